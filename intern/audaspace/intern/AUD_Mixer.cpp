@@ -32,6 +32,10 @@
 
 #include <cstring>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 AUD_Mixer::AUD_Mixer(AUD_DeviceSpecs specs) :
 	m_specs(specs)
 {
@@ -91,7 +95,21 @@ void AUD_Mixer::mix(sample_t* buffer, int start, int length, float volume)
 	length = (AUD_MIN(m_length, length + start) - start) * m_specs.channels;
 	start *= m_specs.channels;
 
-	for(int i = 0; i < length; i++)
+	int i = 0;
+
+#ifdef __SSE2__
+	// four samples at once, unaligned loads as start can be any sample
+	const __m128 v = _mm_set1_ps(volume);
+
+	for(; i <= length - 4; i += 4)
+	{
+		_mm_storeu_ps(out + start + i,
+		              _mm_add_ps(_mm_loadu_ps(out + start + i),
+		                         _mm_mul_ps(_mm_loadu_ps(buffer + i), v)));
+	}
+#endif
+
+	for(; i < length; i++)
 		out[i + start] += buffer[i] * volume;
 }
 
@@ -99,8 +117,18 @@ void AUD_Mixer::read(data_t* buffer, float volume)
 {
 	sample_t* out = m_buffer.getBuffer();
 
-	for(int i = 0; i < m_length * m_specs.channels; i++)
+	int length = m_length * m_specs.channels;
+	int i = 0;
+
+#ifdef __SSE2__
+	const __m128 v = _mm_set1_ps(volume);
+
+	for(; i <= length - 4; i += 4)
+		_mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(out + i), v));
+#endif
+
+	for(; i < length; i++)
 		out[i] *= volume;
 
-	m_convert(buffer, (data_t*) out, m_length * m_specs.channels);
+	m_convert(buffer, (data_t*) out, length);
 }
@@ -440,6 +440,39 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
                 default=False,
                 )
 
+        cls.use_adaptive_sampling = BoolProperty(
+                name="Adaptive Sampling",
+                description="Stop sampling pixels once their noise estimate drops "
+                            "below the threshold, spending samples where they are "
+                            "most needed",
+                default=False,
+                )
+
+        cls.adaptive_threshold = FloatProperty(
+                name="Adaptive Threshold",
+                description="Noise level at which to stop sampling a pixel, "
+                            "relative to its brightness, lower values give "
+                            "cleaner results",
+                min=0.0, max=1.0,
+                default=0.01,
+                )
+
+        cls.adaptive_min_samples = IntProperty(
+                name="Adaptive Min Samples",
+                description="Minimum number of samples each pixel gets before "
+                            "adaptive sampling may stop it",
+                min=2, max=2147483647,
+                default=16,
+                )
+
+        cls.use_light_tree = BoolProperty(
+                name="Light Tree",
+                description="Sample lights through a clustering tree weighted "
+                            "by distance and orientation, reducing noise in "
+                            "scenes with many lights",
+                default=False,
+                )
+
         cls.sample_clamp_direct = FloatProperty(
                 name="Clamp Direct",
                 description="If non-zero, the maximum value for a direct sample, "
@@ -503,6 +536,15 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
                 description="Use BVH spatial splits: longer builder time, faster render",
                 default=False,
                 )
+        cls.texture_cache_size = IntProperty(
+                name="Texture Cache Size",
+                description="Limit texture memory for CPU rendering, loading "
+                            "images on first use and keeping at most this many "
+                            "megabytes of pixels resident (0 to load all images "
+                            "up front)",
+                min=0, max=1024 * 1024,
+                default=0,
+                )
         cls.tile_order = EnumProperty(
                 name="Tile Order",
                 description="Tile order for rendering",
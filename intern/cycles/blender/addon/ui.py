@@ -168,6 +168,14 @@ class CyclesRender_PT_sampling(CyclesButtonsPanel, Panel):
         sub.prop(cscene, "sample_clamp_direct")
         sub.prop(cscene, "sample_clamp_indirect")
 
+        sub.prop(cscene, "use_adaptive_sampling")
+        subsub = sub.column(align=True)
+        subsub.active = cscene.use_adaptive_sampling
+        subsub.prop(cscene, "adaptive_threshold", text="Threshold")
+        subsub.prop(cscene, "adaptive_min_samples", text="Min Samples")
+
+        sub.prop(cscene, "use_light_tree")
+
         if cscene.progressive == 'PATH' or use_branched_path(context) is False:
             col = split.column()
             sub = col.column(align=True)
@@ -401,6 +409,11 @@ class CyclesRender_PT_performance(CyclesButtonsPanel, Panel):
 
         col.separator()
 
+        col.label(text="Textures:")
+        col.prop(cscene, "texture_cache_size", text="Cache Size")
+
+        col.separator()
+
         col.label(text="Acceleration structure:")
         col.prop(cscene, "debug_use_spatial_splits")
 
@@ -188,6 +188,7 @@ void BlenderSession::reset_session(BL::BlendData& b_data_, BL::Scene& b_scene_)
 		 * them rather than trying to distinguish which settings need to be updated
 		 */
 
+		delete sync;
 		delete session;
 
 		create_session();
@@ -196,7 +197,6 @@ void BlenderSession::reset_session(BL::BlendData& b_data_, BL::Scene& b_scene_)
 	}
 
 	session->progress.reset();
-	scene->reset();
 
 	session->tile_manager.set_tile_order(session_params.tile_order);
 
@@ -205,8 +205,10 @@ void BlenderSession::reset_session(BL::BlendData& b_data_, BL::Scene& b_scene_)
 	 */
 	session->stats.mem_peak = session->stats.mem_used;
 
-	/* sync object should be re-created */
-	sync = new BlenderSync(b_engine, b_data, b_scene, scene, !background, session->progress, is_cpu);
+	/* keep the sync object, so data synced for previous frames is re-used and
+	 * only datablocks that can change over time get re-synced and uploaded */
+	sync->reset(b_data, b_scene);
+	sync->tag_update();
 
 	/* for final render we will do full data sync per render layer, only
 	 * do some basic syncing here, no objects or materials for speed */
@@ -492,6 +494,12 @@ void BlenderSession::render()
 			}
 		}
 
+		/* adaptive sampling needs auxiliary passes in the render buffer */
+		if(scene->integrator->adaptive_sampling) {
+			Pass::add(PASS_VARIANCE, passes);
+			Pass::add(PASS_ADAPTIVE, passes);
+		}
+
 		buffer_params.passes = passes;
 		scene->film->pass_alpha_threshold = b_layer_iter->pass_alpha_threshold();
 		scene->film->tag_passes_update(scene, passes);
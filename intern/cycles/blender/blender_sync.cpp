@@ -78,54 +78,146 @@ BlenderSync::~BlenderSync()
 
 /* Sync */
 
-bool BlenderSync::sync_recalc()
+void BlenderSync::reset(BL::BlendData& b_data_, BL::Scene& b_scene_)
 {
-	/* sync recalc flags from blender to cycles. actual update is done separate,
-	 * so we can do it later on if doing it immediate is not suitable */
+	/* Update data and scene pointers, rendering a new frame of a persistent
+	 * session comes with fresh wrappers for them. */
+	b_data = b_data_;
+	b_scene = b_scene_;
+}
 
+void BlenderSync::tag_update()
+{
+	/* On a frame change with a persistent session the recalc flags have
+	 * already been cleared by the frame update itself, so conservatively
+	 * tag everything that can change over time for re-syncing. Static
+	 * datablocks keep their synced data and device memory.
+	 *
+	 * Materials, lamps and worlds are re-synced when they or their node
+	 * tree carry animation or drivers; animation on node groups inside is
+	 * not detected. */
 	BL::BlendData::materials_iterator b_mat;
-	bool has_updated_objects = b_data.objects.is_updated();
+
 	for(b_data.materials.begin(b_mat); b_mat != b_data.materials.end(); ++b_mat) {
-		if(b_mat->is_updated() || (b_mat->node_tree() && b_mat->node_tree().is_updated())) {
+		if(b_mat->animation_data() ||
+		   (b_mat->node_tree() && b_mat->node_tree().animation_data()))
+		{
 			shader_map.set_recalc(*b_mat);
 		}
-		else {
-			Shader *shader = shader_map.find(*b_mat);
-			if(has_updated_objects && shader != NULL && shader->has_object_dependency) {
-				shader_map.set_recalc(*b_mat);
-			}
-		}
 	}
 
 	BL::BlendData::lamps_iterator b_lamp;
 
-	for(b_data.lamps.begin(b_lamp); b_lamp != b_data.lamps.end(); ++b_lamp)
-		if(b_lamp->is_updated() || (b_lamp->node_tree() && b_lamp->node_tree().is_updated()))
+	for(b_data.lamps.begin(b_lamp); b_lamp != b_data.lamps.end(); ++b_lamp) {
+		if(b_lamp->animation_data() ||
+		   (b_lamp->node_tree() && b_lamp->node_tree().animation_data()))
+		{
 			shader_map.set_recalc(*b_lamp);
+		}
+	}
+
+	BL::BlendData::worlds_iterator b_world;
+
+	for(b_data.worlds.begin(b_world); b_world != b_data.worlds.end(); ++b_world) {
+		if(b_world->animation_data() ||
+		   (b_world->node_tree() && b_world->node_tree().animation_data()))
+		{
+			world_recalc = true;
+		}
+	}
 
 	BL::BlendData::objects_iterator b_ob;
 
 	for(b_data.objects.begin(b_ob); b_ob != b_data.objects.end(); ++b_ob) {
-		if(b_ob->is_updated()) {
+		if(object_is_light(*b_ob)) {
+			/* Lights are small and fully re-synced, their transforms are
+			 * not compared against the existing ones during sync. */
 			object_map.set_recalc(*b_ob);
 			light_map.set_recalc(*b_ob);
 		}
-
-		if(object_is_mesh(*b_ob)) {
-			if(b_ob->is_updated_data() || b_ob->data().is_updated()) {
+		else if(object_is_mesh(*b_ob)) {
+			/* Deforming meshes need new geometry, object level transforms
+			 * are compared during object sync and need no tagging here. */
+			if(BKE_object_is_deform_modified(*b_ob, b_scene, preview)) {
 				BL::ID key = BKE_object_is_modified(*b_ob)? *b_ob: b_ob->data();
 				mesh_map.set_recalc(key);
 			}
 		}
-		else if(object_is_light(*b_ob)) {
-			if(b_ob->is_updated_data() || b_ob->data().is_updated())
-				light_map.set_recalc(*b_ob);
+
+		/* Particle state advances with time. */
+		if(b_ob->particle_systems.length() != 0)
+			particle_system_map.set_recalc(*b_ob);
+	}
+}
+
+bool BlenderSync::sync_recalc()
+{
+	/* sync recalc flags from blender to cycles. actual update is done separate,
+	 * so we can do it later on if doing it immediate is not suitable */
+
+	/* The dependency graph counts tagged IDs per type, which the collection
+	 * level is_updated() exposes. Use it to skip scanning ID types without a
+	 * single update, so an unrelated edit doesn't pay for iterating every
+	 * datablock in heavy scenes. */
+	bool has_updated_objects = b_data.objects.is_updated();
+	bool has_updated_node_trees = b_data.node_groups.is_updated();
+
+	if(b_data.materials.is_updated() || has_updated_node_trees || has_updated_objects) {
+		BL::BlendData::materials_iterator b_mat;
+
+		for(b_data.materials.begin(b_mat); b_mat != b_data.materials.end(); ++b_mat) {
+			if(b_mat->is_updated() || (b_mat->node_tree() && b_mat->node_tree().is_updated())) {
+				shader_map.set_recalc(*b_mat);
+			}
+			else {
+				Shader *shader = shader_map.find(*b_mat);
+				if(has_updated_objects && shader != NULL && shader->has_object_dependency) {
+					shader_map.set_recalc(*b_mat);
+				}
+			}
 		}
-		
-		if(b_ob->is_updated_data()) {
-			BL::Object::particle_systems_iterator b_psys;
-			for(b_ob->particle_systems.begin(b_psys); b_psys != b_ob->particle_systems.end(); ++b_psys)
-				particle_system_map.set_recalc(*b_ob);
+	}
+
+	if(b_data.lamps.is_updated() || has_updated_node_trees) {
+		BL::BlendData::lamps_iterator b_lamp;
+
+		for(b_data.lamps.begin(b_lamp); b_lamp != b_data.lamps.end(); ++b_lamp)
+			if(b_lamp->is_updated() || (b_lamp->node_tree() && b_lamp->node_tree().is_updated()))
+				shader_map.set_recalc(*b_lamp);
+	}
+
+	/* object data updates tag their own ID type, not ID_OB,
+	 * so check the types that can back a synced object too */
+	if(has_updated_objects ||
+	   b_data.meshes.is_updated() ||
+	   b_data.curves.is_updated() ||
+	   b_data.metaballs.is_updated() ||
+	   b_data.lamps.is_updated())
+	{
+		BL::BlendData::objects_iterator b_ob;
+
+		for(b_data.objects.begin(b_ob); b_ob != b_data.objects.end(); ++b_ob) {
+			if(b_ob->is_updated()) {
+				object_map.set_recalc(*b_ob);
+				light_map.set_recalc(*b_ob);
+			}
+
+			if(object_is_mesh(*b_ob)) {
+				if(b_ob->is_updated_data() || b_ob->data().is_updated()) {
+					BL::ID key = BKE_object_is_modified(*b_ob)? *b_ob: b_ob->data();
+					mesh_map.set_recalc(key);
+				}
+			}
+			else if(object_is_light(*b_ob)) {
+				if(b_ob->is_updated_data() || b_ob->data().is_updated())
+					light_map.set_recalc(*b_ob);
+			}
+
+			if(b_ob->is_updated_data()) {
+				BL::Object::particle_systems_iterator b_psys;
+				for(b_ob->particle_systems.begin(b_psys); b_psys != b_ob->particle_systems.end(); ++b_psys)
+					particle_system_map.set_recalc(*b_ob);
+			}
 		}
 	}
 
@@ -150,35 +242,38 @@ bool BlenderSync::sync_recalc()
 		}
 	}
 
-	BL::BlendData::meshes_iterator b_mesh;
-
-	for(b_data.meshes.begin(b_mesh); b_mesh != b_data.meshes.end(); ++b_mesh) {
-		if(b_mesh->is_updated()) {
-			mesh_map.set_recalc(*b_mesh);
-		}
-		else if(dicing_prop_changed) {
-			PointerRNA cmesh = RNA_pointer_get(&b_mesh->ptr, "cycles");
+	if(b_data.meshes.is_updated() || dicing_prop_changed) {
+		BL::BlendData::meshes_iterator b_mesh;
 
-			if(RNA_enum_get(&cmesh, "subdivision_type"))
+		for(b_data.meshes.begin(b_mesh); b_mesh != b_data.meshes.end(); ++b_mesh) {
+			if(b_mesh->is_updated()) {
 				mesh_map.set_recalc(*b_mesh);
+			}
+			else if(dicing_prop_changed) {
+				PointerRNA cmesh = RNA_pointer_get(&b_mesh->ptr, "cycles");
+
+				if(RNA_enum_get(&cmesh, "subdivision_type"))
+					mesh_map.set_recalc(*b_mesh);
+			}
 		}
 	}
 
+	if(b_data.worlds.is_updated() || has_updated_node_trees || has_updated_objects) {
+		BL::BlendData::worlds_iterator b_world;
 
-	BL::BlendData::worlds_iterator b_world;
-
-	for(b_data.worlds.begin(b_world); b_world != b_data.worlds.end(); ++b_world) {
-		if(world_map == b_world->ptr.data) {
-			if(b_world->is_updated() ||
-			   (b_world->node_tree() && b_world->node_tree().is_updated()))
-			{
-				world_recalc = true;
-			}
-			else if(b_world->node_tree() && b_world->use_nodes()) {
-				Shader *shader = scene->shaders[scene->default_background];
-				if(has_updated_objects && shader != NULL && shader->has_object_dependency) {
+		for(b_data.worlds.begin(b_world); b_world != b_data.worlds.end(); ++b_world) {
+			if(world_map == b_world->ptr.data) {
+				if(b_world->is_updated() ||
+				   (b_world->node_tree() && b_world->node_tree().is_updated()))
+				{
 					world_recalc = true;
 				}
+				else if(b_world->node_tree() && b_world->use_nodes()) {
+					Shader *shader = scene->shaders[scene->default_background];
+					if(has_updated_objects && shader != NULL && shader->has_object_dependency) {
+						world_recalc = true;
+					}
+				}
 			}
 		}
 	}
@@ -273,6 +368,19 @@ void BlenderSync::sync_integrator()
 
 	integrator->sample_clamp_direct = get_float(cscene, "sample_clamp_direct");
 	integrator->sample_clamp_indirect = get_float(cscene, "sample_clamp_indirect");
+
+	/* adaptive sampling is only used for final renders */
+	integrator->adaptive_sampling = (!preview) && get_boolean(cscene, "use_adaptive_sampling");
+	integrator->adaptive_threshold = get_float(cscene, "adaptive_threshold");
+	integrator->adaptive_min_samples = get_int(cscene, "adaptive_min_samples");
+
+	/* the light tree lives in the light distribution, rebuild on change */
+	bool use_light_tree = get_boolean(cscene, "use_light_tree");
+	if(integrator->use_light_tree != use_light_tree) {
+		integrator->use_light_tree = use_light_tree;
+		scene->light_manager->tag_update(scene);
+	}
+
 #ifdef __CAMERA_MOTION__
 	if(!preview) {
 		if(integrator->motion_blur != r.use_motion_blur()) {
@@ -512,6 +620,10 @@ SceneParams BlenderSync::get_scene_params(BL::Scene& b_scene,
 		params.use_qbvh = false;
 	}
 
+	/* Texture cache size is specified in megabytes, CPU only. */
+	if(is_cpu)
+		params.texture_cache_size = (size_t)RNA_int_get(&cscene, "texture_cache_size") * 1024 * 1024;
+
 	return params;
 }
 
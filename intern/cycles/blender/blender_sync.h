@@ -59,6 +59,8 @@ public:
 
 	/* sync */
 	bool sync_recalc();
+	void reset(BL::BlendData& b_data, BL::Scene& b_scene);
+	void tag_update();
 	void sync_data(BL::RenderSettings& b_render,
 	               BL::SpaceView3D& b_v3d,
 	               BL::Object& b_override,
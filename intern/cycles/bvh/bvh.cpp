@@ -27,15 +27,26 @@
 
 #include "util_debug.h"
 #include "util_foreach.h"
+#include "util_function.h"
 #include "util_logging.h"
 #include "util_map.h"
 #include "util_progress.h"
 #include "util_system.h"
+#include "util_task.h"
 #include "util_types.h"
 #include "util_math.h"
 
 CCL_NAMESPACE_BEGIN
 
+/* Number of primitives handled by a single refit task, and below which
+ * refitting is not worth threading at all. */
+static const int BVH_REFIT_TASK_SIZE = 65536;
+
+/* How many tree levels to split into per-subtree refit tasks, 2^6 binary
+ * and 4^3 quad subtrees keep all cores busy at negligible task overhead. */
+static const int BVH_REFIT_PARALLEL_DEPTH = 6;
+static const int QBVH_REFIT_PARALLEL_DEPTH = 3;
+
 /* Pack Utility */
 
 struct BVHStackEntry
@@ -75,6 +86,10 @@ void BVH::build(Progress& progress)
 {
 	progress.set_substatus("Building BVH");
 
+	build_meshes.resize(objects.size());
+	for(size_t i = 0; i < objects.size(); i++)
+		build_meshes[i] = objects[i]->mesh;
+
 	/* build nodes */
 	BVHBuild bvh_build(objects,
 	                   pack.prim_type,
@@ -108,15 +123,54 @@ void BVH::build(Progress& progress)
 
 /* Refitting */
 
-void BVH::refit(Progress& progress)
+bool BVH::refit(Progress& progress)
 {
+	/* A swapped mesh means different geometry behind an unchanged object
+	 * array, which only a full rebuild can handle. */
+	if(objects.size() != build_meshes.size())
+		return false;
+	for(size_t i = 0; i < objects.size(); i++)
+		if(objects[i]->mesh != build_meshes[i])
+			return false;
+
+	if(params.top_level) {
+		/* Re-copy data of the refitted instance BVH's, bail out when the
+		 * packed layout no longer matches the objects. */
+		progress.set_substatus("Packing BVH instances");
+		if(!refit_instances())
+			return false;
+	}
+
+	if(progress.get_cancel()) return true;
+
+	/* Refresh triangle vertices and visibility. For the top level this only
+	 * needs to cover our own primitive range, the instanced ranges were just
+	 * copied over by refit_instances(). */
 	progress.set_substatus("Packing BVH primitives");
-	pack_primitives();
 
-	if(progress.get_cancel()) return;
+	const int num_prims = (params.top_level)? (int)pack.own_prim_size
+	                                        : (int)pack.prim_index.size();
+
+	if(num_prims < BVH_REFIT_TASK_SIZE || TaskScheduler::num_threads() == 1) {
+		refit_primitives(0, num_prims);
+	}
+	else {
+		TaskPool pool;
+		for(int from = 0; from < num_prims; from += BVH_REFIT_TASK_SIZE) {
+			pool.push(function_bind(&BVH::refit_primitives,
+			                        this,
+			                        from,
+			                        min(from + BVH_REFIT_TASK_SIZE, num_prims)));
+		}
+		pool.wait_work();
+	}
+
+	if(progress.get_cancel()) return true;
 
 	progress.set_substatus("Refitting BVH nodes");
 	refit_nodes();
+
+	return true;
 }
 
 /* Triangles */
@@ -177,6 +231,38 @@ void BVH::pack_primitives()
 	}
 }
 
+void BVH::refit_primitives(int from, int to)
+{
+	/* Update triangle vertices and primitive visibility in the already
+	 * allocated storage. Unlike pack_primitives() this has to deal with
+	 * prim_index having been made global by pack_instances() for the
+	 * top level BVH. Ranges only touch their own output, so this is run
+	 * from multiple refit tasks at once. */
+	for(int i = from; i < to; i++) {
+		if(pack.prim_index[i] == -1)
+			continue;
+
+		Object *ob = objects[pack.prim_object[i]];
+		const Mesh *mesh = ob->mesh;
+
+		if(pack.prim_type[i] & PRIMITIVE_TRIANGLE) {
+			int tidx = pack.prim_index[i] - ((params.top_level)? mesh->tri_offset: 0);
+			const int *vidx = mesh->triangles[tidx].v;
+			const float3 *vpos = &mesh->verts[0];
+			float4 *storage = &pack.tri_storage[i * TRI_NODE_SIZE];
+
+			storage[0] = float3_to_float4(vpos[vidx[0]]);
+			storage[1] = float3_to_float4(vpos[vidx[1]]);
+			storage[2] = float3_to_float4(vpos[vidx[2]]);
+		}
+
+		pack.prim_visibility[i] = ob->visibility;
+
+		if(pack.prim_type[i] & PRIMITIVE_ALL_CURVE)
+			pack.prim_visibility[i] |= PATH_RAY_CURVE;
+	}
+}
+
 /* Pack Instances */
 
 void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
@@ -188,6 +274,11 @@ void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
 	size_t nsize = (use_qbvh)? BVH_QNODE_SIZE: BVH_NODE_SIZE;
 	size_t nsize_leaf = (use_qbvh)? BVH_QNODE_LEAF_SIZE: BVH_NODE_LEAF_SIZE;
 
+	/* remember own data sizes so refit_instances() can replay the merge */
+	pack.own_prim_size = pack.prim_index.size();
+	pack.own_nodes_size = nodes_size;
+	pack.own_leaf_nodes_size = leaf_nodes_size;
+
 	/* adjust primitive index to point to the triangle in the global array, for
 	 * meshes with transform applied and already in the top level BVH */
 	for(size_t i = 0; i < pack.prim_index.size(); i++)
@@ -375,6 +466,148 @@ void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
 	}
 }
 
+bool BVH::refit_instances()
+{
+	bool use_qbvh = params.use_qbvh;
+	size_t nsize = (use_qbvh)? BVH_QNODE_SIZE: BVH_NODE_SIZE;
+	size_t nsize_leaf = (use_qbvh)? BVH_QNODE_LEAF_SIZE: BVH_NODE_LEAF_SIZE;
+
+	/* Verify the merged layout still matches the objects, any size mismatch
+	 * means the topology changed after all and a full rebuild is needed. */
+	size_t prim_size = pack.own_prim_size;
+	size_t nodes_size = pack.own_nodes_size;
+	size_t leaf_nodes_size = pack.own_leaf_nodes_size;
+
+	map<Mesh*, int> mesh_map;
+
+	foreach(Object *ob, objects) {
+		Mesh *mesh = ob->mesh;
+
+		if(!mesh->need_build_bvh())
+			continue;
+		if(mesh_map.find(mesh) != mesh_map.end())
+			continue;
+		if(mesh->bvh == NULL)
+			return false;
+
+		prim_size += mesh->bvh->pack.prim_index.size();
+		nodes_size += mesh->bvh->pack.nodes.size();
+		leaf_nodes_size += mesh->bvh->pack.leaf_nodes.size();
+
+		mesh_map[mesh] = 1;
+	}
+
+	if(prim_size != pack.prim_index.size() ||
+	   nodes_size != pack.nodes.size() ||
+	   leaf_nodes_size != pack.leaf_nodes.size())
+	{
+		return false;
+	}
+
+	mesh_map.clear();
+
+	/* Replay the merge loops of pack_instances() for the data that changes
+	 * with deformation, all offsets are identical to the original pack since
+	 * the topology was verified to be unchanged above.
+	 * NOTE: Keep in sync with pack_instances(). */
+	size_t prim_offset = pack.own_prim_size;
+	size_t nodes_offset = pack.own_nodes_size;
+	size_t nodes_leaf_offset = pack.own_leaf_nodes_size;
+
+	size_t pack_prim_visibility_offset = pack.own_prim_size;
+	size_t pack_tri_storage_offset = pack.own_prim_size*TRI_NODE_SIZE;
+	size_t pack_nodes_offset = pack.own_nodes_size;
+	size_t pack_leaf_nodes_offset = pack.own_leaf_nodes_size;
+
+	uint *pack_prim_visibility = (pack.prim_visibility.size())? &pack.prim_visibility[0]: NULL;
+	float4 *pack_tri_storage = (pack.tri_storage.size())? &pack.tri_storage[0]: NULL;
+	int4 *pack_nodes = (pack.nodes.size())? &pack.nodes[0]: NULL;
+	int4 *pack_leaf_nodes = (pack.leaf_nodes.size())? &pack.leaf_nodes[0]: NULL;
+
+	foreach(Object *ob, objects) {
+		Mesh *mesh = ob->mesh;
+
+		if(!mesh->need_build_bvh())
+			continue;
+		if(mesh_map.find(mesh) != mesh_map.end())
+			continue;
+
+		mesh_map[mesh] = 1;
+
+		BVH *bvh = mesh->bvh;
+
+		int noffset = nodes_offset/nsize;
+		int noffset_leaf = nodes_leaf_offset/nsize_leaf;
+
+		/* merge primitive visibility */
+		if(bvh->pack.prim_visibility.size()) {
+			memcpy(pack_prim_visibility + pack_prim_visibility_offset,
+			       &bvh->pack.prim_visibility[0],
+			       bvh->pack.prim_visibility.size()*sizeof(uint));
+			pack_prim_visibility_offset += bvh->pack.prim_visibility.size();
+		}
+
+		/* merge triangle intersection data */
+		if(bvh->pack.tri_storage.size()) {
+			memcpy(pack_tri_storage + pack_tri_storage_offset,
+			       &bvh->pack.tri_storage[0],
+			       bvh->pack.tri_storage.size()*sizeof(float4));
+			pack_tri_storage_offset += bvh->pack.tri_storage.size();
+		}
+
+		/* merge nodes */
+		if(bvh->pack.leaf_nodes.size()) {
+			int4 *leaf_nodes = &bvh->pack.leaf_nodes[0];
+			size_t leaf_nodes_size = bvh->pack.leaf_nodes.size();
+			for(size_t i = 0; i < leaf_nodes_size; i += nsize_leaf) {
+				int4 data = leaf_nodes[i];
+				data.x += prim_offset;
+				data.y += prim_offset;
+				pack_leaf_nodes[pack_leaf_nodes_offset] = data;
+				for(size_t j = 1; j < nsize_leaf; ++j) {
+					pack_leaf_nodes[pack_leaf_nodes_offset + j] = leaf_nodes[i + j];
+				}
+				pack_leaf_nodes_offset += nsize_leaf;
+			}
+		}
+
+		if(bvh->pack.nodes.size()) {
+			size_t nsize_bbox = (use_qbvh)? 6: 3;
+			int4 *bvh_nodes = &bvh->pack.nodes[0];
+			size_t bvh_nodes_size = bvh->pack.nodes.size();
+
+			for(size_t i = 0; i < bvh_nodes_size; i += nsize) {
+				memcpy(pack_nodes + pack_nodes_offset, bvh_nodes + i, nsize_bbox*sizeof(int4));
+
+				/* modify offsets into arrays */
+				int4 data = bvh_nodes[i + nsize_bbox];
+
+				data.x += (data.x < 0)? -noffset_leaf: noffset;
+				data.y += (data.y < 0)? -noffset_leaf: noffset;
+
+				if(use_qbvh) {
+					data.z += (data.z < 0)? -noffset_leaf: noffset;
+					data.w += (data.w < 0)? -noffset_leaf: noffset;
+				}
+
+				pack_nodes[pack_nodes_offset + nsize_bbox] = data;
+
+				memcpy(&pack_nodes[pack_nodes_offset + nsize_bbox+1],
+				       &bvh_nodes[i + nsize_bbox+1],
+				       sizeof(int4) * (nsize - (nsize_bbox+1)));
+
+				pack_nodes_offset += nsize;
+			}
+		}
+
+		nodes_offset += bvh->pack.nodes.size();
+		nodes_leaf_offset += bvh->pack.leaf_nodes.size();
+		prim_offset += bvh->pack.prim_index.size();
+	}
+
+	return true;
+}
+
 /* Regular BVH */
 
 RegularBVH::RegularBVH(const BVHParams& params_, const vector<Object*>& objects_)
@@ -476,11 +709,52 @@ void RegularBVH::pack_nodes(const BVHNode *root)
 
 void RegularBVH::refit_nodes()
 {
-	assert(!params.top_level);
-
 	BoundBox bbox = BoundBox::empty;
 	uint visibility = 0;
-	refit_node(0, (pack.root_index == -1)? true: false, bbox, visibility);
+
+	if(pack.root_index == -1) {
+		refit_node(0, true, bbox, visibility);
+	}
+	else if(pack.prim_index.size() >= (size_t)BVH_REFIT_TASK_SIZE &&
+	        TaskScheduler::num_threads() > 1)
+	{
+		refit_node_task(0, false, &bbox, &visibility, 0);
+	}
+	else {
+		refit_node(0, false, bbox, visibility);
+	}
+}
+
+void RegularBVH::refit_node_task(int idx, bool leaf, BoundBox *bbox, uint *visibility, int depth)
+{
+	/* Subtrees only touch their own node range so they refit in parallel,
+	 * below the splitting depth we fall back to the serial recursion. */
+	if(leaf || depth >= BVH_REFIT_PARALLEL_DEPTH) {
+		refit_node(idx, leaf, *bbox, *visibility);
+		return;
+	}
+
+	int4 *data = &pack.nodes[idx*BVH_NODE_SIZE];
+	int c0 = data[3].x;
+	int c1 = data[3].y;
+
+	BoundBox bbox0 = BoundBox::empty, bbox1 = BoundBox::empty;
+	uint visibility0 = 0, visibility1 = 0;
+
+	TaskPool pool;
+	pool.push(function_bind(&RegularBVH::refit_node_task,
+	                        this,
+	                        (c0 < 0)? -c0-1: c0, (c0 < 0),
+	                        &bbox0, &visibility0,
+	                        depth + 1));
+	refit_node_task((c1 < 0)? -c1-1: c1, (c1 < 0), &bbox1, &visibility1, depth + 1);
+	pool.wait_work();
+
+	pack_node(idx, bbox0, bbox1, c0, c1, visibility0, visibility1);
+
+	bbox->grow(bbox0);
+	bbox->grow(bbox1);
+	*visibility = visibility0|visibility1;
 }
 
 void RegularBVH::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility)
@@ -489,8 +763,19 @@ void RegularBVH::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility
 		int4 *data = &pack.leaf_nodes[idx*BVH_NODE_LEAF_SIZE];
 		int c0 = data[0].x;
 		int c1 = data[0].y;
+		/* Single object instance leaf of the top level BVH, stored with the
+		 * primitive index inverted (see pack_leaf()), skip the loop below. */
+		const int prim_start = (c0 < 0)? 0: c0;
+		const int prim_end = (c0 < 0)? 0: c1;
+		if(c0 < 0) {
+			int prim = ~c0;
+			Object *ob = objects[pack.prim_object[prim]];
+
+			bbox.grow(ob->bounds);
+			visibility |= ob->visibility;
+		}
 		/* refit leaf node */
-		for(int prim = c0; prim < c1; prim++) {
+		for(int prim = prim_start; prim < prim_end; prim++) {
 			int pidx = pack.prim_index[prim];
 			int tob = pack.prim_object[prim];
 			Object *ob = objects[tob];
@@ -741,11 +1026,80 @@ void QBVH::pack_nodes(const BVHNode *root)
 
 void QBVH::refit_nodes()
 {
-	assert(!params.top_level);
-
 	BoundBox bbox = BoundBox::empty;
 	uint visibility = 0;
-	refit_node(0, (pack.root_index == -1)? true: false, bbox, visibility);
+
+	if(pack.root_index == -1) {
+		refit_node(0, true, bbox, visibility);
+	}
+	else if(pack.prim_index.size() >= (size_t)BVH_REFIT_TASK_SIZE &&
+	        TaskScheduler::num_threads() > 1)
+	{
+		refit_node_task(0, false, &bbox, &visibility, 0);
+	}
+	else {
+		refit_node(0, false, bbox, visibility);
+	}
+}
+
+void QBVH::refit_node_task(int idx, bool leaf, BoundBox *bbox, uint *visibility, int depth)
+{
+	/* Subtrees only touch their own node range so they refit in parallel,
+	 * below the splitting depth we fall back to the serial recursion. */
+	if(leaf || depth >= QBVH_REFIT_PARALLEL_DEPTH) {
+		refit_node(idx, leaf, *bbox, *visibility);
+		return;
+	}
+
+	int4 *data = &pack.nodes[idx*BVH_QNODE_SIZE];
+	int4 c = data[6];
+
+	BoundBox child_bbox[4] = {BoundBox::empty,
+	                          BoundBox::empty,
+	                          BoundBox::empty,
+	                          BoundBox::empty};
+	uint child_visibility[4] = {0};
+
+	TaskPool pool;
+	for(int i = 1; i < 4; ++i) {
+		if(c[i] != 0) {
+			pool.push(function_bind(&QBVH::refit_node_task,
+			                        this,
+			                        (c[i] < 0)? -c[i]-1: c[i], (c[i] < 0),
+			                        &child_bbox[i], &child_visibility[i],
+			                        depth + 1));
+		}
+	}
+	if(c[0] != 0) {
+		refit_node_task((c[0] < 0)? -c[0]-1: c[0], (c[0] < 0),
+		                &child_bbox[0], &child_visibility[0],
+		                depth + 1);
+	}
+	pool.wait_work();
+
+	for(int i = 0; i < 4; ++i) {
+		if(c[i] != 0) {
+			bbox->grow(child_bbox[i]);
+			*visibility |= child_visibility[i];
+		}
+	}
+
+	/* TODO(sergey): See the de-duplication notes in refit_node(). */
+	float4 inner_data[BVH_QNODE_SIZE];
+	for(int i = 0; i < 4; ++i) {
+		float3 bb_min = child_bbox[i].min;
+		float3 bb_max = child_bbox[i].max;
+		inner_data[0][i] = bb_min.x;
+		inner_data[1][i] = bb_max.x;
+		inner_data[2][i] = bb_min.y;
+		inner_data[3][i] = bb_max.y;
+		inner_data[4][i] = bb_min.z;
+		inner_data[5][i] = bb_max.z;
+		inner_data[6][i] = __int_as_float(c[i]);
+	}
+	memcpy(&pack.nodes[idx * BVH_QNODE_SIZE],
+	       inner_data,
+	       sizeof(float4)*BVH_QNODE_SIZE);
 }
 
 void QBVH::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility)
@@ -753,8 +1107,19 @@ void QBVH::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility)
 	if(leaf) {
 		int4 *data = &pack.leaf_nodes[idx*BVH_QNODE_LEAF_SIZE];
 		int4 c = data[0];
+		/* Single object instance leaf of the top level BVH, stored with the
+		 * primitive index inverted (see pack_leaf()), skip the loop below. */
+		const int prim_start = (c.x < 0)? 0: c.x;
+		const int prim_end = (c.x < 0)? 0: c.y;
+		if(c.x < 0) {
+			int prim = ~c.x;
+			Object *ob = objects[pack.prim_object[prim]];
+
+			bbox.grow(ob->bounds);
+			visibility |= ob->visibility;
+		}
 		/* Refit leaf node. */
-		for(int prim = c.x; prim < c.y; prim++) {
+		for(int prim = prim_start; prim < prim_end; prim++) {
 			int pidx = pack.prim_index[prim];
 			int tob = pack.prim_object[prim];
 			Object *ob = objects[tob];
@@ -30,6 +30,7 @@ struct BVHStackEntry;
 class BVHParams;
 class BoundBox;
 class LeafNode;
+class Mesh;
 class Object;
 class Progress;
 
@@ -67,9 +68,19 @@ struct PackedBVH {
 	/* index of the root node. */
 	int root_index;
 
+	/* Sizes of the top level BVH's own data, before the instanced mesh BVH's
+	 * were merged into the arrays above. Remembered by pack_instances() so
+	 * the merge can be replayed cheaply when refitting. */
+	size_t own_prim_size;
+	size_t own_nodes_size;
+	size_t own_leaf_nodes_size;
+
 	PackedBVH()
 	{
 		root_index = 0;
+		own_prim_size = 0;
+		own_nodes_size = 0;
+		own_leaf_nodes_size = 0;
 	}
 };
 
@@ -81,12 +92,18 @@ public:
 	PackedBVH pack;
 	BVHParams params;
 	vector<Object*> objects;
+	/* Meshes of those objects at build time, so refit() can detect an object
+	 * whose mesh was swapped for different geometry. */
+	vector<Mesh*> build_meshes;
 
 	static BVH *create(const BVHParams& params, const vector<Object*>& objects);
 	virtual ~BVH() {}
 
 	void build(Progress& progress);
-	void refit(Progress& progress);
+
+	/* Refit node bounds without rebuilding the tree, returns false when the
+	 * packed layout no longer matches the objects and a rebuild is needed. */
+	bool refit(Progress& progress);
 
 protected:
 	BVH(const BVHParams& params, const vector<Object*>& objects);
@@ -95,9 +112,15 @@ protected:
 	void pack_primitives();
 	void pack_triangle(int idx, float4 storage[3]);
 
+	/* refresh triangle vertices and visibility of already packed primitives */
+	void refit_primitives(int from, int to);
+
 	/* merge instance BVH's */
 	void pack_instances(size_t nodes_size, size_t leaf_nodes_size);
 
+	/* re-copy refitted instance BVH data into the global arrays */
+	bool refit_instances();
+
 	/* for subclasses to implement */
 	virtual void pack_nodes(const BVHNode *root) = 0;
 	virtual void refit_nodes() = 0;
@@ -122,6 +145,7 @@ protected:
 	/* refit */
 	void refit_nodes();
 	void refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility);
+	void refit_node_task(int idx, bool leaf, BoundBox *bbox, uint *visibility, int depth);
 };
 
 /* QBVH
@@ -142,6 +166,7 @@ protected:
 	/* refit */
 	void refit_nodes();
 	void refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility);
+	void refit_node_task(int idx, bool leaf, BoundBox *bbox, uint *visibility, int depth);
 };
 
 CCL_NAMESPACE_END
@@ -193,6 +193,11 @@ struct BVHSpatialStorage {
 	 * new references in before they're getting inserted into actual array,
 	 */
 	vector<BVHReference> new_references;
+
+	/* Per-reference side classification used by the threaded spatial split
+	 * partitioning.
+	 */
+	vector<char> sides;
 };
 
 CCL_NAMESPACE_END
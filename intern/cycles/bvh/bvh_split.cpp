@@ -26,6 +26,25 @@
 
 CCL_NAMESPACE_BEGIN
 
+/* Below this many references binning and partitioning of a spatial split are
+ * not worth threading. Deeper nodes always fall below this, so nested tasks
+ * are only spawned near the root where the builder has not fanned out into
+ * enough subtree tasks yet to keep all cores busy.
+ */
+static const int SPATIAL_SPLIT_TASK_SIZE = 32768;
+
+/* Reference side classification for the threaded partition. */
+enum {
+	SPATIAL_SIDE_BOTH = 0,
+	SPATIAL_SIDE_LEFT,
+	SPATIAL_SIDE_RIGHT,
+};
+
+/* Per-task histogram for the threaded binning. */
+struct BVHSpatialBinTask {
+	BVHSpatialBin bins[3][BVHParams::NUM_SPATIAL_BINS];
+};
+
 /* Object Split */
 
 BVHObjectSplit::BVHObjectSplit(BVHBuild *builder,
@@ -129,30 +148,59 @@ BVHSpatialSplit::BVHSpatialSplit(const BVHBuild& builder,
 	}
 
 	/* chop references into bins. */
-	for(unsigned int refIdx = range.start(); refIdx < range.end(); refIdx++) {
-		const BVHReference& ref = references_->at(refIdx);
-		float3 firstBinf = (ref.bounds().min - origin) * invBinSize;
-		float3 lastBinf = (ref.bounds().max - origin) * invBinSize;
-		int3 firstBin = make_int3((int)firstBinf.x, (int)firstBinf.y, (int)firstBinf.z);
-		int3 lastBin = make_int3((int)lastBinf.x, (int)lastBinf.y, (int)lastBinf.z);
-
-		firstBin = clamp(firstBin, 0, BVHParams::NUM_SPATIAL_BINS - 1);
-		lastBin = clamp(lastBin, firstBin, BVHParams::NUM_SPATIAL_BINS - 1);
-
-		for(int dim = 0; dim < 3; dim++) {
-			BVHReference currRef = ref;
-
-			for(int i = firstBin[dim]; i < lastBin[dim]; i++) {
-				BVHReference leftRef, rightRef;
-
-				split_reference(builder, leftRef, rightRef, currRef, dim, origin[dim] + binSize[dim] * (float)(i + 1));
-				storage_->bins[dim][i].bounds.grow(leftRef.bounds());
-				currRef = rightRef;
+	if(range.size() < SPATIAL_SPLIT_TASK_SIZE || TaskScheduler::num_threads() == 1) {
+		bin_references(&builder,
+		               range.start(),
+		               range.end(),
+		               origin,
+		               binSize,
+		               invBinSize,
+		               storage_->bins);
+	}
+	else {
+		/* Bin chunks of the range into per-task histograms and merge them
+		 * afterwards, so tasks never contend on the shared bins.
+		 */
+		const int num_refs = range.size();
+		const int num_tasks = min(TaskScheduler::num_threads(),
+		                          num_refs / (SPATIAL_SPLIT_TASK_SIZE / 4));
+		vector<BVHSpatialBinTask> task_bins(num_tasks);
+		TaskPool pool;
+
+		for(int task = 0; task < num_tasks; task++) {
+			BVHSpatialBin (*bins)[BVHParams::NUM_SPATIAL_BINS] = task_bins[task].bins;
+
+			for(int dim = 0; dim < 3; dim++) {
+				for(int i = 0; i < BVHParams::NUM_SPATIAL_BINS; i++) {
+					bins[dim][i].bounds = BoundBox::empty;
+					bins[dim][i].enter = 0;
+					bins[dim][i].exit = 0;
+				}
 			}
 
-			storage_->bins[dim][lastBin[dim]].bounds.grow(currRef.bounds());
-			storage_->bins[dim][firstBin[dim]].enter++;
-			storage_->bins[dim][lastBin[dim]].exit++;
+			pool.push(function_bind(&BVHSpatialSplit::bin_references,
+			                        this,
+			                        &builder,
+			                        range.start() + (int)((int64_t)num_refs * task / num_tasks),
+			                        range.start() + (int)((int64_t)num_refs * (task + 1) / num_tasks),
+			                        origin,
+			                        binSize,
+			                        invBinSize,
+			                        bins));
+		}
+		pool.wait_work();
+
+		for(int task = 0; task < num_tasks; task++) {
+			for(int dim = 0; dim < 3; dim++) {
+				for(int i = 0; i < BVHParams::NUM_SPATIAL_BINS; i++) {
+					BVHSpatialBin& bin = storage_->bins[dim][i];
+					const BVHSpatialBin& task_bin = task_bins[task].bins[dim][i];
+
+					bin.bounds.grow(task_bin.bounds);
+					bin.enter += task_bin.enter;
+					bin.exit += task_bin.exit;
+				}
+			}
 		}
 	}
 
@@ -189,6 +237,73 @@ BVHSpatialSplit::BVHSpatialSplit(const BVHBuild& builder,
 	}
 }
 
+void BVHSpatialSplit::bin_references(const BVHBuild *builder,
+                                     int from,
+                                     int to,
+                                     float3 origin,
+                                     float3 binSize,
+                                     float3 invBinSize,
+                                     BVHSpatialBin (*bins)[BVHParams::NUM_SPATIAL_BINS])
+{
+	for(int refIdx = from; refIdx < to; refIdx++) {
+		const BVHReference& ref = references_->at(refIdx);
+		float3 firstBinf = (ref.bounds().min - origin) * invBinSize;
+		float3 lastBinf = (ref.bounds().max - origin) * invBinSize;
+		int3 firstBin = make_int3((int)firstBinf.x, (int)firstBinf.y, (int)firstBinf.z);
+		int3 lastBin = make_int3((int)lastBinf.x, (int)lastBinf.y, (int)lastBinf.z);
+
+		firstBin = clamp(firstBin, 0, BVHParams::NUM_SPATIAL_BINS - 1);
+		lastBin = clamp(lastBin, firstBin, BVHParams::NUM_SPATIAL_BINS - 1);
+
+		for(int dim = 0; dim < 3; dim++) {
+			BVHReference currRef = ref;
+
+			for(int i = firstBin[dim]; i < lastBin[dim]; i++) {
+				BVHReference leftRef, rightRef;
+
+				split_reference(*builder, leftRef, rightRef, currRef, dim, origin[dim] + binSize[dim] * (float)(i + 1));
+				bins[dim][i].bounds.grow(leftRef.bounds());
+				currRef = rightRef;
+			}
+
+			bins[dim][lastBin[dim]].bounds.grow(currRef.bounds());
+			bins[dim][firstBin[dim]].enter++;
+			bins[dim][lastBin[dim]].exit++;
+		}
+	}
+}
+
+void BVHSpatialSplit::classify_references(int from,
+                                          int to,
+                                          int base,
+                                          char *sides,
+                                          BoundBox *left_bounds,
+                                          BoundBox *right_bounds)
+{
+	const vector<BVHReference>& refs = *references_;
+
+	*left_bounds = BoundBox::empty;
+	*right_bounds = BoundBox::empty;
+
+	for(int i = from; i < to; i++) {
+		const BoundBox& bounds = refs[i].bounds();
+
+		if(bounds.max[this->dim] <= this->pos) {
+			/* entirely on the left-hand side */
+			left_bounds->grow(bounds);
+			sides[i - base] = SPATIAL_SIDE_LEFT;
+		}
+		else if(bounds.min[this->dim] >= this->pos) {
+			/* entirely on the right-hand side */
+			right_bounds->grow(bounds);
+			sides[i - base] = SPATIAL_SIDE_RIGHT;
+		}
+		else {
+			sides[i - base] = SPATIAL_SIDE_BOTH;
+		}
+	}
+}
+
 void BVHSpatialSplit::split(BVHBuild *builder,
                             BVHRange& left,
                             BVHRange& right,
@@ -208,16 +323,66 @@ void BVHSpatialSplit::split(BVHBuild *builder,
 	BoundBox left_bounds = BoundBox::empty;
 	BoundBox right_bounds = BoundBox::empty;
 
-	for(int i = left_end; i < right_start; i++) {
-		if(refs[i].bounds().max[this->dim] <= this->pos) {
-			/* entirely on the left-hand side */
-			left_bounds.grow(refs[i].bounds());
-			swap(refs[i], refs[left_end++]);
+	if(range.size() < SPATIAL_SPLIT_TASK_SIZE || TaskScheduler::num_threads() == 1) {
+		for(int i = left_end; i < right_start; i++) {
+			if(refs[i].bounds().max[this->dim] <= this->pos) {
+				/* entirely on the left-hand side */
+				left_bounds.grow(refs[i].bounds());
+				swap(refs[i], refs[left_end++]);
+			}
+			else if(refs[i].bounds().min[this->dim] >= this->pos) {
+				/* entirely on the right-hand side */
+				right_bounds.grow(refs[i].bounds());
+				swap(refs[i--], refs[--right_start]);
+			}
 		}
-		else if(refs[i].bounds().min[this->dim] >= this->pos) {
-			/* entirely on the right-hand side */
-			right_bounds.grow(refs[i].bounds());
-			swap(refs[i--], refs[--right_start]);
+	}
+	else {
+		/* Classify references and accumulate side bounds in parallel chunks,
+		 * then do the cheap pointer shuffling serially from the precomputed
+		 * sides. The swaps have to move the side flags along to keep them in
+		 * sync with the references.
+		 */
+		const int num_refs = range.size();
+		const int num_tasks = min(TaskScheduler::num_threads(),
+		                          num_refs / (SPATIAL_SPLIT_TASK_SIZE / 4));
+		vector<char>& sides = storage_->sides;
+		vector<BoundBox> task_bounds(num_tasks * 2);
+		TaskPool pool;
+
+		sides.resize(num_refs);
+
+		for(int task = 0; task < num_tasks; task++) {
+			pool.push(function_bind(&BVHSpatialSplit::classify_references,
+			                        this,
+			                        left_start + (int)((int64_t)num_refs * task / num_tasks),
+			                        left_start + (int)((int64_t)num_refs * (task + 1) / num_tasks),
+			                        left_start,
+			                        &sides[0],
+			                        &task_bounds[task * 2],
+			                        &task_bounds[task * 2 + 1]));
+		}
+		pool.wait_work();
+
+		for(int task = 0; task < num_tasks; task++) {
+			left_bounds.grow(task_bounds[task * 2]);
+			right_bounds.grow(task_bounds[task * 2 + 1]);
+		}
+
+		for(int i = left_end; i < right_start; i++) {
+			const char side = sides[i - left_start];
+
+			if(side == SPATIAL_SIDE_LEFT) {
+				swap(refs[i], refs[left_end]);
+				swap(sides[i - left_start], sides[left_end - left_start]);
+				left_end++;
+			}
+			else if(side == SPATIAL_SIDE_RIGHT) {
+				--right_start;
+				swap(refs[i], refs[right_start]);
+				swap(sides[i - left_start], sides[right_start - left_start]);
+				i--;
+			}
 		}
 	}
 
@@ -88,6 +88,24 @@ protected:
 	BVHSpatialStorage *storage_;
 	vector<BVHReference> *references_;
 
+	/* Threaded binning and partitioning helpers. Reference ranges are chopped
+	 * into per-task chunks which only touch their own output, results are
+	 * merged by the caller afterwards.
+	 */
+	void bin_references(const BVHBuild *builder,
+	                    int from,
+	                    int to,
+	                    float3 origin,
+	                    float3 binSize,
+	                    float3 invBinSize,
+	                    BVHSpatialBin (*bins)[BVHParams::NUM_SPATIAL_BINS]);
+	void classify_references(int from,
+	                         int to,
+	                         int base,
+	                         char *sides,
+	                         BoundBox *left_bounds,
+	                         BoundBox *right_bounds);
+
 	/* Lower-level functions which calculates boundaries of left and right nodes
 	 * needed for spatial split.
 	 *
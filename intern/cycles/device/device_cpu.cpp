@@ -48,6 +48,34 @@
 
 CCL_NAMESPACE_BEGIN
 
+/* Pixel traversal order for a tile in Morton (Z) order, so consecutive
+ * camera rays stay spatially coherent and BVH nodes and triangles get
+ * re-used from cache, instead of sweeping full scanlines. Entries are
+ * local pixel indices (x + y*w). */
+static void tile_morton_order(int w, int h, vector<int>& order)
+{
+	order.clear();
+	order.reserve(w*h);
+
+	/* walk a square power of two grid, skip pixels outside the tile */
+	int size = 1;
+	while(size < w || size < h)
+		size <<= 1;
+
+	for(int i = 0; i < size*size; i++) {
+		/* de-interleave the even and odd bits of i into x and y */
+		int x = 0, y = 0;
+
+		for(int b = 0; (i >> (2*b)) != 0; b++) {
+			x |= ((i >> (2*b)) & 1) << b;
+			y |= ((i >> (2*b + 1)) & 1) << b;
+		}
+
+		if(x < w && y < h)
+			order.push_back(x + y*w);
+	}
+}
+
 class CPUDevice : public Device
 {
 public:
@@ -163,7 +191,8 @@ public:
 		                mem.data_height,
 		                mem.data_depth,
 		                interpolation,
-		                extension);
+		                extension,
+		                mem.texture_cache_handle);
 		mem.device_pointer = mem.data_pointer;
 		mem.device_size = mem.memory_size();
 		stats.mem_alloc(mem.device_size);
@@ -257,28 +286,44 @@ public:
 			path_trace_kernel = kernel_cpu_path_trace;
 		}
 		
+		vector<int> pixel_order;
+
 		while(task.acquire_tile(this, tile)) {
 			float *render_buffer = (float*)tile.buffer;
 			uint *rng_state = (uint*)tile.rng_state;
 			int start_sample = tile.start_sample;
 			int end_sample = tile.start_sample + tile.num_samples;
 
+			tile_morton_order(tile.w, tile.h, pixel_order);
+
 			for(int sample = start_sample; sample < end_sample; sample++) {
 				if(task.get_cancel() || task_pool.canceled()) {
 					if(task.need_finish_queue == false)
 						break;
 				}
 
-				for(int y = tile.y; y < tile.y + tile.h; y++) {
-					for(int x = tile.x; x < tile.x + tile.w; x++) {
-						path_trace_kernel(&kg, render_buffer, rng_state,
-						                  sample, x, y, tile.offset, tile.stride);
-					}
+				for(size_t i = 0; i < pixel_order.size(); i++) {
+					int x = tile.x + pixel_order[i] % tile.w;
+					int y = tile.y + pixel_order[i] / tile.w;
+
+					path_trace_kernel(&kg, render_buffer, rng_state,
+					                  sample, x, y, tile.offset, tile.stride);
 				}
 
 				tile.sample = sample + 1;
 
 				task.update_progress(&tile);
+
+				/* adaptive sampling, periodically update the convergence
+				 * mask and stop early once the whole tile converged */
+				if(task.adaptive_step != 0 &&
+				   tile.sample >= task.adaptive_min_samples &&
+				   tile.sample % task.adaptive_step == 0 &&
+				   tile.sample < end_sample)
+				{
+					if(!task.update_adaptive(tile, tile.sample))
+						break;
+				}
 			}
 
 			task.release_tile(tile);
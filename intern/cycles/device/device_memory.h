@@ -175,6 +175,10 @@ public:
 	/* device pointer */
 	device_ptr device_pointer;
 
+	/* CPU texture cache slot this memory is registered with, when image
+	 * pixels are loaded lazily. NULL for ordinary memory. */
+	void *texture_cache_handle;
+
 protected:
 	device_memory() {}
 	virtual ~device_memory() { assert(!device_pointer); }
@@ -203,6 +207,7 @@ public:
 		assert(data_elements > 0);
 
 		device_pointer = 0;
+		texture_cache_handle = NULL;
 	}
 
 	virtual ~device_vector() {}
@@ -35,6 +35,7 @@
 
 #include "buffers.h"
 
+#include "util_algorithm.h"
 #include "util_foreach.h"
 #include "util_list.h"
 #include "util_map.h"
@@ -63,6 +64,167 @@ typedef boost::archive::binary_oarchive o_archive;
 typedef boost::archive::binary_iarchive i_archive;
 #endif
 
+/* Compression of bulk buffer transfers.
+ *
+ * Scene data and render buffers are large and mostly structured data that
+ * compresses well enough with a simple and very fast LZ scheme. The point is
+ * not maximum ratio, but to keep a 10GbE link from being the bottleneck at
+ * scene upload time. The format is an LZ4 style token stream:
+ * [token][literal lengths][literals][offset][match lengths], ending in a
+ * sequence of plain literals. Chunks that do not shrink are stored raw. */
+
+#define NETWORK_CHUNK_SIZE	(1 << 20)
+#define NETWORK_SEND_WINDOW	4
+
+static inline size_t net_compress_bound(size_t size)
+{
+	return size + size/255 + 16;
+}
+
+/* Returns size of compressed data, or 0 if the data did not shrink and
+ * should be stored uncompressed. */
+static inline size_t net_compress(const uint8_t *src, size_t src_size, uint8_t *dst)
+{
+	const int hash_bits = 13;
+	uint32_t hash_table[1 << hash_bits];
+
+	const uint8_t *ip = src;
+	const uint8_t *anchor = src;
+	const uint8_t *iend = src + src_size;
+	const uint8_t *mflimit = (src_size > 12)? iend - 12: src;
+	const uint8_t *matchlimit = iend - 5;
+	uint8_t *op = dst;
+
+	memset(hash_table, 0, sizeof(hash_table));
+
+	while(ip < mflimit) {
+		uint32_t seq, mseq;
+		memcpy(&seq, ip, 4);
+
+		uint32_t h = (seq*2654435761u) >> (32 - hash_bits);
+		const uint8_t *match = src + hash_table[h];
+		hash_table[h] = (uint32_t)(ip - src);
+
+		memcpy(&mseq, match, 4);
+
+		if(match >= ip || mseq != seq || (size_t)(ip - match) > 65535) {
+			ip++;
+			continue;
+		}
+
+		/* extend the match, leaving room for the final literal sequence */
+		const uint8_t *mp = match + 4;
+		const uint8_t *p = ip + 4;
+
+		while(p < matchlimit && *p == *mp) {
+			p++;
+			mp++;
+		}
+
+		size_t literal_len = (size_t)(ip - anchor);
+		size_t match_len = (size_t)(p - ip) - 4; /* biased by 4 byte minimum */
+
+		/* token holds both lengths, 15 means more length bytes follow */
+		*op++ = (uint8_t)((min(literal_len, (size_t)15) << 4) | min(match_len, (size_t)15));
+
+		if(literal_len >= 15) {
+			size_t l = literal_len - 15;
+			for(; l >= 255; l -= 255)
+				*op++ = 255;
+			*op++ = (uint8_t)l;
+		}
+
+		memcpy(op, anchor, literal_len);
+		op += literal_len;
+
+		uint16_t offset = (uint16_t)(ip - match);
+		memcpy(op, &offset, 2);
+		op += 2;
+
+		if(match_len >= 15) {
+			size_t l = match_len - 15;
+			for(; l >= 255; l -= 255)
+				*op++ = 255;
+			*op++ = (uint8_t)l;
+		}
+
+		ip = p;
+		anchor = p;
+
+		/* give up early on incompressible chunks */
+		if((size_t)(op - dst) >= src_size)
+			return 0;
+	}
+
+	/* final literal sequence, without a match after it */
+	size_t literal_len = (size_t)(iend - anchor);
+
+	*op++ = (uint8_t)(min(literal_len, (size_t)15) << 4);
+
+	if(literal_len >= 15) {
+		size_t l = literal_len - 15;
+		for(; l >= 255; l -= 255)
+			*op++ = 255;
+		*op++ = (uint8_t)l;
+	}
+
+	memcpy(op, anchor, literal_len);
+	op += literal_len;
+
+	return ((size_t)(op - dst) < src_size)? (size_t)(op - dst): 0;
+}
+
+static inline void net_decompress(const uint8_t *src, size_t src_size, uint8_t *dst, size_t dst_size)
+{
+	const uint8_t *ip = src, *iend = src + src_size;
+	uint8_t *op = dst, *oend = dst + dst_size;
+
+	while(ip < iend) {
+		uint32_t token = *ip++;
+
+		size_t literal_len = token >> 4;
+		if(literal_len == 15) {
+			uint32_t b;
+			do {
+				b = *ip++;
+				literal_len += b;
+			} while(b == 255 && ip < iend);
+		}
+
+		if(literal_len > (size_t)(oend - op) || literal_len > (size_t)(iend - ip))
+			break;
+
+		memcpy(op, ip, literal_len);
+		ip += literal_len;
+		op += literal_len;
+
+		/* the final literal sequence has no match following it */
+		if(ip >= iend)
+			break;
+
+		uint16_t offset;
+		memcpy(&offset, ip, 2);
+		ip += 2;
+
+		size_t match_len = (token & 15) + 4;
+		if((token & 15) == 15) {
+			uint32_t b;
+			do {
+				b = *ip++;
+				match_len += b;
+			} while(b == 255 && ip < iend);
+		}
+
+		const uint8_t *mp = op - offset;
+		if(mp < dst || match_len > (size_t)(oend - op))
+			break;
+
+		/* byte wise copy, matches may overlap their own output */
+		while(match_len--)
+			*op++ = *mp++;
+	}
+}
+
 /* Serialization of device memory */
 
 class network_device_memory : public device_memory
@@ -175,24 +337,87 @@ public:
 		sent = true;
 	}
 
+	/* Send a bulk buffer as individually compressed chunks. A few chunks are
+	 * kept in flight asynchronously, so compressing the next chunk overlaps
+	 * with the previous ones still going out on the wire, instead of the
+	 * whole transfer blocking on a single synchronous write. */
 	void write_buffer(void *buffer, size_t size)
 	{
-		boost::system::error_code error;
+		if(size == 0)
+			return;
 
-		boost::asio::write(socket,
-			boost::asio::buffer(buffer, size),
-			boost::asio::transfer_all(), error);
-		
+		boost::asio::io_service& io_service = socket.get_io_service();
+
+		if(io_service.stopped())
+			io_service.reset();
+
+		uint8_t *data = (uint8_t*)buffer;
+		size_t offset = 0;
+
+		do {
+			size_t raw_size = min((size_t)NETWORK_CHUNK_SIZE, size - offset);
+
+			/* compress while previously queued chunks are being sent */
+			vector<uint8_t> *chunk = new vector<uint8_t>(8 + net_compress_bound(raw_size));
+			size_t compressed_size = net_compress(data + offset, raw_size, &(*chunk)[8]);
+
+			/* incompressible chunks are stored raw */
+			if(compressed_size == 0) {
+				memcpy(&(*chunk)[8], data + offset, raw_size);
+				compressed_size = raw_size;
+			}
+
+			chunk->resize(8 + compressed_size);
+
+			uint32_t header[2] = {(uint32_t)compressed_size, (uint32_t)raw_size};
+			memcpy(&(*chunk)[0], header, 8);
+
+			/* writes on a stream socket must not overlap, so only the front
+			 * of the queue is in flight and the handler chains to the next */
+			send_queue.push_back(chunk);
+
+			if(send_queue.size() == 1) {
+				boost::asio::async_write(socket,
+					boost::asio::buffer(*chunk),
+					boost::bind(&RPCSend::write_buffer_chunk_done, this,
+					boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
+			}
+
+			/* limit how far compression runs ahead of the socket */
+			while(send_queue.size() >= NETWORK_SEND_WINDOW)
+				io_service.run_one();
+
+			offset += raw_size;
+		} while(offset < size);
+
+		/* drain remaining chunks before reusing the socket for other RPCs */
+		while(!send_queue.empty())
+			io_service.run_one();
+	}
+
+protected:
+	void write_buffer_chunk_done(const boost::system::error_code& error, size_t /*bytes*/)
+	{
 		if(error.value())
 			error_func->network_error(error.message());
+
+		delete send_queue.front();
+		send_queue.pop_front();
+
+		if(!send_queue.empty()) {
+			boost::asio::async_write(socket,
+				boost::asio::buffer(*send_queue.front()),
+				boost::bind(&RPCSend::write_buffer_chunk_done, this,
+				boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
+		}
 	}
 
-protected:
 	string name;
 	tcp::socket& socket;
 	ostringstream archive_stream;
 	o_archive archive;
 	bool sent;
+	std::deque<vector<uint8_t>*> send_queue;
 	NetworkError *error_func;
 };
 
@@ -271,17 +496,52 @@ public:
 		*archive & data;
 	}
 
+	/* Receive a bulk buffer sent by RPCSend::write_buffer as a stream of
+	 * compressed chunks. */
 	void read_buffer(void *buffer, size_t size)
 	{
-		boost::system::error_code error;
-		size_t len = boost::asio::read(socket, boost::asio::buffer(buffer, size), error);
+		uint8_t *data = (uint8_t*)buffer;
+		size_t offset = 0;
+		vector<uint8_t> compressed;
 
-		if(error.value()) {
-			error_func->network_error(error.message());
-		}
+		while(offset < size) {
+			uint32_t header[2];
+			boost::system::error_code error;
+
+			boost::asio::read(socket, boost::asio::buffer(header, 8), error);
+
+			if(error.value()) {
+				error_func->network_error(error.message());
+				return;
+			}
 
-		if(len != size)
-			cout << "Network receive error: buffer size doesn't match expected size\n";
+			size_t compressed_size = header[0];
+			size_t raw_size = header[1];
+
+			if(raw_size == 0 || raw_size > size - offset || compressed_size > raw_size) {
+				error_func->network_error("Network receive error: invalid chunk header");
+				return;
+			}
+
+			if(compressed_size == raw_size) {
+				/* chunk was stored raw */
+				boost::asio::read(socket, boost::asio::buffer(data + offset, raw_size), error);
+			}
+			else {
+				compressed.resize(compressed_size);
+				boost::asio::read(socket, boost::asio::buffer(&compressed[0], compressed_size), error);
+
+				if(!error.value())
+					net_decompress(&compressed[0], compressed_size, data + offset, raw_size);
+			}
+
+			if(error.value()) {
+				error_func->network_error(error.message());
+				return;
+			}
+
+			offset += raw_size;
+		}
 	}
 
 	void read(DeviceTask& task)
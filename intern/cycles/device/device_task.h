@@ -63,9 +63,15 @@ public:
 	function<void(RenderTile&)> update_tile_sample;
 	function<void(RenderTile&)> release_tile;
 	function<bool(void)> get_cancel;
+	/* adaptive sampling, returns false once all pixels in the tile converged */
+	function<bool(RenderTile&, int)> update_adaptive;
 
 	bool need_finish_queue;
 	bool integrator_branched;
+	/* update the adaptive convergence mask every this many samples, zero
+	 * when adaptive sampling is disabled */
+	int adaptive_step;
+	int adaptive_min_samples;
 	int2 requested_tile_size;
 protected:
 	double last_update_time;
@@ -71,12 +71,20 @@ ccl_device_inline int qbvh_node_intersect(KernelGlobals *__restrict kg,
 {
 	const int offset = nodeAddr*BVH_QNODE_SIZE;
 #ifdef __KERNEL_AVX2__
-	const ssef tnear_x = msub(kernel_tex_fetch_ssef(__bvh_nodes, offset+near_x), idir.x, org_idir.x);
-	const ssef tnear_y = msub(kernel_tex_fetch_ssef(__bvh_nodes, offset+near_y), idir.y, org_idir.y);
-	const ssef tnear_z = msub(kernel_tex_fetch_ssef(__bvh_nodes, offset+near_z), idir.z, org_idir.z);
-	const ssef tfar_x = msub(kernel_tex_fetch_ssef(__bvh_nodes, offset+far_x), idir.x, org_idir.x);
-	const ssef tfar_y = msub(kernel_tex_fetch_ssef(__bvh_nodes, offset+far_y), idir.y, org_idir.y);
-	const ssef tfar_z = msub(kernel_tex_fetch_ssef(__bvh_nodes, offset+far_z), idir.z, org_idir.z);
+	/* Each axis keeps its two bounding planes in consecutive float4 slots, so
+	 * one 8-wide fused multiply-subtract resolves both slab distances of all
+	 * four children at once. Plane selection by ray direction sign is loop
+	 * invariant and predicted well.
+	 */
+	const avxf tx = msub(kernel_tex_fetch_avxf(__bvh_nodes, offset+0), avxf(idir.x), avxf(org_idir.x));
+	const avxf ty = msub(kernel_tex_fetch_avxf(__bvh_nodes, offset+2), avxf(idir.y), avxf(org_idir.y));
+	const avxf tz = msub(kernel_tex_fetch_avxf(__bvh_nodes, offset+4), avxf(idir.z), avxf(org_idir.z));
+	const ssef tnear_x = (near_x == 0)? low(tx): high(tx);
+	const ssef tnear_y = (near_y == 2)? low(ty): high(ty);
+	const ssef tnear_z = (near_z == 4)? low(tz): high(tz);
+	const ssef tfar_x = (near_x == 0)? high(tx): low(tx);
+	const ssef tfar_y = (near_y == 2)? high(ty): low(ty);
+	const ssef tfar_z = (near_z == 4)? high(tz): low(tz);
 #else
 	const ssef tnear_x = (kernel_tex_fetch_ssef(__bvh_nodes, offset+near_x) - org.x) * idir.x;
 	const ssef tnear_y = (kernel_tex_fetch_ssef(__bvh_nodes, offset+near_y) - org.y) * idir.y;
@@ -122,12 +130,16 @@ ccl_device_inline int qbvh_node_intersect_robust(KernelGlobals *__restrict kg,
 {
 	const int offset = nodeAddr*BVH_QNODE_SIZE;
 #ifdef __KERNEL_AVX2__
-	const ssef tnear_x = msub(kernel_tex_fetch_ssef(__bvh_nodes, offset+near_x), idir.x, P_idir.x);
-	const ssef tnear_y = msub(kernel_tex_fetch_ssef(__bvh_nodes, offset+near_y), idir.y, P_idir.y);
-	const ssef tnear_z = msub(kernel_tex_fetch_ssef(__bvh_nodes, offset+near_z), idir.z, P_idir.z);
-	const ssef tfar_x = msub(kernel_tex_fetch_ssef(__bvh_nodes, offset+far_x), idir.x, P_idir.x);
-	const ssef tfar_y = msub(kernel_tex_fetch_ssef(__bvh_nodes, offset+far_y), idir.y, P_idir.y);
-	const ssef tfar_z = msub(kernel_tex_fetch_ssef(__bvh_nodes, offset+far_z), idir.z, P_idir.z);
+	/* Same 8-wide slab evaluation as in qbvh_node_intersect() above. */
+	const avxf tx = msub(kernel_tex_fetch_avxf(__bvh_nodes, offset+0), avxf(idir.x), avxf(P_idir.x));
+	const avxf ty = msub(kernel_tex_fetch_avxf(__bvh_nodes, offset+2), avxf(idir.y), avxf(P_idir.y));
+	const avxf tz = msub(kernel_tex_fetch_avxf(__bvh_nodes, offset+4), avxf(idir.z), avxf(P_idir.z));
+	const ssef tnear_x = (near_x == 0)? low(tx): high(tx);
+	const ssef tnear_y = (near_y == 2)? low(ty): high(ty);
+	const ssef tnear_z = (near_z == 4)? low(tz): high(tz);
+	const ssef tfar_x = (near_x == 0)? high(tx): low(tx);
+	const ssef tfar_y = (near_y == 2)? high(ty): low(ty);
+	const ssef tfar_z = (near_z == 4)? high(tz): low(tz);
 #else
 	const ssef tnear_x = (kernel_tex_fetch_ssef(__bvh_nodes, offset+near_x) - P.x) * idir.x;
 	const ssef tnear_y = (kernel_tex_fetch_ssef(__bvh_nodes, offset+near_y) - P.y) * idir.y;
@@ -60,6 +60,13 @@ CCL_NAMESPACE_BEGIN
 
 #define kernel_assert(cond) assert(cond)
 
+/* Lazy loading hook into the CPU texture cache owned by the ImageManager
+ * (render/image.cpp). Only called for image slots that were registered with
+ * a cache handle and have no resident pixels yet; returns the pixel data
+ * for the slot, loading it from disk first if needed, or NULL when loading
+ * failed. */
+void *texture_cache_fetch(void *handle, int *r_width, int *r_height, int *r_depth);
+
 /* Texture types to be compatible with CUDA textures. These are really just
  * simple arrays and after inlining fetch hopefully revert to being a simple
  * pointer lookup. */
@@ -85,6 +92,17 @@ template<typename T> struct texture  {
 	}
 #endif
 
+#ifdef __KERNEL_AVX__
+	/* Fetches two consecutive float4 elements, index is in float4 units.
+	 * Data is only guaranteed to be 16 bytes aligned, hence unaligned load.
+	 */
+	ccl_always_inline avxf fetch_avxf(int index)
+	{
+		kernel_assert(index >= 0 && index + 1 < width);
+		return avxf::loadu((float*)data + index*4);
+	}
+#endif
+
 	T *data;
 	int width;
 };
@@ -144,8 +162,10 @@ template<typename T> struct texture_image  {
 
 	ccl_always_inline float4 interp(float x, float y)
 	{
-		if(UNLIKELY(!data))
-			return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+		if(UNLIKELY(!data)) {
+			if(!cache_handle || !fetch_cached())
+				return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+		}
 
 		int ix, iy, nix, niy;
 
@@ -285,8 +305,10 @@ template<typename T> struct texture_image  {
 	ccl_always_inline float4 interp_3d_ex(float x, float y, float z,
 	                                      int interpolation = INTERPOLATION_LINEAR)
 	{
-		if(UNLIKELY(!data))
-			return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+		if(UNLIKELY(!data)) {
+			if(!cache_handle || !fetch_cached())
+				return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+		}
 
 		int ix, iy, iz, nix, niy, niz;
 
@@ -470,7 +492,19 @@ template<typename T> struct texture_image  {
 		depth = depth_;
 	}
 
+	/* Fault a non-resident image in through the texture cache. Note that each
+	 * rendering thread works on its own copy of KernelGlobals, so this only
+	 * fills in the thread local slot and the cache stays in charge of the
+	 * pixel data itself. */
+	bool fetch_cached()
+	{
+		void *cache_data = texture_cache_fetch(cache_handle, &width, &height, &depth);
+		data = (T*)cache_data;
+		return cache_data != NULL;
+	}
+
 	T *data;
+	void *cache_handle;
 	int interpolation;
 	ExtensionType extension;
 	int width, height, depth;
@@ -494,6 +528,7 @@ typedef texture_image<uchar4> texture_image_uchar4;
 #define kernel_tex_fetch(tex, index) (kg->tex.fetch(index))
 #define kernel_tex_fetch_ssef(tex, index) (kg->tex.fetch_ssef(index))
 #define kernel_tex_fetch_ssei(tex, index) (kg->tex.fetch_ssei(index))
+#define kernel_tex_fetch_avxf(tex, index) (kg->tex.fetch_avxf(index))
 #define kernel_tex_lookup(tex, t, offset, size) (kg->tex.lookup(t, offset, size))
 
 #define kernel_tex_image_interp(tex, x, y) \
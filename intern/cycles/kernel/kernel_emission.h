@@ -187,6 +187,16 @@ ccl_device_noinline float3 indirect_primitive_emission(KernelGlobals *kg, Shader
 		/* multiple importance sampling, get triangle light pdf,
 		 * and compute weight with respect to BSDF pdf */
 		float pdf = triangle_light_pdf(kg, ccl_fetch(sd, Ng), ccl_fetch(sd, I), t);
+
+		/* scale the flat selection probability by the tree's, from the
+		 * point the ray was traced from */
+		if(kernel_data.integrator.use_light_tree) {
+			float3 ray_P = ccl_fetch(sd, P) + ccl_fetch(sd, I)*t;
+			pdf *= light_tree_triangle_factor(kg, ray_P,
+			                                  ccl_fetch(sd, object),
+			                                  ccl_fetch(sd, prim));
+		}
+
 		float mis_weight = power_heuristic(bsdf_pdf, pdf);
 
 		return L*mis_weight;
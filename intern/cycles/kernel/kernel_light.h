@@ -33,6 +33,201 @@ typedef struct LightSample {
 	LightType type;		/* type of light */
 } LightSample;
 
+/* Light Tree
+ *
+ * Binary clustering over the light distribution. Instead of picking emitters
+ * from the flat area weighted cdf, we descend the tree and at each node pick
+ * a child with probability proportional to its importance for the shading
+ * point, driven by cluster energy, distance and orientation. Within a leaf,
+ * emitters keep their flat cdf weights, so the scale between the tree and
+ * flat selection probability is the descent probability divided by the
+ * leaf's share of the flat cdf. */
+
+ccl_device_inline float light_tree_cdf_range(KernelGlobals *kg, int index)
+{
+	return kernel_tex_fetch(__light_distribution, index + 1).x -
+	       kernel_tex_fetch(__light_distribution, index).x;
+}
+
+ccl_device float light_tree_cluster_importance(KernelGlobals *kg, float3 P, int node)
+{
+	float4 n0 = kernel_tex_fetch(__light_tree_nodes, node*LIGHT_TREE_NODE_SIZE + 0);
+	float4 n1 = kernel_tex_fetch(__light_tree_nodes, node*LIGHT_TREE_NODE_SIZE + 1);
+	float4 n2 = kernel_tex_fetch(__light_tree_nodes, node*LIGHT_TREE_NODE_SIZE + 2);
+
+	float3 bbox_min = make_float3(n0.x, n0.y, n0.z);
+	float3 bbox_max = make_float3(n1.x, n1.y, n1.z);
+	float energy = n0.w;
+
+	float3 center = 0.5f*(bbox_min + bbox_max);
+	float radius = 0.5f*len(bbox_max - bbox_min);
+
+	/* clamp the squared distance so clusters containing P stay finite */
+	float3 d = center - P;
+	float dist2 = max(dot(d, d), 0.25f*radius*radius + 1e-4f);
+
+	/* facing term from the cluster's mean emitter orientation, clusters
+	 * with omnidirectional emitters store a zero axis. mesh emitters are
+	 * two sided, so use the absolute cosine, and widen the term by the
+	 * cluster's orientation spread */
+	float3 axis = make_float3(n2.x, n2.y, n2.z);
+	float facing = 1.0f;
+
+	if(!is_zero(axis)) {
+		float cos_spread = n2.w;
+		facing = clamp(fabsf(dot(axis, d))/sqrtf(dist2) + (1.0f - cos_spread),
+		               0.1f, 1.0f);
+	}
+
+	return energy*facing/dist2;
+}
+
+/* Sample an index into the light distribution through stochastic tree
+ * descent. Returns the ratio between the tree and flat selection
+ * probability in tree_factor, zero when nothing can be sampled. */
+ccl_device int light_tree_sample_distribution(KernelGlobals *kg,
+                                              float randt,
+                                              float3 P,
+                                              float *tree_factor)
+{
+	int node = 0;
+	float pdf = 1.0f;
+
+	for(;;) {
+		float4 n3 = kernel_tex_fetch(__light_tree_nodes, node*LIGHT_TREE_NODE_SIZE + 3);
+
+		if(__float_as_int(n3.z)) {
+			/* leaf, pick an emitter proportional to its flat cdf range */
+			int first = __float_as_int(n3.x);
+			int num = __float_as_int(n3.y);
+
+			float sum = 0.0f;
+			for(int i = 0; i < num; i++)
+				sum += light_tree_cdf_range(kg, kernel_tex_fetch(__light_tree_order, first + i));
+
+			if(sum == 0.0f) {
+				*tree_factor = 0.0f;
+				return 0;
+			}
+
+			int index = kernel_tex_fetch(__light_tree_order, first + num - 1);
+			float r = randt*sum;
+
+			for(int i = 0; i < num - 1; i++) {
+				int candidate = kernel_tex_fetch(__light_tree_order, first + i);
+				r -= light_tree_cdf_range(kg, candidate);
+
+				if(r <= 0.0f) {
+					index = candidate;
+					break;
+				}
+			}
+
+			/* the emitter's own cdf range cancels against the flat pdf */
+			*tree_factor = pdf/sum;
+			return index;
+		}
+
+		int left = __float_as_int(n3.x);
+		int right = __float_as_int(n3.y);
+
+		float imp_left = light_tree_cluster_importance(kg, P, left);
+		float imp_right = light_tree_cluster_importance(kg, P, right);
+		float total = imp_left + imp_right;
+
+		float prob_left = (total > 0.0f)? imp_left/total: 0.5f;
+
+		if(randt < prob_left) {
+			node = left;
+			randt = randt/prob_left;
+			pdf *= prob_left;
+		}
+		else {
+			node = right;
+			randt = (randt - prob_left)/(1.0f - prob_left);
+			pdf *= 1.0f - prob_left;
+		}
+	}
+}
+
+/* Probability scale for an emitter in a known leaf, relative to the flat
+ * cdf. Walks the tree upwards mirroring the descent probabilities, used to
+ * correct the forward pdf for multiple importance sampling. */
+ccl_device float light_tree_pdf_factor(KernelGlobals *kg, float3 P, int leaf)
+{
+	float4 n3 = kernel_tex_fetch(__light_tree_nodes, leaf*LIGHT_TREE_NODE_SIZE + 3);
+	int first = __float_as_int(n3.x);
+	int num = __float_as_int(n3.y);
+
+	float sum = 0.0f;
+	for(int i = 0; i < num; i++)
+		sum += light_tree_cdf_range(kg, kernel_tex_fetch(__light_tree_order, first + i));
+
+	if(sum == 0.0f)
+		return 0.0f;
+
+	float pdf = 1.0f;
+	int node = leaf;
+
+	for(;;) {
+		float4 n1 = kernel_tex_fetch(__light_tree_nodes, node*LIGHT_TREE_NODE_SIZE + 1);
+		int parent = __float_as_int(n1.w);
+
+		if(parent == -1)
+			break;
+
+		float4 p3 = kernel_tex_fetch(__light_tree_nodes, parent*LIGHT_TREE_NODE_SIZE + 3);
+		int left = __float_as_int(p3.x);
+		int right = __float_as_int(p3.y);
+
+		float imp_left = light_tree_cluster_importance(kg, P, left);
+		float imp_right = light_tree_cluster_importance(kg, P, right);
+		float total = imp_left + imp_right;
+
+		float prob_left = (total > 0.0f)? imp_left/total: 0.5f;
+
+		pdf *= (node == left)? prob_left: 1.0f - prob_left;
+		node = parent;
+	}
+
+	return pdf/sum;
+}
+
+/* Forward pdf scale for an emissive triangle hit by BSDF sampling, P is the
+ * point the ray was traced from. */
+ccl_device float light_tree_triangle_factor(KernelGlobals *kg, float3 P, int object, int prim)
+{
+	/* binary search the emissive triangle table, sorted by object and prim */
+	int first = 0;
+	int len = kernel_data.integrator.num_distribution -
+	          kernel_data.integrator.num_all_lights;
+	int num = len;
+
+	while(len > 0) {
+		int half_len = len >> 1;
+		int middle = first + half_len;
+		uint4 entry = kernel_tex_fetch(__light_tree_triangles, middle);
+
+		if((int)entry.x < object || ((int)entry.x == object && (int)entry.y < prim)) {
+			first = middle + 1;
+			len = len - half_len - 1;
+		}
+		else {
+			len = half_len;
+		}
+	}
+
+	if(first == num)
+		return 1.0f;
+
+	uint4 entry = kernel_tex_fetch(__light_tree_triangles, first);
+
+	if((int)entry.x != object || (int)entry.y != prim)
+		return 1.0f;
+
+	return light_tree_pdf_factor(kg, P, (int)entry.z);
+}
+
 /* Area light sampling */
 
 /* Uses the following paper:
@@ -435,6 +630,16 @@ ccl_device float3 background_light_sample(KernelGlobals *kg, float3 P, float ran
 
 ccl_device float background_light_pdf(KernelGlobals *kg, float3 P, float3 direction)
 {
+	float pdf_lights = kernel_data.integrator.pdf_lights;
+
+	/* scale the flat selection probability by the tree's */
+	if(kernel_data.integrator.use_light_tree &&
+	   kernel_data.integrator.light_tree_background_leaf != -1)
+	{
+		pdf_lights *= light_tree_pdf_factor(kg, P,
+		                                    kernel_data.integrator.light_tree_background_leaf);
+	}
+
 	/* Probability of sampling portals instead of the map. */
 	float portal_sampling_pdf = kernel_data.integrator.portal_pdf;
 
@@ -447,7 +652,7 @@ ccl_device float background_light_pdf(KernelGlobals *kg, float3 P, float3 direct
 			/* Portal sampling is not possible here because all portals point to the wrong side.
 			 * If map sampling is possible, it would be used instead, otherwise fallback sampling is used. */
 			if(portal_sampling_pdf == 1.0f) {
-				return kernel_data.integrator.pdf_lights / M_4PI_F;
+				return pdf_lights / M_4PI_F;
 			}
 			else {
 				/* Force map sampling. */
@@ -459,7 +664,7 @@ ccl_device float background_light_pdf(KernelGlobals *kg, float3 P, float3 direct
 		/* Evaluate PDF of sampling this direction by map sampling. */
 		map_pdf = background_map_pdf(kg, direction) * (1.0f - portal_sampling_pdf);
 	}
-	return (portal_pdf + map_pdf) * kernel_data.integrator.pdf_lights;
+	return (portal_pdf + map_pdf) * pdf_lights;
 }
 #endif
 
@@ -851,7 +1056,20 @@ ccl_device_noinline void light_sample(KernelGlobals *kg,
                                       LightSample *ls)
 {
 	/* sample index */
-	int index = light_distribution_sample(kg, randt);
+	int index;
+	float tree_factor = 1.0f;
+
+	if(kernel_data.integrator.use_light_tree) {
+		index = light_tree_sample_distribution(kg, randt, P, &tree_factor);
+
+		if(tree_factor == 0.0f) {
+			ls->pdf = 0.0f;
+			return;
+		}
+	}
+	else {
+		index = light_distribution_sample(kg, randt);
+	}
 
 	/* fetch light data */
 	float4 l = kernel_tex_fetch(__light_distribution, index);
@@ -865,7 +1083,7 @@ ccl_device_noinline void light_sample(KernelGlobals *kg,
 
 		/* compute incoming direction, distance and pdf */
 		ls->D = normalize_len(ls->P - P, &ls->t);
-		ls->pdf = triangle_light_pdf(kg, ls->Ng, -ls->D, ls->t);
+		ls->pdf = triangle_light_pdf(kg, ls->Ng, -ls->D, ls->t)*tree_factor;
 		ls->shader |= shader_flag;
 	}
 	else {
@@ -877,6 +1095,16 @@ ccl_device_noinline void light_sample(KernelGlobals *kg,
 		}
 
 		lamp_light_sample(kg, lamp, randu, randv, P, ls);
+
+		/* scale the flat selection probability by the tree's. the background
+		 * folds selection into the pdf, other lamps fold the inverse into
+		 * the intensity */
+		if(tree_factor != 1.0f) {
+			if(ls->type == LIGHT_BACKGROUND)
+				ls->pdf *= tree_factor;
+			else
+				ls->eval_fac /= tree_factor;
+		}
 	}
 }
 
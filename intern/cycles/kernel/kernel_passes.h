@@ -60,6 +60,39 @@ ccl_device_inline void kernel_write_pass_float4(ccl_global float *buffer, int sa
 #endif // __SPLIT_KERNEL__ && __WORK_STEALING__
 }
 
+/* Adaptive sampling. When a pixel has been marked as converged by the host,
+ * we stop tracing paths for it, but keep adding its current mean to the
+ * accumulation buffer. That way all pixels stay uniformly scaled by the
+ * number of samples and none of the film convert or pass reading code needs
+ * to know about per-pixel sample counts. */
+ccl_device_inline bool kernel_adaptive_skip(KernelGlobals *kg, ccl_global float *buffer, int sample)
+{
+	if(!(kernel_data.film.pass_flag & PASS_ADAPTIVE))
+		return false;
+
+	if(buffer[kernel_data.film.pass_adaptive] == 0.0f)
+		return false;
+
+	/* Scale accumulated result as if one more sample with the current mean
+	 * value was added, for all passes. The convergence mask itself is left
+	 * untouched so it keeps its host written value. */
+	float scale = (float)(sample + 1)/(float)sample;
+
+	for(int i = 0; i < kernel_data.film.pass_stride; i++)
+		if(i != kernel_data.film.pass_adaptive)
+			buffer[i] *= scale;
+
+	return true;
+}
+
+ccl_device_inline void kernel_write_variance_pass(KernelGlobals *kg, ccl_global float *buffer, int sample, float4 L)
+{
+	if(kernel_data.film.pass_flag & PASS_VARIANCE) {
+		float lum = average(float4_to_float3(L));
+		kernel_write_pass_float(buffer + kernel_data.film.pass_variance, sample, lum*lum);
+	}
+}
+
 ccl_device_inline void kernel_write_data_passes(KernelGlobals *kg, ccl_global float *buffer, PathRadiance *L,
 	ShaderData *sd, int sample, ccl_addr_space PathState *state, float3 throughput)
 {
@@ -143,6 +143,10 @@ ccl_device void kernel_path_indirect(KernelGlobals *kg,
 				if(volume_segment.closure_flag & SD_SCATTER) {
 					int all = kernel_data.integrator.sample_all_lights_indirect;
 
+					/* reuse shader evaluations between scatter samples that
+					 * land in the same step of the segment */
+					float volume_shade_t = -1.0f;
+
 					/* direct light sampling */
 					kernel_branched_path_volume_connect_light(kg,
 					                                          rng,
@@ -152,7 +156,8 @@ ccl_device void kernel_path_indirect(KernelGlobals *kg,
 					                                          L,
 					                                          all,
 					                                          &volume_ray,
-					                                          &volume_segment);
+					                                          &volume_segment,
+					                                          &volume_shade_t);
 
 					/* indirect sample. if we use distance sampling and take just
 					 * one sample for direct and indirect light, we could share
@@ -169,7 +174,8 @@ ccl_device void kernel_path_indirect(KernelGlobals *kg,
 					                                         rscatter,
 					                                         &volume_segment,
 					                                         NULL,
-					                                         true);
+					                                         true,
+					                                         &volume_shade_t);
 				}
 
 				/* free cached steps */
@@ -707,9 +713,14 @@ ccl_device_inline float4 kernel_path_integrate(KernelGlobals *kg,
 				if(volume_segment.closure_flag & SD_SCATTER) {
 					int all = false;
 
+					/* reuse shader evaluations between scatter samples that
+					 * land in the same step of the segment */
+					float volume_shade_t = -1.0f;
+
 					/* direct light sampling */
 					kernel_branched_path_volume_connect_light(kg, rng, &volume_sd,
-						throughput, &state, &L, all, &volume_ray, &volume_segment);
+						throughput, &state, &L, all, &volume_ray, &volume_segment,
+						&volume_shade_t);
 
 					/* indirect sample. if we use distance sampling and take just
 					 * one sample for direct and indirect light, we could share
@@ -719,7 +730,8 @@ ccl_device_inline float4 kernel_path_integrate(KernelGlobals *kg,
 
 					result = kernel_volume_decoupled_scatter(kg,
 						&state, &volume_ray, &volume_sd, &throughput,
-						rphase, rscatter, &volume_segment, NULL, true);
+						rphase, rscatter, &volume_segment, NULL, true,
+						&volume_shade_t);
 				}
 
 				/* free cached steps */
@@ -920,6 +932,10 @@ ccl_device void kernel_path_trace(KernelGlobals *kg,
 	rng_state += index;
 	buffer += index*pass_stride;
 
+	/* adaptive sampling, skip pixels that the host marked as converged */
+	if(kernel_adaptive_skip(kg, buffer, sample))
+		return;
+
 	/* initialize random numbers and ray */
 	RNG rng;
 	Ray ray;
@@ -936,6 +952,7 @@ ccl_device void kernel_path_trace(KernelGlobals *kg,
 
 	/* accumulate result in output buffer */
 	kernel_write_pass_float4(buffer, sample, L);
+	kernel_write_variance_pass(kg, buffer, sample, L);
 
 	path_rng_end(kg, rng_state, rng);
 }
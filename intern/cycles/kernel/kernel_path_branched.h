@@ -299,8 +299,13 @@ ccl_device float4 kernel_branched_path_integrate(KernelGlobals *kg, RNG *rng, in
 
 				int all = kernel_data.integrator.sample_all_lights_direct;
 
+				/* reuse shader evaluations between scatter samples that
+				 * land in the same step of the segment */
+				float volume_shade_t = -1.0f;
+
 				kernel_branched_path_volume_connect_light(kg, rng, &volume_sd,
-					throughput, &state, &L, all, &volume_ray, &volume_segment);
+					throughput, &state, &L, all, &volume_ray, &volume_segment,
+					&volume_shade_t);
 
 				/* indirect light sampling */
 				int num_samples = kernel_data.integrator.volume_samples;
@@ -326,7 +331,8 @@ ccl_device float4 kernel_branched_path_integrate(KernelGlobals *kg, RNG *rng, in
 					float rscatter = path_state_rng_1D_for_decision(kg, &tmp_rng, &ps, PRNG_SCATTER_DISTANCE);
 
 					VolumeIntegrateResult result = kernel_volume_decoupled_scatter(kg,
-						&ps, &pray, &volume_sd, &tp, rphase, rscatter, &volume_segment, NULL, false);
+						&ps, &pray, &volume_sd, &tp, rphase, rscatter, &volume_segment, NULL, false,
+						&volume_shade_t);
 
 					(void)result;
 					kernel_assert(result == VOLUME_PATH_SCATTERED);
@@ -576,6 +582,10 @@ ccl_device void kernel_branched_path_trace(KernelGlobals *kg,
 	rng_state += index;
 	buffer += index*pass_stride;
 
+	/* adaptive sampling, skip pixels that the host marked as converged */
+	if(kernel_adaptive_skip(kg, buffer, sample))
+		return;
+
 	/* initialize random numbers and ray */
 	RNG rng;
 	Ray ray;
@@ -592,6 +602,7 @@ ccl_device void kernel_branched_path_trace(KernelGlobals *kg,
 
 	/* accumulate result in output buffer */
 	kernel_write_pass_float4(buffer, sample, L);
+	kernel_write_variance_pass(kg, buffer, sample, L);
 
 	path_rng_end(kg, rng_state, rng);
 }
@@ -57,6 +57,9 @@ KERNEL_TEX(float4, texture_float4, __light_distribution)
 KERNEL_TEX(float4, texture_float4, __light_data)
 KERNEL_TEX(float2, texture_float2, __light_background_marginal_cdf)
 KERNEL_TEX(float2, texture_float2, __light_background_conditional_cdf)
+KERNEL_TEX(float4, texture_float4, __light_tree_nodes)
+KERNEL_TEX(uint, texture_uint, __light_tree_order)
+KERNEL_TEX(uint4, texture_uint4, __light_tree_triangles)
 
 /* particles */
 KERNEL_TEX(float4, texture_float4, __particles)
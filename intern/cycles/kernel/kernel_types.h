@@ -37,6 +37,7 @@ CCL_NAMESPACE_BEGIN
 #define OBJECT_SIZE 		11
 #define OBJECT_VECTOR_SIZE	6
 #define LIGHT_SIZE			5
+#define LIGHT_TREE_NODE_SIZE	4
 #define FILTER_TABLE_SIZE	1024
 #define RAMP_TABLE_SIZE		256
 #define SHUTTER_TABLE_SIZE		256
@@ -356,6 +357,8 @@ typedef enum PassType {
 	PASS_BVH_TRAVERSED_INSTANCES = (1 << 27),
 	PASS_RAY_BOUNCES = (1 << 28),
 #endif
+	PASS_VARIANCE = (1 << 29), /* adaptive sampling, squared luminance */
+	PASS_ADAPTIVE = (1 << 30), /* adaptive sampling, convergence mask */
 } PassType;
 
 #define PASS_ALL (~0)
@@ -1014,18 +1017,23 @@ typedef struct KernelFilm {
 	int pass_shadow;
 	float pass_shadow_scale;
 	int filter_table_offset;
-	int pass_pad2;
+	int pass_variance;
 
 	int pass_mist;
 	float mist_start;
 	float mist_inv_depth;
 	float mist_falloff;
 
+	int pass_adaptive;
+	int pass_pad1;
+	int pass_pad2;
+	int pass_pad3;
+
 #ifdef __KERNEL_DEBUG__
 	int pass_bvh_traversal_steps;
 	int pass_bvh_traversed_instances;
 	int pass_ray_bounces;
-	int pass_pad3;
+	int pass_pad4;
 #endif
 } KernelFilm;
 
@@ -1058,6 +1066,10 @@ typedef struct KernelIntegrator {
 	int num_portals;
 	int portal_offset;
 
+	/* light tree */
+	int use_light_tree;
+	int light_tree_background_leaf;
+
 	/* bounces */
 	int min_bounce;
 	int max_bounce;
@@ -1111,7 +1123,7 @@ typedef struct KernelIntegrator {
 	float volume_step_size;
 	int volume_samples;
 
-	int pad;
+	int pad1, pad2, pad3;
 } KernelIntegrator;
 
 typedef struct KernelBVH {
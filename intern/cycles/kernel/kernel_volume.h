@@ -752,11 +752,16 @@ ccl_device void kernel_volume_decoupled_free(KernelGlobals *kg, VolumeSegment *s
 /* scattering for homogeneous and heterogeneous volumes, using decoupled ray
  * marching.
  *
+ * shade_t_cache may point to a float shared between scatter calls on the same
+ * segment and shader data, to skip re-evaluating the shader when consecutive
+ * samples land in the same step. pass NULL for a single scatter call.
+ *
  * function is expected to return VOLUME_PATH_SCATTERED when probalistic_scatter is false */
 ccl_device VolumeIntegrateResult kernel_volume_decoupled_scatter(
 	KernelGlobals *kg, PathState *state, Ray *ray, ShaderData *sd,
 	float3 *throughput, float rphase, float rscatter,
-	const VolumeSegment *segment, const float3 *light_P, bool probalistic_scatter)
+	const VolumeSegment *segment, const float3 *light_P, bool probalistic_scatter,
+	float *shade_t_cache)
 {
 	kernel_assert(segment->closure_flag & SD_SCATTER);
 
@@ -925,12 +930,20 @@ ccl_device VolumeIntegrateResult kernel_volume_decoupled_scatter(
 	/* modify throughput */
 	*throughput *= step->sigma_s * transmittance * (mis_weight / pdf);
 
-	/* evaluate shader to create closures at shading point */
+	/* evaluate shader to create closures at shading point. the recording
+	 * jittered one shading point per step, so when a previous scatter sample
+	 * on this segment already shaded the same step, the closures in sd are
+	 * still valid and the evaluation can be skipped */
 	if(segment->numsteps > 1) {
-		sd->P = ray->P + step->shade_t*ray->D;
+		if(!(shade_t_cache && *shade_t_cache == step->shade_t)) {
+			sd->P = ray->P + step->shade_t*ray->D;
 
-		VolumeShaderCoefficients coeff;
-		volume_shader_sample(kg, sd, state, sd->P, &coeff);
+			VolumeShaderCoefficients coeff;
+			volume_shader_sample(kg, sd, state, sd->P, &coeff);
+
+			if(shade_t_cache)
+				*shade_t_cache = step->shade_t;
+		}
 	}
 
 	/* move to new position */
@@ -315,6 +315,70 @@ bool RenderBuffers::get_pass_rect(PassType type, float exposure, int sample, int
 	return false;
 }
 
+/* Adaptive sampling. Mark pixels in the given tile rect whose estimated
+ * sampling error dropped below the threshold, so the kernels stop tracing
+ * paths for them. This works on host side memory, which for the CPU device
+ * is the same memory the kernels accumulate into. Returns true as long as
+ * any pixel in the rect is still active. */
+bool RenderBuffers::update_adaptive_mask(int x, int y, int w, int h, int offset, int stride, int sample, float threshold)
+{
+	int pass_offset_combined = -1;
+	int pass_offset_variance = -1;
+	int pass_offset_adaptive = -1;
+	int pass_offset = 0;
+
+	foreach(Pass& pass, params.passes) {
+		if(pass.type == PASS_COMBINED)
+			pass_offset_combined = pass_offset;
+		else if(pass.type == PASS_VARIANCE)
+			pass_offset_variance = pass_offset;
+		else if(pass.type == PASS_ADAPTIVE)
+			pass_offset_adaptive = pass_offset;
+
+		pass_offset += pass.components;
+	}
+
+	if(pass_offset_combined == -1 ||
+	   pass_offset_variance == -1 ||
+	   pass_offset_adaptive == -1 ||
+	   sample < 2)
+	{
+		return true;
+	}
+
+	int pass_stride = params.get_passes_size();
+	float *data = (float*)buffer.data_pointer;
+	float n = (float)sample;
+	bool any_active = false;
+
+	for(int py = y; py < y + h; py++) {
+		for(int px = x; px < x + w; px++) {
+			float *buf = data + (offset + px + py*stride)*pass_stride;
+
+			if(buf[pass_offset_adaptive] != 0.0f)
+				continue;
+
+			/* combined pass holds the per sample radiance sum, the variance
+			 * pass the sum of squared per sample luminance */
+			float sum = average(make_float3(buf[pass_offset_combined],
+			                                buf[pass_offset_combined + 1],
+			                                buf[pass_offset_combined + 2]));
+			float var = (buf[pass_offset_variance] - sum*sum/n)/(n - 1.0f);
+
+			/* standard error of the mean, compared against the mean so that
+			 * brighter pixels are allowed proportionally more absolute noise */
+			float error = sqrtf(max(var, 0.0f)/n);
+
+			if(error <= threshold*(sum/n + 0.0001f))
+				buf[pass_offset_adaptive] = 1.0f;
+			else
+				any_active = true;
+		}
+	}
+
+	return any_active;
+}
+
 /* Display Buffer */
 
 DisplayBuffer::DisplayBuffer(Device *device_, bool linear)
@@ -80,6 +80,7 @@ public:
 
 	bool copy_from_device();
 	bool get_pass_rect(PassType type, float exposure, int sample, int components, float *pixels);
+	bool update_adaptive_mask(int x, int y, int w, int h, int offset, int stride, int sample, float threshold);
 
 protected:
 	void device_free();
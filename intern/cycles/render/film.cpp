@@ -153,6 +153,16 @@ void Pass::add(PassType type, vector<Pass>& passes)
 			 */
 			pass.components = 0;
 			break;
+		case PASS_VARIANCE:
+			pass.components = 1;
+			pass.exposure = false;
+			break;
+		case PASS_ADAPTIVE:
+			/* Convergence mask, written by the host and only read by the
+			 * kernel, so should never be filtered or scaled. */
+			pass.components = 1;
+			pass.filter = false;
+			break;
 #ifdef WITH_CYCLES_DEBUG
 		case PASS_BVH_TRAVERSAL_STEPS:
 			pass.components = 1;
@@ -404,6 +414,13 @@ void Film::device_update(Device *device, DeviceScene *dscene, Scene *scene)
 				kfilm->use_light_pass = 1;
 				break;
 
+			case PASS_VARIANCE:
+				kfilm->pass_variance = kfilm->pass_stride;
+				break;
+			case PASS_ADAPTIVE:
+				kfilm->pass_adaptive = kfilm->pass_stride;
+				break;
+
 #ifdef WITH_CYCLES_DEBUG
 			case PASS_BVH_TRAVERSAL_STEPS:
 				kfilm->pass_bvh_traversal_steps = kfilm->pass_stride;
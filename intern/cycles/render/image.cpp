@@ -19,6 +19,7 @@
 #include "scene.h"
 
 #include "util_foreach.h"
+#include "util_logging.h"
 #include "util_path.h"
 #include "util_progress.h"
 #include "util_texture.h"
@@ -36,6 +37,13 @@ ImageManager::ImageManager(const DeviceInfo& info)
 	osl_texture_system = NULL;
 	animation_frame = 0;
 
+	/* Lazy loading of images into a fixed size cache is only supported on
+	 * the CPU device, other devices cannot fault images in mid render. */
+	texture_cache_supported = (info.type == DEVICE_CPU);
+	texture_cache_size = 0;
+	texture_cache_used = 0;
+	texture_cache_clock = 0;
+
 	/* Set image limits */
 
 	/* CPU */
@@ -109,6 +117,25 @@ void ImageManager::set_osl_texture_system(void *texture_system)
 	osl_texture_system = texture_system;
 }
 
+void ImageManager::set_texture_cache_size(size_t size)
+{
+	if(texture_cache_size == size)
+		return;
+
+	texture_cache_size = size;
+
+	/* Tag all images for reload, so they switch between eager and lazy
+	 * loading as needed on the next device update. */
+	for(int type = 0; type < IMAGE_DATA_NUM_TYPES; type++) {
+		for(size_t slot = 0; slot < images[type].size(); slot++) {
+			if(images[type][slot])
+				images[type][slot]->need_load = true;
+		}
+	}
+
+	need_update = true;
+}
+
 bool ImageManager::set_animation_frame_update(int frame)
 {
 	if(frame != animation_frame) {
@@ -265,6 +292,18 @@ string ImageManager::name_from_type(int type)
 		return "byte4";
 }
 
+string ImageManager::name_from_slot(ImageDataType type, int slot)
+{
+	int flat_slot = type_index_to_flattened_slot(slot, type);
+
+	if(flat_slot >= 100)
+		return string_printf("__tex_image_%s_%d", name_from_type(type).c_str(), flat_slot);
+	else if(flat_slot >= 10)
+		return string_printf("__tex_image_%s_0%d", name_from_type(type).c_str(), flat_slot);
+	else
+		return string_printf("__tex_image_%s_00%d", name_from_type(type).c_str(), flat_slot);
+}
+
 static bool image_equals(ImageManager::Image *image,
                          const string& filename,
                          void *builtin_data,
@@ -302,6 +341,8 @@ int ImageManager::add_image(const string& filename,
 	if(type == IMAGE_DATA_TYPE_BYTE && tex_num_images[type] == 0)
 		type = IMAGE_DATA_TYPE_BYTE4;
 
+	thread_scoped_lock images_lock(images_mutex);
+
 	/* Fnd existing image. */
 	for(slot = 0; slot < images[type].size(); slot++) {
 		img = images[type][slot];
@@ -362,6 +403,8 @@ int ImageManager::add_image(const string& filename,
 
 void ImageManager::remove_image(int flat_slot)
 {
+	thread_scoped_lock images_lock(images_mutex);
+
 	ImageDataType type;
 	int slot = flattened_slot_to_type_index(flat_slot, &type);
 
@@ -384,20 +427,30 @@ void ImageManager::remove_image(const string& filename,
                                 ExtensionType extension)
 {
 	size_t slot;
+	int flat_slot = -1;
 
-	for(int type = 0; type < IMAGE_DATA_NUM_TYPES; type++) {
-		for(slot = 0; slot < images[type].size(); slot++) {
-			if(images[type][slot] && image_equals(images[type][slot],
-		                                          filename,
-		                                          builtin_data,
-		                                          interpolation,
-		                                          extension))
-			{
-				remove_image(type_index_to_flattened_slot(slot, (ImageDataType)type));
-				return;
+	/* find the slot under the lock, but remove through the public function
+	 * so we do not lock the mutex recursively */
+	{
+		thread_scoped_lock images_lock(images_mutex);
+
+		for(int type = 0; type < IMAGE_DATA_NUM_TYPES && flat_slot == -1; type++) {
+			for(slot = 0; slot < images[type].size(); slot++) {
+				if(images[type][slot] && image_equals(images[type][slot],
+			                                          filename,
+			                                          builtin_data,
+			                                          interpolation,
+			                                          extension))
+				{
+					flat_slot = type_index_to_flattened_slot(slot, (ImageDataType)type);
+					break;
+				}
 			}
 		}
 	}
+
+	if(flat_slot != -1)
+		remove_image(flat_slot);
 }
 
 /* TODO(sergey): Deduplicate with the iteration above, but make it pretty,
@@ -409,6 +462,8 @@ void ImageManager::tag_reload_image(const string& filename,
                                     InterpolationType interpolation,
                                     ExtensionType extension)
 {
+	thread_scoped_lock images_lock(images_mutex);
+
 	for(size_t type = 0; type < IMAGE_DATA_NUM_TYPES; type++) {
 		for(size_t slot = 0; slot < images[type].size(); slot++) {
 			if(images[type][slot] && image_equals(images[type][slot],
@@ -746,7 +801,9 @@ bool ImageManager::file_load_float_image(Image *img, device_vector<float>& tex_i
 
 void ImageManager::device_load_image(Device *device, DeviceScene *dscene, ImageDataType type, int slot, Progress *progress)
 {
-	if(progress->get_cancel())
+	/* NOTE: progress is NULL when called to fault an image in from the
+	 * texture cache, rendering threads cannot report status. */
+	if(progress && progress->get_cancel())
 		return;
 	
 	Image *img = images[type][slot];
@@ -754,19 +811,24 @@ void ImageManager::device_load_image(Device *device, DeviceScene *dscene, ImageD
 	if(osl_texture_system && !img->builtin_data)
 		return;
 
+	/* Drop lazy loading state when the image is no longer cached. */
+	if(!use_texture_cache(img))
+		texture_cache_free_slot(type, slot);
+
+	/* For cached images the master kernel globals must not be touched here:
+	 * fault-ins run while rendering threads copy the whole struct
+	 * unsynchronized at task start, and a racing copy could observe a torn
+	 * slot. The pixels reach the threads through texture_cache_fetch()
+	 * filling their local slot instead, and the master slot is re-registered
+	 * between renders, see device_update(). */
+	const bool defer_register = use_texture_cache(img);
+
 	string filename = path_filename(images[type][slot]->filename);
-	progress->set_status("Updating Images", "Loading " + filename);
+	if(progress)
+		progress->set_status("Updating Images", "Loading " + filename);
 
 	/* Slot assignment */
-	int flat_slot = type_index_to_flattened_slot(slot, type);
-
-	string name;
-	if(flat_slot >= 100)
-		name = string_printf("__tex_image_%s_%d", name_from_type(type).c_str(), flat_slot);
-	else if(flat_slot >= 10)
-		name = string_printf("__tex_image_%s_0%d", name_from_type(type).c_str(), flat_slot);
-	else
-		name = string_printf("__tex_image_%s_00%d", name_from_type(type).c_str(), flat_slot);
+	string name = name_from_slot(type, slot);
 
 	if(type == IMAGE_DATA_TYPE_FLOAT4) {
 		device_vector<float4>& tex_img = dscene->tex_float4_image[slot];
@@ -786,7 +848,7 @@ void ImageManager::device_load_image(Device *device, DeviceScene *dscene, ImageD
 			pixels[3] = TEX_IMAGE_MISSING_A;
 		}
 
-		if(!pack_images) {
+		if(!pack_images && !defer_register) {
 			thread_scoped_lock device_lock(device_mutex);
 			device->tex_alloc(name.c_str(),
 			                  tex_img,
@@ -809,7 +871,7 @@ void ImageManager::device_load_image(Device *device, DeviceScene *dscene, ImageD
 			pixels[0] = TEX_IMAGE_MISSING_R;
 		}
 
-		if(!pack_images) {
+		if(!pack_images && !defer_register) {
 			thread_scoped_lock device_lock(device_mutex);
 			device->tex_alloc(name.c_str(),
 			                  tex_img,
@@ -835,7 +897,7 @@ void ImageManager::device_load_image(Device *device, DeviceScene *dscene, ImageD
 			pixels[3] = (TEX_IMAGE_MISSING_A * 255);
 		}
 
-		if(!pack_images) {
+		if(!pack_images && !defer_register) {
 			thread_scoped_lock device_lock(device_mutex);
 			device->tex_alloc(name.c_str(),
 			                  tex_img,
@@ -858,7 +920,7 @@ void ImageManager::device_load_image(Device *device, DeviceScene *dscene, ImageD
 			pixels[0] = (TEX_IMAGE_MISSING_R * 255);
 		}
 
-		if(!pack_images) {
+		if(!pack_images && !defer_register) {
 			thread_scoped_lock device_lock(device_mutex);
 			device->tex_alloc(name.c_str(),
 			                  tex_img,
@@ -922,11 +984,222 @@ void ImageManager::device_free_image(Device *device, DeviceScene *dscene, ImageD
 			tex_img.clear();
 		}
 
+		texture_cache_free_slot(type, slot);
+
 		delete images[type][slot];
 		images[type][slot] = NULL;
 	}
 }
 
+bool ImageManager::use_texture_cache(const Image *img)
+{
+	/* Only the CPU device can fault images in during rendering, and builtin
+	 * images come from callbacks into Blender which are not safe to call
+	 * from rendering threads. */
+	return texture_cache_supported &&
+	       texture_cache_size > 0 &&
+	       !pack_images &&
+	       !img->builtin_data;
+}
+
+device_memory *ImageManager::image_memory(DeviceScene *dscene, ImageDataType type, int slot)
+{
+	if(type == IMAGE_DATA_TYPE_FLOAT4)
+		return &dscene->tex_float4_image[slot];
+	else if(type == IMAGE_DATA_TYPE_FLOAT)
+		return &dscene->tex_float_image[slot];
+	else if(type == IMAGE_DATA_TYPE_BYTE4)
+		return &dscene->tex_byte4_image[slot];
+	else
+		return &dscene->tex_byte_image[slot];
+}
+
+void ImageManager::device_cache_image(Device *device, DeviceScene *dscene, ImageDataType type, int slot)
+{
+	Image *img = images[type][slot];
+
+	if(cached_images[type].size() <= (size_t)slot)
+		cached_images[type].resize(images[type].size(), NULL);
+
+	CachedImage *cached = cached_images[type][slot];
+
+	if(cached == NULL) {
+		cached = new CachedImage();
+		cached->manager = this;
+		cached->type = type;
+		cached->slot = slot;
+		cached->resident = false;
+		cached->memory_size = 0;
+		cached->last_used = 0;
+		cached_images[type][slot] = cached;
+	}
+
+	cached->device = device;
+	cached->dscene = dscene;
+
+	/* Pixels loaded for an outdated frame are dropped here, the kernel then
+	 * faults the new frame in on the first sample that needs it. */
+	if(cached->resident) {
+		texture_cache_evict(cached);
+	}
+	else {
+		/* Register the empty slot carrying the cache handle with the
+		 * device, eviction re-registers by itself. */
+		device_memory *tex_img = image_memory(dscene, type, slot);
+		tex_img->texture_cache_handle = cached;
+
+		thread_scoped_lock device_lock(device_mutex);
+		device->tex_alloc(name_from_slot(type, slot).c_str(),
+		                  *tex_img,
+		                  img->interpolation,
+		                  img->extension);
+	}
+
+	img->need_load = false;
+}
+
+void ImageManager::texture_cache_evict(CachedImage *cached)
+{
+	/* Frees the pixels of a resident image. Must only run while no kernels
+	 * are executing, since rendering threads keep plain pointers into the
+	 * pixel data; the session guarantees that for scene device updates. */
+	Image *img = images[cached->type][cached->slot];
+
+	if(cached->type == IMAGE_DATA_TYPE_FLOAT4) {
+		device_vector<float4>& tex_img = cached->dscene->tex_float4_image[cached->slot];
+
+		if(tex_img.device_pointer) {
+			thread_scoped_lock device_lock(device_mutex);
+			cached->device->tex_free(tex_img);
+		}
+
+		tex_img.clear();
+	}
+	else if(cached->type == IMAGE_DATA_TYPE_FLOAT) {
+		device_vector<float>& tex_img = cached->dscene->tex_float_image[cached->slot];
+
+		if(tex_img.device_pointer) {
+			thread_scoped_lock device_lock(device_mutex);
+			cached->device->tex_free(tex_img);
+		}
+
+		tex_img.clear();
+	}
+	else if(cached->type == IMAGE_DATA_TYPE_BYTE4) {
+		device_vector<uchar4>& tex_img = cached->dscene->tex_byte4_image[cached->slot];
+
+		if(tex_img.device_pointer) {
+			thread_scoped_lock device_lock(device_mutex);
+			cached->device->tex_free(tex_img);
+		}
+
+		tex_img.clear();
+	}
+	else {
+		device_vector<uchar>& tex_img = cached->dscene->tex_byte_image[cached->slot];
+
+		if(tex_img.device_pointer) {
+			thread_scoped_lock device_lock(device_mutex);
+			cached->device->tex_free(tex_img);
+		}
+
+		tex_img.clear();
+	}
+
+	texture_cache_used -= cached->memory_size;
+	cached->memory_size = 0;
+	cached->resident = false;
+
+	/* Re-register the empty slot so the kernel faults the image back in
+	 * when it is needed again. */
+	device_memory *tex_img = image_memory(cached->dscene, cached->type, cached->slot);
+	tex_img->texture_cache_handle = cached;
+
+	thread_scoped_lock device_lock(device_mutex);
+	cached->device->tex_alloc(name_from_slot(cached->type, cached->slot).c_str(),
+	                          *tex_img,
+	                          img->interpolation,
+	                          img->extension);
+}
+
+void ImageManager::texture_cache_shrink()
+{
+	/* Evict least recently used images until the cache fits its budget
+	 * again. Loads during the last render may have overshot it, which at
+	 * whole image granularity cannot be avoided without stalling kernels. */
+	while(texture_cache_used > texture_cache_size) {
+		CachedImage *lru = NULL;
+
+		for(int type = 0; type < IMAGE_DATA_NUM_TYPES; type++) {
+			foreach(CachedImage *cached, cached_images[type]) {
+				if(cached && cached->resident)
+					if(lru == NULL || cached->last_used < lru->last_used)
+						lru = cached;
+			}
+		}
+
+		if(lru == NULL)
+			break;
+
+		VLOG(1) << "Texture cache: evicting "
+		        << images[lru->type][lru->slot]->filename
+		        << ", " << lru->memory_size << " bytes.";
+
+		texture_cache_evict(lru);
+	}
+}
+
+void ImageManager::texture_cache_free_slot(ImageDataType type, int slot)
+{
+	if(cached_images[type].size() <= (size_t)slot)
+		return;
+
+	CachedImage *cached = cached_images[type][slot];
+
+	if(cached) {
+		texture_cache_used -= cached->memory_size;
+		image_memory(cached->dscene, type, slot)->texture_cache_handle = NULL;
+
+		delete cached;
+		cached_images[type][slot] = NULL;
+	}
+}
+
+void *ImageManager::texture_cache_fetch_slot(CachedImage *cached, int *r_width, int *r_height, int *r_depth)
+{
+	thread_scoped_lock cache_lock(cache_mutex);
+
+	if(!cached->resident) {
+		/* Load the entire image. The master copy of the kernel globals is
+		 * deliberately left alone (it keeps the empty registration), each
+		 * rendering thread picks the pixels up through its own local slot.
+		 * A failed load leaves the usual 1x1 pink pixels behind, so we do
+		 * not retry on every sample. */
+		device_load_image(cached->device, cached->dscene, cached->type, cached->slot, NULL);
+
+		cached->memory_size = image_memory(cached->dscene, cached->type, cached->slot)->memory_size();
+		cached->resident = true;
+		texture_cache_used += cached->memory_size;
+	}
+
+	cached->last_used = ++texture_cache_clock;
+
+	device_memory *tex_img = image_memory(cached->dscene, cached->type, cached->slot);
+	*r_width = tex_img->data_width;
+	*r_height = tex_img->data_height;
+	*r_depth = tex_img->data_depth;
+
+	return (void*)tex_img->data_pointer;
+}
+
+/* Entry point for the CPU kernel, declared in kernel_compat_cpu.h. */
+void *texture_cache_fetch(void *handle, int *r_width, int *r_height, int *r_depth)
+{
+	ImageManager::CachedImage *cached = (ImageManager::CachedImage*)handle;
+
+	return cached->manager->texture_cache_fetch_slot(cached, r_width, r_height, r_depth);
+}
+
 void ImageManager::device_update(Device *device, DeviceScene *dscene, Progress& progress)
 {
 	if(!need_update)
@@ -943,14 +1216,45 @@ void ImageManager::device_update(Device *device, DeviceScene *dscene, Progress&
 				device_free_image(device, dscene, (ImageDataType)type, slot);
 			}
 			else if(images[type][slot]->need_load) {
-				if(!osl_texture_system || images[type][slot]->builtin_data)
-					pool.push(function_bind(&ImageManager::device_load_image, this, device, dscene, (ImageDataType)type, slot, &progress));
+				if(!osl_texture_system || images[type][slot]->builtin_data) {
+					if(use_texture_cache(images[type][slot]))
+						device_cache_image(device, dscene, (ImageDataType)type, slot);
+					else
+						pool.push(function_bind(&ImageManager::device_load_image, this, device, dscene, (ImageDataType)type, slot, &progress));
+				}
 			}
 		}
 	}
 
 	pool.wait_work();
 
+	/* Trim images loaded on demand during the last render back to the
+	 * cache budget. */
+	texture_cache_shrink();
+
+	/* Publish images faulted in during the last render to the master kernel
+	 * globals. Fault-ins don't touch the master (rendering threads copy it
+	 * unsynchronized), so until here only the per-thread slots filled by
+	 * texture_cache_fetch() saw the pixels. No kernels are running now. */
+	for(int type = 0; type < IMAGE_DATA_NUM_TYPES; type++) {
+		foreach(CachedImage *cached, cached_images[type]) {
+			if(cached && cached->resident) {
+				Image *img = images[cached->type][cached->slot];
+				device_memory *tex_img = image_memory(cached->dscene, cached->type, cached->slot);
+
+				/* already published by an earlier update */
+				if(tex_img->device_pointer)
+					continue;
+
+				thread_scoped_lock device_lock(device_mutex);
+				cached->device->tex_alloc(name_from_slot(cached->type, cached->slot).c_str(),
+				                          *tex_img,
+				                          img->interpolation,
+				                          img->extension);
+			}
+		}
+	}
+
 	if(pack_images)
 		device_pack_images(device, dscene, progress);
 
@@ -972,12 +1276,16 @@ void ImageManager::device_update_slot(Device *device,
 		device_free_image(device, dscene, type, slot);
 	}
 	else if(image->need_load) {
-		if(!osl_texture_system || image->builtin_data)
-			device_load_image(device,
-			                  dscene,
-			                  type,
-			                  slot,
-			                  progress);
+		if(!osl_texture_system || image->builtin_data) {
+			if(use_texture_cache(image))
+				device_cache_image(device, dscene, type, slot);
+			else
+				device_load_image(device,
+				                  dscene,
+				                  type,
+				                  slot,
+				                  progress);
+		}
 	}
 }
 
@@ -1094,6 +1402,7 @@ void ImageManager::device_free(Device *device, DeviceScene *dscene)
 			device_free_image(device, dscene, (ImageDataType)type, slot);
 		}
 		images[type].clear();
+		cached_images[type].clear();
 	}
 
 	device->tex_free(dscene->tex_image_byte4_packed);
@@ -72,6 +72,7 @@ public:
 
 	void set_osl_texture_system(void *texture_system);
 	void set_pack_images(bool pack_images_);
+	void set_texture_cache_size(size_t size);
 	bool set_animation_frame_update(int frame);
 
 	bool need_update;
@@ -94,18 +95,44 @@ public:
 		int users;
 	};
 
+	/* Per slot state of the CPU texture cache. When the cache is enabled,
+	 * file images are not loaded up front but registered with such a handle,
+	 * and the kernel faults the pixels in through texture_cache_fetch() on
+	 * the first sample that needs them. */
+	struct CachedImage {
+		ImageManager *manager;
+		Device *device;
+		DeviceScene *dscene;
+		ImageDataType type;
+		int slot;
+
+		bool resident;
+		size_t memory_size;
+		int last_used;
+	};
+
 private:
 	int tex_num_images[IMAGE_DATA_NUM_TYPES];
 	int tex_image_byte4_start;
 	int tex_image_float_start;
 	int tex_image_byte_start;
 	thread_mutex device_mutex;
+	/* image slots are added and removed from multiple shader compile threads */
+	thread_mutex images_mutex;
 	int animation_frame;
 
 	vector<Image*> images[IMAGE_DATA_NUM_TYPES];
 	void *osl_texture_system;
 	bool pack_images;
 
+	/* texture cache */
+	bool texture_cache_supported;
+	size_t texture_cache_size;
+	size_t texture_cache_used;
+	int texture_cache_clock;
+	thread_mutex cache_mutex;
+	vector<CachedImage*> cached_images[IMAGE_DATA_NUM_TYPES];
+
 	bool file_load_image_generic(Image *img, ImageInput **in, int &width, int &height, int &depth, int &components);
 	bool file_load_byte4_image(Image *img, device_vector<uchar4>& tex_img);
 	bool file_load_byte_image(Image *img, device_vector<uchar>& tex_img);
@@ -115,11 +142,23 @@ private:
 	int type_index_to_flattened_slot(int slot, ImageDataType type);
 	int flattened_slot_to_type_index(int flat_slot, ImageDataType *type);
 	string name_from_type(int type);
+	string name_from_slot(ImageDataType type, int slot);
 
 	void device_load_image(Device *device, DeviceScene *dscene, ImageDataType type, int slot, Progress *progess);
 	void device_free_image(Device *device, DeviceScene *dscene, ImageDataType type, int slot);
 
 	void device_pack_images(Device *device, DeviceScene *dscene, Progress& progess);
+
+	/* texture cache */
+	bool use_texture_cache(const Image *img);
+	device_memory *image_memory(DeviceScene *dscene, ImageDataType type, int slot);
+	void device_cache_image(Device *device, DeviceScene *dscene, ImageDataType type, int slot);
+	void texture_cache_evict(CachedImage *cached);
+	void texture_cache_shrink();
+	void texture_cache_free_slot(ImageDataType type, int slot);
+	void *texture_cache_fetch_slot(CachedImage *cached, int *r_width, int *r_height, int *r_depth);
+
+	friend void *texture_cache_fetch(void *handle, int *r_width, int *r_height, int *r_depth);
 };
 
 CCL_NAMESPACE_END
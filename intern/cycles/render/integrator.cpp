@@ -65,6 +65,12 @@ Integrator::Integrator()
 	sample_all_lights_direct = true;
 	sample_all_lights_indirect = true;
 
+	adaptive_sampling = false;
+	adaptive_threshold = 0.01f;
+	adaptive_min_samples = 16;
+
+	use_light_tree = false;
+
 	method = PATH;
 
 	sampling_pattern = SAMPLING_PATTERN_SOBOL;
@@ -224,15 +230,19 @@ bool Integrator::modified(const Integrator& integrator)
 		motion_blur == integrator.motion_blur &&
 		sampling_pattern == integrator.sampling_pattern &&
 		sample_all_lights_direct == integrator.sample_all_lights_direct &&
-		sample_all_lights_indirect == integrator.sample_all_lights_indirect);
+		sample_all_lights_indirect == integrator.sample_all_lights_indirect &&
+		adaptive_sampling == integrator.adaptive_sampling &&
+		adaptive_threshold == integrator.adaptive_threshold &&
+		adaptive_min_samples == integrator.adaptive_min_samples &&
+		use_light_tree == integrator.use_light_tree);
 }
 
 void Integrator::tag_update(Scene *scene)
 {
 	foreach(Shader *shader, scene->shaders) {
 		if(shader->has_integrator_dependency) {
+			shader->need_update = true;
 			scene->shader_manager->need_update = true;
-			break;
 		}
 	}
 	need_update = true;
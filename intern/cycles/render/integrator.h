@@ -64,6 +64,16 @@ public:
 	bool sample_all_lights_direct;
 	bool sample_all_lights_indirect;
 
+	/* adaptive sampling, stop sampling pixels whose estimated error dropped
+	 * below the threshold. only used by the CPU device currently */
+	bool adaptive_sampling;
+	float adaptive_threshold;
+	int adaptive_min_samples;
+
+	/* pick lights through a clustering tree by distance and orientation
+	 * instead of the flat area weighted cdf, for many light scenes */
+	bool use_light_tree;
+
 	enum Method {
 		BRANCHED_PATH = 0,
 		PATH = 1,
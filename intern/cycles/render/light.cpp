@@ -24,6 +24,8 @@
 #include "scene.h"
 #include "shader.h"
 
+#include "util_algorithm.h"
+#include "util_boundbox.h"
 #include "util_foreach.h"
 #include "util_progress.h"
 #include "util_logging.h"
@@ -194,6 +196,143 @@ void LightManager::disable_ineffective_light(Device *device, Scene *scene)
 	}
 }
 
+/* Light Tree
+ *
+ * Binary clustering over the light distribution entries, built by median
+ * splitting along the longest centroid axis. Nodes are uploaded to the
+ * kernel as LIGHT_TREE_NODE_SIZE float4's, see kernel_light.h for the
+ * layout and traversal. */
+
+#define LIGHT_TREE_MAX_LEAF		4
+
+struct LightTreeEmitter {
+	BoundBox bbox;
+	float3 axis;		/* emitter orientation, zero for omnidirectional */
+	float energy;		/* share of the flat distribution cdf */
+	int index;			/* index into the light distribution */
+	int leaf;			/* leaf node the emitter ends up in */
+	int object;			/* object id for triangles, -1 for lamps */
+	int prim;			/* primitive id for triangles, -1 for lamps */
+	bool background;
+
+	LightTreeEmitter()
+	: bbox(BoundBox::empty),
+	  axis(make_float3(0.0f, 0.0f, 0.0f)),
+	  energy(0.0f),
+	  index(-1),
+	  leaf(-1),
+	  object(-1),
+	  prim(-1),
+	  background(false)
+	{
+	}
+};
+
+struct LightTreeCentroidCompare {
+	explicit LightTreeCentroidCompare(int dim_) : dim(dim_) {}
+
+	bool operator()(const LightTreeEmitter& a, const LightTreeEmitter& b) const
+	{
+		float3 ca = a.bbox.center();
+		float3 cb = b.bbox.center();
+
+		if(dim == 0)
+			return ca.x < cb.x;
+		else if(dim == 1)
+			return ca.y < cb.y;
+
+		return ca.z < cb.z;
+	}
+
+	int dim;
+};
+
+struct LightTreeTriangleCompare {
+	bool operator()(const uint4& a, const uint4& b) const
+	{
+		return (a.x < b.x) || (a.x == b.x && a.y < b.y);
+	}
+};
+
+static int light_tree_build(vector<LightTreeEmitter>& emitters,
+                            int begin,
+                            int end,
+                            int parent,
+                            vector<float4>& nodes,
+                            vector<uint>& order)
+{
+	int self = nodes.size()/LIGHT_TREE_NODE_SIZE;
+	nodes.resize(nodes.size() + LIGHT_TREE_NODE_SIZE);
+
+	/* cluster bounds, energy and mean orientation */
+	BoundBox bbox = BoundBox::empty;
+	float3 axis = make_float3(0.0f, 0.0f, 0.0f);
+	float energy = 0.0f;
+	bool omni = false;
+	int i;
+
+	for(i = begin; i < end; i++) {
+		bbox.grow(emitters[i].bbox);
+		axis += emitters[i].axis;
+		energy += emitters[i].energy;
+
+		if(is_zero(emitters[i].axis))
+			omni = true;
+	}
+
+	float cos_spread = 1.0f;
+
+	if(omni || is_zero(axis)) {
+		axis = make_float3(0.0f, 0.0f, 0.0f);
+	}
+	else {
+		axis = normalize(axis);
+
+		for(i = begin; i < end; i++)
+			cos_spread = min(cos_spread, fabsf(dot(axis, emitters[i].axis)));
+
+		cos_spread = max(cos_spread, 0.0f);
+	}
+
+	if(end - begin <= LIGHT_TREE_MAX_LEAF) {
+		nodes[self*LIGHT_TREE_NODE_SIZE + 3] = make_float4(__int_as_float(order.size()),
+		                                                   __int_as_float(end - begin),
+		                                                   __int_as_float(1),
+		                                                   0.0f);
+
+		for(i = begin; i < end; i++) {
+			emitters[i].leaf = self;
+			order.push_back(emitters[i].index);
+		}
+	}
+	else {
+		/* median split along the longest centroid axis */
+		float3 size = bbox.size();
+		int dim = (size.x > size.y)? ((size.x > size.z)? 0: 2):
+		                             ((size.y > size.z)? 1: 2);
+		int middle = (begin + end)/2;
+
+		std::nth_element(emitters.begin() + begin,
+		                 emitters.begin() + middle,
+		                 emitters.begin() + end,
+		                 LightTreeCentroidCompare(dim));
+
+		int left = light_tree_build(emitters, begin, middle, self, nodes, order);
+		int right = light_tree_build(emitters, middle, end, self, nodes, order);
+
+		nodes[self*LIGHT_TREE_NODE_SIZE + 3] = make_float4(__int_as_float(left),
+		                                                   __int_as_float(right),
+		                                                   __int_as_float(0),
+		                                                   0.0f);
+	}
+
+	nodes[self*LIGHT_TREE_NODE_SIZE + 0] = make_float4(bbox.min.x, bbox.min.y, bbox.min.z, energy);
+	nodes[self*LIGHT_TREE_NODE_SIZE + 1] = make_float4(bbox.max.x, bbox.max.y, bbox.max.z, __int_as_float(parent));
+	nodes[self*LIGHT_TREE_NODE_SIZE + 2] = make_float4(axis.x, axis.y, axis.z, cos_spread);
+
+	return self;
+}
+
 void LightManager::device_update_distribution(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress)
 {
 	progress.set_status("Updating Lights", "Computing distribution");
@@ -249,6 +388,13 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 	float4 *distribution = dscene->light_distribution.resize(num_distribution + 1);
 	float totarea = 0.0f;
 
+	/* light tree emitters */
+	bool build_light_tree = scene->integrator->use_light_tree;
+	vector<LightTreeEmitter> emitters;
+
+	if(build_light_tree)
+		emitters.reserve(num_distribution);
+
 	/* triangles */
 	size_t offset = 0;
 	int j = 0;
@@ -328,6 +474,20 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 					}
 
 					totarea += triangle_area(p1, p2, p3);
+
+					if(build_light_tree) {
+						LightTreeEmitter e;
+
+						e.bbox.grow(p1);
+						e.bbox.grow(p2);
+						e.bbox.grow(p3);
+						e.axis = safe_normalize(cross(p2 - p1, p3 - p1));
+						e.index = offset - 1;
+						e.object = j;
+						e.prim = i + mesh->tri_offset;
+
+						emitters.push_back(e);
+					}
 				}
 			}
 		}
@@ -354,6 +514,38 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 		distribution[offset].w = light->size;
 		totarea += lightarea;
 
+		if(build_light_tree) {
+			LightTreeEmitter e;
+
+			if(light->type == LIGHT_AREA) {
+				float3 axisu = light->axisu*(light->sizeu*light->size);
+				float3 axisv = light->axisv*(light->sizev*light->size);
+
+				e.bbox.grow(light->co - 0.5f*axisu - 0.5f*axisv);
+				e.bbox.grow(light->co - 0.5f*axisu + 0.5f*axisv);
+				e.bbox.grow(light->co + 0.5f*axisu - 0.5f*axisv);
+				e.bbox.grow(light->co + 0.5f*axisu + 0.5f*axisv);
+			}
+			else {
+				float3 half = make_float3(light->size, light->size, light->size);
+
+				e.bbox.grow(light->co - half);
+				e.bbox.grow(light->co + half);
+			}
+
+			if(light->type == LIGHT_SPOT ||
+			   light->type == LIGHT_AREA ||
+			   light->type == LIGHT_DISTANT)
+			{
+				e.axis = safe_normalize(light->dir);
+			}
+
+			e.index = offset;
+			e.background = (light->type == LIGHT_BACKGROUND);
+
+			emitters.push_back(e);
+		}
+
 		if(light->size > 0.0f && light->use_mis)
 			use_lamp_mis = true;
 		if(light->type == LIGHT_BACKGROUND) {
@@ -425,6 +617,59 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 		/* CDF */
 		device->tex_alloc("__light_distribution", dscene->light_distribution);
 
+		/* Light tree */
+		kintegrator->use_light_tree = false;
+		kintegrator->light_tree_background_leaf = -1;
+
+		if(build_light_tree && emitters.size() > 0) {
+			/* energy is each emitter's share of the flat cdf, so the tree
+			 * only changes the selection, not the per emitter sampling */
+			foreach(LightTreeEmitter& e, emitters)
+				e.energy = distribution[e.index + 1].x - distribution[e.index].x;
+
+			vector<float4> nodes;
+			vector<uint> order;
+
+			nodes.reserve(emitters.size()*2*LIGHT_TREE_NODE_SIZE);
+			order.reserve(emitters.size());
+
+			light_tree_build(emitters, 0, emitters.size(), -1, nodes, order);
+
+			/* leaf lookups for the forward pdf, emissive triangles sorted
+			 * by object and prim for binary search, and the background */
+			vector<uint4> triangle_lookup;
+			triangle_lookup.reserve(num_triangles);
+
+			foreach(LightTreeEmitter& e, emitters) {
+				if(e.prim != -1)
+					triangle_lookup.push_back(make_uint4(e.object, e.prim, e.leaf, 0));
+				else if(e.background)
+					kintegrator->light_tree_background_leaf = e.leaf;
+			}
+
+			sort(triangle_lookup.begin(), triangle_lookup.end(), LightTreeTriangleCompare());
+
+			float4 *tree_nodes = dscene->light_tree_nodes.resize(nodes.size());
+			memcpy(tree_nodes, &nodes[0], nodes.size()*sizeof(float4));
+			device->tex_alloc("__light_tree_nodes", dscene->light_tree_nodes);
+
+			uint *tree_order = dscene->light_tree_order.resize(order.size());
+			memcpy(tree_order, &order[0], order.size()*sizeof(uint));
+			device->tex_alloc("__light_tree_order", dscene->light_tree_order);
+
+			if(triangle_lookup.size() > 0) {
+				uint4 *tree_triangles = dscene->light_tree_triangles.resize(triangle_lookup.size());
+				memcpy(tree_triangles, &triangle_lookup[0], triangle_lookup.size()*sizeof(uint4));
+				device->tex_alloc("__light_tree_triangles", dscene->light_tree_triangles);
+			}
+
+			kintegrator->use_light_tree = true;
+
+			VLOG(1) << "Use light tree with "
+			        << nodes.size()/LIGHT_TREE_NODE_SIZE << " nodes for "
+			        << emitters.size() << " emitters.";
+		}
+
 		/* Portals */
 		if(num_background_lights > 0 && light_index != scene->lights.size()) {
 			kintegrator->portal_offset = light_index;
@@ -449,6 +694,8 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 		kintegrator->num_portals = 0;
 		kintegrator->portal_offset = 0;
 		kintegrator->portal_pdf = 0.0f;
+		kintegrator->use_light_tree = false;
+		kintegrator->light_tree_background_leaf = -1;
 
 		kfilm->pass_shadow_scale = 1.0f;
 	}
@@ -805,11 +1052,17 @@ void LightManager::device_free(Device *device, DeviceScene *dscene)
 	device->tex_free(dscene->light_data);
 	device->tex_free(dscene->light_background_marginal_cdf);
 	device->tex_free(dscene->light_background_conditional_cdf);
+	device->tex_free(dscene->light_tree_nodes);
+	device->tex_free(dscene->light_tree_order);
+	device->tex_free(dscene->light_tree_triangles);
 
 	dscene->light_distribution.clear();
 	dscene->light_data.clear();
 	dscene->light_background_marginal_cdf.clear();
 	dscene->light_background_conditional_cdf.clear();
+	dscene->light_tree_nodes.clear();
+	dscene->light_tree_order.clear();
+	dscene->light_tree_triangles.clear();
 }
 
 void LightManager::tag_update(Scene * /*scene*/)
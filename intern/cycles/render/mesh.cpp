@@ -79,6 +79,7 @@ Mesh::Mesh()
 {
 	need_update = true;
 	need_update_rebuild = false;
+	is_used = true;
 	transform_applied = false;
 	transform_negative_scaled = false;
 	transform_normal = transform_identity();
@@ -514,12 +515,15 @@ void Mesh::compute_bvh(SceneParams *params, Progress *progress, int n, int total
 		vector<Object*> objects;
 		objects.push_back(&object);
 
+		bool refitted = false;
+
 		if(bvh && !need_update_rebuild) {
 			progress->set_status(msg, "Refitting BVH");
 			bvh->objects = objects;
-			bvh->refit(*progress);
+			refitted = bvh->refit(*progress);
 		}
-		else {
+
+		if(!refitted) {
 			progress->set_status(msg, "Building BVH");
 
 			BVHParams bparams;
@@ -919,6 +923,11 @@ void MeshManager::device_update_attributes(Device *device, DeviceScene *dscene,
 	for(size_t i = 0; i < scene->meshes.size(); i++) {
 		Mesh *mesh = scene->meshes[i];
 
+		/* deduplicated meshes keep an empty request set, objects look up
+		 * attributes through the canonical mesh they were remapped to */
+		if(!mesh->is_used)
+			continue;
+
 		scene->need_global_attributes(mesh_attributes[i]);
 
 		foreach(uint sindex, mesh->used_shaders) {
@@ -1048,6 +1057,11 @@ void MeshManager::device_update_mesh(Device *device, DeviceScene *dscene, Scene
 		mesh->curvekey_offset = curve_key_size;
 		mesh->curve_offset = curve_size;
 
+		/* deduplicated meshes are not packed, all objects reference the
+		 * canonical mesh with the same content */
+		if(!mesh->is_used)
+			continue;
+
 		vert_size += mesh->verts.size();
 		tri_size += mesh->triangles.size();
 
@@ -1065,6 +1079,9 @@ void MeshManager::device_update_mesh(Device *device, DeviceScene *dscene, Scene
 		float4 *tri_vindex = dscene->tri_vindex.resize(tri_size);
 
 		foreach(Mesh *mesh, scene->meshes) {
+			if(!mesh->is_used)
+				continue;
+
 			mesh->pack_normals(scene, &tri_shader[mesh->tri_offset], &vnormal[mesh->vert_offset]);
 			mesh->pack_verts(&tri_verts[mesh->vert_offset], &tri_vindex[mesh->tri_offset], mesh->vert_offset);
 
@@ -1087,6 +1104,9 @@ void MeshManager::device_update_mesh(Device *device, DeviceScene *dscene, Scene
 		float4 *curves = dscene->curves.resize(curve_size);
 
 		foreach(Mesh *mesh, scene->meshes) {
+			if(!mesh->is_used)
+				continue;
+
 			mesh->pack_curves(scene, &curve_keys[mesh->curvekey_offset], &curves[mesh->curve_offset], mesh->curvekey_offset);
 			if(progress.get_cancel()) return;
 		}
@@ -1096,11 +1116,8 @@ void MeshManager::device_update_mesh(Device *device, DeviceScene *dscene, Scene
 	}
 }
 
-void MeshManager::device_update_bvh(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress)
+void MeshManager::device_update_bvh(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress, bool can_refit)
 {
-	/* bvh build */
-	progress.set_status("Updating Scene BVH", "Building");
-
 	VLOG(1) << (scene->params.use_qbvh ? "Using QBVH optimization structure"
 	                                   : "Using regular BVH optimization structure");
 
@@ -1109,9 +1126,27 @@ void MeshManager::device_update_bvh(Device *device, DeviceScene *dscene, Scene *
 	bparams.use_qbvh = scene->params.use_qbvh;
 	bparams.use_spatial_split = scene->params.use_bvh_spatial_split;
 
-	delete bvh;
-	bvh = BVH::create(bparams, scene->objects);
-	bvh->build(progress);
+	/* Refit the previous scene BVH when only object transforms and vertex
+	 * positions changed, which is much cheaper than a full rebuild. */
+	bool refitted = false;
+
+	if(bvh && can_refit &&
+	   bvh->params.use_qbvh == bparams.use_qbvh &&
+	   bvh->params.use_spatial_split == bparams.use_spatial_split &&
+	   bvh->objects == scene->objects)
+	{
+		progress.set_status("Updating Scene BVH", "Refitting");
+		refitted = bvh->refit(progress);
+	}
+
+	if(!refitted) {
+		/* bvh build */
+		progress.set_status("Updating Scene BVH", "Building");
+
+		delete bvh;
+		bvh = BVH::create(bparams, scene->objects);
+		bvh->build(progress);
+	}
 
 	if(progress.get_cancel()) return;
 
@@ -1230,6 +1265,235 @@ void MeshManager::device_update_displacement_images(Device *device,
 	pool.wait_work();
 }
 
+/* Mesh Deduplication
+ *
+ * Meshes exported as per object copies of the same geometry multiply device
+ * memory for no reason. Objects whose meshes have identical content get
+ * pointed at the first such mesh, the duplicates are skipped on device
+ * update and keep only the per object transform. */
+
+static uint mesh_content_hash_data(const void *data, size_t size, uint h)
+{
+	const uchar *bytes = (const uchar*)data;
+
+	while(size >= sizeof(uint)) {
+		uint value;
+		memcpy(&value, bytes, sizeof(uint));
+		h = (h ^ value)*2654435761u;
+		bytes += sizeof(uint);
+		size -= sizeof(uint);
+	}
+
+	while(size--)
+		h = (h ^ *bytes++)*2654435761u;
+
+	return h;
+}
+
+static uint mesh_content_hash_int(uint value, uint h)
+{
+	return (h ^ value)*2654435761u;
+}
+
+template<typename T>
+static uint mesh_content_hash_vector(const vector<T>& data, uint h)
+{
+	if(data.size())
+		h = mesh_content_hash_data(&data[0], data.size()*sizeof(T), h);
+
+	return mesh_content_hash_int(data.size(), h);
+}
+
+static uint mesh_content_hash_flags(const vector<bool>& data, uint h)
+{
+	for(size_t i = 0; i < data.size(); i++)
+		h = mesh_content_hash_int(data[i]? 1: 0, h);
+
+	return mesh_content_hash_int(data.size(), h);
+}
+
+/* Face and vertex normals derive from the geometry and may have been added
+ * to one copy of a mesh already, leave them out of the comparison. */
+static bool mesh_content_skip_attribute(const Attribute& attr)
+{
+	return attr.std == ATTR_STD_FACE_NORMAL || attr.std == ATTR_STD_VERTEX_NORMAL;
+}
+
+static uint mesh_content_hash_attributes(const AttributeSet& attrs, uint h)
+{
+	foreach(const Attribute& attr, attrs.attributes) {
+		if(mesh_content_skip_attribute(attr))
+			continue;
+
+		h = mesh_content_hash_data(attr.name.c_str(), attr.name.size(), h);
+		h = mesh_content_hash_data(&attr.type, sizeof(attr.type), h);
+		h = mesh_content_hash_int(attr.std, h);
+		h = mesh_content_hash_int(attr.element, h);
+		h = mesh_content_hash_vector(attr.buffer, h);
+	}
+
+	return h;
+}
+
+static uint mesh_content_hash(Mesh *mesh)
+{
+	uint h = 2166136261u;
+
+	h = mesh_content_hash_vector(mesh->verts, h);
+	h = mesh_content_hash_vector(mesh->triangles, h);
+	h = mesh_content_hash_vector(mesh->shader, h);
+	h = mesh_content_hash_flags(mesh->smooth, h);
+	h = mesh_content_hash_flags(mesh->forms_quad, h);
+	h = mesh_content_hash_vector(mesh->curve_keys, h);
+	h = mesh_content_hash_vector(mesh->curves, h);
+	h = mesh_content_hash_vector(mesh->used_shaders, h);
+	h = mesh_content_hash_attributes(mesh->attributes, h);
+	h = mesh_content_hash_attributes(mesh->curve_attributes, h);
+	h = mesh_content_hash_int(mesh->transform_applied? 1: 0, h);
+	h = mesh_content_hash_int(mesh->transform_negative_scaled? 1: 0, h);
+	h = mesh_content_hash_data(&mesh->transform_normal, sizeof(Transform), h);
+	h = mesh_content_hash_int(mesh->displacement_method, h);
+	h = mesh_content_hash_int(mesh->motion_steps, h);
+	h = mesh_content_hash_int(mesh->use_motion_blur? 1: 0, h);
+
+	return h;
+}
+
+template<typename T>
+static bool mesh_content_equal_vector(const vector<T>& a, const vector<T>& b)
+{
+	if(a.size() != b.size())
+		return false;
+	if(a.size() == 0)
+		return true;
+
+	return memcmp(&a[0], &b[0], a.size()*sizeof(T)) == 0;
+}
+
+static bool mesh_content_equal_attributes(const AttributeSet& a, const AttributeSet& b)
+{
+	list<Attribute>::const_iterator it_a = a.attributes.begin();
+	list<Attribute>::const_iterator it_b = b.attributes.begin();
+
+	for(;;) {
+		while(it_a != a.attributes.end() && mesh_content_skip_attribute(*it_a))
+			++it_a;
+		while(it_b != b.attributes.end() && mesh_content_skip_attribute(*it_b))
+			++it_b;
+
+		if(it_a == a.attributes.end() || it_b == b.attributes.end())
+			return it_a == a.attributes.end() && it_b == b.attributes.end();
+
+		if(it_a->name != it_b->name ||
+		   it_a->std != it_b->std ||
+		   it_a->type != it_b->type ||
+		   it_a->element != it_b->element ||
+		   it_a->buffer != it_b->buffer)
+		{
+			return false;
+		}
+
+		++it_a;
+		++it_b;
+	}
+}
+
+static bool mesh_content_equal(Mesh *a, Mesh *b)
+{
+	return mesh_content_equal_vector(a->verts, b->verts) &&
+	       mesh_content_equal_vector(a->triangles, b->triangles) &&
+	       mesh_content_equal_vector(a->shader, b->shader) &&
+	       a->smooth == b->smooth &&
+	       a->forms_quad == b->forms_quad &&
+	       mesh_content_equal_vector(a->curve_keys, b->curve_keys) &&
+	       mesh_content_equal_vector(a->curves, b->curves) &&
+	       mesh_content_equal_vector(a->used_shaders, b->used_shaders) &&
+	       mesh_content_equal_attributes(a->attributes, b->attributes) &&
+	       mesh_content_equal_attributes(a->curve_attributes, b->curve_attributes) &&
+	       a->transform_applied == b->transform_applied &&
+	       a->transform_negative_scaled == b->transform_negative_scaled &&
+	       memcmp(&a->transform_normal, &b->transform_normal, sizeof(Transform)) == 0 &&
+	       a->displacement_method == b->displacement_method &&
+	       a->motion_steps == b->motion_steps &&
+	       a->use_motion_blur == b->use_motion_blur;
+}
+
+void MeshManager::deduplicate_meshes(Scene *scene)
+{
+	/* undo remaps from the previous update first, an edit to a mesh must
+	 * not leak through objects that shared it as a duplicate */
+	if(!dedup_restore.empty()) {
+		set<Object*> scene_objects(scene->objects.begin(), scene->objects.end());
+		set<Mesh*> scene_meshes(scene->meshes.begin(), scene->meshes.end());
+
+		for(map<Object*, Mesh*>::iterator it = dedup_restore.begin();
+		    it != dedup_restore.end();
+		    ++it)
+		{
+			if(scene_objects.count(it->first) && scene_meshes.count(it->second))
+				it->first->mesh = it->second;
+		}
+
+		dedup_restore.clear();
+	}
+
+	/* group meshes by content, the first mesh with given content is the
+	 * canonical one. hash buckets are verified with a full comparison */
+	map<uint, vector<Mesh*> > buckets;
+	map<Mesh*, Mesh*> canonical;
+	set<Mesh*> was_used;
+
+	foreach(Mesh *mesh, scene->meshes) {
+		if(mesh->is_used)
+			was_used.insert(mesh);
+		mesh->is_used = false;
+
+		vector<Mesh*>& bucket = buckets[mesh_content_hash(mesh)];
+		Mesh *match = NULL;
+
+		foreach(Mesh *other, bucket) {
+			if(mesh_content_equal(mesh, other)) {
+				match = other;
+				break;
+			}
+		}
+
+		if(match)
+			canonical[mesh] = match;
+		else
+			bucket.push_back(mesh);
+	}
+
+	size_t num_deduplicated = 0;
+
+	foreach(Object *object, scene->objects) {
+		map<Mesh*, Mesh*>::iterator it = canonical.find(object->mesh);
+
+		if(it != canonical.end()) {
+			dedup_restore[object] = object->mesh;
+			object->mesh = it->second;
+			num_deduplicated++;
+		}
+
+		object->mesh->is_used = true;
+	}
+
+	/* packing offsets shift when a mesh switches between used and unused,
+	 * which invalidates the global triangle indices in the scene BVH */
+	foreach(Mesh *mesh, scene->meshes) {
+		if(mesh->is_used != (was_used.count(mesh) != 0)) {
+			mesh->need_update = true;
+			mesh->need_update_rebuild = true;
+		}
+	}
+
+	if(num_deduplicated) {
+		VLOG(1) << "Deduplicated meshes for "
+		        << num_deduplicated << " of "
+		        << scene->objects.size() << " objects.";
+	}
+}
+
 void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress)
 {
 	if(!need_update)
@@ -1237,8 +1501,14 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 
 	VLOG(1) << "Total " << scene->meshes.size() << " meshes.";
 
+	/* share one mesh between objects with identical geometry */
+	deduplicate_meshes(scene);
+
 	/* update normals */
 	foreach(Mesh *mesh, scene->meshes) {
+		if(!mesh->is_used)
+			continue;
+
 		foreach(uint shader, mesh->used_shaders) {
 			if(scene->shaders[shader]->need_update_attributes)
 				mesh->need_update = true;
@@ -1256,7 +1526,8 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 	bool need_displacement_images = false;
 	bool old_need_object_flags_update = false;
 	foreach(Mesh *mesh, scene->meshes) {
-		if(mesh->need_update &&
+		if(mesh->is_used &&
+		   mesh->need_update &&
 		   mesh->displacement_method != Mesh::DISPLACE_BUMP)
 		{
 			need_displacement_images = true;
@@ -1287,7 +1558,7 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 	bool displacement_done = false;
 
 	foreach(Mesh *mesh, scene->meshes)
-		if(mesh->need_update && displace(device, dscene, scene, mesh, progress))
+		if(mesh->is_used && mesh->need_update && displace(device, dscene, scene, mesh, progress))
 			displacement_done = true;
 
 	/* todo: properly handle cancel halfway displacement */
@@ -1307,9 +1578,26 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 	/* update bvh */
 	size_t i = 0, num_bvh = 0;
 
-	foreach(Mesh *mesh, scene->meshes)
+	/* Remember whether the scene BVH topology survives this update, before
+	 * compute_bvh() clears the per-mesh flags. */
+	bool can_refit_scene_bvh = true;
+
+	foreach(Mesh *mesh, scene->meshes) {
+		if(!mesh->is_used) {
+			/* compute_bvh() won't run for deduplicated meshes, clear the
+			 * flags here so they don't keep the manager tagged */
+			if(mesh->need_update_rebuild)
+				can_refit_scene_bvh = false;
+			mesh->need_update = false;
+			mesh->need_update_rebuild = false;
+			continue;
+		}
+
+		if(mesh->need_update && mesh->need_update_rebuild)
+			can_refit_scene_bvh = false;
 		if(mesh->need_update && mesh->need_build_bvh())
 			num_bvh++;
+	}
 
 	TaskPool pool;
 
@@ -1349,7 +1637,7 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 
 	if(progress.get_cancel()) return;
 
-	device_update_bvh(device, dscene, scene, progress);
+	device_update_bvh(device, dscene, scene, progress, can_refit_scene_bvh);
 
 	need_update = false;
 
@@ -34,6 +34,7 @@ class BVH;
 class Device;
 class DeviceScene;
 class Mesh;
+class Object;
 class Progress;
 class Scene;
 class SceneParams;
@@ -111,6 +112,10 @@ public:
 	bool need_update;
 	bool need_update_rebuild;
 
+	/* Referenced by at least one object. Cleared for meshes that got
+	 * deduplicated away, such meshes are skipped on device update. */
+	bool is_used;
+
 	/* BVH */
 	BVH *bvh;
 	size_t tri_offset;
@@ -177,6 +182,9 @@ public:
 
 	bool displace(Device *device, DeviceScene *dscene, Scene *scene, Mesh *mesh, Progress& progress);
 
+	/* point objects with identical mesh content at one shared mesh */
+	void deduplicate_meshes(Scene *scene);
+
 	/* attributes */
 	void update_osl_attributes(Device *device, Scene *scene, vector<AttributeRequestSet>& mesh_attributes);
 	void update_svm_attributes(Device *device, DeviceScene *dscene, Scene *scene, vector<AttributeRequestSet>& mesh_attributes);
@@ -185,12 +193,17 @@ public:
 	void device_update_object(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
 	void device_update_mesh(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
 	void device_update_attributes(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
-	void device_update_bvh(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
+	void device_update_bvh(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress, bool can_refit);
 	void device_update_flags(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
 	void device_update_displacement_images(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
 	void device_free(Device *device, DeviceScene *dscene);
 
 	void tag_update(Scene *scene);
+
+protected:
+	/* original mesh of objects remapped by deduplication, so a later edit
+	 * of that mesh does not leak through the shared one */
+	map<Object*, Mesh*> dedup_restore;
 };
 
 CCL_NAMESPACE_END
@@ -93,6 +93,9 @@ public:
 	device_vector<float4> light_data;
 	device_vector<float2> light_background_marginal_cdf;
 	device_vector<float2> light_background_conditional_cdf;
+	device_vector<float4> light_tree_nodes;
+	device_vector<uint> light_tree_order;
+	device_vector<uint4> light_tree_triangles;
 
 	/* particles */
 	device_vector<float4> particles;
@@ -136,6 +139,10 @@ public:
 	bool use_bvh_spatial_split;
 	bool use_qbvh;
 	bool persistent_data;
+	/* Maximum bytes of image pixels kept resident on the CPU device, with
+	 * lazy loading and LRU eviction of whole images. 0 loads all images up
+	 * front as usual. */
+	size_t texture_cache_size;
 
 	SceneParams()
 	{
@@ -144,6 +151,7 @@ public:
 		use_bvh_spatial_split = false;
 		use_qbvh = false;
 		persistent_data = false;
+		texture_cache_size = 0;
 	}
 
 	bool modified(const SceneParams& params)
@@ -151,7 +159,8 @@ public:
 		&& bvh_type == params.bvh_type
 		&& use_bvh_spatial_split == params.use_bvh_spatial_split
 		&& use_qbvh == params.use_qbvh
-		&& persistent_data == params.persistent_data); }
+		&& persistent_data == params.persistent_data
+		&& texture_cache_size == params.texture_cache_size); }
 };
 
 /* Scene */
@@ -58,10 +58,13 @@ Session::Session(const SessionParams& params_)
 	if(params.background && params.output_path.empty()) {
 		buffers = NULL;
 		display = NULL;
+		display_back = NULL;
 	}
 	else {
 		buffers = new RenderBuffers(device);
 		display = new DisplayBuffer(device, params.display_buffer_linear);
+		display_back = (device_use_gl || params.background)? NULL:
+		               new DisplayBuffer(device, params.display_buffer_linear);
 	}
 
 	session_thread = NULL;
@@ -122,6 +125,7 @@ Session::~Session()
 
 	delete buffers;
 	delete display;
+	delete display_back;
 	delete scene;
 	delete device;
 
@@ -567,9 +571,17 @@ void Session::run_cpu()
 			/* update status and timing */
 			update_status_time();
 
-			if(!params.background)
+			if(!params.background) {
 				need_tonemap = true;
 
+				/* convert to the back display buffer in a device task that
+				 * runs alongside path tracing, so the render threads never
+				 * stall on a display refresh. a pixel the conversion reads
+				 * before the in-flight sample reached it lags one sample
+				 * behind, which the next refresh corrects */
+				tonemap_async(tile_manager.state.sample);
+			}
+
 			if(!device->error_message().empty())
 				progress.set_error(device->error_message());
 		}
@@ -587,9 +599,9 @@ void Session::run_cpu()
 				reset_(delayed_reset.params, delayed_reset.samples);
 			}
 			else if(need_tonemap) {
-				/* tonemap only if we do not reset, we don't we don't
-				 * want to show the result of an incomplete sample */
-				tonemap(tile_manager.state.sample);
+				/* swap in the converted buffer only if we do not reset, we
+				 * don't want to show the result of an incomplete sample */
+				display_swap();
 			}
 
 			if(!device->error_message().empty())
@@ -709,6 +721,8 @@ void Session::reset_(BufferParams& buffer_params, int samples)
 			gpu_draw_ready = false;
 			buffers->reset(device, buffer_params);
 			display->reset(device, buffer_params);
+			if(display_back)
+				display_back->reset(device, buffer_params);
 		}
 	}
 
@@ -908,11 +922,19 @@ void Session::update_progress_sample()
 	progress.increment_sample();
 }
 
+bool Session::update_adaptive(RenderTile& rtile, int sample)
+{
+	return rtile.buffers->update_adaptive_mask(rtile.x, rtile.y, rtile.w, rtile.h,
+	                                           rtile.offset, rtile.stride,
+	                                           sample,
+	                                           scene->integrator->adaptive_threshold);
+}
+
 void Session::path_trace()
 {
 	/* add path trace task */
 	DeviceTask task(DeviceTask::PATH_TRACE);
-	
+
 	task.acquire_tile = function_bind(&Session::acquire_tile, this, _1, _2);
 	task.release_tile = function_bind(&Session::release_tile, this, _1);
 	task.get_cancel = function_bind(&Progress::get_cancel, &this->progress);
@@ -922,10 +944,21 @@ void Session::path_trace()
 	task.integrator_branched = scene->integrator->method == Integrator::BRANCHED_PATH;
 	task.requested_tile_size = params.tile_size;
 
+	/* adaptive sampling needs direct access to the accumulation buffers and
+	 * is only implemented for the CPU device */
+	if(scene->integrator->adaptive_sampling &&
+	   device->info.type == DEVICE_CPU &&
+	   Pass::contains(scene->film->passes, PASS_ADAPTIVE))
+	{
+		task.adaptive_step = 16;
+		task.adaptive_min_samples = max(scene->integrator->adaptive_min_samples, 2);
+		task.update_adaptive = function_bind(&Session::update_adaptive, this, _1, _2);
+	}
+
 	device->task_add(task);
 }
 
-void Session::tonemap(int sample)
+bool Session::tonemap_enqueue(int sample, DisplayBuffer *target)
 {
 	/* add tonemap task */
 	DeviceTask task(DeviceTask::FILM_CONVERT);
@@ -934,18 +967,53 @@ void Session::tonemap(int sample)
 	task.y = tile_manager.state.buffer.full_y;
 	task.w = tile_manager.state.buffer.width;
 	task.h = tile_manager.state.buffer.height;
-	task.rgba_byte = display->rgba_byte.device_pointer;
-	task.rgba_half = display->rgba_half.device_pointer;
+	task.rgba_byte = target->rgba_byte.device_pointer;
+	task.rgba_half = target->rgba_half.device_pointer;
 	task.buffer = buffers->buffer.device_pointer;
 	task.sample = sample;
 	tile_manager.state.buffer.get_offset_stride(task.offset, task.stride);
 
 	if(task.w > 0 && task.h > 0) {
 		device->task_add(task);
+		return true;
+	}
+
+	return false;
+}
+
+void Session::tonemap(int sample)
+{
+	if(tonemap_enqueue(sample, display)) {
 		device->task_wait();
 
 		/* set display to new size */
-		display->draw_set(task.w, task.h);
+		display->draw_set(tile_manager.state.buffer.width, tile_manager.state.buffer.height);
+	}
+
+	display_outdated = false;
+}
+
+void Session::tonemap_async(int sample)
+{
+	/* convert into the back display buffer, without waiting for the task.
+	 * the swap to the front buffer happens after the next task_wait() */
+	tonemap_enqueue(sample, display_back);
+}
+
+void Session::display_swap()
+{
+	/* caller must hold display_mutex, the draw callback reads the front
+	 * buffer under the same lock */
+	int width = tile_manager.state.buffer.width;
+	int height = tile_manager.state.buffer.height;
+
+	if(width > 0 && height > 0) {
+		DisplayBuffer *tmp = display;
+		display = display_back;
+		display_back = tmp;
+
+		/* set display to new size */
+		display->draw_set(width, height);
 	}
 
 	display_outdated = false;
@@ -158,7 +158,10 @@ protected:
 
 	void update_status_time(bool show_pause = false, bool show_done = false);
 
+	bool tonemap_enqueue(int sample, DisplayBuffer *target);
 	void tonemap(int sample);
+	void tonemap_async(int sample);
+	void display_swap();
 	void path_trace();
 	void reset_(BufferParams& params, int samples);
 
@@ -176,8 +179,15 @@ protected:
 
 	void update_progress_sample();
 
+	bool update_adaptive(RenderTile& tile, int sample);
+
 	bool device_use_gl;
 
+	/* back display buffer the CPU session converts into asynchronously,
+	 * swapped with the front buffer once conversion completed. NULL for
+	 * the GPU session, which must convert from the main thread for GL */
+	DisplayBuffer *display_back;
+
 	thread *session_thread;
 
 	volatile bool display_outdated;
@@ -177,6 +177,9 @@ protected:
 	typedef unordered_map<ustring, uint, ustringHash> AttributeIDMap;
 	AttributeIDMap unique_attribute_id;
 
+	/* attribute ids are requested from multiple shader compile threads */
+	thread_mutex attribute_id_mutex;
+
 	thread_mutex lookup_table_mutex;
 	static vector<float> beckmann_table;
 
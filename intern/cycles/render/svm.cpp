@@ -27,6 +27,7 @@
 #include "util_logging.h"
 #include "util_foreach.h"
 #include "util_progress.h"
+#include "util_task.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -42,6 +43,84 @@ SVMShaderManager::~SVMShaderManager()
 
 void SVMShaderManager::reset(Scene * /*scene*/)
 {
+	shader_cache.clear();
+}
+
+/* Copy a shader's compiled nodes into the global array, turning the jump
+ * table offsets from positions local to the shader into absolute positions
+ * in the global array. The shader's nodes start at local index 2, after its
+ * two jump table entries. */
+static void svm_stitch_shader_nodes(int index,
+                                    const vector<int4>& shader_svm_nodes,
+                                    vector<int4> *global_svm_nodes)
+{
+	int i, offset = global_svm_nodes->size() - 2;
+
+	for(i = 0; i < 2; i++) {
+		int4 node = shader_svm_nodes[i];
+		node.y += offset;
+		node.z += offset;
+		node.w += offset;
+		(*global_svm_nodes)[index*2 + i] = node;
+	}
+
+	global_svm_nodes->insert(global_svm_nodes->end(),
+	                         shader_svm_nodes.begin() + 2,
+	                         shader_svm_nodes.end());
+}
+
+void SVMShaderManager::device_update_shader(Scene *scene,
+                                            Shader *shader,
+                                            int index,
+                                            vector<int4> *global_svm_nodes,
+                                            Progress *progress)
+{
+	if(progress->get_cancel())
+		return;
+
+	assert(shader->graph);
+
+	bool background = ((int)index == scene->default_background);
+
+	/* re-use the nodes from the previous update if the shader did not
+	 * change, the has_* flags set by the compiler persist on the shader */
+	{
+		thread_scoped_lock lock(nodes_mutex);
+		map<Shader*, ShaderCompiled>::iterator it = shader_cache.find(shader);
+
+		if(!shader->need_update &&
+		   it != shader_cache.end() &&
+		   it->second.background == background)
+		{
+			svm_stitch_shader_nodes(index, it->second.svm_nodes, global_svm_nodes);
+			return;
+		}
+	}
+
+	/* two jump table entries, copied to the global jump table at stitch time */
+	vector<int4> svm_nodes;
+	svm_nodes.push_back(make_int4(NODE_SHADER_JUMP, 0, 0, 0));
+	svm_nodes.push_back(make_int4(NODE_SHADER_JUMP, 0, 0, 0));
+
+	SVMCompiler::Summary summary;
+	SVMCompiler compiler(scene->shader_manager, scene->image_manager);
+	compiler.background = background;
+	compiler.compile(scene, shader, svm_nodes, 0, &summary);
+
+	VLOG(2) << "Compilation summary:\n"
+	        << "Shader name: " << shader->name << "\n"
+	        << summary.full_report();
+
+	thread_scoped_lock lock(nodes_mutex);
+
+	if(shader->use_mis && shader->has_surface_emission)
+		scene->light_manager->need_update = true;
+
+	ShaderCompiled& cached = shader_cache[shader];
+	cached.svm_nodes = svm_nodes;
+	cached.background = background;
+
+	svm_stitch_shader_nodes(index, svm_nodes, global_svm_nodes);
 }
 
 void SVMShaderManager::device_update(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress)
@@ -57,33 +136,40 @@ void SVMShaderManager::device_update(Device *device, DeviceScene *dscene, Scene
 	/* determine which shaders are in use */
 	device_update_shaders_used(scene);
 
-	/* svm_nodes */
-	vector<int4> svm_nodes;
+	/* svm_nodes, with a two-entry jump table per shader at the front */
+	vector<int4> svm_nodes(scene->shaders.size()*2,
+	                       make_int4(NODE_SHADER_JUMP, 0, 0, 0));
 	size_t i;
 
+	/* each shader graph compiles independently, results are stitched into
+	 * the global node array as the tasks complete */
+	TaskPool pool;
+
 	for(i = 0; i < scene->shaders.size(); i++) {
-		svm_nodes.push_back(make_int4(NODE_SHADER_JUMP, 0, 0, 0));
-		svm_nodes.push_back(make_int4(NODE_SHADER_JUMP, 0, 0, 0));
+		pool.push(function_bind(&SVMShaderManager::device_update_shader,
+		                        this,
+		                        scene,
+		                        scene->shaders[i],
+		                        (int)i,
+		                        &svm_nodes,
+		                        &progress));
 	}
-	
-	for(i = 0; i < scene->shaders.size(); i++) {
-		Shader *shader = scene->shaders[i];
 
-		if(progress.get_cancel()) return;
+	pool.wait_work();
 
-		assert(shader->graph);
+	if(progress.get_cancel()) return;
 
-		if(shader->use_mis && shader->has_surface_emission)
-			scene->light_manager->need_update = true;
-
-		SVMCompiler::Summary summary;
-		SVMCompiler compiler(scene->shader_manager, scene->image_manager);
-		compiler.background = ((int)i == scene->default_background);
-		compiler.compile(scene, shader, svm_nodes, i, &summary);
-
-		VLOG(2) << "Compilation summary:\n"
-		        << "Shader name: " << shader->name << "\n"
-		        << summary.full_report();
+	/* drop cache entries for shaders no longer in the scene */
+	{
+		set<Shader*> scene_shaders(scene->shaders.begin(), scene->shaders.end());
+		map<Shader*, ShaderCompiled>::iterator it = shader_cache.begin();
+
+		while(it != shader_cache.end()) {
+			if(scene_shaders.find(it->first) == scene_shaders.end())
+				shader_cache.erase(it++);
+			else
+				it++;
+		}
 	}
 
 	dscene->svm_nodes.copy((uint4*)&svm_nodes[0], svm_nodes.size());
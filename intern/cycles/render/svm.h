@@ -21,8 +21,10 @@
 #include "graph.h"
 #include "shader.h"
 
+#include "util_map.h"
 #include "util_set.h"
 #include "util_string.h"
+#include "util_thread.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -46,6 +48,31 @@ public:
 
 	void device_update(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
 	void device_free(Device *device, DeviceScene *dscene, Scene *scene);
+
+protected:
+	/* Compiled state of a single shader, kept so unchanged shaders can be
+	 * stitched back into the global node array without recompiling on the
+	 * next device update. */
+	struct ShaderCompiled {
+		/* Two jump table entries followed by the shader's SVM nodes, with
+		 * jump offsets relative to the start of this vector. */
+		vector<int4> svm_nodes;
+		/* Background flag the shader was compiled with. */
+		bool background;
+	};
+
+	/* Compile a single shader, or re-use its cached nodes, and stitch the
+	 * result into the global node array. Runs from a task pool. */
+	void device_update_shader(Scene *scene,
+	                          Shader *shader,
+	                          int index,
+	                          vector<int4> *global_svm_nodes,
+	                          Progress *progress);
+
+	/* Protects the global node array, the cache and the light manager tag
+	 * during parallel compilation. */
+	thread_mutex nodes_mutex;
+	map<Shader*, ShaderCompiled> shader_cache;
 };
 
 /* Graph Compiler */
@@ -322,6 +322,34 @@ bool TileManager::next_tile(Tile& tile, int device)
 
 	tile = Tile(state.tiles[logical_device].front());
 	state.tiles[logical_device].pop_front();
+
+	/* When the shared tile queue is running dry while multiple devices are
+	 * rendering, split the tile being handed out and queue the other half
+	 * again. That way a slow device cannot stall the end of the render on
+	 * one big tile while the faster devices sit idle. Only done when tiles
+	 * are not pinned to devices, since pinned tiles have buffers and result
+	 * slices tied to the device they were generated for. */
+	if(!preserve_tile_device && num_devices > 1 &&
+	   (int)state.tiles[logical_device].size() + 1 < num_devices)
+	{
+		const int min_tile_split_size = 8;
+
+		if(tile.w >= tile.h && tile.w >= 2*min_tile_split_size) {
+			int half = tile.w/2;
+			state.tiles[logical_device].push_front(
+			        Tile(state.num_tiles, tile.x + half, tile.y, tile.w - half, tile.h, tile.device));
+			tile.w = half;
+			state.num_tiles++;
+		}
+		else if(tile.h > tile.w && tile.h >= 2*min_tile_split_size) {
+			int half = tile.h/2;
+			state.tiles[logical_device].push_front(
+			        Tile(state.num_tiles, tile.x, tile.y + half, tile.w, tile.h - half, tile.device));
+			tile.h = half;
+			state.num_tiles++;
+		}
+	}
+
 	state.num_rendered_tiles++;
 	return true;
 }
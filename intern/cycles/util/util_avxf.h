@@ -0,0 +1,102 @@
+/*
+ * Adapted from code copyright 2009-2013 Intel Corporation
+ * Modifications Copyright 2016, Blender Foundation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __UTIL_AVXF_H__
+#define __UTIL_AVXF_H__
+
+CCL_NAMESPACE_BEGIN
+
+#ifdef __KERNEL_AVX__
+
+/*! 8-wide AVX float type. */
+struct avxf
+{
+	typedef avxf Float;
+
+	enum   { size = 8 };  // number of SIMD elements
+	union { __m256 m256; float f[8]; int i[8]; }; // data
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Constructors, Assignment & Cast Operators
+	////////////////////////////////////////////////////////////////////////////////
+
+	__forceinline avxf           () {}
+	__forceinline avxf           (const avxf& other) { m256 = other.m256; }
+	__forceinline avxf& operator=(const avxf& other) { m256 = other.m256; return *this; }
+
+	__forceinline avxf(const __m256 a) : m256(a) {}
+	__forceinline operator const __m256&(void) const { return m256; }
+	__forceinline operator       __m256&(void)       { return m256; }
+
+	__forceinline avxf          (float a) : m256(_mm256_set1_ps(a)) {}
+
+	/* Same 4-wide value replicated into both halves. */
+	__forceinline avxf          (const ssef& a)
+	: m256(_mm256_insertf128_ps(_mm256_castps128_ps256(a), a, 1)) {}
+
+	/* Low and high 4-wide halves. */
+	__forceinline avxf          (const ssef& low, const ssef& high)
+	: m256(_mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1)) {}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Loads and Stores
+	////////////////////////////////////////////////////////////////////////////////
+
+	static __forceinline avxf load (const void* const a) { return _mm256_load_ps((float*)a); }
+	static __forceinline avxf loadu(const void* const a) { return _mm256_loadu_ps((float*)a); }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Unary Operators
+////////////////////////////////////////////////////////////////////////////////
+
+__forceinline const avxf operator +(const avxf& a) { return a; }
+__forceinline const avxf operator -(const avxf& a) { return _mm256_xor_ps(a.m256, _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000))); }
+
+__forceinline const ssef low (const avxf& a) { return _mm256_castps256_ps128(a.m256); }
+__forceinline const ssef high(const avxf& a) { return _mm256_extractf128_ps(a.m256, 1); }
+
+////////////////////////////////////////////////////////////////////////////////
+/// Binary Operators
+////////////////////////////////////////////////////////////////////////////////
+
+__forceinline const avxf operator +(const avxf& a, const avxf& b) { return _mm256_add_ps(a.m256, b.m256); }
+__forceinline const avxf operator -(const avxf& a, const avxf& b) { return _mm256_sub_ps(a.m256, b.m256); }
+__forceinline const avxf operator *(const avxf& a, const avxf& b) { return _mm256_mul_ps(a.m256, b.m256); }
+
+__forceinline const avxf min(const avxf& a, const avxf& b) { return _mm256_min_ps(a.m256, b.m256); }
+__forceinline const avxf max(const avxf& a, const avxf& b) { return _mm256_max_ps(a.m256, b.m256); }
+
+////////////////////////////////////////////////////////////////////////////////
+/// Ternary Operators
+////////////////////////////////////////////////////////////////////////////////
+
+#if defined(__KERNEL_AVX2__)
+__forceinline const avxf madd (const avxf& a, const avxf& b, const avxf& c) { return _mm256_fmadd_ps(a, b, c); }
+__forceinline const avxf msub (const avxf& a, const avxf& b, const avxf& c) { return _mm256_fmsub_ps(a, b, c); }
+__forceinline const avxf nmadd(const avxf& a, const avxf& b, const avxf& c) { return _mm256_fnmadd_ps(a, b, c); }
+#else
+__forceinline const avxf madd (const avxf& a, const avxf& b, const avxf& c) { return a*b+c; }
+__forceinline const avxf msub (const avxf& a, const avxf& b, const avxf& c) { return a*b-c; }
+__forceinline const avxf nmadd(const avxf& a, const avxf& b, const avxf& c) { return c-a*b; }
+#endif
+
+#endif /* __KERNEL_AVX__ */
+
+CCL_NAMESPACE_END
+
+#endif /* __UTIL_AVXF_H__ */
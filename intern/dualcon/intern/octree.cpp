@@ -2063,7 +2063,9 @@ void Octree::writeOut()
 	actualVerts = 0;
 	actualQuads = 0;
 
-	generateMinimizer(root, st, dimen, maxDepth, offset);
+	std::vector<MinimizerJob> jobs;
+	gatherMinimizerLeaves(root, st, dimen, maxDepth, offset, jobs);
+	generateMinimizers(jobs);
 	cellProcContour(root, 0, maxDepth);
 	dc_printf("Vertices written: %d Quads written: %d \n", offset, actualQuads);
 }
@@ -2257,27 +2259,16 @@ void Octree::computeMinimizer(const LeafNode *leaf, int st[3], int len,
 	}
 }
 
-void Octree::generateMinimizer(Node *node, int st[3], int len, int height, int& offset)
+/* Collect the leaf cells in output order and assign their minimizer
+   indices, actually solving for the minimizing vertices is deferred to
+   generateMinimizers() so it can run in parallel */
+void Octree::gatherMinimizerLeaves(Node *node, int st[3], int len, int height, int& offset,
+                                   std::vector<MinimizerJob>& jobs)
 {
-	int i, j;
+	int i;
 
 	if (height == 0) {
-		// Leaf cell, generate
-
-		// First, find minimizer
-		float rvalue[3];
-		rvalue[0] = (float) st[0] + len / 2;
-		rvalue[1] = (float) st[1] + len / 2;
-		rvalue[2] = (float) st[2] + len / 2;
-		computeMinimizer(&node->leaf, st, len, rvalue);
-
-		// Update
-		//float fnst[3];
-		for (j = 0; j < 3; j++) {
-			rvalue[j] = rvalue[j] * range / dimen + origin[j];
-			//fnst[j] = st[j] * range / dimen + origin[j];
-		}
-
+		// Leaf cell
 		int mult = 0, smask = getSignMask(&node->leaf);
 
 		if (use_manifold) {
@@ -2289,9 +2280,14 @@ void Octree::generateMinimizer(Node *node, int st[3], int len, int height, int&
 			}
 		}
 
-		for (j = 0; j < mult; j++) {
-			add_vert(output_mesh, rvalue);
-		}
+		MinimizerJob job;
+		job.leaf = &node->leaf;
+		job.st[0] = st[0];
+		job.st[1] = st[1];
+		job.st[2] = st[2];
+		job.len = len;
+		job.mult = mult;
+		jobs.push_back(job);
 
 		// Store the index
 		setMinimizerIndex(&node->leaf, offset);
@@ -2309,14 +2305,46 @@ void Octree::generateMinimizer(Node *node, int st[3], int len, int height, int&
 				nst[1] = st[1] + vertmap[i][1] * len;
 				nst[2] = st[2] + vertmap[i][2] * len;
 
-				generateMinimizer(node->internal.get_child(count),
-				                  nst, len, height - 1, offset);
+				gatherMinimizerLeaves(node->internal.get_child(count),
+				                      nst, len, height - 1, offset, jobs);
 				count++;
 			}
 		}
 	}
 }
 
+void Octree::generateMinimizers(std::vector<MinimizerJob>& jobs)
+{
+	const int numJobs = (int)jobs.size();
+	std::vector<float> coords((size_t)numJobs * 3);
+	int i, j;
+
+	/* Solving the QEF per leaf dominates the output stage and is
+	   independent per cell, the vertices are then added to the output
+	   mesh in their original order below */
+#ifdef _OPENMP
+#pragma omp parallel for private(j) schedule(dynamic, 1024)
+#endif
+	for (i = 0; i < numJobs; i++) {
+		MinimizerJob& job = jobs[i];
+		float rvalue[3];
+		rvalue[0] = (float) job.st[0] + job.len / 2;
+		rvalue[1] = (float) job.st[1] + job.len / 2;
+		rvalue[2] = (float) job.st[2] + job.len / 2;
+		computeMinimizer(job.leaf, job.st, job.len, rvalue);
+
+		for (j = 0; j < 3; j++) {
+			coords[(size_t)i * 3 + j] = rvalue[j] * range / dimen + origin[j];
+		}
+	}
+
+	for (i = 0; i < numJobs; i++) {
+		for (j = 0; j < jobs[i].mult; j++) {
+			add_vert(output_mesh, &coords[(size_t)i * 3]);
+		}
+	}
+}
+
 void Octree::processEdgeWrite(Node *node[4], int /*depth*/[4], int /*maxdep*/, int dir)
 {
 	//int color = 0;
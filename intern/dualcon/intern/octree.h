@@ -27,6 +27,7 @@
 #include <cstring>
 #include <stdio.h>
 #include <math.h>
+#include <vector>
 #include "GeoCommon.h"
 #include "Projections.h"
 #include "ModelReader.h"
@@ -223,6 +224,17 @@ struct PathList {
 };
 
 
+/**
+ * One leaf cell gathered during the output traversal, so that the
+ * minimizing vertices can be computed in parallel afterwards.
+ */
+struct MinimizerJob {
+	LeafNode *leaf;
+	int st[3];
+	int len;
+	int mult;
+};
+
 /**
  * Class for building and processing an octree
  */
@@ -421,7 +433,9 @@ class Octree
 	void writeOut();
 
 	void countIntersection(Node *node, int height, int& nedge, int& ncell, int& nface);
-	void generateMinimizer(Node *node, int st[3], int len, int height, int& offset);
+	void gatherMinimizerLeaves(Node *node, int st[3], int len, int height, int& offset,
+	                           std::vector<MinimizerJob>& jobs);
+	void generateMinimizers(std::vector<MinimizerJob>& jobs);
 	void computeMinimizer(const LeafNode * leaf, int st[3], int len,
 	                      float rvalue[3]) const;
 	/**
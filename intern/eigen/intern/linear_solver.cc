@@ -29,6 +29,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <vector>
 
@@ -112,6 +113,11 @@ struct LinearSolver
 
 	EigenSparseLU *sparseLU;
 
+	/* sparsity pattern of the last factorized matrix, used to decide if the
+	 * symbolic analysis can be reused after a matrix refresh */
+	std::vector<int> pattern_outer;
+	std::vector<int> pattern_inner;
+
 	int num_variables;
 	std::vector<Variable> variable;
 
@@ -258,6 +264,21 @@ void EIG_linear_solver_matrix_add(LinearSolver *solver, int row, int col, double
 	}
 }
 
+void EIG_linear_solver_matrix_refresh(LinearSolver *solver)
+{
+	if (solver->state != LinearSolver::STATE_MATRIX_SOLVED)
+		return;
+
+	/* variable indexing is kept, only the coefficients are entered again */
+	for (int i = 0; i < solver->num_variables; i++)
+		solver->variable[i].a.clear();
+
+	solver->Mtriplets.clear();
+	solver->Mtriplets.reserve(std::max(solver->m, solver->n)*3);
+
+	solver->state = LinearSolver::STATE_MATRIX_CONSTRUCT;
+}
+
 /* Right hand side */
 
 void EIG_linear_solver_right_hand_side_add(LinearSolver *solver, int rhs, int index, double value)
@@ -299,12 +320,30 @@ bool EIG_linear_solver_solve(LinearSolver *solver)
 		EigenSparseMatrix& M = (solver->least_squares)? solver->MtM: solver->M;
 		M.makeCompressed();
 
-		/* perform sparse LU factorization */
-		EigenSparseLU *sparseLU = new EigenSparseLU();
-		solver->sparseLU = sparseLU;
+		/* only redo the symbolic analysis when the sparsity pattern changed,
+		 * repeated numeric factorizations after a matrix refresh reuse it */
+		const int outer_size = (int)M.outerSize() + 1;
+		const int nnz = (int)M.nonZeros();
+
+		bool pattern_changed =
+			(solver->pattern_outer.size() != (size_t)outer_size) ||
+			(solver->pattern_inner.size() != (size_t)nnz) ||
+			(memcmp(&solver->pattern_outer[0], M.outerIndexPtr(), sizeof(int)*outer_size) != 0) ||
+			(nnz && memcmp(&solver->pattern_inner[0], M.innerIndexPtr(), sizeof(int)*nnz) != 0);
+
+		if (solver->sparseLU == NULL)
+			solver->sparseLU = new EigenSparseLU();
+
+		if (pattern_changed) {
+			solver->sparseLU->analyzePattern(M);
+
+			solver->pattern_outer.assign(M.outerIndexPtr(), M.outerIndexPtr() + outer_size);
+			solver->pattern_inner.assign(M.innerIndexPtr(), M.innerIndexPtr() + nnz);
+		}
 
-		sparseLU->compute(M);
-		result = (sparseLU->info() == Eigen::Success);
+		/* perform numeric sparse LU factorization */
+		solver->sparseLU->factorize(M);
+		result = (solver->sparseLU->info() == Eigen::Success);
 
 		solver->state = LinearSolver::STATE_MATRIX_SOLVED;
 	}
@@ -62,6 +62,14 @@ void EIG_linear_solver_right_hand_side_add(LinearSolver *solver, int rhs, int in
 
 bool EIG_linear_solver_solve(LinearSolver *solver);
 
+/* Reopen a solved system so the matrix coefficients can be entered again.
+ * When the sparsity pattern of the new matrix matches the previous one, the
+ * next solve reuses the symbolic analysis and only redoes the numeric
+ * factorization, which is considerably cheaper than a full refactorization.
+ * A changed pattern is detected and handled with a full refactorization. */
+
+void EIG_linear_solver_matrix_refresh(LinearSolver *solver);
+
 /* Debugging */
 
 void EIG_linear_solver_print_matrix(LinearSolver *solver);
@@ -16,6 +16,10 @@
 #include <algorithm>
 #include <stdio.h>
 
+#ifndef PARALLEL
+#define PARALLEL 0
+#endif // PARALLEL
+
 #ifdef sun
 #include "ieeefp.h"
 #endif
@@ -184,18 +188,56 @@ void IsoSurface::triangulate( void )
 		0,0,0,0,  1,1,1,1 };
 
 	const int coAdd=2;
-  // let the cubes march 
+  // let the cubes march
 	if(mSubdivs<=1) {
 
-		pz = mStart[2]-gsz*0.5;
+		// first pass: scan the whole grid for cells intersected by the
+		// isosurface, parallel over k slabs. the second pass below, which
+		// shares the edge vertex arrays and output vectors and thus stays
+		// serial, then only has to visit the surface cells
+		vector< vector<int> > slabCells(mSizez);
+#if PARALLEL==1
+#pragma omp parallel for schedule(static)
+#endif // PARALLEL==1
 		for(int k=1;k<(mSizez-2);k++) {
-			pz += gsz;
-			py = mStart[1]-gsy*0.5;
+			float val[8];
+			int cIndex;
 			for(int j=1;j<(mSizey-2);j++) {
-				py += gsy;
-				px = mStart[0]-gsx*0.5;
 				for(int i=1;i<(mSizex-2);i++) {
-					px += gsx;
+					val[0] = *getData(i  ,j  ,k  );
+					val[1] = *getData(i+1,j  ,k  );
+					val[2] = *getData(i+1,j+1,k  );
+					val[3] = *getData(i  ,j+1,k  );
+					val[4] = *getData(i  ,j  ,k+1);
+					val[5] = *getData(i+1,j  ,k+1);
+					val[6] = *getData(i+1,j+1,k+1);
+					val[7] = *getData(i  ,j+1,k+1);
+
+					cIndex = 0;
+					if (val[0] < mIsoValue) cIndex |= 1;
+					if (val[1] < mIsoValue) cIndex |= 2;
+					if (val[2] < mIsoValue) cIndex |= 4;
+					if (val[3] < mIsoValue) cIndex |= 8;
+					if (val[4] < mIsoValue) cIndex |= 16;
+					if (val[5] < mIsoValue) cIndex |= 32;
+					if (val[6] < mIsoValue) cIndex |= 64;
+					if (val[7] < mIsoValue) cIndex |= 128;
+
+					if (mcEdgeTable[cIndex] != 0) {
+						slabCells[k].push_back(j*mSizex+i);
+					}
+				}
+			}
+		}
+
+		for(int k=1;k<(mSizez-2);k++) {
+			pz = mStart[2]+(((double)k)-0.5)*gsz;
+			for(size_t n=0; n<slabCells[k].size(); n++) {
+				{
+					const int i = slabCells[k][n] % mSizex;
+					const int j = slabCells[k][n] / mSizex;
+					px = mStart[0]+(((double)i)-0.5)*gsx;
+					py = mStart[1]+(((double)j)-0.5)*gsy;
 
 					value[0] = *getData(i  ,j  ,k  );
 					value[1] = *getData(i+1,j  ,k  );
@@ -290,15 +332,15 @@ void IsoSurface::triangulate( void )
 						} else { continue; }
 					}
 
-					// Create the triangles... 
+					// Create the triangles...
 					for(int e=0; mcTriTable[cubeIndex][e]!=-1; e+=3) {
 						mIndices.push_back( triIndices[ mcTriTable[cubeIndex][e+0] ] );
 						mIndices.push_back( triIndices[ mcTriTable[cubeIndex][e+1] ] );
 						mIndices.push_back( triIndices[ mcTriTable[cubeIndex][e+2] ] );
 					}
-					
-				}//i
-			}// j
+
+				}
+			}// cells
 
 			// copy edge arrays
 			if(!mUseFullEdgeArrays) {
@@ -22,6 +22,25 @@
 
 #include <zlib.h>
 
+#ifndef PARALLEL
+#define PARALLEL 0
+#endif // PARALLEL
+
+//! in-memory image of one output file, compression and disc IO of all
+//! files of a frame run in parallel once the scene walk is done
+typedef struct ntlDumpJob {
+	string filename;
+	const char *gzmode;
+	vector<unsigned char> data;
+} ntlDumpJob;
+
+//! append raw bytes to a dump job buffer
+static void dumpAppend(vector<unsigned char> &data, const void *ptr, size_t size)
+{
+	const unsigned char *bytes = (const unsigned char *)ptr;
+	data.insert(data.end(), bytes, bytes+size);
+}
+
 
 
 /******************************************************************************
@@ -73,6 +92,7 @@ int ntlBlenderDumper::renderScene( void )
   vector<ntlTriangle> Triangles;
   vector<ntlVec3Gfx>  Vertices;
   vector<ntlVec3Gfx>  VertNormals;
+	vector<ntlDumpJob>  dumpJobs;
 
 	// check geo objects
 	int idCnt = 0;          // give IDs to objects
@@ -134,19 +154,21 @@ int ntlBlenderDumper::renderScene( void )
 				if(debugOut) debMsgStd("ntlBlenderDumper::renderScene",DM_MSG,"B-Dumping: "<< (*siter)->getName() 
 						<<", triangles:"<<Triangles.size()<<", vertices:"<<Vertices.size()<<
 						" to "<<boutfilename.str() , 7);
-				gzFile gzf;
 
 				// output velocities if desired
 				if((!isPreview) && (lbm->getDumpVelocities())) {
 					std::ostringstream bvelfilename;
 					bvelfilename << boutfilename.str();
 					bvelfilename << ".bvel.gz";
-					gzf = gzopen(bvelfilename.str().c_str(), "wb9");
-					if(gzf) {
+					dumpJobs.resize(dumpJobs.size()+1);
+					ntlDumpJob &job = dumpJobs.back();
+					job.filename = bvelfilename.str();
+					job.gzmode = "wb9";
+					{
 						int numVerts;
 						if(sizeof(numVerts)!=4) { errMsg("ntlBlenderDumper::renderScene","Invalid int size"); return 1; }
 						numVerts = Vertices.size();
-						gzwrite(gzf, &numVerts, sizeof(numVerts));
+						dumpAppend(job.data, &numVerts, sizeof(numVerts));
 						for(size_t i=0; i<Vertices.size(); i++) {
 							// returns smoothed velocity, scaled by frame time
 							ntlVec3Gfx v = lbm->getVelocityAt( Vertices[i][0], Vertices[i][1], Vertices[i][2] );
@@ -154,18 +176,17 @@ int ntlBlenderDumper::renderScene( void )
 							for(int j=0; j<3; j++) {
 								float vertp = v[j];
 								//if(i<20) errMsg("ntlBlenderDumper","DUMP_VEL final "<<i<<" = "<<v);
-								gzwrite(gzf, &vertp, sizeof(vertp)); }
+								dumpAppend(job.data, &vertp, sizeof(vertp)); }
 						}
-						gzclose( gzf );
 					}
 				}
 
-				// compress all bobj's 
+				// compress all bobj's
 				boutfilename << ".bobj.gz";
-				gzf = gzopen(boutfilename.str().c_str(), "wb1"); // wb9 is slow for large meshes!
-				if (!gzf) {
-					errMsg("ntlBlenderDumper::renderScene","Unable to open output '" + boutfilename.str() + "' ");
-					return 1; }
+				dumpJobs.resize(dumpJobs.size()+1);
+				ntlDumpJob &job = dumpJobs.back();
+				job.filename = boutfilename.str();
+				job.gzmode = "wb1"; // wb9 is slow for large meshes!
 
 				// dont transform velocity output, this is handled in blender
 				// current transform matrix
@@ -194,15 +215,15 @@ int ntlBlenderDumper::renderScene( void )
 				}
 
 				
-				// write to file
+				// write to buffer
 				int numVerts;
 				if(sizeof(numVerts)!=4) { errMsg("ntlBlenderDumper::renderScene","Invalid int size"); return 1; }
 				numVerts = Vertices.size();
-				gzwrite(gzf, &numVerts, sizeof(numVerts));
+				dumpAppend(job.data, &numVerts, sizeof(numVerts));
 				for(size_t i=0; i<Vertices.size(); i++) {
 					for(int j=0; j<3; j++) {
 						float vertp = Vertices[i][j];
-						gzwrite(gzf, &vertp, sizeof(vertp)); }
+						dumpAppend(job.data, &vertp, sizeof(vertp)); }
 				}
 
 				// should be the same as Vertices.size
@@ -210,28 +231,52 @@ int ntlBlenderDumper::renderScene( void )
 					errMsg("ntlBlenderDumper::renderScene","Normals have to have same size as vertices!");
 					VertNormals.resize( Vertices.size() );
 				}
-				gzwrite(gzf, &numVerts, sizeof(numVerts));
+				dumpAppend(job.data, &numVerts, sizeof(numVerts));
 				for(size_t i=0; i<VertNormals.size(); i++) {
 					for(int j=0; j<3; j++) {
 						float normp = VertNormals[i][j];
-						gzwrite(gzf, &normp, sizeof(normp)); }
+						dumpAppend(job.data, &normp, sizeof(normp)); }
 				}
 
 				int numTris = Triangles.size();
-				gzwrite(gzf, &numTris, sizeof(numTris));
+				dumpAppend(job.data, &numTris, sizeof(numTris));
 				for(size_t i=0; i<Triangles.size(); i++) {
 					for(int j=0; j<3; j++) {
 						int triIndex = Triangles[i].getPoints()[j];
-						gzwrite(gzf, &triIndex, sizeof(triIndex)); }
+						dumpAppend(job.data, &triIndex, sizeof(triIndex)); }
 				}
-				gzclose( gzf );
-				debMsgStd("ntlBlenderDumper::renderScene",DM_NOTIFY," Wrote: '"<<boutfilename.str()<<"' ", 2);
 				numGMs++;
 			}
 		}
 
 	}
 
+	// compress and write all files of this frame, deflate is the main cost
+	// for large meshes so the jobs run parallel to each other
+	int writeErrors = 0;
+#if PARALLEL==1
+#pragma omp parallel for schedule(dynamic)
+#endif // PARALLEL==1
+	for(int jobi=0; jobi<(int)dumpJobs.size(); jobi++) {
+		gzFile gzf = gzopen(dumpJobs[jobi].filename.c_str(), dumpJobs[jobi].gzmode);
+		if(!gzf) {
+#if PARALLEL==1
+#pragma omp atomic
+#endif // PARALLEL==1
+			writeErrors++;
+			continue;
+		}
+		gzwrite(gzf, &dumpJobs[jobi].data[0], dumpJobs[jobi].data.size());
+		gzclose(gzf);
+	}
+	for(int jobi=0; jobi<(int)dumpJobs.size(); jobi++) {
+		debMsgStd("ntlBlenderDumper::renderScene",DM_NOTIFY," Wrote: '"<<dumpJobs[jobi].filename<<"' ", 2);
+	}
+	if(writeErrors>0) {
+		errMsg("ntlBlenderDumper::renderScene","Unable to write "<<writeErrors<<" output file(s)");
+		return 1;
+	}
+
 	// output ecr config file
 	if(numGMs>0) {
 		if(debugOut) debMsgStd("ntlBlenderDumper::renderScene",DM_MSG,"Objects dumped: "<<numGMs, 10);
@@ -51,8 +51,22 @@ typedef struct MemHeadAligned {
 	size_t len;
 } MemHeadAligned;
 
-static unsigned int totblock = 0;
-static size_t mem_in_use = 0, mmap_in_use = 0, peak_mem = 0;
+/* The total counters are sharded over cache line sized slots, so that threads
+ * allocating concurrently don't all bounce one hot line between their caches.
+ * The slot is derived from the block address, which means the free of a block
+ * always decrements the slot its allocation incremented: individual slots can
+ * wrap around but the (unsigned) sum over all of them stays exact. */
+typedef struct MemCount {
+	size_t mem_in_use;
+	size_t mmap_in_use;
+	unsigned int totblock;
+	char pad[64 - (2 * sizeof(size_t)) - sizeof(unsigned int)];
+} MemCount;
+
+#define MEM_COUNT_SLOTS 16
+
+static MemCount mem_count[MEM_COUNT_SLOTS];
+static size_t peak_mem = 0;
 static bool malloc_debug_memset = false;
 
 static void (*error_callback)(const char *) = NULL;
@@ -70,6 +84,42 @@ enum {
 #define MEMHEAD_IS_MMAP(memhead) ((memhead)->len & (size_t) MEMHEAD_MMAP_FLAG)
 #define MEMHEAD_IS_ALIGNED(memhead) ((memhead)->len & (size_t) MEMHEAD_ALIGN_FLAG)
 
+/* shift skips the bits that are constant within a cache line */
+MEM_INLINE MemCount *mem_count_slot(const void *ptr)
+{
+	return &mem_count[((size_t)ptr >> 6) & (MEM_COUNT_SLOTS - 1)];
+}
+
+MEM_INLINE size_t mem_count_mem_in_use(void)
+{
+	size_t total = 0;
+	int i;
+	for (i = 0; i < MEM_COUNT_SLOTS; i++) {
+		total += mem_count[i].mem_in_use;
+	}
+	return total;
+}
+
+MEM_INLINE size_t mem_count_mmap_in_use(void)
+{
+	size_t total = 0;
+	int i;
+	for (i = 0; i < MEM_COUNT_SLOTS; i++) {
+		total += mem_count[i].mmap_in_use;
+	}
+	return total;
+}
+
+MEM_INLINE unsigned int mem_count_totblock(void)
+{
+	unsigned int total = 0;
+	int i;
+	for (i = 0; i < MEM_COUNT_SLOTS; i++) {
+		total += mem_count[i].totblock;
+	}
+	return total;
+}
+
 /* Uncomment this to have proper peak counter. */
 #define USE_ATOMIC_MAX
 
@@ -133,6 +183,7 @@ void MEM_lockfree_freeN(void *vmemh)
 {
 	MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
 	size_t len = MEM_lockfree_allocN_len(vmemh);
+	MemCount *count;
 
 	if (vmemh == NULL) {
 		print_error("Attempt to free NULL pointer\n");
@@ -142,11 +193,12 @@ void MEM_lockfree_freeN(void *vmemh)
 		return;
 	}
 
-	atomic_sub_u(&totblock, 1);
-	atomic_sub_z(&mem_in_use, len);
+	count = mem_count_slot(vmemh);
+	atomic_sub_u(&count->totblock, 1);
+	atomic_sub_z(&count->mem_in_use, len);
 
 	if (MEMHEAD_IS_MMAP(memh)) {
-		atomic_sub_z(&mmap_in_use, len);
+		atomic_sub_z(&count->mmap_in_use, len);
 #if defined(WIN32)
 		/* our windows mmap implementation is not thread safe */
 		mem_lock_thread();
@@ -286,15 +338,17 @@ void *MEM_lockfree_callocN(size_t len, const char *str)
 	memh = (MemHead *)calloc(1, len + sizeof(MemHead));
 
 	if (LIKELY(memh)) {
+		void *ptr = PTR_FROM_MEMHEAD(memh);
+		MemCount *count = mem_count_slot(ptr);
+
 		memh->len = len;
-		atomic_add_u(&totblock, 1);
-		atomic_add_z(&mem_in_use, len);
-		update_maximum(&peak_mem, mem_in_use);
+		atomic_add_u(&count->totblock, 1);
+		atomic_add_z(&count->mem_in_use, len);
 
-		return PTR_FROM_MEMHEAD(memh);
+		return ptr;
 	}
 	print_error("Calloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
-	            SIZET_ARG(len), str, (unsigned int) mem_in_use);
+	            SIZET_ARG(len), str, (unsigned int) mem_count_mem_in_use());
 	return NULL;
 }
 
@@ -307,19 +361,21 @@ void *MEM_lockfree_mallocN(size_t len, const char *str)
 	memh = (MemHead *)malloc(len + sizeof(MemHead));
 
 	if (LIKELY(memh)) {
+		void *ptr = PTR_FROM_MEMHEAD(memh);
+		MemCount *count = mem_count_slot(ptr);
+
 		if (UNLIKELY(malloc_debug_memset && len)) {
 			memset(memh + 1, 255, len);
 		}
 
 		memh->len = len;
-		atomic_add_u(&totblock, 1);
-		atomic_add_z(&mem_in_use, len);
-		update_maximum(&peak_mem, mem_in_use);
+		atomic_add_u(&count->totblock, 1);
+		atomic_add_z(&count->mem_in_use, len);
 
-		return PTR_FROM_MEMHEAD(memh);
+		return ptr;
 	}
 	print_error("Malloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
-	            SIZET_ARG(len), str, (unsigned int) mem_in_use);
+	            SIZET_ARG(len), str, (unsigned int) mem_count_mem_in_use());
 	return NULL;
 }
 
@@ -349,6 +405,9 @@ void *MEM_lockfree_mallocN_aligned(size_t len, size_t alignment, const char *str
 		len + extra_padding + sizeof(MemHeadAligned), alignment);
 
 	if (LIKELY(memh)) {
+		void *ptr;
+		MemCount *count;
+
 		/* We keep padding in the beginning of MemHead,
 		 * this way it's always possible to get MemHead
 		 * from the data pointer.
@@ -359,16 +418,18 @@ void *MEM_lockfree_mallocN_aligned(size_t len, size_t alignment, const char *str
 			memset(memh + 1, 255, len);
 		}
 
+		ptr = PTR_FROM_MEMHEAD(memh);
+		count = mem_count_slot(ptr);
+
 		memh->len = len | (size_t) MEMHEAD_ALIGN_FLAG;
 		memh->alignment = (short) alignment;
-		atomic_add_u(&totblock, 1);
-		atomic_add_z(&mem_in_use, len);
-		update_maximum(&peak_mem, mem_in_use);
+		atomic_add_u(&count->totblock, 1);
+		atomic_add_z(&count->mem_in_use, len);
 
-		return PTR_FROM_MEMHEAD(memh);
+		return ptr;
 	}
 	print_error("Malloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
-	            SIZET_ARG(len), str, (unsigned int) mem_in_use);
+	            SIZET_ARG(len), str, (unsigned int) mem_count_mem_in_use());
 	return NULL;
 }
 
@@ -395,19 +456,19 @@ void *MEM_lockfree_mapallocN(size_t len, const char *str)
 #endif
 
 	if (memh != (MemHead *)-1) {
-		memh->len = len | (size_t) MEMHEAD_MMAP_FLAG;
-		atomic_add_u(&totblock, 1);
-		atomic_add_z(&mem_in_use, len);
-		atomic_add_z(&mmap_in_use, len);
+		void *ptr = PTR_FROM_MEMHEAD(memh);
+		MemCount *count = mem_count_slot(ptr);
 
-		update_maximum(&peak_mem, mem_in_use);
-		update_maximum(&peak_mem, mmap_in_use);
+		memh->len = len | (size_t) MEMHEAD_MMAP_FLAG;
+		atomic_add_u(&count->totblock, 1);
+		atomic_add_z(&count->mem_in_use, len);
+		atomic_add_z(&count->mmap_in_use, len);
 
-		return PTR_FROM_MEMHEAD(memh);
+		return ptr;
 	}
 	print_error("Mapalloc returns null, fallback to regular malloc: "
 	            "len=" SIZET_FORMAT " in %s, total %u\n",
-	            SIZET_ARG(len), str, (unsigned int) mmap_in_use);
+	            SIZET_ARG(len), str, (unsigned int) mem_count_mmap_in_use());
 	return MEM_lockfree_callocN(len, str);
 }
 
@@ -428,7 +489,7 @@ void MEM_lockfree_callbackmemlist(void (*func)(void *))
 void MEM_lockfree_printmemlist_stats(void)
 {
 	printf("\ntotal memory len: %.3f MB\n",
-	       (double)mem_in_use / (double)(1024 * 1024));
+	       (double)MEM_lockfree_get_memory_in_use() / (double)(1024 * 1024));
 	printf("peak memory len: %.3f MB\n",
 	       (double)peak_mem / (double)(1024 * 1024));
 	printf("\nFor more detailed per-block statistics run Blender with memory debugging command line argument.\n");
@@ -462,27 +523,33 @@ void MEM_lockfree_set_memory_debug(void)
 
 size_t MEM_lockfree_get_memory_in_use(void)
 {
-	return mem_in_use;
+	/* With the sharded counters the peak can no longer be maintained exactly per
+	 * allocation, it is sampled whenever the totals are read instead (the info
+	 * header polls them once per redraw). */
+	size_t mem_total = mem_count_mem_in_use();
+	update_maximum(&peak_mem, mem_total);
+	return mem_total;
 }
 
 size_t MEM_lockfree_get_mapped_memory_in_use(void)
 {
-	return mmap_in_use;
+	return mem_count_mmap_in_use();
 }
 
 unsigned int MEM_lockfree_get_memory_blocks_in_use(void)
 {
-	return totblock;
+	return mem_count_totblock();
 }
 
 /* dummy */
 void MEM_lockfree_reset_peak_memory(void)
 {
-	peak_mem = mem_in_use;
+	peak_mem = mem_count_mem_in_use();
 }
 
 size_t MEM_lockfree_get_peak_memory(void)
 {
+	update_maximum(&peak_mem, mem_count_mem_in_use());
 	return peak_mem;
 }
 
@@ -66,6 +66,23 @@ enum {
 
 namespace {
 
+// Shared Ceres solver configuration for all bundle adjustment passes:
+// sparse iterative Schur complement solver, threaded over all cores
+// when OpenMP is available.
+void ConfigureBundleSolverOptions(ceres::Solver::Options *options) {
+  options->use_nonmonotonic_steps = true;
+  options->preconditioner_type = ceres::SCHUR_JACOBI;
+  options->linear_solver_type = ceres::ITERATIVE_SCHUR;
+  options->use_explicit_schur_complement = true;
+  options->use_inner_iterations = true;
+  options->max_num_iterations = 100;
+
+#ifdef _OPENMP
+  options->num_threads = omp_get_max_threads();
+  options->num_linear_solver_threads = omp_get_max_threads();
+#endif
+}
+
 // Cost functor which computes reprojection error of 3D point X
 // on camera defined by angle-axis rotation and it's translation
 // (which are in the same block due to optimization reasons).
@@ -421,17 +438,7 @@ void EuclideanBundlePointsOnly(const DistortionModelType distortion_model,
 
   // Configure the solver.
   ceres::Solver::Options options;
-  options.use_nonmonotonic_steps = true;
-  options.preconditioner_type = ceres::SCHUR_JACOBI;
-  options.linear_solver_type = ceres::ITERATIVE_SCHUR;
-  options.use_explicit_schur_complement = true;
-  options.use_inner_iterations = true;
-  options.max_num_iterations = 100;
-
-#ifdef _OPENMP
-  options.num_threads = omp_get_max_threads();
-  options.num_linear_solver_threads = omp_get_max_threads();
-#endif
+  ConfigureBundleSolverOptions(&options);
 
   // Solve!
   ceres::Solver::Summary summary;
@@ -591,17 +598,7 @@ void EuclideanBundleCommonIntrinsics(
 
   // Configure the solver.
   ceres::Solver::Options options;
-  options.use_nonmonotonic_steps = true;
-  options.preconditioner_type = ceres::SCHUR_JACOBI;
-  options.linear_solver_type = ceres::ITERATIVE_SCHUR;
-  options.use_explicit_schur_complement = true;
-  options.use_inner_iterations = true;
-  options.max_num_iterations = 100;
-
-#ifdef _OPENMP
-  options.num_threads = omp_get_max_threads();
-  options.num_linear_solver_threads = omp_get_max_threads();
-#endif
+  ConfigureBundleSolverOptions(&options);
 
   // Solve!
   ceres::Solver::Summary summary;
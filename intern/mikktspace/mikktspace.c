@@ -941,6 +941,9 @@ static void InitTriInfo(STriInfo pTriInfos[], const int piTriListIn[], const SMi
 	// pTriInfos[f].iFlag is cleared in GenerateInitialVerticesIndexList() which is called before this function.
 
 	// generate neighbor info list
+#ifdef _OPENMP
+#pragma omp parallel for private(i)
+#endif
 	for (f=0; f<iNrTrianglesIn; f++)
 		for (i=0; i<3; i++)
 		{
@@ -957,6 +960,10 @@ static void InitTriInfo(STriInfo pTriInfos[], const int piTriListIn[], const SMi
 		}
 
 	// evaluate first order derivatives
+	// (only per triangle data is written, the callbacks are read only)
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
 	for (f=0; f<iNrTrianglesIn; f++)
 	{
 		// initial values
@@ -1193,35 +1200,42 @@ static tbool GenerateTSpaces(STSpace psTspace[], const STriInfo pTriInfos[], con
                              const int iNrActiveGroups, const int piTriListIn[], const float fThresCos,
                              const SMikkTSpaceContext * pContext)
 {
-	STSpace * pSubGroupTspace = NULL;
-	SSubGroup * pUniSubGroups = NULL;
-	int * pTmpMembers = NULL;
-	int iMaxNrFaces=0, iUniqueTspaces=0, g=0, i=0;
+	int iMaxNrFaces=0, g=0;
+	tbool bRes = TTRUE;
 	for (g=0; g<iNrActiveGroups; g++)
 		if (iMaxNrFaces < pGroups[g].iNrFaces)
 			iMaxNrFaces = pGroups[g].iNrFaces;
 
 	if (iMaxNrFaces == 0) return TTRUE;
 
-	// make initial allocations
-	pSubGroupTspace = (STSpace *) malloc(sizeof(STSpace)*iMaxNrFaces);
-	pUniSubGroups = (SSubGroup *) malloc(sizeof(SSubGroup)*iMaxNrFaces);
-	pTmpMembers = (int *) malloc(sizeof(int)*iMaxNrFaces);
-	if (pSubGroupTspace==NULL || pUniSubGroups==NULL || pTmpMembers==NULL)
+	// the groups are independent of each other so they are processed in parallel.
+	// each thread gets its own scratch buffers, the writes to the shared psTspace
+	// array are serialized below.
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
 	{
-		if (pSubGroupTspace!=NULL) free(pSubGroupTspace);
-		if (pUniSubGroups!=NULL) free(pUniSubGroups);
-		if (pTmpMembers!=NULL) free(pTmpMembers);
-		return TFALSE;
-	}
-
-
-	iUniqueTspaces = 0;
+		STSpace * pSubGroupTspace = NULL;
+		SSubGroup * pUniSubGroups = NULL;
+		int * pTmpMembers = NULL;
+		int i=0;
+
+		// make initial allocations
+		pSubGroupTspace = (STSpace *) malloc(sizeof(STSpace)*iMaxNrFaces);
+		pUniSubGroups = (SSubGroup *) malloc(sizeof(SSubGroup)*iMaxNrFaces);
+		pTmpMembers = (int *) malloc(sizeof(int)*iMaxNrFaces);
+		if (pSubGroupTspace==NULL || pUniSubGroups==NULL || pTmpMembers==NULL)
+			bRes = TFALSE;	// only ever cleared so the race is benign
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
 	for (g=0; g<iNrActiveGroups; g++)
 	{
 		const SGroup * pGroup = &pGroups[g];
 		int iUniqueSubGroups = 0, s=0;
 
+		if (bRes)
 		for (i=0; i<pGroup->iNrFaces; i++)	// triangles
 		{
 			const int f = pGroup->pFaceIndices[i];	// triangle number
@@ -1304,14 +1318,8 @@ static tbool GenerateTSpaces(STSpace psTspace[], const STriInfo pTriInfos[], con
 				int * pIndices = (int *) malloc(sizeof(int)*iMembers);
 				if (pIndices==NULL)
 				{
-					// clean up and return false
-					int s=0;
-					for (s=0; s<iUniqueSubGroups; s++)
-						free(pUniSubGroups[s].pTriMembers);
-					free(pUniSubGroups);
-					free(pTmpMembers);
-					free(pSubGroupTspace);
-					return TFALSE;
+					bRes = TFALSE;
+					break;
 				}
 				pUniSubGroups[iUniqueSubGroups].iNrFaces = iMembers;
 				pUniSubGroups[iUniqueSubGroups].pTriMembers = pIndices;
@@ -1321,41 +1329,48 @@ static tbool GenerateTSpaces(STSpace psTspace[], const STriInfo pTriInfos[], con
 				++iUniqueSubGroups;
 			}
 
-			// output tspace
+			// output tspace.
+			// the two triangles of a quad share a slot so the read/modify/write
+			// is serialized, AvgTSpace is commutative so the order does not matter.
 			{
 				const int iOffs = pTriInfos[f].iTSpacesOffs;
 				const int iVert = pTriInfos[f].vert_num[index];
 				STSpace * pTS_out = &psTspace[iOffs+iVert];
-				assert(pTS_out->iCounter<2);
 				assert(((pTriInfos[f].iFlag&ORIENT_PRESERVING)!=0) == pGroup->bOrientPreservering);
-				if (pTS_out->iCounter==1)
-				{
-					*pTS_out = AvgTSpace(pTS_out, &pSubGroupTspace[l]);
-					pTS_out->iCounter = 2;	// update counter
-					pTS_out->bOrient = pGroup->bOrientPreservering;
-				}
-				else
+#ifdef _OPENMP
+#pragma omp critical
+#endif
 				{
-					assert(pTS_out->iCounter==0);
-					*pTS_out = pSubGroupTspace[l];
-					pTS_out->iCounter = 1;	// update counter
-					pTS_out->bOrient = pGroup->bOrientPreservering;
+					assert(pTS_out->iCounter<2);
+					if (pTS_out->iCounter==1)
+					{
+						*pTS_out = AvgTSpace(pTS_out, &pSubGroupTspace[l]);
+						pTS_out->iCounter = 2;	// update counter
+						pTS_out->bOrient = pGroup->bOrientPreservering;
+					}
+					else
+					{
+						assert(pTS_out->iCounter==0);
+						*pTS_out = pSubGroupTspace[l];
+						pTS_out->iCounter = 1;	// update counter
+						pTS_out->bOrient = pGroup->bOrientPreservering;
+					}
 				}
 			}
 		}
 
-		// clean up and offset iUniqueTspaces
+		// clean up
 		for (s=0; s<iUniqueSubGroups; s++)
 			free(pUniSubGroups[s].pTriMembers);
-		iUniqueTspaces += iUniqueSubGroups;
 	}
 
-	// clean up
-	free(pUniSubGroups);
-	free(pTmpMembers);
-	free(pSubGroupTspace);
+		// clean up
+		if (pUniSubGroups!=NULL) free(pUniSubGroups);
+		if (pTmpMembers!=NULL) free(pTmpMembers);
+		if (pSubGroupTspace!=NULL) free(pSubGroupTspace);
+	}
 
-	return TTRUE;
+	return bRes;
 }
 
 static STSpace EvalTspace(int face_indices[], const int iFaces, const int piTriListIn[], const STriInfo pTriInfos[],
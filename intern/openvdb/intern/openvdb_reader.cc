@@ -119,6 +119,12 @@ bool OpenVDBReader::hasGrid(const openvdb::Name &name) const
 
 openvdb::GridBase::Ptr OpenVDBReader::getGrid(const openvdb::Name &name) const
 {
+	GridCache::const_iterator it = m_grid_cache.find(name);
+
+	if (it != m_grid_cache.end()) {
+		return it->second;
+	}
+
 	return m_file->readGrid(name);
 }
 
@@ -127,8 +133,28 @@ size_t OpenVDBReader::numGrids() const
 	return m_file->getGrids()->size();
 }
 
+/* Force all grid trees into memory, so subsequent getGrid calls are mere
+ * cache lookups. Meant to run on a background thread, to warm up the next
+ * frame's file while the current one is being consumed. */
+void OpenVDBReader::prefetchGrids()
+{
+	try {
+		openvdb::GridPtrVecPtr grids = m_file->getGrids();
+		openvdb::GridPtrVec::const_iterator it;
+
+		for (it = grids->begin(); it != grids->end(); ++it) {
+			m_grid_cache[(*it)->getName()] = *it;
+		}
+	}
+	catch (const openvdb::IoError &e) {
+		std::cerr << e.what() << '\n';
+	}
+}
+
 void OpenVDBReader::cleanupFile()
 {
+	m_grid_cache.clear();
+
 	if (m_file) {
 		m_file->close();
 		delete m_file;
@@ -26,13 +26,20 @@
 #ifndef __OPENVDB_READER_H__
 #define __OPENVDB_READER_H__
 
+#include <map>
+
 #include <openvdb/openvdb.h>
 
 struct OpenVDBReader {
 private:
+	typedef std::map<openvdb::Name, openvdb::GridBase::Ptr> GridCache;
+
 	openvdb::MetaMap::Ptr m_meta_map;
 	openvdb::io::File *m_file;
 
+	/* grids forced into memory by prefetchGrids(), see getGrid() */
+	GridCache m_grid_cache;
+
 	void cleanupFile();
 
 public:
@@ -50,6 +57,8 @@ public:
 	bool hasGrid(const openvdb::Name &name) const;
 	openvdb::GridBase::Ptr getGrid(const openvdb::Name &name) const;
 	size_t numGrids() const;
+
+	void prefetchGrids();
 };
 
 #endif /* __OPENVDB_READER_H__ */
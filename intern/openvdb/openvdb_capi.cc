@@ -214,6 +214,11 @@ void OpenVDBReader_open(OpenVDBReader *reader, const char *filename)
 	reader->open(filename);
 }
 
+void OpenVDBReader_prefetch_grids(OpenVDBReader *reader)
+{
+	reader->prefetchGrids();
+}
+
 void OpenVDBReader_get_meta_fl(OpenVDBReader *reader, const char *name, float *value)
 {
 	reader->floatMeta(name, *value);
@@ -72,6 +72,11 @@ subject to the following restrictions:
 #include "BulletCollision/Gimpact/btGImpactShape.h"
 #include "BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h"
 #include "BulletCollision/CollisionShapes/btScaledBvhTriangleMeshShape.h"
+#include "BulletCollision/CollisionDispatch/btSimulationIslandManager.h"
+
+#ifdef _OPENMP
+#  include <omp.h>
+#endif
 
 struct rbDynamicsWorld {
 	btDiscreteDynamicsWorld *dynamicsWorld;
@@ -122,6 +127,216 @@ struct rbFilterCallback : public btOverlapFilterCallback
 	}
 };
 
+/* ********************************** */
+/* Island-Parallel Constraint Solving */
+
+/* Simulation islands (sets of bodies connected through contacts or joints) are
+ * independent by construction: no body, contact manifold or constraint is
+ * shared between two islands. btDiscreteDynamicsWorld nevertheless feeds them
+ * one by one into a single solver on the calling thread. For scenes that
+ * fracture into many islands (destruction setups with thousands of debris
+ * pieces) that serial solve dominates the step time, so rbDiscreteDynamicsWorld
+ * below overrides solveConstraints() to collect the islands emitted by
+ * btSimulationIslandManager and solve them over OpenMP threads instead, with
+ * one btSequentialImpulseConstraintSolver instance per thread.
+ *
+ * Small islands are first merged into batches of at least
+ * m_minimumSolverBatchSize manifolds+constraints, mirroring the batching that
+ * bullet's own InplaceSolverIslandCallback performs, so per-solveGroup()
+ * overhead stays low when islands are tiny (single resting bricks).
+ *
+ * Results match the serial path: each island sees exactly the bodies,
+ * manifolds and constraints it would have seen upstream, and the sequential
+ * impulse solver carries no state between solveGroup() calls (warm starting
+ * data lives in the manifolds, which are per-island).
+ */
+
+static inline int rb_constraint_island_id(const btTypedConstraint *con)
+{
+	/* same rule as bullet's file-local btGetConstraintIslandId() */
+	const btCollisionObject &colobj0 = con->getRigidBodyA();
+	const btCollisionObject &colobj1 = con->getRigidBodyB();
+	return colobj0.getIslandTag() >= 0 ? colobj0.getIslandTag() : colobj1.getIslandTag();
+}
+
+class rbSortConstraintOnIslandPredicate {
+public:
+	bool operator()(const btTypedConstraint *lhs, const btTypedConstraint *rhs) const
+	{
+		return rb_constraint_island_id(lhs) < rb_constraint_island_id(rhs);
+	}
+};
+
+/* Collects island contents instead of solving them inline. The island manager
+ * re-uses its internal body array between processIsland() calls, so everything
+ * is copied into flat arrays here; each island is a range into those arrays,
+ * which also makes merging consecutive islands into one batch trivial. */
+struct rbSolverIslandCollector : public btSimulationIslandManager::IslandCallback {
+	struct Island {
+		int body_start, body_len;
+		int manifold_start, manifold_len;
+		int constraint_start, constraint_len;
+	};
+
+	btTypedConstraint **m_sortedConstraints;
+	int m_numConstraints;
+
+	btAlignedObjectArray<btCollisionObject *> m_bodies;
+	btAlignedObjectArray<btPersistentManifold *> m_manifolds;
+	btAlignedObjectArray<btTypedConstraint *> m_constraints;
+	btAlignedObjectArray<Island> m_islands;
+
+	rbSolverIslandCollector() : m_sortedConstraints(NULL), m_numConstraints(0)
+	{
+	}
+
+	void setup(btTypedConstraint **sortedConstraints, int numConstraints)
+	{
+		m_sortedConstraints = sortedConstraints;
+		m_numConstraints = numConstraints;
+		m_bodies.resize(0);
+		m_manifolds.resize(0);
+		m_constraints.resize(0);
+		m_islands.resize(0);
+	}
+
+	virtual void processIsland(btCollisionObject **bodies, int numBodies,
+	                           btPersistentManifold **manifolds, int numManifolds, int islandId)
+	{
+		Island island;
+		int i;
+
+		island.body_start = m_bodies.size();
+		island.manifold_start = m_manifolds.size();
+		island.constraint_start = m_constraints.size();
+
+		for (i = 0; i < numBodies; i++)
+			m_bodies.push_back(bodies[i]);
+		for (i = 0; i < numManifolds; i++)
+			m_manifolds.push_back(manifolds[i]);
+
+		if (islandId < 0) {
+			/* island splitting disabled, all constraints belong to this group */
+			for (i = 0; i < m_numConstraints; i++)
+				m_constraints.push_back(m_sortedConstraints[i]);
+		}
+		else {
+			/* constraints are sorted by island id, pick out this island's range */
+			for (i = 0; i < m_numConstraints; i++) {
+				if (rb_constraint_island_id(m_sortedConstraints[i]) == islandId)
+					break;
+			}
+			for (; i < m_numConstraints && rb_constraint_island_id(m_sortedConstraints[i]) == islandId; i++)
+				m_constraints.push_back(m_sortedConstraints[i]);
+		}
+
+		island.body_len = m_bodies.size() - island.body_start;
+		island.manifold_len = m_manifolds.size() - island.manifold_start;
+		island.constraint_len = m_constraints.size() - island.constraint_start;
+		m_islands.push_back(island);
+	}
+};
+
+class rbDiscreteDynamicsWorld : public btDiscreteDynamicsWorld {
+	rbSolverIslandCollector m_islandCollector;
+	btAlignedObjectArray<btConstraintSolver *> m_threadSolvers;
+
+public:
+	rbDiscreteDynamicsWorld(btDispatcher *dispatcher, btBroadphaseInterface *pairCache,
+	                        btConstraintSolver *constraintSolver,
+	                        btCollisionConfiguration *collisionConfiguration)
+	        : btDiscreteDynamicsWorld(dispatcher, pairCache, constraintSolver, collisionConfiguration)
+	{
+	}
+
+	virtual ~rbDiscreteDynamicsWorld()
+	{
+		for (int i = 0; i < m_threadSolvers.size(); i++)
+			delete m_threadSolvers[i];
+	}
+
+protected:
+	virtual void solveConstraints(btContactSolverInfo &solverInfo)
+	{
+		int i;
+
+		/* same constraint ordering as btDiscreteDynamicsWorld::solveConstraints() */
+		m_sortedConstraints.resize(m_constraints.size());
+		for (i = 0; i < getNumConstraints(); i++)
+			m_sortedConstraints[i] = m_constraints[i];
+		m_sortedConstraints.quickSort(rbSortConstraintOnIslandPredicate());
+
+		btTypedConstraint **constraintsPtr = getNumConstraints() ? &m_sortedConstraints[0] : NULL;
+
+		m_islandCollector.setup(constraintsPtr, m_sortedConstraints.size());
+		m_constraintSolver->prepareSolve(getCollisionWorld()->getNumCollisionObjects(),
+		                                 getCollisionWorld()->getDispatcher()->getNumManifolds());
+
+		getSimulationIslandManager()->buildAndProcessIslands(getCollisionWorld()->getDispatcher(),
+		                                                     getCollisionWorld(), &m_islandCollector);
+
+		solveCollectedIslands(solverInfo);
+
+		m_constraintSolver->allSolved(solverInfo, getDebugDrawer());
+	}
+
+	void solveCollectedIslands(btContactSolverInfo &solverInfo)
+	{
+		const int num_islands = m_islandCollector.m_islands.size();
+		btAlignedObjectArray<int> batch_starts;
+		int i, num_threads, batch_size = 0;
+
+		if (num_islands == 0)
+			return;
+
+		/* greedily merge consecutive islands into batches of at least
+		 * m_minimumSolverBatchSize manifolds+constraints; islands share no
+		 * bodies, so merged batches stay independent of each other */
+		const int min_batch = solverInfo.m_minimumSolverBatchSize > 1 ? solverInfo.m_minimumSolverBatchSize : 1;
+
+		for (i = 0; i < num_islands; i++) {
+			const rbSolverIslandCollector::Island &island = m_islandCollector.m_islands[i];
+			if (batch_size == 0)
+				batch_starts.push_back(i);
+			batch_size += island.manifold_len + island.constraint_len;
+			if (batch_size >= min_batch)
+				batch_size = 0;
+		}
+		batch_starts.push_back(num_islands);
+
+		const int num_batches = batch_starts.size() - 1;
+
+#ifdef _OPENMP
+		num_threads = omp_get_max_threads();
+#else
+		num_threads = 1;
+#endif
+		while (m_threadSolvers.size() < num_threads)
+			m_threadSolvers.push_back(new btSequentialImpulseConstraintSolver());
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) if (num_batches > 1)
+#endif
+		for (int b = 0; b < num_batches; b++) {
+			const rbSolverIslandCollector::Island &first = m_islandCollector.m_islands[batch_starts[b]];
+			const rbSolverIslandCollector::Island &last = m_islandCollector.m_islands[batch_starts[b + 1] - 1];
+			const int num_bodies = (last.body_start + last.body_len) - first.body_start;
+			const int num_manifolds = (last.manifold_start + last.manifold_len) - first.manifold_start;
+			const int num_constraints = (last.constraint_start + last.constraint_len) - first.constraint_start;
+#ifdef _OPENMP
+			btConstraintSolver *solver = m_threadSolvers[omp_get_thread_num()];
+#else
+			btConstraintSolver *solver = m_threadSolvers[0];
+#endif
+
+			solver->solveGroup(num_bodies ? &m_islandCollector.m_bodies[first.body_start] : NULL, num_bodies,
+			                   num_manifolds ? &m_islandCollector.m_manifolds[first.manifold_start] : NULL, num_manifolds,
+			                   num_constraints ? &m_islandCollector.m_constraints[first.constraint_start] : NULL, num_constraints,
+			                   solverInfo, getDebugDrawer(), getCollisionWorld()->getDispatcher());
+		}
+	}
+};
+
 static inline void copy_v3_btvec3(float vec[3], const btVector3 &btvec)
 {
 	vec[0] = (float)btvec[0];
@@ -160,7 +375,7 @@ rbDynamicsWorld *RB_dworld_new(const float gravity[3])
 	world->constraintSolver = new btSequentialImpulseConstraintSolver();
 
 	/* world */
-	world->dynamicsWorld = new btDiscreteDynamicsWorld(world->dispatcher,
+	world->dynamicsWorld = new rbDiscreteDynamicsWorld(world->dispatcher,
 	                                                   world->pairCache,
 	                                                   world->constraintSolver,
 	                                                   world->collisionConfiguration);
@@ -94,6 +94,15 @@ FLUID_3D::FLUID_3D(int *res, float dx, float dtdef, int init_heat, int init_fire
 	_densityOld   = new float[_totalCells];
 	_obstacles    = new unsigned char[_totalCells]; // set 0 at end of step
 
+	_blockRes[0] = (_xRes + OCC_BLOCK_SIZE - 1) >> OCC_BLOCK_SHIFT;
+	_blockRes[1] = (_yRes + OCC_BLOCK_SIZE - 1) >> OCC_BLOCK_SHIFT;
+	_blockRes[2] = (_zRes + OCC_BLOCK_SIZE - 1) >> OCC_BLOCK_SHIFT;
+	_totalBlocks = _blockRes[0] * _blockRes[1] * _blockRes[2];
+	_occupancy   = new unsigned char[_totalBlocks];
+
+	for (int x = 0; x < _totalBlocks; x++)
+		_occupancy[x] = 1; // everything active until the first rebuild
+
 	// For threaded version:
 	_xVelocityTemp = new float[_totalCells];
 	_yVelocityTemp = new float[_totalCells];
@@ -277,6 +286,7 @@ FLUID_3D::~FLUID_3D()
 	if (_heat) delete[] _heat;
 	if (_heatOld) delete[] _heatOld;
 	if (_obstacles) delete[] _obstacles;
+	if (_occupancy) delete[] _occupancy;
 
 	if (_xVelocityTemp) delete[] _xVelocityTemp;
 	if (_yVelocityTemp) delete[] _yVelocityTemp;
@@ -322,6 +332,82 @@ void FLUID_3D::initBlenderRNA(float *alpha, float *beta, float *dt_factor, float
 	_max_temp = flame_max_temp;
 }
 
+//////////////////////////////////////////////////////////////////////
+// rebuild the coarse occupancy map of active blocks
+//
+// A block is inactive when neither it nor anything within backtrace
+// reach of it carries smoke content. Scalar advection resolves to
+// exactly zero in those blocks, so the kernels can skip them wholesale.
+//////////////////////////////////////////////////////////////////////
+void FLUID_3D::updateOccupancy()
+{
+	const int bx = _blockRes[0];
+	const int by = _blockRes[1];
+	const int bz = _blockRes[2];
+	const float dt0 = _dt / _dx;
+	float maxVel2 = 0.0f;
+	int index = 0, dilate, pass, i;
+
+	for (i = 0; i < _totalBlocks; i++)
+		_occupancy[i] = 0;
+
+	// mark blocks carrying any advected scalar content
+	for (int z = 0; z < _zRes; z++)
+		for (int y = 0; y < _yRes; y++)
+			for (int x = 0; x < _xRes; x++, index++)
+			{
+				bool content = (_densityOld[index] != 0.0f);
+				if (_heat && !content) content = (_heatOld[index] != 0.0f);
+				if (_fuel && !content) content = (_fuelOld[index] != 0.0f || _reactOld[index] != 0.0f);
+				if (_color_r && !content) content = (_color_rOld[index] != 0.0f || _color_gOld[index] != 0.0f || _color_bOld[index] != 0.0f);
+
+				if (content)
+					_occupancy[(x >> OCC_BLOCK_SHIFT) + ((y >> OCC_BLOCK_SHIFT) + (z >> OCC_BLOCK_SHIFT) * by) * bx] = 1;
+			}
+
+	// the maximum distance content can travel this step decides how far
+	// the active set has to grow, plus slack for the interpolation stencils
+	for (size_t cell = 0; cell < _totalCells; cell++)
+	{
+		float v2 = _xVelocityOld[cell] * _xVelocityOld[cell] +
+		           _yVelocityOld[cell] * _yVelocityOld[cell] +
+		           _zVelocityOld[cell] * _zVelocityOld[cell];
+		if (v2 > maxVel2) maxVel2 = v2;
+	}
+	dilate = (int)((dt0 * sqrtf(maxVel2) + 2.0f) / (float)OCC_BLOCK_SIZE) + 1;
+
+	// grow the active set by one block per pass, full 26-neighborhood
+	for (pass = 0; pass < dilate; pass++)
+	{
+		for (int z = 0; z < bz; z++)
+			for (int y = 0; y < by; y++)
+				for (int x = 0; x < bx; x++)
+				{
+					if (_occupancy[x + (y + z * by) * bx])
+						continue;
+
+					bool nearActive = false;
+					for (int dz = -1; dz <= 1 && !nearActive; dz++)
+						for (int dy = -1; dy <= 1 && !nearActive; dy++)
+							for (int dx = -1; dx <= 1 && !nearActive; dx++)
+							{
+								const int nx = x + dx, ny = y + dy, nz = z + dz;
+								if (nx < 0 || ny < 0 || nz < 0 || nx >= bx || ny >= by || nz >= bz)
+									continue;
+								if (_occupancy[nx + (ny + nz * by) * bx] == 1)
+									nearActive = true;
+							}
+
+					if (nearActive)
+						_occupancy[x + (y + z * by) * bx] = 2;
+				}
+
+		for (i = 0; i < _totalBlocks; i++)
+			if (_occupancy[i] == 2)
+				_occupancy[i] = 1;
+	}
+}
+
 //////////////////////////////////////////////////////////////////////
 // step simulation once
 //////////////////////////////////////////////////////////////////////
@@ -444,6 +530,8 @@ void FLUID_3D::step(float dt, float gravity[3])
 	SWAP_POINTERS(_color_g, _color_gOld);
 	SWAP_POINTERS(_color_b, _color_bOld);
 
+	updateOccupancy();
+
 	advectMacCormackBegin(0, _zRes);
 
 #if PARALLEL==1
@@ -1512,18 +1600,18 @@ void FLUID_3D::advectMacCormackEnd1(int zBegin, int zEnd)
 
 	// advectFieldMacCormack1(dt, xVelocity, yVelocity, zVelocity, oldField, newField, res)
 
-	advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _densityOld, _densityTemp, res, zBegin, zEnd);
+	advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _densityOld, _densityTemp, res, zBegin, zEnd, _occupancy, _blockRes);
 	if (_heat) {
-		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _heatOld, _heatTemp, res, zBegin, zEnd);
+		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _heatOld, _heatTemp, res, zBegin, zEnd, _occupancy, _blockRes);
 	}
 	if (_fuel) {
-		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _fuelOld, _fuelTemp, res, zBegin, zEnd);
-		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _reactOld, _reactTemp, res, zBegin, zEnd);
+		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _fuelOld, _fuelTemp, res, zBegin, zEnd, _occupancy, _blockRes);
+		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _reactOld, _reactTemp, res, zBegin, zEnd, _occupancy, _blockRes);
 	}
 	if (_color_r) {
-		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_rOld, _color_rTemp, res, zBegin, zEnd);
-		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_gOld, _color_gTemp, res, zBegin, zEnd);
-		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_bOld, _color_bTemp, res, zBegin, zEnd);
+		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_rOld, _color_rTemp, res, zBegin, zEnd, _occupancy, _blockRes);
+		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_gOld, _color_gTemp, res, zBegin, zEnd, _occupancy, _blockRes);
+		advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_bOld, _color_bTemp, res, zBegin, zEnd, _occupancy, _blockRes);
 	}
 	advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _xVelocityOld, _xVelocity, res, zBegin, zEnd);
 	advectFieldMacCormack1(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _yVelocityOld, _yVelocity, res, zBegin, zEnd);
@@ -1546,18 +1634,18 @@ void FLUID_3D::advectMacCormackEnd2(int zBegin, int zEnd)
 	// advectFieldMacCormack2(dt, xVelocity, yVelocity, zVelocity, oldField, newField, tempfield, temp, res, obstacles)
 
 	/* finish advection */
-	advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _densityOld, _density, _densityTemp, t1, res, _obstacles, zBegin, zEnd);
+	advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _densityOld, _density, _densityTemp, t1, res, _obstacles, zBegin, zEnd, _occupancy, _blockRes);
 	if (_heat) {
-		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _heatOld, _heat, _heatTemp, t1, res, _obstacles, zBegin, zEnd);
+		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _heatOld, _heat, _heatTemp, t1, res, _obstacles, zBegin, zEnd, _occupancy, _blockRes);
 	}
 	if (_fuel) {
-		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _fuelOld, _fuel, _fuelTemp, t1, res, _obstacles, zBegin, zEnd);
-		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _reactOld, _react, _reactTemp, t1, res, _obstacles, zBegin, zEnd);
+		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _fuelOld, _fuel, _fuelTemp, t1, res, _obstacles, zBegin, zEnd, _occupancy, _blockRes);
+		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _reactOld, _react, _reactTemp, t1, res, _obstacles, zBegin, zEnd, _occupancy, _blockRes);
 	}
 	if (_color_r) {
-		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_rOld, _color_r, _color_rTemp, t1, res, _obstacles, zBegin, zEnd);
-		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_gOld, _color_g, _color_gTemp, t1, res, _obstacles, zBegin, zEnd);
-		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_bOld, _color_b, _color_bTemp, t1, res, _obstacles, zBegin, zEnd);
+		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_rOld, _color_r, _color_rTemp, t1, res, _obstacles, zBegin, zEnd, _occupancy, _blockRes);
+		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_gOld, _color_g, _color_gTemp, t1, res, _obstacles, zBegin, zEnd, _occupancy, _blockRes);
+		advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _color_bOld, _color_b, _color_bTemp, t1, res, _obstacles, zBegin, zEnd, _occupancy, _blockRes);
 	}
 	advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _xVelocityOld, _xVelocityTemp, _xVelocity, t1, res, _obstacles, zBegin, zEnd);
 	advectFieldMacCormack2(dt0, _xVelocityOld, _yVelocityOld, _zVelocityOld, _yVelocityOld, _yVelocityTemp, _yVelocity, t1, res, _obstacles, zBegin, zEnd);
@@ -43,6 +43,10 @@ using namespace std;
 using namespace BasicVector;
 struct WTURBULENCE;
 
+// size of one occupancy map block along each axis, keep a power of two
+#define OCC_BLOCK_SHIFT 3
+#define OCC_BLOCK_SIZE (1 << OCC_BLOCK_SHIFT)
+
 struct FLUID_3D  
 {
 	public:
@@ -113,6 +117,14 @@ struct FLUID_3D
 		unsigned char*  _obstacles; /* only used (useful) for static obstacles like domain boundaries */
 		unsigned char*  _obstaclesAnim;
 
+		/* coarse occupancy map of OCC_BLOCK_SIZE^3 blocks, rebuilt every step.
+		 * A block is active when it, or anything within backtrace reach of it,
+		 * carries smoke content; scalar advection skips inactive blocks. */
+		unsigned char*  _occupancy;
+		int _blockRes[3];
+		int _totalBlocks;
+		void updateOccupancy();
+
 		// Required for proper threading:
 		float* _xVelocityTemp;
 		float* _yVelocityTemp;
@@ -233,11 +245,14 @@ struct FLUID_3D
 
 		// static advection functions, also used by WTURBULENCE
 		static void advectFieldSemiLagrange(const float dt, const float* velx, const float* vely,  const float* velz,
-				float* oldField, float* newField, Vec3Int res, int zBegin, int zEnd);
+				float* oldField, float* newField, Vec3Int res, int zBegin, int zEnd,
+				const unsigned char* occupancy = NULL, const int* blockRes = NULL);
 		static void advectFieldMacCormack1(const float dt, const float* xVelocity, const float* yVelocity, const float* zVelocity, 
-				float* oldField, float* tempResult, Vec3Int res, int zBegin, int zEnd);
+				float* oldField, float* tempResult, Vec3Int res, int zBegin, int zEnd,
+				const unsigned char* occupancy = NULL, const int* blockRes = NULL);
 		static void advectFieldMacCormack2(const float dt, const float* xVelocity, const float* yVelocity, const float* zVelocity, 
-				float* oldField, float* newField, float* tempResult, float* temp1,Vec3Int res, const unsigned char* obstacles, int zBegin, int zEnd);
+				float* oldField, float* newField, float* tempResult, float* temp1,Vec3Int res, const unsigned char* obstacles, int zBegin, int zEnd,
+				const unsigned char* occupancy = NULL, const int* blockRes = NULL);
 
 
 		// temp ones for testing
@@ -248,9 +263,11 @@ struct FLUID_3D
 
 		// maccormack helper functions
 		static void clampExtrema(const float dt, const float* xVelocity, const float* yVelocity,  const float* zVelocity,
-				float* oldField, float* newField, Vec3Int res, int zBegin, int zEnd);
+				float* oldField, float* newField, Vec3Int res, int zBegin, int zEnd,
+				const unsigned char* occupancy = NULL, const int* blockRes = NULL);
 		static void clampOutsideRays(const float dt, const float* xVelocity, const float* yVelocity,  const float* zVelocity,
-				float* oldField, float* newField, Vec3Int res, const unsigned char* obstacles, const float *oldAdvection, int zBegin, int zEnd);
+				float* oldField, float* newField, Vec3Int res, const unsigned char* obstacles, const float *oldAdvection, int zBegin, int zEnd,
+				const unsigned char* occupancy = NULL, const int* blockRes = NULL);
 
 
 
@@ -103,8 +103,12 @@ void blf_font_size(FontBLF *font, unsigned int size, unsigned int dpi)
 		font->glyph_cache = gc;
 	else {
 		gc = blf_glyph_cache_new(font);
-		if (gc)
+		if (gc) {
 			font->glyph_cache = gc;
+			/* pre-rasterize the ascii range, so drawing at this size
+			 * doesn't hitch on it and stays lock-free for these glyphs */
+			blf_glyph_cache_fill_ascii(font);
+		}
 		else
 			font->glyph_cache = NULL;
 	}
@@ -197,7 +197,9 @@ GlyphBLF *blf_glyph_search(GlyphCacheBLF *gc, unsigned int c)
 	return NULL;
 }
 
-GlyphBLF *blf_glyph_add(FontBLF *font, unsigned int index, unsigned int c)
+/* rasterize one glyph and add it to the cache,
+ * font->ft_lib_mutex must be held by the caller */
+static GlyphBLF *blf_glyph_add_nolock(FontBLF *font, unsigned int index, unsigned int c)
 {
 	FT_GlyphSlot slot;
 	GlyphBLF *g;
@@ -208,33 +210,15 @@ GlyphBLF *blf_glyph_add(FontBLF *font, unsigned int index, unsigned int c)
 	FT_BBox bbox;
 	unsigned int key;
 
-	g = blf_glyph_search(font->glyph_cache, c);
-	if (g)
-		return g;
-
-	/* glyphs are dynamically created as needed by font rendering. this means that
-	 * to make font rendering thread safe we have to do locking here. note that this
-	 * must be a lock for the whole library and not just per font, because the font
-	 * renderer uses a shared buffer internally */
-	BLI_spin_lock(font->ft_lib_mutex);
-
-	/* search again after locking */
-	g = blf_glyph_search(font->glyph_cache, c);
-	if (g) {
-		BLI_spin_unlock(font->ft_lib_mutex);
-		return g;
-	}
-
 	if (font->flags & BLF_HINTING)
 		flags &= ~FT_LOAD_NO_HINTING;
-	
+
 	if (is_sharp)
 		err = FT_Load_Glyph(font->face, (FT_UInt)index, FT_LOAD_TARGET_MONO);
 	else
-		err = FT_Load_Glyph(font->face, (FT_UInt)index, flags);  
+		err = FT_Load_Glyph(font->face, (FT_UInt)index, flags);
 
 	if (err) {
-		BLI_spin_unlock(font->ft_lib_mutex);
 		return NULL;
 	}
 
@@ -256,7 +240,6 @@ GlyphBLF *blf_glyph_add(FontBLF *font, unsigned int index, unsigned int c)
 	}
 
 	if (err || slot->format != FT_GLYPH_FORMAT_BITMAP) {
-		BLI_spin_unlock(font->ft_lib_mutex);
 		return NULL;
 	}
 
@@ -297,11 +280,54 @@ GlyphBLF *blf_glyph_add(FontBLF *font, unsigned int index, unsigned int c)
 	key = blf_hash(g->c);
 	BLI_addhead(&(font->glyph_cache->bucket[key]), g);
 
+	return g;
+}
+
+GlyphBLF *blf_glyph_add(FontBLF *font, unsigned int index, unsigned int c)
+{
+	GlyphBLF *g;
+
+	g = blf_glyph_search(font->glyph_cache, c);
+	if (g)
+		return g;
+
+	/* glyphs are dynamically created as needed by font rendering. this means that
+	 * to make font rendering thread safe we have to do locking here. note that this
+	 * must be a lock for the whole library and not just per font, because the font
+	 * renderer uses a shared buffer internally */
+	BLI_spin_lock(font->ft_lib_mutex);
+
+	/* search again after locking */
+	g = blf_glyph_search(font->glyph_cache, c);
+	if (g == NULL) {
+		g = blf_glyph_add_nolock(font, index, c);
+	}
+
 	BLI_spin_unlock(font->ft_lib_mutex);
 
 	return g;
 }
 
+/* Rasterize the full ascii range in one go, taking the library lock once
+ * instead of once per glyph. Called when a glyph cache is created, so by the
+ * time text is drawn the common glyphs are all cached and regular draws don't
+ * need the lock at all for them. */
+void blf_glyph_cache_fill_ascii(FontBLF *font)
+{
+	unsigned int i;
+
+	BLI_spin_lock(font->ft_lib_mutex);
+
+	for (i = 0; i < 256; i++) {
+		if (blf_glyph_search(font->glyph_cache, i) == NULL) {
+			FT_UInt index = FT_Get_Char_Index(font->face, i);
+			blf_glyph_add_nolock(font, index, i);
+		}
+	}
+
+	BLI_spin_unlock(font->ft_lib_mutex);
+}
+
 void blf_glyph_free(GlyphBLF *g)
 {
 	/* don't need free the texture, the GlyphCache already
@@ -182,6 +182,7 @@ struct DerivedMesh {
 	int needsFree; /* checked on ->release, is set to 0 for cached results */
 	int deformedOnly; /* set by modifier stack if only deformed from original */
 	BVHCache *bvhCache;
+	struct LinkNode *mappingCache;  /* MeshMappingCache, see BKE_mesh_mapping.h */
 	struct GPUDrawObject *drawObject;
 	DerivedMeshType type;
 	float auto_bump_scale;
@@ -803,6 +804,11 @@ void DM_calc_auto_bump_scale(DerivedMesh *dm);
 /** Set object's bounding box based on DerivedMesh min/max data */
 void DM_set_object_boundbox(struct Object *ob, DerivedMesh *dm);
 
+/* modifier stack fingerprints, used to skip redundant re-evaluations
+ * (see mesh_build_data in DerivedMesh.c) */
+void DM_eval_fingerprint_object_remove(struct Object *ob);
+void DM_eval_fingerprint_free(void);
+
 void DM_init_origspace(DerivedMesh *dm);
 
 /* debug only */
@@ -32,6 +32,7 @@
  *  \author nzc
  *  \since March 2001
  */
+struct DupliObject;
 struct EvaluationContext;
 struct Path;
 struct Object;
@@ -70,6 +71,20 @@ struct ListBase *object_duplilist(struct EvaluationContext *eval_ctx, struct Sce
 void free_object_duplilist(struct ListBase *lb);
 int count_duplilist(struct Object *ob);
 
+/* Free the cached dupli list kept on the duplicator object. */
+void object_dupli_cache_free(struct Object *ob);
+
+/* Invalidate all cached dupli lists, to be called whenever tagging or a
+ * frame change may affect generated duplis. Stale caches are freed lazily
+ * on the next object_duplilist call. */
+void object_dupli_cache_invalidate(void);
+
+/* Callback iteration over duplis, without materializing the full list.
+ * The entry passed to the callback is only valid during the call. */
+typedef void (*DupliObjectIterFunc)(void *userdata, struct DupliObject *dob);
+void object_duplilist_iterate(struct EvaluationContext *eval_ctx, struct Scene *scene, struct Object *ob,
+                              DupliObjectIterFunc func, void *userdata);
+
 typedef struct DupliExtraData {
 	float obmat[4][4];
 	unsigned int lay;
@@ -179,6 +179,17 @@ void BKE_animsys_evaluate_all_animation(struct Main *main, struct Scene *scene,
 struct FCurve;
 bool BKE_animsys_execute_fcurve(struct PointerRNA *ptr, struct AnimMapper *remap, struct FCurve *fcu);
 
+/* ------------- Resolved RNA-Path Cache ------ */
+
+/* Free the runtime cache of resolved RNA paths of the given AnimData. */
+void BKE_animsys_rna_cache_free(struct AnimData *adt);
+
+/* Invalidate the resolved RNA path caches of all AnimData blocks, to be
+ * called whenever the layout of datablocks may have changed (pointers into
+ * them stored in the caches may be dangling after that).
+ */
+void BKE_animsys_rna_cache_invalidate(void);
+
 /* ------------ Specialized API --------------- */
 /* There are a few special tools which require these following functions. They are NOT to be used
  * for standard animation evaluation UNDER ANY CIRCUMSTANCES! 
@@ -150,6 +150,15 @@ BVHTree *bvhtree_from_mesh_looptri_ex(
         const BLI_bitmap *mask, int looptri_num_active,
         float epsilon, int tree_type, int axis);
 
+/**
+ * Refits an existing tree to the current coordinates in data->vert, only
+ * valid while topology is unchanged (deform-only changes); O(n) instead of
+ * the O(n log n) rebuild.
+ */
+void bvhtree_from_mesh_verts_refit(struct BVHTreeFromMesh *data);
+void bvhtree_from_mesh_edges_refit(struct BVHTreeFromMesh *data);
+void bvhtree_from_mesh_looptri_refit(struct BVHTreeFromMesh *data);
+
 /**
  * Frees data allocated by a call to bvhtree_from_mesh_*.
  */
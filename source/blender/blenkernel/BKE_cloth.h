@@ -97,6 +97,7 @@ typedef struct Cloth {
 	struct MVertTri		*tri;
 	struct Implicit_Data	*implicit; 		/* our implicit solver connects to this pointer */
 	struct EdgeSet	 	*edgeset; 		/* used for selfcollisions */
+	struct ClothCollisionCache *coll_cache;	/* persistent collision pair buffers, see collision.c */
 	int last_frame, pad4;
 } Cloth;
 
@@ -157,6 +157,10 @@ typedef struct ColliderCache {
 struct ListBase *get_collider_cache(struct Scene *scene, struct Object *self, struct Group *group);
 void free_collider_cache(struct ListBase **colliders);
 
+/* persistent broad phase cache kept on the Cloth, owned by collision.c */
+struct ClothCollisionCache;
+void cloth_collision_cache_free(struct ClothCollisionCache *cache);
+
 /////////////////////////////////////////////////
 
 
@@ -254,6 +254,26 @@ void CustomData_bmesh_interp(
         const float *weights, const float *sub_weights, int count,
         void *dst_block);
 
+/* pre-compiled plan of the matching layer pairs between two CustomData objects,
+ * so tight per-element copy/interp loops (subsurf, mirror, ...) skip the layer
+ * descriptor walk and type-info lookup each call.
+ *
+ * The plan borrows the layer data pointers: it is only valid as long as neither
+ * CustomData object has layers added, removed or reallocated.
+ */
+typedef struct CustomDataLayerPlan CustomDataLayerPlan;
+
+CustomDataLayerPlan *CustomData_layer_plan_create(
+        const struct CustomData *source, struct CustomData *dest);
+void CustomData_layer_plan_copy_data(
+        const CustomDataLayerPlan *plan,
+        int source_index, int dest_index, int count);
+void CustomData_layer_plan_interp(
+        const CustomDataLayerPlan *plan,
+        const int *src_indices, const float *weights, const float *sub_weights,
+        int count, int dest_index);
+void CustomData_layer_plan_free(CustomDataLayerPlan *plan);
+
 
 /* swaps the data in the element corners, to new corners with indices as
  * specified in corner_indices. for edges this is an array of length 2, for
@@ -105,6 +105,10 @@ typedef struct EffectorCache {
 	float guide_loc[4], guide_dir[3], guide_radius;
 	float velocity[3];
 
+	/* normalized z-axis of the object, precomputed so the per-point
+	 * evaluation does not renormalize it for every point */
+	float znor[3];
+
 	float frame;
 	int flag;
 } EffectorCache;
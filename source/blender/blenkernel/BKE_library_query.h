@@ -32,6 +32,8 @@
  */
 
 struct ID;
+struct LinkNode;
+struct Main;
 
 /* Tips for the callback for cases it's gonna to modify the pointer. */
 enum {
@@ -75,4 +77,15 @@ void BKE_library_update_ID_link_user(struct ID *id_dst, struct ID *id_src, const
 
 int BKE_library_ID_use_ID(struct ID *id_user, struct ID *id_used);
 
+/* Reverse dependency index over a whole Main (which IDs use which).
+ * Build once, then query/maintain instead of rescanning all of Main per ID. */
+struct MainIDRelations;
+
+struct MainIDRelations *BKE_main_relations_create(struct Main *bmain);
+void BKE_main_relations_free(struct MainIDRelations *relations);
+struct LinkNode *BKE_main_relations_ids_used(struct MainIDRelations *relations, struct ID *id);
+struct LinkNode *BKE_main_relations_ids_users(struct MainIDRelations *relations, struct ID *id);
+void BKE_main_relations_insert_id(struct MainIDRelations *relations, struct ID *id);
+void BKE_main_relations_remove_id(struct MainIDRelations *relations, struct ID *id);
+
 #endif  /* __BKE_LIBRARY_QUERY_H__ */
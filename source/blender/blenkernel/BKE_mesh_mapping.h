@@ -31,6 +31,7 @@
  *  \ingroup bke
  */
 
+struct DerivedMesh;
 struct MVert;
 struct MEdge;
 struct MPoly;
@@ -134,6 +135,20 @@ void BKE_mesh_origindex_map_create_looptri(
         const struct MPoly *mpoly, const int mpoly_num,
         const struct MLoopTri *looptri, const int looptri_num);
 
+/* Cached mappings, attached to a DerivedMesh (DerivedMesh.mappingCache) and
+ * freed together with it: since a DM's topology never changes once built,
+ * repeated lookups within one stack evaluation cost a single build. */
+enum {
+	MESH_MAPPING_VERT_POLY = 0,
+	MESH_MAPPING_VERT_LOOP = 1,
+	MESH_MAPPING_VERT_EDGE = 2,
+};
+
+typedef struct LinkNode MeshMappingCache;
+
+const MeshElemMap *BKE_mesh_mapping_cached_get(struct DerivedMesh *dm, const int type);
+void BKE_mesh_mapping_cache_free(MeshMappingCache **cache_p);
+
 /* islands */
 
 /* Loop islands data helpers. */
@@ -54,6 +54,7 @@ void multires_set_tot_level(struct Object *ob,
                             struct MultiresModifierData *mmd, int lvl);
 
 void multires_mark_as_modified(struct Object *ob, enum MultiresModifiedFlags flags);
+void multires_mark_grids_as_modified(struct Object *ob, const int *grid_indices, int totgrid);
 
 void multires_force_update(struct Object *ob);
 void multires_force_render_update(struct Object *ob);
@@ -73,6 +73,11 @@ int seekPackedFile(struct PackedFile *pf, int offset, int whence);
 void rewindPackedFile(struct PackedFile *pf);
 int readPackedFile(struct PackedFile *pf, void *data, int size);
 
+/* lazy packed files */
+void *acquirePackedFileData(struct PackedFile *pf);
+void releasePackedFileData(struct PackedFile *pf);
+void ensureAllPackedFiles(struct Main *bmain, const char *filepath);
+
 /* ID should be not NULL, return 1 if there's a packed file */
 bool BKE_pack_check(struct ID *id);
 /* ID should be not NULL, throws error when ID is Library */
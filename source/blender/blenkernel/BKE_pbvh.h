@@ -263,6 +263,15 @@ typedef struct PBVHVertexIter {
 	const int *vert_indices;
 	float *vmask;
 
+	/* sphere-restricted iteration over spatial buckets (mesh only),
+	 * see BKE_pbvh_vertex_iter_begin_sphere */
+	const int *bucket_verts;
+	const int *bucket_offsets;
+	int tot_buckets;
+	int b;
+	unsigned long long bucket_mask;
+	int bucket_fallback[2];
+
 	/* bmesh */
 	struct GSetIterator bm_unique_verts;
 	struct GSetIterator bm_other_verts;
@@ -281,6 +290,9 @@ typedef struct PBVHVertexIter {
 
 void pbvh_vertex_iter_init(PBVH *bvh, PBVHNode *node,
                            PBVHVertexIter *vi, int mode);
+void pbvh_vertex_iter_init_sphere(PBVH *bvh, PBVHNode *node,
+                                  PBVHVertexIter *vi, int mode,
+                                  const float center[3], float radius_squared);
 
 #define BKE_pbvh_vertex_iter_begin(bvh, node, vi, mode) \
 	pbvh_vertex_iter_init(bvh, node, &vi, mode); \
@@ -341,6 +353,31 @@ void pbvh_vertex_iter_init(PBVH *bvh, PBVHNode *node,
 		} \
 	}
 
+/* Mesh-only (PBVH_FACES) variant that visits buckets of vertices (see
+ * pbvh.c's PBVHVertBuckets) and skips whole buckets outside the brush
+ * sphere; with PBVH_ITER_ALL it degrades to one bucket over every vertex.
+ * \note vi.i stays the vertex's original node-local position, so indexing
+ * per-node arrays (undo, proxies) by it keeps working unchanged. */
+#define BKE_pbvh_vertex_iter_begin_sphere(bvh, node, center, radius_squared, vi, mode) \
+	pbvh_vertex_iter_init_sphere(bvh, node, &vi, mode, center, radius_squared); \
+	 \
+	for (vi.b = 0; vi.b < vi.tot_buckets; vi.b++) { \
+		if (vi.bucket_verts && !(vi.bucket_mask & (1ULL << vi.b))) \
+			continue; \
+		for (vi.gx = vi.bucket_offsets[vi.b]; vi.gx < vi.bucket_offsets[vi.b + 1]; vi.gx++) { \
+			vi.i = vi.bucket_verts ? vi.bucket_verts[vi.gx] : vi.gx; \
+			vi.mvert = &vi.mverts[vi.vert_indices[vi.i]]; \
+			if (mode == PBVH_ITER_UNIQUE && vi.mvert->flag & ME_HIDE) \
+				continue; \
+			vi.co = vi.mvert->co; \
+			vi.no = vi.mvert->no; \
+			if (vi.vmask) \
+				vi.mask = &vi.vmask[vi.vert_indices[vi.i]];
+
+#define BKE_pbvh_vertex_iter_end_sphere \
+		} \
+	}
+
 void BKE_pbvh_node_get_proxies(PBVHNode *node, PBVHProxyNode **proxies, int *proxy_count);
 void BKE_pbvh_node_free_proxies(PBVHNode *node);
 PBVHProxyNode *BKE_pbvh_node_add_proxy(PBVH *bvh, PBVHNode *node);
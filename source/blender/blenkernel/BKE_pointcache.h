@@ -324,6 +324,9 @@ void BKE_ptcache_quick_cache_all(struct Main *bmain, struct Scene *scene);
 /* Bake cache or simulate to current frame with settings defined in the baker. */
 void BKE_ptcache_bake(struct PTCacheBaker *baker);
 
+/* wait for the background frame writer, only needed on exit */
+void BKE_ptcache_async_write_exit(void);
+
 /* Convert disk cache to memory cache. */
 void BKE_ptcache_disk_to_mem(struct PTCacheID *pid);
 
@@ -192,6 +192,12 @@ struct ImBuf *BKE_sequencer_give_ibuf_direct(const SeqRenderData *context, float
 struct ImBuf *BKE_sequencer_give_ibuf_seqbase(const SeqRenderData *context, float cfra, int chan_shown, struct ListBase *seqbasep);
 void BKE_sequencer_give_ibuf_prefetch_request(const SeqRenderData *context, float cfra, int chan_shown);
 
+/* sequencer look-ahead prefetch, renders frames into the sequencer cache
+ * from a background job using private copies of the strips */
+struct SeqPrefetchContext *BKE_sequencer_prefetch_context_create(struct Scene *scene);
+bool BKE_sequencer_prefetch_frame(struct SeqPrefetchContext *pctx, const SeqRenderData *context, float cfra, int chanshown);
+void BKE_sequencer_prefetch_context_free(struct SeqPrefetchContext *pctx);
+
 /* **********************************************************************
  * sequencer.c
  *
@@ -282,6 +288,10 @@ void BKE_sequencer_cache_put(const SeqRenderData *context, struct Sequence *seq,
 
 void BKE_sequencer_cache_cleanup_sequence(struct Sequence *seq);
 
+/* tell the cache which frame the interface is displaying, frames behind the
+ * playhead in the scrub direction are evicted before frames ahead of it */
+void BKE_sequencer_cache_set_playhead(int cfra);
+
 struct ImBuf *BKE_sequencer_preprocessed_cache_get(const SeqRenderData *context, struct Sequence *seq, float cfra, eSeqStripElemIBuf type);
 void BKE_sequencer_preprocessed_cache_put(const SeqRenderData *context, struct Sequence *seq, float cfra, eSeqStripElemIBuf type, struct ImBuf *ibuf);
 void BKE_sequencer_preprocessed_cache_cleanup(void);
@@ -135,6 +135,10 @@ typedef struct CCGDerivedMesh {
 
 		struct Object *ob;
 		MultiresModifiedFlags modified_flags;
+
+		/* bitmap of grids sculpted on since the last mdisps update,
+		 * NULL means all grids are considered modified */
+		unsigned int *grid_dirty;
 	} multires;
 
 	struct EdgeHash *ehash;
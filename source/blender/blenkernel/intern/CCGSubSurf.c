@@ -310,6 +310,8 @@ CCGSubSurf *ccgSubSurf_new(CCGMeshIFC *ifc, int subdivLevels, CCGAllocatorIFC *a
 		ss->osd_topology_refiner = NULL;
 		ss->osd_mesh_invalid = false;
 		ss->osd_coarse_coords_invalid = false;
+		ss->osd_coarse_coords_changed_begin = 0;
+		ss->osd_coarse_coords_changed_end = -1;
 		ss->osd_vao = 0;
 		ss->skip_grids = false;
 		ss->osd_compute = 0;
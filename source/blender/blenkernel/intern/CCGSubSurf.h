@@ -71,7 +71,9 @@ typedef enum {
 
 /***/
 
-#define CCG_OMP_LIMIT	1000000
+#define CCG_TASK_LIMIT	1000000
+/* old name, still used by the remaining OpenMP loops in multires.c */
+#define CCG_OMP_LIMIT	CCG_TASK_LIMIT
 
 /***/
 
@@ -228,6 +228,11 @@ struct CCGSubSurf {
 	 * Used to avoid updating GL mesh coords on every redraw.
 	 */
 	bool osd_coarse_coords_invalid;
+	/* Range of coarse vertices which actually moved since the last GPU upload,
+	 * so deform-only updates (playback) only upload that part of the buffer.
+	 * End is exclusive, negative end means the whole buffer is uploaded.
+	 */
+	int osd_coarse_coords_changed_begin, osd_coarse_coords_changed_end;
 
 	/* GL mesh descriptor, used for refinment and draw. */
 	struct OpenSubdiv_GLMesh *osd_mesh;
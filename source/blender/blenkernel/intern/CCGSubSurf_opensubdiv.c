@@ -190,6 +190,8 @@ void ccgSubSurf_checkTopologyChanged(CCGSubSurf *ss, DerivedMesh *dm)
 		/* ** Make sure both GPU and CPU backends are properly reset. ** */
 
 		ss->osd_coarse_coords_invalid = true;
+		ss->osd_coarse_coords_changed_begin = 0;
+		ss->osd_coarse_coords_changed_end = -1;
 		ss->osd_uvs_invalid = true;
 
 		/* Reset GPU part. */
@@ -209,11 +211,25 @@ void ccgSubSurf_checkTopologyChanged(CCGSubSurf *ss, DerivedMesh *dm)
 
 static void ccgSubSurf__updateGLMeshCoords(CCGSubSurf *ss)
 {
+	int start_vertex = 0;
+	int num_verts = ss->osd_num_coarse_coords;
+
 	BLI_assert(ss->meshIFC.numLayers == 3);
+
+	/* Upload only the range of vertices which moved since the last refinement
+	 * when it's known, the whole buffer otherwise. */
+	if (ss->osd_coarse_coords_changed_end >= 0) {
+		start_vertex = ss->osd_coarse_coords_changed_begin;
+		num_verts = ss->osd_coarse_coords_changed_end - start_vertex;
+	}
+
 	openSubdiv_osdGLMeshUpdateVertexBuffer(ss->osd_mesh,
-	                                       (float *) ss->osd_coarse_coords,
-	                                       0,
-	                                       ss->osd_num_coarse_coords);
+	                                       (float *) (ss->osd_coarse_coords + start_vertex * 2),
+	                                       start_vertex,
+	                                       num_verts);
+
+	ss->osd_coarse_coords_changed_begin = 0;
+	ss->osd_coarse_coords_changed_end = -1;
 }
 
 bool ccgSubSurf_prepareGLMesh(CCGSubSurf *ss, bool use_osd_glsl)
@@ -265,6 +281,10 @@ bool ccgSubSurf_prepareGLMesh(CCGSubSurf *ss, bool use_osd_glsl)
 			return false;
 		}
 
+		/* Freshly created GPU buffer needs all of the coordinates. */
+		ss->osd_coarse_coords_changed_begin = 0;
+		ss->osd_coarse_coords_changed_end = -1;
+
 		ccgSubSurf__updateGLMeshCoords(ss);
 		openSubdiv_osdGLMeshRefine(ss->osd_mesh);
 		openSubdiv_osdGLMeshSynchronize(ss->osd_mesh);
@@ -854,6 +874,8 @@ void ccgSubSurf_prepareTopologyRefiner(CCGSubSurf *ss, DerivedMesh *dm)
 		const int num_verts = dm->getNumVerts(dm);
 		const MVert *mvert = dm->getVertArray(dm);
 		int vert;
+		int changed_begin = -1, changed_end = -1;
+		bool is_fresh_buffer = false;
 		if (ss->osd_coarse_coords != NULL &&
 		    num_verts != ss->osd_num_coarse_coords)
 		{
@@ -862,13 +884,44 @@ void ccgSubSurf_prepareTopologyRefiner(CCGSubSurf *ss, DerivedMesh *dm)
 		}
 		if (ss->osd_coarse_coords == NULL) {
 			ss->osd_coarse_coords = MEM_mallocN(sizeof(float) * 6 * num_verts, "osd coarse positions");
+			is_fresh_buffer = true;
 		}
+		/* Compare against the previous coordinates while filling the buffer in,
+		 * so deform-only evaluations (playback) know which vertices actually
+		 * moved and unchanged evaluations skip the GPU refinement entirely. */
 		for (vert = 0; vert < num_verts; vert++) {
+			float no[3];
+			normal_short_to_float_v3(no, mvert[vert].no);
+			if (!is_fresh_buffer &&
+			    (!equals_v3v3(ss->osd_coarse_coords[vert * 2 + 0], mvert[vert].co) ||
+			     !equals_v3v3(ss->osd_coarse_coords[vert * 2 + 1], no)))
+			{
+				if (changed_begin == -1) {
+					changed_begin = vert;
+				}
+				changed_end = vert + 1;
+			}
 			copy_v3_v3(ss->osd_coarse_coords[vert * 2 + 0], mvert[vert].co);
-			normal_short_to_float_v3(ss->osd_coarse_coords[vert * 2 + 1], mvert[vert].no);
+			copy_v3_v3(ss->osd_coarse_coords[vert * 2 + 1], no);
 		}
 		ss->osd_num_coarse_coords = num_verts;
-		ss->osd_coarse_coords_invalid = true;
+		if (is_fresh_buffer) {
+			ss->osd_coarse_coords_invalid = true;
+			ss->osd_coarse_coords_changed_begin = 0;
+			ss->osd_coarse_coords_changed_end = -1;
+		}
+		else if (changed_begin != -1) {
+			if (ss->osd_coarse_coords_invalid) {
+				/* A previous update was not uploaded yet, upload everything. */
+				ss->osd_coarse_coords_changed_begin = 0;
+				ss->osd_coarse_coords_changed_end = -1;
+			}
+			else {
+				ss->osd_coarse_coords_invalid = true;
+				ss->osd_coarse_coords_changed_begin = changed_begin;
+				ss->osd_coarse_coords_changed_end = changed_end;
+			}
+		}
 	}
 }
 
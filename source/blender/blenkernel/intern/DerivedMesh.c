@@ -46,10 +46,12 @@
 #include "BLI_array.h"
 #include "BLI_blenlib.h"
 #include "BLI_bitmap.h"
+#include "BLI_ghash.h"
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
 #include "BLI_linklist.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "BKE_cdderivedmesh.h"
 #include "BKE_editmesh.h"
@@ -295,6 +297,7 @@ void DM_init_funcs(DerivedMesh *dm)
 	dm->getLoopDataArray = DM_get_loop_data_layer;
 
 	bvhcache_init(&dm->bvhCache);
+	dm->mappingCache = NULL;
 }
 
 /**
@@ -373,6 +376,7 @@ int DM_release(DerivedMesh *dm)
 {
 	if (dm->needsFree) {
 		bvhcache_free(&dm->bvhCache);
+		BKE_mesh_mapping_cache_free(&dm->mappingCache);
 		GPU_drawobject_free(dm);
 		CustomData_free(&dm->vertData, dm->numVertData);
 		CustomData_free(&dm->edgeData, dm->numEdgeData);
@@ -2560,12 +2564,292 @@ static bool calc_modifiers_skip_orco(const Object *ob)
 }
 #endif
 
+/* -------------------------------------------------------------------- */
+/* Modifier stack result re-use
+ *
+ * The depsgraph tags objects with OB_RECALC_DATA rather liberally (moving one
+ * object can re-tag every object it shares relations with), so with many
+ * objects we often re-run a whole modifier stack only to produce exactly the
+ * DerivedMesh we already have. Remember a fingerprint of everything that goes
+ * into mesh_calc_modifiers() per object, and skip the rebuild when nothing
+ * changed. The result itself stays on the object (ob->derivedFinal/Deform) as
+ * usual, the cache only stores the fingerprint, so it adds no real memory of
+ * its own - entries are simply dropped when the table grows past a cap, and
+ * whenever the object's derived caches are freed for other reasons.
+ */
+
+/* maximum number of per-object fingerprint entries before dropping them all */
+#define DM_EVAL_FINGERPRINT_MAX 8192
+
+static GHash *dm_eval_fingerprint_hash = NULL;
+static ThreadMutex dm_eval_fingerprint_mutex = BLI_MUTEX_INITIALIZER;
+
+/* FNV-1a, word-at-a-time over the bulk of the buffer */
+static uint64_t dm_eval_fingerprint_feed(uint64_t h, const void *data, size_t len)
+{
+	const unsigned char *p = data;
+
+	for ( ; len >= sizeof(uint64_t); p += sizeof(uint64_t), len -= sizeof(uint64_t)) {
+		uint64_t w;
+		memcpy(&w, p, sizeof(w));
+		h = (h ^ w) * 0x100000001b3ULL;
+	}
+	for ( ; len != 0; p++, len--) {
+		h = (h ^ *p) * 0x100000001b3ULL;
+	}
+	return h;
+}
+
+static void dm_eval_fingerprint_id_link_cb(void *userData, Object *UNUSED(ob), ID **idpoin, int UNUSED(cd_flag))
+{
+	if (*idpoin) {
+		*((bool *)userData) = true;
+	}
+}
+
+/**
+ * Feed all layers of \a data that the caller doesn't hash explicitly.
+ *
+ * \return false when a layer holds per-element allocations (multires
+ * displacement and the like) whose contents we cannot hash cheaply,
+ * the result may not be re-used then.
+ */
+static bool dm_eval_fingerprint_feed_customdata(uint64_t *h, const CustomData *data, const int totelem)
+{
+	int i;
+
+	for (i = 0; i < data->totlayer; i++) {
+		const CustomDataLayer *layer = &data->layers[i];
+
+		switch (layer->type) {
+			/* hashed by the caller (dvert holds pointers, needs special handling) */
+			case CD_MVERT:
+			case CD_MEDGE:
+			case CD_MPOLY:
+			case CD_MLOOP:
+			case CD_MDEFORMVERT:
+				continue;
+			/* per-element allocations, edited in place */
+			case CD_MDISPS:
+			case CD_GRID_PAINT_MASK:
+				return false;
+		}
+
+		*h = dm_eval_fingerprint_feed(*h, &layer->type, sizeof(layer->type));
+		*h = dm_eval_fingerprint_feed(*h, &layer->active, sizeof(layer->active));
+		*h = dm_eval_fingerprint_feed(*h, layer->name, sizeof(layer->name));
+		if (layer->data) {
+			*h = dm_eval_fingerprint_feed(
+			        *h, layer->data, (size_t)CustomData_sizeof(layer->type) * (size_t)totelem);
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Fingerprint all inputs of the viewport modifier stack evaluation of \a ob.
+ *
+ * \return false when the result may not be re-used (stack depends on time,
+ * on other IDs whose change we cannot detect here, or the object is in a mode
+ * that edits data in place).
+ */
+static bool dm_eval_fingerprint_calc(
+        Scene *scene, Object *ob, CustomDataMask dataMask,
+        const bool build_shapekey_layers, const bool need_mapping,
+        uint64_t *r_hash)
+{
+	Mesh *me = ob->data;
+	VirtualModifierData virtualModifierData;
+	ModifierData *md;
+	uint64_t h = 0xcbf29ce484222325ULL;
+
+	if (ob->mode != OB_MODE_OBJECT) {
+		/* sculpt/paint/edit modes modify data in place */
+		return false;
+	}
+	if (me->key || ob->particlesystem.first || ob->soft) {
+		/* shape keys and point-cached data are animated without any
+		 * change we could detect on the stack itself */
+		return false;
+	}
+
+	for (md = modifiers_getVirtualModifierList(ob, &virtualModifierData);
+	     md;
+	     md = md->next)
+	{
+		const ModifierTypeInfo *mti = modifierType_getInfo(md->type);
+		bool has_id_link = false;
+
+		if (!modifier_isEnabled(scene, md, eModifierMode_Realtime)) {
+			continue;
+		}
+		if (mti->dependsOnTime && mti->dependsOnTime(md)) {
+			return false;
+		}
+		/* any linked object/texture may change without this stack changing */
+		if (mti->foreachIDLink) {
+			mti->foreachIDLink(md, ob, dm_eval_fingerprint_id_link_cb, &has_id_link);
+		}
+		else if (mti->foreachObjectLink) {
+			mti->foreachObjectLink(md, ob, (ObjectWalkFunc)dm_eval_fingerprint_id_link_cb, &has_id_link);
+		}
+		if (has_id_link) {
+			return false;
+		}
+
+		h = dm_eval_fingerprint_feed(h, &md->type, sizeof(md->type));
+		h = dm_eval_fingerprint_feed(h, &md->mode, sizeof(md->mode));
+		if (md->type == eModifierType_Subsurf) {
+			/* the struct tail holds the runtime caches (emCache/mCache) which
+			 * change on every evaluation, hashing them would defeat re-use
+			 * entirely, so hash the user settings individually instead */
+			const SubsurfModifierData *smd = (const SubsurfModifierData *)md;
+			h = dm_eval_fingerprint_feed(h, &smd->subdivType, sizeof(smd->subdivType));
+			h = dm_eval_fingerprint_feed(h, &smd->levels, sizeof(smd->levels));
+			h = dm_eval_fingerprint_feed(h, &smd->flags, sizeof(smd->flags));
+			h = dm_eval_fingerprint_feed(h, &smd->use_opensubdiv, sizeof(smd->use_opensubdiv));
+		}
+		else if (ELEM(md->type, eModifierType_Hook, eModifierType_Warp, eModifierType_WeightVGEdit)) {
+			/* falloff curves are heap data edited in place behind a stable
+			 * pointer, there is nothing in the struct to detect edits with */
+			return false;
+		}
+		else {
+			/* settings are the struct tail, past the ModifierData header (which
+			 * holds list pointers that change without any user visible effect) */
+			h = dm_eval_fingerprint_feed(
+			        h, (const char *)md + sizeof(ModifierData),
+			        (size_t)mti->structSize - sizeof(ModifierData));
+		}
+	}
+
+	/* input mesh 'version': topology counts and the geometry arrays themselves,
+	 * hashing these is still far cheaper than evaluating even a single modifier */
+	h = dm_eval_fingerprint_feed(h, &me, sizeof(me));
+	h = dm_eval_fingerprint_feed(h, &me->totvert, sizeof(me->totvert));
+	h = dm_eval_fingerprint_feed(h, &me->totedge, sizeof(me->totedge));
+	h = dm_eval_fingerprint_feed(h, &me->totpoly, sizeof(me->totpoly));
+	h = dm_eval_fingerprint_feed(h, &me->totloop, sizeof(me->totloop));
+	h = dm_eval_fingerprint_feed(h, me->mvert, sizeof(*me->mvert) * (size_t)me->totvert);
+	h = dm_eval_fingerprint_feed(h, me->medge, sizeof(*me->medge) * (size_t)me->totedge);
+	h = dm_eval_fingerprint_feed(h, me->mpoly, sizeof(*me->mpoly) * (size_t)me->totpoly);
+	h = dm_eval_fingerprint_feed(h, me->mloop, sizeof(*me->mloop) * (size_t)me->totloop);
+	if (me->dvert) {
+		int i;
+		for (i = 0; i < me->totvert; i++) {
+			h = dm_eval_fingerprint_feed(
+			        h, me->dvert[i].dw, sizeof(*me->dvert[i].dw) * (size_t)me->dvert[i].totweight);
+		}
+	}
+
+	/* the remaining layers (UVs, vertex colors, custom normals, ...) feed into
+	 * evaluation as well and can be edited without the arrays above changing */
+	if (!dm_eval_fingerprint_feed_customdata(&h, &me->vdata, me->totvert) ||
+	    !dm_eval_fingerprint_feed_customdata(&h, &me->edata, me->totedge) ||
+	    !dm_eval_fingerprint_feed_customdata(&h, &me->pdata, me->totpoly) ||
+	    !dm_eval_fingerprint_feed_customdata(&h, &me->ldata, me->totloop))
+	{
+		return false;
+	}
+
+	/* mesh settings read during modifier evaluation (auto smooth) */
+	h = dm_eval_fingerprint_feed(h, &me->flag, sizeof(me->flag));
+	h = dm_eval_fingerprint_feed(h, &me->smoothresh, sizeof(me->smoothresh));
+
+	/* scene simplify lowers subsurf levels behind the modifier's back */
+	{
+		const int simplify = (scene->r.mode & R_SIMPLIFY) != 0;
+		h = dm_eval_fingerprint_feed(h, &simplify, sizeof(simplify));
+		h = dm_eval_fingerprint_feed(h, &scene->r.simplify_subsurf, sizeof(scene->r.simplify_subsurf));
+	}
+
+	/* evaluation parameters */
+	h = dm_eval_fingerprint_feed(h, &dataMask, sizeof(dataMask));
+	h = dm_eval_fingerprint_feed(h, &build_shapekey_layers, sizeof(build_shapekey_layers));
+	h = dm_eval_fingerprint_feed(h, &need_mapping, sizeof(need_mapping));
+
+	*r_hash = h;
+	return true;
+}
+
+static bool dm_eval_fingerprint_match(Object *ob, const uint64_t hash)
+{
+	const uint64_t *val;
+	bool match = false;
+
+	BLI_mutex_lock(&dm_eval_fingerprint_mutex);
+	if (dm_eval_fingerprint_hash &&
+	    (val = BLI_ghash_lookup(dm_eval_fingerprint_hash, ob)))
+	{
+		match = (*val == hash);
+	}
+	BLI_mutex_unlock(&dm_eval_fingerprint_mutex);
+
+	return match;
+}
+
+static void dm_eval_fingerprint_store(Object *ob, const uint64_t hash)
+{
+	uint64_t *val;
+
+	BLI_mutex_lock(&dm_eval_fingerprint_mutex);
+	if (dm_eval_fingerprint_hash == NULL) {
+		dm_eval_fingerprint_hash = BLI_ghash_ptr_new(__func__);
+	}
+	else if (BLI_ghash_size(dm_eval_fingerprint_hash) >= DM_EVAL_FINGERPRINT_MAX) {
+		/* simple budget: drop everything, entries re-appear as objects re-evaluate */
+		BLI_ghash_clear(dm_eval_fingerprint_hash, NULL, MEM_freeN);
+	}
+
+	val = BLI_ghash_lookup(dm_eval_fingerprint_hash, ob);
+	if (val == NULL) {
+		val = MEM_mallocN(sizeof(*val), __func__);
+		BLI_ghash_insert(dm_eval_fingerprint_hash, ob, val);
+	}
+	*val = hash;
+	BLI_mutex_unlock(&dm_eval_fingerprint_mutex);
+}
+
+/* called whenever an object's derived caches are freed, also on object free */
+void DM_eval_fingerprint_object_remove(Object *ob)
+{
+	BLI_mutex_lock(&dm_eval_fingerprint_mutex);
+	if (dm_eval_fingerprint_hash) {
+		BLI_ghash_remove(dm_eval_fingerprint_hash, ob, NULL, MEM_freeN);
+	}
+	BLI_mutex_unlock(&dm_eval_fingerprint_mutex);
+}
+
+void DM_eval_fingerprint_free(void)
+{
+	BLI_mutex_lock(&dm_eval_fingerprint_mutex);
+	if (dm_eval_fingerprint_hash) {
+		BLI_ghash_free(dm_eval_fingerprint_hash, NULL, MEM_freeN);
+		dm_eval_fingerprint_hash = NULL;
+	}
+	BLI_mutex_unlock(&dm_eval_fingerprint_mutex);
+}
+
 static void mesh_build_data(
         Scene *scene, Object *ob, CustomDataMask dataMask,
         const bool build_shapekey_layers, const bool need_mapping)
 {
+	uint64_t fingerprint;
+	bool use_fingerprint;
+
 	BLI_assert(ob->type == OB_MESH);
 
+	use_fingerprint = dm_eval_fingerprint_calc(
+	        scene, ob, dataMask, build_shapekey_layers, need_mapping, &fingerprint);
+
+	if (use_fingerprint && ob->derivedFinal && ob->derivedDeform &&
+	    dm_eval_fingerprint_match(ob, fingerprint))
+	{
+		/* nothing the stack depends on changed, keep the current result */
+		return;
+	}
+
 	BKE_object_free_derived_caches(ob);
 	BKE_object_sculpt_modifiers_changed(ob);
 
@@ -2594,6 +2878,10 @@ static void mesh_build_data(
 		BKE_sculpt_update_mesh_elements(scene, scene->toolsettings->sculpt, ob, false, false);
 	}
 
+	if (use_fingerprint) {
+		dm_eval_fingerprint_store(ob, fingerprint);
+	}
+
 	BLI_assert(!(ob->derivedFinal->dirty & DM_DIRTY_NORMALS));
 }
 
@@ -42,6 +42,7 @@
 #include "BLI_blenlib.h"
 #include "BLI_alloca.h"
 #include "BLI_dynstr.h"
+#include "BLI_ghash.h"
 #include "BLI_listbase.h"
 
 #include "BLT_translation.h"
@@ -71,6 +72,8 @@
 
 #include "RNA_access.h"
 
+#include "atomic_ops.h"
+
 #include "nla_private.h"
 
 /* ***************************************** */
@@ -242,7 +245,10 @@ void BKE_animdata_free(ID *id)
 			
 			/* free overrides */
 			/* TODO... */
-			
+
+			/* free resolved path cache */
+			BKE_animsys_rna_cache_free(adt);
+
 			/* free animdata now */
 			MEM_freeN(adt);
 			iat->adt = NULL;
@@ -280,7 +286,10 @@ AnimData *BKE_animdata_copy(AnimData *adt, const bool do_action)
 	
 	/* don't copy overrides */
 	BLI_listbase_clear(&dadt->overrides);
-	
+
+	/* don't share the resolved path cache, it's rebuilt on demand */
+	dadt->rna_path_cache = NULL;
+
 	/* return */
 	return dadt;
 }
@@ -968,7 +977,11 @@ void BKE_animdata_fix_paths_rename(ID *owner_id, AnimData *adt, ID *ref_id, cons
 	/* if no AnimData, no need to proceed */
 	if (ELEM(NULL, owner_id, adt))
 		return;
-	
+
+	/* cached resolved paths may now point at the wrong data, e.g. when
+	 * another datablock later re-uses the old name */
+	BKE_animsys_rna_cache_invalidate();
+
 	/* Name sanitation logic - shared with BKE_action_fix_paths_rename() */
 	if ((oldName != NULL) && (newName != NULL)) {
 		/* pad the names with [" "] so that only exact matches are made */
@@ -1057,6 +1070,10 @@ void BKE_animdata_fix_paths_remove(ID *id, const char *prefix)
 
 		/* check if there's any AnimData to start with */
 		if (adt) {
+			/* the data behind the removed paths is typically about to be
+			 * freed (node/strip deletion doesn't go through a relations
+			 * update), so no cached resolved pointer into it may survive */
+			BKE_animsys_rna_cache_invalidate();
 
 			/* free fcurves */
 			if (adt->action)
@@ -1171,9 +1188,13 @@ void BKE_animdata_fix_paths_rename_all(ID *ref_id, const char *prefix, const cha
 {
 	Main *mainptr = G.main;
 	ID *id;
-	
-	/* macro for less typing 
-	 *	- whether animdata exists is checked for by the main renaming callback, though taking 
+
+	/* see BKE_animdata_fix_paths_rename(); bumped here as well so the cache
+	 * is invalidated even when the renamed data has no own AnimData */
+	BKE_animsys_rna_cache_invalidate();
+
+	/* macro for less typing
+	 *	- whether animdata exists is checked for by the main renaming callback, though taking
 	 *	  this outside of the function may make things slightly faster?
 	 */
 #define RENAMEFIX_ANIM_IDS(first) \
@@ -1483,19 +1504,97 @@ static bool animsys_remap_path(AnimMapper *UNUSED(remap), char *path, char **dst
 }
 
 
+/* ***************************************** */
+/* Resolved RNA-Path Cache */
+
+/* Cached result of RNA_path_resolve_property() for one path, relative to the
+ * ID owning the AnimData. Entries carry a generation number: whenever the
+ * layout of datablocks may have changed (pointers stored in the resolved
+ * PointerRNA may be dangling), the global generation is bumped and all
+ * entries re-resolve on their next use.
+ */
+typedef struct AnimRNAPathCacheEntry {
+	PointerRNA ptr;
+	PropertyRNA *prop;
+	unsigned int generation;
+	bool resolved;
+} AnimRNAPathCacheEntry;
+
+/* Never matches a freshly allocated entry (those start at generation 0). */
+static unsigned int animsys_rna_cache_generation = 1;
+
+void BKE_animsys_rna_cache_invalidate(void)
+{
+	atomic_add_uint32(&animsys_rna_cache_generation, 1);
+}
+
+void BKE_animsys_rna_cache_free(AnimData *adt)
+{
+	if (adt->rna_path_cache != NULL) {
+		BLI_ghash_free(adt->rna_path_cache, MEM_freeN, MEM_freeN);
+		adt->rna_path_cache = NULL;
+	}
+}
+
+/* Resolve a path relative to the AnimData owner, using the cache. Only for
+ * paths rooted at the ID owning the AnimData: NLA strip control curves and
+ * the like resolve against other roots and must pass adt=NULL.
+ *
+ * NOTE: an AnimData block is only ever evaluated by one thread at a time
+ * (it's a single operation in the depsgraph), so no locking is needed here.
+ */
+static bool animsys_rna_path_resolve_cached(AnimData *adt, PointerRNA *ptr, const char *path,
+                                            PointerRNA *r_ptr, PropertyRNA **r_prop)
+{
+	GHash *cache;
+	AnimRNAPathCacheEntry *entry;
+
+	if (adt == NULL) {
+		return RNA_path_resolve_property(ptr, path, r_ptr, r_prop);
+	}
+
+	if (adt->rna_path_cache == NULL) {
+		adt->rna_path_cache = BLI_ghash_str_new("AnimData rna_path_cache");
+	}
+	cache = adt->rna_path_cache;
+
+	entry = BLI_ghash_lookup(cache, path);
+	if (entry == NULL) {
+		entry = MEM_callocN(sizeof(AnimRNAPathCacheEntry), "AnimRNAPathCacheEntry");
+		BLI_ghash_insert(cache, BLI_strdup(path), entry);
+	}
+
+	if (entry->generation != animsys_rna_cache_generation) {
+		entry->resolved = RNA_path_resolve_property(ptr, path, &entry->ptr, &entry->prop);
+		entry->generation = animsys_rna_cache_generation;
+	}
+
+	if (!entry->resolved) {
+		return false;
+	}
+	*r_ptr = entry->ptr;
+	*r_prop = entry->prop;
+	return true;
+}
+
+/* ***************************************** */
+
 /* less than 1.0 evaluates to false, use epsilon to avoid float error */
 #define ANIMSYS_FLOAT_AS_BOOL(value) ((value) > ((1.0f - FLT_EPSILON)))
 
-/* Write the given value to a setting using RNA, and return success */
-static bool animsys_write_rna_setting(PointerRNA *ptr, char *path, int array_index, float value)
+/* Write the given value to a setting using RNA, and return success.
+ * adt is only used for caching the resolved path and may be NULL,
+ * see animsys_rna_path_resolve_cached().
+ */
+static bool animsys_write_rna_setting(AnimData *adt, PointerRNA *ptr, char *path, int array_index, float value)
 {
 	PropertyRNA *prop;
 	PointerRNA new_ptr;
-	
+
 	//printf("%p %s %i %f\n", ptr, path, array_index, value);
-	
+
 	/* get property to write to */
-	if (RNA_path_resolve_property(ptr, path, &new_ptr, &prop)) {
+	if (animsys_rna_path_resolve_cached(adt, ptr, path, &new_ptr, &prop)) {
 		/* set value for animatable numerical values only
 		 * HACK: some local F-Curves (e.g. those on NLA Strips) are evaluated
 		 *       without an ID provided, which causes the animateable test to fail!
@@ -1619,35 +1718,42 @@ static bool animsys_write_rna_setting(PointerRNA *ptr, char *path, int array_ind
 	}
 }
 
-/* Simple replacement based data-setting of the FCurve using RNA */
-bool BKE_animsys_execute_fcurve(PointerRNA *ptr, AnimMapper *remap, FCurve *fcu)
+/* Simple replacement based data-setting of the FCurve using RNA,
+ * adt is only used for caching the resolved path and may be NULL.
+ */
+static bool animsys_execute_fcurve_ex(AnimData *adt, PointerRNA *ptr, AnimMapper *remap, FCurve *fcu)
 {
 	char *path = NULL;
 	bool free_path = false;
 	bool ok = false;
-	
+
 	/* get path, remapped as appropriate to work in its new environment */
 	free_path = animsys_remap_path(remap, fcu->rna_path, &path);
-	
+
 	/* write value to setting */
 	if (path)
-		ok = animsys_write_rna_setting(ptr, path, fcu->array_index, fcu->curval);
-	
+		ok = animsys_write_rna_setting(adt, ptr, path, fcu->array_index, fcu->curval);
+
 	/* free temp path-info */
 	if (free_path)
 		MEM_freeN(path);
-		
+
 	/* return whether we were successful */
 	return ok;
 }
 
-/* Evaluate all the F-Curves in the given list 
+bool BKE_animsys_execute_fcurve(PointerRNA *ptr, AnimMapper *remap, FCurve *fcu)
+{
+	return animsys_execute_fcurve_ex(NULL, ptr, remap, fcu);
+}
+
+/* Evaluate all the F-Curves in the given list
  * This performs a set of standard checks. If extra checks are required, separate code should be used
  */
-static void animsys_evaluate_fcurves(PointerRNA *ptr, ListBase *list, AnimMapper *remap, float ctime)
+static void animsys_evaluate_fcurves(AnimData *adt, PointerRNA *ptr, ListBase *list, AnimMapper *remap, float ctime)
 {
 	FCurve *fcu;
-	
+
 	/* calculate then execute each curve */
 	for (fcu = list->first; fcu; fcu = fcu->next) {
 		/* check if this F-Curve doesn't belong to a muted group */
@@ -1655,7 +1761,7 @@ static void animsys_evaluate_fcurves(PointerRNA *ptr, ListBase *list, AnimMapper
 			/* check if this curve should be skipped */
 			if ((fcu->flag & (FCURVE_MUTED | FCURVE_DISABLED)) == 0) {
 				calculate_fcurve(fcu, ctime);
-				BKE_animsys_execute_fcurve(ptr, remap, fcu); 
+				animsys_execute_fcurve_ex(adt, ptr, remap, fcu);
 			}
 		}
 	}
@@ -1685,8 +1791,8 @@ static void animsys_evaluate_drivers(PointerRNA *ptr, AnimData *adt, float ctime
 				 * NOTE: for 'layering' option later on, we should check if we should remove old value before adding
 				 *       new to only be done when drivers only changed */
 				calculate_fcurve(fcu, ctime);
-				ok = BKE_animsys_execute_fcurve(ptr, NULL, fcu);
-				
+				ok = animsys_execute_fcurve_ex(adt, ptr, NULL, fcu);
+
 				/* clear recalc flag */
 				driver->flag &= ~DRIVER_FLAG_RECALC;
 				
@@ -1759,17 +1865,24 @@ void animsys_evaluate_action_group(PointerRNA *ptr, bAction *act, bActionGroup *
 	}
 }
 
-/* Evaluate Action (F-Curve Bag) */
-void animsys_evaluate_action(PointerRNA *ptr, bAction *act, AnimMapper *remap, float ctime)
+/* Evaluate Action (F-Curve Bag),
+ * adt is only used for caching the resolved paths and may be NULL.
+ */
+static void animsys_evaluate_action_ex(AnimData *adt, PointerRNA *ptr, bAction *act, AnimMapper *remap, float ctime)
 {
 	/* check if mapper is appropriate for use here (we set to NULL if it's inappropriate) */
 	if (act == NULL) return;
 	if ((remap) && (remap->target != act)) remap = NULL;
-	
+
 	action_idcode_patch_check(ptr->id.data, act);
-	
+
 	/* calculate then execute each curve */
-	animsys_evaluate_fcurves(ptr, &act->curves, remap, ctime);
+	animsys_evaluate_fcurves(adt, ptr, &act->curves, remap, ctime);
+}
+
+void animsys_evaluate_action(PointerRNA *ptr, bAction *act, AnimMapper *remap, float ctime)
+{
+	animsys_evaluate_action_ex(NULL, ptr, act, remap, ctime);
 }
 
 /* ***************************************** */
@@ -1807,8 +1920,9 @@ static void nlastrip_evaluate_controls(NlaStrip *strip, float ctime)
 		/* create RNA-pointer needed to set values */
 		RNA_pointer_create(NULL, &RNA_NlaStrip, strip, &strip_ptr);
 		
-		/* execute these settings as per normal */
-		animsys_evaluate_fcurves(&strip_ptr, &strip->fcurves, NULL, ctime);
+		/* execute these settings as per normal,
+		 * not rooted at the AnimData owner so no path caching here */
+		animsys_evaluate_fcurves(NULL, &strip_ptr, &strip->fcurves, NULL, ctime);
 	}
 	
 	/* analytically generate values for influence and time (if applicable)
@@ -2539,7 +2653,7 @@ static void animsys_evaluate_nla(ListBase *echannels, PointerRNA *ptr, AnimData
 			/* TODO: this is really just a stop-gap measure... */
 			if (G.debug & G_DEBUG) printf("NLA Eval: Stopgap for active action on NLA Stack - no strips case\n");
 			
-			animsys_evaluate_action(ptr, adt->action, adt->remap, ctime);
+			animsys_evaluate_action_ex(adt, ptr, adt->action, adt->remap, ctime);
 			BLI_freelistN(&estrips);
 			return;
 		}
@@ -2613,7 +2727,7 @@ static void animsys_evaluate_overrides(PointerRNA *ptr, AnimData *adt)
 	
 	/* for each override, simply execute... */
 	for (aor = adt->overrides.first; aor; aor = aor->next)
-		animsys_write_rna_setting(ptr, aor->rna_path, aor->array_index, aor->value);
+		animsys_write_rna_setting(NULL, ptr, aor->rna_path, aor->array_index, aor->value);
 }
 
 /* ***************************************** */
@@ -2682,7 +2796,7 @@ void BKE_animsys_evaluate_animdata(Scene *scene, ID *id, AnimData *adt, float ct
 		}
 		/* evaluate Active Action only */
 		else if (adt->action)
-			animsys_evaluate_action(&id_ptr, adt->action, adt->remap, ctime);
+			animsys_evaluate_action_ex(adt, &id_ptr, adt->action, adt->remap, ctime);
 		
 		/* reset tag */
 		adt->recalc &= ~ADT_RECALC_ANIM;
@@ -882,6 +882,184 @@ static void armature_bbone_defmats_cb(void *userdata, Link *iter, int index)
 	}
 }
 
+typedef struct ArmatureUserdata {
+	Object *armOb;
+	DerivedMesh *dm;
+	float (*vertexCos)[3];
+	float (*defMats)[3][3];
+	float (*prevCos)[3];
+	MDeformVert *dverts;
+	MDeformVert *dverts_dm;
+	int defbase_tot;
+	int target_totvert;
+	int armature_def_nr;
+	bool use_envelope;
+	bool use_quaternion;
+	bool invert_vgroup;
+	bool use_dverts;
+	float premat[4][4];
+	float postmat[4][4];
+	bPoseChannel **defnrToPC;
+	int *defnrToPCIndex;
+	bPoseChanDeform *pdef_info_array;
+} ArmatureUserdata;
+
+static void armature_deform_coords_cb(void *userdata, const int i)
+{
+	ArmatureUserdata *data = userdata;
+	float (*const vertexCos)[3] = data->vertexCos;
+	float (*const defMats)[3][3] = data->defMats;
+	float (*const prevCos)[3] = data->prevCos;
+	const bool use_envelope = data->use_envelope;
+	const bool use_quaternion = data->use_quaternion;
+	const bool use_dverts = data->use_dverts;
+	const int armature_def_nr = data->armature_def_nr;
+	bPoseChannel *pchan;
+	bPoseChanDeform *pdef_info;
+	MDeformVert *dvert;
+	DualQuat sumdq, *dq = NULL;
+	float *co, dco[3];
+	float sumvec[3], summat[3][3];
+	float *vec = NULL, (*smat)[3] = NULL;
+	float contrib = 0.0f;
+	float armature_weight = 1.0f; /* default to 1 if no overall def group */
+	float prevco_weight = 1.0f;   /* weight for optional cached vertexcos */
+
+	if (use_quaternion) {
+		memset(&sumdq, 0, sizeof(DualQuat));
+		dq = &sumdq;
+	}
+	else {
+		sumvec[0] = sumvec[1] = sumvec[2] = 0.0f;
+		vec = sumvec;
+
+		if (defMats) {
+			zero_m3(summat);
+			smat = summat;
+		}
+	}
+
+	if (use_dverts || armature_def_nr != -1) {
+		if (data->dm)
+			dvert = data->dverts_dm ? &data->dverts_dm[i] : NULL;
+		else if (data->dverts && i < data->target_totvert)
+			dvert = data->dverts + i;
+		else
+			dvert = NULL;
+	}
+	else
+		dvert = NULL;
+
+	if (armature_def_nr != -1 && dvert) {
+		armature_weight = defvert_find_weight(dvert, armature_def_nr);
+
+		if (data->invert_vgroup)
+			armature_weight = 1.0f - armature_weight;
+
+		/* hackish: the blending factor can be used for blending with prevCos too */
+		if (prevCos) {
+			prevco_weight = armature_weight;
+			armature_weight = 1.0f;
+		}
+	}
+
+	/* check if there's any  point in calculating for this vert */
+	if (armature_weight == 0.0f)
+		return;
+
+	/* get the coord we work on */
+	co = prevCos ? prevCos[i] : vertexCos[i];
+
+	/* Apply the object's matrix */
+	mul_m4_v3(data->premat, co);
+
+	if (use_dverts && dvert && dvert->totweight) { /* use weight groups ? */
+		MDeformWeight *dw = dvert->dw;
+		int deformed = 0;
+		unsigned int j;
+
+		for (j = dvert->totweight; j != 0; j--, dw++) {
+			const int index = dw->def_nr;
+			if (index >= 0 && index < data->defbase_tot && (pchan = data->defnrToPC[index])) {
+				float weight = dw->weight;
+				Bone *bone = pchan->bone;
+				pdef_info = data->pdef_info_array + data->defnrToPCIndex[index];
+
+				deformed = 1;
+
+				if (bone && bone->flag & BONE_MULT_VG_ENV) {
+					weight *= distfactor_to_bone(co, bone->arm_head, bone->arm_tail,
+					                             bone->rad_head, bone->rad_tail, bone->dist);
+				}
+				pchan_bone_deform(pchan, pdef_info, weight, vec, dq, smat, co, &contrib);
+			}
+		}
+		/* if there are vertexgroups but not groups with bones
+		 * (like for softbody groups) */
+		if (deformed == 0 && use_envelope) {
+			pdef_info = data->pdef_info_array;
+			for (pchan = data->armOb->pose->chanbase.first; pchan; pchan = pchan->next, pdef_info++) {
+				if (!(pchan->bone->flag & BONE_NO_DEFORM))
+					contrib += dist_bone_deform(pchan, pdef_info, vec, dq, smat, co);
+			}
+		}
+	}
+	else if (use_envelope) {
+		pdef_info = data->pdef_info_array;
+		for (pchan = data->armOb->pose->chanbase.first; pchan; pchan = pchan->next, pdef_info++) {
+			if (!(pchan->bone->flag & BONE_NO_DEFORM))
+				contrib += dist_bone_deform(pchan, pdef_info, vec, dq, smat, co);
+		}
+	}
+
+	/* actually should be EPSILON? weight values and contrib can be like 10e-39 small */
+	if (contrib > 0.0001f) {
+		if (use_quaternion) {
+			normalize_dq(dq, contrib);
+
+			if (armature_weight != 1.0f) {
+				copy_v3_v3(dco, co);
+				mul_v3m3_dq(dco, (defMats) ? summat : NULL, dq);
+				sub_v3_v3(dco, co);
+				mul_v3_fl(dco, armature_weight);
+				add_v3_v3(co, dco);
+			}
+			else
+				mul_v3m3_dq(co, (defMats) ? summat : NULL, dq);
+
+			smat = summat;
+		}
+		else {
+			mul_v3_fl(vec, armature_weight / contrib);
+			add_v3_v3v3(co, vec, co);
+		}
+
+		if (defMats) {
+			float pre[3][3], post[3][3], tmpmat[3][3];
+
+			copy_m3_m4(pre, data->premat);
+			copy_m3_m4(post, data->postmat);
+			copy_m3_m3(tmpmat, defMats[i]);
+
+			if (!use_quaternion) /* quaternion already is scale corrected */
+				mul_m3_fl(smat, armature_weight / contrib);
+
+			mul_m3_series(defMats[i], post, smat, pre, tmpmat);
+		}
+	}
+
+	/* always, check above code */
+	mul_m4_v3(data->postmat, co);
+
+	/* interpolate with previous modifier position using weight group */
+	if (prevCos) {
+		float mw = 1.0f - prevco_weight;
+		vertexCos[i][0] = prevco_weight * vertexCos[i][0] + mw * co[0];
+		vertexCos[i][1] = prevco_weight * vertexCos[i][1] + mw * co[1];
+		vertexCos[i][2] = prevco_weight * vertexCos[i][2] + mw * co[2];
+	}
+}
+
 void armature_deform_verts(Object *armOb, Object *target, DerivedMesh *dm, float (*vertexCos)[3],
                            float (*defMats)[3][3], int numVerts, int deformflag,
                            float (*prevCos)[3], const char *defgrp_name)
@@ -980,149 +1158,20 @@ void armature_deform_verts(Object *armOb, Object *target, DerivedMesh *dm, float
 		}
 	}
 
-	for (i = 0; i < numVerts; i++) {
-		MDeformVert *dvert;
-		DualQuat sumdq, *dq = NULL;
-		float *co, dco[3];
-		float sumvec[3], summat[3][3];
-		float *vec = NULL, (*smat)[3] = NULL;
-		float contrib = 0.0f;
-		float armature_weight = 1.0f; /* default to 1 if no overall def group */
-		float prevco_weight = 1.0f;   /* weight for optional cached vertexcos */
-
-		if (use_quaternion) {
-			memset(&sumdq, 0, sizeof(DualQuat));
-			dq = &sumdq;
-		}
-		else {
-			sumvec[0] = sumvec[1] = sumvec[2] = 0.0f;
-			vec = sumvec;
-
-			if (defMats) {
-				zero_m3(summat);
-				smat = summat;
-			}
-		}
-
-		if (use_dverts || armature_def_nr != -1) {
-			if (dm)
-				dvert = dm->getVertData(dm, i, CD_MDEFORMVERT);
-			else if (dverts && i < target_totvert)
-				dvert = dverts + i;
-			else
-				dvert = NULL;
-		}
-		else
-			dvert = NULL;
-
-		if (armature_def_nr != -1 && dvert) {
-			armature_weight = defvert_find_weight(dvert, armature_def_nr);
-
-			if (invert_vgroup)
-				armature_weight = 1.0f - armature_weight;
-
-			/* hackish: the blending factor can be used for blending with prevCos too */
-			if (prevCos) {
-				prevco_weight = armature_weight;
-				armature_weight = 1.0f;
-			}
-		}
-
-		/* check if there's any  point in calculating for this vert */
-		if (armature_weight == 0.0f)
-			continue;
-
-		/* get the coord we work on */
-		co = prevCos ? prevCos[i] : vertexCos[i];
-
-		/* Apply the object's matrix */
-		mul_m4_v3(premat, co);
-
-		if (use_dverts && dvert && dvert->totweight) { /* use weight groups ? */
-			MDeformWeight *dw = dvert->dw;
-			int deformed = 0;
-			unsigned int j;
-
-			for (j = dvert->totweight; j != 0; j--, dw++) {
-				const int index = dw->def_nr;
-				if (index >= 0 && index < defbase_tot && (pchan = defnrToPC[index])) {
-					float weight = dw->weight;
-					Bone *bone = pchan->bone;
-					pdef_info = pdef_info_array + defnrToPCIndex[index];
-
-					deformed = 1;
-
-					if (bone && bone->flag & BONE_MULT_VG_ENV) {
-						weight *= distfactor_to_bone(co, bone->arm_head, bone->arm_tail,
-						                             bone->rad_head, bone->rad_tail, bone->dist);
-					}
-					pchan_bone_deform(pchan, pdef_info, weight, vec, dq, smat, co, &contrib);
-				}
-			}
-			/* if there are vertexgroups but not groups with bones
-			 * (like for softbody groups) */
-			if (deformed == 0 && use_envelope) {
-				pdef_info = pdef_info_array;
-				for (pchan = armOb->pose->chanbase.first; pchan; pchan = pchan->next, pdef_info++) {
-					if (!(pchan->bone->flag & BONE_NO_DEFORM))
-						contrib += dist_bone_deform(pchan, pdef_info, vec, dq, smat, co);
-				}
-			}
-		}
-		else if (use_envelope) {
-			pdef_info = pdef_info_array;
-			for (pchan = armOb->pose->chanbase.first; pchan; pchan = pchan->next, pdef_info++) {
-				if (!(pchan->bone->flag & BONE_NO_DEFORM))
-					contrib += dist_bone_deform(pchan, pdef_info, vec, dq, smat, co);
-			}
-		}
-
-		/* actually should be EPSILON? weight values and contrib can be like 10e-39 small */
-		if (contrib > 0.0001f) {
-			if (use_quaternion) {
-				normalize_dq(dq, contrib);
+	{
+		ArmatureUserdata data2 = {
+		    .armOb = armOb, .dm = dm, .vertexCos = vertexCos, .defMats = defMats, .prevCos = prevCos,
+		    .dverts = dverts, .dverts_dm = (dm) ? dm->getVertDataArray(dm, CD_MDEFORMVERT) : NULL,
+		    .defbase_tot = defbase_tot, .target_totvert = target_totvert, .armature_def_nr = armature_def_nr,
+		    .use_envelope = use_envelope, .use_quaternion = use_quaternion,
+		    .invert_vgroup = invert_vgroup, .use_dverts = use_dverts,
+		    .defnrToPC = defnrToPC, .defnrToPCIndex = defnrToPCIndex, .pdef_info_array = pdef_info_array,
+		};
+		copy_m4_m4(data2.premat, premat);
+		copy_m4_m4(data2.postmat, postmat);
 
-				if (armature_weight != 1.0f) {
-					copy_v3_v3(dco, co);
-					mul_v3m3_dq(dco, (defMats) ? summat : NULL, dq);
-					sub_v3_v3(dco, co);
-					mul_v3_fl(dco, armature_weight);
-					add_v3_v3(co, dco);
-				}
-				else
-					mul_v3m3_dq(co, (defMats) ? summat : NULL, dq);
-
-				smat = summat;
-			}
-			else {
-				mul_v3_fl(vec, armature_weight / contrib);
-				add_v3_v3v3(co, vec, co);
-			}
-
-			if (defMats) {
-				float pre[3][3], post[3][3], tmpmat[3][3];
-
-				copy_m3_m4(pre, premat);
-				copy_m3_m4(post, postmat);
-				copy_m3_m3(tmpmat, defMats[i]);
-
-				if (!use_quaternion) /* quaternion already is scale corrected */
-					mul_m3_fl(smat, armature_weight / contrib);
-
-				mul_m3_series(defMats[i], post, smat, pre, tmpmat);
-			}
-		}
-
-		/* always, check above code */
-		mul_m4_v3(postmat, co);
-
-		/* interpolate with previous modifier position using weight group */
-		if (prevCos) {
-			float mw = 1.0f - prevco_weight;
-			vertexCos[i][0] = prevco_weight * vertexCos[i][0] + mw * co[0];
-			vertexCos[i][1] = prevco_weight * vertexCos[i][1] + mw * co[1];
-			vertexCos[i][2] = prevco_weight * vertexCos[i][2] + mw * co[2];
-		}
+		/* vertices only touch their own output, all pose data is read-only here */
+		BLI_task_parallel_range(0, numVerts, &data2, armature_deform_coords_cb, numVerts > 1024);
 	}
 
 	if (dualquats)
@@ -1891,6 +1940,10 @@ void BKE_pose_rebuild(Object *ob, bArmature *arm)
 	ob->pose->flag |= POSE_WAS_REBUILT;
 
 	BKE_pose_channels_hash_make(ob->pose);
+
+	/* Channels may have been freed, resolved RNA paths into them are no
+	 * longer valid. */
+	BKE_animsys_rna_cache_invalidate();
 }
 
 /* ********************** THE POSE SOLVER ******************* */
@@ -2146,6 +2199,140 @@ void BKE_pose_where_is_bone(Scene *scene, Object *ob, bPoseChannel *pchan, float
 	BKE_pose_where_is_bone_tail(pchan);
 }
 
+/* Parallel evaluation of plain FK channels, see BKE_pose_where_is(). */
+
+typedef struct PoseChannelEvalBatch {
+	Scene *scene;
+	Object *ob;
+	float ctime;
+
+	/* Consecutive constraint-less channels, collected until the main loop
+	 * hits a channel with constraints or an IK tree. */
+	bPoseChannel **pending;
+	int totpending;
+
+	/* Scratch space for grouping the pending channels by hierarchy level,
+	 * exec_level points at the channels of the level being evaluated. */
+	bPoseChannel **exec;
+	bPoseChannel **exec_level;
+	int *level_len;
+	GHash *level_hash;
+} PoseChannelEvalBatch;
+
+static void pose_where_is_batch_cb(void *userdata, const int index)
+{
+	PoseChannelEvalBatch *batch = userdata;
+	BKE_pose_where_is_bone(batch->scene, batch->ob, batch->exec_level[index], batch->ctime, 1);
+}
+
+static void pose_where_is_flush_batch(PoseChannelEvalBatch *batch)
+{
+	int i, num_levels = 0, level_begin;
+
+	if (batch->totpending == 0) {
+		return;
+	}
+
+	/* Channels of the same hierarchy level only depend on channels of the
+	 * lower levels: the pending channels have no constraints so their only
+	 * dependency is the parent, which is guaranteed to come first in the
+	 * sorted channel list. Parents outside the batch are already evaluated.
+	 *
+	 * The hash stores level + 1 per channel, so a missing parent gives the
+	 * expected level zero.
+	 */
+	for (i = 0; i < batch->totpending; i++) {
+		bPoseChannel *pchan = batch->pending[i];
+		int level = 0;
+		if (pchan->parent != NULL) {
+			level = GET_INT_FROM_POINTER(BLI_ghash_lookup(batch->level_hash, pchan->parent));
+		}
+		BLI_ghash_insert(batch->level_hash, pchan, SET_INT_IN_POINTER(level + 1));
+		batch->level_len[level]++;
+		num_levels = MAX2(num_levels, level + 1);
+	}
+
+	/* Counting sort of the channels by level, turning the per-level counts
+	 * into end offsets along the way. */
+	level_begin = 0;
+	for (i = 0; i < num_levels; i++) {
+		const int len = batch->level_len[i];
+		batch->level_len[i] = level_begin;
+		level_begin += len;
+	}
+	for (i = 0; i < batch->totpending; i++) {
+		bPoseChannel *pchan = batch->pending[i];
+		const int level = GET_INT_FROM_POINTER(BLI_ghash_lookup(batch->level_hash, pchan)) - 1;
+		batch->exec[batch->level_len[level]++] = pchan;
+	}
+
+	/* Evaluate level by level, channels within a level from multiple threads. */
+	level_begin = 0;
+	for (i = 0; i < num_levels; i++) {
+		const int level_len = batch->level_len[i] - level_begin;
+		batch->exec_level = batch->exec + level_begin;
+		BLI_task_parallel_range(0, level_len, batch, pose_where_is_batch_cb, level_len > 64);
+		level_begin = batch->level_len[i];
+		batch->level_len[i] = 0;
+	}
+
+	batch->totpending = 0;
+	BLI_ghash_clear(batch->level_hash, NULL, NULL);
+}
+
+/* Threaded version of the main solver loop of BKE_pose_where_is(), used for
+ * the poses with many channels. Behaves like the serial loop, except that
+ * runs of channels without constraints are evaluated in parallel: channels
+ * with constraints can read any other channel and the sorted channel list
+ * encodes such dependencies only as ordering, so they act as barriers.
+ */
+static void pose_channels_where_is_parallel(Scene *scene, Object *ob, float ctime, int totchan)
+{
+	PoseChannelEvalBatch batch;
+	bPoseChannel *pchan;
+
+	batch.scene = scene;
+	batch.ob = ob;
+	batch.ctime = ctime;
+	batch.pending = MEM_mallocN(sizeof(bPoseChannel *) * totchan, "pose batch pending");
+	batch.exec = MEM_mallocN(sizeof(bPoseChannel *) * totchan, "pose batch exec");
+	batch.level_len = MEM_callocN(sizeof(int) * totchan, "pose batch level_len");
+	batch.level_hash = BLI_ghash_ptr_new_ex("pose batch level_hash", totchan);
+	batch.totpending = 0;
+
+	for (pchan = ob->pose->chanbase.first; pchan; pchan = pchan->next) {
+		/* if we find an IK root, we handle it separated */
+		if (pchan->flag & POSE_IKTREE) {
+			pose_where_is_flush_batch(&batch);
+			BIK_execute_tree(scene, ob, pchan, ctime);
+		}
+		/* if we find a Spline IK root, we handle it separated too */
+		else if (pchan->flag & POSE_IKSPLINE) {
+			pose_where_is_flush_batch(&batch);
+			BKE_splineik_execute_tree(scene, ob, pchan, ctime);
+		}
+		else if (pchan->flag & POSE_DONE) {
+			/* Already solved as a part of an IK tree. */
+		}
+		else if (pchan->constraints.first != NULL || (pchan->flag & POSE_CHAIN)) {
+			/* Constraint targets have to be complete and nothing may read
+			 * this channel concurrently, evaluate in the main thread. */
+			pose_where_is_flush_batch(&batch);
+			BKE_pose_where_is_bone(scene, ob, pchan, ctime, 1);
+		}
+		else {
+			/* Plain FK channel, only depends on its parent. */
+			batch.pending[batch.totpending++] = pchan;
+		}
+	}
+	pose_where_is_flush_batch(&batch);
+
+	MEM_freeN(batch.pending);
+	MEM_freeN(batch.exec);
+	MEM_freeN(batch.level_len);
+	BLI_ghash_free(batch.level_hash, NULL, NULL);
+}
+
 /* This only reads anim data from channels, and writes to channels */
 /* This is the only function adding poses */
 void BKE_pose_where_is(Scene *scene, Object *ob)
@@ -2155,6 +2342,7 @@ void BKE_pose_where_is(Scene *scene, Object *ob)
 	bPoseChannel *pchan;
 	float imat[4][4];
 	float ctime;
+	int totchan;
 
 	if (ob->type != OB_ARMATURE)
 		return;
@@ -2196,18 +2384,25 @@ void BKE_pose_where_is(Scene *scene, Object *ob)
 		BKE_pose_splineik_init_tree(scene, ob, ctime);
 
 		/* 3. the main loop, channels are already hierarchical sorted from root to children */
-		for (pchan = ob->pose->chanbase.first; pchan; pchan = pchan->next) {
-			/* 4a. if we find an IK root, we handle it separated */
-			if (pchan->flag & POSE_IKTREE) {
-				BIK_execute_tree(scene, ob, pchan, ctime);
-			}
-			/* 4b. if we find a Spline IK root, we handle it separated too */
-			else if (pchan->flag & POSE_IKSPLINE) {
-				BKE_splineik_execute_tree(scene, ob, pchan, ctime);
-			}
-			/* 5. otherwise just call the normal solver */
-			else if (!(pchan->flag & POSE_DONE)) {
-				BKE_pose_where_is_bone(scene, ob, pchan, ctime, 1);
+		totchan = BLI_listbase_count(&ob->pose->chanbase);
+		if (totchan > 256) {
+			/* 4-5. heavy rigs, evaluate independent channels from multiple threads */
+			pose_channels_where_is_parallel(scene, ob, ctime, totchan);
+		}
+		else {
+			for (pchan = ob->pose->chanbase.first; pchan; pchan = pchan->next) {
+				/* 4a. if we find an IK root, we handle it separated */
+				if (pchan->flag & POSE_IKTREE) {
+					BIK_execute_tree(scene, ob, pchan, ctime);
+				}
+				/* 4b. if we find a Spline IK root, we handle it separated too */
+				else if (pchan->flag & POSE_IKSPLINE) {
+					BKE_splineik_execute_tree(scene, ob, pchan, ctime);
+				}
+				/* 5. otherwise just call the normal solver */
+				else if (!(pchan->flag & POSE_DONE)) {
+					BKE_pose_where_is_bone(scene, ob, pchan, ctime, 1);
+				}
 			}
 		}
 		/* 6. release the IK tree */
@@ -38,7 +38,6 @@
 #include "DNA_object_force.h"
 #include "DNA_scene_types.h"
 
-#include "BLI_rand.h"
 #include "BLI_math.h"
 #include "BLI_blenlib.h"
 #include "BLI_kdtree.h"
@@ -53,6 +52,8 @@
 
 #include "RNA_enum_types.h"
 
+#include "atomic_ops.h"
+
 typedef struct BoidValues {
 	float max_speed, max_acc;
 	float max_ave, min_speed;
@@ -61,6 +62,19 @@ typedef struct BoidValues {
 
 static int apply_boid_rule(BoidBrainData *bbd, BoidRule *rule, BoidValues *val, ParticleData *pa, float fuzziness);
 
+/* Deterministic pseudo random value in [0, 1) for a particle and frame.
+ * Unlike drawing from a shared RNG stream this does not depend on the order the
+ * boids are evaluated in, so the rules can be applied to the particles in parallel.
+ */
+static float boid_frand(BoidBrainData *bbd, ParticleData *pa, int offset)
+{
+	ParticleSystem *psys = bbd->sim->psys;
+	const int p = (int)(pa - psys->particles);
+	const int rand = (int)(psys_frand(psys, psys->seed + p + offset) * 1000.0f);
+
+	return psys_frand(psys, (unsigned int)bbd->cfra + rand + offset);
+}
+
 static int rule_none(BoidRule *UNUSED(rule), BoidBrainData *UNUSED(data), BoidValues *UNUSED(val), ParticleData *UNUSED(pa))
 {
 	return 0;
@@ -243,9 +257,9 @@ static int rule_avoid_collision(BoidRule *rule, BoidBrainData *bbd, BoidValues *
 			if (dot_v3v3(col.pce.nor, pa->prev_state.ave) < -0.99f) {
 				/* don't know why, but uneven range [0.0, 1.0] */
 				/* works much better than even [-1.0, 1.0] */
-				bbd->wanted_co[0] = BLI_rng_get_float(bbd->rng);
-				bbd->wanted_co[1] = BLI_rng_get_float(bbd->rng);
-				bbd->wanted_co[2] = BLI_rng_get_float(bbd->rng);
+				bbd->wanted_co[0] = boid_frand(bbd, pa, 17);
+				bbd->wanted_co[1] = boid_frand(bbd, pa, 18);
+				bbd->wanted_co[2] = boid_frand(bbd, pa, 19);
 			}
 			else {
 				copy_v3_v3(bbd->wanted_co, col.pce.nor);
@@ -375,7 +389,9 @@ static int rule_separate(BoidRule *UNUSED(rule), BoidBrainData *bbd, BoidValues
 	int ret = 0;
 
 	if (neighbors > 1 && ptn[1].dist!=0.0f) {
-		sub_v3_v3v3(vec, pa->prev_state.co, bbd->sim->psys->particles[ptn[1].index].state.co);
+		/* like the other rules, only look at the previous state of the neighbor,
+		 * its current state may be half way through being updated */
+		sub_v3_v3v3(vec, pa->prev_state.co, bbd->sim->psys->particles[ptn[1].index].prev_state.co);
 		mul_v3_fl(vec, (2.0f * val->personal_space * pa->size - ptn[1].dist) / ptn[1].dist);
 		add_v3_v3(bbd->wanted_co, vec);
 		bbd->wanted_speed = val->max_speed;
@@ -577,9 +593,9 @@ static int rule_average_speed(BoidRule *rule, BoidBrainData *bbd, BoidValues *va
 
 	if (asbr->wander > 0.0f) {
 		/* abuse pa->r_ave for wandering */
-		bpa->wander[0] += asbr->wander * (-1.0f + 2.0f * BLI_rng_get_float(bbd->rng));
-		bpa->wander[1] += asbr->wander * (-1.0f + 2.0f * BLI_rng_get_float(bbd->rng));
-		bpa->wander[2] += asbr->wander * (-1.0f + 2.0f * BLI_rng_get_float(bbd->rng));
+		bpa->wander[0] += asbr->wander * (-1.0f + 2.0f * boid_frand(bbd, pa, 31));
+		bpa->wander[1] += asbr->wander * (-1.0f + 2.0f * boid_frand(bbd, pa, 32));
+		bpa->wander[2] += asbr->wander * (-1.0f + 2.0f * boid_frand(bbd, pa, 33));
 
 		normalize_v3(bpa->wander);
 
@@ -605,9 +621,9 @@ static int rule_average_speed(BoidRule *rule, BoidBrainData *bbd, BoidValues *va
 
 		/* may happen at birth */
 		if (dot_v2v2(bbd->wanted_co, bbd->wanted_co)==0.0f) {
-			bbd->wanted_co[0] = 2.0f*(0.5f - BLI_rng_get_float(bbd->rng));
-			bbd->wanted_co[1] = 2.0f*(0.5f - BLI_rng_get_float(bbd->rng));
-			bbd->wanted_co[2] = 2.0f*(0.5f - BLI_rng_get_float(bbd->rng));
+			bbd->wanted_co[0] = 2.0f*(0.5f - boid_frand(bbd, pa, 41));
+			bbd->wanted_co[1] = 2.0f*(0.5f - boid_frand(bbd, pa, 42));
+			bbd->wanted_co[2] = 2.0f*(0.5f - boid_frand(bbd, pa, 43));
 		}
 		
 		/* leveling */
@@ -686,7 +702,7 @@ static int rule_fight(BoidRule *rule, BoidBrainData *bbd, BoidValues *val, Parti
 
 		/* attack if in range */
 		if (closest_dist <= bbd->part->boids->range + pa->size + enemy_pa->size) {
-			float damage = BLI_rng_get_float(bbd->rng);
+			float damage = boid_frand(bbd, pa, 59);
 			float enemy_dir[3];
 
 			normalize_v3_v3(enemy_dir, bbd->wanted_co);
@@ -697,7 +713,9 @@ static int rule_fight(BoidRule *rule, BoidBrainData *bbd, BoidValues *val, Parti
 			/* must face enemy to fight */
 			if (dot_v3v3(pa->prev_state.ave, enemy_dir)>0.5f) {
 				bpa = enemy_pa->boid;
-				bpa->data.health -= bbd->part->boids->strength * bbd->timestep * ((1.0f-bbd->part->boids->accuracy)*damage + bbd->part->boids->accuracy);
+				/* several boids may attack the same enemy at once, so the damage is applied atomically */
+				atomic_add_fl(&bpa->data.health,
+				              -bbd->part->boids->strength * bbd->timestep * ((1.0f-bbd->part->boids->accuracy)*damage + bbd->part->boids->accuracy));
 			}
 		}
 		else {
@@ -1199,9 +1217,9 @@ void boid_body(BoidBrainData *bbd, ParticleData *pa)
 			/* choose random direction to turn if wanted velocity */
 			/* is directly behind regardless of z-coordinate */
 			if (dot_v2v2(old_dir2, wanted_dir2) < -0.99f) {
-				wanted_dir[0] = 2.0f*(0.5f - BLI_rng_get_float(bbd->rng));
-				wanted_dir[1] = 2.0f*(0.5f - BLI_rng_get_float(bbd->rng));
-				wanted_dir[2] = 2.0f*(0.5f - BLI_rng_get_float(bbd->rng));
+				wanted_dir[0] = 2.0f*(0.5f - boid_frand(bbd, pa, 73));
+				wanted_dir[1] = 2.0f*(0.5f - boid_frand(bbd, pa, 74));
+				wanted_dir[2] = 2.0f*(0.5f - boid_frand(bbd, pa, 75));
 				normalize_v3(wanted_dir);
 			}
 
@@ -1097,6 +1097,68 @@ BVHTree *bvhtree_from_mesh_looptri_ex(
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+
+/** \name Refit
+ *
+ * Re-bound the leaves of an existing tree against the current vertex
+ * coordinates and update the internal nodes bottom-up. Only valid while the
+ * topology the tree was built from is unchanged (armature or shape-key
+ * deformation), in which case it is much cheaper than a rebuild: no
+ * re-balancing, just new bounds.
+ *
+ * \{ */
+
+static int mesh_verts_refit_cb(void *userdata, int index, float r_co[4][3])
+{
+	const BVHTreeFromMesh *data = userdata;
+
+	copy_v3_v3(r_co[0], data->vert[index].co);
+	return 1;
+}
+
+static int mesh_edges_refit_cb(void *userdata, int index, float r_co[4][3])
+{
+	const BVHTreeFromMesh *data = userdata;
+	const MEdge *edge = &data->edge[index];
+
+	copy_v3_v3(r_co[0], data->vert[edge->v1].co);
+	copy_v3_v3(r_co[1], data->vert[edge->v2].co);
+	return 2;
+}
+
+static int mesh_looptri_refit_cb(void *userdata, int index, float r_co[4][3])
+{
+	const BVHTreeFromMesh *data = userdata;
+	const MLoopTri *lt = &data->looptri[index];
+
+	copy_v3_v3(r_co[0], data->vert[data->loop[lt->tri[0]].v].co);
+	copy_v3_v3(r_co[1], data->vert[data->loop[lt->tri[1]].v].co);
+	copy_v3_v3(r_co[2], data->vert[data->loop[lt->tri[2]].v].co);
+	return 3;
+}
+
+/* Refit a tree created by bvhtree_from_mesh_verts (data->vert may be
+ * repointed at deformed coordinates first). */
+void bvhtree_from_mesh_verts_refit(BVHTreeFromMesh *data)
+{
+	BLI_bvhtree_refit(data->tree, mesh_verts_refit_cb, data);
+}
+
+/* Refit a tree created by bvhtree_from_mesh_edges. */
+void bvhtree_from_mesh_edges_refit(BVHTreeFromMesh *data)
+{
+	BLI_bvhtree_refit(data->tree, mesh_edges_refit_cb, data);
+}
+
+/* Refit a tree created by bvhtree_from_mesh_looptri. */
+void bvhtree_from_mesh_looptri_refit(BVHTreeFromMesh *data)
+{
+	BLI_bvhtree_refit(data->tree, mesh_looptri_refit_cb, data);
+}
+
+/** \} */
+
 
 /* Frees data allocated by a call to bvhtree_from_editmesh_*. */
 void free_bvhtree_from_editmesh(struct BVHTreeFromEditMesh *data)
@@ -42,6 +42,7 @@
 
 #include "BKE_cdderivedmesh.h"
 #include "BKE_cloth.h"
+#include "BKE_collision.h"
 #include "BKE_effect.h"
 #include "BKE_global.h"
 #include "BKE_modifier.h"
@@ -541,8 +542,10 @@ void cloth_free_modifier(ClothModifierData *clmd )
 
 		if (cloth->edgeset)
 			BLI_edgeset_free(cloth->edgeset);
-		
-		
+
+		cloth_collision_cache_free(cloth->coll_cache);
+
+
 		/*
 		if (clmd->clothObject->facemarks)
 		MEM_freeN(clmd->clothObject->facemarks);
@@ -608,6 +611,7 @@ void cloth_free_modifier_extern(ClothModifierData *clmd )
 		if (cloth->edgeset)
 			BLI_edgeset_free(cloth->edgeset);
 
+		cloth_collision_cache_free(cloth->coll_cache);
 
 		/*
 		if (clmd->clothObject->facemarks)
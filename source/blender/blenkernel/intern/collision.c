@@ -44,6 +44,7 @@
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
 #include "BLI_edgehash.h"
+#include "BLI_task.h"
 
 #include "BKE_cloth.h"
 #include "BKE_effect.h"
@@ -604,18 +605,133 @@ void free_collider_cache(ListBase **colliders)
 }
 
 
+/* the near check goes through the task scheduler above this overlap count */
+#define CLOTH_COLLISION_THREADED_LIMIT 1024
+
+/* Persistent per-collider cache of broad phase results and narrow phase pair
+ * buffers, kept on the Cloth.  Consecutive substeps overlap nearly the same
+ * pairs, so keeping the arrays alive means the reallocations the old code did
+ * on every call almost never trigger.  Within one substep the collision rounds
+ * see the exact same trees (they are only refit between substeps), so the
+ * first round's overlap result is reused for the later rounds instead of
+ * descending both trees again. */
+typedef struct ClothCollObjCache {
+	struct ClothCollObjCache *next, *prev;
+	/* key: only ever compared, never dereferenced, so an entry surviving its
+	 * collider merely keeps some scratch buffers around */
+	const CollisionModifierData *collmd;
+	BVHTreeOverlap *overlap;
+	unsigned int overlap_num;
+	bool overlap_valid;	/* true while the current substep's rounds run */
+	CollPair *pairs;
+	unsigned int pairs_alloc;
+} ClothCollObjCache;
+
+typedef struct ClothCollisionCache {
+	ListBase objects;	/* ClothCollObjCache per collider */
+} ClothCollisionCache;
+
+static ClothCollObjCache *cloth_collision_cache_ensure(Cloth *cloth, const CollisionModifierData *collmd)
+{
+	ClothCollObjCache *entry;
+
+	if (cloth->coll_cache == NULL) {
+		cloth->coll_cache = MEM_callocN(sizeof(ClothCollisionCache), "ClothCollisionCache");
+	}
+
+	for (entry = cloth->coll_cache->objects.first; entry; entry = entry->next) {
+		if (entry->collmd == collmd) {
+			return entry;
+		}
+	}
+
+	entry = MEM_callocN(sizeof(ClothCollObjCache), "ClothCollObjCache");
+	entry->collmd = collmd;
+	BLI_addtail(&cloth->coll_cache->objects, entry);
+
+	return entry;
+}
+
+void cloth_collision_cache_free(ClothCollisionCache *cache)
+{
+	if (cache) {
+		ClothCollObjCache *entry;
+
+		for (entry = cache->objects.first; entry; entry = entry->next) {
+			if (entry->overlap)
+				MEM_freeN(entry->overlap);
+			if (entry->pairs)
+				MEM_freeN(entry->pairs);
+		}
+		BLI_freelistN(&cache->objects);
+		MEM_freeN(cache);
+	}
+}
+
+typedef struct ClothNearcheckTaskData {
+	ClothModifierData *clmd;
+	CollisionModifierData *collmd;
+	BVHTreeOverlap *overlap;
+	CollPair *pairs;	/* 4 slots per overlap, see cloth_collision */
+	unsigned char *pairs_num;	/* pairs each overlap produced */
+	float dt;
+} ClothNearcheckTaskData;
+
+static void cloth_nearcheck_task_cb(void *userdata, const int i)
+{
+	ClothNearcheckTaskData *data = userdata;
+	CollPair *start = &data->pairs[i * 4];
+	CollPair *end = cloth_collision((ModifierData *)data->clmd, (ModifierData *)data->collmd,
+	                                data->overlap + i, start, data->dt);
+
+	data->pairs_num[i] = (unsigned char)(end - start);
+}
+
 static void cloth_bvh_objcollisions_nearcheck ( ClothModifierData * clmd, CollisionModifierData *collmd,
-	CollPair **collisions, CollPair **collisions_index, int numresult, BVHTreeOverlap *overlap, double dt)
+	ClothCollObjCache *cache, CollPair **collisions_index, int numresult, BVHTreeOverlap *overlap, double dt)
 {
+	ClothNearcheckTaskData data;
+	unsigned char *pairs_num;
+	CollPair *pairs_end;
 	int i;
-	
-	*collisions = (CollPair *) MEM_mallocN(sizeof(CollPair) * numresult * 4, "collision array" ); // * 4 since cloth_collision_static can return more than 1 collision
-	*collisions_index = *collisions;
 
+	// * 4 since cloth_collision_static can return more than 1 collision
+	if (cache->pairs_alloc < (unsigned int)numresult * 4) {
+		if (cache->pairs)
+			MEM_freeN(cache->pairs);
+		cache->pairs = (CollPair *) MEM_mallocN(sizeof(CollPair) * numresult * 4, "collision array" );
+		cache->pairs_alloc = numresult * 4;
+	}
+
+	pairs_num = MEM_mallocN(sizeof(*pairs_num) * numresult, "collision pair counts");
+
+	/* the costly part is the nearest point solve per overlap, and every
+	 * overlap writes only into its own slots, so the checks run in parallel */
+	data.clmd = clmd;
+	data.collmd = collmd;
+	data.overlap = overlap;
+	data.pairs = cache->pairs;
+	data.pairs_num = pairs_num;
+	data.dt = dt;
+
+	BLI_task_parallel_range(0, numresult, &data, cloth_nearcheck_task_cb,
+	                        numresult > CLOTH_COLLISION_THREADED_LIMIT);
+
+	/* compact the per-overlap slots into a contiguous run, in overlap order,
+	 * so the result matches the old serial loop exactly */
+	pairs_end = cache->pairs;
 	for ( i = 0; i < numresult; i++ ) {
-		*collisions_index = cloth_collision((ModifierData *)clmd, (ModifierData *)collmd,
-		                                    overlap+i, *collisions_index, dt);
+		if (pairs_num[i]) {
+			if (pairs_end != &cache->pairs[i * 4]) {
+				memmove(pairs_end, &cache->pairs[i * 4], sizeof(CollPair) * pairs_num[i]);
+			}
+			pairs_end += pairs_num[i];
+		}
 	}
+
+	MEM_freeN(pairs_num);
+
+	*collisions_index = pairs_end;
 }
 
 static int cloth_bvh_objcollisions_resolve ( ClothModifierData * clmd, CollisionModifierData *collmd, CollPair *collisions, CollPair *collisions_index)
@@ -704,49 +820,50 @@ int cloth_bvh_objcollision(Object *ob, ClothModifierData *clmd, float step, floa
 		collision_move_object ( collmd, step + dt, step );
 	}
 
+	/* both trees were refit above, the last substep's broad phase results are stale */
+	if (cloth->coll_cache) {
+		ClothCollObjCache *cache;
+		for (cache = cloth->coll_cache->objects.first; cache; cache = cache->next) {
+			cache->overlap_valid = false;
+		}
+	}
+
 	do {
-		CollPair **collisions, **collisions_index;
-		
 		ret2 = 0;
 
-		collisions = MEM_callocN(sizeof(CollPair *) *numcollobj, "CollPair");
-		collisions_index = MEM_callocN(sizeof(CollPair *) *numcollobj, "CollPair");
-		
 		// check all collision objects
 		for (i = 0; i < numcollobj; i++) {
 			Object *collob= collobjs[i];
 			CollisionModifierData *collmd = (CollisionModifierData *)modifiers_findByType(collob, eModifierType_Collision);
-			BVHTreeOverlap *overlap = NULL;
-			unsigned int result = 0;
+			ClothCollObjCache *cache;
+			CollPair *collisions_index;
 			
 			if (!collmd->bvhtree)
 				continue;
 			
-			/* search for overlapping collision pairs */
-			overlap = BLI_bvhtree_overlap(cloth_bvh, collmd->bvhtree, &result, NULL, NULL);
+			cache = cloth_collision_cache_ensure(cloth, collmd);
+
+			/* search for overlapping collision pairs; the trees don't change
+			 * between rounds, so only the first round of a substep descends them */
+			if (!cache->overlap_valid) {
+				if ( cache->overlap )
+					MEM_freeN ( cache->overlap );
+				cache->overlap = BLI_bvhtree_overlap(cloth_bvh, collmd->bvhtree, &cache->overlap_num, NULL, NULL);
+				cache->overlap_valid = true;
+			}
 				
 			// go to next object if no overlap is there
-			if ( result && overlap ) {
+			if ( cache->overlap_num && cache->overlap ) {
 				/* check if collisions really happen (costly near check) */
-				cloth_bvh_objcollisions_nearcheck ( clmd, collmd, &collisions[i], 
-					&collisions_index[i], result, overlap, dt/(float)clmd->coll_parms->loop_count);
+				cloth_bvh_objcollisions_nearcheck ( clmd, collmd, cache,
+					&collisions_index, cache->overlap_num, cache->overlap, dt/(float)clmd->coll_parms->loop_count);
 			
 				// resolve nearby collisions
-				ret += cloth_bvh_objcollisions_resolve ( clmd, collmd, collisions[i],  collisions_index[i]);
+				ret += cloth_bvh_objcollisions_resolve ( clmd, collmd, cache->pairs, collisions_index);
 				ret2 += ret;
 			}
-
-			if ( overlap )
-				MEM_freeN ( overlap );
 		}
 		rounds++;
-		
-		for (i = 0; i < numcollobj; i++) {
-			if ( collisions[i] ) MEM_freeN ( collisions[i] );
-		}
-			
-		MEM_freeN(collisions);
-		MEM_freeN(collisions_index);
 
 		////////////////////////////////////////////////////////////
 		// update positions
@@ -40,6 +40,7 @@
 
 #include "BLI_utildefines.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "BKE_crazyspace.h"
 #include "BKE_DerivedMesh.h"
@@ -362,6 +363,21 @@ int BKE_sculpt_get_first_deform_matrices(Scene *scene, Object *ob, float (**defo
 	return numleft;
 }
 
+typedef struct CrazyspaceVertexMatsData {
+	float (*deformmats)[3][3];
+	float (*quats)[4];
+} CrazyspaceVertexMatsData;
+
+static void crazyspace_vertex_mats_task_cb(void *userdata, const int i)
+{
+	CrazyspaceVertexMatsData *data = userdata;
+	float qmat[3][3], tmat[3][3];
+
+	quat_to_mat3(qmat, data->quats[i]);
+	mul_m3_m3m3(tmat, qmat, data->deformmats[i]);
+	copy_m3_m3(data->deformmats[i], tmat);
+}
+
 void BKE_crazyspace_build_sculpt(Scene *scene, Object *ob, float (**deformmats)[3][3], float (**deformcos)[3])
 {
 	int totleft = BKE_sculpt_get_first_deform_matrices(scene, ob, deformmats, deformcos);
@@ -373,7 +389,8 @@ void BKE_crazyspace_build_sculpt(Scene *scene, Object *ob, float (**deformmats)[
 		float (*deformedVerts)[3] = *deformcos;
 		float (*origVerts)[3] = MEM_dupallocN(deformedVerts);
 		float (*quats)[4];
-		int i, deformed = 0;
+		CrazyspaceVertexMatsData data;
+		int deformed = 0;
 		VirtualModifierData virtualModifierData;
 		ModifierData *md = modifiers_getVirtualModifierList(ob, &virtualModifierData);
 		Mesh *me = (Mesh *)ob->data;
@@ -398,13 +415,10 @@ void BKE_crazyspace_build_sculpt(Scene *scene, Object *ob, float (**deformmats)[
 
 		BKE_crazyspace_set_quats_mesh(me, origVerts, deformedVerts, quats);
 
-		for (i = 0; i < me->totvert; i++) {
-			float qmat[3][3], tmat[3][3];
-
-			quat_to_mat3(qmat, quats[i]);
-			mul_m3_m3m3(tmat, qmat, (*deformmats)[i]);
-			copy_m3_m3((*deformmats)[i], tmat);
-		}
+		data.deformmats = *deformmats;
+		data.quats = quats;
+		BLI_task_parallel_range(0, me->totvert, &data, crazyspace_vertex_mats_task_cb,
+		                        (me->totvert > 10000));
 
 		MEM_freeN(origVerts);
 		MEM_freeN(quats);
@@ -40,6 +40,7 @@
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
 #include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
 
 #include "DNA_curve_types.h"
 #include "DNA_material_types.h"
@@ -2596,6 +2597,54 @@ static void bevlist_firstlast_direction_calc_from_bpoint(Nurb *nu, BevList *bl)
 	}
 }
 
+/* true when the spline will add a BevList (matches the branches of STEP 1 below) */
+static bool curve_bevelList_nurb_makes_list(Nurb *nu)
+{
+	return !(BKE_nurb_check_valid_u(nu) && (nu->type == CU_NURBS) && (nu->pntsv != 1));
+}
+
+/* key over everything BKE_curve_bevelList_make reads from the spline,
+ * matching keys give matching bevel lists so they can be re-used */
+static unsigned int curve_bevelList_nurb_hash(Curve *cu, Nurb *nu, const bool for_render)
+{
+	BLI_HashMurmur2A mm2;
+
+	BLI_hash_mm2a_init(&mm2, 0);
+
+	/* object level settings, they influence every spline */
+	BLI_hash_mm2a_add_int(&mm2, cu->flag);
+	BLI_hash_mm2a_add_int(&mm2, cu->twist_mode);
+	BLI_hash_mm2a_add(&mm2, (const unsigned char *)&cu->twist_smooth, sizeof(float));
+	BLI_hash_mm2a_add_int(&mm2, cu->bevfac1_mapping);
+	BLI_hash_mm2a_add_int(&mm2, cu->bevfac2_mapping);
+	/* the radius use depends on these being set, not on their values */
+	BLI_hash_mm2a_add_int(&mm2, (cu->bevobj != NULL));
+	BLI_hash_mm2a_add_int(&mm2, (cu->ext1 != 0.0f || cu->ext2 != 0.0f));
+
+	BLI_hash_mm2a_add_int(&mm2, nu->type);
+	BLI_hash_mm2a_add_int(&mm2, nu->flag);
+	BLI_hash_mm2a_add_int(&mm2, nu->flagu);
+	BLI_hash_mm2a_add_int(&mm2, nu->pntsu);
+	BLI_hash_mm2a_add_int(&mm2, nu->pntsv);
+	BLI_hash_mm2a_add_int(&mm2, nu->orderu);
+	BLI_hash_mm2a_add_int(&mm2, nu->charidx);
+	BLI_hash_mm2a_add_int(&mm2, (for_render && cu->resolu_ren != 0) ? cu->resolu_ren : nu->resolu);
+
+	if (nu->type == CU_BEZIER) {
+		if (nu->bezt)
+			BLI_hash_mm2a_add(&mm2, (const unsigned char *)nu->bezt, sizeof(BezTriple) * nu->pntsu);
+	}
+	else if (nu->bp) {
+		BLI_hash_mm2a_add(&mm2, (const unsigned char *)nu->bp, sizeof(BPoint) * nu->pntsu * nu->pntsv);
+	}
+
+	if ((nu->type == CU_NURBS) && nu->knotsu) {
+		BLI_hash_mm2a_add(&mm2, (const unsigned char *)nu->knotsu, sizeof(float) * KNOTSU(nu));
+	}
+
+	return BLI_hash_mm2a_end(&mm2);
+}
+
 void BKE_curve_bevelList_free(ListBase *bev)
 {
 	BevList *bl, *blnext;
@@ -2637,6 +2686,7 @@ void BKE_curve_bevelList_make(Object *ob, ListBase *nurbs, bool for_render)
 	int *segbevcount;
 	bool do_tilt, do_radius, do_weight;
 	bool is_editmode = false;
+	unsigned int nu_hash;
 	ListBase *bev;
 
 	/* segbevcount alsp requires seglen. */
@@ -2652,17 +2702,40 @@ void BKE_curve_bevelList_make(Object *ob, ListBase *nurbs, bool for_render)
 
 	/* STEP 1: MAKE POLYS  */
 
-	BKE_curve_bevelList_free(&ob->curve_cache->bev);
-	nu = nurbs->first;
 	if (cu->editnurb && ob->type != OB_FONT) {
 		is_editmode = 1;
 	}
 
+	/* when every spline still hashes to the key stored in the previous bevel list
+	 * nothing that influences the evaluated points has changed, and the old list
+	 * can be kept as is (typical when only a bevel or taper object triggered the
+	 * displist rebuild of this curve) */
+	if (bev->first != NULL) {
+		bl = bev->first;
+		for (nu = nurbs->first; nu; nu = nu->next) {
+			if (nu->hide && is_editmode)
+				continue;
+			if (!curve_bevelList_nurb_makes_list(nu))
+				continue;
+			if (bl == NULL || bl->hash != curve_bevelList_nurb_hash(cu, nu, for_render))
+				break;
+			bl = bl->next;
+		}
+		if (nu == NULL && bl == NULL) {
+			return;
+		}
+	}
+
+	BKE_curve_bevelList_free(&ob->curve_cache->bev);
+	nu = nurbs->first;
+
 	for (; nu; nu = nu->next) {
-		
+
 		if (nu->hide && is_editmode)
 			continue;
-		
+
+		nu_hash = curve_bevelList_nurb_hash(cu, nu, for_render);
+
 		/* check if we will calculate tilt data */
 		do_tilt = CU_DO_TILT(cu, nu);
 		do_radius = CU_DO_RADIUS(cu, nu); /* normal display uses the radius, better just to calculate them */
@@ -2675,6 +2748,7 @@ void BKE_curve_bevelList_make(Object *ob, ListBase *nurbs, bool for_render)
 			BLI_addtail(bev, bl);
 			bl->nr = 0;
 			bl->charidx = nu->charidx;
+			bl->hash = nu_hash;
 		}
 		else {
 			BevPoint *bevp;
@@ -2699,6 +2773,7 @@ void BKE_curve_bevelList_make(Object *ob, ListBase *nurbs, bool for_render)
 				bl->nr = len;
 				bl->dupe_nr = 0;
 				bl->charidx = nu->charidx;
+				bl->hash = nu_hash;
 				bevp = bl->bevpoints;
 				bevp->offset = 0;
 				bp = nu->bp;
@@ -2743,6 +2818,7 @@ void BKE_curve_bevelList_make(Object *ob, ListBase *nurbs, bool for_render)
 
 				bl->poly = (nu->flagu & CU_NURB_CYCLIC) ? 0 : -1;
 				bl->charidx = nu->charidx;
+				bl->hash = nu_hash;
 
 				bevp = bl->bevpoints;
 				seglen = bl->seglen;
@@ -2880,6 +2956,7 @@ void BKE_curve_bevelList_make(Object *ob, ListBase *nurbs, bool for_render)
 					bl->dupe_nr = 0;
 					bl->poly = (nu->flagu & CU_NURB_CYCLIC) ? 0 : -1;
 					bl->charidx = nu->charidx;
+					bl->hash = nu_hash;
 
 					bevp = bl->bevpoints;
 					seglen = bl->seglen;
@@ -2333,6 +2333,116 @@ void CustomData_interp(const CustomData *source, CustomData *dest,
 	if (count > SOURCE_BUF_SIZE) MEM_freeN((void *)sources);
 }
 
+/* Pre-compiled layer pair plans, see BKE_customdata.h for the rationale. */
+
+typedef struct CustomDataLayerPlanEntry {
+	const void *src_data;
+	void *dst_data;
+	size_t size;
+	cd_copy copy;
+	cd_interp interp;
+} CustomDataLayerPlanEntry;
+
+struct CustomDataLayerPlan {
+	CustomDataLayerPlanEntry *entries;
+	int totentry;
+};
+
+CustomDataLayerPlan *CustomData_layer_plan_create(const CustomData *source, CustomData *dest)
+{
+	CustomDataLayerPlan *plan = MEM_callocN(sizeof(*plan), __func__);
+	int src_i, dest_i;
+
+	plan->entries = MEM_mallocN(sizeof(*plan->entries) * (size_t)source->totlayer, __func__);
+
+	/* same layer matching logic as CustomData_copy_data, run once instead of per element */
+	dest_i = 0;
+	for (src_i = 0; src_i < source->totlayer; ++src_i) {
+		while (dest_i < dest->totlayer && dest->layers[dest_i].type < source->layers[src_i].type) {
+			dest_i++;
+		}
+
+		if (dest_i >= dest->totlayer) break;
+
+		if (dest->layers[dest_i].type == source->layers[src_i].type) {
+			const void *src_data = source->layers[src_i].data;
+			void *dst_data = dest->layers[dest_i].data;
+
+			if (src_data && dst_data) {
+				const LayerTypeInfo *typeInfo = layerType_getInfo(source->layers[src_i].type);
+				CustomDataLayerPlanEntry *entry = &plan->entries[plan->totentry++];
+
+				entry->src_data = src_data;
+				entry->dst_data = dst_data;
+				entry->size = (size_t)typeInfo->size;
+				entry->copy = typeInfo->copy;
+				entry->interp = typeInfo->interp;
+			}
+
+			dest_i++;
+		}
+	}
+
+	return plan;
+}
+
+void CustomData_layer_plan_copy_data(
+        const CustomDataLayerPlan *plan,
+        int source_index, int dest_index, int count)
+{
+	const CustomDataLayerPlanEntry *entry = plan->entries;
+	int i;
+
+	for (i = 0; i < plan->totentry; ++i, ++entry) {
+		if (entry->copy) {
+			entry->copy(POINTER_OFFSET(entry->src_data, (size_t)source_index * entry->size),
+			            POINTER_OFFSET(entry->dst_data, (size_t)dest_index * entry->size),
+			            count);
+		}
+		else {
+			memcpy(POINTER_OFFSET(entry->dst_data, (size_t)dest_index * entry->size),
+			       POINTER_OFFSET(entry->src_data, (size_t)source_index * entry->size),
+			       (size_t)count * entry->size);
+		}
+	}
+}
+
+void CustomData_layer_plan_interp(
+        const CustomDataLayerPlan *plan,
+        const int *src_indices, const float *weights, const float *sub_weights,
+        int count, int dest_index)
+{
+	const CustomDataLayerPlanEntry *entry = plan->entries;
+	const void *source_buf[SOURCE_BUF_SIZE];
+	const void **sources = source_buf;
+	int i, j;
+
+	/* slow fallback in case we're interpolating a ridiculous number of
+	 * elements
+	 */
+	if (count > SOURCE_BUF_SIZE)
+		sources = MEM_mallocN(sizeof(*sources) * (size_t)count, __func__);
+
+	for (i = 0; i < plan->totentry; ++i, ++entry) {
+		if (!entry->interp) continue;
+
+		for (j = 0; j < count; ++j) {
+			sources[j] = POINTER_OFFSET(entry->src_data, (size_t)src_indices[j] * entry->size);
+		}
+
+		entry->interp(sources, weights, sub_weights, count,
+		              POINTER_OFFSET(entry->dst_data, (size_t)dest_index * entry->size));
+	}
+
+	if (count > SOURCE_BUF_SIZE) MEM_freeN((void *)sources);
+}
+
+void CustomData_layer_plan_free(CustomDataLayerPlan *plan)
+{
+	MEM_freeN(plan->entries);
+	MEM_freeN(plan);
+}
+
 /**
  * Swap data inside each item, for all layers.
  * This only applies to item types that may store several sub-item data (e.g. corner data [UVs, VCol, ...] of
@@ -1708,6 +1708,9 @@ static void dag_scene_build(Main *bmain, Scene *sce)
 /* clear all dependency graphs */
 void DAG_relations_tag_update(Main *bmain)
 {
+	/* Structural changes may leave pointers in the resolved RNA path
+	 * caches dangling. */
+	BKE_animsys_rna_cache_invalidate();
 	if (DEG_depsgraph_use_legacy()) {
 		Scene *sce;
 		for (sce = bmain->scene.first; sce; sce = sce->id.next) {
@@ -2955,6 +2958,9 @@ void DAG_id_tag_update_ex(Main *bmain, ID *id, short flag)
 		return;
 	}
 
+	/* edits can move instanced objects around, drop cached dupli lists */
+	object_dupli_cache_invalidate();
+
 	if (id == NULL) return;
 
 	if (G.debug & G_DEBUG_DEPSGRAPH) {
@@ -3585,6 +3591,9 @@ void DAG_editors_update_pre(Main *bmain, Scene *scene, bool time)
 /* Tag all relations for update. */
 void DAG_relations_tag_update(Main *bmain)
 {
+	/* Structural changes may leave pointers in the resolved RNA path
+	 * caches dangling. */
+	BKE_animsys_rna_cache_invalidate();
 	DEG_relations_tag_update(bmain);
 }
 
@@ -45,6 +45,7 @@
 #include "BLI_memarena.h"
 #include "BLI_math.h"
 #include "BLI_scanfill.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_global.h"
@@ -1362,6 +1363,73 @@ static void fillBevelCap(Nurb *nu, DispList *dlb, float *prev_fp, ListBase *disp
 	BLI_addtail(dispbase, dl);
 }
 
+typedef struct BevelTessData {
+	Scene *scene;
+	Curve *cu;
+	BevList *bl;
+	DispList *dlb;
+	float *verts;
+	int start, steps;
+	float firstblend, lastblend, widfac;
+} BevelTessData;
+
+/* one bevel cross-section, writes only its own slice of the verts array so the
+ * sections of a spline can be done in parallel */
+static void curve_bevel_tess_cb(void *userdata, const int a)
+{
+	BevelTessData *btd = userdata;
+	Curve *cu = btd->cu;
+	BevList *bl = btd->bl;
+	DispList *dlb = btd->dlb;
+	BevPoint *bevp_first =  bl->bevpoints;
+	BevPoint *bevp_last  = &bl->bevpoints[bl->nr - 1];
+	BevPoint *bevp       = &bl->bevpoints[btd->start + a];
+	const int i = btd->start + a;
+	const int steps = btd->steps;
+	float *data = btd->verts + 3 * dlb->nr * a;
+	float fac = 1.0f;
+
+	if (cu->taperobj == NULL) {
+		fac = bevp->radius;
+	}
+	else {
+		float len, taper_fac;
+
+		if (cu->flag & CU_MAP_TAPER) {
+			len = (steps - 3) + btd->firstblend + btd->lastblend;
+
+			if (a == 0)
+				taper_fac = 0.0f;
+			else if (a == steps - 1)
+				taper_fac = 1.0f;
+			else
+				taper_fac = ((float) a - (1.0f - btd->firstblend)) / len;
+		}
+		else {
+			len = bl->nr - 1;
+			taper_fac = (float) i / len;
+
+			if (a == 0)
+				taper_fac += (1.0f - btd->firstblend) / len;
+			else if (a == steps - 1)
+				taper_fac -= (1.0f - btd->lastblend) / len;
+		}
+
+		fac = displist_calc_taper(btd->scene, cu->taperobj, taper_fac);
+	}
+
+	/* rotate bevel piece and write in data */
+	if ((a == 0) && (bevp != bevp_last)) {
+		rotateBevelPiece(cu, bevp, bevp + 1, dlb, 1.0f - btd->firstblend, btd->widfac, fac, &data);
+	}
+	else if ((a == steps - 1) && (bevp != bevp_first)) {
+		rotateBevelPiece(cu, bevp, bevp - 1, dlb, 1.0f - btd->lastblend, btd->widfac, fac, &data);
+	}
+	else {
+		rotateBevelPiece(cu, bevp, NULL, dlb, 0.0f, btd->widfac, fac, &data);
+	}
+}
+
 static void calc_bevfac_segment_mapping(BevList *bl, float bevfac, float spline_length, int *r_bev, float *r_blend)
 {
 	float normlen, normsum = 0.0f;
@@ -1519,7 +1587,7 @@ static void do_makeDispListCurveTypes(Scene *scene, Object *ob, ListBase *dispba
 		ListBase dlbev;
 		ListBase nubase = {NULL, NULL};
 
-		BKE_curve_bevelList_free(&ob->curve_cache->bev);
+		/* bevel lists are freed (or re-used) by BKE_curve_bevelList_make */
 
 		/* We only re-evaluate path if evaluation is not happening for orco.
 		 * If the calculation happens for orco, we should never free data which
@@ -1600,7 +1668,7 @@ static void do_makeDispListCurveTypes(Scene *scene, Object *ob, ListBase *dispba
 						float bottom_no[3] = {0.0f};
 						float top_no[3] = {0.0f};
 						float firstblend = 0.0f, lastblend = 0.0f;
-						int i, start, steps = 0;
+						int start, steps = 0;
 
 						if (nu->flagu & CU_NURB_CYCLIC) {
 							calc_bevfac_mapping_default(bl,
@@ -1615,7 +1683,6 @@ static void do_makeDispListCurveTypes(Scene *scene, Object *ob, ListBase *dispba
 						}
 
 						for (dlb = dlbev.first; dlb; dlb = dlb->next) {
-							BevPoint *bevp_first, *bevp_last;
 							BevPoint *bevp;
 
 							/* for each part of the bevel use a separate displblock */
@@ -1645,68 +1712,50 @@ static void do_makeDispListCurveTypes(Scene *scene, Object *ob, ListBase *dispba
 							dl->bevelSplitFlag = MEM_callocN(sizeof(*dl->bevelSplitFlag) * ((steps + 0x1F) >> 5),
 							                                 "bevelSplitFlag");
 
-							/* for each point of poly make a bevel piece */
-							bevp_first =  bl->bevpoints;
-							bevp_last  = &bl->bevpoints[bl->nr - 1];
-							bevp       = &bl->bevpoints[start];
-							for (i = start, a = 0; a < steps; i++, bevp++, a++) {
-								float fac = 1.0;
-								float *cur_data = data;
+							/* for each point of poly make a bevel piece,
+							 * every piece only writes its own slice of verts */
+							{
+								BevelTessData btd;
+								bool use_threading;
 
-								if (cu->taperobj == NULL) {
-									fac = bevp->radius;
-								}
-								else {
-									float len, taper_fac;
-
-									if (cu->flag & CU_MAP_TAPER) {
-										len = (steps - 3) + firstblend + lastblend;
-
-										if (a == 0)
-											taper_fac = 0.0f;
-										else if (a == steps - 1)
-											taper_fac = 1.0f;
-										else
-											taper_fac = ((float) a - (1.0f - firstblend)) / len;
-									}
-									else {
-										len = bl->nr - 1;
-										taper_fac = (float) i / len;
-
-										if (a == 0)
-											taper_fac += (1.0f - firstblend) / len;
-										else if (a == steps - 1)
-											taper_fac -= (1.0f - lastblend) / len;
-									}
-
-									fac = displist_calc_taper(scene, cu->taperobj, taper_fac);
+								/* make sure the taper displist exists before going
+								 * wide, displist_calc_taper builds it on first use */
+								if (cu->taperobj) {
+									displist_calc_taper(scene, cu->taperobj, 0.0f);
 								}
+								use_threading = ((steps * dlb->nr) > 1024) &&
+								                (cu->taperobj == NULL ||
+								                 (cu->taperobj->curve_cache &&
+								                  cu->taperobj->curve_cache->disp.first));
+
+								btd.scene = scene;
+								btd.cu = cu;
+								btd.bl = bl;
+								btd.dlb = dlb;
+								btd.verts = data;
+								btd.start = start;
+								btd.steps = steps;
+								btd.firstblend = firstblend;
+								btd.lastblend = lastblend;
+								btd.widfac = widfac;
+
+								BLI_task_parallel_range(0, steps, &btd, curve_bevel_tess_cb, use_threading);
+							}
 
+							bevp = &bl->bevpoints[start];
+							for (a = 0; a < steps; bevp++, a++) {
 								if (bevp->split_tag) {
 									dl->bevelSplitFlag[a >> 5] |= 1 << (a & 0x1F);
 								}
+							}
 
-								/* rotate bevel piece and write in data */
-								if ((a == 0) && (bevp != bevp_last)) {
-									rotateBevelPiece(cu, bevp, bevp + 1, dlb, 1.0f - firstblend, widfac, fac, &data);
-								}
-								else if ((a == steps - 1) && (bevp != bevp_first) ) {
-									rotateBevelPiece(cu, bevp, bevp - 1, dlb, 1.0f - lastblend, widfac, fac, &data);
-								}
-								else {
-									rotateBevelPiece(cu, bevp, NULL, dlb, 0.0f, widfac, fac, &data);
-								}
-
-								if (cu->bevobj && (cu->flag & CU_FILL_CAPS) && !(nu->flagu & CU_NURB_CYCLIC)) {
-									if (a == 1) {
-										fillBevelCap(nu, dlb, cur_data - 3 * dlb->nr, &bottom_capbase);
-										negate_v3_v3(bottom_no, bevp->dir);
-									}
-									if (a == steps - 1) {
-										fillBevelCap(nu, dlb, cur_data, &top_capbase);
-										copy_v3_v3(top_no, bevp->dir);
-									}
+							if (cu->bevobj && (cu->flag & CU_FILL_CAPS) && !(nu->flagu & CU_NURB_CYCLIC) && steps) {
+								if (steps > 1) {
+									fillBevelCap(nu, dlb, data, &bottom_capbase);
+									negate_v3_v3(bottom_no, bl->bevpoints[start + 1].dir);
 								}
+								fillBevelCap(nu, dlb, data + 3 * dlb->nr * (steps - 1), &top_capbase);
+								copy_v3_v3(top_no, bl->bevpoints[start + steps - 1].dir);
 							}
 
 							/* gl array drawing: using indices */
@@ -1754,6 +1803,7 @@ static void do_makeDispListCurveTypes(Scene *scene, Object *ob, ListBase *dispba
 void BKE_displist_make_curveTypes(Scene *scene, Object *ob, const bool for_orco)
 {
 	ListBase *dispbase;
+	ListBase bev_cache = {NULL, NULL};
 
 	/* The same check for duplis as in do_makeDispListCurveTypes.
 	 * Happens when curve used for constraint/bevel was converted to mesh.
@@ -1761,11 +1811,19 @@ void BKE_displist_make_curveTypes(Scene *scene, Object *ob, const bool for_orco)
 	if (!ELEM(ob->type, OB_SURF, OB_CURVE, OB_FONT))
 		return;
 
+	/* keep the evaluated bevel lists over the cache free, BKE_curve_bevelList_make
+	 * re-uses them when the splines they were built from are unchanged */
+	if (ob->curve_cache) {
+		bev_cache = ob->curve_cache->bev;
+		BLI_listbase_clear(&ob->curve_cache->bev);
+	}
+
 	BKE_object_free_derived_caches(ob);
 
 	if (!ob->curve_cache) {
 		ob->curve_cache = MEM_callocN(sizeof(CurveCache), "CurveCache for curve types");
 	}
+	ob->curve_cache->bev = bev_cache;
 
 	dispbase = &(ob->curve_cache->disp);
 
@@ -191,6 +191,12 @@ typedef struct PaintBakeData {
 	float prev_obmat[4][4]; /* previous frame object matrix */
 	int clear;              /* flag to check if surface was cleared/reset -> have to redo velocity etc. */
 
+	/* persistent scratch buffers, allocated on first use and re-used between
+	 * steps/frames to avoid repeated allocations (sizes depend on total_points only) */
+	void *prev_points;      /* previous point state copy for wave and effect steps */
+	float *force;           /* effect force vectors, 3 float dir + 1 float strength per point */
+	int *brush_points;      /* flattened point indices of grid cells hit by current brush */
+
 } PaintBakeData;
 
 /* UV Image sequence format point	*/
@@ -829,6 +835,12 @@ static void free_bakeData(PaintSurfaceData *data)
 			MEM_freeN(bData->velocity);
 		if (bData->prev_velocity)
 			MEM_freeN(bData->prev_velocity);
+		if (bData->prev_points)
+			MEM_freeN(bData->prev_points);
+		if (bData->force)
+			MEM_freeN(bData->force);
+		if (bData->brush_points)
+			MEM_freeN(bData->brush_points);
 
 		MEM_freeN(data->bData);
 		data->bData = NULL;
@@ -3204,11 +3216,16 @@ static int dynamicPaint_paintMesh(DynamicPaintSurface *surface,
 			if (bvhtree_from_mesh_looptri(&treeData, dm, 0.0f, 4, 8)) {
 				int c_index;
 				int total_cells = grid->dim[0] * grid->dim[1] * grid->dim[2];
+				int tot_points = 0;
 
-				/* loop through space partitioning grid */
-				for (c_index = 0; c_index < total_cells; c_index++) {
-					int id;
+				/* Gather the points of every grid cell that intersects the brush
+				 * bounds, so the brush pass below runs as one parallel loop over
+				 * all affected points instead of syncing threads between every
+				 * single cell. Points of a cell are consecutive in t_index. */
+				if (!bData->brush_points)
+					bData->brush_points = MEM_mallocN(sData->total_points * sizeof(int), "Dynamic Paint brush points");
 
+				for (c_index = 0; c_index < total_cells; c_index++) {
 					/* check grid cell bounding box */
 					if (!grid->s_num[c_index] ||
 					    !meshBrush_boundsIntersect(&grid->bounds[c_index], &mesh_bb, brush, brush_radius))
@@ -3216,10 +3233,18 @@ static int dynamicPaint_paintMesh(DynamicPaintSurface *surface,
 						continue;
 					}
 
-					/* loop through cell points and process brush */
+					memcpy(&bData->brush_points[tot_points], &grid->t_index[grid->s_pos[c_index]],
+					       grid->s_num[c_index] * sizeof(int));
+					tot_points += grid->s_num[c_index];
+				}
+
+				{
+					int id;
+
+					/* process brush for all gathered points */
 #pragma omp parallel for schedule(static)
-					for (id = 0; id < grid->s_num[c_index]; id++) {
-						int index = grid->t_index[grid->s_pos[c_index] + id];
+					for (id = 0; id < tot_points; id++) {
+						int index = bData->brush_points[id];
 						int ss, samples = bData->s_num[index];
 						float total_sample = (float)samples;
 						float brushStrength = 0.0f; /* brush influence factor */
@@ -4135,8 +4160,10 @@ static int dynamicPaint_prepareEffectStep(
 		float vel[3] = {0};
 		ListBase *effectors = pdInitEffectors(scene, ob, NULL, surface->effector_weights, true);
 
-		/* allocate memory for force data (dir vector + strength) */
-		*force = MEM_mallocN(sData->total_points * 4 * sizeof(float), "PaintEffectForces");
+		/* force data (dir vector + strength), kept on bake data between frames */
+		if (!bData->force)
+			bData->force = MEM_mallocN(sData->total_points * 4 * sizeof(float), "PaintEffectForces");
+		*force = bData->force;
 
 		if (*force) {
 #pragma omp parallel for schedule(static)
@@ -4394,8 +4421,12 @@ static void dynamicPaint_doWaveStep(DynamicPaintSurface *surface, float timescal
 	const float canvas_size = getSurfaceDimension(sData);
 	float wave_scale = CANVAS_REL_SIZE / canvas_size;
 
-	/* allocate memory */
-	PaintWavePoint *prevPoint = MEM_mallocN(sData->total_points * sizeof(PaintWavePoint), "Temp previous points for wave simulation");
+	PaintWavePoint *prevPoint;
+
+	/* use persistent scratch buffer for previous point states */
+	if (!sData->bData->prev_points)
+		sData->bData->prev_points = MEM_mallocN(sData->total_points * sizeof(PaintWavePoint), "Temp previous points for wave simulation");
+	prevPoint = sData->bData->prev_points;
 	if (!prevPoint)
 		return;
 
@@ -4502,8 +4533,6 @@ static void dynamicPaint_doWaveStep(DynamicPaintSurface *surface, float timescal
 		}
 		wPoint->state = DPAINT_WAVE_NONE;
 	}
-
-	MEM_freeN(prevPoint);
 }
 
 /* Do dissolve and fading effects */
@@ -4971,8 +5000,10 @@ static int dynamicPaint_doStep(Scene *scene, Object *ob, DynamicPaintSurface *su
 			PaintPoint *prevPoint;
 			float *force = NULL;
 
-			/* Allocate memory for surface previous points to read unchanged values from	*/
-			prevPoint = MEM_mallocN(sData->total_points * sizeof(struct PaintPoint), "PaintSurfaceDataCopy");
+			/* Persistent scratch buffer for surface previous points to read unchanged values from	*/
+			if (!bData->prev_points)
+				bData->prev_points = MEM_mallocN(sData->total_points * sizeof(struct PaintPoint), "PaintSurfaceDataCopy");
+			prevPoint = bData->prev_points;
 			if (!prevPoint)
 				return setError(canvas, N_("Not enough free memory"));
 
@@ -4981,12 +5012,6 @@ static int dynamicPaint_doStep(Scene *scene, Object *ob, DynamicPaintSurface *su
 			for (s = 0; s < steps; s++) {
 				dynamicPaint_doEffectStep(surface, force, prevPoint, timescale, (float)steps);
 			}
-
-			/* Free temporary effect data	*/
-			if (prevPoint)
-				MEM_freeN(prevPoint);
-			if (force)
-				MEM_freeN(force);
 		}
 	}
 
@@ -112,6 +112,15 @@ static void editmesh_tessface_calc_intern(BMEditMesh *em)
 
 	BMLoop *(*looptris)[3];
 
+	/* topology unchanged since the last full tessellation: the cached
+	 * looptris still reference valid loops and the triangle/quad fans are
+	 * still correct, only the coordinate dependent ngon fills can be stale
+	 * (e.g. transforming verts), so re-fill those in place */
+	if (em->looptris && !bm->tess_dirty) {
+		BM_mesh_calc_tessellation_ngons(bm, em->looptris);
+		return;
+	}
+
 #if 0
 	/* note, we could be clever and re-use this array but would need to ensure
 	 * its realloced at some point, for now just free it */
@@ -144,6 +153,7 @@ static void editmesh_tessface_calc_intern(BMEditMesh *em)
 	/* after allocating the em->looptris, we're ready to tessellate */
 	BM_mesh_calc_tessellation(em->bm, em->looptris, &em->tottri);
 
+	bm->tess_dirty = false;
 }
 
 void BKE_editmesh_tessface_calc(BMEditMesh *em)
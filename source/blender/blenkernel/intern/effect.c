@@ -156,6 +156,9 @@ static EffectorCache *new_effector_cache(Scene *scene, Object *ob, ParticleSyste
 	eff->psys = psys;
 	eff->pd = pd;
 	eff->frame = -1;
+
+	normalize_v3_v3(eff->znor, ob->obmat[2]);
+
 	return eff;
 }
 static void add_object_to_effectors(ListBase **effectors, Scene *scene, EffectorWeights *weights, Object *ob, Object *ob_src)
@@ -303,6 +306,9 @@ static void precalculate_effector(EffectorCache *eff)
 		copy_v3_v3(old_vel, eff->ob->obmat[3]);
 		BKE_object_where_is_calc_time(eff->scene, eff->ob, cfra);
 		sub_v3_v3v3(eff->velocity, eff->ob->obmat[3], old_vel);
+
+		/* the matrix may have been reevaluated above */
+		normalize_v3_v3(eff->znor, eff->ob->obmat[2]);
 	}
 }
 
@@ -640,7 +646,7 @@ int get_effector_data(EffectorCache *eff, EffectorData *efd, EffectedPoint *poin
 		const Object *ob = eff->ob;
 
 		/* use z-axis as normal*/
-		normalize_v3_v3(efd->nor, ob->obmat[2]);
+		copy_v3_v3(efd->nor, eff->znor);
 
 		if (eff->pd && eff->pd->shape == PFIELD_SHAPE_PLANE) {
 			float temp[3], translate[3];
@@ -680,7 +686,7 @@ int get_effector_data(EffectorCache *eff, EffectorData *efd, EffectedPoint *poin
 		else {
 			/* for some effectors we need the object center every time */
 			sub_v3_v3v3(efd->vec_to_point2, point->loc, eff->ob->obmat[3]);
-			normalize_v3_v3(efd->nor2, eff->ob->obmat[2]);
+			copy_v3_v3(efd->nor2, eff->znor);
 		}
 	}
 
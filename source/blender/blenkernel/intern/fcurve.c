@@ -2143,6 +2143,49 @@ static void berekenx(float *f, float *o, int b)
 /* -------------------------- */
 
 /* Calculate F-Curve value for 'evaltime' using BezTriple keyframes */
+/* Find the index of the keyframe segment containing evaltime. Equivalent to
+ * binarysearch_bezt_index_ex(), but tries the segment hit by the previous
+ * evaluation first: during playback and scrubbing consecutive evaluation
+ * times almost always fall in the same or an adjacent segment, which makes
+ * the lookup O(1) instead of a binary search per curve per frame.
+ */
+static int fcurve_eval_bezt_index(FCurve *fcu, BezTriple *bezts, float evaltime,
+                                  float threshold, bool *r_exact)
+{
+	const int arraylen = fcu->totvert;
+	const int prev = (int)fcu->last_eval_index;
+	/* Candidate segments: the previously hit one, then its two neighbours. */
+	const int candidates[3] = {prev, prev + 1, prev - 1};
+	int i, a;
+
+	for (i = 0; i < 3; i++) {
+		const int c = candidates[i];
+		if (c < 1 || c > arraylen - 1) {
+			continue;
+		}
+		/* Only accept an unambiguous interior hit. Anything within the
+		 * equality threshold of a keyframe takes the full search below,
+		 * so the exact-match rules stay identical to the binary search.
+		 */
+		if ((bezts[c - 1].vec[1][0] < evaltime) &&
+		    (bezts[c].vec[1][0] > evaltime) &&
+		    !IS_EQT(evaltime, bezts[c - 1].vec[1][0], threshold) &&
+		    !IS_EQT(evaltime, bezts[c].vec[1][0], threshold))
+		{
+			*r_exact = false;
+			fcu->last_eval_index = (unsigned int)c;
+			return c;
+		}
+	}
+
+	a = binarysearch_bezt_index_ex(bezts, evaltime, arraylen, threshold, r_exact);
+	/* The cache is purely a hint: concurrent evaluation of a shared action
+	 * may write it from two threads, a stale value only costs the fast path.
+	 */
+	fcu->last_eval_index = (unsigned int)a;
+	return a;
+}
+
 static float fcurve_eval_keyframes(FCurve *fcu, BezTriple *bezts, float evaltime)
 {
 	const float eps = 1.e-8f;
@@ -2274,7 +2317,7 @@ static float fcurve_eval_keyframes(FCurve *fcu, BezTriple *bezts, float evaltime
 		 *    - 0.00001 is too fine     -> Weird errors, like selecting the wrong keyframe range (see T39207), occur.
 		 *                                 This lower bound was established in b888a32eee8147b028464336ad2404d8155c64dd
 		 */
-		a = binarysearch_bezt_index_ex(bezts, evaltime, fcu->totvert, 0.0001, &exact);
+		a = fcurve_eval_bezt_index(fcu, bezts, evaltime, 0.0001, &exact);
 		if (G.debug & G_DEBUG) printf("eval fcurve '%s' - %f => %u/%u, %d\n", fcu->rna_path, evaltime, a, fcu->totvert, exact);
 		
 		if (exact) {
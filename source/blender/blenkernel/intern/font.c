@@ -46,6 +46,7 @@
 #include "BLI_string.h"
 #include "BLI_string_utf8.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_vfontdata.h"
 
@@ -191,7 +192,11 @@ static VFontData *vfont_get_data(Main *bmain, VFont *vfont)
 		}
 		
 		if (pf) {
-			vfont->data = BLI_vfontdata_from_freetypefont(pf);
+			/* the freetype code in blenlib reads pf->data directly */
+			if (acquirePackedFileData(pf)) {
+				vfont->data = BLI_vfontdata_from_freetypefont(pf);
+				releasePackedFileData(pf);
+			}
 			if (pf != vfont->packedfile) {
 				freePackedFile(pf);
 			}
@@ -614,6 +619,72 @@ struct TempLineInfo {
 	int   wspace_nr;  /* number of whitespaces of line */
 };
 
+typedef struct VFontToCurveTaskData {
+	Main *bmain;
+	Curve *cu;
+	Object *ob;
+	VFontData *vfd;
+	const wchar_t *mem;
+	CharInfo *custrinfo;
+	struct CharTrans *chartransdata;
+	ListBase *char_nubase;  /* one spline list per character, spliced in order afterwards */
+	float xtrax;
+	int slen;
+} VFontToCurveTaskData;
+
+/* build the splines of one character, all fonts and glyphs were already
+ * loaded by the layout pass so this only reads the caches */
+static void vfont_to_curve_char_task_cb(void *userdata, const int i)
+{
+	VFontToCurveTaskData *data = userdata;
+	Curve *cu = data->cu;
+	ListBase *nubase = &data->char_nubase[i];
+	struct CharTrans *ct = &data->chartransdata[i];
+	CharInfo *info = &data->custrinfo[i];
+	unsigned int cha = (unsigned int) data->mem[i];
+
+	if (info->flag & CU_CHINFO_SMALLCAPS_CHECK) {
+		cha = towupper(cha);
+	}
+
+	if (info->mat_nr > (data->ob->totcol)) {
+		/* printf("Error: Illegal material index (%d) in text object, setting to 0\n", info->mat_nr); */
+		info->mat_nr = 0;
+	}
+	/* We do not want to see any character for \n or \r */
+	if (cha != '\n')
+		buildchar(data->bmain, cu, nubase, cha, info, ct->xof, ct->yof, ct->rot, i);
+
+	if ((info->flag & CU_CHINFO_UNDERLINE) && (cha != '\n')) {
+		float twidth, ulwidth, uloverlap = 0.0f;
+		VChar *che;
+		rctf rect;
+
+		if ((i < (data->slen - 1)) && (data->mem[i + 1] != '\n') &&
+		    ((data->mem[i + 1] != ' ') || (data->custrinfo[i + 1].flag & CU_CHINFO_UNDERLINE)) &&
+		    ((data->custrinfo[i + 1].flag & CU_CHINFO_WRAP) == 0))
+		{
+			uloverlap = data->xtrax + 0.1f;
+		}
+		/* Find the character, the characters has to be in the memory already
+		 * since character checking has been done earlier already. */
+		che = find_vfont_char(data->vfd, cha);
+
+		twidth = char_width(cu, che, info);
+		ulwidth = (twidth * (1.0f + (info->kern / 40.0f))) + uloverlap;
+
+		rect.xmin = ct->xof;
+		rect.xmax = rect.xmin + ulwidth;
+
+		rect.ymin = ct->yof;
+		rect.ymax = rect.ymin - cu->ulheight;
+
+		build_underline(cu, nubase,
+		                &rect, cu->ulpos - 0.05f,
+		                ct->rot, i, info->mat_nr);
+	}
+}
+
 bool BKE_vfont_to_curve_ex(Main *bmain, Object *ob, int mode, ListBase *r_nubase,
                            const wchar_t **r_text, int *r_text_len, bool *r_text_free,
                            struct CharTrans **r_chartransdata)
@@ -769,7 +840,13 @@ makebreak:
 				 * happen often once all the chars are load.
 				 */
 				if ((che = find_vfont_char(vfd, ascii)) == NULL) {
-					che = BLI_vfontchar_from_freetypefont(vfont, ascii);
+					/* the freetype code in blenlib reads temp_pf->data directly */
+					if (vfont->temp_pf == NULL || acquirePackedFileData(vfont->temp_pf)) {
+						che = BLI_vfontchar_from_freetypefont(vfont, ascii);
+						if (vfont->temp_pf) {
+							releasePackedFileData(vfont->temp_pf);
+						}
+					}
 				}
 				BLI_rw_mutex_unlock(&vfont_rwlock);
 			}
@@ -1164,55 +1241,34 @@ makebreak:
 	}
 
 	if (mode == FO_EDIT) {
+		VFontToCurveTaskData task_data;
+		ListBase *char_nubase;
+
 		/* make nurbdata */
 		BKE_nurbList_free(r_nubase);
-		
-		ct = chartransdata;
-		for (i = 0; i < slen; i++) {
-			unsigned int cha = (unsigned int) mem[i];
-			info = &(custrinfo[i]);
-
-			if (info->flag & CU_CHINFO_SMALLCAPS_CHECK) {
-				cha = towupper(cha);
-			}
-
-			if (info->mat_nr > (ob->totcol)) {
-				/* printf("Error: Illegal material index (%d) in text object, setting to 0\n", info->mat_nr); */
-				info->mat_nr = 0;
-			}
-			/* We do not want to see any character for \n or \r */
-			if (cha != '\n')
-				buildchar(bmain, cu, r_nubase, cha, info, ct->xof, ct->yof, ct->rot, i);
-
-			if ((info->flag & CU_CHINFO_UNDERLINE) && (cha != '\n')) {
-				float ulwidth, uloverlap = 0.0f;
-				rctf rect;
-
-				if ((i < (slen - 1)) && (mem[i + 1] != '\n') &&
-				    ((mem[i + 1] != ' ') || (custrinfo[i + 1].flag & CU_CHINFO_UNDERLINE)) &&
-				    ((custrinfo[i + 1].flag & CU_CHINFO_WRAP) == 0))
-				{
-					uloverlap = xtrax + 0.1f;
-				}
-				/* Find the character, the characters has to be in the memory already
-				 * since character checking has been done earlier already. */
-				che = find_vfont_char(vfd, cha);
 
-				twidth = char_width(cu, che, info);
-				ulwidth = (twidth * (1.0f + (info->kern / 40.0f))) + uloverlap;
+		/* from here each character only reads the font caches, so the
+		 * characters can be built in parallel, every character writes
+		 * its own spline list which keeps the spline order stable */
+		char_nubase = MEM_callocN(sizeof(ListBase) * (size_t)(slen + 1), "char_nubase");
 
-				rect.xmin = ct->xof;
-				rect.xmax = rect.xmin + ulwidth;
+		task_data.bmain = bmain;
+		task_data.cu = cu;
+		task_data.ob = ob;
+		task_data.vfd = vfd;
+		task_data.mem = mem;
+		task_data.custrinfo = custrinfo;
+		task_data.chartransdata = chartransdata;
+		task_data.char_nubase = char_nubase;
+		task_data.xtrax = xtrax;
+		task_data.slen = slen;
 
-				rect.ymin = ct->yof;
-				rect.ymax = rect.ymin - cu->ulheight;
+		BLI_task_parallel_range(0, slen, &task_data, vfont_to_curve_char_task_cb, (slen > 64));
 
-				build_underline(cu, r_nubase,
-				                &rect, cu->ulpos - 0.05f,
-				                ct->rot, i, info->mat_nr);
-			}
-			ct++;
+		for (i = 0; i < slen; i++) {
+			BLI_movelisttolist(r_nubase, &char_nubase[i]);
 		}
+		MEM_freeN(char_nubase);
 	}
 
 	ok = true;
@@ -3579,9 +3579,14 @@ static ImBuf *load_image_single(
 
 		imapf = BLI_findlink(&ima->packedfiles, view_id);
 		if (imapf->packedfile) {
-			ibuf = IMB_ibImageFromMemory(
-			       (unsigned char *)imapf->packedfile->data, imapf->packedfile->size, flag,
-			       ima->colorspace_settings.name, "<packed data>");
+			unsigned char *data = acquirePackedFileData(imapf->packedfile);
+
+			if (data) {
+				ibuf = IMB_ibImageFromMemory(
+				       data, imapf->packedfile->size, flag,
+				       ima->colorspace_settings.name, "<packed data>");
+				releasePackedFileData(imapf->packedfile);
+			}
 		}
 	}
 	else {
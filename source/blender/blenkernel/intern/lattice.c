@@ -40,6 +40,7 @@
 #include "BLI_listbase.h"
 #include "BLI_bitmap.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
@@ -372,6 +373,11 @@ typedef struct LatticeDeformData {
 	Object *object;
 	float *latticedata;
 	float latmat[4][4];
+
+	/* cached at init so calc_latt_deform() doesn't re-resolve them per vertex */
+	Lattice *lt;         /* lattice data, editmode applied */
+	MDeformVert *dvert;  /* lattice vgroup weights */
+	int defgrp_index;    /* index of lt->vgroup, -1 if unused */
 } LatticeDeformData;
 
 LatticeDeformData *init_latt_deform(Object *oblatt, Object *ob)
@@ -434,31 +440,34 @@ LatticeDeformData *init_latt_deform(Object *oblatt, Object *ob)
 	lattice_deform_data->object = oblatt;
 	copy_m4_m4(lattice_deform_data->latmat, latmat);
 
+	/* vgroup influence, resolved once instead of for every deformed vertex */
+	lattice_deform_data->lt = lt;
+	lattice_deform_data->dvert = BKE_lattice_deform_verts_get(oblatt);
+	if (lt->vgroup[0] && lattice_deform_data->dvert)
+		lattice_deform_data->defgrp_index = defgroup_name_index(oblatt, lt->vgroup);
+	else
+		lattice_deform_data->defgrp_index = -1;
+
 	return lattice_deform_data;
 }
 
 void calc_latt_deform(LatticeDeformData *lattice_deform_data, float co[3], float weight)
 {
-	Object *ob = lattice_deform_data->object;
-	Lattice *lt = ob->data;
+	const Lattice *lt = lattice_deform_data->lt;
 	float u, v, w, tu[4], tv[4], tw[4];
 	float vec[3];
 	int idx_w, idx_v, idx_u;
 	int ui, vi, wi, uu, vv, ww;
 
 	/* vgroup influence */
-	int defgrp_index = -1;
+	const int defgrp_index = lattice_deform_data->defgrp_index;
+	const MDeformVert *dvert = lattice_deform_data->dvert;
 	float co_prev[3], weight_blend = 0.0f;
-	MDeformVert *dvert = BKE_lattice_deform_verts_get(ob);
-
 
-	if (lt->editlatt) lt = lt->editlatt->latt;
 	if (lattice_deform_data->latticedata == NULL) return;
 
-	if (lt->vgroup[0] && dvert) {
-		defgrp_index = defgroup_name_index(ob, lt->vgroup);
+	if (defgrp_index != -1)
 		copy_v3_v3(co_prev, co);
-	}
 
 	/* co is in local coords, treat with latmat */
 	mul_v3_m4v3(vec, lattice_deform_data->latmat, co);
@@ -885,11 +894,33 @@ void curve_deform_vector(Scene *scene, Object *cuOb, Object *target,
 
 }
 
+typedef struct LatticeDeformVertsData {
+	LatticeDeformData *lattice_deform_data;
+	float (*vertexCos)[3];
+	MDeformVert *dvert;  /* target vgroup weights, one per vertex (may be NULL) */
+	int defgrp_index;
+	float fac;
+} LatticeDeformVertsData;
+
+static void lattice_deform_verts_cb(void *userdata, const int a)
+{
+	LatticeDeformVertsData *data = userdata;
+
+	if (data->dvert != NULL) {
+		const float weight = defvert_find_weight(&data->dvert[a], data->defgrp_index);
+
+		if (weight > 0.0f)
+			calc_latt_deform(data->lattice_deform_data, data->vertexCos[a], weight * data->fac);
+	}
+	else {
+		calc_latt_deform(data->lattice_deform_data, data->vertexCos[a], data->fac);
+	}
+}
+
 void lattice_deform_verts(Object *laOb, Object *target, DerivedMesh *dm,
                           float (*vertexCos)[3], int numVerts, const char *vgroup, float fac)
 {
 	LatticeDeformData *lattice_deform_data;
-	int a;
 	bool use_vgroups;
 
 	if (laOb->type != OB_LATTICE)
@@ -918,25 +949,22 @@ void lattice_deform_verts(Object *laOb, Object *target, DerivedMesh *dm,
 	if (vgroup && vgroup[0] && use_vgroups) {
 		Mesh *me = target->data;
 		const int defgrp_index = defgroup_name_index(target, vgroup);
-		float weight;
 
 		if (defgrp_index >= 0 && (me->dvert || dm)) {
-			MDeformVert *dvert = me->dvert;
-			
-			for (a = 0; a < numVerts; a++, dvert++) {
-				if (dm) dvert = dm->getVertData(dm, a, CD_MDEFORMVERT);
-
-				weight = defvert_find_weight(dvert, defgrp_index);
-
-				if (weight > 0.0f)
-					calc_latt_deform(lattice_deform_data, vertexCos[a], weight * fac);
-			}
+			LatticeDeformVertsData data = {
+			    .lattice_deform_data = lattice_deform_data, .vertexCos = vertexCos,
+			    .dvert = (dm) ? dm->getVertDataArray(dm, CD_MDEFORMVERT) : me->dvert,
+			    .defgrp_index = defgrp_index, .fac = fac,
+			};
+			BLI_task_parallel_range(0, numVerts, &data, lattice_deform_verts_cb, numVerts > 1024);
 		}
 	}
 	else {
-		for (a = 0; a < numVerts; a++) {
-			calc_latt_deform(lattice_deform_data, vertexCos[a], fac);
-		}
+		LatticeDeformVertsData data = {
+		    .lattice_deform_data = lattice_deform_data, .vertexCos = vertexCos,
+		    .dvert = NULL, .defgrp_index = -1, .fac = fac,
+		};
+		BLI_task_parallel_range(0, numVerts, &data, lattice_deform_verts_cb, numVerts > 1024);
 	}
 	end_latt_deform(lattice_deform_data);
 }
@@ -60,15 +60,22 @@
 #include "DNA_vfont_types.h"
 #include "DNA_world_types.h"
 
+#include "MEM_guardedalloc.h"
+
 #include "BLI_utildefines.h"
 #include "BLI_ghash.h"
+#include "BLI_linklist.h"
+#include "BLI_listbase.h"
 #include "BLI_linklist_stack.h"
+#include "BLI_memarena.h"
+#include "BLI_task.h"
 
 #include "BKE_animsys.h"
 #include "BKE_constraint.h"
 #include "BKE_fcurve.h"
 #include "BKE_library.h"
 #include "BKE_library_query.h"
+#include "BKE_main.h"
 #include "BKE_modifier.h"
 #include "BKE_particle.h"
 #include "BKE_rigidbody.h"
@@ -776,3 +783,219 @@ int BKE_library_ID_use_ID(ID *id_user, ID *id_used)
 
 	return iter.count;
 }
+
+/* ***** Main reverse dependency index (users-of map). ***** */
+
+typedef struct MainIDRelationsEntry {
+	struct LinkNode *ids_used;   /* IDs directly used by this ID */
+	struct LinkNode *ids_users;  /* IDs directly using this ID */
+} MainIDRelationsEntry;
+
+struct MainIDRelations {
+	GHash *id_entries;  /* ID * -> MainIDRelationsEntry * */
+	/* All entries and link nodes are allocated from these,
+	 * one arena per task scheduler thread so the collecting pass can run in parallel. */
+	MemArena **arenas;
+	int num_arenas;
+};
+
+typedef struct MainRelationsBuildData {
+	ID **ids;
+	struct MainIDRelations *relations;
+} MainRelationsBuildData;
+
+typedef struct MainRelationsCollectData {
+	MainIDRelationsEntry *entry;
+	MemArena *arena;
+} MainRelationsCollectData;
+
+static void main_relations_entry_add(struct LinkNode **lnp, MemArena *arena, ID *id)
+{
+	LinkNode *ln = BLI_memarena_alloc(arena, sizeof(*ln));
+	ln->link = id;
+	ln->next = *lnp;
+	*lnp = ln;
+}
+
+static int main_relations_collect_cb(void *user_data, ID *id_self, ID **id_pointer, int UNUSED(cd_flag))
+{
+	MainRelationsCollectData *data = user_data;
+
+	if (*id_pointer && *id_pointer != id_self) {
+		main_relations_entry_add(&data->entry->ids_used, data->arena, *id_pointer);
+	}
+	return IDWALK_RET_NOP;
+}
+
+static void main_relations_build_task_cb(void *userdata, void *UNUSED(userdata_chunk), const int index, const int thread_id)
+{
+	MainRelationsBuildData *data = userdata;
+	struct MainIDRelations *relations = data->relations;
+	ID *id = data->ids[index];
+	MainRelationsCollectData collect;
+
+	/* only reads the ghash, all entries are inserted before the tasks are spawned */
+	collect.entry = BLI_ghash_lookup(relations->id_entries, id);
+
+	collect.arena = relations->arenas[thread_id];
+	if (UNLIKELY(collect.arena == NULL)) {
+		collect.arena = relations->arenas[thread_id] = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, __func__);
+	}
+
+	BKE_library_foreach_ID_link(id, main_relations_collect_cb, &collect, IDWALK_READONLY);
+}
+
+/**
+ * Build the reverse dependency index for the whole \a bmain.
+ *
+ * \note Usages are recorded with their multiplicity, an ID using another one through
+ * several pointers shows up that many times in the lists.
+ * \note Only IDs in \a bmain get a users list, usages of private/embedded IDs are
+ * still recorded in #BKE_main_relations_ids_used but cannot be queried the other way.
+ */
+struct MainIDRelations *BKE_main_relations_create(Main *bmain)
+{
+	struct MainIDRelations *relations = MEM_callocN(sizeof(*relations), __func__);
+	TaskScheduler *task_scheduler = BLI_task_scheduler_get();
+	ListBase *lbarray[MAX_LIBARRAY];
+	MainRelationsBuildData data;
+	ID *id;
+	int a, i, num_ids = 0;
+
+	relations->num_arenas = BLI_task_scheduler_num_threads(task_scheduler);
+	relations->arenas = MEM_callocN(sizeof(*relations->arenas) * (size_t)relations->num_arenas, __func__);
+	relations->arenas[0] = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, __func__);
+
+	a = set_listbasepointers(bmain, lbarray);
+	while (a--) {
+		num_ids += BLI_listbase_count(lbarray[a]);
+	}
+
+	relations->id_entries = BLI_ghash_ptr_new_ex(__func__, (unsigned int)num_ids);
+	data.ids = MEM_mallocN(sizeof(*data.ids) * (size_t)num_ids, __func__);
+	data.relations = relations;
+
+	i = 0;
+	a = set_listbasepointers(bmain, lbarray);
+	while (a--) {
+		for (id = lbarray[a]->first; id; id = id->next) {
+			MainIDRelationsEntry *entry = BLI_memarena_calloc(relations->arenas[0], sizeof(*entry));
+			BLI_ghash_insert(relations->id_entries, id, entry);
+			data.ids[i++] = id;
+		}
+	}
+
+	/* collect the 'uses' side in parallel, each task only writes to its own ID's entry */
+	BLI_task_parallel_range_ex(
+	        0, num_ids, &data, NULL, 0, main_relations_build_task_cb,
+	        (num_ids > 1024), true);
+
+	/* invert into the 'users' side, serially (appends to other IDs' entries) */
+	for (i = 0; i < num_ids; i++) {
+		MainIDRelationsEntry *entry = BLI_ghash_lookup(relations->id_entries, data.ids[i]);
+		LinkNode *ln;
+
+		for (ln = entry->ids_used; ln; ln = ln->next) {
+			MainIDRelationsEntry *entry_used = BLI_ghash_lookup(relations->id_entries, ln->link);
+			if (entry_used) {
+				main_relations_entry_add(&entry_used->ids_users, relations->arenas[0], data.ids[i]);
+			}
+		}
+	}
+
+	MEM_freeN(data.ids);
+
+	return relations;
+}
+
+void BKE_main_relations_free(struct MainIDRelations *relations)
+{
+	int i;
+
+	BLI_ghash_free(relations->id_entries, NULL, NULL);
+	for (i = 0; i < relations->num_arenas; i++) {
+		if (relations->arenas[i]) {
+			BLI_memarena_free(relations->arenas[i]);
+		}
+	}
+	MEM_freeN(relations->arenas);
+	MEM_freeN(relations);
+}
+
+/** IDs directly used by \a id (NULL for an unknown ID). */
+struct LinkNode *BKE_main_relations_ids_used(struct MainIDRelations *relations, ID *id)
+{
+	MainIDRelationsEntry *entry = BLI_ghash_lookup(relations->id_entries, id);
+	return entry ? entry->ids_used : NULL;
+}
+
+/** IDs directly using \a id (NULL for an unknown ID). */
+struct LinkNode *BKE_main_relations_ids_users(struct MainIDRelations *relations, ID *id)
+{
+	MainIDRelationsEntry *entry = BLI_ghash_lookup(relations->id_entries, id);
+	return entry ? entry->ids_users : NULL;
+}
+
+static void main_relations_entry_remove(struct LinkNode **lnp, ID *id)
+{
+	/* removes all occurrences, the nodes themselves stay in the arenas until the index is freed */
+	while (*lnp) {
+		if ((*lnp)->link == id) {
+			*lnp = (*lnp)->next;
+		}
+		else {
+			lnp = &(*lnp)->next;
+		}
+	}
+}
+
+/**
+ * Add a freshly created \a id (or one whose usages changed, after a remove/insert pair)
+ * to an existing index.
+ */
+void BKE_main_relations_insert_id(struct MainIDRelations *relations, ID *id)
+{
+	MainIDRelationsEntry *entry = BLI_memarena_calloc(relations->arenas[0], sizeof(*entry));
+	MainRelationsCollectData collect;
+	LinkNode *ln;
+
+	BLI_ghash_insert(relations->id_entries, id, entry);
+
+	collect.entry = entry;
+	collect.arena = relations->arenas[0];
+	BKE_library_foreach_ID_link(id, main_relations_collect_cb, &collect, IDWALK_READONLY);
+
+	for (ln = entry->ids_used; ln; ln = ln->next) {
+		MainIDRelationsEntry *entry_used = BLI_ghash_lookup(relations->id_entries, ln->link);
+		if (entry_used) {
+			main_relations_entry_add(&entry_used->ids_users, relations->arenas[0], id);
+		}
+	}
+}
+
+/**
+ * Remove \a id from an existing index, before it is freed or its usages change.
+ * Only touches the entries of actual users/used IDs, not the whole Main.
+ */
+void BKE_main_relations_remove_id(struct MainIDRelations *relations, ID *id)
+{
+	MainIDRelationsEntry *entry = BLI_ghash_popkey(relations->id_entries, id, NULL);
+	LinkNode *ln;
+
+	if (entry == NULL) {
+		return;
+	}
+
+	for (ln = entry->ids_used; ln; ln = ln->next) {
+		MainIDRelationsEntry *entry_used = BLI_ghash_lookup(relations->id_entries, ln->link);
+		if (entry_used) {
+			main_relations_entry_remove(&entry_used->ids_users, id);
+		}
+	}
+	for (ln = entry->ids_users; ln; ln = ln->next) {
+		MainIDRelationsEntry *entry_user = BLI_ghash_lookup(relations->id_entries, ln->link);
+		if (entry_user) {
+			main_relations_entry_remove(&entry_user->ids_used, id);
+		}
+	}
+}
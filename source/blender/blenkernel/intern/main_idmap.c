@@ -0,0 +1,213 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/blenkernel/intern/main_idmap.c
+ *  \ingroup bke
+ *
+ * Utility functions for fast lookups of ID data-blocks by name,
+ * avoiding the O(n) list walks of #BKE_libblock_find_name
+ * when many lookups are done on the same Main
+ * (file import, undo, make-local passes...).
+ *
+ * The maps are build lazily, one ghash per ID type, the first time an
+ * ID of that type is looked up. Callers that add or remove IDs while
+ * holding a map must keep it in sync with #BKE_main_idmap_insert_id and
+ * #BKE_main_idmap_remove_id.
+ */
+
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_ID.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_listbase.h"
+#include "BLI_ghash.h"
+#include "BLI_mempool.h"
+
+#include "BKE_idcode.h"
+#include "BKE_library.h"
+#include "BKE_main.h"
+#include "BKE_main_idmap.h"
+
+/** Map per ID type, from a name (and library) to the ID pointer. */
+struct IDNameLib_Key {
+	/** ID name, sizeof(ID::name) - 2, so without the ID_XX prefix */
+	const char *name;
+	/** Library the ID belongs to, NULL for local IDs */
+	const struct Library *lib;
+};
+
+struct IDNameLib_TypeMap {
+	GHash *map;
+	short id_type;
+};
+
+struct IDNameLib_Map {
+	struct IDNameLib_TypeMap type_maps[MAX_LIBARRAY];
+	int num_types;
+	struct BLI_mempool *keys_pool;
+	struct Main *bmain;
+};
+
+static struct IDNameLib_TypeMap *main_idmap_from_idcode(struct IDNameLib_Map *id_map, short id_type)
+{
+	int i;
+	for (i = 0; i < id_map->num_types; i++) {
+		if (id_map->type_maps[i].id_type == id_type) {
+			return &id_map->type_maps[i];
+		}
+	}
+	return NULL;
+}
+
+struct IDNameLib_Map *BKE_main_idmap_create(struct Main *bmain)
+{
+	struct IDNameLib_Map *id_map = MEM_mallocN(sizeof(*id_map), __func__);
+	int index = 0;
+	int i = 0;
+	short id_type;
+
+	while ((id_type = BKE_idcode_iter_step(&index))) {
+		/* skip the fake ID types that have no Main listbase (ID_ID, ID_SEQ...) */
+		if (which_libbase(bmain, id_type) != NULL) {
+			BLI_assert(i < MAX_LIBARRAY);
+			id_map->type_maps[i].map = NULL;
+			id_map->type_maps[i].id_type = id_type;
+			i++;
+		}
+	}
+	id_map->num_types = i;
+
+	id_map->keys_pool = NULL;
+	id_map->bmain = bmain;
+
+	return id_map;
+}
+
+struct Main *BKE_main_idmap_main_get(struct IDNameLib_Map *id_map)
+{
+	return id_map->bmain;
+}
+
+static unsigned int idkey_hash(const void *ptr)
+{
+	const struct IDNameLib_Key *idkey = ptr;
+	unsigned int key = BLI_ghashutil_strhash_p(idkey->name);
+	if (idkey->lib) {
+		key ^= BLI_ghashutil_ptrhash(idkey->lib);
+	}
+	return key;
+}
+
+static bool idkey_cmp(const void *a, const void *b)
+{
+	const struct IDNameLib_Key *idkey_a = a;
+	const struct IDNameLib_Key *idkey_b = b;
+	return !STREQ(idkey_a->name, idkey_b->name) || (idkey_a->lib != idkey_b->lib);
+}
+
+static void main_idmap_insert_id_key(struct IDNameLib_Map *id_map, struct IDNameLib_TypeMap *type_map, ID *id)
+{
+	struct IDNameLib_Key *key = BLI_mempool_alloc(id_map->keys_pool);
+	key->name = id->name + 2;
+	key->lib = id->lib;
+	BLI_ghash_insert(type_map->map, key, id);
+}
+
+/* lazy init of the ghash for one ID type */
+static void main_idmap_ensure_type_map(struct IDNameLib_Map *id_map, struct IDNameLib_TypeMap *type_map)
+{
+	ListBase *lb = which_libbase(id_map->bmain, type_map->id_type);
+	ID *id;
+
+	if (id_map->keys_pool == NULL) {
+		id_map->keys_pool = BLI_mempool_create(sizeof(struct IDNameLib_Key), 1024, 1024, BLI_MEMPOOL_NOP);
+	}
+
+	type_map->map = BLI_ghash_new_ex(idkey_hash, idkey_cmp, __func__,
+	                                 BLI_listbase_count(lb));
+	for (id = lb->first; id; id = id->next) {
+		main_idmap_insert_id_key(id_map, type_map, id);
+	}
+}
+
+void BKE_main_idmap_insert_id(struct IDNameLib_Map *id_map, ID *id)
+{
+	struct IDNameLib_TypeMap *type_map = main_idmap_from_idcode(id_map, GS(id->name));
+
+	/* if the map for this type was not built yet, the new ID is picked up on first lookup */
+	if (type_map && type_map->map) {
+		main_idmap_insert_id_key(id_map, type_map, id);
+	}
+}
+
+void BKE_main_idmap_remove_id(struct IDNameLib_Map *id_map, ID *id)
+{
+	struct IDNameLib_TypeMap *type_map = main_idmap_from_idcode(id_map, GS(id->name));
+
+	if (type_map && type_map->map) {
+		struct IDNameLib_Key key_lookup = {id->name + 2, id->lib};
+		/* the stored key is not freed here, it remains in the pool until the map is destroyed */
+		BLI_ghash_remove(type_map->map, &key_lookup, NULL, NULL);
+	}
+}
+
+ID *BKE_main_idmap_lookup(struct IDNameLib_Map *id_map, short id_type, const char *name, const Library *lib)
+{
+	struct IDNameLib_TypeMap *type_map = main_idmap_from_idcode(id_map, id_type);
+	struct IDNameLib_Key key_lookup;
+
+	if (UNLIKELY(type_map == NULL)) {
+		return NULL;
+	}
+
+	if (type_map->map == NULL) {
+		main_idmap_ensure_type_map(id_map, type_map);
+	}
+
+	key_lookup.name = name;
+	key_lookup.lib = lib;
+	return BLI_ghash_lookup(type_map->map, &key_lookup);
+}
+
+ID *BKE_main_idmap_lookup_id(struct IDNameLib_Map *id_map, const ID *id)
+{
+	return BKE_main_idmap_lookup(id_map, GS(id->name), id->name + 2, id->lib);
+}
+
+void BKE_main_idmap_destroy(struct IDNameLib_Map *id_map)
+{
+	struct IDNameLib_TypeMap *type_map = id_map->type_maps;
+	int i;
+
+	for (i = 0; i < id_map->num_types; i++, type_map++) {
+		if (type_map->map) {
+			BLI_ghash_free(type_map->map, NULL, NULL);
+			type_map->map = NULL;
+		}
+	}
+	if (id_map->keys_pool) {
+		BLI_mempool_destroy(id_map->keys_pool);
+	}
+
+	MEM_freeN(id_map);
+}
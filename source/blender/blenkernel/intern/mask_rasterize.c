@@ -81,10 +81,12 @@
 #include "BLI_math.h"
 #include "BLI_rect.h"
 #include "BLI_listbase.h"
-#include "BLI_linklist.h"
+#include "BLI_task.h"
 
 #include "BKE_mask.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_strict_flags.h"
 
 /* this is rather and annoying hack, use define to isolate it.
@@ -409,10 +411,109 @@ static void layer_bucket_init_dummy(MaskRasterLayer *layer)
 	BLI_rctf_init(&layer->bounds, -1.0f, -1.0f, -1.0f, -1.0f);
 }
 
-static void layer_bucket_init(MaskRasterLayer *layer, const float pixel_size)
+typedef struct MaskRasterBucketData {
+	MaskRasterLayer *layer;
+	float bucket_size_x;
+	float bucket_size_y;
+	float bucket_max_rad_squared;
+	/* face counts per bucket in the count pass, write cursors in the fill pass */
+	unsigned int *bucketstore_tot;
+	/* NULL in the count pass */
+	unsigned int **buckets_face;
+} MaskRasterBucketData;
+
+static void layer_bucket_init_task_cb(void *userdata, const int f)
 {
-	MemArena *arena = BLI_memarena_new(MEM_SIZE_OPTIMAL(1 << 16), __func__);
+	MaskRasterBucketData *data = userdata;
+	MaskRasterLayer *layer = data->layer;
+	const unsigned int face_index = (unsigned int)f;
+	const unsigned int *face = layer->face_array[face_index];
+	float (*cos)[3] = layer->face_coords;
+
+	float xmin;
+	float xmax;
+	float ymin;
+	float ymax;
+
+	if (face[3] == TRI_VERT) {
+		const float *v1 = cos[face[0]];
+		const float *v2 = cos[face[1]];
+		const float *v3 = cos[face[2]];
+
+		xmin = min_ff(v1[0], min_ff(v2[0], v3[0]));
+		xmax = max_ff(v1[0], max_ff(v2[0], v3[0]));
+		ymin = min_ff(v1[1], min_ff(v2[1], v3[1]));
+		ymax = max_ff(v1[1], max_ff(v2[1], v3[1]));
+	}
+	else {
+		const float *v1 = cos[face[0]];
+		const float *v2 = cos[face[1]];
+		const float *v3 = cos[face[2]];
+		const float *v4 = cos[face[3]];
+
+		xmin = min_ff(v1[0], min_ff(v2[0], min_ff(v3[0], v4[0])));
+		xmax = max_ff(v1[0], max_ff(v2[0], max_ff(v3[0], v4[0])));
+		ymin = min_ff(v1[1], min_ff(v2[1], min_ff(v3[1], v4[1])));
+		ymax = max_ff(v1[1], max_ff(v2[1], max_ff(v3[1], v4[1])));
+	}
+
+
+	/* not essential but may as will skip any faces outside the view */
+	if (!((xmax < 0.0f) || (ymax < 0.0f) || (xmin > 1.0f) || (ymin > 1.0f))) {
+
+		CLAMP(xmin, 0.0f,  1.0f);
+		CLAMP(ymin, 0.0f,  1.0f);
+		CLAMP(xmax, 0.0f,  1.0f);
+		CLAMP(ymax, 0.0f,  1.0f);
 
+		{
+			unsigned int xi_min = (unsigned int) ((xmin - layer->bounds.xmin) * layer->buckets_xy_scalar[0]);
+			unsigned int xi_max = (unsigned int) ((xmax - layer->bounds.xmin) * layer->buckets_xy_scalar[0]);
+			unsigned int yi_min = (unsigned int) ((ymin - layer->bounds.ymin) * layer->buckets_xy_scalar[1]);
+			unsigned int yi_max = (unsigned int) ((ymax - layer->bounds.ymin) * layer->buckets_xy_scalar[1]);
+
+			unsigned int xi, yi;
+
+			/* this should _almost_ never happen but since it can in extreme cases,
+			 * we have to clamp the values or we overrun the buffer and crash */
+			if (xi_min >= layer->buckets_x) xi_min = layer->buckets_x - 1;
+			if (xi_max >= layer->buckets_x) xi_max = layer->buckets_x - 1;
+			if (yi_min >= layer->buckets_y) yi_min = layer->buckets_y - 1;
+			if (yi_max >= layer->buckets_y) yi_max = layer->buckets_y - 1;
+
+			for (yi = yi_min; yi <= yi_max; yi++) {
+				unsigned int bucket_index = (layer->buckets_x * yi) + xi_min;
+				for (xi = xi_min; xi <= xi_max; xi++, bucket_index++) {
+					// unsigned int bucket_index = (layer->buckets_x * yi) + xi; /* correct but do in outer loop */
+
+					BLI_assert(xi < layer->buckets_x);
+					BLI_assert(yi < layer->buckets_y);
+
+					/* check if the bucket intersects with the face */
+					/* note: there is a trade off here since checking box/tri intersections isn't
+					 * as optimal as it could be, but checking pixels against faces they will never intersect
+					 * with is likely the greater slowdown here - so check if the cell intersects the face */
+					if (layer_bucket_isect_test(layer, face_index,
+					                            xi, yi,
+					                            data->bucket_size_x, data->bucket_size_y,
+					                            data->bucket_max_rad_squared))
+					{
+						if (data->buckets_face) {
+							const unsigned int insert = atomic_add_uint32(&data->bucketstore_tot[bucket_index], 1) - 1;
+							data->buckets_face[bucket_index][insert] = face_index;
+						}
+						else {
+							atomic_add_uint32(&data->bucketstore_tot[bucket_index], 1);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+static void layer_bucket_init(MaskRasterLayer *layer, const float pixel_size)
+{
 	const float bucket_dim_x = BLI_rctf_size_x(&layer->bounds);
 	const float bucket_dim_y = BLI_rctf_size_y(&layer->bounds);
 
@@ -434,127 +535,58 @@ static void layer_bucket_init(MaskRasterLayer *layer, const float pixel_size)
 		const float bucket_max_rad = (max_ff(bucket_size_x, bucket_size_y) * (float)M_SQRT2) + FLT_EPSILON;
 		const float bucket_max_rad_squared = bucket_max_rad * bucket_max_rad;
 
-		unsigned int *face = &layer->face_array[0][0];
-		float (*cos)[3] = layer->face_coords;
-
 		const unsigned int  bucket_tot = layer->buckets_x * layer->buckets_y;
-		LinkNode     **bucketstore     = MEM_callocN(bucket_tot * sizeof(LinkNode *),  __func__);
 		unsigned int  *bucketstore_tot = MEM_callocN(bucket_tot * sizeof(unsigned int), __func__);
+		unsigned int **buckets_face    = MEM_mallocN(bucket_tot * sizeof(*buckets_face), __func__);
 
-		unsigned int face_index;
+		const bool use_threading = (layer->face_tot > 1024);
 
-		for (face_index = 0; face_index < layer->face_tot; face_index++, face += 4) {
-			float xmin;
-			float xmax;
-			float ymin;
-			float ymax;
+		unsigned int bucket_index;
 
-			if (face[3] == TRI_VERT) {
-				const float *v1 = cos[face[0]];
-				const float *v2 = cos[face[1]];
-				const float *v3 = cos[face[2]];
+		MaskRasterBucketData data;
 
-				xmin = min_ff(v1[0], min_ff(v2[0], v3[0]));
-				xmax = max_ff(v1[0], max_ff(v2[0], v3[0]));
-				ymin = min_ff(v1[1], min_ff(v2[1], v3[1]));
-				ymax = max_ff(v1[1], max_ff(v2[1], v3[1]));
-			}
-			else {
-				const float *v1 = cos[face[0]];
-				const float *v2 = cos[face[1]];
-				const float *v3 = cos[face[2]];
-				const float *v4 = cos[face[3]];
-
-				xmin = min_ff(v1[0], min_ff(v2[0], min_ff(v3[0], v4[0])));
-				xmax = max_ff(v1[0], max_ff(v2[0], max_ff(v3[0], v4[0])));
-				ymin = min_ff(v1[1], min_ff(v2[1], min_ff(v3[1], v4[1])));
-				ymax = max_ff(v1[1], max_ff(v2[1], max_ff(v3[1], v4[1])));
-			}
+		data.layer = layer;
+		data.bucket_size_x = bucket_size_x;
+		data.bucket_size_y = bucket_size_y;
+		data.bucket_max_rad_squared = bucket_max_rad_squared;
+		data.bucketstore_tot = bucketstore_tot;
+		data.buckets_face = NULL;
 
+		/* first pass counts the faces per bucket so the arrays can be allocated
+		 * exactly, faces are fully independent and only bump atomic counters */
+		BLI_task_parallel_range(0, (int)layer->face_tot, &data, layer_bucket_init_task_cb,
+		                        use_threading);
 
-			/* not essential but may as will skip any faces outside the view */
-			if (!((xmax < 0.0f) || (ymax < 0.0f) || (xmin > 1.0f) || (ymin > 1.0f))) {
-
-				CLAMP(xmin, 0.0f,  1.0f);
-				CLAMP(ymin, 0.0f,  1.0f);
-				CLAMP(xmax, 0.0f,  1.0f);
-				CLAMP(ymax, 0.0f,  1.0f);
-
-				{
-					unsigned int xi_min = (unsigned int) ((xmin - layer->bounds.xmin) * layer->buckets_xy_scalar[0]);
-					unsigned int xi_max = (unsigned int) ((xmax - layer->bounds.xmin) * layer->buckets_xy_scalar[0]);
-					unsigned int yi_min = (unsigned int) ((ymin - layer->bounds.ymin) * layer->buckets_xy_scalar[1]);
-					unsigned int yi_max = (unsigned int) ((ymax - layer->bounds.ymin) * layer->buckets_xy_scalar[1]);
-					void *face_index_void = SET_UINT_IN_POINTER(face_index);
-
-					unsigned int xi, yi;
-
-					/* this should _almost_ never happen but since it can in extreme cases,
-					 * we have to clamp the values or we overrun the buffer and crash */
-					if (xi_min >= layer->buckets_x) xi_min = layer->buckets_x - 1;
-					if (xi_max >= layer->buckets_x) xi_max = layer->buckets_x - 1;
-					if (yi_min >= layer->buckets_y) yi_min = layer->buckets_y - 1;
-					if (yi_max >= layer->buckets_y) yi_max = layer->buckets_y - 1;
-
-					for (yi = yi_min; yi <= yi_max; yi++) {
-						unsigned int bucket_index = (layer->buckets_x * yi) + xi_min;
-						for (xi = xi_min; xi <= xi_max; xi++, bucket_index++) {
-							// unsigned int bucket_index = (layer->buckets_x * yi) + xi; /* correct but do in outer loop */
-
-							BLI_assert(xi < layer->buckets_x);
-							BLI_assert(yi < layer->buckets_y);
-							BLI_assert(bucket_index < bucket_tot);
-
-							/* check if the bucket intersects with the face */
-							/* note: there is a trade off here since checking box/tri intersections isn't
-							 * as optimal as it could be, but checking pixels against faces they will never intersect
-							 * with is likely the greater slowdown here - so check if the cell intersects the face */
-							if (layer_bucket_isect_test(layer, face_index,
-							                            xi, yi,
-							                            bucket_size_x, bucket_size_y,
-							                            bucket_max_rad_squared))
-							{
-								BLI_linklist_prepend_arena(&bucketstore[bucket_index], face_index_void, arena);
-								bucketstore_tot[bucket_index]++;
-							}
-						}
-					}
-				}
+		/* allocate with one extra entry for the terminator,
+		 * the counters are reset and re-used as write cursors for the fill pass */
+		for (bucket_index = 0; bucket_index < bucket_tot; bucket_index++) {
+			if (bucketstore_tot[bucket_index]) {
+				buckets_face[bucket_index] = MEM_mallocN((bucketstore_tot[bucket_index] + 1) * sizeof(unsigned int),
+				                                         __func__);
+				bucketstore_tot[bucket_index] = 0;
+			}
+			else {
+				buckets_face[bucket_index] = NULL;
 			}
 		}
 
-		if (1) {
-			/* now convert linknodes into arrays for faster per pixel access */
-			unsigned int  **buckets_face = MEM_mallocN(bucket_tot * sizeof(*buckets_face), __func__);
-			unsigned int bucket_index;
-
-			for (bucket_index = 0; bucket_index < bucket_tot; bucket_index++) {
-				if (bucketstore_tot[bucket_index]) {
-					unsigned int  *bucket = MEM_mallocN((bucketstore_tot[bucket_index] + 1) * sizeof(unsigned int),
-					                                    __func__);
-					LinkNode *bucket_node;
-
-					buckets_face[bucket_index] = bucket;
+		/* second pass re-runs the same intersection tests and scatters the
+		 * face indices into the bucket arrays (order within a bucket doesn't
+		 * matter, lookups scan to the terminator) */
+		data.buckets_face = buckets_face;
+		BLI_task_parallel_range(0, (int)layer->face_tot, &data, layer_bucket_init_task_cb,
+		                        use_threading);
 
-					for (bucket_node = bucketstore[bucket_index]; bucket_node; bucket_node = bucket_node->next) {
-						*bucket = GET_UINT_FROM_POINTER(bucket_node->link);
-						bucket++;
-					}
-					*bucket = TRI_TERMINATOR_ID;
-				}
-				else {
-					buckets_face[bucket_index] = NULL;
-				}
+		for (bucket_index = 0; bucket_index < bucket_tot; bucket_index++) {
+			if (buckets_face[bucket_index]) {
+				buckets_face[bucket_index][bucketstore_tot[bucket_index]] = TRI_TERMINATOR_ID;
 			}
-
-			layer->buckets_face = buckets_face;
 		}
 
-		MEM_freeN(bucketstore);
+		layer->buckets_face = buckets_face;
+
 		MEM_freeN(bucketstore_tot);
 	}
-
-	BLI_memarena_free(arena);
 }
 
 void BKE_maskrasterize_handle_init(MaskRasterHandle *mr_handle, struct Mask *mask,
@@ -45,6 +45,7 @@
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
 #include "BLI_memarena.h"
+#include "BLI_task.h"
 
 #include "BKE_global.h"
 
@@ -76,6 +77,11 @@ typedef struct cubes {          /* linked list of cubes acting as stack */
 	struct cubes *next;         /* remaining elements */
 } CUBES;
 
+typedef struct CubeVertexSolve {  /* pre-computed surface vertices of one cube */
+	float co[12][3], no[12][3];   /* intersection point and normal per cube edge */
+	int solved;                   /* bitmask of edges which have a solution */
+} CubeVertexSolve;
+
 typedef struct centerlist {     /* list of cube locations */
 	int i, j, k;                /* cube location */
 	struct centerlist *next;    /* remaining elements */
@@ -139,10 +145,10 @@ typedef struct process {        /* parameters, storage */
 } PROCESS;
 
 /* Forward declarations */
-static int vertid(PROCESS *process, const CORNER *c1, const CORNER *c2);
+static int vertid(PROCESS *process, const CORNER *c1, const CORNER *c2, const CubeVertexSolve *solve, const int cube_edge);
 static void add_cube(PROCESS *process, int i, int j, int k);
 static void make_face(PROCESS *process, int i1, int i2, int i3, int i4);
-static void converge(PROCESS *process, const CORNER *c1, const CORNER *c2, float r_p[3]);
+static void converge(PROCESS *process, MetaballBVHNode **bvh_queue, const CORNER *c1, const CORNER *c2, float r_p[3]);
 
 /* ******************* SIMPLE BVH ********************* */
 
@@ -361,26 +367,27 @@ static float densfunc(const MetaElem *ball, float x, float y, float z)
 
 /**
  * Computes density at given position form all metaballs which contain this point in their box.
- * Traverses BVH using a queue.
+ * Traverses BVH using a queue (passed in explicitly, so concurrent evaluations can
+ * each use their own).
  */
-static float metaball(PROCESS *process, float x, float y, float z)
+static float metaball(PROCESS *process, MetaballBVHNode **bvh_queue, float x, float y, float z)
 {
 	int i;
 	float dens = 0.0f;
 	unsigned int front = 0, back = 0;
 	MetaballBVHNode *node;
 
-	process->bvh_queue[front++] = &process->metaball_bvh;
+	bvh_queue[front++] = &process->metaball_bvh;
 
 	while (front != back) {
-		node = process->bvh_queue[back++];
+		node = bvh_queue[back++];
 
 		for (i = 0; i < 2; i++) {
 			if ((node->bb[i].min[0] <= x) && (node->bb[i].max[0] >= x) &&
 			    (node->bb[i].min[1] <= y) && (node->bb[i].max[1] >= y) &&
 			    (node->bb[i].min[2] <= z) && (node->bb[i].max[2] >= z))
 			{
-				if (node->child[i])	process->bvh_queue[front++] = node->child[i];
+				if (node->child[i])	bvh_queue[front++] = node->child[i];
 				else dens += densfunc(node->bb[i].ml, x, y, z);
 			}
 		}
@@ -487,7 +494,7 @@ static int rightface[12] = {
 /**
  * triangulate the cube directly, without decomposition
  */
-static void docube(PROCESS *process, CUBE *cube)
+static void docube(PROCESS *process, CUBE *cube, const CubeVertexSolve *solve)
 {
 	INTLISTS *polys;
 	CORNER *c1, *c2;
@@ -518,7 +525,7 @@ static void docube(PROCESS *process, CUBE *cube)
 			c1 = cube->corners[corner1[edges->i]];
 			c2 = cube->corners[corner2[edges->i]];
 
-			indexar[count] = vertid(process, c1, c2);
+			indexar[count] = vertid(process, c1, c2, solve, edges->i);
 			count++;
 		}
 
@@ -595,7 +602,7 @@ static CORNER *setcorner(PROCESS *process, int i, int j, int k)
 	c->k = k;
 	c->co[2] = ((float)k - 0.5f) * process->size;
 
-	c->value = metaball(process, c->co[0], c->co[1], c->co[2]);
+	c->value = metaball(process, process->bvh_queue, c->co[0], c->co[1], c->co[2]);
 
 	c->next = process->corners[index];
 	process->corners[index] = c;
@@ -850,14 +857,14 @@ static void addtovertices(PROCESS *process, const float v[3], const float no[3])
  *
  * \note Doesn't do normalization!
  */
-static void vnormal(PROCESS *process, const float point[3], float r_no[3])
+static void vnormal(PROCESS *process, MetaballBVHNode **bvh_queue, const float point[3], float r_no[3])
 {
 	const float delta = process->delta;
-	const float f = metaball(process, point[0], point[1], point[2]);
+	const float f = metaball(process, bvh_queue, point[0], point[1], point[2]);
 
-	r_no[0] = metaball(process, point[0] + delta, point[1], point[2]) - f;
-	r_no[1] = metaball(process, point[0], point[1] + delta, point[2]) - f;
-	r_no[2] = metaball(process, point[0], point[1], point[2] + delta) - f;
+	r_no[0] = metaball(process, bvh_queue, point[0] + delta, point[1], point[2]) - f;
+	r_no[1] = metaball(process, bvh_queue, point[0], point[1] + delta, point[2]) - f;
+	r_no[2] = metaball(process, bvh_queue, point[0], point[1], point[2] + delta) - f;
 
 #if 0
 	f = normalize_v3(r_no);
@@ -885,22 +892,29 @@ static void vnormal(PROCESS *process, const float point[3], float r_no[3])
 /**
  * \return the id of vertex between two corners.
  *
- * If it wasn't previously computed, does #converge() and adds vertex to process.
+ * Uses the result pre-computed for this cube edge when there is one,
+ * otherwise does #converge() here; either way adds the vertex to process.
  */
-static int vertid(PROCESS *process, const CORNER *c1, const CORNER *c2)
+static int vertid(PROCESS *process, const CORNER *c1, const CORNER *c2, const CubeVertexSolve *solve, const int cube_edge)
 {
 	float v[3], no[3];
 	int vid = getedge(process->edges, c1->i, c1->j, c1->k, c2->i, c2->j, c2->k);
 
 	if (vid != -1) return vid;  /* previously computed */
 
-	converge(process, c1, c2, v);  /* position */
+	if (solve && (solve->solved & (1 << cube_edge))) {
+		copy_v3_v3(v, solve->co[cube_edge]);
+		copy_v3_v3(no, solve->no[cube_edge]);
+	}
+	else {
+		converge(process, process->bvh_queue, c1, c2, v);  /* position */
 
 #ifdef USE_ACCUM_NORMAL
-	zero_v3(no);
+		zero_v3(no);
 #else
-	vnormal(process, v, no);
+		vnormal(process, process->bvh_queue, v, no);
 #endif
+	}
 
 	addtovertices(process, v, no);            /* save vertex */
 	vid = (int)process->curvertex - 1;
@@ -913,7 +927,7 @@ static int vertid(PROCESS *process, const CORNER *c1, const CORNER *c2)
  * Given two corners, computes approximation of surface intersection point between them.
  * In case of small threshold, do bisection.
  */
-static void converge(PROCESS *process, const CORNER *c1, const CORNER *c2, float r_p[3])
+static void converge(PROCESS *process, MetaballBVHNode **bvh_queue, const CORNER *c1, const CORNER *c2, float r_p[3])
 {
 	float tmp, dens;
 	unsigned int i;
@@ -936,7 +950,7 @@ static void converge(PROCESS *process, const CORNER *c1, const CORNER *c2, float
 
 	for (i = 0; i < process->converge_res; i++) {
 		interp_v3_v3v3(r_p, c1_co, c2_co, 0.5f);
-		dens = metaball(process, r_p[0], r_p[1], r_p[2]);
+		dens = metaball(process, bvh_queue, r_p[0], r_p[1], r_p[2]);
 
 		if (dens > 0.0f) {
 			c1_value = dens;
@@ -1043,16 +1057,70 @@ static void find_first_points(PROCESS *process, const unsigned int em)
 	}
 }
 
+typedef struct PolygonizeWaveData {
+	PROCESS *process;
+	CUBE *wave;                    /* cubes of the current wave */
+	CubeVertexSolve *solves;       /* one solve per wave cube */
+	MetaballBVHNode **bvh_queues;  /* bvh traversal queue per thread */
+} PolygonizeWaveData;
+
+/**
+ * Solves surface vertices of one wave cube: for every cube edge whose corner
+ * values cross the threshold and whose vertex wasn't computed by an earlier
+ * wave, runs #converge() and #vnormal() into the per-cube scratch.
+ *
+ * Only reads the edge hash table (no writes happen during the parallel phase),
+ * and traverses the bvh through this thread's own queue.
+ */
+static void polygonize_solve_cube_cb(void *userdata, void *UNUSED(userdata_chunk), const int n, const int thread_id)
+{
+	PolygonizeWaveData *data = userdata;
+	PROCESS *process = data->process;
+	MetaballBVHNode **bvh_queue = data->bvh_queues + ((size_t)thread_id * process->bvh_queue_size);
+	const CUBE *cube = &data->wave[n];
+	CubeVertexSolve *solve = &data->solves[n];
+	int e;
+
+	solve->solved = 0;
+
+	for (e = 0; e < 12; e++) {
+		const CORNER *c1 = cube->corners[corner1[e]];
+		const CORNER *c2 = cube->corners[corner2[e]];
+
+		if ((c1->value > 0.0f) == (c2->value > 0.0f)) {
+			continue;
+		}
+
+		if (getedge(process->edges, c1->i, c1->j, c1->k, c2->i, c2->j, c2->k) != -1) {
+			continue;  /* computed by an earlier wave */
+		}
+
+		converge(process, bvh_queue, c1, c2, solve->co[e]);
+
+#ifdef USE_ACCUM_NORMAL
+		zero_v3(solve->no[e]);
+#else
+		vnormal(process, bvh_queue, solve->co[e], solve->no[e]);
+#endif
+
+		solve->solved |= (1 << e);
+	}
+}
+
 /**
  * The main polygonization proc.
  * Allocates memory, makes cubetable,
  * finds starting surface points
  * and processes cubes on the stack until none left.
+ *
+ * Cubes are taken off the stack in waves: the expensive surface-vertex
+ * computation of a whole wave runs in parallel tasks, then a cheap serial
+ * pass builds the faces and pushes the cubes of the next wave.
  */
 static void polygonize(PROCESS *process)
 {
-	CUBE c;
-	unsigned int i;
+	PolygonizeWaveData data;
+	unsigned int i, num_queues, wave_size = 0;
 
 	process->centers = MEM_callocN(HASHSIZE * sizeof(CENTERLIST *), "mbproc->centers");
 	process->corners = MEM_callocN(HASHSIZE * sizeof(CORNER *), "mbproc->corners");
@@ -1065,12 +1133,39 @@ static void polygonize(PROCESS *process)
 		find_first_points(process, i);
 	}
 
+	data.process = process;
+	data.wave = NULL;
+	data.solves = NULL;
+	num_queues = (unsigned int)BLI_task_scheduler_num_threads(BLI_task_scheduler_get()) + 1;
+	data.bvh_queues = MEM_mallocN(
+	        sizeof(MetaballBVHNode *) * process->bvh_queue_size * num_queues, "Metaball BVH Queues");
+
 	while (process->cubes != NULL) {
-		c = process->cubes->cube;
-		process->cubes = process->cubes->next;
+		unsigned int wave_len = 0;
+
+		while (process->cubes != NULL) {
+			if (UNLIKELY(wave_len == wave_size)) {
+				wave_size += 4096;
+				data.wave = MEM_reallocN(data.wave, sizeof(CUBE) * wave_size);
+				data.solves = MEM_reallocN(data.solves, sizeof(CubeVertexSolve) * wave_size);
+			}
+
+			data.wave[wave_len++] = process->cubes->cube;
+			process->cubes = process->cubes->next;
+		}
+
+		BLI_task_parallel_range_ex(
+		        0, (int)wave_len, &data, NULL, 0, polygonize_solve_cube_cb,
+		        (wave_len > 1), false);
 
-		docube(process, &c);
+		for (i = 0; i < wave_len; i++) {
+			docube(process, &data.wave[i], &data.solves[i]);
+		}
 	}
+
+	if (data.wave) MEM_freeN(data.wave);
+	if (data.solves) MEM_freeN(data.solves);
+	MEM_freeN(data.bvh_queues);
 }
 
 /**
@@ -50,6 +50,8 @@
 #include "BLI_stack.h"
 #include "BLI_task.h"
 
+#include "atomic_ops.h"
+
 #include "BKE_customdata.h"
 #include "BKE_global.h"
 #include "BKE_mesh.h"
@@ -236,13 +238,32 @@ static void mesh_calc_normals_poly_accum_task_cb(void *userdata, const int pidx)
 			const float fac = saacos(-dot_v3v3(cur_edge, prev_edge));
 
 			/* accumulate */
-			madd_v3_v3fl(vnors[ml[i].v], pnor, fac);
+			float *vnor = vnors[ml[i].v];
+			/* atomics, several tasks may write to the same vertex at the same time
+			 * (much cheaper than a per-thread copy of the whole vnors array) */
+			atomic_add_fl(&vnor[0], pnor[0] * fac);
+			atomic_add_fl(&vnor[1], pnor[1] * fac);
+			atomic_add_fl(&vnor[2], pnor[2] * fac);
 			prev_edge = cur_edge;
 		}
 	}
 
 }
 
+static void mesh_calc_normals_poly_finalize_task_cb(void *userdata, const int vidx)
+{
+	MeshCalcNormalsData *data = userdata;
+	MVert *mv = &data->mverts[vidx];
+	float *no = data->vnors[vidx];
+
+	if (UNLIKELY(normalize_v3(no) == 0.0f)) {
+		/* following Mesh convention; we use vertex coordinate itself for normal in this case */
+		normalize_v3_v3(no, mv->co);
+	}
+
+	normal_float_to_short_v3(mv->no, no);
+}
+
 void BKE_mesh_calc_normals_poly(
         MVert *mverts, float (*r_vertnors)[3], int numVerts,
         const MLoop *mloop, const MPoly *mpolys,
@@ -252,7 +273,6 @@ void BKE_mesh_calc_normals_poly(
 	float (*pnors)[3] = r_polynors;
 	float (*vnors)[3] = r_vertnors;
 	bool free_vnors = false;
-	int i;
 
 	if (only_face_normals) {
 		BLI_assert((pnors != NULL) || (numPolys == 0));
@@ -281,17 +301,7 @@ void BKE_mesh_calc_normals_poly(
 
 	BLI_task_parallel_range(0, numPolys, &data, mesh_calc_normals_poly_accum_task_cb, (numPolys > BKE_MESH_OMP_LIMIT));
 
-	for (i = 0; i < numVerts; i++) {
-		MVert *mv = &mverts[i];
-		float *no = vnors[i];
-
-		if (UNLIKELY(normalize_v3(no) == 0.0f)) {
-			/* following Mesh convention; we use vertex coordinate itself for normal in this case */
-			normalize_v3_v3(no, mv->co);
-		}
-
-		normal_float_to_short_v3(mv->no, no);
-	}
+	BLI_task_parallel_range(0, numVerts, &data, mesh_calc_normals_poly_finalize_task_cb, (numVerts > BKE_MESH_OMP_LIMIT));
 
 	if (free_vnors) {
 		MEM_freeN(vnors);
@@ -1142,6 +1152,36 @@ static void loop_split_generator(TaskPool * __restrict UNUSED(pool), void *taskd
  * Compute split normals, i.e. vertex normals associated with each poly (hence 'loop normals').
  * Useful to materialize sharp edges (or non-smooth faces) without actually modifying the geometry (splitting edges).
  */
+typedef struct LoopsNoSplitFillData {
+	const MPoly *mpolys;
+	const MLoop *mloops;
+	const MVert *mverts;
+	const float (*polynors)[3];
+	float (*loopnors)[3];
+	int *loop_to_poly;
+} LoopsNoSplitFillData;
+
+static void mesh_normals_loop_no_split_fill_task_cb(void *userdata, const int mp_index)
+{
+	LoopsNoSplitFillData *data = userdata;
+	const MPoly *mp = &data->mpolys[mp_index];
+	int ml_index = mp->loopstart;
+	const int ml_index_end = ml_index + mp->totloop;
+	const bool is_poly_flat = ((mp->flag & ME_SMOOTH) == 0);
+
+	for (; ml_index < ml_index_end; ml_index++) {
+		if (data->loop_to_poly) {
+			data->loop_to_poly[ml_index] = mp_index;
+		}
+		if (is_poly_flat) {
+			copy_v3_v3(data->loopnors[ml_index], data->polynors[mp_index]);
+		}
+		else {
+			normal_short_to_float_v3(data->loopnors[ml_index], data->mverts[data->mloops[ml_index].v].no);
+		}
+	}
+}
+
 void BKE_mesh_normals_loop_split(
         const MVert *mverts, const int numVerts, MEdge *medges, const int numEdges,
         MLoop *mloops, float (*r_loopnors)[3], const int numLoops,
@@ -1159,26 +1199,13 @@ void BKE_mesh_normals_loop_split(
 		 * since we may want to use lnors even when mesh's 'autosmooth' is disabled (see e.g. mesh mapping code).
 		 * As usual, we could handle that on case-by-case basis, but simpler to keep it well confined here.
 		 */
-		int mp_index;
-
-		for (mp_index = 0; mp_index < numPolys; mp_index++) {
-			MPoly *mp = &mpolys[mp_index];
-			int ml_index = mp->loopstart;
-			const int ml_index_end = ml_index + mp->totloop;
-			const bool is_poly_flat = ((mp->flag & ME_SMOOTH) == 0);
+		LoopsNoSplitFillData fill_data = {
+		    .mpolys = mpolys, .mloops = mloops, .mverts = mverts,
+		    .polynors = polynors, .loopnors = r_loopnors, .loop_to_poly = r_loop_to_poly,
+		};
 
-			for (; ml_index < ml_index_end; ml_index++) {
-				if (r_loop_to_poly) {
-					r_loop_to_poly[ml_index] = mp_index;
-				}
-				if (is_poly_flat) {
-					copy_v3_v3(r_loopnors[ml_index], polynors[mp_index]);
-				}
-				else {
-					normal_short_to_float_v3(r_loopnors[ml_index], mverts[mloops[ml_index].v].no);
-				}
-			}
-		}
+		BLI_task_parallel_range(0, numPolys, &fill_data, mesh_normals_loop_no_split_fill_task_cb,
+		                        (numPolys > BKE_MESH_OMP_LIMIT));
 		return;
 	}
 
@@ -2721,132 +2748,158 @@ int BKE_mesh_recalc_tessellation(
 
 }
 
-/**
- * Calculate tessellation into #MLoopTri which exist only for this purpose.
- */
-void BKE_mesh_recalc_looptri(
-        const MLoop *mloop, const MPoly *mpoly,
-        const MVert *mvert,
-        int totloop, int totpoly,
-        MLoopTri *mlooptri)
-{
-	/* use this to avoid locking pthread for _every_ polygon
-	 * and calling the fill function */
+/* use this to avoid locking pthread for _every_ polygon
+ * and calling the fill function */
 
 #define USE_TESSFACE_SPEEDUP
 
-	const MPoly *mp;
+typedef struct MeshRecalcLooptriData {
+	const MLoop *mloop;
+	const MPoly *mpoly;
+	const MVert *mvert;
+	MLoopTri *mlooptri;
+	/** One arena per task scheduler thread for the ngon fills, created on first use. */
+	MemArena **arenas;
+} MeshRecalcLooptriData;
+
+static void mesh_recalc_looptri_task_cb(void *userdata, void *UNUSED(userdata_chunk),
+                                        const int poly_index, const int thread_id)
+{
+	MeshRecalcLooptriData *data = userdata;
+	const MLoop *mloop = data->mloop;
+	const MVert *mvert = data->mvert;
+	const MPoly *mp = &data->mpoly[poly_index];
 	const MLoop *ml;
 	MLoopTri *mlt;
-	MemArena *arena = NULL;
-	int poly_index, mlooptri_index;
+	const unsigned int mp_loopstart = (unsigned int)mp->loopstart;
+	const unsigned int mp_totloop = (unsigned int)mp->totloop;
+	/* polys before this one only create (loopstart - 2 * index) tessellated faces,
+	 * which makes the destination index independent of the other polys */
+	unsigned int mlooptri_index = (unsigned int)poly_to_tri_count(poly_index, mp->loopstart);
+	unsigned int l1, l2, l3;
 	unsigned int j;
 
-	mlooptri_index = 0;
-	mp = mpoly;
-	for (poly_index = 0; poly_index < totpoly; poly_index++, mp++) {
-		const unsigned int mp_loopstart = (unsigned int)mp->loopstart;
-		const unsigned int mp_totloop = (unsigned int)mp->totloop;
-		unsigned int l1, l2, l3;
-		if (mp_totloop < 3) {
-			/* do nothing */
-		}
+	if (mp_totloop < 3) {
+		/* do nothing */
+	}
 
 #ifdef USE_TESSFACE_SPEEDUP
 
 #define ML_TO_MLT(i1, i2, i3)  { \
-			mlt = &mlooptri[mlooptri_index]; \
-			l1 = mp_loopstart + i1; \
-			l2 = mp_loopstart + i2; \
-			l3 = mp_loopstart + i3; \
-			ARRAY_SET_ITEMS(mlt->tri, l1, l2, l3); \
-			mlt->poly = (unsigned int)poly_index; \
-		} ((void)0)
-
-		else if (mp_totloop == 3) {
-			ML_TO_MLT(0, 1, 2);
-			mlooptri_index++;
-		}
-		else if (mp_totloop == 4) {
-			ML_TO_MLT(0, 1, 2);
-			mlooptri_index++;
-			ML_TO_MLT(0, 2, 3);
-			mlooptri_index++;
-		}
+		mlt = &data->mlooptri[mlooptri_index]; \
+		l1 = mp_loopstart + i1; \
+		l2 = mp_loopstart + i2; \
+		l3 = mp_loopstart + i3; \
+		ARRAY_SET_ITEMS(mlt->tri, l1, l2, l3); \
+		mlt->poly = (unsigned int)poly_index; \
+	} ((void)0)
+
+	else if (mp_totloop == 3) {
+		ML_TO_MLT(0, 1, 2);
+	}
+	else if (mp_totloop == 4) {
+		ML_TO_MLT(0, 1, 2);
+		mlooptri_index++;
+		ML_TO_MLT(0, 2, 3);
+	}
 #endif /* USE_TESSFACE_SPEEDUP */
-		else {
-			const float *co_curr, *co_prev;
-
-			float normal[3];
+	else {
+		const float *co_curr, *co_prev;
 
-			float axis_mat[3][3];
-			float (*projverts)[2];
-			unsigned int (*tris)[3];
+		float normal[3];
 
-			const unsigned int totfilltri = mp_totloop - 2;
+		float axis_mat[3][3];
+		float (*projverts)[2];
+		unsigned int (*tris)[3];
 
-			if (UNLIKELY(arena == NULL)) {
-				arena = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, __func__);
-			}
+		const unsigned int totfilltri = mp_totloop - 2;
 
-			tris = BLI_memarena_alloc(arena, sizeof(*tris) * (size_t)totfilltri);
-			projverts = BLI_memarena_alloc(arena, sizeof(*projverts) * (size_t)mp_totloop);
+		MemArena *arena = data->arenas[thread_id];
+		if (UNLIKELY(arena == NULL)) {
+			arena = data->arenas[thread_id] = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, __func__);
+		}
 
-			zero_v3(normal);
+		tris = BLI_memarena_alloc(arena, sizeof(*tris) * (size_t)totfilltri);
+		projverts = BLI_memarena_alloc(arena, sizeof(*projverts) * (size_t)mp_totloop);
 
-			/* calc normal, flipped: to get a positive 2d cross product */
-			ml = mloop + mp_loopstart;
-			co_prev = mvert[ml[mp_totloop - 1].v].co;
-			for (j = 0; j < mp_totloop; j++, ml++) {
-				co_curr = mvert[ml->v].co;
-				add_newell_cross_v3_v3v3(normal, co_prev, co_curr);
-				co_prev = co_curr;
-			}
-			if (UNLIKELY(normalize_v3(normal) == 0.0f)) {
-				normal[2] = 1.0f;
-			}
+		zero_v3(normal);
 
-			/* project verts to 2d */
-			axis_dominant_v3_to_m3_negate(axis_mat, normal);
+		/* calc normal, flipped: to get a positive 2d cross product */
+		ml = mloop + mp_loopstart;
+		co_prev = mvert[ml[mp_totloop - 1].v].co;
+		for (j = 0; j < mp_totloop; j++, ml++) {
+			co_curr = mvert[ml->v].co;
+			add_newell_cross_v3_v3v3(normal, co_prev, co_curr);
+			co_prev = co_curr;
+		}
+		if (UNLIKELY(normalize_v3(normal) == 0.0f)) {
+			normal[2] = 1.0f;
+		}
 
-			ml = mloop + mp_loopstart;
-			for (j = 0; j < mp_totloop; j++, ml++) {
-				mul_v2_m3v3(projverts[j], axis_mat, mvert[ml->v].co);
-			}
+		/* project verts to 2d */
+		axis_dominant_v3_to_m3_negate(axis_mat, normal);
 
-			BLI_polyfill_calc_arena((const float (*)[2])projverts, mp_totloop, 1, tris, arena);
+		ml = mloop + mp_loopstart;
+		for (j = 0; j < mp_totloop; j++, ml++) {
+			mul_v2_m3v3(projverts[j], axis_mat, mvert[ml->v].co);
+		}
 
-			/* apply fill */
-			for (j = 0; j < totfilltri; j++) {
-				unsigned int *tri = tris[j];
+		BLI_polyfill_calc_arena((const float (*)[2])projverts, mp_totloop, 1, tris, arena);
 
-				mlt = &mlooptri[mlooptri_index];
+		/* apply fill */
+		for (j = 0; j < totfilltri; j++) {
+			unsigned int *tri = tris[j];
 
-				/* set loop indices, transformed to vert indices later */
-				l1 = mp_loopstart + tri[0];
-				l2 = mp_loopstart + tri[1];
-				l3 = mp_loopstart + tri[2];
+			mlt = &data->mlooptri[mlooptri_index];
 
-				ARRAY_SET_ITEMS(mlt->tri, l1, l2, l3);
-				mlt->poly = (unsigned int)poly_index;
+			/* set loop indices, transformed to vert indices later */
+			l1 = mp_loopstart + tri[0];
+			l2 = mp_loopstart + tri[1];
+			l3 = mp_loopstart + tri[2];
 
-				mlooptri_index++;
-			}
+			ARRAY_SET_ITEMS(mlt->tri, l1, l2, l3);
+			mlt->poly = (unsigned int)poly_index;
 
-			BLI_memarena_clear(arena);
+			mlooptri_index++;
 		}
-	}
 
-	if (arena) {
-		BLI_memarena_free(arena);
-		arena = NULL;
+		BLI_memarena_clear(arena);
 	}
-
-	BLI_assert(mlooptri_index == poly_to_tri_count(totpoly, totloop));
-	UNUSED_VARS_NDEBUG(totloop);
+}
 
 #undef USE_TESSFACE_SPEEDUP
 #undef ML_TO_MLT
+
+/**
+ * Calculate tessellation into #MLoopTri which exist only for this purpose.
+ */
+void BKE_mesh_recalc_looptri(
+        const MLoop *mloop, const MPoly *mpoly,
+        const MVert *mvert,
+        int totloop, int totpoly,
+        MLoopTri *mlooptri)
+{
+	TaskScheduler *task_scheduler = BLI_task_scheduler_get();
+	const int num_threads = BLI_task_scheduler_num_threads(task_scheduler);
+	MeshRecalcLooptriData data = {
+	    .mloop = mloop, .mpoly = mpoly, .mvert = mvert, .mlooptri = mlooptri,
+	};
+	int i;
+
+	data.arenas = MEM_callocN(sizeof(*data.arenas) * (size_t)num_threads, __func__);
+
+	/* ngon fill cost varies wildly between polys, use dynamic scheduling */
+	BLI_task_parallel_range_ex(0, totpoly, &data, NULL, 0, mesh_recalc_looptri_task_cb,
+	                           (totpoly > BKE_MESH_OMP_LIMIT), true);
+
+	for (i = 0; i < num_threads; i++) {
+		if (data.arenas[i]) {
+			BLI_memarena_free(data.arenas[i]);
+		}
+	}
+	MEM_freeN(data.arenas);
+
+	UNUSED_VARS(totloop);
 }
 
 /* -------------------------------------------------------------------- */
@@ -35,8 +35,13 @@
 #include "BLI_buffer.h"
 #include "BLI_utildefines.h"
 #include "BLI_bitmap.h"
+#include "BLI_linklist.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
+#include "BKE_DerivedMesh.h"
+#include "BKE_mesh.h"
 #include "BKE_mesh_mapping.h"
 #include "BKE_customdata.h"
 #include "BLI_memarena.h"
@@ -195,6 +200,51 @@ void BKE_mesh_uv_vert_map_free(UvVertMap *vmap)
  *
  * Wrapped by #BKE_mesh_vert_poly_map_create & BKE_mesh_vert_loop_map_create
  */
+typedef struct MeshVertPolyMapChunkData {
+	MeshElemMap *map;
+	const MPoly *mpoly;
+	const MLoop *mloop;
+	int *chunk_counts;
+	int totvert;
+	int totpoly;
+	int chunk_size;
+	bool do_loops;
+} MeshVertPolyMapChunkData;
+
+static void mesh_vert_poly_or_loop_map_count_cb(void *userdata, const int chunk)
+{
+	MeshVertPolyMapChunkData *data = userdata;
+	int *counts = data->chunk_counts + (size_t)chunk * (size_t)data->totvert;
+	const int pidx_end = min_ii((chunk + 1) * data->chunk_size, data->totpoly);
+	int i, j;
+
+	for (i = chunk * data->chunk_size; i < pidx_end; i++) {
+		const MPoly *p = &data->mpoly[i];
+
+		for (j = 0; j < p->totloop; j++)
+			counts[data->mloop[p->loopstart + j].v]++;
+	}
+}
+
+static void mesh_vert_poly_or_loop_map_fill_cb(void *userdata, const int chunk)
+{
+	MeshVertPolyMapChunkData *data = userdata;
+	/* exclusive offsets into each vertex' indices, see the scan pass */
+	int *offsets = data->chunk_counts + (size_t)chunk * (size_t)data->totvert;
+	const int pidx_end = min_ii((chunk + 1) * data->chunk_size, data->totpoly);
+	int i, j;
+
+	for (i = chunk * data->chunk_size; i < pidx_end; i++) {
+		const MPoly *p = &data->mpoly[i];
+
+		for (j = 0; j < p->totloop; j++) {
+			const unsigned int v = data->mloop[p->loopstart + j].v;
+
+			data->map[v].indices[offsets[v]++] = data->do_loops ? p->loopstart + j : i;
+		}
+	}
+}
+
 static void mesh_vert_poly_or_loop_map_create(
         MeshElemMap **r_map, int **r_mem,
         const MPoly *mpoly, const MLoop *mloop,
@@ -206,6 +256,56 @@ static void mesh_vert_poly_or_loop_map_create(
 
 	indices = index_iter = MEM_mallocN(sizeof(int) * (size_t)totloop, __func__);
 
+	if (totloop > BKE_MESH_OMP_LIMIT) {
+		/* Two-pass counting sort over poly chunks: per-chunk counts keep both
+		 * passes lock-free, and the serial scan in between makes the result
+		 * bit-identical to the serial code below (poly order per vertex). */
+		const int num_threads = BLI_task_scheduler_num_threads(BLI_task_scheduler_get());
+		const int chunk_size = (totpoly + num_threads - 1) / num_threads;
+		const int num_chunks = (totpoly + chunk_size - 1) / chunk_size;
+		int *chunk_counts = MEM_callocN(sizeof(int) * (size_t)totvert * (size_t)num_chunks, __func__);
+		MeshVertPolyMapChunkData data;
+		int c;
+
+		data.map = map;
+		data.mpoly = mpoly;
+		data.mloop = mloop;
+		data.chunk_counts = chunk_counts;
+		data.totvert = totvert;
+		data.totpoly = totpoly;
+		data.chunk_size = chunk_size;
+		data.do_loops = do_loops;
+
+		BLI_task_parallel_range(0, num_chunks, &data, mesh_vert_poly_or_loop_map_count_cb,
+		                        (num_chunks > 1));
+
+		/* Assign indices mem, and turn the per-chunk counts into exclusive
+		 * offsets into each vertex' indices for the fill pass. */
+		for (i = 0; i < totvert; i++) {
+			int tot = 0;
+
+			for (c = 0; c < num_chunks; c++) {
+				int *count = &chunk_counts[(size_t)c * (size_t)totvert + (size_t)i];
+				const int count_c = *count;
+				*count = tot;
+				tot += count_c;
+			}
+
+			map[i].indices = index_iter;
+			map[i].count = tot;
+			index_iter += tot;
+		}
+
+		BLI_task_parallel_range(0, num_chunks, &data, mesh_vert_poly_or_loop_map_fill_cb,
+		                        (num_chunks > 1));
+
+		MEM_freeN(chunk_counts);
+
+		*r_map = map;
+		*r_mem = indices;
+		return;
+	}
+
 	/* Count number of polys for each vertex */
 	for (i = 0; i < totpoly; i++) {
 		const MPoly *p = &mpoly[i];
@@ -483,6 +583,113 @@ void BKE_mesh_origindex_map_create_looptri(
 /** \} */
 
 
+/* -------------------------------------------------------------------- */
+
+/** \name Mesh Mapping Cache
+ *
+ * Stores built mappings on the DerivedMesh they were created from,
+ * mirroring the BVHCache in bvhutils.c.
+ *
+ * \{ */
+
+typedef struct MeshMappingCacheItem {
+	MeshElemMap *map;
+	int *mem;
+	int type;
+} MeshMappingCacheItem;
+
+static ThreadRWMutex cache_rwlock = BLI_RWLOCK_INITIALIZER;
+
+static MeshMappingCacheItem *mesh_mapping_cache_find(const MeshMappingCache *cache, const int type)
+{
+	while (cache) {
+		MeshMappingCacheItem *item = cache->link;
+		if (item->type == type) {
+			return item;
+		}
+		cache = cache->next;
+	}
+
+	return NULL;
+}
+
+/**
+ * Returns the requested mapping for \a dm's topology, building and caching it
+ * on the DM the first time it is requested. The returned map is owned by the
+ * DM, callers must not free it, and it stays valid as long as the DM does.
+ */
+const MeshElemMap *BKE_mesh_mapping_cached_get(DerivedMesh *dm, const int type)
+{
+	MeshMappingCacheItem *item;
+	MeshElemMap *map = NULL;
+	int *mem = NULL;
+
+	BLI_rw_mutex_lock(&cache_rwlock, THREAD_LOCK_READ);
+	item = mesh_mapping_cache_find(dm->mappingCache, type);
+	BLI_rw_mutex_unlock(&cache_rwlock);
+
+	if (item) {
+		return item->map;
+	}
+
+	switch (type) {
+		case MESH_MAPPING_VERT_POLY:
+			BKE_mesh_vert_poly_map_create(
+			        &map, &mem, dm->getPolyArray(dm), dm->getLoopArray(dm),
+			        dm->getNumVerts(dm), dm->getNumPolys(dm), dm->getNumLoops(dm));
+			break;
+		case MESH_MAPPING_VERT_LOOP:
+			BKE_mesh_vert_loop_map_create(
+			        &map, &mem, dm->getPolyArray(dm), dm->getLoopArray(dm),
+			        dm->getNumVerts(dm), dm->getNumPolys(dm), dm->getNumLoops(dm));
+			break;
+		case MESH_MAPPING_VERT_EDGE:
+			BKE_mesh_vert_edge_map_create(
+			        &map, &mem, dm->getEdgeArray(dm),
+			        dm->getNumVerts(dm), dm->getNumEdges(dm));
+			break;
+		default:
+			BLI_assert(0);
+			return NULL;
+	}
+
+	BLI_rw_mutex_lock(&cache_rwlock, THREAD_LOCK_WRITE);
+	item = mesh_mapping_cache_find(dm->mappingCache, type);
+	if (item == NULL) {
+		item = MEM_mallocN(sizeof(*item), __func__);
+		item->map = map;
+		item->mem = mem;
+		item->type = type;
+		BLI_linklist_prepend(&dm->mappingCache, item);
+	}
+	else {
+		/* Another thread built the same mapping in the meantime. */
+		MEM_freeN(map);
+		MEM_freeN(mem);
+	}
+	BLI_rw_mutex_unlock(&cache_rwlock);
+
+	return item->map;
+}
+
+static void mesh_mapping_cache_item_free(void *link)
+{
+	MeshMappingCacheItem *item = link;
+
+	MEM_freeN(item->map);
+	MEM_freeN(item->mem);
+	MEM_freeN(item);
+}
+
+void BKE_mesh_mapping_cache_free(MeshMappingCache **cache_p)
+{
+	BLI_linklist_free(*cache_p, mesh_mapping_cache_item_free);
+	*cache_p = NULL;
+}
+
+/** \} */
+
+
 /* -------------------------------------------------------------------- */
 
 /** \name Mesh loops/poly islands.
@@ -38,6 +38,8 @@
 #include "BLI_memarena.h"
 #include "BLI_polyfill2d.h"
 #include "BLI_rand.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "BKE_bvhutils.h"
 #include "BKE_customdata.h"
@@ -654,13 +656,10 @@ void BKE_mesh_remap_calc_edges_from_dm(
 		float tmp_co[3], tmp_no[3];
 
 		if (mode == MREMAP_MODE_EDGE_VERT_NEAREST) {
-			const int num_verts_src = dm_src->getNumVerts(dm_src);
-			const int num_edges_src = dm_src->getNumEdges(dm_src);
 			MEdge *edges_src = dm_src->getEdgeArray(dm_src);
 			float (*vcos_src)[3] = MEM_mallocN(sizeof(*vcos_src) * (size_t)dm_src->getNumVerts(dm_src), __func__);
 
-			MeshElemMap *vert_to_edge_src_map;
-			int         *vert_to_edge_src_map_mem;
+			const MeshElemMap *vert_to_edge_src_map;
 
 			struct {
 				float hit_dist;
@@ -671,8 +670,7 @@ void BKE_mesh_remap_calc_edges_from_dm(
 				v_dst_to_src_map[i].hit_dist = -1.0f;
 			}
 
-			BKE_mesh_vert_edge_map_create(&vert_to_edge_src_map, &vert_to_edge_src_map_mem,
-			                              edges_src, num_verts_src, num_edges_src);
+			vert_to_edge_src_map = BKE_mesh_mapping_cached_get(dm_src, MESH_MAPPING_VERT_EDGE);
 
 			dm_src->getVertCos(dm_src, vcos_src);
 
@@ -772,8 +770,6 @@ void BKE_mesh_remap_calc_edges_from_dm(
 
 			MEM_freeN(vcos_src);
 			MEM_freeN(v_dst_to_src_map);
-			MEM_freeN(vert_to_edge_src_map);
-			MEM_freeN(vert_to_edge_src_map_mem);
 		}
 		else if (mode == MREMAP_MODE_EDGE_NEAREST) {
 			bvhtree_from_mesh_edges(&treedata, dm_src, 0.0f, 2, 6);
@@ -1108,6 +1104,577 @@ static float mesh_remap_calc_loops_astar_f_cost(
 #define ASTAR_STEPS_MAX 64
 
 
+typedef struct LoopRemapThreadScratch {
+	IslandResult **islands_res;    /* One buffer per tree, sized for the biggest dest poly. */
+	BLI_AStarSolution as_solution;
+
+	/* Memory buffers for mesh_remap_interp_poly_data_get(). */
+	size_t buff_size_interp;
+	float (*vcos_interp)[3];
+	int *indices_interp;
+	float *weights_interp;
+} LoopRemapThreadScratch;
+
+typedef struct LoopRemapData {
+	int mode;
+	const SpaceTransform *space_transform;
+	float max_dist, max_dist_sq, ray_radius;
+
+	MVert *verts_dst;
+	MLoop *loops_dst;
+	MPoly *polys_dst;
+	float (*poly_nors_dst)[3];
+	float (*loop_nors_dst)[3];
+
+	MVert *verts_src;
+	MLoop *loops_src;
+	MPoly *polys_src;
+	float (*vcos_src)[3];
+	float (*poly_nors_src)[3];
+	float (*loop_nors_src)[3];
+	float (*poly_cents_src)[3];
+
+	const MeshElemMap *vert_to_loop_map_src;
+	const MeshElemMap *vert_to_poly_map_src;
+	MeshElemMap *poly_to_looptri_map_src;
+	int *loop_to_poly_map_src;
+	const MLoopTri *looptri_src;
+
+	bool use_from_vert, use_islands;
+	int num_trees;
+	int isld_steps_src;
+	BVHTreeFromMesh *treedata;
+	BLI_AStarGraph *as_graphdata;
+	MeshIslandStore *island_store;
+
+	LoopRemapThreadScratch *scratch;  /* One per task thread. */
+
+	MeshPairRemap *r_map;
+	SpinLock lock;  /* Guards r_map's memarena. */
+} LoopRemapData;
+
+/**
+ * Computes the mapping of all loops of one dest poly, see #BKE_mesh_remap_calc_loops_from_dm.
+ *
+ * All queried data is read-only here, except for \a r_map (guarded by \a data's spinlock)
+ * and this thread's own scratch buffers.
+ */
+static void mesh_remap_calc_loops_cb(void *userdata, void *UNUSED(userdata_chunk), const int pidx_dst, const int thread_id)
+{
+	LoopRemapData *data = userdata;
+	LoopRemapThreadScratch *scratch = &data->scratch[thread_id];
+
+	const int mode = data->mode;
+	const SpaceTransform *space_transform = data->space_transform;
+	const float max_dist = data->max_dist;
+	const float max_dist_sq = data->max_dist_sq;
+	const float ray_radius = data->ray_radius;
+	const float full_weight = 1.0f;
+	const bool use_from_vert = data->use_from_vert;
+	const bool use_islands = data->use_islands;
+	const int num_trees = data->num_trees;
+	const int isld_steps_src = data->isld_steps_src;
+
+	MVert *verts_dst = data->verts_dst;
+	MLoop *loops_dst = data->loops_dst;
+	MVert *verts_src = data->verts_src;
+	MLoop *loops_src = data->loops_src;
+	MPoly *polys_src = data->polys_src;
+
+	IslandResult **islands_res = scratch->islands_res;
+	BLI_AStarSolution *as_solution = &scratch->as_solution;
+	MeshPairRemap *r_map = data->r_map;
+
+	BVHTreeNearest nearest = {0};
+	BVHTreeRayHit rayhit = {0};
+	float hit_dist;
+	float tmp_co[3], tmp_no[3];
+
+	MPoly *mp_dst = &data->polys_dst[pidx_dst];
+	MLoop *ml_src, *ml_dst;
+	MPoly *mp_src;
+	int tindex, lidx_dst, plidx_dst, pidx_src, lidx_src, plidx_src;
+	int i;
+
+	float pnor_dst[3];
+
+	/* Only in use_from_vert case, we may need polys' centers as fallback in case we cannot decide which
+	 * corner to use from normals only. */
+	float pcent_dst[3];
+	bool pcent_dst_valid = false;
+
+	nearest.index = -1;
+
+	if (mode == MREMAP_MODE_LOOP_NEAREST_POLYNOR) {
+		copy_v3_v3(pnor_dst, data->poly_nors_dst[pidx_dst]);
+		if (space_transform) {
+			BLI_space_transform_apply_normal(space_transform, pnor_dst);
+		}
+	}
+
+	for (tindex = 0; tindex < num_trees; tindex++) {
+		BVHTreeFromMesh *tdata = &data->treedata[tindex];
+
+		ml_dst = &loops_dst[mp_dst->loopstart];
+		for (plidx_dst = 0; plidx_dst < mp_dst->totloop; plidx_dst++, ml_dst++) {
+			if (use_from_vert) {
+				const MeshElemMap *vert_to_refelem_map_src = NULL;
+
+				copy_v3_v3(tmp_co, verts_dst[ml_dst->v].co);
+				nearest.index = -1;
+
+				/* Convert the vertex to tree coordinates, if needed. */
+				if (space_transform) {
+					BLI_space_transform_apply(space_transform, tmp_co);
+				}
+
+				if (mesh_remap_bvhtree_query_nearest(tdata, &nearest, tmp_co, max_dist_sq, &hit_dist)) {
+					float (*nor_dst)[3];
+					float (*nors_src)[3];
+					float best_nor_dot = -2.0f;
+					float best_sqdist_fallback = FLT_MAX;
+					int best_index_src = -1;
+
+					if (mode == MREMAP_MODE_LOOP_NEAREST_LOOPNOR) {
+						copy_v3_v3(tmp_no, data->loop_nors_dst[plidx_dst + mp_dst->loopstart]);
+						if (space_transform) {
+							BLI_space_transform_apply_normal(space_transform, tmp_no);
+						}
+						nor_dst = &tmp_no;
+						nors_src = data->loop_nors_src;
+						vert_to_refelem_map_src = data->vert_to_loop_map_src;
+					}
+					else {  /* if (mode == MREMAP_MODE_LOOP_NEAREST_POLYNOR) { */
+						nor_dst = &pnor_dst;
+						nors_src = data->poly_nors_src;
+						vert_to_refelem_map_src = data->vert_to_poly_map_src;
+					}
+
+					for (i = vert_to_refelem_map_src[nearest.index].count; i--;) {
+						const int index_src = vert_to_refelem_map_src[nearest.index].indices[i];
+						const float dot = dot_v3v3(nors_src[index_src], *nor_dst);
+
+						pidx_src = (mode == MREMAP_MODE_LOOP_NEAREST_LOOPNOR) ?
+						               data->loop_to_poly_map_src[index_src] : index_src;
+						/* WARNING! This is not the *real* lidx_src in case of POLYNOR, we only use it
+						 *          to check we stay on current island (all loops from a given poly are
+						 *          on same island!). */
+						lidx_src = (mode == MREMAP_MODE_LOOP_NEAREST_LOOPNOR) ?
+						               index_src : polys_src[pidx_src].loopstart;
+
+						/* A same vert may be at the boundary of several islands! Hence, we have to ensure
+						 * poly/loop we are currently considering *belongs* to current island! */
+						if (use_islands && data->island_store->items_to_islands[lidx_src] != tindex) {
+							continue;
+						}
+
+						if (dot > best_nor_dot - 1e-6f) {
+							/* We need something as fallback decision in case dest normal matches several
+							 * source normals (see T44522), using distance between polys' centers here. */
+							float *pcent_src;
+							float sqdist;
+
+							mp_src = &polys_src[pidx_src];
+							ml_src = &loops_src[mp_src->loopstart];
+
+							if (!pcent_dst_valid) {
+								BKE_mesh_calc_poly_center(
+								            mp_dst, &loops_dst[mp_dst->loopstart], verts_dst, pcent_dst);
+								pcent_dst_valid = true;
+							}
+							pcent_src = data->poly_cents_src[pidx_src];
+							sqdist = len_squared_v3v3(pcent_dst, pcent_src);
+
+							if ((dot > best_nor_dot + 1e-6f) || (sqdist < best_sqdist_fallback)) {
+								best_nor_dot = dot;
+								best_sqdist_fallback = sqdist;
+								best_index_src = index_src;
+							}
+						}
+					}
+					if (mode == MREMAP_MODE_LOOP_NEAREST_POLYNOR) {
+						/* Our best_index_src is a poly one for now!
+						 * Have to find its loop matching our closest vertex. */
+						mp_src = &polys_src[best_index_src];
+						ml_src = &loops_src[mp_src->loopstart];
+						for (plidx_src = 0; plidx_src < mp_src->totloop; plidx_src++, ml_src++) {
+							if ((int)ml_src->v == nearest.index) {
+								best_index_src = plidx_src + mp_src->loopstart;
+								break;
+							}
+						}
+					}
+					best_nor_dot = (best_nor_dot + 1.0f) * 0.5f;
+					islands_res[tindex][plidx_dst].factor = hit_dist ? (best_nor_dot / hit_dist) : 1e18f;
+					islands_res[tindex][plidx_dst].hit_dist = hit_dist;
+					islands_res[tindex][plidx_dst].index_src = best_index_src;
+				}
+				else {
+					/* No source for this dest loop! */
+					islands_res[tindex][plidx_dst].factor = 0.0f;
+					islands_res[tindex][plidx_dst].hit_dist = FLT_MAX;
+					islands_res[tindex][plidx_dst].index_src = -1;
+				}
+			}
+			else if (mode & MREMAP_USE_NORPROJ) {
+				int n = (ray_radius > 0.0f) ? MREMAP_RAYCAST_APPROXIMATE_NR : 1;
+				float w = 1.0f;
+
+				copy_v3_v3(tmp_co, verts_dst[ml_dst->v].co);
+				copy_v3_v3(tmp_no, data->loop_nors_dst[plidx_dst + mp_dst->loopstart]);
+
+				/* We do our transform here, since we may do several raycast/nearest queries. */
+				if (space_transform) {
+					BLI_space_transform_apply(space_transform, tmp_co);
+					BLI_space_transform_apply_normal(space_transform, tmp_no);
+				}
+
+				while (n--) {
+					if (mesh_remap_bvhtree_query_raycast(
+					        tdata, &rayhit, tmp_co, tmp_no, ray_radius / w, max_dist, &hit_dist))
+					{
+						islands_res[tindex][plidx_dst].factor = (hit_dist ? (1.0f / hit_dist) : 1e18f) * w;
+						islands_res[tindex][plidx_dst].hit_dist = hit_dist;
+						islands_res[tindex][plidx_dst].index_src = (int)tdata->looptri[rayhit.index].poly;
+						copy_v3_v3(islands_res[tindex][plidx_dst].hit_point, rayhit.co);
+						break;
+					}
+					/* Next iteration will get bigger radius but smaller weight! */
+					w /= MREMAP_RAYCAST_APPROXIMATE_FAC;
+				}
+				if (n == -1) {
+					/* Fallback to 'nearest' hit here, loops usually comes in 'face group', not good to
+					 * have only part of one dest face's loops to map to source.
+					 * Note that since we give this a null weight, if whole weight for a given face
+					 * is null, it means none of its loop mapped to this source island, hence we can skip it
+					 * later.
+					 */
+					copy_v3_v3(tmp_co, verts_dst[ml_dst->v].co);
+					nearest.index = -1;
+
+					/* Convert the vertex to tree coordinates, if needed. */
+					if (space_transform) {
+						BLI_space_transform_apply(space_transform, tmp_co);
+					}
+
+					/* In any case, this fallback nearest hit should have no weight at all
+					 * in 'best island' decision! */
+					islands_res[tindex][plidx_dst].factor = 0.0f;
+
+					if (mesh_remap_bvhtree_query_nearest(tdata, &nearest, tmp_co, max_dist_sq, &hit_dist)) {
+						islands_res[tindex][plidx_dst].hit_dist = hit_dist;
+						islands_res[tindex][plidx_dst].index_src = (int)tdata->looptri[nearest.index].poly;
+						copy_v3_v3(islands_res[tindex][plidx_dst].hit_point, nearest.co);
+					}
+					else {
+						/* No source for this dest loop! */
+						islands_res[tindex][plidx_dst].hit_dist = FLT_MAX;
+						islands_res[tindex][plidx_dst].index_src = -1;
+					}
+				}
+			}
+			else {  /* Nearest poly either to use all its loops/verts or just closest one. */
+				copy_v3_v3(tmp_co, verts_dst[ml_dst->v].co);
+				nearest.index = -1;
+
+				/* Convert the vertex to tree coordinates, if needed. */
+				if (space_transform) {
+					BLI_space_transform_apply(space_transform, tmp_co);
+				}
+
+				if (mesh_remap_bvhtree_query_nearest(tdata, &nearest, tmp_co, max_dist_sq, &hit_dist)) {
+					islands_res[tindex][plidx_dst].factor = hit_dist ? (1.0f / hit_dist) : 1e18f;
+					islands_res[tindex][plidx_dst].hit_dist = hit_dist;
+					islands_res[tindex][plidx_dst].index_src = (int)tdata->looptri[nearest.index].poly;
+					copy_v3_v3(islands_res[tindex][plidx_dst].hit_point, nearest.co);
+				}
+				else {
+					/* No source for this dest loop! */
+					islands_res[tindex][plidx_dst].factor = 0.0f;
+					islands_res[tindex][plidx_dst].hit_dist = FLT_MAX;
+					islands_res[tindex][plidx_dst].index_src = -1;
+				}
+			}
+		}
+	}
+
+	/* And now, find best island to use! */
+	/* We have to first select the 'best source island' for given dst poly and its loops.
+	 * Then, we have to check that poly does not 'spread' across some island's limits
+	 * (like inner seams for UVs, etc.).
+	 * Note we only still partially support that kind of situation here, i.e. polys spreading over actual cracks
+	 * (like a narrow space without faces on src, splitting a 'tube-like' geometry). That kind of situation
+	 * should be relatively rare, though.
+	 */
+	{
+		BLI_AStarGraph *as_graph = NULL;
+		int *poly_island_index_map = NULL;
+		int pidx_src_prev = -1;
+
+		MeshElemMap *best_island = NULL;
+		float best_island_fac = 0.0f;
+		int best_island_index = -1;
+
+		for (tindex = 0; tindex < num_trees; tindex++) {
+			float island_fac = 0.0f;
+
+			for (plidx_dst = 0; plidx_dst < mp_dst->totloop; plidx_dst++) {
+				island_fac += islands_res[tindex][plidx_dst].factor;
+			}
+			island_fac /= (float)mp_dst->totloop;
+
+			if (island_fac > best_island_fac) {
+				best_island_fac = island_fac;
+				best_island_index = tindex;
+			}
+		}
+
+		if (best_island_index != -1 && isld_steps_src) {
+			best_island = use_islands ? data->island_store->islands[best_island_index] : NULL;
+			as_graph = &data->as_graphdata[best_island_index];
+			poly_island_index_map = (int *)as_graph->custom_data;
+			BLI_astar_solution_init(as_graph, as_solution, NULL);
+		}
+
+		for (plidx_dst = 0; plidx_dst < mp_dst->totloop; plidx_dst++) {
+			IslandResult *isld_res;
+			lidx_dst = plidx_dst + mp_dst->loopstart;
+
+			if (best_island_index == -1) {
+				/* No source for any loops of our dest poly in any source islands. */
+				BLI_spin_lock(&data->lock);
+				BKE_mesh_remap_item_define_invalid(r_map, lidx_dst);
+				BLI_spin_unlock(&data->lock);
+				continue;
+			}
+
+			as_solution->custom_data = SET_INT_IN_POINTER(false);
+
+			isld_res = &islands_res[best_island_index][plidx_dst];
+			if (use_from_vert) {
+				/* Indices stored in islands_res are those of loops, one per dest loop. */
+				lidx_src = isld_res->index_src;
+				if (lidx_src >= 0) {
+					pidx_src = data->loop_to_poly_map_src[lidx_src];
+					/* If prev and curr poly are the same, no need to do anything more!!! */
+					if (!ELEM(pidx_src_prev, -1, pidx_src) && isld_steps_src) {
+						int pidx_isld_src, pidx_isld_src_prev;
+						if (poly_island_index_map) {
+							pidx_isld_src = poly_island_index_map[pidx_src];
+							pidx_isld_src_prev = poly_island_index_map[pidx_src_prev];
+						}
+						else {
+							pidx_isld_src = pidx_src;
+							pidx_isld_src_prev = pidx_src_prev;
+						}
+
+						BLI_astar_graph_solve(
+						        as_graph, pidx_isld_src_prev, pidx_isld_src,
+						        mesh_remap_calc_loops_astar_f_cost, as_solution, isld_steps_src);
+						if (GET_INT_FROM_POINTER(as_solution->custom_data) && (as_solution->steps > 0)) {
+							/* Find first 'cutting edge' on path, and bring back lidx_src on poly just
+							 * before that edge.
+							 * Note we could try to be much smarter (like e.g. storing a whole poly's indices,
+							 * and making decision (on which side of cutting edge(s!) to be) on the end,
+							 * but this is one more level of complexity, better to first see if
+							 * simple solution works!
+							 */
+							int last_valid_pidx_isld_src = -1;
+							/* Note we go backward here, from dest to src poly. */
+							for (i = as_solution->steps - 1; i--;) {
+								BLI_AStarGNLink *as_link = as_solution->prev_links[pidx_isld_src];
+								const int eidx = GET_INT_FROM_POINTER(as_link->custom_data);
+								pidx_isld_src = as_solution->prev_nodes[pidx_isld_src];
+								BLI_assert(pidx_isld_src != -1);
+								if (eidx != -1) {
+									/* we are 'crossing' a cutting edge. */
+									last_valid_pidx_isld_src = pidx_isld_src;
+								}
+							}
+							if (last_valid_pidx_isld_src != -1) {
+								/* Find a new valid loop in that new poly (nearest one for now).
+								 * Note we could be much more subtle here, again that's for later... */
+								int j;
+								float best_dist_sq = FLT_MAX;
+
+								ml_dst = &loops_dst[lidx_dst];
+								copy_v3_v3(tmp_co, verts_dst[ml_dst->v].co);
+
+								/* We do our transform here, since we may do several raycast/nearest queries. */
+								if (space_transform) {
+									BLI_space_transform_apply(space_transform, tmp_co);
+								}
+
+								pidx_src = use_islands ? best_island->indices[last_valid_pidx_isld_src] :
+								                         last_valid_pidx_isld_src;
+								mp_src = &polys_src[pidx_src];
+								ml_src = &loops_src[mp_src->loopstart];
+								for (j = 0; j < mp_src->totloop; j++, ml_src++) {
+									const float dist_sq = len_squared_v3v3(verts_src[ml_src->v].co, tmp_co);
+									if (dist_sq < best_dist_sq) {
+										best_dist_sq = dist_sq;
+										lidx_src = mp_src->loopstart + j;
+									}
+								}
+							}
+						}
+					}
+					BLI_spin_lock(&data->lock);
+					mesh_remap_item_define(
+					        r_map, lidx_dst, isld_res->hit_dist,
+					        best_island_index, 1, &lidx_src, &full_weight);
+					BLI_spin_unlock(&data->lock);
+					pidx_src_prev = pidx_src;
+				}
+				else {
+					/* No source for this loop in this island. */
+					/* TODO: would probably be better to get a source at all cost in best island anyway? */
+					BLI_spin_lock(&data->lock);
+					mesh_remap_item_define(
+					        r_map, lidx_dst, FLT_MAX,
+					        best_island_index, 0, NULL, NULL);
+					BLI_spin_unlock(&data->lock);
+				}
+			}
+			else {
+				/* Else, we use source poly, indices stored in islands_res are those of polygons. */
+				pidx_src = isld_res->index_src;
+				if (pidx_src >= 0) {
+					float *hit_co = isld_res->hit_point;
+					int best_loop_index_src;
+
+					mp_src = &polys_src[pidx_src];
+					/* If prev and curr poly are the same, no need to do anything more!!! */
+					if (!ELEM(pidx_src_prev, -1, pidx_src) && isld_steps_src) {
+						int pidx_isld_src, pidx_isld_src_prev;
+						if (poly_island_index_map) {
+							pidx_isld_src = poly_island_index_map[pidx_src];
+							pidx_isld_src_prev = poly_island_index_map[pidx_src_prev];
+						}
+						else {
+							pidx_isld_src = pidx_src;
+							pidx_isld_src_prev = pidx_src_prev;
+						}
+
+						BLI_astar_graph_solve(
+						        as_graph, pidx_isld_src_prev, pidx_isld_src,
+						        mesh_remap_calc_loops_astar_f_cost, as_solution, isld_steps_src);
+						if (GET_INT_FROM_POINTER(as_solution->custom_data) && (as_solution->steps > 0)) {
+							/* Find first 'cutting edge' on path, and bring back lidx_src on poly just
+							 * before that edge.
+							 * Note we could try to be much smarter (like e.g. storing a whole poly's indices,
+							 * and making decision (one which side of cutting edge(s!) to be on the end,
+							 * but this is one more level of complexity, better to first see if
+							 * simple solution works!
+							 */
+							int last_valid_pidx_isld_src = -1;
+							/* Note we go backward here, from dest to src poly. */
+							for (i = as_solution->steps - 1; i--;) {
+								BLI_AStarGNLink *as_link = as_solution->prev_links[pidx_isld_src];
+								int eidx = GET_INT_FROM_POINTER(as_link->custom_data);
+
+								pidx_isld_src = as_solution->prev_nodes[pidx_isld_src];
+								BLI_assert(pidx_isld_src != -1);
+								if (eidx != -1) {
+									/* we are 'crossing' a cutting edge. */
+									last_valid_pidx_isld_src = pidx_isld_src;
+								}
+							}
+							if (last_valid_pidx_isld_src != -1) {
+								/* Find a new valid loop in that new poly (nearest point on poly for now).
+								 * Note we could be much more subtle here, again that's for later... */
+								float best_dist_sq = FLT_MAX;
+								int j;
+
+								ml_dst = &loops_dst[lidx_dst];
+								copy_v3_v3(tmp_co, verts_dst[ml_dst->v].co);
+
+								/* We do our transform here, since we may do several raycast/nearest queries. */
+								if (space_transform) {
+									BLI_space_transform_apply(space_transform, tmp_co);
+								}
+
+								pidx_src = use_islands ? best_island->indices[last_valid_pidx_isld_src] :
+								                         last_valid_pidx_isld_src;
+								mp_src = &polys_src[pidx_src];
+
+								/* batched so big-ngon sources get the SIMD path */
+								for (j = 0; j < data->poly_to_looptri_map_src[pidx_src].count; j += 4) {
+									const int num = min_ii(data->poly_to_looptri_map_src[pidx_src].count - j, 4);
+									const float *tri_a[4], *tri_b[4], *tri_c[4];
+									float h[4][3];
+									int k;
+
+									for (k = 0; k < num; k++) {
+										const MLoopTri *lt =
+										        &data->looptri_src[data->poly_to_looptri_map_src[pidx_src].indices[j + k]];
+										tri_a[k] = data->vcos_src[loops_src[lt->tri[0]].v];
+										tri_b[k] = data->vcos_src[loops_src[lt->tri[1]].v];
+										tri_c[k] = data->vcos_src[loops_src[lt->tri[2]].v];
+									}
+									/* pad the last batch with the first triangle */
+									for (; k < 4; k++) {
+										tri_a[k] = tri_a[0];
+										tri_b[k] = tri_b[0];
+										tri_c[k] = tri_c[0];
+									}
+
+									closest_on_tri_to_point_v3_batch4(h, tmp_co, tri_a, tri_b, tri_c);
+
+									for (k = 0; k < num; k++) {
+										const float dist_sq = len_squared_v3v3(tmp_co, h[k]);
+										if (dist_sq < best_dist_sq) {
+											copy_v3_v3(hit_co, h[k]);
+											best_dist_sq = dist_sq;
+										}
+									}
+								}
+							}
+						}
+					}
+
+					if (mode == MREMAP_MODE_LOOP_POLY_NEAREST) {
+						mesh_remap_interp_poly_data_get(
+						        mp_src, loops_src, (const float (*)[3])data->vcos_src, hit_co,
+						        &scratch->buff_size_interp, &scratch->vcos_interp, true, &scratch->indices_interp,
+						        &scratch->weights_interp, false, &best_loop_index_src);
+
+						BLI_spin_lock(&data->lock);
+						mesh_remap_item_define(
+						        r_map, lidx_dst, isld_res->hit_dist,
+						        best_island_index, 1, &best_loop_index_src, &full_weight);
+						BLI_spin_unlock(&data->lock);
+					}
+					else {
+						const int sources_num = mesh_remap_interp_poly_data_get(
+						        mp_src, loops_src, (const float (*)[3])data->vcos_src, hit_co,
+						        &scratch->buff_size_interp, &scratch->vcos_interp, true, &scratch->indices_interp,
+						        &scratch->weights_interp, true, NULL);
+
+						BLI_spin_lock(&data->lock);
+						mesh_remap_item_define(
+						        r_map, lidx_dst,
+						        isld_res->hit_dist, best_island_index,
+						        sources_num, scratch->indices_interp, scratch->weights_interp);
+						BLI_spin_unlock(&data->lock);
+					}
+
+					pidx_src_prev = pidx_src;
+				}
+				else {
+					/* No source for this loop in this island. */
+					/* TODO: would probably be better to get a source at all cost in best island anyway? */
+					BLI_spin_lock(&data->lock);
+					mesh_remap_item_define(r_map, lidx_dst, FLT_MAX, best_island_index, 0, NULL, NULL);
+					BLI_spin_unlock(&data->lock);
+				}
+			}
+		}
+
+		BLI_astar_solution_clear(as_solution);
+	}
+}
+
 void BKE_mesh_remap_calc_loops_from_dm(
         const int mode, const SpaceTransform *space_transform, const float max_dist, const float ray_radius,
         MVert *verts_dst, const int numverts_dst, MEdge *edges_dst, const int numedges_dst,
@@ -1136,11 +1703,7 @@ void BKE_mesh_remap_calc_loops_from_dm(
 	}
 	else {
 		BVHTreeFromMesh *treedata = NULL;
-		BVHTreeNearest nearest = {0};
-		BVHTreeRayHit rayhit = {0};
 		int num_trees = 0;
-		float hit_dist;
-		float tmp_co[3], tmp_no[3];
 
 		const bool use_from_vert = (mode & MREMAP_USE_VERT);
 
@@ -1148,7 +1711,6 @@ void BKE_mesh_remap_calc_loops_from_dm(
 		bool use_islands = false;
 
 		BLI_AStarGraph *as_graphdata = NULL;
-		BLI_AStarSolution as_solution = {0};
 		const int isld_steps_src = islands_precision_src ?
 		                           max_ii((int)(ASTAR_STEPS_MAX * islands_precision_src + 0.499f), 1) : 0;
 
@@ -1159,10 +1721,8 @@ void BKE_mesh_remap_calc_loops_from_dm(
 
 		float (*poly_cents_src)[3] = NULL;
 
-		MeshElemMap *vert_to_loop_map_src = NULL;
-		int *vert_to_loop_map_src_buff = NULL;
-		MeshElemMap *vert_to_poly_map_src = NULL;
-		int *vert_to_poly_map_src_buff = NULL;
+		const MeshElemMap *vert_to_loop_map_src = NULL;
+		const MeshElemMap *vert_to_poly_map_src = NULL;
 		MeshElemMap *edge_to_poly_map_src = NULL;
 		int *edge_to_poly_map_src_buff = NULL;
 		MeshElemMap *poly_to_looptri_map_src = NULL;
@@ -1188,16 +1748,10 @@ void BKE_mesh_remap_calc_loops_from_dm(
 		const MLoopTri *looptri_src = NULL;
 		int num_looptri_src = 0;
 
-		size_t buff_size_interp = MREMAP_DEFAULT_BUFSIZE;
-		float (*vcos_interp)[3] = NULL;
-		int *indices_interp = NULL;
-		float *weights_interp = NULL;
-
-		MLoop *ml_src, *ml_dst;
-		MPoly *mp_src, *mp_dst;
-		int tindex, pidx_dst, lidx_dst, plidx_dst, pidx_src, lidx_src, plidx_src;
+		MLoop *ml_src;
+		MPoly *mp_src;
+		int tindex, pidx_dst, pidx_src, lidx_src, plidx_src;
 
-		IslandResult **islands_res;
 		size_t islands_res_buff_size = MREMAP_DEFAULT_BUFSIZE;
 
 		const float bvh_epsilon = (mode & MREMAP_USE_NORPROJ) ? MREMAP_RAYCAST_APPROXIMATE_BVHEPSILON(ray_radius) : 0.0f;
@@ -1205,10 +1759,6 @@ void BKE_mesh_remap_calc_loops_from_dm(
 		if (!use_from_vert) {
 			vcos_src = MEM_mallocN(sizeof(*vcos_src) * (size_t)num_verts_src, __func__);
 			dm_src->getVertCos(dm_src, vcos_src);
-
-			vcos_interp = MEM_mallocN(sizeof(*vcos_interp) * buff_size_interp, __func__);
-			indices_interp = MEM_mallocN(sizeof(*indices_interp) * buff_size_interp, __func__);
-			weights_interp = MEM_mallocN(sizeof(*weights_interp) * buff_size_interp, __func__);
 		}
 
 		{
@@ -1259,11 +1809,9 @@ void BKE_mesh_remap_calc_loops_from_dm(
 		}
 
 		if (use_from_vert) {
-			BKE_mesh_vert_loop_map_create(&vert_to_loop_map_src, &vert_to_loop_map_src_buff,
-			                              polys_src, loops_src, num_verts_src, num_polys_src, num_loops_src);
+			vert_to_loop_map_src = BKE_mesh_mapping_cached_get(dm_src, MESH_MAPPING_VERT_LOOP);
 			if (mode & MREMAP_USE_POLY) {
-				BKE_mesh_vert_poly_map_create(&vert_to_poly_map_src, &vert_to_poly_map_src_buff,
-				                              polys_src, loops_src, num_verts_src, num_polys_src, num_loops_src);
+				vert_to_poly_map_src = BKE_mesh_mapping_cached_get(dm_src, MESH_MAPPING_VERT_POLY);
 			}
 		}
 
@@ -1424,493 +1972,114 @@ void BKE_mesh_remap_calc_loops_from_dm(
 			}
 		}
 
-		/* And check each dest poly! */
-		islands_res = MEM_mallocN(sizeof(*islands_res) * (size_t)num_trees, __func__);
-		for (tindex = 0; tindex < num_trees; tindex++) {
-			islands_res[tindex] = MEM_mallocN(sizeof(**islands_res) * islands_res_buff_size, __func__);
-		}
-
-		for (pidx_dst = 0, mp_dst = polys_dst; pidx_dst < numpolys_dst; pidx_dst++, mp_dst++) {
-			float pnor_dst[3];
-
-			/* Only in use_from_vert case, we may need polys' centers as fallback in case we cannot decide which
-			 * corner to use from normals only. */
-			float pcent_dst[3];
-			bool pcent_dst_valid = false;
-
-			if (mode == MREMAP_MODE_LOOP_NEAREST_POLYNOR) {
-				copy_v3_v3(pnor_dst, poly_nors_dst[pidx_dst]);
-				if (space_transform) {
-					BLI_space_transform_apply_normal(space_transform, pnor_dst);
+		/* And check each dest poly (parallel over dest polys, each worker using its own scratch)! */
+		{
+			TaskScheduler *task_scheduler = BLI_task_scheduler_get();
+			const int num_scratch = BLI_task_scheduler_num_threads(task_scheduler) + 1;
+			LoopRemapData data;
+			int sidx;
+
+			/* Size the per-thread result buffers for the biggest dest poly up-front,
+			 * workers cannot grow them. */
+			for (pidx_dst = 0; pidx_dst < numpolys_dst; pidx_dst++) {
+				if ((size_t)polys_dst[pidx_dst].totloop > islands_res_buff_size) {
+					islands_res_buff_size = (size_t)polys_dst[pidx_dst].totloop;
 				}
 			}
 
-			if ((size_t)mp_dst->totloop > islands_res_buff_size) {
-				islands_res_buff_size = (size_t)mp_dst->totloop + MREMAP_DEFAULT_BUFSIZE;
-				for (tindex = 0; tindex < num_trees; tindex++) {
-					islands_res[tindex] = MEM_reallocN(islands_res[tindex], sizeof(**islands_res) * islands_res_buff_size);
-				}
+			/* Lazy creation inside the workers would race. */
+			if (!use_from_vert && isld_steps_src && poly_to_looptri_map_src == NULL) {
+				BKE_mesh_origindex_map_create_looptri(
+				        &poly_to_looptri_map_src, &poly_to_looptri_map_src_buff,
+				        polys_src, num_polys_src,
+				        looptri_src, num_looptri_src);
 			}
 
-			for (tindex = 0; tindex < num_trees; tindex++) {
-				BVHTreeFromMesh *tdata = &treedata[tindex];
-
-				ml_dst = &loops_dst[mp_dst->loopstart];
-				for (plidx_dst = 0; plidx_dst < mp_dst->totloop; plidx_dst++, ml_dst++) {
-					if (use_from_vert) {
-						MeshElemMap *vert_to_refelem_map_src = NULL;
-
-						copy_v3_v3(tmp_co, verts_dst[ml_dst->v].co);
-						nearest.index = -1;
-
-						/* Convert the vertex to tree coordinates, if needed. */
-						if (space_transform) {
-							BLI_space_transform_apply(space_transform, tmp_co);
-						}
-
-						if (mesh_remap_bvhtree_query_nearest(tdata, &nearest, tmp_co, max_dist_sq, &hit_dist)) {
-							float (*nor_dst)[3];
-							float (*nors_src)[3];
-							float best_nor_dot = -2.0f;
-							float best_sqdist_fallback = FLT_MAX;
-							int best_index_src = -1;
-
-							if (mode == MREMAP_MODE_LOOP_NEAREST_LOOPNOR) {
-								copy_v3_v3(tmp_no, loop_nors_dst[plidx_dst + mp_dst->loopstart]);
-								if (space_transform) {
-									BLI_space_transform_apply_normal(space_transform, tmp_no);
-								}
-								nor_dst = &tmp_no;
-								nors_src = loop_nors_src;
-								vert_to_refelem_map_src = vert_to_loop_map_src;
-							}
-							else {  /* if (mode == MREMAP_MODE_LOOP_NEAREST_POLYNOR) { */
-								nor_dst = &pnor_dst;
-								nors_src = poly_nors_src;
-								vert_to_refelem_map_src = vert_to_poly_map_src;
-							}
-
-							for (i = vert_to_refelem_map_src[nearest.index].count; i--;) {
-								const int index_src = vert_to_refelem_map_src[nearest.index].indices[i];
-								const float dot = dot_v3v3(nors_src[index_src], *nor_dst);
-
-								pidx_src = (mode == MREMAP_MODE_LOOP_NEAREST_LOOPNOR) ?
-								               loop_to_poly_map_src[index_src] : index_src;
-								/* WARNING! This is not the *real* lidx_src in case of POLYNOR, we only use it
-								 *          to check we stay on current island (all loops from a given poly are
-								 *          on same island!). */
-								lidx_src = (mode == MREMAP_MODE_LOOP_NEAREST_LOOPNOR) ?
-								               index_src : polys_src[pidx_src].loopstart;
-
-								/* A same vert may be at the boundary of several islands! Hence, we have to ensure
-								 * poly/loop we are currently considering *belongs* to current island! */
-								if (use_islands && island_store.items_to_islands[lidx_src] != tindex) {
-									continue;
-								}
-
-								if (dot > best_nor_dot - 1e-6f) {
-									/* We need something as fallback decision in case dest normal matches several
-									 * source normals (see T44522), using distance between polys' centers here. */
-									float *pcent_src;
-									float sqdist;
-
-									mp_src = &polys_src[pidx_src];
-									ml_src = &loops_src[mp_src->loopstart];
-
-									if (!pcent_dst_valid) {
-										BKE_mesh_calc_poly_center(
-										            mp_dst, &loops_dst[mp_dst->loopstart], verts_dst, pcent_dst);
-										pcent_dst_valid = true;
-									}
-									pcent_src = poly_cents_src[pidx_src];
-									sqdist = len_squared_v3v3(pcent_dst, pcent_src);
-
-									if ((dot > best_nor_dot + 1e-6f) || (sqdist < best_sqdist_fallback)) {
-										best_nor_dot = dot;
-										best_sqdist_fallback = sqdist;
-										best_index_src = index_src;
-									}
-								}
-							}
-							if (mode == MREMAP_MODE_LOOP_NEAREST_POLYNOR) {
-								/* Our best_index_src is a poly one for now!
-								 * Have to find its loop matching our closest vertex. */
-								mp_src = &polys_src[best_index_src];
-								ml_src = &loops_src[mp_src->loopstart];
-								for (plidx_src = 0; plidx_src < mp_src->totloop; plidx_src++, ml_src++) {
-									if ((int)ml_src->v == nearest.index) {
-										best_index_src = plidx_src + mp_src->loopstart;
-										break;
-									}
-								}
-							}
-							best_nor_dot = (best_nor_dot + 1.0f) * 0.5f;
-							islands_res[tindex][plidx_dst].factor = hit_dist ? (best_nor_dot / hit_dist) : 1e18f;
-							islands_res[tindex][plidx_dst].hit_dist = hit_dist;
-							islands_res[tindex][plidx_dst].index_src = best_index_src;
-						}
-						else {
-							/* No source for this dest loop! */
-							islands_res[tindex][plidx_dst].factor = 0.0f;
-							islands_res[tindex][plidx_dst].hit_dist = FLT_MAX;
-							islands_res[tindex][plidx_dst].index_src = -1;
-						}
-					}
-					else if (mode & MREMAP_USE_NORPROJ) {
-						int n = (ray_radius > 0.0f) ? MREMAP_RAYCAST_APPROXIMATE_NR : 1;
-						float w = 1.0f;
-
-						copy_v3_v3(tmp_co, verts_dst[ml_dst->v].co);
-						copy_v3_v3(tmp_no, loop_nors_dst[plidx_dst + mp_dst->loopstart]);
-
-						/* We do our transform here, since we may do several raycast/nearest queries. */
-						if (space_transform) {
-							BLI_space_transform_apply(space_transform, tmp_co);
-							BLI_space_transform_apply_normal(space_transform, tmp_no);
-						}
-
-						while (n--) {
-							if (mesh_remap_bvhtree_query_raycast(
-							        tdata, &rayhit, tmp_co, tmp_no, ray_radius / w, max_dist, &hit_dist))
-							{
-								islands_res[tindex][plidx_dst].factor = (hit_dist ? (1.0f / hit_dist) : 1e18f) * w;
-								islands_res[tindex][plidx_dst].hit_dist = hit_dist;
-								islands_res[tindex][plidx_dst].index_src = (int)tdata->looptri[rayhit.index].poly;
-								copy_v3_v3(islands_res[tindex][plidx_dst].hit_point, rayhit.co);
-								break;
-							}
-							/* Next iteration will get bigger radius but smaller weight! */
-							w /= MREMAP_RAYCAST_APPROXIMATE_FAC;
-						}
-						if (n == -1) {
-							/* Fallback to 'nearest' hit here, loops usually comes in 'face group', not good to
-							 * have only part of one dest face's loops to map to source.
-							 * Note that since we give this a null weight, if whole weight for a given face
-							 * is null, it means none of its loop mapped to this source island, hence we can skip it
-							 * later.
-							 */
-							copy_v3_v3(tmp_co, verts_dst[ml_dst->v].co);
-							nearest.index = -1;
-
-							/* Convert the vertex to tree coordinates, if needed. */
-							if (space_transform) {
-								BLI_space_transform_apply(space_transform, tmp_co);
-							}
-
-							/* In any case, this fallback nearest hit should have no weight at all
-							 * in 'best island' decision! */
-							islands_res[tindex][plidx_dst].factor = 0.0f;
-
-							if (mesh_remap_bvhtree_query_nearest(tdata, &nearest, tmp_co, max_dist_sq, &hit_dist)) {
-								islands_res[tindex][plidx_dst].hit_dist = hit_dist;
-								islands_res[tindex][plidx_dst].index_src = (int)tdata->looptri[nearest.index].poly;
-								copy_v3_v3(islands_res[tindex][plidx_dst].hit_point, nearest.co);
-							}
-							else {
-								/* No source for this dest loop! */
-								islands_res[tindex][plidx_dst].hit_dist = FLT_MAX;
-								islands_res[tindex][plidx_dst].index_src = -1;
-							}
-						}
-					}
-					else {  /* Nearest poly either to use all its loops/verts or just closest one. */
-						copy_v3_v3(tmp_co, verts_dst[ml_dst->v].co);
-						nearest.index = -1;
-
-						/* Convert the vertex to tree coordinates, if needed. */
-						if (space_transform) {
-							BLI_space_transform_apply(space_transform, tmp_co);
-						}
-
-						if (mesh_remap_bvhtree_query_nearest(tdata, &nearest, tmp_co, max_dist_sq, &hit_dist)) {
-							islands_res[tindex][plidx_dst].factor = hit_dist ? (1.0f / hit_dist) : 1e18f;
-							islands_res[tindex][plidx_dst].hit_dist = hit_dist;
-							islands_res[tindex][plidx_dst].index_src = (int)tdata->looptri[nearest.index].poly;
-							copy_v3_v3(islands_res[tindex][plidx_dst].hit_point, nearest.co);
-						}
-						else {
-							/* No source for this dest loop! */
-							islands_res[tindex][plidx_dst].factor = 0.0f;
-							islands_res[tindex][plidx_dst].hit_dist = FLT_MAX;
-							islands_res[tindex][plidx_dst].index_src = -1;
-						}
-					}
+			data.mode = mode;
+			data.space_transform = space_transform;
+			data.max_dist = max_dist;
+			data.max_dist_sq = max_dist_sq;
+			data.ray_radius = ray_radius;
+			data.verts_dst = verts_dst;
+			data.loops_dst = loops_dst;
+			data.polys_dst = polys_dst;
+			data.poly_nors_dst = poly_nors_dst;
+			data.loop_nors_dst = loop_nors_dst;
+			data.verts_src = verts_src;
+			data.loops_src = loops_src;
+			data.polys_src = polys_src;
+			data.vcos_src = vcos_src;
+			data.poly_nors_src = poly_nors_src;
+			data.loop_nors_src = loop_nors_src;
+			data.poly_cents_src = poly_cents_src;
+			data.vert_to_loop_map_src = vert_to_loop_map_src;
+			data.vert_to_poly_map_src = vert_to_poly_map_src;
+			data.poly_to_looptri_map_src = poly_to_looptri_map_src;
+			data.loop_to_poly_map_src = loop_to_poly_map_src;
+			data.looptri_src = looptri_src;
+			data.use_from_vert = use_from_vert;
+			data.use_islands = use_islands;
+			data.num_trees = num_trees;
+			data.isld_steps_src = isld_steps_src;
+			data.treedata = treedata;
+			data.as_graphdata = as_graphdata;
+			data.island_store = &island_store;
+			data.r_map = r_map;
+			BLI_spin_init(&data.lock);
+
+			data.scratch = MEM_callocN(sizeof(*data.scratch) * (size_t)num_scratch, __func__);
+			for (sidx = 0; sidx < num_scratch; sidx++) {
+				LoopRemapThreadScratch *scratch = &data.scratch[sidx];
+
+				scratch->islands_res = MEM_mallocN(sizeof(*scratch->islands_res) * (size_t)num_trees, __func__);
+				for (tindex = 0; tindex < num_trees; tindex++) {
+					scratch->islands_res[tindex] = MEM_mallocN(
+					        sizeof(**scratch->islands_res) * islands_res_buff_size, __func__);
+				}
+				if (!use_from_vert) {
+					scratch->buff_size_interp = MREMAP_DEFAULT_BUFSIZE;
+					scratch->vcos_interp = MEM_mallocN(sizeof(*scratch->vcos_interp) * scratch->buff_size_interp, __func__);
+					scratch->indices_interp = MEM_mallocN(sizeof(*scratch->indices_interp) * scratch->buff_size_interp, __func__);
+					scratch->weights_interp = MEM_mallocN(sizeof(*scratch->weights_interp) * scratch->buff_size_interp, __func__);
 				}
 			}
 
-			/* And now, find best island to use! */
-			/* We have to first select the 'best source island' for given dst poly and its loops.
-			 * Then, we have to check that poly does not 'spread' across some island's limits
-			 * (like inner seams for UVs, etc.).
-			 * Note we only still partially support that kind of situation here, i.e. polys spreading over actual cracks
-			 * (like a narrow space without faces on src, splitting a 'tube-like' geometry). That kind of situation
-			 * should be relatively rare, though.
-			 */
-			/* XXX This block in itself is big and complex enough to be a separate function but... it uses a bunch
-			 *     of locale vars. Not worth sending all that through parameters (for now at least). */
-			{
-				BLI_AStarGraph *as_graph = NULL;
-				int *poly_island_index_map = NULL;
-				int pidx_src_prev = -1;
+			BLI_task_parallel_range_ex(
+			        0, numpolys_dst, &data, NULL, 0, mesh_remap_calc_loops_cb,
+			        (numpolys_dst > 512), false);
 
-				MeshElemMap *best_island = NULL;
-				float best_island_fac = 0.0f;
-				int best_island_index = -1;
+			for (sidx = 0; sidx < num_scratch; sidx++) {
+				LoopRemapThreadScratch *scratch = &data.scratch[sidx];
 
 				for (tindex = 0; tindex < num_trees; tindex++) {
-					float island_fac = 0.0f;
-
-					for (plidx_dst = 0; plidx_dst < mp_dst->totloop; plidx_dst++) {
-						island_fac += islands_res[tindex][plidx_dst].factor;
-					}
-					island_fac /= (float)mp_dst->totloop;
-
-					if (island_fac > best_island_fac) {
-						best_island_fac = island_fac;
-						best_island_index = tindex;
-					}
+					MEM_freeN(scratch->islands_res[tindex]);
 				}
-
-				if (best_island_index != -1 && isld_steps_src) {
-					best_island = use_islands ? island_store.islands[best_island_index] : NULL;
-					as_graph = &as_graphdata[best_island_index];
-					poly_island_index_map = (int *)as_graph->custom_data;
-					BLI_astar_solution_init(as_graph, &as_solution, NULL);
+				MEM_freeN(scratch->islands_res);
+				BLI_astar_solution_free(&scratch->as_solution);
+				if (scratch->vcos_interp) {
+					MEM_freeN(scratch->vcos_interp);
 				}
-
-				for (plidx_dst = 0; plidx_dst < mp_dst->totloop; plidx_dst++) {
-					IslandResult *isld_res;
-					lidx_dst = plidx_dst + mp_dst->loopstart;
-
-					if (best_island_index == -1) {
-						/* No source for any loops of our dest poly in any source islands. */
-						BKE_mesh_remap_item_define_invalid(r_map, lidx_dst);
-						continue;
-					}
-
-					as_solution.custom_data = SET_INT_IN_POINTER(false);
-
-					isld_res = &islands_res[best_island_index][plidx_dst];
-					if (use_from_vert) {
-						/* Indices stored in islands_res are those of loops, one per dest loop. */
-						lidx_src = isld_res->index_src;
-						if (lidx_src >= 0) {
-							pidx_src = loop_to_poly_map_src[lidx_src];
-							/* If prev and curr poly are the same, no need to do anything more!!! */
-							if (!ELEM(pidx_src_prev, -1, pidx_src) && isld_steps_src) {
-								int pidx_isld_src, pidx_isld_src_prev;
-								if (poly_island_index_map) {
-									pidx_isld_src = poly_island_index_map[pidx_src];
-									pidx_isld_src_prev = poly_island_index_map[pidx_src_prev];
-								}
-								else {
-									pidx_isld_src = pidx_src;
-									pidx_isld_src_prev = pidx_src_prev;
-								}
-
-								BLI_astar_graph_solve(
-								        as_graph, pidx_isld_src_prev, pidx_isld_src,
-								        mesh_remap_calc_loops_astar_f_cost, &as_solution, isld_steps_src);
-								if (GET_INT_FROM_POINTER(as_solution.custom_data) && (as_solution.steps > 0)) {
-									/* Find first 'cutting edge' on path, and bring back lidx_src on poly just
-									 * before that edge.
-									 * Note we could try to be much smarter (like e.g. storing a whole poly's indices,
-									 * and making decision (on which side of cutting edge(s!) to be) on the end,
-									 * but this is one more level of complexity, better to first see if
-									 * simple solution works!
-									 */
-									int last_valid_pidx_isld_src = -1;
-									/* Note we go backward here, from dest to src poly. */
-									for (i = as_solution.steps - 1; i--;) {
-										BLI_AStarGNLink *as_link = as_solution.prev_links[pidx_isld_src];
-										const int eidx = GET_INT_FROM_POINTER(as_link->custom_data);
-										pidx_isld_src = as_solution.prev_nodes[pidx_isld_src];
-										BLI_assert(pidx_isld_src != -1);
-										if (eidx != -1) {
-											/* we are 'crossing' a cutting edge. */
-											last_valid_pidx_isld_src = pidx_isld_src;
-										}
-									}
-									if (last_valid_pidx_isld_src != -1) {
-										/* Find a new valid loop in that new poly (nearest one for now).
-										 * Note we could be much more subtle here, again that's for later... */
-										int j;
-										float best_dist_sq = FLT_MAX;
-
-										ml_dst = &loops_dst[lidx_dst];
-										copy_v3_v3(tmp_co, verts_dst[ml_dst->v].co);
-
-										/* We do our transform here, since we may do several raycast/nearest queries. */
-										if (space_transform) {
-											BLI_space_transform_apply(space_transform, tmp_co);
-										}
-
-										pidx_src = use_islands ? best_island->indices[last_valid_pidx_isld_src] :
-										                         last_valid_pidx_isld_src;
-										mp_src = &polys_src[pidx_src];
-										ml_src = &loops_src[mp_src->loopstart];
-										for (j = 0; j < mp_src->totloop; j++, ml_src++) {
-											const float dist_sq = len_squared_v3v3(verts_src[ml_src->v].co, tmp_co);
-											if (dist_sq < best_dist_sq) {
-												best_dist_sq = dist_sq;
-												lidx_src = mp_src->loopstart + j;
-											}
-										}
-									}
-								}
-							}
-							mesh_remap_item_define(
-							        r_map, lidx_dst, isld_res->hit_dist,
-							        best_island_index, 1, &lidx_src, &full_weight);
-							pidx_src_prev = pidx_src;
-						}
-						else {
-							/* No source for this loop in this island. */
-							/* TODO: would probably be better to get a source at all cost in best island anyway? */
-							mesh_remap_item_define(
-							        r_map, lidx_dst, FLT_MAX,
-							        best_island_index, 0, NULL, NULL);
-						}
-					}
-					else {
-						/* Else, we use source poly, indices stored in islands_res are those of polygons. */
-						pidx_src = isld_res->index_src;
-						if (pidx_src >= 0) {
-							float *hit_co = isld_res->hit_point;
-							int best_loop_index_src;
-
-							mp_src = &polys_src[pidx_src];
-							/* If prev and curr poly are the same, no need to do anything more!!! */
-							if (!ELEM(pidx_src_prev, -1, pidx_src) && isld_steps_src) {
-								int pidx_isld_src, pidx_isld_src_prev;
-								if (poly_island_index_map) {
-									pidx_isld_src = poly_island_index_map[pidx_src];
-									pidx_isld_src_prev = poly_island_index_map[pidx_src_prev];
-								}
-								else {
-									pidx_isld_src = pidx_src;
-									pidx_isld_src_prev = pidx_src_prev;
-								}
-
-								BLI_astar_graph_solve(
-								        as_graph, pidx_isld_src_prev, pidx_isld_src,
-								        mesh_remap_calc_loops_astar_f_cost, &as_solution, isld_steps_src);
-								if (GET_INT_FROM_POINTER(as_solution.custom_data) && (as_solution.steps > 0)) {
-									/* Find first 'cutting edge' on path, and bring back lidx_src on poly just
-									 * before that edge.
-									 * Note we could try to be much smarter (like e.g. storing a whole poly's indices,
-									 * and making decision (one which side of cutting edge(s!) to be on the end,
-									 * but this is one more level of complexity, better to first see if
-									 * simple solution works!
-									 */
-									int last_valid_pidx_isld_src = -1;
-									/* Note we go backward here, from dest to src poly. */
-									for (i = as_solution.steps - 1; i--;) {
-										BLI_AStarGNLink *as_link = as_solution.prev_links[pidx_isld_src];
-										int eidx = GET_INT_FROM_POINTER(as_link->custom_data);
-
-										pidx_isld_src = as_solution.prev_nodes[pidx_isld_src];
-										BLI_assert(pidx_isld_src != -1);
-										if (eidx != -1) {
-											/* we are 'crossing' a cutting edge. */
-											last_valid_pidx_isld_src = pidx_isld_src;
-										}
-									}
-									if (last_valid_pidx_isld_src != -1) {
-										/* Find a new valid loop in that new poly (nearest point on poly for now).
-										 * Note we could be much more subtle here, again that's for later... */
-										float best_dist_sq = FLT_MAX;
-										int j;
-
-										ml_dst = &loops_dst[lidx_dst];
-										copy_v3_v3(tmp_co, verts_dst[ml_dst->v].co);
-
-										/* We do our transform here, since we may do several raycast/nearest queries. */
-										if (space_transform) {
-											BLI_space_transform_apply(space_transform, tmp_co);
-										}
-
-										pidx_src = use_islands ? best_island->indices[last_valid_pidx_isld_src] :
-										                         last_valid_pidx_isld_src;
-										mp_src = &polys_src[pidx_src];
-
-										/* Create that one on demand. */
-										if (poly_to_looptri_map_src == NULL) {
-											BKE_mesh_origindex_map_create_looptri(
-											        &poly_to_looptri_map_src, &poly_to_looptri_map_src_buff,
-											        polys_src, num_polys_src,
-											        looptri_src, num_looptri_src);
-										}
-
-										for (j = poly_to_looptri_map_src[pidx_src].count; j--;) {
-											float h[3];
-											const MLoopTri *lt = &looptri_src[poly_to_looptri_map_src[pidx_src].indices[j]];
-											float dist_sq;
-
-											closest_on_tri_to_point_v3(
-											        h, tmp_co,
-											        vcos_src[loops_src[lt->tri[0]].v],
-											        vcos_src[loops_src[lt->tri[1]].v],
-											        vcos_src[loops_src[lt->tri[2]].v]);
-											dist_sq = len_squared_v3v3(tmp_co, h);
-											if (dist_sq < best_dist_sq) {
-												copy_v3_v3(hit_co, h);
-												best_dist_sq = dist_sq;
-											}
-										}
-									}
-								}
-							}
-
-							if (mode == MREMAP_MODE_LOOP_POLY_NEAREST) {
-								mesh_remap_interp_poly_data_get(
-								        mp_src, loops_src, (const float (*)[3])vcos_src, hit_co,
-								        &buff_size_interp, &vcos_interp, true, &indices_interp,
-								        &weights_interp, false, &best_loop_index_src);
-
-								mesh_remap_item_define(
-								        r_map, lidx_dst, isld_res->hit_dist,
-								        best_island_index, 1, &best_loop_index_src, &full_weight);
-							}
-							else {
-								const int sources_num = mesh_remap_interp_poly_data_get(
-								        mp_src, loops_src, (const float (*)[3])vcos_src, hit_co,
-								        &buff_size_interp, &vcos_interp, true, &indices_interp,
-								        &weights_interp, true, NULL);
-
-								mesh_remap_item_define(
-								        r_map, lidx_dst,
-								        isld_res->hit_dist, best_island_index,
-								        sources_num, indices_interp, weights_interp);
-							}
-
-							pidx_src_prev = pidx_src;
-						}
-						else {
-							/* No source for this loop in this island. */
-							/* TODO: would probably be better to get a source at all cost in best island anyway? */
-							mesh_remap_item_define(r_map, lidx_dst, FLT_MAX, best_island_index, 0, NULL, NULL);
-						}
-					}
+				if (scratch->indices_interp) {
+					MEM_freeN(scratch->indices_interp);
+				}
+				if (scratch->weights_interp) {
+					MEM_freeN(scratch->weights_interp);
 				}
-
-				BLI_astar_solution_clear(&as_solution);
 			}
+			MEM_freeN(data.scratch);
+			BLI_spin_end(&data.lock);
 		}
 
 		for (tindex = 0; tindex < num_trees; tindex++) {
-			MEM_freeN(islands_res[tindex]);
 			free_bvhtree_from_mesh(&treedata[tindex]);
 			if (isld_steps_src) {
 				BLI_astar_graph_free(&as_graphdata[tindex]);
 			}
 		}
-		MEM_freeN(islands_res);
 		BKE_mesh_loop_islands_free(&island_store);
 		MEM_freeN(treedata);
 		if (isld_steps_src) {
 			MEM_freeN(as_graphdata);
-			BLI_astar_solution_free(&as_solution);
 		}
 
 		if (verts_allocated_src) {
@@ -1931,18 +2100,6 @@ void BKE_mesh_remap_calc_loops_from_dm(
 		if (looptri_allocated_src) {
 			MEM_freeN((void *)looptri_src);
 		}
-		if (vert_to_loop_map_src) {
-			MEM_freeN(vert_to_loop_map_src);
-		}
-		if (vert_to_loop_map_src_buff) {
-			MEM_freeN(vert_to_loop_map_src_buff);
-		}
-		if (vert_to_poly_map_src) {
-			MEM_freeN(vert_to_poly_map_src);
-		}
-		if (vert_to_poly_map_src_buff) {
-			MEM_freeN(vert_to_poly_map_src_buff);
-		}
 		if (edge_to_poly_map_src) {
 			MEM_freeN(edge_to_poly_map_src);
 		}
@@ -1961,15 +2118,6 @@ void BKE_mesh_remap_calc_loops_from_dm(
 		if (poly_cents_src) {
 			MEM_freeN(poly_cents_src);
 		}
-		if (vcos_interp) {
-			MEM_freeN(vcos_interp);
-		}
-		if (indices_interp) {
-			MEM_freeN(indices_interp);
-		}
-		if (weights_interp) {
-			MEM_freeN(weights_interp);
-		}
 	}
 }
 
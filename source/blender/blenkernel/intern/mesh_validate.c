@@ -39,6 +39,7 @@
 
 #include "BLI_utildefines.h"
 #include "BLI_edgehash.h"
+#include "BLI_sort.h"
 #include "BLI_math_base.h"
 #include "BLI_math_vector.h"
 
@@ -1282,7 +1283,7 @@ static void to_edgesort(struct EdgeSort *ed,
 	ed->is_draw = is_draw;
 }
 
-static int vergedgesort(const void *v1, const void *v2)
+static int vergedgesort(const void *v1, const void *v2, void *UNUSED(thunk))
 {
 	const struct EdgeSort *x1 = v1, *x2 = v2;
 
@@ -1343,7 +1344,7 @@ static void mesh_calc_edges_mdata(
 		}
 	}
 
-	qsort(edsort, totedge, sizeof(struct EdgeSort), vergedgesort);
+	BLI_qsort_parallel(edsort, (size_t)totedge, sizeof(struct EdgeSort), vergedgesort, NULL);
 
 	/* count final amount */
 	for (a = totedge, ed = edsort; a > 1; a--, ed++) {
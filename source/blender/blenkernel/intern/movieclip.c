@@ -537,6 +537,7 @@ static bool put_imbuf_cache(MovieClip *clip,
 		                                     moviecache_getprioritydata,
 		                                     moviecache_getitempriority,
 		                                     moviecache_prioritydeleter);
+		IMB_moviecache_set_priority_band(moviecache, MOVIECACHE_BAND_MOVIECLIP);
 
 		clip->cache->moviecache = moviecache;
 		clip->cache->sequence_offset = -1;
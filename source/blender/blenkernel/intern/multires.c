@@ -43,6 +43,7 @@
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_pbvh.h"
@@ -77,7 +78,9 @@ typedef enum {
 } DispOp;
 
 static void multires_mvert_to_ss(DerivedMesh *dm, MVert *mvert);
-static void multiresModifier_disp_run(DerivedMesh *dm, Mesh *me, DerivedMesh *dm2, DispOp op, CCGElem **oldGridData, int totlvl);
+static void multiresModifier_disp_run(
+        DerivedMesh *dm, Mesh *me, DerivedMesh *dm2, DispOp op, CCGElem **oldGridData, int totlvl,
+        const BLI_bitmap *grid_dirty);
 
 /** Customdata **/
 
@@ -371,6 +374,38 @@ void multires_mark_as_modified(Object *ob, MultiresModifiedFlags flags)
 		multires_dm_mark_as_modified(ob->derivedFinal, flags);
 }
 
+/**
+ * Grid-aware version of #multires_mark_as_modified, for callers (sculpt mode)
+ * which know exactly which grids they wrote to. Only marked grids have their
+ * mdisps recomputed on the next update.
+ *
+ * A NULL \a ccgdm->multires.grid_dirty bitmap means all grids are considered
+ * modified, so marking without grid info stays conservative: once the coords
+ * flag was set that way, tracking is not started anymore until the next update.
+ */
+void multires_mark_grids_as_modified(Object *ob, const int *grid_indices, int totgrid)
+{
+	CCGDerivedMesh *ccgdm;
+	int i;
+
+	if (!ob || !ob->derivedFinal)
+		return;
+
+	ccgdm = (CCGDerivedMesh *)ob->derivedFinal;
+
+	if (!ccgdm->multires.grid_dirty) {
+		if (ccgdm->multires.modified_flags & MULTIRES_COORDS_MODIFIED)
+			return;
+		ccgdm->multires.grid_dirty = BLI_BITMAP_NEW(ccgdm->dm.getNumGrids(&ccgdm->dm),
+		                                            "multires grid_dirty");
+	}
+
+	for (i = 0; i < totgrid; i++)
+		BLI_BITMAP_ENABLE(ccgdm->multires.grid_dirty, grid_indices[i]);
+
+	ccgdm->multires.modified_flags |= MULTIRES_COORDS_MODIFIED;
+}
+
 void multires_force_update(Object *ob)
 {
 	if (ob) {
@@ -871,7 +906,7 @@ void multiresModifier_base_apply(MultiresModifierData *mmd, Object *ob)
 	cddm->release(cddm);
 
 	/* calc disps */
-	multiresModifier_disp_run(dispdm, me, NULL, CALC_DISPLACEMENTS, origdm->getGridData(origdm), totlvl);
+	multiresModifier_disp_run(dispdm, me, NULL, CALC_DISPLACEMENTS, origdm->getGridData(origdm), totlvl, NULL);
 
 	origdm->release(origdm);
 	dispdm->release(dispdm);
@@ -944,7 +979,7 @@ static void multires_subdivide(MultiresModifierData *mmd, Object *ob, int totlvl
 		multires_reallocate_mdisps(me->totloop, mdisps, totlvl); 
 
 		/* compute displacements */
-		multiresModifier_disp_run(highdm, me, NULL, CALC_DISPLACEMENTS, subGridData, totlvl);
+		multiresModifier_disp_run(highdm, me, NULL, CALC_DISPLACEMENTS, subGridData, totlvl, NULL);
 
 		/* free */
 		highdm->release(highdm);
@@ -1005,7 +1040,111 @@ static void grid_tangent_matrix(float mat[3][3], const CCGKey *key,
 /* XXX WARNING: subsurf elements from dm and oldGridData *must* be of the same format (size),
  *              because this code uses CCGKey's info from dm to access oldGridData's normals
  *              (through the call to grid_tangent_matrix())! */
-static void multiresModifier_disp_run(DerivedMesh *dm, Mesh *me, DerivedMesh *dm2, DispOp op, CCGElem **oldGridData, int totlvl)
+typedef struct MultiresDispRunData {
+	DispOp op;
+	MPoly *mpoly;
+	MDisps *mdisps;
+	GridPaintMask *grid_paint_mask;
+	const BLI_bitmap *grid_dirty;
+	CCGElem **gridData;
+	CCGElem **subGridData;
+	CCGKey *key;
+	int *gridOffset;
+	int gridSize, dGridSize, dSkip;
+} MultiresDispRunData;
+
+static void multires_disp_run_cb(void *userdata, const int pidx)
+{
+	MultiresDispRunData *tdata = userdata;
+	const DispOp op = tdata->op;
+	CCGKey *key = tdata->key;
+	MPoly *mpoly = tdata->mpoly;
+	GridPaintMask *grid_paint_mask = tdata->grid_paint_mask;
+	const int gridSize = tdata->gridSize;
+	const int dGridSize = tdata->dGridSize;
+	const int dSkip = tdata->dSkip;
+	const int numVerts = mpoly[pidx].totloop;
+	int S, x, y, gIndex = tdata->gridOffset[pidx];
+
+	if (tdata->grid_dirty) {
+		/* Skip polys whose grids were not sculpted on since the last update.
+		 * Note this is checked per poly and not per grid, since all grids of
+		 * a poly get stitched together along their shared boundaries. */
+		for (S = 0; S < numVerts; ++S) {
+			if (BLI_BITMAP_TEST(tdata->grid_dirty, gIndex + S))
+				break;
+		}
+		if (S == numVerts)
+			return;
+	}
+
+	for (S = 0; S < numVerts; ++S, ++gIndex) {
+		GridPaintMask *gpm = grid_paint_mask ? &grid_paint_mask[gIndex] : NULL;
+		MDisps *mdisp = &tdata->mdisps[mpoly[pidx].loopstart + S];
+		CCGElem *grid = tdata->gridData[gIndex];
+		CCGElem *subgrid = tdata->subGridData[gIndex];
+		float (*dispgrid)[3] = mdisp->disps;
+
+		for (y = 0; y < gridSize; y++) {
+			for (x = 0; x < gridSize; x++) {
+				float *co = CCG_grid_elem_co(key, grid, x, y);
+				float *sco = CCG_grid_elem_co(key, subgrid, x, y);
+				float *data = dispgrid[dGridSize * y * dSkip + x * dSkip];
+				float mat[3][3], disp[3], d[3], mask;
+
+				/* construct tangent space matrix */
+				grid_tangent_matrix(mat, key, x, y, subgrid);
+
+				switch (op) {
+					case APPLY_DISPLACEMENTS:
+						/* Convert displacement to object space
+						 * and add to grid points */
+						mul_v3_m3v3(disp, mat, data);
+						add_v3_v3v3(co, sco, disp);
+						break;
+					case CALC_DISPLACEMENTS:
+						/* Calculate displacement between new and old
+						 * grid points and convert to tangent space */
+						sub_v3_v3v3(disp, co, sco);
+						invert_m3(mat);
+						mul_v3_m3v3(data, mat, disp);
+						break;
+					case ADD_DISPLACEMENTS:
+						/* Convert subdivided displacements to tangent
+						 * space and add to the original displacements */
+						invert_m3(mat);
+						mul_v3_m3v3(d, mat, co);
+						add_v3_v3(data, d);
+						break;
+				}
+
+				if (gpm) {
+					switch (op) {
+						case APPLY_DISPLACEMENTS:
+							/* Copy mask from gpm to DM */
+							*CCG_grid_elem_mask(key, grid, x, y) =
+							    paint_grid_paint_mask(gpm, key->level, x, y);
+							break;
+						case CALC_DISPLACEMENTS:
+							/* Copy mask from DM to gpm */
+							mask = *CCG_grid_elem_mask(key, grid, x, y);
+							gpm->data[y * gridSize + x] = CLAMPIS(mask, 0, 1);
+							break;
+						case ADD_DISPLACEMENTS:
+							/* Add mask displacement to gpm */
+							gpm->data[y * gridSize + x] +=
+							    *CCG_grid_elem_mask(key, grid, x, y);
+							break;
+					}
+				}
+			}
+		}
+	}
+}
+
+static void multiresModifier_disp_run(
+        DerivedMesh *dm, Mesh *me, DerivedMesh *dm2, DispOp op, CCGElem **oldGridData, int totlvl,
+        const BLI_bitmap *grid_dirty)
 {
 	CCGDerivedMesh *ccgdm = (CCGDerivedMesh *)dm;
 	CCGElem **gridData, **subGridData;
@@ -1013,10 +1152,11 @@ static void multiresModifier_disp_run(DerivedMesh *dm, Mesh *me, DerivedMesh *dm
 	MPoly *mpoly = me->mpoly;
 	MDisps *mdisps = CustomData_get_layer(&me->ldata, CD_MDISPS);
 	GridPaintMask *grid_paint_mask = NULL;
+	MultiresDispRunData data;
 	int *gridOffset;
-	int i, k, /*numGrids, */ gridSize, dGridSize, dSkip;
+	int i, /*numGrids, */ gridSize, dGridSize, dSkip;
 	int totloop, totpoly;
-	
+
 	/* this happens in the dm made by bmesh_mdisps_space_set */
 	if (dm2 && CustomData_has_layer(&dm2->loopData, CD_MDISPS)) {
 		mpoly = CustomData_get_layer(&dm2->polyData, CD_MPOLY);
@@ -1050,98 +1190,45 @@ static void multiresModifier_disp_run(DerivedMesh *dm, Mesh *me, DerivedMesh *dm
 	if (key.has_mask)
 		grid_paint_mask = CustomData_get_layer(&me->ldata, CD_GRID_PAINT_MASK);
 
-	k = 0; /*current loop/mdisp index within the mloop array*/
-
-#pragma omp parallel for private(i) if (totloop * gridSize * gridSize >= CCG_OMP_LIMIT)
-
-	for (i = 0; i < totpoly; ++i) {
-		const int numVerts = mpoly[i].totloop;
-		int S, x, y, gIndex = gridOffset[i];
-
-		for (S = 0; S < numVerts; ++S, ++gIndex, ++k) {
-			GridPaintMask *gpm = grid_paint_mask ? &grid_paint_mask[gIndex] : NULL;
-			MDisps *mdisp = &mdisps[mpoly[i].loopstart + S];
-			CCGElem *grid = gridData[gIndex];
-			CCGElem *subgrid = subGridData[gIndex];
-			float (*dispgrid)[3] = NULL;
-
-			/* when adding new faces in edit mode, need to allocate disps */
-			if (!mdisp->disps)
-#pragma omp critical
-			{
-				multires_reallocate_mdisps(totloop, mdisps, totlvl);
-			}
-
-			dispgrid = mdisp->disps;
-
-			/* if needed, reallocate multires paint mask */
-			if (gpm && gpm->level < key.level) {
+	/* When adding new faces in edit mode, need to allocate disps,
+	 * and lower level multires paint masks may need reallocating too.
+	 * Do both serially up front, so the task callbacks need no locking
+	 * (this used to be #pragma omp critical). */
+	for (i = 0; i < totloop; ++i) {
+		if (!mdisps[i].disps) {
+			multires_reallocate_mdisps(totloop, mdisps, totlvl);
+			break;
+		}
+	}
+	if (grid_paint_mask) {
+		for (i = 0; i < totloop; ++i) {
+			GridPaintMask *gpm = &grid_paint_mask[i];
+			if (gpm->level < key.level) {
 				gpm->level = key.level;
-#pragma omp critical
-				{
-					if (gpm->data)
-						MEM_freeN(gpm->data);
-					gpm->data = MEM_callocN(sizeof(float) * key.grid_area, "gpm.data");
-				}
+				if (gpm->data)
+					MEM_freeN(gpm->data);
+				gpm->data = MEM_callocN(sizeof(float) * key.grid_area, "gpm.data");
 			}
+		}
+	}
 
-			for (y = 0; y < gridSize; y++) {
-				for (x = 0; x < gridSize; x++) {
-					float *co = CCG_grid_elem_co(&key, grid, x, y);
-					float *sco = CCG_grid_elem_co(&key, subgrid, x, y);
-					float *data = dispgrid[dGridSize * y * dSkip + x * dSkip];
-					float mat[3][3], disp[3], d[3], mask;
+	data.op = op;
+	data.mpoly = mpoly;
+	data.mdisps = mdisps;
+	data.grid_paint_mask = grid_paint_mask;
+	data.grid_dirty = grid_dirty;
+	data.gridData = gridData;
+	data.subGridData = subGridData;
+	data.key = &key;
+	data.gridOffset = gridOffset;
+	data.gridSize = gridSize;
+	data.dGridSize = dGridSize;
+	data.dSkip = dSkip;
 
-					/* construct tangent space matrix */
-					grid_tangent_matrix(mat, &key, x, y, subgrid);
+	BLI_task_parallel_range(0, totpoly, &data, multires_disp_run_cb,
+	                        (totloop * gridSize * gridSize >= CCG_TASK_LIMIT));
 
-					switch (op) {
-						case APPLY_DISPLACEMENTS:
-							/* Convert displacement to object space
-							 * and add to grid points */
-							mul_v3_m3v3(disp, mat, data);
-							add_v3_v3v3(co, sco, disp);
-							break;
-						case CALC_DISPLACEMENTS:
-							/* Calculate displacement between new and old
-							 * grid points and convert to tangent space */
-							sub_v3_v3v3(disp, co, sco);
-							invert_m3(mat);
-							mul_v3_m3v3(data, mat, disp);
-							break;
-						case ADD_DISPLACEMENTS:
-							/* Convert subdivided displacements to tangent
-							 * space and add to the original displacements */
-							invert_m3(mat);
-							mul_v3_m3v3(d, mat, co);
-							add_v3_v3(data, d);
-							break;
-					}
 
-					if (gpm) {
-						switch (op) {
-							case APPLY_DISPLACEMENTS:
-								/* Copy mask from gpm to DM */
-								*CCG_grid_elem_mask(&key, grid, x, y) =
-								    paint_grid_paint_mask(gpm, key.level, x, y);
-								break;
-							case CALC_DISPLACEMENTS:
-								/* Copy mask from DM to gpm */
-								mask = *CCG_grid_elem_mask(&key, grid, x, y);
-								gpm->data[y * gridSize + x] = CLAMPIS(mask, 0, 1);
-								break;
-							case ADD_DISPLACEMENTS:
-								/* Add mask displacement to gpm */
-								gpm->data[y * gridSize + x] +=
-								    *CCG_grid_elem_mask(&key, grid, x, y);
-								break;
-						}
-					}
-				}
-			}
-		}
-	}
-	
 	if (op == APPLY_DISPLACEMENTS) {
 		ccgSubSurf_stitchFaces(ccgdm->ss, 0, NULL, 0);
 		ccgSubSurf_updateNormals(ccgdm->ss, NULL, 0);
@@ -1226,7 +1313,7 @@ void multires_modifier_update_mdisps(struct DerivedMesh *dm)
 			ccgSubSurf_updateLevels(ss, lvl, NULL, 0);
 
 			/* add to displacements */
-			multiresModifier_disp_run(highdm, me, NULL, ADD_DISPLACEMENTS, subGridData, mmd->totlvl);
+			multiresModifier_disp_run(highdm, me, NULL, ADD_DISPLACEMENTS, subGridData, mmd->totlvl, NULL);
 
 			/* free */
 			highdm->release(highdm);
@@ -1245,10 +1332,17 @@ void multires_modifier_update_mdisps(struct DerivedMesh *dm)
 			subdm = subsurf_dm_create_local(ob, cddm, mmd->totlvl, mmd->simple, 0, mmd->flags & eMultiresModifierFlag_PlainUv, has_mask);
 			cddm->release(cddm);
 
-			multiresModifier_disp_run(dm, me, NULL, CALC_DISPLACEMENTS, subdm->getGridData(subdm), mmd->totlvl);
+			multiresModifier_disp_run(dm, me, NULL, CALC_DISPLACEMENTS, subdm->getGridData(subdm), mmd->totlvl,
+			                          ccgdm->multires.grid_dirty);
 
 			subdm->release(subdm);
 		}
+
+		/* all grids are in sync with the mdisps again */
+		if (ccgdm->multires.grid_dirty) {
+			MEM_freeN(ccgdm->multires.grid_dirty);
+			ccgdm->multires.grid_dirty = NULL;
+		}
 	}
 }
 
@@ -1474,7 +1568,7 @@ DerivedMesh *multires_make_derived_from_derived(DerivedMesh *dm,
 	CustomData_external_read(&me->ldata, &me->id, CD_MASK_MDISPS, me->totloop);
 
 	/*run displacement*/
-	multiresModifier_disp_run(result, ob->data, dm, APPLY_DISPLACEMENTS, subGridData, mmd->totlvl);
+	multiresModifier_disp_run(result, ob->data, dm, APPLY_DISPLACEMENTS, subGridData, mmd->totlvl, NULL);
 
 	/* copy hidden elements for this level */
 	if (ccgdm)
@@ -2174,8 +2268,60 @@ static void multires_sync_levels(Scene *scene, Object *ob_src, Object *ob_dst)
 	}
 }
 
+typedef struct MultiresApplySmatData {
+	MPoly *mpoly;
+	MDisps *mdisps;
+	CCGElem **gridData;
+	CCGElem **subGridData;
+	CCGKey *dm_key;
+	CCGKey *subdm_key;
+	int *gridOffset;
+	float (*smat)[3];
+	int gridSize, dGridSize, dSkip;
+} MultiresApplySmatData;
+
+static void multires_apply_smat_cb(void *userdata, const int pidx)
+{
+	MultiresApplySmatData *tdata = userdata;
+	CCGKey *dm_key = tdata->dm_key;
+	CCGKey *subdm_key = tdata->subdm_key;
+	const int gridSize = tdata->gridSize;
+	const int dGridSize = tdata->dGridSize;
+	const int dSkip = tdata->dSkip;
+	const int numVerts = tdata->mpoly[pidx].totloop;
+	MDisps *mdisp = &tdata->mdisps[tdata->mpoly[pidx].loopstart];
+	int S, x, y, gIndex = tdata->gridOffset[pidx];
+
+	for (S = 0; S < numVerts; ++S, ++gIndex, mdisp++) {
+		CCGElem *grid = tdata->gridData[gIndex];
+		CCGElem *subgrid = tdata->subGridData[gIndex];
+		float (*dispgrid)[3] = mdisp->disps;
+
+		for (y = 0; y < gridSize; y++) {
+			for (x = 0; x < gridSize; x++) {
+				float *co = CCG_grid_elem_co(dm_key, grid, x, y);
+				float *sco = CCG_grid_elem_co(subdm_key, subgrid, x, y);
+				float *data = dispgrid[dGridSize * y * dSkip + x * dSkip];
+				float mat[3][3], disp[3];
+
+				/* construct tangent space matrix */
+				grid_tangent_matrix(mat, dm_key, x, y, grid);
+
+				/* scale subgrid coord and calculate displacement */
+				mul_m3_v3(tdata->smat, sco);
+				sub_v3_v3v3(disp, sco, co);
+
+				/* convert difference to tangent space */
+				invert_m3(mat);
+				mul_v3_m3v3(data, mat, disp);
+			}
+		}
+	}
+}
+
 static void multires_apply_smat(Scene *scene, Object *ob, float smat[3][3])
 {
+	MultiresApplySmatData data;
 	DerivedMesh *dm = NULL, *cddm = NULL, *subdm = NULL;
 	CCGElem **gridData, **subGridData;
 	CCGKey dm_key, subdm_key;
@@ -2226,38 +2372,20 @@ static void multires_apply_smat(Scene *scene, Object *ob, float smat[3][3])
 	dGridSize = multires_side_tot[high_mmd.totlvl];
 	dSkip = (dGridSize - 1) / (gridSize - 1);
 
-#pragma omp parallel for private(i) if (me->totloop * gridSize * gridSize >= CCG_OMP_LIMIT)
-	for (i = 0; i < me->totpoly; ++i) {
-		const int numVerts = mpoly[i].totloop;
-		MDisps *mdisp = &mdisps[mpoly[i].loopstart];
-		int S, x, y, gIndex = gridOffset[i];
-
-		for (S = 0; S < numVerts; ++S, ++gIndex, mdisp++) {
-			CCGElem *grid = gridData[gIndex];
-			CCGElem *subgrid = subGridData[gIndex];
-			float (*dispgrid)[3] = mdisp->disps;
-
-			for (y = 0; y < gridSize; y++) {
-				for (x = 0; x < gridSize; x++) {
-					float *co = CCG_grid_elem_co(&dm_key, grid, x, y);
-					float *sco = CCG_grid_elem_co(&subdm_key, subgrid, x, y);
-					float *data = dispgrid[dGridSize * y * dSkip + x * dSkip];
-					float mat[3][3], disp[3];
-
-					/* construct tangent space matrix */
-					grid_tangent_matrix(mat, &dm_key, x, y, grid);
-
-					/* scale subgrid coord and calculate displacement */
-					mul_m3_v3(smat, sco);
-					sub_v3_v3v3(disp, sco, co);
-
-					/* convert difference to tangent space */
-					invert_m3(mat);
-					mul_v3_m3v3(data, mat, disp);
-				}
-			}
-		}
-	}
+	data.mpoly = mpoly;
+	data.mdisps = mdisps;
+	data.gridData = gridData;
+	data.subGridData = subGridData;
+	data.dm_key = &dm_key;
+	data.subdm_key = &subdm_key;
+	data.gridOffset = gridOffset;
+	data.smat = smat;
+	data.gridSize = gridSize;
+	data.dGridSize = dGridSize;
+	data.dSkip = dSkip;
+
+	BLI_task_parallel_range(0, me->totpoly, &data, multires_apply_smat_cb,
+	                        (me->totloop * gridSize * gridSize >= CCG_TASK_LIMIT));
 
 	dm->release(dm);
 	subdm->release(subdm);
@@ -339,8 +339,12 @@ void BKE_object_free_derived_caches(Object *ob)
 		ob->derivedDeform->release(ob->derivedDeform);
 		ob->derivedDeform = NULL;
 	}
-	
+
+	DM_eval_fingerprint_object_remove(ob);
+
 	BKE_object_free_curve_cache(ob);
+
+	object_dupli_cache_free(ob);
 }
 
 void BKE_object_free_caches(Object *object)
@@ -470,6 +474,8 @@ void BKE_object_free_ex(Object *ob, bool do_id_user)
 		MEM_freeN(ob->curve_cache);
 	}
 
+	object_dupli_cache_free(ob);
+
 	BKE_previewimg_free(&ob->preview);
 }
 
@@ -1337,6 +1343,7 @@ ParticleSystem *BKE_object_copy_particlesystem(ParticleSystem *psys)
 	psysn->effectors = NULL;
 	psysn->tree = NULL;
 	psysn->bvhtree = NULL;
+	psysn->sph_grid = NULL;
 	
 	BLI_listbase_clear(&psysn->pathcachebufs);
 	BLI_listbase_clear(&psysn->childcachebufs);
@@ -1573,6 +1580,7 @@ Object *BKE_object_copy_ex(Main *bmain, Object *ob, bool copy_caches)
 
 	/* Copy runtime surve data. */
 	obn->curve_cache = NULL;
+	obn->dupli_cache = NULL;
 
 	if (ob->id.lib) {
 		BKE_id_lib_local_paths(bmain, ob->id.lib, &obn->id);
@@ -32,6 +32,7 @@
 #include <limits.h>
 #include <stdlib.h>
 #include <stddef.h>
+#include <string.h>
 
 #include "MEM_guardedalloc.h"
 
@@ -40,6 +41,9 @@
 
 #include "BLI_math.h"
 #include "BLI_rand.h"
+#include "BLI_task.h"
+
+#include "atomic_ops.h"
 
 #include "DNA_anim_types.h"
 #include "DNA_group_types.h"
@@ -67,6 +71,77 @@
 
 /* Dupli-Geometry */
 
+/* ---- Chunked DupliObject storage ----
+ *
+ * DupliObject entries are bump-allocated from larger chunks owned by the list
+ * storage instead of one MEM_callocN per instance. With millions of duplis
+ * (heavy dupligroup/dupliface setups) per-entry allocation and freeing
+ * dominate the listing time. The public handle stays a ListBase of
+ * DupliObject so all iteration code is unaffected, only free_object_duplilist
+ * knows about the chunks.
+ */
+
+typedef struct DupliChunk {
+	struct DupliChunk *next, *prev;
+	int totdupli, size;
+	/* DupliObject array of 'size' entries follows the header in the same allocation */
+} DupliChunk;
+
+typedef struct DupliListStore {
+	ListBase base;         /* resulting list of DupliObject, must be first (the public handle) */
+	ListBase chunks;       /* DupliChunk blocks owning the DupliObject memory */
+	ListBase done_objects; /* LinkData of child objects flagged OB_DONE during generation */
+
+	/* caching on the duplicator object, see object_duplilist_ex */
+	bool cached;           /* owned by Object.dupli_cache, free_object_duplilist keeps it */
+	char update;           /* 'update' argument the list was built with */
+	short eval_mode;       /* eval_ctx->mode the list was built for */
+	unsigned int generation; /* dupli_cache_generation value at build time */
+} DupliListStore;
+
+/* Caches are served again while this matches their stored generation, bumped
+ * by dependency graph tagging and frame changes so unchanged instancing
+ * setups are not rebuilt on every viewport redraw or render sync. Stale
+ * caches are discarded lazily on the next lookup.
+ */
+static unsigned int dupli_cache_generation = 1;
+
+#define DUPLI_CHUNK_DEFAULT_SIZE 1024
+/* minimum element count before filling entries with multiple threads */
+#define DUPLI_PARALLEL_THRESHOLD 1024
+
+BLI_INLINE DupliObject *dupli_chunk_data(DupliChunk *chunk)
+{
+	return (DupliObject *)(chunk + 1);
+}
+
+/* grab 'count' contiguous zeroed entries, they are not linked into the list yet */
+static DupliObject *dupli_store_alloc(DupliListStore *store, int count)
+{
+	DupliChunk *chunk = store->chunks.last;
+	DupliObject *dob;
+
+	if (chunk == NULL || chunk->size - chunk->totdupli < count) {
+		const int size = MAX2(count, DUPLI_CHUNK_DEFAULT_SIZE);
+		chunk = MEM_callocN(sizeof(DupliChunk) + sizeof(DupliObject) * (size_t)size, "DupliChunk");
+		chunk->size = size;
+		BLI_addtail(&store->chunks, chunk);
+	}
+
+	dob = dupli_chunk_data(chunk) + chunk->totdupli;
+	chunk->totdupli += count;
+
+	return dob;
+}
+
+/* streaming iterator state, see object_duplilist_iterate */
+typedef struct DupliIterator {
+	DupliObjectIterFunc func;
+	void *userdata;
+	DupliObject dob; /* single scratch entry handed out by make_dupli */
+	bool pending;    /* scratch entry is filled but not yet passed to func */
+} DupliIterator;
+
 typedef struct DupliContext {
 	EvaluationContext *eval_ctx;
 	bool do_update;
@@ -85,7 +160,9 @@ typedef struct DupliContext {
 	const struct DupliGenerator *gen;
 
 	/* result containers */
-	ListBase *duplilist; /* legacy doubly-linked list */
+	DupliListStore *store; /* chunked storage owning the DupliObject memory */
+	ListBase *duplilist;   /* legacy doubly-linked list (entries live in store) */
+	DupliIterator *iter;   /* streaming callback, used instead of a list */
 } DupliContext;
 
 typedef struct DupliGenerator {
@@ -115,7 +192,9 @@ static void init_context(DupliContext *r_ctx, EvaluationContext *eval_ctx, Scene
 
 	r_ctx->gen = get_dupli_generator(r_ctx);
 
+	r_ctx->store = NULL;
 	r_ctx->duplilist = NULL;
+	r_ctx->iter = NULL;
 }
 
 /* create sub-context for recursive duplis */
@@ -138,25 +217,15 @@ static void copy_dupli_context(DupliContext *r_ctx, const DupliContext *ctx, Obj
 	r_ctx->gen = get_dupli_generator(r_ctx);
 }
 
-/* generate a dupli instance
+/* fill in a dupli instance
  * mat is transform of the object relative to current context (including object obmat)
  */
-static DupliObject *make_dupli(const DupliContext *ctx,
-                               Object *ob, float mat[4][4], int index,
-                               bool animated, bool hide)
+static void make_dupli_at(const DupliContext *ctx, DupliObject *dob,
+                          Object *ob, float mat[4][4], int index,
+                          bool animated, bool hide)
 {
-	DupliObject *dob;
 	int i;
 
-	/* add a DupliObject instance to the result container */
-	if (ctx->duplilist) {
-		dob = MEM_callocN(sizeof(DupliObject), "dupli object");
-		BLI_addtail(ctx->duplilist, dob);
-	}
-	else {
-		return NULL;
-	}
-
 	dob->ob = ob;
 	mul_m4_m4m4(dob->mat, (float (*)[4])ctx->space_mat, mat);
 	dob->type = ctx->gen->type;
@@ -180,6 +249,36 @@ static DupliObject *make_dupli(const DupliContext *ctx,
 	 * scene, they will not show up at all, limitation that should be solved once. */
 	if (ob->type == OB_MBALL)
 		dob->no_draw = true;
+}
+
+/* generate a dupli instance in the result container */
+static DupliObject *make_dupli(const DupliContext *ctx,
+                               Object *ob, float mat[4][4], int index,
+                               bool animated, bool hide)
+{
+	DupliObject *dob;
+
+	if (ctx->duplilist) {
+		dob = dupli_store_alloc(ctx->store, 1);
+		BLI_addtail(ctx->duplilist, dob);
+	}
+	else if (ctx->iter) {
+		/* Streaming mode: generators write orco/uv into the returned entry
+		 * after this call, so the callback is deferred until the next dupli
+		 * (or the end of iteration) to see the complete entry.
+		 */
+		if (ctx->iter->pending) {
+			ctx->iter->func(ctx->iter->userdata, &ctx->iter->dob);
+		}
+		dob = &ctx->iter->dob;
+		memset(dob, 0, sizeof(*dob));
+		ctx->iter->pending = true;
+	}
+	else {
+		return NULL;
+	}
+
+	make_dupli_at(ctx, dob, ob, mat, index, animated, hide);
 
 	return dob;
 }
@@ -228,9 +327,15 @@ static void make_child_duplis(const DupliContext *ctx, void *userdata, MakeChild
 
 			if ((ob->lay & lay) && ob != obedit && is_child(ob, parent)) {
 				/* mballs have a different dupli handling */
-				if (ob->type != OB_MBALL)
+				if (ob->type != OB_MBALL) {
 					ob->flag |= OB_DONE;  /* doesnt render */
 
+					/* remember the flagging so serving a cached list can replay it */
+					if (ctx->store) {
+						BLI_addtail(&ctx->store->done_objects, BLI_genericNodeN(ob));
+					}
+				}
+
 				make_child_duplis_cb(ctx, userdata, ob);
 			}
 		}
@@ -243,9 +348,15 @@ static void make_child_duplis(const DupliContext *ctx, void *userdata, MakeChild
 
 			if ((base->lay & lay) && ob != obedit && is_child(ob, parent)) {
 				/* mballs have a different dupli handling */
-				if (ob->type != OB_MBALL)
+				if (ob->type != OB_MBALL) {
 					ob->flag |= OB_DONE;  /* doesnt render */
 
+					/* remember the flagging so serving a cached list can replay it */
+					if (ctx->store) {
+						BLI_addtail(&ctx->store->done_objects, BLI_genericNodeN(ob));
+					}
+				}
+
 				make_child_duplis_cb(ctx, userdata, ob);
 			}
 		}
@@ -441,25 +552,33 @@ static void get_duplivert_transform(const float co[3], const float nor_f[3], con
 	loc_quat_size_to_mat4(mat, co, quat, size);
 }
 
-static void vertex_dupli__mapFunc(void *userData, int index, const float co[3],
-                                  const float nor_f[3], const short nor_s[3])
+static void vertex_dupli_transform(const VertexDupliData *vdd,
+                                   const float co[3], const float nor_f[3], const short nor_s[3],
+                                   float r_obmat[4][4], float r_space_mat[4][4])
 {
-	const VertexDupliData *vdd = userData;
 	Object *inst_ob = vdd->inst_ob;
-	DupliObject *dob;
-	float obmat[4][4], space_mat[4][4];
 
 	/* obmat is transform to vertex */
-	get_duplivert_transform(co, nor_f, nor_s, vdd->use_rotation, inst_ob->trackflag, inst_ob->upflag, obmat);
+	get_duplivert_transform(co, nor_f, nor_s, vdd->use_rotation, inst_ob->trackflag, inst_ob->upflag, r_obmat);
 	/* make offset relative to inst_ob using relative child transform */
-	mul_mat3_m4_v3((float (*)[4])vdd->child_imat, obmat[3]);
+	mul_mat3_m4_v3((float (*)[4])vdd->child_imat, r_obmat[3]);
 	/* apply obmat _after_ the local vertex transform */
-	mul_m4_m4m4(obmat, inst_ob->obmat, obmat);
+	mul_m4_m4m4(r_obmat, inst_ob->obmat, r_obmat);
 
 	/* space matrix is constructed by removing obmat transform,
 	 * this yields the worldspace transform for recursive duplis
 	 */
-	mul_m4_m4m4(space_mat, obmat, inst_ob->imat);
+	mul_m4_m4m4(r_space_mat, r_obmat, inst_ob->imat);
+}
+
+static void vertex_dupli__mapFunc(void *userData, int index, const float co[3],
+                                  const float nor_f[3], const short nor_s[3])
+{
+	const VertexDupliData *vdd = userData;
+	DupliObject *dob;
+	float obmat[4][4], space_mat[4][4];
+
+	vertex_dupli_transform(vdd, co, nor_f, nor_s, obmat, space_mat);
 
 	dob = make_dupli(vdd->ctx, vdd->inst_ob, obmat, index, false, false);
 
@@ -470,6 +589,35 @@ static void vertex_dupli__mapFunc(void *userData, int index, const float co[3],
 	make_recursive_duplis(vdd->ctx, vdd->inst_ob, space_mat, index, false);
 }
 
+/* parallel filling of pre-allocated entries, for children without recursive duplis */
+typedef struct VertexDupliThreadData {
+	const VertexDupliData *vdd;
+	DupliObject *dobs;
+} VertexDupliThreadData;
+
+static void vertex_dupli_parallel_cb(void *userdata, const int index)
+{
+	const VertexDupliThreadData *data = userdata;
+	const VertexDupliData *vdd = data->vdd;
+	DupliObject *dob = &data->dobs[index];
+	float co[3], no[3];
+	float obmat[4][4], space_mat[4][4];
+
+	vdd->dm->getVertCo(vdd->dm, index, co);
+	if (vdd->use_rotation) {
+		vdd->dm->getVertNo(vdd->dm, index, no);
+		vertex_dupli_transform(vdd, co, no, NULL, obmat, space_mat);
+	}
+	else {
+		vertex_dupli_transform(vdd, co, NULL, NULL, obmat, space_mat);
+	}
+
+	make_dupli_at(vdd->ctx, dob, vdd->inst_ob, obmat, index, false, false);
+
+	if (vdd->orco)
+		copy_v3_v3(dob->orco, vdd->orco[index]);
+}
+
 static void make_child_duplis_verts(const DupliContext *ctx, void *userdata, Object *child)
 {
 	VertexDupliData *vdd = userdata;
@@ -484,6 +632,23 @@ static void make_child_duplis_verts(const DupliContext *ctx, void *userdata, Obj
 		dm->foreachMappedVert(dm, vertex_dupli__mapFunc, vdd,
 		                      vdd->use_rotation ? DM_FOREACH_USE_NORMAL : 0);
 	}
+	else if (ctx->duplilist && (child->transflag & OB_DUPLI) == 0 &&
+	         vdd->totvert > DUPLI_PARALLEL_THRESHOLD)
+	{
+		/* The child generates no recursive duplis, so every entry only
+		 * depends on its own vertex and can be filled in parallel.
+		 */
+		VertexDupliThreadData data;
+		int a;
+
+		data.vdd = vdd;
+		data.dobs = dupli_store_alloc(ctx->store, vdd->totvert);
+
+		BLI_task_parallel_range(0, vdd->totvert, &data, vertex_dupli_parallel_cb, true);
+
+		for (a = 0; a < vdd->totvert; a++)
+			BLI_addtail(ctx->duplilist, &data.dobs[a]);
+	}
 	else {
 		int a, totvert = vdd->totvert;
 		float vec[3], no[3];
@@ -701,74 +866,134 @@ static void get_dupliface_transform(MPoly *mpoly, MLoop *mloop, MVert *mvert,
 	loc_quat_size_to_mat4(mat, loc, quat, size);
 }
 
+static void face_dupli_transform(const DupliContext *ctx, const FaceDupliData *fdd,
+                                 Object *inst_ob, const float child_imat[4][4], MPoly *mp,
+                                 float r_obmat[4][4], float r_space_mat[4][4])
+{
+	MLoop *loopstart = fdd->mloop + mp->loopstart;
+
+	/* obmat is transform to face */
+	get_dupliface_transform(mp, loopstart, fdd->mvert, fdd->use_scale, ctx->object->dupfacesca, r_obmat);
+	/* make offset relative to inst_ob using relative child transform */
+	mul_mat3_m4_v3((float (*)[4])child_imat, r_obmat[3]);
+
+	/* XXX ugly hack to ensure same behavior as in master
+	 * this should not be needed, parentinv is not consistent
+	 * outside of parenting.
+	 */
+	{
+		float imat[3][3];
+		copy_m3_m4(imat, inst_ob->parentinv);
+		mul_m4_m3m4(r_obmat, imat, r_obmat);
+	}
+
+	/* apply obmat _after_ the local face transform */
+	mul_m4_m4m4(r_obmat, inst_ob->obmat, r_obmat);
+
+	/* space matrix is constructed by removing obmat transform,
+	 * this yields the worldspace transform for recursive duplis
+	 */
+	mul_m4_m4m4(r_space_mat, r_obmat, inst_ob->imat);
+}
+
+/* average orco/uv over the face corners (orco/mloopuv are NULL unless texcoords are used) */
+static void face_dupli_texcoords(const FaceDupliData *fdd, MPoly *mp, DupliObject *dob)
+{
+	MLoop *loopstart = fdd->mloop + mp->loopstart;
+	const float w = 1.0f / (float)mp->totloop;
+
+	if (fdd->orco) {
+		int j;
+		for (j = 0; j < mp->totloop; j++) {
+			madd_v3_v3fl(dob->orco, fdd->orco[loopstart[j].v], w);
+		}
+	}
+
+	if (fdd->mloopuv) {
+		int j;
+		for (j = 0; j < mp->totloop; j++) {
+			madd_v2_v2fl(dob->uv, fdd->mloopuv[mp->loopstart + j].uv, w);
+		}
+	}
+}
+
+/* parallel filling of pre-allocated entries, for children without recursive duplis */
+typedef struct FaceDupliThreadData {
+	const DupliContext *ctx;
+	const FaceDupliData *fdd;
+	Object *inst_ob;
+	float child_imat[4][4];
+	DupliObject *dobs;
+} FaceDupliThreadData;
+
+static void face_dupli_parallel_cb(void *userdata, const int index)
+{
+	const FaceDupliThreadData *data = userdata;
+	MPoly *mp = &data->fdd->mpoly[index];
+	DupliObject *dob = &data->dobs[index];
+	float obmat[4][4], space_mat[4][4];
+
+	/* degenerate face, entry stays unused and is never linked into the list */
+	if (UNLIKELY(mp->totloop < 3))
+		return;
+
+	face_dupli_transform(data->ctx, data->fdd, data->inst_ob, data->child_imat, mp, obmat, space_mat);
+
+	make_dupli_at(data->ctx, dob, data->inst_ob, obmat, index, false, false);
+	face_dupli_texcoords(data->fdd, mp, dob);
+}
+
 static void make_child_duplis_faces(const DupliContext *ctx, void *userdata, Object *inst_ob)
 {
 	FaceDupliData *fdd = userdata;
-	MPoly *mpoly = fdd->mpoly, *mp;
-	MLoop *mloop = fdd->mloop;
-	MVert *mvert = fdd->mvert;
-	float (*orco)[3] = fdd->orco;
-	MLoopUV *mloopuv = fdd->mloopuv;
-	int a, totface = fdd->totface;
-	bool use_texcoords = ELEM(ctx->eval_ctx->mode, DAG_EVAL_RENDER, DAG_EVAL_PREVIEW);
 	float child_imat[4][4];
-	DupliObject *dob;
 
 	invert_m4_m4(inst_ob->imat, inst_ob->obmat);
 	/* relative transform from parent to child space */
 	mul_m4_m4m4(child_imat, inst_ob->imat, ctx->object->obmat);
 
-	for (a = 0, mp = mpoly; a < totface; a++, mp++) {
-		MLoop *loopstart = mloop + mp->loopstart;
-		float space_mat[4][4], obmat[4][4];
+	if (ctx->duplilist && (inst_ob->transflag & OB_DUPLI) == 0 &&
+	    fdd->totface > DUPLI_PARALLEL_THRESHOLD)
+	{
+		/* The child generates no recursive duplis, so every entry only
+		 * depends on its own face and can be filled in parallel.
+		 */
+		FaceDupliThreadData data;
+		int a;
 
-		if (UNLIKELY(mp->totloop < 3))
-			continue;
+		data.ctx = ctx;
+		data.fdd = fdd;
+		data.inst_ob = inst_ob;
+		copy_m4_m4(data.child_imat, child_imat);
+		data.dobs = dupli_store_alloc(ctx->store, fdd->totface);
 
-		/* obmat is transform to face */
-		get_dupliface_transform(mp, loopstart, mvert, fdd->use_scale, ctx->object->dupfacesca, obmat);
-		/* make offset relative to inst_ob using relative child transform */
-		mul_mat3_m4_v3(child_imat, obmat[3]);
+		BLI_task_parallel_range(0, fdd->totface, &data, face_dupli_parallel_cb, true);
 
-		/* XXX ugly hack to ensure same behavior as in master
-		 * this should not be needed, parentinv is not consistent
-		 * outside of parenting.
-		 */
-		{
-			float imat[3][3];
-			copy_m3_m4(imat, inst_ob->parentinv);
-			mul_m4_m3m4(obmat, imat, obmat);
+		for (a = 0; a < fdd->totface; a++) {
+			if (data.dobs[a].ob) {
+				BLI_addtail(ctx->duplilist, &data.dobs[a]);
+			}
 		}
+	}
+	else {
+		MPoly *mp = fdd->mpoly;
+		int a;
 
-		/* apply obmat _after_ the local face transform */
-		mul_m4_m4m4(obmat, inst_ob->obmat, obmat);
+		for (a = 0; a < fdd->totface; a++, mp++) {
+			float space_mat[4][4], obmat[4][4];
+			DupliObject *dob;
 
-		/* space matrix is constructed by removing obmat transform,
-		 * this yields the worldspace transform for recursive duplis
-		 */
-		mul_m4_m4m4(space_mat, obmat, inst_ob->imat);
+			if (UNLIKELY(mp->totloop < 3))
+				continue;
 
-		dob = make_dupli(ctx, inst_ob, obmat, a, false, false);
-		if (use_texcoords) {
-			float w = 1.0f / (float)mp->totloop;
+			face_dupli_transform(ctx, fdd, inst_ob, child_imat, mp, obmat, space_mat);
 
-			if (orco) {
-				int j;
-				for (j = 0; j < mp->totloop; j++) {
-					madd_v3_v3fl(dob->orco, orco[loopstart[j].v], w);
-				}
-			}
+			dob = make_dupli(ctx, inst_ob, obmat, a, false, false);
+			face_dupli_texcoords(fdd, mp, dob);
 
-			if (mloopuv) {
-				int j;
-				for (j = 0; j < mp->totloop; j++) {
-					madd_v2_v2fl(dob->uv, mloopuv[mp->loopstart + j].uv, w);
-				}
-			}
+			/* recursion */
+			make_recursive_duplis(ctx, inst_ob, space_mat, a, false);
 		}
-
-		/* recursion */
-		make_recursive_duplis(ctx, inst_ob, space_mat, a, false);
 	}
 }
 
@@ -1185,15 +1410,55 @@ static const DupliGenerator *get_dupli_generator(const DupliContext *ctx)
 /* Returns a list of DupliObject */
 ListBase *object_duplilist_ex(EvaluationContext *eval_ctx, Scene *scene, Object *ob, bool update)
 {
-	ListBase *duplilist = MEM_callocN(sizeof(ListBase), "duplilist");
+	/* Render database building runs in its own thread while the viewport
+	 * keeps redrawing, so render-mode lookups (and viewport lookups during a
+	 * render) never touch the cache and always get a private list.
+	 */
+	const bool use_cache = (eval_ctx->mode != DAG_EVAL_RENDER) && !G.is_rendering;
+	/* read once up front: generation bumps during generation (updates done by
+	 * the generators can tag ids) then make the new cache immediately stale */
+	const unsigned int generation = dupli_cache_generation;
+	DupliListStore *store = use_cache ? ob->dupli_cache : NULL;
 	DupliContext ctx;
+
+	/* serve the cached list if nothing invalidated it since it was built */
+	if (store) {
+		if (store->generation == generation &&
+		    store->eval_mode == (short)eval_ctx->mode &&
+		    store->update == (char)update)
+		{
+			LinkData *link;
+
+			/* replay the child flagging of make_child_duplis, render
+			 * conversion uses it to skip objects duplicated away */
+			for (link = store->done_objects.first; link; link = link->next) {
+				((Object *)link->data)->flag |= OB_DONE;
+			}
+
+			return &store->base;
+		}
+
+		object_dupli_cache_free(ob);
+	}
+
+	store = MEM_callocN(sizeof(DupliListStore), "duplilist");
 	init_context(&ctx, eval_ctx, scene, ob, NULL, update);
 	if (ctx.gen) {
-		ctx.duplilist = duplilist;
+		ctx.store = store;
+		ctx.duplilist = &store->base;
 		ctx.gen->make_duplis(&ctx);
 	}
 
-	return duplilist;
+	if (use_cache) {
+		/* keep the result for the next request */
+		store->cached = true;
+		store->update = (char)update;
+		store->eval_mode = (short)eval_ctx->mode;
+		store->generation = generation;
+		ob->dupli_cache = store;
+	}
+
+	return &store->base;
 }
 
 /* note: previously updating was always done, this is why it defaults to be on
@@ -1203,10 +1468,68 @@ ListBase *object_duplilist(EvaluationContext *eval_ctx, Scene *sce, Object *ob)
 	return object_duplilist_ex(eval_ctx, sce, ob, true);
 }
 
+/* Generate duplis and pass each one to the given callback instead of building
+ * a list. The entry passed to the callback is reused, it is only valid for
+ * the duration of the call, copy out what is needed. Use this to stream over
+ * huge numbers of instances where materializing the full list costs too much
+ * memory.
+ */
+void object_duplilist_iterate(EvaluationContext *eval_ctx, Scene *scene, Object *ob,
+                              DupliObjectIterFunc func, void *userdata)
+{
+	DupliContext ctx;
+	DupliIterator iter;
+
+	init_context(&ctx, eval_ctx, scene, ob, NULL, true);
+	if (ctx.gen) {
+		iter.func = func;
+		iter.userdata = userdata;
+		iter.pending = false;
+		ctx.iter = &iter;
+		ctx.gen->make_duplis(&ctx);
+
+		/* flush the last deferred entry */
+		if (iter.pending) {
+			func(userdata, &iter.dob);
+		}
+	}
+}
+
 void free_object_duplilist(ListBase *lb)
 {
-	BLI_freelistN(lb);
-	MEM_freeN(lb);
+	/* the list is the first member of the chunked storage it was created with,
+	 * the DupliObject entries themselves live inside the chunks */
+	DupliListStore *store = (DupliListStore *)lb;
+
+	/* owned by the duplicator's cache now, kept for the next request */
+	if (store->cached) {
+		return;
+	}
+
+	BLI_freelistN(&store->done_objects);
+	BLI_freelistN(&store->chunks);
+	MEM_freeN(store);
+}
+
+void object_dupli_cache_free(Object *ob)
+{
+	DupliListStore *store = ob->dupli_cache;
+
+	if (store) {
+		store->cached = false;
+		ob->dupli_cache = NULL;
+
+		/* the RNA dupli_list api holds on to the list between its create and
+		 * clear calls, hand ownership back instead of freeing under it */
+		if (ob->duplilist != &store->base) {
+			free_object_duplilist(&store->base);
+		}
+	}
+}
+
+void object_dupli_cache_invalidate(void)
+{
+	atomic_add_uint32(&dupli_cache_generation, 1);
 }
 
 int count_duplilist(Object *ob)
@@ -539,187 +539,235 @@ static void ocean_compute_displacement_y(TaskPool *pool, void *UNUSED(taskdata),
 	fftw_execute(o->_disp_y_plan);
 }
 
+static void ocean_compute_displacement_x_row(void *userdata, const int i)
+{
+	OceanSimulateData *osd = userdata;
+	const Ocean *o = osd->o;
+	const float scale = osd->scale;
+	const float chop_amount = osd->chop_amount;
+	int j;
+
+	for (j = 0; j <= o->_N / 2; ++j) {
+		fftw_complex mul_param;
+		fftw_complex minus_i;
+
+		init_complex(minus_i, 0.0, -1.0);
+		init_complex(mul_param, -scale, 0);
+		mul_complex_f(mul_param, mul_param, chop_amount);
+		mul_complex_c(mul_param, mul_param, minus_i);
+		mul_complex_c(mul_param, mul_param, o->_htilda[i * (1 + o->_N / 2) + j]);
+		mul_complex_f(mul_param, mul_param,
+		              ((o->_k[i * (1 + o->_N / 2) + j] == 0.0f) ?
+		               0.0f :
+		               o->_kx[i] / o->_k[i * (1 + o->_N / 2) + j]));
+		init_complex(o->_fft_in_x[i * (1 + o->_N / 2) + j], real_c(mul_param), image_c(mul_param));
+	}
+}
+
 static void ocean_compute_displacement_x(TaskPool *pool, void *UNUSED(taskdata), int UNUSED(threadid))
 {
 	OceanSimulateData *osd = BLI_task_pool_userdata(pool);
 	const Ocean *o = osd->o;
+
+	BLI_task_parallel_range(0, o->_M, osd, ocean_compute_displacement_x_row, o->_M > 16);
+	fftw_execute(o->_disp_x_plan);
+}
+
+static void ocean_compute_displacement_z_row(void *userdata, const int i)
+{
+	OceanSimulateData *osd = userdata;
+	const Ocean *o = osd->o;
 	const float scale = osd->scale;
 	const float chop_amount = osd->chop_amount;
-	int i, j;
+	int j;
 
-	for (i = 0; i < o->_M; ++i) {
-		for (j = 0; j <= o->_N / 2; ++j) {
-			fftw_complex mul_param;
-			fftw_complex minus_i;
-
-			init_complex(minus_i, 0.0, -1.0);
-			init_complex(mul_param, -scale, 0);
-			mul_complex_f(mul_param, mul_param, chop_amount);
-			mul_complex_c(mul_param, mul_param, minus_i);
-			mul_complex_c(mul_param, mul_param, o->_htilda[i * (1 + o->_N / 2) + j]);
-			mul_complex_f(mul_param, mul_param,
-			              ((o->_k[i * (1 + o->_N / 2) + j] == 0.0f) ?
-			               0.0f :
-			               o->_kx[i] / o->_k[i * (1 + o->_N / 2) + j]));
-			init_complex(o->_fft_in_x[i * (1 + o->_N / 2) + j], real_c(mul_param), image_c(mul_param));
-		}
+	for (j = 0; j <= o->_N / 2; ++j) {
+		fftw_complex mul_param;
+		fftw_complex minus_i;
+
+		init_complex(minus_i, 0.0, -1.0);
+		init_complex(mul_param, -scale, 0);
+		mul_complex_f(mul_param, mul_param, chop_amount);
+		mul_complex_c(mul_param, mul_param, minus_i);
+		mul_complex_c(mul_param, mul_param, o->_htilda[i * (1 + o->_N / 2) + j]);
+		mul_complex_f(mul_param, mul_param,
+		              ((o->_k[i * (1 + o->_N / 2) + j] == 0.0f) ?
+		               0.0f :
+		               o->_kz[j] / o->_k[i * (1 + o->_N / 2) + j]));
+		init_complex(o->_fft_in_z[i * (1 + o->_N / 2) + j], real_c(mul_param), image_c(mul_param));
 	}
-	fftw_execute(o->_disp_x_plan);
 }
 
 static void ocean_compute_displacement_z(TaskPool *pool, void *UNUSED(taskdata), int UNUSED(threadid))
 {
 	OceanSimulateData *osd = BLI_task_pool_userdata(pool);
 	const Ocean *o = osd->o;
-	const float scale = osd->scale;
+
+	BLI_task_parallel_range(0, o->_M, osd, ocean_compute_displacement_z_row, o->_M > 16);
+	fftw_execute(o->_disp_z_plan);
+}
+
+static void ocean_compute_jacobian_jxx_row(void *userdata, const int i)
+{
+	OceanSimulateData *osd = userdata;
+	const Ocean *o = osd->o;
 	const float chop_amount = osd->chop_amount;
-	int i, j;
+	int j;
 
-	for (i = 0; i < o->_M; ++i) {
-		for (j = 0; j <= o->_N / 2; ++j) {
-			fftw_complex mul_param;
-			fftw_complex minus_i;
-
-			init_complex(minus_i, 0.0, -1.0);
-			init_complex(mul_param, -scale, 0);
-			mul_complex_f(mul_param, mul_param, chop_amount);
-			mul_complex_c(mul_param, mul_param, minus_i);
-			mul_complex_c(mul_param, mul_param, o->_htilda[i * (1 + o->_N / 2) + j]);
-			mul_complex_f(mul_param, mul_param,
-			              ((o->_k[i * (1 + o->_N / 2) + j] == 0.0f) ?
-			               0.0f :
-			               o->_kz[j] / o->_k[i * (1 + o->_N / 2) + j]));
-			init_complex(o->_fft_in_z[i * (1 + o->_N / 2) + j], real_c(mul_param), image_c(mul_param));
-		}
+	for (j = 0; j <= o->_N / 2; ++j) {
+		fftw_complex mul_param;
+
+		/* init_complex(mul_param, -scale, 0); */
+		init_complex(mul_param, -1, 0);
+
+		mul_complex_f(mul_param, mul_param, chop_amount);
+		mul_complex_c(mul_param, mul_param, o->_htilda[i * (1 + o->_N / 2) + j]);
+		mul_complex_f(mul_param, mul_param,
+		              ((o->_k[i * (1 + o->_N / 2) + j] == 0.0f) ?
+		               0.0f :
+		               o->_kx[i] * o->_kx[i] / o->_k[i * (1 + o->_N / 2) + j]));
+		init_complex(o->_fft_in_jxx[i * (1 + o->_N / 2) + j], real_c(mul_param), image_c(mul_param));
 	}
-	fftw_execute(o->_disp_z_plan);
 }
 
 static void ocean_compute_jacobian_jxx(TaskPool *pool, void *UNUSED(taskdata), int UNUSED(threadid))
 {
 	OceanSimulateData *osd = BLI_task_pool_userdata(pool);
 	const Ocean *o = osd->o;
-	const float chop_amount = osd->chop_amount;
-	int i, j;
 
-	for (i = 0; i < o->_M; ++i) {
-		for (j = 0; j <= o->_N / 2; ++j) {
-			fftw_complex mul_param;
-
-			/* init_complex(mul_param, -scale, 0); */
-			init_complex(mul_param, -1, 0);
-
-			mul_complex_f(mul_param, mul_param, chop_amount);
-			mul_complex_c(mul_param, mul_param, o->_htilda[i * (1 + o->_N / 2) + j]);
-			mul_complex_f(mul_param, mul_param,
-			              ((o->_k[i * (1 + o->_N / 2) + j] == 0.0f) ?
-			               0.0f :
-			               o->_kx[i] * o->_kx[i] / o->_k[i * (1 + o->_N / 2) + j]));
-			init_complex(o->_fft_in_jxx[i * (1 + o->_N / 2) + j], real_c(mul_param), image_c(mul_param));
-		}
-	}
+	BLI_task_parallel_range(0, o->_M, osd, ocean_compute_jacobian_jxx_row, o->_M > 16);
 	fftw_execute(o->_Jxx_plan);
 
-	for (i = 0; i < o->_M; ++i) {
-		for (j = 0; j < o->_N; ++j) {
-			o->_Jxx[i * o->_N + j] += 1.0;
+	{
+		int i, j;
+		for (i = 0; i < o->_M; ++i) {
+			for (j = 0; j < o->_N; ++j) {
+				o->_Jxx[i * o->_N + j] += 1.0;
+			}
 		}
 	}
 }
 
-static void ocean_compute_jacobian_jzz(TaskPool *pool, void *UNUSED(taskdata), int UNUSED(threadid))
+static void ocean_compute_jacobian_jzz_row(void *userdata, const int i)
 {
-	OceanSimulateData *osd = BLI_task_pool_userdata(pool);
+	OceanSimulateData *osd = userdata;
 	const Ocean *o = osd->o;
 	const float chop_amount = osd->chop_amount;
-	int i, j;
+	int j;
 
-	for (i = 0; i < o->_M; ++i) {
-		for (j = 0; j <= o->_N / 2; ++j) {
-			fftw_complex mul_param;
-
-			/* init_complex(mul_param, -scale, 0); */
-			init_complex(mul_param, -1, 0);
-
-			mul_complex_f(mul_param, mul_param, chop_amount);
-			mul_complex_c(mul_param, mul_param, o->_htilda[i * (1 + o->_N / 2) + j]);
-			mul_complex_f(mul_param, mul_param,
-			              ((o->_k[i * (1 + o->_N / 2) + j] == 0.0f) ?
-			               0.0f :
-			               o->_kz[j] * o->_kz[j] / o->_k[i * (1 + o->_N / 2) + j]));
-			init_complex(o->_fft_in_jzz[i * (1 + o->_N / 2) + j], real_c(mul_param), image_c(mul_param));
-		}
+	for (j = 0; j <= o->_N / 2; ++j) {
+		fftw_complex mul_param;
+
+		/* init_complex(mul_param, -scale, 0); */
+		init_complex(mul_param, -1, 0);
+
+		mul_complex_f(mul_param, mul_param, chop_amount);
+		mul_complex_c(mul_param, mul_param, o->_htilda[i * (1 + o->_N / 2) + j]);
+		mul_complex_f(mul_param, mul_param,
+		              ((o->_k[i * (1 + o->_N / 2) + j] == 0.0f) ?
+		               0.0f :
+		               o->_kz[j] * o->_kz[j] / o->_k[i * (1 + o->_N / 2) + j]));
+		init_complex(o->_fft_in_jzz[i * (1 + o->_N / 2) + j], real_c(mul_param), image_c(mul_param));
 	}
+}
+
+static void ocean_compute_jacobian_jzz(TaskPool *pool, void *UNUSED(taskdata), int UNUSED(threadid))
+{
+	OceanSimulateData *osd = BLI_task_pool_userdata(pool);
+	const Ocean *o = osd->o;
+
+	BLI_task_parallel_range(0, o->_M, osd, ocean_compute_jacobian_jzz_row, o->_M > 16);
 	fftw_execute(o->_Jzz_plan);
 
-	for (i = 0; i < o->_M; ++i) {
-		for (j = 0; j < o->_N; ++j) {
-			o->_Jzz[i * o->_N + j] += 1.0;
+	{
+		int i, j;
+		for (i = 0; i < o->_M; ++i) {
+			for (j = 0; j < o->_N; ++j) {
+				o->_Jzz[i * o->_N + j] += 1.0;
+			}
 		}
 	}
 }
 
-static void ocean_compute_jacobian_jxz(TaskPool *pool, void *UNUSED(taskdata), int UNUSED(threadid))
+static void ocean_compute_jacobian_jxz_row(void *userdata, const int i)
 {
-	OceanSimulateData *osd = BLI_task_pool_userdata(pool);
+	OceanSimulateData *osd = userdata;
 	const Ocean *o = osd->o;
 	const float chop_amount = osd->chop_amount;
-	int i, j;
+	int j;
 
-	for (i = 0; i < o->_M; ++i) {
-		for (j = 0; j <= o->_N / 2; ++j) {
-			fftw_complex mul_param;
-
-			/* init_complex(mul_param, -scale, 0); */
-			init_complex(mul_param, -1, 0);
-
-			mul_complex_f(mul_param, mul_param, chop_amount);
-			mul_complex_c(mul_param, mul_param, o->_htilda[i * (1 + o->_N / 2) + j]);
-			mul_complex_f(mul_param, mul_param,
-			              ((o->_k[i * (1 + o->_N / 2) + j] == 0.0f) ?
-			               0.0f :
-			               o->_kx[i] * o->_kz[j] / o->_k[i * (1 + o->_N / 2) + j]));
-			init_complex(o->_fft_in_jxz[i * (1 + o->_N / 2) + j], real_c(mul_param), image_c(mul_param));
-		}
+	for (j = 0; j <= o->_N / 2; ++j) {
+		fftw_complex mul_param;
+
+		/* init_complex(mul_param, -scale, 0); */
+		init_complex(mul_param, -1, 0);
+
+		mul_complex_f(mul_param, mul_param, chop_amount);
+		mul_complex_c(mul_param, mul_param, o->_htilda[i * (1 + o->_N / 2) + j]);
+		mul_complex_f(mul_param, mul_param,
+		              ((o->_k[i * (1 + o->_N / 2) + j] == 0.0f) ?
+		               0.0f :
+		               o->_kx[i] * o->_kz[j] / o->_k[i * (1 + o->_N / 2) + j]));
+		init_complex(o->_fft_in_jxz[i * (1 + o->_N / 2) + j], real_c(mul_param), image_c(mul_param));
 	}
+}
+
+static void ocean_compute_jacobian_jxz(TaskPool *pool, void *UNUSED(taskdata), int UNUSED(threadid))
+{
+	OceanSimulateData *osd = BLI_task_pool_userdata(pool);
+	const Ocean *o = osd->o;
+
+	BLI_task_parallel_range(0, o->_M, osd, ocean_compute_jacobian_jxz_row, o->_M > 16);
 	fftw_execute(o->_Jxz_plan);
 }
 
+static void ocean_compute_normal_x_row(void *userdata, const int i)
+{
+	OceanSimulateData *osd = userdata;
+	const Ocean *o = osd->o;
+	int j;
+
+	for (j = 0; j <= o->_N / 2; ++j) {
+		fftw_complex mul_param;
+
+		init_complex(mul_param, 0.0, -1.0);
+		mul_complex_c(mul_param, mul_param, o->_htilda[i * (1 + o->_N / 2) + j]);
+		mul_complex_f(mul_param, mul_param, o->_kx[i]);
+		init_complex(o->_fft_in_nx[i * (1 + o->_N / 2) + j], real_c(mul_param), image_c(mul_param));
+	}
+}
+
 static void ocean_compute_normal_x(TaskPool *pool, void *UNUSED(taskdata), int UNUSED(threadid))
 {
 	OceanSimulateData *osd = BLI_task_pool_userdata(pool);
 	const Ocean *o = osd->o;
-	int i, j;
 
-	for (i = 0; i < o->_M; ++i) {
-		for (j = 0; j <= o->_N / 2; ++j) {
-			fftw_complex mul_param;
+	BLI_task_parallel_range(0, o->_M, osd, ocean_compute_normal_x_row, o->_M > 16);
+	fftw_execute(o->_N_x_plan);
+}
 
-			init_complex(mul_param, 0.0, -1.0);
-			mul_complex_c(mul_param, mul_param, o->_htilda[i * (1 + o->_N / 2) + j]);
-			mul_complex_f(mul_param, mul_param, o->_kx[i]);
-			init_complex(o->_fft_in_nx[i * (1 + o->_N / 2) + j], real_c(mul_param), image_c(mul_param));
-		}
+static void ocean_compute_normal_z_row(void *userdata, const int i)
+{
+	OceanSimulateData *osd = userdata;
+	const Ocean *o = osd->o;
+	int j;
+
+	for (j = 0; j <= o->_N / 2; ++j) {
+		fftw_complex mul_param;
+
+		init_complex(mul_param, 0.0, -1.0);
+		mul_complex_c(mul_param, mul_param, o->_htilda[i * (1 + o->_N / 2) + j]);
+		mul_complex_f(mul_param, mul_param, o->_kz[i]);
+		init_complex(o->_fft_in_nz[i * (1 + o->_N / 2) + j], real_c(mul_param), image_c(mul_param));
 	}
-	fftw_execute(o->_N_x_plan);
 }
 
 static void ocean_compute_normal_z(TaskPool *pool, void *UNUSED(taskdata), int UNUSED(threadid))
 {
 	OceanSimulateData *osd = BLI_task_pool_userdata(pool);
 	const Ocean *o = osd->o;
-	int i, j;
-
-	for (i = 0; i < o->_M; ++i) {
-		for (j = 0; j <= o->_N / 2; ++j) {
-			fftw_complex mul_param;
 
-			init_complex(mul_param, 0.0, -1.0);
-			mul_complex_c(mul_param, mul_param, o->_htilda[i * (1 + o->_N / 2) + j]);
-			mul_complex_f(mul_param, mul_param, o->_kz[i]);
-			init_complex(o->_fft_in_nz[i * (1 + o->_N / 2) + j], real_c(mul_param), image_c(mul_param));
-		}
-	}
+	BLI_task_parallel_range(0, o->_M, osd, ocean_compute_normal_z_row, o->_M > 16);
 	fftw_execute(o->_N_z_plan);
 }
 
@@ -1248,156 +1296,225 @@ void BKE_ocean_simulate_cache(struct OceanCache *och, int frame)
 }
 
 
-void BKE_ocean_bake(struct Ocean *o, struct OceanCache *och, void (*update_cb)(void *, float progress, int *cancel),
-                    void *update_cb_data)
+typedef struct OceanBakeRowData {
+	struct Ocean *o;
+	struct OceanCache *och;
+	ImBuf *ibuf_disp;
+	ImBuf *ibuf_foam;
+	ImBuf *ibuf_normal;
+	float *prev_foam;
+	int res_x;
+	/* no previous foam to accumulate on the first baked frame */
+	bool first_frame;
+} OceanBakeRowData;
+
+static void ocean_bake_rows(void *userdata, const int y)
 {
+	OceanBakeRowData *obrd = userdata;
+	struct Ocean *o = obrd->o;
+	struct OceanCache *och = obrd->och;
+	const int res_x = obrd->res_x;
 	/* note: some of these values remain uninitialized unless certain options
 	 * are enabled, take care that BKE_ocean_eval_ij() initializes a member
 	 * before use - campbell */
 	OceanResult ocr;
+	int x;
 
-	ImageFormatData imf = {0};
+	for (x = 0; x < res_x; x++) {
 
-	int f, i = 0, x, y, cancel = 0;
-	float progress;
+		BKE_ocean_eval_ij(o, &ocr, x, y);
 
-	ImBuf *ibuf_foam, *ibuf_disp, *ibuf_normal;
-	float *prev_foam;
-	int res_x = och->resolution_x;
-	int res_y = och->resolution_y;
-	char string[FILE_MAX];
-	//RNG *rng;
+		/* add to the image */
+		rgb_to_rgba_unit_alpha(&obrd->ibuf_disp->rect_float[4 * (res_x * y + x)], ocr.disp);
 
-	if (!o) return;
+		if (o->_do_jacobian) {
+			/* TODO, cleanup unused code - campbell */
 
-	if (o->_do_jacobian) prev_foam = MEM_callocN(res_x * res_y * sizeof(float), "previous frame foam bake data");
-	else prev_foam = NULL;
+			float /*r, */ /* UNUSED */ pr = 0.0f, foam_result;
+			float neg_disp, neg_eplus;
 
-	//rng = BLI_rng_new(0);
+			ocr.foam = BKE_ocean_jminus_to_foam(ocr.Jminus, och->foam_coverage);
 
-	/* setup image format */
-	imf.imtype = R_IMF_IMTYPE_OPENEXR;
-	imf.depth =  R_IMF_CHAN_DEPTH_16;
-	imf.exr_codec = R_IMF_EXR_CODEC_ZIP;
+			/* accumulate previous value for this cell */
+			if (!obrd->first_frame) {
+				pr = obrd->prev_foam[res_x * y + x];
+			}
 
-	for (f = och->start, i = 0; f <= och->end; f++, i++) {
+			/* r = BLI_rng_get_float(rng); */ /* UNUSED */ /* randomly reduce foam */
 
-		/* create a new imbuf to store image for this frame */
-		ibuf_foam = IMB_allocImBuf(res_x, res_y, 32, IB_rectfloat);
-		ibuf_disp = IMB_allocImBuf(res_x, res_y, 32, IB_rectfloat);
-		ibuf_normal = IMB_allocImBuf(res_x, res_y, 32, IB_rectfloat);
+			/* pr = pr * och->foam_fade; */		/* overall fade */
 
-		BKE_ocean_simulate(o, och->time[i], och->wave_scale, och->chop_amount);
+			/* remember ocean coord sys is Y up!
+			 * break up the foam where height (Y) is low (wave valley), and X and Z displacement is greatest
+			 */
 
-		/* add new foam */
-		for (y = 0; y < res_y; y++) {
-			for (x = 0; x < res_x; x++) {
+			neg_disp = ocr.disp[1] < 0.0f ? 1.0f + ocr.disp[1] : 1.0f;
+			neg_disp = neg_disp < 0.0f ? 0.0f : neg_disp;
 
-				BKE_ocean_eval_ij(o, &ocr, x, y);
+			/* foam, 'ocr.Eplus' only initialized with do_jacobian */
+			neg_eplus = ocr.Eplus[2] < 0.0f ? 1.0f + ocr.Eplus[2] : 1.0f;
+			neg_eplus = neg_eplus < 0.0f ? 0.0f : neg_eplus;
 
-				/* add to the image */
-				rgb_to_rgba_unit_alpha(&ibuf_disp->rect_float[4 * (res_x * y + x)], ocr.disp);
+			if (pr < 1.0f)
+				pr *= pr;
 
-				if (o->_do_jacobian) {
-					/* TODO, cleanup unused code - campbell */
+			pr *= och->foam_fade * (0.75f + neg_eplus * 0.25f);
 
-					float /*r, */ /* UNUSED */ pr = 0.0f, foam_result;
-					float neg_disp, neg_eplus;
+			/* A full clamping should not be needed! */
+			foam_result = min_ff(pr + ocr.foam, 1.0f);
 
-					ocr.foam = BKE_ocean_jminus_to_foam(ocr.Jminus, och->foam_coverage);
+			obrd->prev_foam[res_x * y + x] = foam_result;
 
-					/* accumulate previous value for this cell */
-					if (i > 0) {
-						pr = prev_foam[res_x * y + x];
-					}
+			/*foam_result = min_ff(foam_result, 1.0f); */
 
-					/* r = BLI_rng_get_float(rng); */ /* UNUSED */ /* randomly reduce foam */
+			value_to_rgba_unit_alpha(&obrd->ibuf_foam->rect_float[4 * (res_x * y + x)], foam_result);
+		}
 
-					/* pr = pr * och->foam_fade; */		/* overall fade */
+		if (o->_do_normals) {
+			rgb_to_rgba_unit_alpha(&obrd->ibuf_normal->rect_float[4 * (res_x * y + x)], ocr.normal);
+		}
+	}
+}
 
-					/* remember ocean coord sys is Y up!
-					 * break up the foam where height (Y) is low (wave valley), and X and Z displacement is greatest
-					 */
+typedef struct OceanBakeWriteJob {
+	struct OceanCache *och;
+	ImageFormatData *imf;
+	/* imbufs are owned by the job and freed once written */
+	ImBuf *ibuf_disp;
+	ImBuf *ibuf_foam;
+	ImBuf *ibuf_normal;
+	int frame;
+	bool do_jacobian;
+	bool do_normals;
+} OceanBakeWriteJob;
+
+static void *ocean_bake_write_thread(void *data)
+{
+	OceanBakeWriteJob *job = data;
+	struct OceanCache *och = job->och;
+	char string[FILE_MAX];
 
-#if 0
-					vec[0] = ocr.disp[0];
-					vec[1] = ocr.disp[2];
-					hor_stretch = len_v2(vec);
-					CLAMP(hor_stretch, 0.0, 1.0);
-#endif
+	cache_filename(string, och->bakepath, och->relbase, job->frame, CACHE_TYPE_DISPLACE);
+	if (0 == BKE_imbuf_write(job->ibuf_disp, string, job->imf))
+		printf("Cannot save Displacement File Output to %s\n", string);
 
-					neg_disp = ocr.disp[1] < 0.0f ? 1.0f + ocr.disp[1] : 1.0f;
-					neg_disp = neg_disp < 0.0f ? 0.0f : neg_disp;
+	if (job->do_jacobian) {
+		cache_filename(string, och->bakepath, och->relbase, job->frame, CACHE_TYPE_FOAM);
+		if (0 == BKE_imbuf_write(job->ibuf_foam, string, job->imf))
+			printf("Cannot save Foam File Output to %s\n", string);
+	}
 
-					/* foam, 'ocr.Eplus' only initialized with do_jacobian */
-					neg_eplus = ocr.Eplus[2] < 0.0f ? 1.0f + ocr.Eplus[2] : 1.0f;
-					neg_eplus = neg_eplus < 0.0f ? 0.0f : neg_eplus;
+	if (job->do_normals) {
+		cache_filename(string, och->bakepath, och->relbase, job->frame, CACHE_TYPE_NORMAL);
+		if (0 == BKE_imbuf_write(job->ibuf_normal, string, job->imf))
+			printf("Cannot save Normal File Output to %s\n", string);
+	}
 
-#if 0
-					if (ocr.disp[1] < 0.0 || r > och->foam_fade)
-						pr *= och->foam_fade;
+	IMB_freeImBuf(job->ibuf_disp);
+	IMB_freeImBuf(job->ibuf_foam);
+	IMB_freeImBuf(job->ibuf_normal);
 
+	return NULL;
+}
 
-					pr = pr * (1.0 - hor_stretch) * ocr.disp[1];
-					pr = pr * neg_disp * neg_eplus;
-#endif
+void BKE_ocean_bake(struct Ocean *o, struct OceanCache *och, void (*update_cb)(void *, float progress, int *cancel),
+                    void *update_cb_data)
+{
+	ImageFormatData imf = {0};
 
-					if (pr < 1.0f)
-						pr *= pr;
+	int f, i = 0, cancel = 0;
+	float progress;
 
-					pr *= och->foam_fade * (0.75f + neg_eplus * 0.25f);
+	ImBuf *ibuf_foam, *ibuf_disp, *ibuf_normal;
+	float *prev_foam;
+	int res_x = och->resolution_x;
+	int res_y = och->resolution_y;
+	ListBase write_threads;
+	OceanBakeWriteJob write_job;
+	bool write_pending = false;
+	//RNG *rng;
 
-					/* A full clamping should not be needed! */
-					foam_result = min_ff(pr + ocr.foam, 1.0f);
+	if (!o) return;
 
-					prev_foam[res_x * y + x] = foam_result;
+	if (o->_do_jacobian) prev_foam = MEM_callocN(res_x * res_y * sizeof(float), "previous frame foam bake data");
+	else prev_foam = NULL;
 
-					/*foam_result = min_ff(foam_result, 1.0f); */
+	//rng = BLI_rng_new(0);
 
-					value_to_rgba_unit_alpha(&ibuf_foam->rect_float[4 * (res_x * y + x)], foam_result);
-				}
+	/* setup image format */
+	imf.imtype = R_IMF_IMTYPE_OPENEXR;
+	imf.depth =  R_IMF_CHAN_DEPTH_16;
+	imf.exr_codec = R_IMF_EXR_CODEC_ZIP;
 
-				if (o->_do_normals) {
-					rgb_to_rgba_unit_alpha(&ibuf_normal->rect_float[4 * (res_x * y + x)], ocr.normal);
-				}
-			}
-		}
+	/* single writer thread, so the EXR compression and disk i/o of a frame
+	 * overlap the simulation of the next one */
+	BLI_init_threads(&write_threads, ocean_bake_write_thread, 1);
 
-		/* write the images */
-		cache_filename(string, och->bakepath, och->relbase, f, CACHE_TYPE_DISPLACE);
-		if (0 == BKE_imbuf_write(ibuf_disp, string, &imf))
-			printf("Cannot save Displacement File Output to %s\n", string);
+	for (f = och->start, i = 0; f <= och->end; f++, i++) {
 
-		if (o->_do_jacobian) {
-			cache_filename(string, och->bakepath, och->relbase, f, CACHE_TYPE_FOAM);
-			if (0 == BKE_imbuf_write(ibuf_foam, string, &imf))
-				printf("Cannot save Foam File Output to %s\n", string);
+		/* create a new imbuf to store image for this frame */
+		ibuf_foam = IMB_allocImBuf(res_x, res_y, 32, IB_rectfloat);
+		ibuf_disp = IMB_allocImBuf(res_x, res_y, 32, IB_rectfloat);
+		ibuf_normal = IMB_allocImBuf(res_x, res_y, 32, IB_rectfloat);
+
+		BKE_ocean_simulate(o, och->time[i], och->wave_scale, och->chop_amount);
+
+		/* add new foam, rows are independent (each pixel only touches its own
+		 * accumulated foam cell) so they are filled in parallel */
+		{
+			OceanBakeRowData obrd;
+
+			obrd.o = o;
+			obrd.och = och;
+			obrd.ibuf_disp = ibuf_disp;
+			obrd.ibuf_foam = ibuf_foam;
+			obrd.ibuf_normal = ibuf_normal;
+			obrd.prev_foam = prev_foam;
+			obrd.res_x = res_x;
+			obrd.first_frame = (i == 0);
+
+			BLI_task_parallel_range(0, res_y, &obrd, ocean_bake_rows, res_y > 16);
 		}
 
-		if (o->_do_normals) {
-			cache_filename(string, och->bakepath, och->relbase, f, CACHE_TYPE_NORMAL);
-			if (0 == BKE_imbuf_write(ibuf_normal, string, &imf))
-				printf("Cannot save Normal File Output to %s\n", string);
+		/* write the images, handing the imbufs over to the writer thread,
+		 * at most one frame is in flight to keep memory use bounded */
+		if (write_pending) {
+			BLI_remove_thread(&write_threads, &write_job);
 		}
 
-		IMB_freeImBuf(ibuf_disp);
-		IMB_freeImBuf(ibuf_foam);
-		IMB_freeImBuf(ibuf_normal);
+		write_job.och = och;
+		write_job.imf = &imf;
+		write_job.ibuf_disp = ibuf_disp;
+		write_job.ibuf_foam = ibuf_foam;
+		write_job.ibuf_normal = ibuf_normal;
+		write_job.frame = f;
+		write_job.do_jacobian = o->_do_jacobian;
+		write_job.do_normals = o->_do_normals;
+
+		BLI_insert_thread(&write_threads, &write_job);
+		write_pending = true;
 
 		progress = (f - och->start) / (float)och->duration;
 
 		update_cb(update_cb_data, progress, &cancel);
 
 		if (cancel) {
-			if (prev_foam) MEM_freeN(prev_foam);
-			//BLI_rng_free(rng);
-			return;
+			break;
 		}
 	}
 
+	/* wait for the last frame to hit the disk */
+	if (write_pending) {
+		BLI_remove_thread(&write_threads, &write_job);
+	}
+	BLI_end_threads(&write_threads);
+
 	//BLI_rng_free(rng);
 	if (prev_foam) MEM_freeN(prev_foam);
-	och->baked = 1;
+
+	if (!cancel) {
+		och->baked = 1;
+	}
 }
 
 #else /* WITH_OCEANSIM */
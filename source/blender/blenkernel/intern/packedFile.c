@@ -49,6 +49,7 @@
 #include "DNA_vfont_types.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_font.h"
@@ -59,6 +60,215 @@
 #include "BKE_report.h"
 #include "BKE_sound.h"
 
+/* ********** lazy packed files ********** */
+
+/* Packed files read from an uncompressed .blend are not kept in memory but
+ * streamed back in from the file when needed (PF_FILE_LAZY, set on file read,
+ * see direct_link_packedfile). Materialized buffers stay on a least recently
+ * used list so repeated access is cheap, and are dropped again when their
+ * total size exceeds PF_LAZY_CACHE_LIMIT. */
+
+#define PF_LAZY_CACHE_LIMIT (128 << 20)
+
+typedef struct LazyBufLink {
+	struct LazyBufLink *next, *prev;
+	PackedFile *pf;
+	/* buffers with users are never dropped, see acquirePackedFileData() */
+	int users;
+} LazyBufLink;
+
+static ListBase pf_lazy_cache = {NULL, NULL};
+static size_t pf_lazy_cache_size = 0;
+static ThreadMutex pf_lazy_mutex = BLI_MUTEX_INITIALIZER;
+
+static LazyBufLink *packedfile_lazy_find(const PackedFile *pf)
+{
+	LazyBufLink *link;
+
+	for (link = pf_lazy_cache.first; link; link = link->next)
+		if (link->pf == pf)
+			return link;
+
+	return NULL;
+}
+
+/* drop least recently used buffers until the cache fits its limit again */
+static void packedfile_lazy_trim(void)
+{
+	LazyBufLink *link, *link_next;
+
+	for (link = pf_lazy_cache.first;
+	     link && (pf_lazy_cache_size > PF_LAZY_CACHE_LIMIT);
+	     link = link_next)
+	{
+		link_next = link->next;
+
+		if (link->users == 0) {
+			pf_lazy_cache_size -= link->pf->size;
+			MEM_freeN(link->pf->data);
+			link->pf->data = NULL;
+			BLI_remlink(&pf_lazy_cache, link);
+			MEM_freeN(link);
+		}
+	}
+}
+
+static void *packedfile_lazy_read(const PackedFile *pf)
+{
+	void *data = NULL;
+	int file;
+
+	if (pf->lazy_path == NULL)
+		return NULL;
+
+	file = BLI_open(pf->lazy_path, O_BINARY | O_RDONLY, 0);
+	if (file == -1) {
+		printf("acquirePackedFileData: source file '%s' not found\n", pf->lazy_path);
+		return NULL;
+	}
+
+	if (lseek(file, pf->lazy_offset, SEEK_SET) == pf->lazy_offset) {
+		data = MEM_mallocN(pf->size ? pf->size : 1, "packFile");
+		if (read(file, data, pf->size) != pf->size) {
+			printf("acquirePackedFileData: failed reading from '%s'\n", pf->lazy_path);
+			MEM_freeN(data);
+			data = NULL;
+		}
+	}
+
+	close(file);
+
+	return data;
+}
+
+/**
+ * Returns the packed data, reading it back in from the source .blend file
+ * for lazy packed files. Each successful call on a lazy packed file must be
+ * paired with releasePackedFileData() once the caller is done with the
+ * buffer, so it may be dropped from the cache again. Can return NULL when
+ * the source file went missing.
+ */
+void *acquirePackedFileData(PackedFile *pf)
+{
+	void *data;
+
+	if ((pf->flag & PF_FILE_LAZY) == 0) {
+		return pf->data;
+	}
+
+	BLI_mutex_lock(&pf_lazy_mutex);
+
+	if (pf->data == NULL) {
+		pf->data = packedfile_lazy_read(pf);
+		if (pf->data) {
+			LazyBufLink *link = MEM_callocN(sizeof(*link), "LazyBufLink");
+			link->pf = pf;
+			BLI_addtail(&pf_lazy_cache, link);
+			pf_lazy_cache_size += pf->size;
+		}
+	}
+
+	if (pf->data) {
+		/* buffers from dupPackedFile() are not on the cache list, those are
+		 * simply kept until the packed file is freed */
+		LazyBufLink *link = packedfile_lazy_find(pf);
+
+		if (link) {
+			link->users++;
+			/* most recently used last */
+			BLI_remlink(&pf_lazy_cache, link);
+			BLI_addtail(&pf_lazy_cache, link);
+		}
+		packedfile_lazy_trim();
+	}
+
+	data = pf->data;
+
+	BLI_mutex_unlock(&pf_lazy_mutex);
+
+	return data;
+}
+
+void releasePackedFileData(PackedFile *pf)
+{
+	LazyBufLink *link;
+
+	if ((pf->flag & PF_FILE_LAZY) == 0)
+		return;
+
+	BLI_mutex_lock(&pf_lazy_mutex);
+
+	link = packedfile_lazy_find(pf);
+	if (link && link->users > 0)
+		link->users--;
+
+	BLI_mutex_unlock(&pf_lazy_mutex);
+}
+
+/* turn a lazy packed file back into a regular in-memory one */
+static void packedfile_make_eager(PackedFile *pf, const char *filepath)
+{
+	LazyBufLink *link;
+
+	if (pf == NULL || (pf->flag & PF_FILE_LAZY) == 0)
+		return;
+	if (filepath && pf->lazy_path && (BLI_path_cmp(filepath, pf->lazy_path) != 0))
+		return;
+
+	acquirePackedFileData(pf);
+	releasePackedFileData(pf);
+
+	BLI_mutex_lock(&pf_lazy_mutex);
+	if ((link = packedfile_lazy_find(pf))) {
+		pf_lazy_cache_size -= pf->size;
+		BLI_remlink(&pf_lazy_cache, link);
+		MEM_freeN(link);
+	}
+	pf->flag &= ~PF_FILE_LAZY;
+	BLI_mutex_unlock(&pf_lazy_mutex);
+
+	if (pf->lazy_path) {
+		MEM_freeN(pf->lazy_path);
+		pf->lazy_path = NULL;
+	}
+	if (pf->data == NULL) {
+		printf("packedfile_make_eager: packed data lost, source file missing\n");
+	}
+}
+
+/**
+ * Permanently materializes every lazy packed file streaming from \a filepath
+ * (all of them when \a filepath is NULL). Must be called before overwriting
+ * the file, the stored offsets are meaningless afterwards.
+ */
+void ensureAllPackedFiles(Main *bmain, const char *filepath)
+{
+	Image *ima;
+	VFont *vf;
+	bSound *sound;
+	Library *lib;
+
+	for (ima = bmain->image.first; ima; ima = ima->id.next) {
+		ImagePackedFile *imapf;
+
+		for (imapf = ima->packedfiles.first; imapf; imapf = imapf->next)
+			packedfile_make_eager(imapf->packedfile, filepath);
+	}
+
+	for (vf = bmain->vfont.first; vf; vf = vf->id.next) {
+		packedfile_make_eager(vf->packedfile, filepath);
+		packedfile_make_eager(vf->temp_pf, filepath);
+	}
+
+	for (sound = bmain->sound.first; sound; sound = sound->id.next) {
+		packedfile_make_eager(sound->packedfile, filepath);
+		packedfile_make_eager(sound->newpackedfile, filepath);
+	}
+
+	for (lib = bmain->library.first; lib; lib = lib->id.next)
+		packedfile_make_eager(lib->packedfile, filepath);
+}
+
 int seekPackedFile(PackedFile *pf, int offset, int whence)
 {
 	int oldseek = -1, seek = 0;
@@ -97,20 +307,26 @@ void rewindPackedFile(PackedFile *pf)
 }
 
 int readPackedFile(PackedFile *pf, void *data, int size)
-{ 
-	if ((pf != NULL) && (size >= 0) && (data != NULL)) {
+{
+	void *pfdata;
+
+	if ((pf != NULL) && (size >= 0) && (data != NULL) &&
+	    (pfdata = acquirePackedFileData(pf)))
+	{
 		if (size + pf->seek > pf->size) {
 			size = pf->size - pf->seek;
 		}
 
 		if (size > 0) {
-			memcpy(data, ((char *) pf->data) + pf->seek, size);
+			memcpy(data, ((char *) pfdata) + pf->seek, size);
 		}
 		else {
 			size = 0;
 		}
 
 		pf->seek += size;
+
+		releasePackedFileData(pf);
 	}
 	else {
 		size = -1;
@@ -145,7 +361,21 @@ int countPackedFiles(Main *bmain)
 void freePackedFile(PackedFile *pf)
 {
 	if (pf) {
-		MEM_freeN(pf->data);
+		if (pf->flag & PF_FILE_LAZY) {
+			LazyBufLink *link;
+
+			BLI_mutex_lock(&pf_lazy_mutex);
+			if ((link = packedfile_lazy_find(pf))) {
+				pf_lazy_cache_size -= pf->size;
+				BLI_remlink(&pf_lazy_cache, link);
+				MEM_freeN(link);
+			}
+			BLI_mutex_unlock(&pf_lazy_mutex);
+		}
+		if (pf->data)
+			MEM_freeN(pf->data);
+		if (pf->lazy_path)
+			MEM_freeN(pf->lazy_path);
 		MEM_freeN(pf);
 	}
 	else
@@ -156,8 +386,15 @@ PackedFile *dupPackedFile(const PackedFile *pf_src)
 {
 	PackedFile *pf_dst;
 
-	pf_dst       = MEM_dupallocN(pf_src);
-	pf_dst->data = MEM_dupallocN(pf_src->data);
+	pf_dst = MEM_dupallocN(pf_src);
+	if (pf_src->flag & PF_FILE_LAZY) {
+		/* the copy streams data in from the source file by itself */
+		pf_dst->data = NULL;
+		pf_dst->lazy_path = pf_src->lazy_path ? BLI_strdup(pf_src->lazy_path) : NULL;
+	}
+	else {
+		pf_dst->data = MEM_dupallocN(pf_src->data);
+	}
 
 	return pf_dst;
 }
@@ -326,14 +563,20 @@ int writePackedFile(ReportList *reports, const char *filename, PackedFile *pf, i
 		ret_value = RET_ERROR;
 	}
 	else {
-		if (write(file, pf->data, pf->size) != pf->size) {
+		void *pfdata = acquirePackedFileData(pf);
+
+		if ((pfdata == NULL) || (write(file, pfdata, pf->size) != pf->size)) {
 			BKE_reportf(reports, RPT_ERROR, "Error writing file '%s'", name);
 			ret_value = RET_ERROR;
 		}
 		else {
 			BKE_reportf(reports, RPT_INFO, "Saved packed file to: %s", name);
 		}
-		
+
+		if (pfdata) {
+			releasePackedFileData(pf);
+		}
+
 		close(file);
 	}
 	
@@ -382,10 +625,14 @@ int checkPackedFile(const char *filename, PackedFile *pf)
 	}
 	else {
 		/* we'll have to compare the two... */
+		const char *pfdata = acquirePackedFileData(pf);
 
-		file = BLI_open(name, O_BINARY | O_RDONLY, 0);
-		if (file == -1) {
+		if (pfdata == NULL) {
+			ret_val = PF_DIFFERS;
+		}
+		else if ((file = BLI_open(name, O_BINARY | O_RDONLY, 0)) == -1) {
 			ret_val = PF_NOFILE;
+			releasePackedFileData(pf);
 		}
 		else {
 			ret_val = PF_EQUAL;
@@ -402,14 +649,15 @@ int checkPackedFile(const char *filename, PackedFile *pf)
 					break;
 				}
 				else {
-					if (memcmp(buf, ((char *)pf->data) + i, len)) {
+					if (memcmp(buf, pfdata + i, len)) {
 						ret_val = PF_DIFFERS;
 						break;
 					}
 				}
 			}
-			
+
 			close(file);
+			releasePackedFileData(pf);
 		}
 	}
 	
@@ -46,6 +46,7 @@
 #include "BLI_utildefines.h"
 #include "BLI_math_vector.h"
 #include "BLI_listbase.h"
+#include "BLI_task.h"
 
 #include "BKE_brush.h"
 #include "BKE_colortools.h"
@@ -785,6 +786,12 @@ static bool sculpt_modifiers_active(Scene *scene, Sculpt *sd, Object *ob)
 /**
  * \param need_mask So the DerivedMesh thats returned has mask data
  */
+static void sculpt_invert_deform_imats_task_cb(void *userdata, const int a)
+{
+	float (*deform_imats)[3][3] = userdata;
+	invert_m3(deform_imats[a]);
+}
+
 void BKE_sculpt_update_mesh_elements(Scene *scene, Sculpt *sd, Object *ob,
                                      bool need_pmap, bool need_mask)
 {
@@ -849,8 +856,6 @@ void BKE_sculpt_update_mesh_elements(Scene *scene, Sculpt *sd, Object *ob,
 
 	if (ss->modifiers_active) {
 		if (!ss->orig_cos) {
-			int a;
-
 			BKE_sculptsession_free_deformMats(ss);
 
 			ss->orig_cos = (ss->kb) ? BKE_keyblock_convert_to_vertcos(ob, ss->kb) : BKE_mesh_vertexCos_get(me, NULL);
@@ -858,9 +863,8 @@ void BKE_sculpt_update_mesh_elements(Scene *scene, Sculpt *sd, Object *ob,
 			BKE_crazyspace_build_sculpt(scene, ob, &ss->deform_imats, &ss->deform_cos);
 			BKE_pbvh_apply_vertCos(ss->pbvh, ss->deform_cos);
 
-			for (a = 0; a < me->totvert; ++a) {
-				invert_m3(ss->deform_imats[a]);
-			}
+			BLI_task_parallel_range(0, me->totvert, ss->deform_imats,
+			                        sculpt_invert_deform_imats_task_cb, (me->totvert > 10000));
 		}
 	}
 	else {
@@ -48,6 +48,7 @@
 #include "DNA_dynamicpaint_types.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_hash_mm2a.h"
 #include "BLI_noise.h"
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
@@ -580,6 +581,7 @@ void psys_free(Object *ob, ParticleSystem *psys)
 
 		BLI_bvhtree_free(psys->bvhtree);
 		BLI_kdtree_free(psys->tree);
+		psys_sph_grid_free(psys);
  
 		if (psys->fluid_springs)
 			MEM_freeN(psys->fluid_springs);
@@ -2522,6 +2524,55 @@ static void cache_key_incremental_rotation(ParticleCacheKey *key0, ParticleCache
  * - Useful for making use of opengl vertex arrays for super fast strand drawing.
  * - Makes child strands possible and creates them too into the cache.
  * - Cached path data is also used to determine cut position for the editmode tool. */
+/* Hash of everything the path cache of a plain (non keyed/baked/dynamic) hair
+ * system depends on. The hair keys themselves are included, so any groom edit
+ * invalidates the cache without the edit tools having to version it. */
+static unsigned int psys_cache_paths_hash(ParticleSimulationData *sim, Material *ma, int segments)
+{
+	ParticleSystem *psys = sim->psys;
+	ParticleSettings *part = psys->part;
+	const void *ptrs[2];
+	BLI_HashMurmur2A hm2a;
+	HairKey *hkey;
+	int k;
+	PARTICLE_P;
+
+	BLI_hash_mm2a_init(&hm2a, 0);
+
+	BLI_hash_mm2a_add_int(&hm2a, segments);
+	BLI_hash_mm2a_add_int(&hm2a, psys->totpart);
+	BLI_hash_mm2a_add_int(&hm2a, psys->flag);
+	BLI_hash_mm2a_add_int(&hm2a, psys->seed);
+	BLI_hash_mm2a_add_int(&hm2a, part->from);
+	BLI_hash_mm2a_add_int(&hm2a, part->flag);
+	BLI_hash_mm2a_add_int(&hm2a, part->draw);
+	BLI_hash_mm2a_add_int(&hm2a, part->draw_col);
+	BLI_hash_mm2a_add_int(&hm2a, part->omat);
+	BLI_hash_mm2a_add(&hm2a, (const unsigned char *)&part->path_start, sizeof(float));
+	BLI_hash_mm2a_add(&hm2a, (const unsigned char *)&part->path_end, sizeof(float));
+	BLI_hash_mm2a_add(&hm2a, (const unsigned char *)&part->randlength, sizeof(float));
+	BLI_hash_mm2a_add(&hm2a, (const unsigned char *)sim->ob->obmat, sizeof(sim->ob->obmat));
+	BLI_hash_mm2a_add(&hm2a, (const unsigned char *)psys->vgroup, sizeof(psys->vgroup));
+
+	/* new emitter or particle data means a rebuild even if the values match */
+	ptrs[0] = sim->psmd->dm_final;
+	ptrs[1] = psys->particles;
+	BLI_hash_mm2a_add(&hm2a, (const unsigned char *)ptrs, sizeof(ptrs));
+
+	if (ma && (part->draw_col == PART_DRAW_COL_MAT))
+		BLI_hash_mm2a_add(&hm2a, (const unsigned char *)&ma->r, sizeof(float) * 3);
+
+	/* the groom itself; world_co is derived data so leave it out */
+	LOOP_PARTICLES {
+		BLI_hash_mm2a_add_int(&hm2a, pa->totkey);
+		for (k = 0, hkey = pa->hair; k < pa->totkey; k++, hkey++) {
+			BLI_hash_mm2a_add(&hm2a, (const unsigned char *)hkey->co, sizeof(hkey->co) + sizeof(hkey->time));
+		}
+	}
+
+	return BLI_hash_mm2a_end(&hm2a);
+}
+
 void psys_cache_paths(ParticleSimulationData *sim, float cfra)
 {
 	PARTICLE_PSMD;
@@ -2564,15 +2615,53 @@ void psys_cache_paths(ParticleSimulationData *sim, float cfra)
 	keyed = psys->flag & PSYS_KEYED;
 	baked = psys->pointcache->mem_cache.first && psys->part->type != PART_HAIR;
 
-	/* clear out old and create new empty path cache */
-	psys_free_path_cache(psys, psys->edit);
-	cache = psys->pathcache = psys_alloc_path_cache_buffers(&psys->pathcachebufs, totpart, segments + 1);
-
 	psys->lattice_deform_data = psys_create_lattice_deform_data(sim);
 	ma = give_current_material(sim->ob, psys->part->omat);
 	if (ma && (psys->part->draw_col == PART_DRAW_COL_MAT))
 		copy_v3_v3(col, &ma->r);
 
+	/* A plain hair system's paths depend only on the groom and a handful of
+	 * settings, all cheap to hash, so the old cache can be re-used when none
+	 * of them changed. Effectors, lattices, dynamics, keyed/baked motion and
+	 * textures can animate without touching those inputs, so such systems
+	 * always rebuild. */
+	if (part->type == PART_HAIR && !keyed && !baked && hair_dm == NULL &&
+	    psys->effectors == NULL && psys->lattice_deform_data == NULL)
+	{
+		bool has_texture = false;
+		int i;
+
+		for (i = 0; i < MAX_MTEX; i++) {
+			if (part->mtex[i] && part->mtex[i]->tex) {
+				has_texture = true;
+				break;
+			}
+		}
+
+		if (!has_texture) {
+			unsigned int hash = psys_cache_paths_hash(sim, ma, segments);
+
+			if (psys->recalc == 0 && psys->pathcache && psys->totcached == totpart &&
+			    psys->pathcache_hash == hash)
+			{
+				/* groom and settings unchanged, keep the old paths */
+				return;
+			}
+
+			psys->pathcache_hash = hash;
+		}
+		else {
+			psys->pathcache_hash = 0;
+		}
+	}
+	else {
+		psys->pathcache_hash = 0;
+	}
+
+	/* clear out old and create new empty path cache */
+	psys_free_path_cache(psys, psys->edit);
+	cache = psys->pathcache = psys_alloc_path_cache_buffers(&psys->pathcachebufs, totpart, segments + 1);
+
 	if ((psys->flag & PSYS_GLOBAL_HAIR) == 0) {
 		if ((psys->part->flag & PART_CHILD_EFFECT) == 0)
 			vg_effector = psys_cache_vgroup(psmd->dm_final, psys, PSYS_VG_EFFECTOR);
@@ -47,6 +47,28 @@ void do_child_modifiers(ParticleThreadContext *ctx, ParticleSimulationData *sim,
                         ParticleTexture *ptex, const float par_co[3], const float par_vel[3], const float par_rot[4], const float par_orco[3],
                         ChildParticle *cpa, const float orco[3], float mat[4][4], ParticleKey *state, float t);
 
+/* Per-child invariants of do_child_modifiers, hoisted out of the per-key
+ * loops so noise and random number lookups only happen once per path. */
+typedef struct ChildModifierCache {
+	CurveMapping *clumpcurve;
+	CurveMapping *roughcurve;
+	float kink_amp, kink_amp_clump, kink_freq;
+	float rough1, rough2, rough_end;
+	float pa_clump;
+	float orco[3];					/* noise coordinates for do_rough */
+	float rough_rand[3];			/* random vector for rough2 and rough_end */
+	float kink_base[3];				/* kink axis in global space, before the parent rotation */
+	float clump_center_offset[3];	/* voronoi cell offset for clump noise */
+	bool use_clump_noise;
+	bool smooth_start;
+} ChildModifierCache;
+
+static void child_modifier_cache_init(ChildModifierCache *cmc, ParticleThreadContext *ctx, ParticleSimulationData *sim,
+                                      ParticleTexture *ptex, ChildParticle *cpa, const float orco[3], const float par_orco[3]);
+static void do_child_modifiers_cached(const ChildModifierCache *cmc, ParticleSimulationData *sim, ChildParticle *cpa,
+                                      const float par_co[3], const float par_vel[3], const float par_rot[4],
+                                      float mat[4][4], ParticleKey *state, float t);
+
 static void get_strand_normal(Material *ma, const float surfnor[3], float surfdist, float nor[3])
 {
 	float cross[3], nstrand[3], vnor[3], blend;
@@ -204,6 +226,7 @@ static void do_kink_spiral(ParticleThreadContext *ctx, ParticleTexture *ptex, co
 	float cut_time;
 	int start_index = 0, end_index = 0;
 	float kink_base[3];
+	ChildModifierCache cmc;
 	
 	if (ptex) {
 		kink_amp *= ptex->kink_amp;
@@ -241,6 +264,8 @@ static void do_kink_spiral(ParticleThreadContext *ctx, ParticleTexture *ptex, co
 	kink_base[part->kink_axis] = 1.0f;
 	mul_mat3_m4_v3(ctx->sim.ob->obmat, kink_base);
 	
+	child_modifier_cache_init(&cmc, ctx, &ctx->sim, ptex, cpa, orco, parent_orco);
+	
 	for (k = 0, key = keys; k < end_index; k++, key++) {
 		float par_time;
 		float *par_co, *par_vel, *par_rot;
@@ -281,7 +306,7 @@ static void do_kink_spiral(ParticleThreadContext *ctx, ParticleTexture *ptex, co
 		}
 		
 		/* apply different deformations to the child path */
-		do_child_modifiers(ctx, &ctx->sim, ptex, par_co, par_vel, par_rot, parent_orco, cpa, orco, hairmat, (ParticleKey *)key, par_time);
+		do_child_modifiers_cached(&cmc, &ctx->sim, cpa, par_co, par_vel, par_rot, hairmat, (ParticleKey *)key, par_time);
 	}
 	
 	totlen = 0.0f;
@@ -338,10 +363,13 @@ void psys_apply_child_modifiers(ParticleThreadContext *ctx, struct ListBase *mod
 	}
 	else {
 		ParticlePathIterator iter;
+		ChildModifierCache cmc;
 		
 		totkeys = ctx->segments + 1;
 		max_length = ptex->length;
 		
+		child_modifier_cache_init(&cmc, ctx, &ctx->sim, ptex, cpa, orco, parent_orco);
+		
 		for (k = 0, key = keys; k < totkeys; k++, key++) {
 			ParticleKey *par;
 			
@@ -349,7 +377,7 @@ void psys_apply_child_modifiers(ParticleThreadContext *ctx, struct ListBase *mod
 			par = (ParticleKey *)iter.parent_key;
 			
 			/* apply different deformations to the child path */
-			do_child_modifiers(ctx, &ctx->sim, ptex, par->co, par->vel, iter.parent_rotation, parent_orco, cpa, orco, hairmat, (ParticleKey *)key, iter.time);
+			do_child_modifiers_cached(&cmc, &ctx->sim, cpa, par->co, par->vel, iter.parent_rotation, hairmat, (ParticleKey *)key, iter.time);
 		}
 	}
 
@@ -396,8 +424,8 @@ void psys_apply_child_modifiers(ParticleThreadContext *ctx, struct ListBase *mod
 
 /* ------------------------------------------------------------------------- */
 
-void do_kink(ParticleKey *state, const float par_co[3], const float par_vel[3], const float par_rot[4], float time, float freq, float shape,
-             float amplitude, float flat, short type, short axis, float obmat[4][4], int smooth_start)
+static void do_kink_ex(ParticleKey *state, const float par_co[3], const float par_vel[3], const float par_rot[4], float time, float freq, float shape,
+                       float amplitude, float flat, short type, const float kink_base[3], int smooth_start)
 {
 	float kink[3] = {1.f, 0.f, 0.f}, par_vec[3], q1[4] = {1.f, 0.f, 0.f, 0.f};
 	float t, dt = 1.f, result[3];
@@ -426,11 +454,8 @@ void do_kink(ParticleKey *state, const float par_co[3], const float par_vel[3],
 	if (!ELEM(type, PART_KINK_RADIAL)) {
 		float temp[3];
 
-		kink[axis] = 1.f;
+		copy_v3_v3(kink, kink_base);
 
-		if (obmat)
-			mul_mat3_m4_v3(obmat, kink);
-		
 		mul_qt_v3(par_rot, kink);
 
 		/* make sure kink is normal to strand */
@@ -555,6 +580,18 @@ void do_kink(ParticleKey *state, const float par_co[3], const float par_vel[3],
 		copy_v3_v3(state->co, result);
 }
 
+void do_kink(ParticleKey *state, const float par_co[3], const float par_vel[3], const float par_rot[4], float time, float freq, float shape,
+             float amplitude, float flat, short type, short axis, float obmat[4][4], int smooth_start)
+{
+	float kink_base[3] = {0.f, 0.f, 0.f};
+
+	kink_base[axis] = 1.f;
+	if (obmat)
+		mul_mat3_m4_v3(obmat, kink_base);
+
+	do_kink_ex(state, par_co, par_vel, par_rot, time, freq, shape, amplitude, flat, type, kink_base, smooth_start);
+}
+
 static float do_clump_level(float result[3], const float co[3], const float par_co[3], float time,
                             float clumpfac, float clumppow, float pa_clump, CurveMapping *clumpcurve)
 {
@@ -584,19 +621,15 @@ static float do_clump_level(float result[3], const float co[3], const float par_
 	return clump;
 }
 
-float do_clump(ParticleKey *state, const float par_co[3], float time, const float orco_offset[3], float clumpfac, float clumppow, float pa_clump,
-               bool use_clump_noise, float clump_noise_size, CurveMapping *clumpcurve)
+static float do_clump_ex(ParticleKey *state, const float par_co[3], float time, float clumpfac, float clumppow, float pa_clump,
+                         const float clump_center_offset[3], CurveMapping *clumpcurve)
 {
 	float clump;
 	
-	if (use_clump_noise && clump_noise_size != 0.0f) {
-		float center[3], noisevec[3];
-		float da[4], pa[12];
+	if (clump_center_offset) {
+		float center[3];
 		
-		mul_v3_v3fl(noisevec, orco_offset, 1.0f / clump_noise_size);
-		voronoi(noisevec[0], noisevec[1], noisevec[2], da, pa, 1.0f, 0);
-		mul_v3_fl(&pa[0], clump_noise_size);
-		add_v3_v3v3(center, par_co, &pa[0]);
+		add_v3_v3v3(center, par_co, clump_center_offset);
 		
 		do_clump_level(state->co, state->co, center, time, clumpfac, clumppow, pa_clump, clumpcurve);
 	}
@@ -606,6 +639,24 @@ float do_clump(ParticleKey *state, const float par_co[3], float time, const floa
 	return clump;
 }
 
+float do_clump(ParticleKey *state, const float par_co[3], float time, const float orco_offset[3], float clumpfac, float clumppow, float pa_clump,
+               bool use_clump_noise, float clump_noise_size, CurveMapping *clumpcurve)
+{
+	float clump_center_offset[3];
+	const bool has_noise = (use_clump_noise && clump_noise_size != 0.0f);
+	
+	if (has_noise) {
+		float noisevec[3];
+		float da[4], pa[12];
+		
+		mul_v3_v3fl(noisevec, orco_offset, 1.0f / clump_noise_size);
+		voronoi(noisevec[0], noisevec[1], noisevec[2], da, pa, 1.0f, 0);
+		mul_v3_v3fl(clump_center_offset, &pa[0], clump_noise_size);
+	}
+	
+	return do_clump_ex(state, par_co, time, clumpfac, clumppow, pa_clump, has_noise ? clump_center_offset : NULL, clumpcurve);
+}
+
 static void do_rough(const float loc[3], float mat[4][4], float t, float fac, float size, float thres, ParticleKey *state)
 {
 	float rough[3];
@@ -664,76 +715,102 @@ static void do_rough_curve(const float loc[3], float mat[4][4], float time, floa
 	madd_v3_v3fl(state->co, mat[2], fac * rough[2]);
 }
 
-void do_child_modifiers(ParticleThreadContext *ctx, ParticleSimulationData *sim, ParticleTexture *ptex,
-                        const float par_co[3], const float par_vel[3], const float par_rot[4], const float par_orco[3],
-                        ChildParticle *cpa, const float orco[3], float mat[4][4], ParticleKey *state, float t)
+static void child_modifier_cache_init(ChildModifierCache *cmc, ParticleThreadContext *ctx, ParticleSimulationData *sim,
+                                      ParticleTexture *ptex, ChildParticle *cpa, const float orco[3], const float par_orco[3])
 {
 	ParticleSettings *part = sim->psys->part;
-	CurveMapping *clumpcurve = NULL, *roughcurve = NULL;
-	int i = cpa - sim->psys->child;
-	int guided = 0;
+	const int i = cpa - sim->psys->child;
 
+	cmc->clumpcurve = NULL;
+	cmc->roughcurve = NULL;
 	if (part->child_flag & PART_CHILD_USE_CLUMP_CURVE) {
-		clumpcurve = (ctx != NULL) ? ctx->clumpcurve : part->clumpcurve;
+		cmc->clumpcurve = (ctx != NULL) ? ctx->clumpcurve : part->clumpcurve;
 	}
 	if (part->child_flag & PART_CHILD_USE_ROUGH_CURVE) {
-		roughcurve = (ctx != NULL) ? ctx->roughcurve : part->roughcurve;
+		cmc->roughcurve = (ctx != NULL) ? ctx->roughcurve : part->roughcurve;
 	}
 
-	float kink_amp = part->kink_amp;
-	float kink_amp_clump = part->kink_amp_clump;
-	float kink_freq = part->kink_freq;
-	float rough1 = part->rough1;
-	float rough2 = part->rough2;
-	float rough_end = part->rough_end;
-	const bool smooth_start = (sim->psys->part->childtype == PART_CHILD_FACES);
+	cmc->kink_amp = part->kink_amp;
+	cmc->kink_amp_clump = part->kink_amp_clump;
+	cmc->kink_freq = part->kink_freq;
+	cmc->rough1 = part->rough1;
+	cmc->rough2 = part->rough2;
+	cmc->rough_end = part->rough_end;
+	cmc->pa_clump = 1.f;
+	cmc->smooth_start = (part->childtype == PART_CHILD_FACES);
 
 	if (ptex) {
-		kink_amp *= ptex->kink_amp;
-		kink_freq *= ptex->kink_freq;
-		rough1 *= ptex->rough1;
-		rough2 *= ptex->rough2;
-		rough_end *= ptex->roughe;
+		cmc->kink_amp *= ptex->kink_amp;
+		cmc->kink_freq *= ptex->kink_freq;
+		cmc->rough1 *= ptex->rough1;
+		cmc->rough2 *= ptex->rough2;
+		cmc->rough_end *= ptex->roughe;
+		cmc->pa_clump = ptex->clump;
 	}
 
+	copy_v3_v3(cmc->orco, orco);
+	psys_frand_vec(sim->psys, i + 27, cmc->rough_rand);
+
+	zero_v3(cmc->kink_base);
+	cmc->kink_base[part->kink_axis] = 1.f;
+	mul_mat3_m4_v3(sim->ob->obmat, cmc->kink_base);
+
+	cmc->use_clump_noise = ((part->child_flag & PART_CHILD_USE_CLUMP_NOISE) && part->clump_noise_size != 0.0f);
+	if (cmc->use_clump_noise) {
+		float orco_offset[3], noisevec[3];
+		float da[4], pa[12];
+
+		sub_v3_v3v3(orco_offset, orco, par_orco);
+		mul_v3_v3fl(noisevec, orco_offset, 1.0f / part->clump_noise_size);
+		voronoi(noisevec[0], noisevec[1], noisevec[2], da, pa, 1.0f, 0);
+		mul_v3_v3fl(cmc->clump_center_offset, &pa[0], part->clump_noise_size);
+	}
+}
+
+static void do_child_modifiers_cached(const ChildModifierCache *cmc, ParticleSimulationData *sim, ChildParticle *cpa,
+                                      const float par_co[3], const float par_vel[3], const float par_rot[4],
+                                      float mat[4][4], ParticleKey *state, float t)
+{
+	ParticleSettings *part = sim->psys->part;
+	int guided = 0;
+
 	if (part->flag & PART_CHILD_EFFECT)
 		/* state is safe to cast, since only co and vel are used */
-		guided = do_guides(sim->psys->part, sim->psys->effectors, (ParticleKey *)state, cpa->parent, t);
+		guided = do_guides(part, sim->psys->effectors, (ParticleKey *)state, cpa->parent, t);
 
 	if (guided == 0) {
-		float orco_offset[3];
-		float clump;
-		
-		sub_v3_v3v3(orco_offset, orco, par_orco);
-		clump = do_clump(state, par_co, t, orco_offset, part->clumpfac, part->clumppow, ptex ? ptex->clump : 1.f,
-		                 part->child_flag & PART_CHILD_USE_CLUMP_NOISE, part->clump_noise_size, clumpcurve);
+		float clump = do_clump_ex(state, par_co, t, part->clumpfac, part->clumppow, cmc->pa_clump,
+		                          cmc->use_clump_noise ? cmc->clump_center_offset : NULL, cmc->clumpcurve);
 
-		if (kink_freq != 0.f) {
-			kink_amp *= (1.f - kink_amp_clump * clump);
+		if (cmc->kink_freq != 0.f) {
+			float kink_amp = cmc->kink_amp * (1.f - cmc->kink_amp_clump * clump);
 			
-			do_kink(state, par_co, par_vel, par_rot, t, kink_freq, part->kink_shape,
-			        kink_amp, part->kink_flat, part->kink, part->kink_axis,
-			        sim->ob->obmat, smooth_start);
+			do_kink_ex(state, par_co, par_vel, par_rot, t, cmc->kink_freq, part->kink_shape,
+			           kink_amp, part->kink_flat, part->kink, cmc->kink_base, cmc->smooth_start);
 		}
 	}
 
-	if (roughcurve) {
-		do_rough_curve(orco, mat, t, rough1, part->rough1_size, roughcurve, state);
+	if (cmc->roughcurve) {
+		do_rough_curve(cmc->orco, mat, t, cmc->rough1, part->rough1_size, cmc->roughcurve, state);
 	}
 	else {
-		if (rough1 > 0.f)
-			do_rough(orco, mat, t, rough1, part->rough1_size, 0.0, state);
+		if (cmc->rough1 > 0.f)
+			do_rough(cmc->orco, mat, t, cmc->rough1, part->rough1_size, 0.0, state);
 	
-		if (rough2 > 0.f) {
-			float vec[3];
-			psys_frand_vec(sim->psys, i + 27, vec);
-			do_rough(vec, mat, t, rough2, part->rough2_size, part->rough2_thres, state);
-		}
+		if (cmc->rough2 > 0.f)
+			do_rough(cmc->rough_rand, mat, t, cmc->rough2, part->rough2_size, part->rough2_thres, state);
 	
-		if (rough_end > 0.f) {
-			float vec[3];
-			psys_frand_vec(sim->psys, i + 27, vec);
-			do_rough_end(vec, mat, t, rough_end, part->rough_end_shape, state);
-		}
+		if (cmc->rough_end > 0.f)
+			do_rough_end(cmc->rough_rand, mat, t, cmc->rough_end, part->rough_end_shape, state);
 	}
 }
+
+void do_child_modifiers(ParticleThreadContext *ctx, ParticleSimulationData *sim, ParticleTexture *ptex,
+                        const float par_co[3], const float par_vel[3], const float par_rot[4], const float par_orco[3],
+                        ChildParticle *cpa, const float orco[3], float mat[4][4], ParticleKey *state, float t)
+{
+	ChildModifierCache cmc;
+
+	child_modifier_cache_init(&cmc, ctx, sim, ptex, cpa, orco, par_orco);
+	do_child_modifiers_cached(&cmc, sim, cpa, par_co, par_vel, par_rot, mat, state, t);
+}
@@ -763,6 +763,43 @@ static void distribute_invalid(Scene *scene, ParticleSystem *psys, int from)
 	}
 }
 
+/* How many particles one random-assignment task handles;
+ * a task skips the rng stream up to its start, so chunks stay deterministic. */
+#define PSYS_TRAND_CHUNK_SIZE 32768
+
+typedef struct ParticleTrandTaskData {
+	const float *element_sum;
+	const int *element_map;
+	int *particle_element;
+	float *pos;             /* per-particle random position, for the jitter offsets */
+	int totmapped;
+	int totpart;
+	int rng_seed;
+} ParticleTrandTaskData;
+
+static void distribute_trand_chunk_exec(void *userdata, const int chunk)
+{
+	ParticleTrandTaskData *data = userdata;
+	RNG *rng = BLI_rng_new_srandom(data->rng_seed);
+	const int p_start = chunk * PSYS_TRAND_CHUNK_SIZE;
+	const int p_end = min_ii(p_start + PSYS_TRAND_CHUNK_SIZE, data->totpart);
+	int p;
+
+	/* one rng draw per particle, so skipping gives the stream of the serial loop */
+	BLI_rng_skip(rng, p_start);
+
+	for (p = p_start; p < p_end; p++) {
+		/* In theory element_sum[totelem - 1] should be 1.0,
+		 * but due to float errors this is not necessarily always true, so scale pos accordingly. */
+		const float pos = BLI_rng_get_float(rng) * data->element_sum[data->totmapped - 1];
+		data->particle_element[p] = data->element_map[
+		        distribute_binary_search((float *)data->element_sum, data->totmapped, pos)];
+		data->pos[p] = pos;
+	}
+
+	BLI_rng_free(rng);
+}
+
 /* Creates a distribution of coordinates on a DerivedMesh	*/
 /* This is to denote functionality that does not yet work with mesh - only derived mesh */
 static int psys_thread_context_init_distribute(ParticleThreadContext *ctx, ParticleSimulationData *sim, int from)
@@ -1047,15 +1084,29 @@ static int psys_thread_context_init_distribute(ParticleThreadContext *ctx, Parti
 	
 	/* Finally assign elements to particles */
 	if ((part->flag & PART_TRAND) || (part->simplify_flag & PART_SIMPLIFY_ENABLE)) {
-		float pos;
-
+		ParticleTrandTaskData taskdata;
+		const int numchunks = (totpart + PSYS_TRAND_CHUNK_SIZE - 1) / PSYS_TRAND_CHUNK_SIZE;
+		float *pa_pos = MEM_mallocN(sizeof(*pa_pos) * totpart, __func__);
+
+		taskdata.element_sum = element_sum;
+		taskdata.element_map = element_map;
+		taskdata.particle_element = particle_element;
+		taskdata.pos = pa_pos;
+		taskdata.totmapped = totmapped;
+		taskdata.totpart = totpart;
+		/* same seed the global rng was given above, each chunk replays the
+		 * serial BLI_frand() stream from its own start */
+		taskdata.rng_seed = 31415926 + psys->seed + (children ? psys->child_seed : 0);
+
+		BLI_task_parallel_range(0, numchunks, &taskdata, distribute_trand_chunk_exec, (numchunks > 1));
+
+		/* write the jitter offsets serially, several particles can land on one
+		 * element and the serial loop let the last one (in particle order) win */
 		for (p = 0; p < totpart; p++) {
-			/* In theory element_sum[totelem - 1] should be 1.0,
-			 * but due to float errors this is not necessarily always true, so scale pos accordingly. */
-			pos = BLI_frand() * element_sum[totmapped - 1];
-			particle_element[p] = element_map[distribute_binary_search(element_sum, totmapped, pos)];
-			jitter_offset[particle_element[p]] = pos;
+			jitter_offset[particle_element[p]] = pa_pos[p];
 		}
+
+		MEM_freeN(pa_pos);
 	}
 	else {
 		double step, pos;
@@ -1222,6 +1222,181 @@ void psys_get_pointcache_start_end(Scene *scene, ParticleSystem *psys, int *sfra
 	*efra = min_ii((int)(part->end + part->lifetime + 1.0f), max_ii(scene->r.pefra, scene->r.efra));
 }
 
+/************************************************/
+/*			SPH Neighbor Grid						*/
+/************************************************/
+
+/* Uniform grid over the live particle positions, used instead of the bvh for
+ * SPH neighbor lookups. Positions are snapshotted into a compact array sorted
+ * by cell, so the range queries from the threaded dynamics loop walk a few
+ * contiguous runs of floats instead of descending a tree, and the neighbor
+ * order stays deterministic between runs.
+ */
+
+#define SPH_GRID_MAX_RES 128
+#define SPH_GRID_PARALLEL_LIMIT 4096
+
+typedef struct SPHGrid {
+	float gmin[3];				/* bounding box minimum of the inserted positions */
+	float inv_cellsize[3];		/* maps position offsets to cell coordinates */
+	int res[3];
+	int totcells;
+
+	int *offsets;				/* totcells+1 entries, cell ranges into the arrays below */
+	int *index;					/* particle indices sorted by cell */
+	float (*co)[3];				/* snapshotted positions, same order as index */
+	int totpoint;
+} SPHGrid;
+
+BLI_INLINE int sph_grid_cell_axis(const SPHGrid *grid, float x, int axis)
+{
+	return min_ii(max_ii((int)((x - grid->gmin[axis]) * grid->inv_cellsize[axis]), 0), grid->res[axis] - 1);
+}
+
+void psys_sph_grid_free(ParticleSystem *psys)
+{
+	SPHGrid *grid = psys->sph_grid;
+
+	if (grid) {
+		if (grid->offsets)
+			MEM_freeN(grid->offsets);
+		if (grid->index)
+			MEM_freeN(grid->index);
+		if (grid->co)
+			MEM_freeN(grid->co);
+		MEM_freeN(grid);
+
+		psys->sph_grid = NULL;
+	}
+}
+
+typedef struct SPHGridCellsData {
+	const SPHGrid *grid;
+	const float (*co)[3];
+	int *cells;
+} SPHGridCellsData;
+
+static void sph_grid_cells_task_cb(void *userdata, const int n)
+{
+	SPHGridCellsData *data = userdata;
+	const SPHGrid *grid = data->grid;
+	const float *co = data->co[n];
+
+	data->cells[n] = sph_grid_cell_axis(grid, co[0], 0) +
+	                 (sph_grid_cell_axis(grid, co[1], 1) +
+	                  sph_grid_cell_axis(grid, co[2], 2) * grid->res[1]) * grid->res[0];
+}
+
+/* expects the bvhtree write lock to be held, see psys_update_particle_bvhtree */
+static void sph_grid_rebuild(ParticleSystem *psys, float cfra, int totpart, float cellsize)
+{
+	SPHGrid *grid;
+	SPHGridCellsData celldata;
+	float (*co)[3];
+	float gmax[3];
+	int *index, *cells, *cursor;
+	int tot = 0, n, a;
+	PARTICLE_P;
+
+	psys_sph_grid_free(psys);
+
+	co = MEM_mallocN(sizeof(*co) * totpart, "SPHGrid build co");
+	index = MEM_mallocN(sizeof(*index) * totpart, "SPHGrid build index");
+
+	LOOP_SHOWN_PARTICLES {
+		if (pa->alive == PARS_ALIVE) {
+			/* same position choice as the bvhtree build used */
+			copy_v3_v3(co[tot], (pa->state.time == cfra) ? pa->prev_state.co : pa->state.co);
+			index[tot] = p;
+			tot++;
+		}
+	}
+
+	if (tot == 0) {
+		MEM_freeN(co);
+		MEM_freeN(index);
+		return;
+	}
+
+	grid = MEM_callocN(sizeof(SPHGrid), "SPHGrid");
+
+	INIT_MINMAX(grid->gmin, gmax);
+	for (n = 0; n < tot; n++)
+		minmax_v3v3_v3(grid->gmin, gmax, co[n]);
+
+	grid->totcells = 1;
+	for (a = 0; a < 3; a++) {
+		const float extent = gmax[a] - grid->gmin[a];
+
+		grid->res[a] = max_ii((int)min_ff(extent / cellsize + 1.0f, (float)SPH_GRID_MAX_RES), 1);
+		grid->inv_cellsize[a] = (extent > FLT_EPSILON) ? (float)grid->res[a] / extent : 0.0f;
+		grid->totcells *= grid->res[a];
+	}
+
+	cells = MEM_mallocN(sizeof(*cells) * tot, "SPHGrid build cells");
+
+	celldata.grid = grid;
+	celldata.co = (const float (*)[3])co;
+	celldata.cells = cells;
+	BLI_task_parallel_range(0, tot, &celldata, sph_grid_cells_task_cb, tot > SPH_GRID_PARALLEL_LIMIT);
+
+	/* counting sort, keeps particles in index order within each cell */
+	grid->offsets = MEM_callocN(sizeof(*grid->offsets) * (grid->totcells + 1), "SPHGrid offsets");
+	for (n = 0; n < tot; n++)
+		grid->offsets[cells[n] + 1]++;
+	for (a = 0; a < grid->totcells; a++)
+		grid->offsets[a + 1] += grid->offsets[a];
+
+	grid->index = MEM_mallocN(sizeof(*grid->index) * tot, "SPHGrid index");
+	grid->co = MEM_mallocN(sizeof(*grid->co) * tot, "SPHGrid co");
+	grid->totpoint = tot;
+
+	cursor = MEM_dupallocN(grid->offsets);
+	for (n = 0; n < tot; n++) {
+		const int slot = cursor[cells[n]]++;
+
+		grid->index[slot] = index[n];
+		copy_v3_v3(grid->co[slot], co[n]);
+	}
+	MEM_freeN(cursor);
+
+	MEM_freeN(cells);
+	MEM_freeN(co);
+	MEM_freeN(index);
+
+	psys->sph_grid = grid;
+}
+
+/* same semantics as BLI_bvhtree_range_query: the callback gets every point
+ * within radius of co, with its stored position and squared distance */
+static void sph_grid_range_query(const SPHGrid *grid, const float co[3], float radius,
+                                 BVHTree_RangeQuery callback, void *userdata)
+{
+	const float radius_sq = radius * radius;
+	int cmin[3], cmax[3], c[3], a;
+
+	for (a = 0; a < 3; a++) {
+		cmin[a] = sph_grid_cell_axis(grid, co[a] - radius, a);
+		cmax[a] = sph_grid_cell_axis(grid, co[a] + radius, a);
+	}
+
+	for (c[2] = cmin[2]; c[2] <= cmax[2]; c[2]++) {
+		for (c[1] = cmin[1]; c[1] <= cmax[1]; c[1]++) {
+			for (c[0] = cmin[0]; c[0] <= cmax[0]; c[0]++) {
+				const int cell = c[0] + (c[1] + c[2] * grid->res[1]) * grid->res[0];
+				int n;
+
+				for (n = grid->offsets[cell]; n < grid->offsets[cell + 1]; n++) {
+					const float dist_sq = len_squared_v3v3(grid->co[n], co);
+
+					if (dist_sq <= radius_sq)
+						callback(userdata, grid->index[n], grid->co[n], dist_sq);
+				}
+			}
+		}
+	}
+}
+
 /************************************************/
 /*			Effectors							*/
 /************************************************/
@@ -1233,28 +1408,43 @@ static void psys_update_particle_bvhtree(ParticleSystem *psys, float cfra)
 		bool need_rebuild;
 
 		BLI_rw_mutex_lock(&psys_bvhtree_rwlock, THREAD_LOCK_READ);
-		need_rebuild = !psys->bvhtree || psys->bvhtree_frame != cfra;
+		need_rebuild = (!psys->bvhtree && !psys->sph_grid) || psys->bvhtree_frame != cfra;
 		BLI_rw_mutex_unlock(&psys_bvhtree_rwlock);
 		
 		if (need_rebuild) {
+			SPHFluidSettings *fluid = psys->part->fluid;
+			float cellsize = fluid ? fluid->radius * ((fluid->flag & SPH_FAC_RADIUS) ? 4.0f * psys->part->size : 1.0f) : 0.0f;
+
 			LOOP_SHOWN_PARTICLES {
 				totpart++;
 			}
 			
 			BLI_rw_mutex_lock(&psys_bvhtree_rwlock, THREAD_LOCK_WRITE);
 			
-			BLI_bvhtree_free(psys->bvhtree);
-			psys->bvhtree = BLI_bvhtree_new(totpart, 0.0, 4, 6);
-			
-			LOOP_SHOWN_PARTICLES {
-				if (pa->alive == PARS_ALIVE) {
-					if (pa->state.time == cfra)
-						BLI_bvhtree_insert(psys->bvhtree, p, pa->prev_state.co, 1);
-					else
-						BLI_bvhtree_insert(psys->bvhtree, p, pa->state.co, 1);
+			if (cellsize > 0.0f) {
+				/* fluids only query through sph_evaluate_func, where the grid
+				 * replaces the bvh descent with linear scans over a few cells */
+				BLI_bvhtree_free(psys->bvhtree);
+				psys->bvhtree = NULL;
+
+				sph_grid_rebuild(psys, cfra, totpart, cellsize);
+			}
+			else {
+				psys_sph_grid_free(psys);
+
+				BLI_bvhtree_free(psys->bvhtree);
+				psys->bvhtree = BLI_bvhtree_new(totpart, 0.0, 4, 6);
+				
+				LOOP_SHOWN_PARTICLES {
+					if (pa->alive == PARS_ALIVE) {
+						if (pa->state.time == cfra)
+							BLI_bvhtree_insert(psys->bvhtree, p, pa->prev_state.co, 1);
+						else
+							BLI_bvhtree_insert(psys->bvhtree, p, pa->state.co, 1);
+					}
 				}
+				BLI_bvhtree_balance(psys->bvhtree);
 			}
-			BLI_bvhtree_balance(psys->bvhtree);
 			
 			psys->bvhtree_frame = cfra;
 			
@@ -1578,7 +1768,10 @@ static void sph_evaluate_func(BVHTree *tree, ParticleSystem **psys, float co[3],
 		else {
 			BLI_rw_mutex_lock(&psys_bvhtree_rwlock, THREAD_LOCK_READ);
 			
-			BLI_bvhtree_range_query(psys[i]->bvhtree, co, interaction_radius, callback, pfr);
+			if (psys[i]->sph_grid)
+				sph_grid_range_query(psys[i]->sph_grid, co, interaction_radius, callback, pfr);
+			else if (psys[i]->bvhtree)
+				BLI_bvhtree_range_query(psys[i]->bvhtree, co, interaction_radius, callback, pfr);
 			
 			BLI_rw_mutex_unlock(&psys_bvhtree_rwlock);
 		}
@@ -3454,12 +3647,40 @@ static void dynamics_step_sph_classical_integrate_task_cb_ex(
 	}
 }
 
+static void dynamics_step_boids_task_cb_ex(
+        void *userdata, void *userdata_chunk, const int p, const int UNUSED(thread_id))
+{
+	DynamicStepSolverTaskData *data = userdata;
+	ParticleSimulationData *sim = data->sim;
+	ParticleSystem *psys = sim->psys;
+
+	/* scratch data for the rules, each chunk of particles gets its own copy */
+	BoidBrainData *bbd = userdata_chunk;
+
+	ParticleData *pa;
+
+	if ((pa = psys->particles + p)->state.time <= 0.0f) {
+		return;
+	}
+
+	bbd->goal_ob = NULL;
+
+	boid_brain(bbd, p, pa);
+
+	if (pa->alive != PARS_DYING) {
+		boid_body(bbd, pa);
+
+		/* deflection */
+		if (sim->colliders)
+			collision_check(sim, p, pa->state.time, data->cfra);
+	}
+}
+
 /* unbaked particles are calculated dynamically */
 static void dynamics_step(ParticleSimulationData *sim, float cfra)
 {
 	ParticleSystem *psys = sim->psys;
 	ParticleSettings *part=psys->part;
-	RNG *rng;
 	BoidBrainData bbd;
 	ParticleTexture ptex;
 	PARTICLE_P;
@@ -3487,8 +3708,6 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
 	}
 
 	BLI_srandom(31415926 + (int)cfra + psys->seed);
-	/* for now do both, boids us 'rng' */
-	rng = BLI_rng_new_srandom(31415926 + (int)cfra + psys->seed);
 
 	psys_update_effectors(sim);
 
@@ -3505,7 +3724,6 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
 			bbd.cfra = cfra;
 			bbd.dfra = dfra;
 			bbd.timestep = timestep;
-			bbd.rng = rng;
 
 			psys_update_particle_tree(psys, cfra);
 
@@ -3592,19 +3810,16 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
 		}
 		case PART_PHYS_BOIDS:
 		{
-			LOOP_DYNAMIC_PARTICLES {
-				bbd.goal_ob = NULL;
-				
-				boid_brain(&bbd, p, pa);
+			DynamicStepSolverTaskData task_data = {
+			    .sim = sim, .cfra = cfra, .timestep = timestep, .dtime = dtime,
+			};
 
-				if (pa->alive != PARS_DYING) {
-					boid_body(&bbd, pa);
+			/* the rules only read the previous state of other boids and the particle
+			 * tree built above, so the brains can be evaluated in parallel */
+			BLI_task_parallel_range_ex(
+			            0, psys->totpart, &task_data, &bbd, sizeof(bbd),
+			            dynamics_step_boids_task_cb_ex, psys->totpart > 100, true);
 
-					/* deflection */
-					if (sim->colliders)
-						collision_check(sim, p, pa->state.time, cfra);
-				}
-			}
 			break;
 		}
 		case PART_PHYS_FLUID:
@@ -3669,7 +3884,6 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
 	}
 
 	free_collider_cache(&sim->colliders);
-	BLI_rng_free(rng);
 }
 static void update_children(ParticleSimulationData *sim)
 {
@@ -57,6 +57,24 @@
 
 #define PBVH_THREADED_LIMIT 4
 
+/* number of spatial buckets a leaf's unique vertices are sorted into for
+ * sphere-restricted iteration, see pbvh_node_buckets_ensure */
+#define PBVH_VERT_BUCKETS_AXIS 4
+#define PBVH_VERT_BUCKETS_TOT \
+	(PBVH_VERT_BUCKETS_AXIS * PBVH_VERT_BUCKETS_AXIS * PBVH_VERT_BUCKETS_AXIS)
+
+typedef struct PBVHVertBuckets {
+	/* bounds of the unique vertices at build time (node->vb may lag behind) */
+	float bmin[3];
+	float bucket_size[3];
+	/* bucket b owns verts[offsets[b]..offsets[b + 1]) */
+	int offsets[PBVH_VERT_BUCKETS_TOT + 1];
+	/* node-local positions into node->vert_indices, sorted by bucket */
+	int *verts;
+} PBVHVertBuckets;
+
+static void pbvh_node_buckets_free(PBVHNode *node);
+
 typedef struct PBVHStack {
 	PBVHNode *node;
 	bool revisiting;
@@ -628,6 +646,7 @@ void BKE_pbvh_free(PBVH *bvh)
 			if (node->face_vert_indices)
 				MEM_freeN((void *)node->face_vert_indices);
 			BKE_pbvh_node_layer_disp_free(node);
+			pbvh_node_buckets_free(node);
 
 			if (node->bm_faces)
 				BLI_gset_free(node->bm_faces, NULL);
@@ -1085,10 +1104,30 @@ void pbvh_update_BB_redraw(PBVH *bvh, PBVHNode **nodes, int totnode, int flag)
 	BLI_task_parallel_range(0, totnode, &data, pbvh_update_BB_redraw_task_cb, totnode > PBVH_THREADED_LIMIT);
 }
 
+static void pbvh_update_draw_buffer_fill_task_cb(void *userdata, const int n)
+{
+	PBVHUpdateData *data = userdata;
+	PBVH *bvh = data->bvh;
+	PBVHNode *node = data->nodes[n];
+
+	if (node->flag & PBVH_UpdateDrawBuffers) {
+		if (bvh->type == PBVH_GRIDS)
+			GPU_update_grid_pbvh_buffers_fill(node->draw_buffers);
+		else
+			GPU_update_mesh_pbvh_buffers_fill(node->draw_buffers);
+	}
+}
+
 static void pbvh_update_draw_buffers(PBVH *bvh, PBVHNode **nodes, int totnode)
 {
-	/* can't be done in parallel with OpenGL */
-	for (int n = 0; n < totnode; n++) {
+	PBVHUpdateData data = {
+		.bvh = bvh, .nodes = nodes,
+	};
+	int n;
+
+	/* opengl buffer creation, mapping and unmapping can't be done in parallel,
+	 * only the vertex data fill in between is threaded below */
+	for (n = 0; n < totnode; n++) {
 		PBVHNode *node = nodes[n];
 
 		if (node->flag & PBVH_RebuildDrawBuffers) {
@@ -1097,18 +1136,18 @@ static void pbvh_update_draw_buffers(PBVH *bvh, PBVHNode **nodes, int totnode)
 				case PBVH_GRIDS:
 					node->draw_buffers =
 						GPU_build_grid_pbvh_buffers(node->prim_indices,
-					                           node->totprim,
-					                           bvh->grid_hidden,
-					                           bvh->gridkey.grid_size,
-					                           &bvh->gridkey);
+				                           node->totprim,
+				                           bvh->grid_hidden,
+				                           bvh->gridkey.grid_size,
+				                           &bvh->gridkey);
 					break;
 				case PBVH_FACES:
 					node->draw_buffers =
 						GPU_build_mesh_pbvh_buffers(node->face_vert_indices,
-					                           bvh->mpoly, bvh->mloop, bvh->looptri,
-					                           bvh->verts,
-					                           node->prim_indices,
-					                           node->totprim);
+				                           bvh->mpoly, bvh->mloop, bvh->looptri,
+				                           bvh->verts,
+				                           node->prim_indices,
+				                           node->totprim);
 					break;
 				case PBVH_BMESH:
 					node->draw_buffers =
@@ -1122,7 +1161,7 @@ static void pbvh_update_draw_buffers(PBVH *bvh, PBVHNode **nodes, int totnode)
 		if (node->flag & PBVH_UpdateDrawBuffers) {
 			switch (bvh->type) {
 				case PBVH_GRIDS:
-					GPU_update_grid_pbvh_buffers(node->draw_buffers,
+					GPU_update_grid_pbvh_buffers_begin(node->draw_buffers,
 					                        bvh->grids,
 					                        bvh->grid_flag_mats,
 					                        node->prim_indices,
@@ -1131,7 +1170,7 @@ static void pbvh_update_draw_buffers(PBVH *bvh, PBVHNode **nodes, int totnode)
 					                        bvh->show_diffuse_color);
 					break;
 				case PBVH_FACES:
-					GPU_update_mesh_pbvh_buffers(node->draw_buffers,
+					GPU_update_mesh_pbvh_buffers_begin(node->draw_buffers,
 					                        bvh->verts,
 					                        node->vert_indices,
 					                        node->uniq_verts +
@@ -1142,16 +1181,30 @@ static void pbvh_update_draw_buffers(PBVH *bvh, PBVHNode **nodes, int totnode)
 					                        bvh->show_diffuse_color);
 					break;
 				case PBVH_BMESH:
+					/* bmesh fills interleave gl buffer management, keep serial */
 					GPU_update_bmesh_pbvh_buffers(node->draw_buffers,
 					                         bvh->bm,
 					                         node->bm_faces,
 					                         node->bm_unique_verts,
 					                         node->bm_other_verts,
 					                         bvh->show_diffuse_color);
+					node->flag &= ~PBVH_UpdateDrawBuffers;
 					break;
 			}
+		}
+	}
+
+	if (bvh->type != PBVH_BMESH) {
+		BLI_task_parallel_range(0, totnode, &data, pbvh_update_draw_buffer_fill_task_cb,
+		                        totnode > PBVH_THREADED_LIMIT);
+
+		for (n = 0; n < totnode; n++) {
+			PBVHNode *node = nodes[n];
 
-			node->flag &= ~PBVH_UpdateDrawBuffers;
+			if (node->flag & PBVH_UpdateDrawBuffers) {
+				GPU_update_pbvh_buffers_end(node->draw_buffers);
+				node->flag &= ~PBVH_UpdateDrawBuffers;
+			}
 		}
 	}
 }
@@ -1340,6 +1393,9 @@ BMesh *BKE_pbvh_get_bmesh(PBVH *bvh)
 void BKE_pbvh_node_mark_update(PBVHNode *node)
 {
 	node->flag |= PBVH_UpdateNormals | PBVH_UpdateBB | PBVH_UpdateOriginalBB | PBVH_UpdateDrawBuffers | PBVH_UpdateRedraw;
+
+	/* vertices are about to move, the spatial buckets are stale now */
+	pbvh_node_buckets_free(node);
 }
 
 void BKE_pbvh_node_mark_rebuild_draw(PBVHNode *node)
@@ -2015,6 +2071,134 @@ void BKE_pbvh_gather_proxies(PBVH *pbvh, PBVHNode ***r_array,  int *r_tot)
 	*r_tot = tot;
 }
 
+/************************* Vertex Spatial Buckets ****************************/
+
+static void pbvh_node_buckets_free(PBVHNode *node)
+{
+	if (node->vert_buckets) {
+		MEM_freeN(node->vert_buckets->verts);
+		MEM_freeN(node->vert_buckets);
+		node->vert_buckets = NULL;
+	}
+}
+
+BLI_INLINE int pbvh_vert_bucket_index(const PBVHVertBuckets *buckets, const float co[3])
+{
+	int b = 0, j;
+
+	for (j = 0; j < 3; j++) {
+		int a = 0;
+
+		if (buckets->bucket_size[j] > 0.0f) {
+			a = (int)((co[j] - buckets->bmin[j]) / buckets->bucket_size[j]);
+			CLAMP(a, 0, PBVH_VERT_BUCKETS_AXIS - 1);
+		}
+
+		b = b * PBVH_VERT_BUCKETS_AXIS + a;
+	}
+
+	return b;
+}
+
+/* Sort the node's unique vertices into a small uniform grid of buckets so a
+ * brush can reject the vertices of an entire bucket with one bounds test.
+ * Built on first use and thrown away by BKE_pbvh_node_mark_update, which runs
+ * before any vertices move. */
+static void pbvh_node_buckets_ensure(PBVH *bvh, PBVHNode *node)
+{
+	PBVHVertBuckets *buckets;
+	float bmax[3];
+	int counts[PBVH_VERT_BUCKETS_TOT] = {0};
+	const int totvert = node->uniq_verts;
+	int i, b, j;
+
+	if (node->vert_buckets)
+		return;
+
+	buckets = MEM_callocN(sizeof(PBVHVertBuckets), "PBVHVertBuckets");
+	buckets->verts = MEM_mallocN(sizeof(int) * totvert, "PBVHVertBuckets.verts");
+
+	INIT_MINMAX(buckets->bmin, bmax);
+	for (i = 0; i < totvert; i++)
+		minmax_v3v3_v3(buckets->bmin, bmax, bvh->verts[node->vert_indices[i]].co);
+
+	for (j = 0; j < 3; j++)
+		buckets->bucket_size[j] = (bmax[j] - buckets->bmin[j]) / PBVH_VERT_BUCKETS_AXIS;
+
+	/* counting sort on the bucket index */
+	for (i = 0; i < totvert; i++)
+		counts[pbvh_vert_bucket_index(buckets, bvh->verts[node->vert_indices[i]].co)]++;
+
+	buckets->offsets[0] = 0;
+	for (b = 0; b < PBVH_VERT_BUCKETS_TOT; b++)
+		buckets->offsets[b + 1] = buckets->offsets[b] + counts[b];
+
+	copy_vn_i(counts, PBVH_VERT_BUCKETS_TOT, 0);
+	for (i = 0; i < totvert; i++) {
+		b = pbvh_vert_bucket_index(buckets, bvh->verts[node->vert_indices[i]].co);
+		buckets->verts[buckets->offsets[b] + counts[b]] = i;
+		counts[b]++;
+	}
+
+	node->vert_buckets = buckets;
+}
+
+/* bitmask of the buckets whose bounds intersect the given sphere */
+static unsigned long long pbvh_vert_buckets_sphere_mask(
+        const PBVHVertBuckets *buckets, const float center[3], float radius_squared)
+{
+	unsigned long long mask = 0;
+	int x, y, z, j, b = 0;
+
+	for (x = 0; x < PBVH_VERT_BUCKETS_AXIS; x++) {
+		for (y = 0; y < PBVH_VERT_BUCKETS_AXIS; y++) {
+			for (z = 0; z < PBVH_VERT_BUCKETS_AXIS; z++, b++) {
+				const int axis[3] = {x, y, z};
+				float dist_sq = 0.0f;
+
+				for (j = 0; j < 3; j++) {
+					const float lo = buckets->bmin[j] + axis[j] * buckets->bucket_size[j];
+					const float hi = lo + buckets->bucket_size[j];
+
+					if      (center[j] < lo) dist_sq += SQUARE(lo - center[j]);
+					else if (center[j] > hi) dist_sq += SQUARE(center[j] - hi);
+				}
+
+				if (dist_sq <= radius_squared)
+					mask |= 1ULL << b;
+			}
+		}
+	}
+
+	return mask;
+}
+
+void pbvh_vertex_iter_init_sphere(PBVH *bvh, PBVHNode *node,
+                                  PBVHVertexIter *vi, int mode,
+                                  const float center[3], float radius_squared)
+{
+	pbvh_vertex_iter_init(bvh, node, vi, mode);
+
+	if (bvh->type == PBVH_FACES && mode == PBVH_ITER_UNIQUE) {
+		pbvh_node_buckets_ensure(bvh, node);
+
+		vi->bucket_verts = node->vert_buckets->verts;
+		vi->bucket_offsets = node->vert_buckets->offsets;
+		vi->tot_buckets = PBVH_VERT_BUCKETS_TOT;
+		vi->bucket_mask = pbvh_vert_buckets_sphere_mask(node->vert_buckets,
+		                                                center, radius_squared);
+	}
+	else {
+		/* PBVH_ITER_ALL falls back to one bucket spanning all vertices */
+		vi->bucket_verts = NULL;
+		vi->bucket_fallback[0] = 0;
+		vi->bucket_fallback[1] = vi->totvert;
+		vi->bucket_offsets = vi->bucket_fallback;
+		vi->tot_buckets = 1;
+		vi->bucket_mask = 1;
+	}
+}
+
 void pbvh_vertex_iter_init(PBVH *bvh, PBVHNode *node,
                            PBVHVertexIter *vi, int mode)
 {
@@ -79,6 +79,11 @@ struct PBVHNode {
 	const int *vert_indices;
 	unsigned int uniq_verts, face_verts;
 
+	/* Lazily built spatial buckets over the unique vertices, so brushes can
+	 * skip whole groups of vertices outside their radius.  Invalidated
+	 * whenever the node is marked for update (mesh-based PBVH only). */
+	struct PBVHVertBuckets *vert_buckets;
+
 	/* An array mapping face corners into the vert_indices
 	 * array. The array is sized to match 'totprim', and each of
 	 * the face's corners gets an index into the vert_indices
@@ -47,6 +47,7 @@
 #include "DNA_smoke_types.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
@@ -138,11 +139,25 @@ static int ptcache_extra_datasize[] = {
 	sizeof(ParticleSpring)
 };
 
+/* a block of sample data compressed independently of the others, so large
+ * frames can compress their blocks in parallel before writing them in order */
+typedef struct PTCacheCompressedChunk {
+	unsigned char *in;         /* source data, not owned */
+	unsigned int in_len;
+	unsigned char *out;        /* compression buffer, LZO_OUT_LEN(in_len) bytes, owned by the caller */
+	size_t out_len;
+	unsigned char compressed;  /* 0: raw, 1: lzo, 2: lzma, same flag as written to the file */
+	unsigned char props[16];   /* lzma stream properties */
+	size_t props_len;
+} PTCacheCompressedChunk;
+
 /* forward declerations */
 static int ptcache_file_compressed_read(PTCacheFile *pf, unsigned char *result, unsigned int len);
 static int ptcache_file_compressed_write(PTCacheFile *pf, unsigned char *in, unsigned int in_len, unsigned char *out, int mode);
+static void ptcache_file_compressed_write_chunks(PTCacheFile *pf, PTCacheCompressedChunk *chunks, int totchunk, int mode);
 static int ptcache_file_write(PTCacheFile *pf, const void *f, unsigned int tot, unsigned int size);
 static int ptcache_file_read(PTCacheFile *pf, void *f, unsigned int tot, unsigned int size);
+static int ptcache_async_write_flush(void);
 
 /* Common functions */
 static int ptcache_basic_header_read(PTCacheFile *pf)
@@ -596,33 +611,41 @@ static int  ptcache_smoke_write(PTCacheFile *pf, void *smoke_v)
 		float dt, dx, *dens, *react, *fuel, *flame, *heat, *heatold, *vx, *vy, *vz, *r, *g, *b;
 		unsigned char *obstacles;
 		unsigned int in_len = sizeof(float)*(unsigned int)res;
-		unsigned char *out = (unsigned char *)MEM_callocN(LZO_OUT_LEN(in_len) * 4, "pointcache_lzo_buffer");
+		PTCacheCompressedChunk chunks[14];
+		int totchunk = 0;
 		//int mode = res >= 1000000 ? 2 : 1;
 		int mode=1;		// light
 		if (sds->cache_comp == SM_CACHE_HEAVY) mode=2;	// heavy
 
 		smoke_export(sds->fluid, &dt, &dx, &dens, &react, &flame, &fuel, &heat, &heatold, &vx, &vy, &vz, &r, &g, &b, &obstacles);
 
-		ptcache_file_compressed_write(pf, (unsigned char *)sds->shadow, in_len, out, mode);
-		ptcache_file_compressed_write(pf, (unsigned char *)dens, in_len, out, mode);
+		/* gather the fields first so they compress in parallel, the file
+		 * order is unchanged */
+#define SMOKE_CHUNK(ptr, len) { chunks[totchunk].in = (unsigned char *)(ptr); chunks[totchunk].in_len = (len); totchunk++; } (void)0
+
+		SMOKE_CHUNK(sds->shadow, in_len);
+		SMOKE_CHUNK(dens, in_len);
 		if (fluid_fields & SM_ACTIVE_HEAT) {
-			ptcache_file_compressed_write(pf, (unsigned char *)heat, in_len, out, mode);
-			ptcache_file_compressed_write(pf, (unsigned char *)heatold, in_len, out, mode);
+			SMOKE_CHUNK(heat, in_len);
+			SMOKE_CHUNK(heatold, in_len);
 		}
 		if (fluid_fields & SM_ACTIVE_FIRE) {
-			ptcache_file_compressed_write(pf, (unsigned char *)flame, in_len, out, mode);
-			ptcache_file_compressed_write(pf, (unsigned char *)fuel, in_len, out, mode);
-			ptcache_file_compressed_write(pf, (unsigned char *)react, in_len, out, mode);
+			SMOKE_CHUNK(flame, in_len);
+			SMOKE_CHUNK(fuel, in_len);
+			SMOKE_CHUNK(react, in_len);
 		}
 		if (fluid_fields & SM_ACTIVE_COLORS) {
-			ptcache_file_compressed_write(pf, (unsigned char *)r, in_len, out, mode);
-			ptcache_file_compressed_write(pf, (unsigned char *)g, in_len, out, mode);
-			ptcache_file_compressed_write(pf, (unsigned char *)b, in_len, out, mode);
-		}
-		ptcache_file_compressed_write(pf, (unsigned char *)vx, in_len, out, mode);
-		ptcache_file_compressed_write(pf, (unsigned char *)vy, in_len, out, mode);
-		ptcache_file_compressed_write(pf, (unsigned char *)vz, in_len, out, mode);
-		ptcache_file_compressed_write(pf, (unsigned char *)obstacles, (unsigned int)res, out, mode);
+			SMOKE_CHUNK(r, in_len);
+			SMOKE_CHUNK(g, in_len);
+			SMOKE_CHUNK(b, in_len);
+		}
+		SMOKE_CHUNK(vx, in_len);
+		SMOKE_CHUNK(vy, in_len);
+		SMOKE_CHUNK(vz, in_len);
+		SMOKE_CHUNK(obstacles, (unsigned int)res);
+
+		ptcache_file_compressed_write_chunks(pf, chunks, totchunk, mode);
+
 		ptcache_file_write(pf, &dt, 1, sizeof(float));
 		ptcache_file_write(pf, &dx, 1, sizeof(float));
 		ptcache_file_write(pf, &sds->p0, 3, sizeof(float));
@@ -635,8 +658,6 @@ static int  ptcache_smoke_write(PTCacheFile *pf, void *smoke_v)
 		ptcache_file_write(pf, &sds->res_min, 3, sizeof(int));
 		ptcache_file_write(pf, &sds->res_max, 3, sizeof(int));
 		ptcache_file_write(pf, &sds->active_color, 3, sizeof(float));
-
-		MEM_freeN(out);
 		
 		ret = 1;
 	}
@@ -648,7 +669,8 @@ static int  ptcache_smoke_write(PTCacheFile *pf, void *smoke_v)
 		float *dens, *react, *fuel, *flame, *tcu, *tcv, *tcw, *r, *g, *b;
 		unsigned int in_len = sizeof(float)*(unsigned int)res;
 		unsigned int in_len_big;
-		unsigned char *out;
+		PTCacheCompressedChunk chunks[10];
+		int totchunk = 0;
 		int mode;
 
 		smoke_turbulence_get_res(sds->wt, res_big_array);
@@ -661,25 +683,24 @@ static int  ptcache_smoke_write(PTCacheFile *pf, void *smoke_v)
 
 		smoke_turbulence_export(sds->wt, &dens, &react, &flame, &fuel, &r, &g, &b, &tcu, &tcv, &tcw);
 
-		out = (unsigned char *)MEM_callocN(LZO_OUT_LEN(in_len_big), "pointcache_lzo_buffer");
-		ptcache_file_compressed_write(pf, (unsigned char *)dens, in_len_big, out, mode);
+		SMOKE_CHUNK(dens, in_len_big);
 		if (fluid_fields & SM_ACTIVE_FIRE) {
-			ptcache_file_compressed_write(pf, (unsigned char *)flame, in_len_big, out, mode);
-			ptcache_file_compressed_write(pf, (unsigned char *)fuel, in_len_big, out, mode);
-			ptcache_file_compressed_write(pf, (unsigned char *)react, in_len_big, out, mode);
+			SMOKE_CHUNK(flame, in_len_big);
+			SMOKE_CHUNK(fuel, in_len_big);
+			SMOKE_CHUNK(react, in_len_big);
 		}
 		if (fluid_fields & SM_ACTIVE_COLORS) {
-			ptcache_file_compressed_write(pf, (unsigned char *)r, in_len_big, out, mode);
-			ptcache_file_compressed_write(pf, (unsigned char *)g, in_len_big, out, mode);
-			ptcache_file_compressed_write(pf, (unsigned char *)b, in_len_big, out, mode);
+			SMOKE_CHUNK(r, in_len_big);
+			SMOKE_CHUNK(g, in_len_big);
+			SMOKE_CHUNK(b, in_len_big);
 		}
-		MEM_freeN(out);
+		SMOKE_CHUNK(tcu, in_len);
+		SMOKE_CHUNK(tcv, in_len);
+		SMOKE_CHUNK(tcw, in_len);
 
-		out = (unsigned char *)MEM_callocN(LZO_OUT_LEN(in_len), "pointcache_lzo_buffer");
-		ptcache_file_compressed_write(pf, (unsigned char *)tcu, in_len, out, mode);
-		ptcache_file_compressed_write(pf, (unsigned char *)tcv, in_len, out, mode);
-		ptcache_file_compressed_write(pf, (unsigned char *)tcw, in_len, out, mode);
-		MEM_freeN(out);
+		ptcache_file_compressed_write_chunks(pf, chunks, totchunk, mode);
+
+#undef SMOKE_CHUNK
 		
 		ret = 1;
 	}
@@ -1961,60 +1982,110 @@ static int ptcache_file_compressed_read(PTCacheFile *pf, unsigned char *result,
 
 	return r;
 }
-static int ptcache_file_compressed_write(PTCacheFile *pf, unsigned char *in, unsigned int in_len, unsigned char *out, int mode)
+/* compress one chunk into chunk->out; pure computation on private buffers,
+ * so any number of chunks can run concurrently */
+static int ptcache_compress_chunk(PTCacheCompressedChunk *chunk, int mode)
 {
 	int r = 0;
-	unsigned char compressed = 0;
-	size_t out_len= 0;
-	unsigned char *props = MEM_callocN(16 * sizeof(char), "tmp");
-	size_t sizeOfIt = 5;
 
 	(void)mode; /* unused when building w/o compression */
 
+	chunk->compressed = 0;
+	chunk->out_len = 0;
+	chunk->props_len = 5;
+
 #ifdef WITH_LZO
-	out_len= LZO_OUT_LEN(in_len);
+	chunk->out_len = LZO_OUT_LEN(chunk->in_len);
 	if (mode == 1) {
 		LZO_HEAP_ALLOC(wrkmem, LZO1X_MEM_COMPRESS);
 		
-		r = lzo1x_1_compress(in, (lzo_uint)in_len, out, (lzo_uint *)&out_len, wrkmem);
-		if (!(r == LZO_E_OK) || (out_len >= in_len))
-			compressed = 0;
+		r = lzo1x_1_compress(chunk->in, (lzo_uint)chunk->in_len, chunk->out, (lzo_uint *)&chunk->out_len, wrkmem);
+		if (!(r == LZO_E_OK) || (chunk->out_len >= chunk->in_len))
+			chunk->compressed = 0;
 		else
-			compressed = 1;
+			chunk->compressed = 1;
 	}
 #endif
 #ifdef WITH_LZMA
 	if (mode == 2) {
 		
-		r = LzmaCompress(out, &out_len, in, in_len, //assume sizeof(char)==1....
-		                 props, &sizeOfIt, 5, 1 << 24, 3, 0, 2, 32, 2);
+		r = LzmaCompress(chunk->out, &chunk->out_len, chunk->in, chunk->in_len, //assume sizeof(char)==1....
+		                 chunk->props, &chunk->props_len, 5, 1 << 24, 3, 0, 2, 32, 2);
 
-		if (!(r == SZ_OK) || (out_len >= in_len))
-			compressed = 0;
+		if (!(r == SZ_OK) || (chunk->out_len >= chunk->in_len))
+			chunk->compressed = 0;
 		else
-			compressed = 2;
+			chunk->compressed = 2;
 	}
 #endif
-	
-	ptcache_file_write(pf, &compressed, 1, sizeof(unsigned char));
-	if (compressed) {
-		unsigned int size = out_len;
+
+	return r;
+}
+
+static void ptcache_file_compressed_chunk_write(PTCacheFile *pf, PTCacheCompressedChunk *chunk)
+{
+	ptcache_file_write(pf, &chunk->compressed, 1, sizeof(unsigned char));
+	if (chunk->compressed) {
+		unsigned int size = chunk->out_len;
 		ptcache_file_write(pf, &size, 1, sizeof(unsigned int));
-		ptcache_file_write(pf, out, out_len, sizeof(unsigned char));
+		ptcache_file_write(pf, chunk->out, chunk->out_len, sizeof(unsigned char));
 	}
 	else
-		ptcache_file_write(pf, in, in_len, sizeof(unsigned char));
+		ptcache_file_write(pf, chunk->in, chunk->in_len, sizeof(unsigned char));
 
-	if (compressed == 2) {
-		unsigned int size = sizeOfIt;
-		ptcache_file_write(pf, &sizeOfIt, 1, sizeof(unsigned int));
-		ptcache_file_write(pf, props, size, sizeof(unsigned char));
+	if (chunk->compressed == 2) {
+		unsigned int size = chunk->props_len;
+		ptcache_file_write(pf, &size, 1, sizeof(unsigned int));
+		ptcache_file_write(pf, chunk->props, size, sizeof(unsigned char));
 	}
+}
 
-	MEM_freeN(props);
+static int ptcache_file_compressed_write(PTCacheFile *pf, unsigned char *in, unsigned int in_len, unsigned char *out, int mode)
+{
+	PTCacheCompressedChunk chunk;
+	int r;
+
+	chunk.in = in;
+	chunk.in_len = in_len;
+	chunk.out = out;
+
+	r = ptcache_compress_chunk(&chunk, mode);
+	ptcache_file_compressed_chunk_write(pf, &chunk);
 
 	return r;
 }
+
+typedef struct PTCacheCompressTaskData {
+	PTCacheCompressedChunk *chunks;
+	int mode;
+} PTCacheCompressTaskData;
+
+static void ptcache_compress_chunk_task_cb(void *userdata, const int i)
+{
+	PTCacheCompressTaskData *data = userdata;
+
+	ptcache_compress_chunk(&data->chunks[i], data->mode);
+}
+
+/* compress the chunks in parallel, then write them out in order */
+static void ptcache_file_compressed_write_chunks(PTCacheFile *pf, PTCacheCompressedChunk *chunks, int totchunk, int mode)
+{
+	PTCacheCompressTaskData data;
+	int i;
+
+	for (i = 0; i < totchunk; i++)
+		chunks[i].out = (unsigned char *)MEM_mallocN(LZO_OUT_LEN(chunks[i].in_len), "pointcache_lzo_buffer");
+
+	data.chunks = chunks;
+	data.mode = mode;
+
+	BLI_task_parallel_range(0, totchunk, &data, ptcache_compress_chunk_task_cb, totchunk > 1);
+
+	for (i = 0; i < totchunk; i++) {
+		ptcache_file_compressed_chunk_write(pf, &chunks[i]);
+		MEM_freeN(chunks[i].out);
+	}
+}
 static int ptcache_file_read(PTCacheFile *pf, void *f, unsigned int tot, unsigned int size)
 {
 	return (fread(f, size, tot, pf->fp) == tot);
@@ -2396,14 +2467,18 @@ static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
 
 	if (!error) {
 		if (pid->cache->compression) {
+			PTCacheCompressedChunk chunks[BPHYS_TOT_DATA];
+			int totchunk = 0;
+
 			for (i=0; i<BPHYS_TOT_DATA; i++) {
 				if (pm->data[i]) {
-					unsigned int in_len = pm->totpoint*ptcache_data_size[i];
-					unsigned char *out = (unsigned char *)MEM_callocN(LZO_OUT_LEN(in_len) * 4, "pointcache_lzo_buffer");
-					ptcache_file_compressed_write(pf, (unsigned char *)(pm->data[i]), in_len, out, pid->cache->compression);
-					MEM_freeN(out);
+					chunks[totchunk].in = (unsigned char *)(pm->data[i]);
+					chunks[totchunk].in_len = pm->totpoint*ptcache_data_size[i];
+					totchunk++;
 				}
 			}
+
+			ptcache_file_compressed_write_chunks(pf, chunks, totchunk, pid->cache->compression);
 		}
 		else {
 			BKE_ptcache_mem_pointers_init(pm);
@@ -2496,10 +2571,106 @@ static int ptcache_read_stream(PTCacheID *pid, int cfra)
 	return error == 0;
 }
 
+#ifdef WITH_OPENVDB
+/* Background prefetch of the next frame's vdb file during cached playback.
+ * Only one frame is warmed at a time; the worker forces the grid trees into
+ * the reader's memory so the main thread read becomes a cache lookup.
+ * Guarded by a mutex, cache reads can come from multiple depsgraph threads. */
+static struct {
+	TaskPool *pool;
+	struct OpenVDBReader *reader;
+	char filename[FILE_MAX * 2];
+} ptcache_vdb_prefetch = {NULL, NULL, {'\0'}};
+
+static ThreadMutex ptcache_vdb_prefetch_mutex = BLI_MUTEX_INITIALIZER;
+
+static void ptcache_vdb_prefetch_task(TaskPool *__restrict UNUSED(pool), void *UNUSED(taskdata), int UNUSED(threadid))
+{
+	OpenVDBReader_open(ptcache_vdb_prefetch.reader, ptcache_vdb_prefetch.filename);
+	OpenVDBReader_prefetch_grids(ptcache_vdb_prefetch.reader);
+}
+
+/* must be called with the prefetch mutex held */
+static void ptcache_vdb_prefetch_wait(void)
+{
+	if (ptcache_vdb_prefetch.pool) {
+		BLI_task_pool_work_and_wait(ptcache_vdb_prefetch.pool);
+		BLI_task_pool_free(ptcache_vdb_prefetch.pool);
+		ptcache_vdb_prefetch.pool = NULL;
+	}
+}
+
+/* hand the prefetched reader over if it matches, the caller owns it then */
+static struct OpenVDBReader *ptcache_vdb_prefetch_acquire(const char *filename)
+{
+	struct OpenVDBReader *reader = NULL;
+
+	BLI_mutex_lock(&ptcache_vdb_prefetch_mutex);
+
+	if (ptcache_vdb_prefetch.reader && STREQ(ptcache_vdb_prefetch.filename, filename)) {
+		ptcache_vdb_prefetch_wait();
+
+		reader = ptcache_vdb_prefetch.reader;
+		ptcache_vdb_prefetch.reader = NULL;
+		ptcache_vdb_prefetch.filename[0] = '\0';
+	}
+
+	BLI_mutex_unlock(&ptcache_vdb_prefetch_mutex);
+
+	return reader;
+}
+
+static void ptcache_vdb_prefetch_start(PTCacheID *pid, int cfra)
+{
+	char filename[FILE_MAX * 2];
+
+	ptcache_filename(pid, filename, cfra, 1, 1);
+
+	if (!BLI_exists(filename)) {
+		return;
+	}
+
+	BLI_mutex_lock(&ptcache_vdb_prefetch_mutex);
+
+	if (!STREQ(ptcache_vdb_prefetch.filename, filename)) {
+		ptcache_vdb_prefetch_wait();
+
+		if (ptcache_vdb_prefetch.reader) {
+			OpenVDBReader_free(ptcache_vdb_prefetch.reader);
+		}
+
+		ptcache_vdb_prefetch.reader = OpenVDBReader_create();
+		BLI_strncpy(ptcache_vdb_prefetch.filename, filename, sizeof(ptcache_vdb_prefetch.filename));
+
+		ptcache_vdb_prefetch.pool = BLI_task_pool_create_background(BLI_task_scheduler_get(), NULL);
+		BLI_task_pool_push(ptcache_vdb_prefetch.pool, ptcache_vdb_prefetch_task, NULL, false, TASK_PRIORITY_LOW);
+	}
+
+	BLI_mutex_unlock(&ptcache_vdb_prefetch_mutex);
+}
+
+static void ptcache_vdb_prefetch_free(void)
+{
+	BLI_mutex_lock(&ptcache_vdb_prefetch_mutex);
+
+	ptcache_vdb_prefetch_wait();
+
+	if (ptcache_vdb_prefetch.reader) {
+		OpenVDBReader_free(ptcache_vdb_prefetch.reader);
+		ptcache_vdb_prefetch.reader = NULL;
+	}
+	ptcache_vdb_prefetch.filename[0] = '\0';
+
+	BLI_mutex_unlock(&ptcache_vdb_prefetch_mutex);
+}
+#endif /* WITH_OPENVDB */
+
 static int ptcache_read_openvdb_stream(PTCacheID *pid, int cfra)
 {
 #ifdef WITH_OPENVDB
+	struct OpenVDBReader *reader;
 	char filename[FILE_MAX * 2];
+	int error;
 
 	 /* save blend file before using disk pointcache */
 	if (!G.relbase_valid && (pid->cache->flag & PTCACHE_EXTERNAL) == 0)
@@ -2511,14 +2682,23 @@ static int ptcache_read_openvdb_stream(PTCacheID *pid, int cfra)
 		return 0;
 	}
 
-	struct OpenVDBReader *reader = OpenVDBReader_create();
-	OpenVDBReader_open(reader, filename);
+	reader = ptcache_vdb_prefetch_acquire(filename);
 
-	if (!pid->read_openvdb_stream(reader, pid->calldata)) {
-		return 0;
+	if (reader == NULL) {
+		reader = OpenVDBReader_create();
+		OpenVDBReader_open(reader, filename);
 	}
 
-	return 1;
+	error = !pid->read_openvdb_stream(reader, pid->calldata);
+
+	OpenVDBReader_free(reader);
+
+	if (!error) {
+		/* warm the next frame while this one is consumed */
+		ptcache_vdb_prefetch_start(pid, cfra + 1);
+	}
+
+	return error == 0;
 #else
 	UNUSED_VARS(pid, cfra);
 	return 0;
@@ -2636,6 +2816,9 @@ static int ptcache_interpolate(PTCacheID *pid, float cfra, int cfra1, int cfra2)
 /* possible to get old or interpolated result */
 int BKE_ptcache_read(PTCacheID *pid, float cfra)
 {
+	/* make sure the background writer isn't still writing the frame we read */
+	ptcache_async_write_flush();
+
 	int cfrai = (int)floor(cfra), cfra1=0, cfra2=0;
 	int ret = 0;
 
@@ -2718,6 +2901,91 @@ int BKE_ptcache_read(PTCacheID *pid, float cfra)
 
 	return ret;
 }
+/* Background frame writer:
+ * While baking, the PTCacheMem snapshot of a disk frame is handed to a
+ * background task instead of being compressed and written on the simulation
+ * thread, so stepping the simulation overlaps the compression and I/O of the
+ * previous frame.  At most one frame is in flight; the writer is flushed
+ * before any cache file is read or the next frame is pushed, which keeps the
+ * on-disk state coherent for everyone going through the public API.
+ *
+ * Note that ptcache_mem_frame_to_disk clears the old frame file itself, so
+ * BKE_ptcache_id_clear must not flush (the worker would wait on its own
+ * task); while baking all clears come from the baking thread's write path,
+ * which has flushed already. */
+typedef struct PTCacheAsyncWrite {
+	PTCacheID pid;	/* by-value copy; points into scene data the bake keeps alive */
+	PTCacheMem *pm;
+	PTCacheMem *pm2;
+} PTCacheAsyncWrite;
+
+static struct {
+	TaskPool *pool;
+	int error;
+} ptcache_async_writer = {NULL, 0};
+
+static void ptcache_async_write_free_frame(PTCacheMem *pm)
+{
+	ptcache_data_free(pm);
+	ptcache_extra_free(pm);
+	MEM_freeN(pm);
+}
+
+static void ptcache_async_write_task(TaskPool *UNUSED(pool), void *taskdata, int UNUSED(threadid))
+{
+	PTCacheAsyncWrite *write = taskdata;
+	int error = 0;
+
+	error += !ptcache_mem_frame_to_disk(&write->pid, write->pm);
+	ptcache_async_write_free_frame(write->pm);
+
+	if (write->pm2) {
+		error += !ptcache_mem_frame_to_disk(&write->pid, write->pm2);
+		ptcache_async_write_free_frame(write->pm2);
+	}
+
+	/* no lock needed, only one task is ever in flight */
+	ptcache_async_writer.error += error;
+}
+
+/* wait for the in-flight frame, returns the errors accumulated since the last flush */
+static int ptcache_async_write_flush(void)
+{
+	int error = 0;
+
+	if (ptcache_async_writer.pool) {
+		BLI_task_pool_work_and_wait(ptcache_async_writer.pool);
+		BLI_task_pool_free(ptcache_async_writer.pool);
+		ptcache_async_writer.pool = NULL;
+
+		error = ptcache_async_writer.error;
+		ptcache_async_writer.error = 0;
+	}
+
+	return error;
+}
+
+static void ptcache_async_write_push(PTCacheID *pid, PTCacheMem *pm, PTCacheMem *pm2)
+{
+	PTCacheAsyncWrite *write = MEM_mallocN(sizeof(PTCacheAsyncWrite), "PTCacheAsyncWrite");
+
+	write->pid = *pid;
+	write->pm = pm;
+	write->pm2 = pm2;
+
+	ptcache_async_writer.pool = BLI_task_pool_create_background(BLI_task_scheduler_get(), NULL);
+	BLI_task_pool_push(ptcache_async_writer.pool, ptcache_async_write_task, write, true, TASK_PRIORITY_LOW);
+}
+
+void BKE_ptcache_async_write_exit(void)
+{
+	ptcache_async_write_flush();
+
+#ifdef WITH_OPENVDB
+	ptcache_vdb_prefetch_free();
+#endif
+}
+
 static int ptcache_write_stream(PTCacheID *pid, int cfra, int totpoint)
 {
 	PTCacheFile *pf = NULL;
@@ -2820,20 +3088,28 @@ static int ptcache_write(PTCacheID *pid, int cfra, int overwrite)
 	pm->frame = cfra;
 
 	if (cache->flag & PTCACHE_DISK_CACHE) {
-		error += !ptcache_mem_frame_to_disk(pid, pm);
-
-		// if (pm) /* pm is always set */
-		{
-			ptcache_data_free(pm);
-			ptcache_extra_free(pm);
-			MEM_freeN(pm);
+		if (cache->flag & PTCACHE_BAKING) {
+			/* pm is a private snapshot already, let the background writer
+			 * compress and write it while the next frame simulates; the
+			 * writer frees the frames and reports errors at the next flush */
+			ptcache_async_write_push(pid, pm, pm2);
 		}
+		else {
+			error += !ptcache_mem_frame_to_disk(pid, pm);
 
-		if (pm2) {
-			error += !ptcache_mem_frame_to_disk(pid, pm2);
-			ptcache_data_free(pm2);
-			ptcache_extra_free(pm2);
-			MEM_freeN(pm2);
+			// if (pm) /* pm is always set */
+			{
+				ptcache_data_free(pm);
+				ptcache_extra_free(pm);
+				MEM_freeN(pm);
+			}
+
+			if (pm2) {
+				error += !ptcache_mem_frame_to_disk(pid, pm2);
+				ptcache_data_free(pm2);
+				ptcache_extra_free(pm2);
+				MEM_freeN(pm2);
+			}
 		}
 	}
 	else {
@@ -2901,6 +3177,10 @@ int BKE_ptcache_write(PTCacheID *pid, unsigned int cfra)
 	if (totpoint == 0 || (cfra ? pid->data_types == 0 : pid->info_types == 0))
 		return 0;
 
+	/* the previous frame has to be on disk before the frame scan below,
+	 * this also surfaces any write error of the in-flight frame */
+	error += ptcache_async_write_flush();
+
 	if (ptcache_write_needed(pid, cfra, &overwrite)==0)
 		return 0;
 
@@ -3692,6 +3972,9 @@ void BKE_ptcache_bake(PTCacheBaker *baker)
 		printf("\nBake %s %s (%i frames simulated).\n", (cancel ? "canceled after" : "finished in"), run, CFRA - startframe);
 	}
 
+	/* the last frame may still be in the background writer */
+	ptcache_async_write_flush();
+
 	/* clear baking flag */
 	if (pid) {
 		cache->flag &= ~(PTCACHE_BAKING|PTCACHE_REDO_NEEDED);
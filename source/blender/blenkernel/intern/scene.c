@@ -1462,9 +1462,20 @@ static void scene_update_object_add_task(void *node, void *user_data);
 
 static void scene_update_all_bases(EvaluationContext *eval_ctx, Scene *scene, Scene *scene_parent)
 {
-	Base *base;
+	/* Walking the base list is a dependent load per object which hurts on
+	 * scenes with many objects, so iterate over a contiguous snapshot instead.
+	 * The view is kept across updates to re-use its array allocation, there's
+	 * no counter tracking base list changes so bump the generation each call
+	 * (scene updates only ever run from the main thread).
+	 */
+	static ListBaseFrozen bases_frozen = BLI_LISTBASE_FROZEN_INIT;
+	static unsigned int bases_generation = 0;
+	unsigned int i;
 
-	for (base = scene->base.first; base; base = base->next) {
+	BLI_listbase_frozen_ensure(&bases_frozen, &scene->base, ++bases_generation);
+
+	for (i = 0; i < bases_frozen.count; i++) {
+		Base *base = (Base *)bases_frozen.array[i];
 		Object *object = base->object;
 
 		BKE_object_handle_update_ex(eval_ctx, scene_parent, object, scene->rigidbody_world, true);
@@ -1900,6 +1911,10 @@ void BKE_scene_update_for_newframe_ex(EvaluationContext *eval_ctx, Main *bmain,
 #ifdef DETAILED_ANALYSIS_OUTPUT
 	double start_time = PIL_check_seconds_timer();
 #endif
+
+	/* duplis can be time dependent (dupliframes, particles, animated groups),
+	 * so cached lists don't survive a frame change */
+	object_dupli_cache_invalidate();
 #ifdef WITH_LEGACY_DEPSGRAPH
 	bool use_new_eval = !DEG_depsgraph_use_legacy();
 #else
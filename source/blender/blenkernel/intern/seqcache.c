@@ -27,6 +27,7 @@
  */
 
 #include <stddef.h>
+#include <stdlib.h>
 
 #include "BLI_sys_types.h"  /* for intptr_t */
 
@@ -51,6 +52,10 @@ typedef struct SeqCacheKey {
 	eSeqStripElemIBuf type;
 } SeqCacheKey;
 
+typedef struct SeqCachePriorityData {
+	int cfra;
+} SeqCachePriorityData;
+
 typedef struct SeqPreprocessCacheElem {
 	struct SeqPreprocessCacheElem *next, *prev;
 
@@ -69,6 +74,11 @@ typedef struct SeqPreprocessCache {
 static struct MovieCache *moviecache = NULL;
 static struct SeqPreprocessCache *preprocess_cache = NULL;
 
+/* most recently displayed timeline frame and scrub direction, used to decide
+ * which cached frames are evicted first when the cache runs out of memory */
+static int playhead_frame = 0;
+static int playhead_direction = 1;
+
 static void preprocessed_cache_destruct(void);
 
 static bool seq_cmp_render_data(const SeqRenderData *a, const SeqRenderData *b)
@@ -121,6 +131,59 @@ static bool seqcache_hashcmp(const void *a_, const void *b_)
 	        seq_cmp_render_data(&a->context, &b->context));
 }
 
+static void *seqcache_getprioritydata(void *key_v)
+{
+	SeqCacheKey *key = (SeqCacheKey *) key_v;
+	SeqCachePriorityData *priority_data;
+
+	priority_data = MEM_callocN(sizeof(*priority_data), "sequencer cache priority data");
+	priority_data->cfra = (int)key->cfra + key->seq->start;
+
+	return priority_data;
+}
+
+static int seqcache_getitempriority(void *UNUSED(last_userkey_v), void *priority_data_v)
+{
+	SeqCachePriorityData *priority_data = (SeqCachePriorityData *) priority_data_v;
+	int distance = priority_data->cfra - playhead_frame;
+
+	/* frames the playhead already passed are less likely to be needed again
+	 * than frames ahead of it, evict those first */
+	if (distance * playhead_direction < 0) {
+		return -2 * abs(distance);
+	}
+
+	return -abs(distance);
+}
+
+static void seqcache_prioritydeleter(void *priority_data_v)
+{
+	SeqCachePriorityData *priority_data = (SeqCachePriorityData *) priority_data_v;
+
+	MEM_freeN(priority_data);
+}
+
+static struct MovieCache *seqcache_moviecache_create(void)
+{
+	struct MovieCache *cache;
+
+	cache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
+
+	IMB_moviecache_set_priority_callback(cache, seqcache_getprioritydata, seqcache_getitempriority,
+	                                     seqcache_prioritydeleter);
+	IMB_moviecache_set_priority_band(cache, MOVIECACHE_BAND_SEQUENCER);
+
+	return cache;
+}
+
+void BKE_sequencer_cache_set_playhead(int cfra)
+{
+	if (cfra != playhead_frame) {
+		playhead_direction = (cfra > playhead_frame) ? 1 : -1;
+		playhead_frame = cfra;
+	}
+}
+
 void BKE_sequencer_cache_destruct(void)
 {
 	if (moviecache)
@@ -133,7 +196,7 @@ void BKE_sequencer_cache_cleanup(void)
 {
 	if (moviecache) {
 		IMB_moviecache_free(moviecache);
-		moviecache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
+		moviecache = seqcache_moviecache_create();
 	}
 
 	BKE_sequencer_preprocessed_cache_cleanup();
@@ -178,7 +241,7 @@ void BKE_sequencer_cache_put(const SeqRenderData *context, Sequence *seq, float
 	}
 
 	if (!moviecache) {
-		moviecache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
+		moviecache = seqcache_moviecache_create();
 	}
 
 	key.seq = seq;
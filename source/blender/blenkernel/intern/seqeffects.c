@@ -34,12 +34,17 @@
 #include <math.h>
 #include <stdlib.h>
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 #include "MEM_guardedalloc.h"
 
 #include "BLI_math.h" /* windows needs for M_PI */
 #include "BLI_utildefines.h"
 #include "BLI_rect.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 
 #include "DNA_scene_types.h"
 #include "DNA_sequence_types.h"
@@ -543,6 +548,39 @@ static void do_cross_effect_float(float facf0, float facf1, int x, int y, float
 	fac4 = facf1;
 	fac3 = 1.0f - fac4;
 
+#ifdef __SSE2__
+	/* blend one pixel per register, unaligned loads since the
+	 * rects are not guaranteed to be 16 byte aligned */
+	{
+		const __m128 fac1_sse = _mm_set1_ps(fac1);
+		const __m128 fac2_sse = _mm_set1_ps(fac2);
+		const __m128 fac3_sse = _mm_set1_ps(fac3);
+		const __m128 fac4_sse = _mm_set1_ps(fac4);
+
+		while (y--) {
+			x = xo;
+			while (x--) {
+				_mm_storeu_ps(rt, _mm_add_ps(_mm_mul_ps(fac1_sse, _mm_loadu_ps(rt1)),
+				                             _mm_mul_ps(fac2_sse, _mm_loadu_ps(rt2))));
+
+				rt1 += 4; rt2 += 4; rt += 4;
+			}
+
+			if (y == 0)
+				break;
+			y--;
+
+			x = xo;
+			while (x--) {
+				_mm_storeu_ps(rt, _mm_add_ps(_mm_mul_ps(fac3_sse, _mm_loadu_ps(rt1)),
+				                             _mm_mul_ps(fac4_sse, _mm_loadu_ps(rt2))));
+
+				rt1 += 4; rt2 += 4; rt += 4;
+			}
+
+		}
+	}
+#else
 	while (y--) {
 		x = xo;
 		while (x--) {
@@ -569,6 +607,7 @@ static void do_cross_effect_float(float facf0, float facf1, int x, int y, float
 		}
 
 	}
+#endif
 }
 
 static void do_cross_effect(const SeqRenderData *context, Sequence *UNUSED(seq), float UNUSED(cfra),
@@ -1561,7 +1600,8 @@ static void copy_wipe_effect(Sequence *dst, Sequence *src)
 	dst->effectdata = MEM_dupallocN(src->effectdata);
 }
 
-static void do_wipe_effect_byte(Sequence *seq, float facf0, float UNUSED(facf1),  int x, int y, unsigned char *rect1,
+static void do_wipe_effect_byte(Sequence *seq, float facf0, float UNUSED(facf1),  int x, int y,
+                                int start_line, int total_lines, unsigned char *rect1,
                                 unsigned char *rect2, unsigned char *out)
 {
 	WipeZone wipezone;
@@ -1569,6 +1609,7 @@ static void do_wipe_effect_byte(Sequence *seq, float facf0, float UNUSED(facf1),
 	int xo, yo;
 	unsigned char *cp1, *cp2, *rt;
 
+	/* the zone is calculated for the full frame, only the lines of this slice are filled */
 	precalc_wipe_zone(&wipezone, wipe, x, y);
 
 	cp1 = rect1;
@@ -1576,8 +1617,8 @@ static void do_wipe_effect_byte(Sequence *seq, float facf0, float UNUSED(facf1),
 	rt = out;
 
 	xo = x;
-	yo = y;
-	for (y = 0; y < yo; y++) {
+	yo = start_line + total_lines;
+	for (y = start_line; y < yo; y++) {
 		for (x = 0; x < xo; x++) {
 			float check = check_zone(&wipezone, x, y, seq, facf0);
 			if (check) {
@@ -1627,7 +1668,8 @@ static void do_wipe_effect_byte(Sequence *seq, float facf0, float UNUSED(facf1),
 	}
 }
 
-static void do_wipe_effect_float(Sequence *seq, float facf0, float UNUSED(facf1), int x, int y, float *rect1,
+static void do_wipe_effect_float(Sequence *seq, float facf0, float UNUSED(facf1), int x, int y,
+                                 int start_line, int total_lines, float *rect1,
                                  float *rect2, float *out)
 {
 	WipeZone wipezone;
@@ -1635,6 +1677,7 @@ static void do_wipe_effect_float(Sequence *seq, float facf0, float UNUSED(facf1)
 	int xo, yo;
 	float *rt1, *rt2, *rt;
 
+	/* the zone is calculated for the full frame, only the lines of this slice are filled */
 	precalc_wipe_zone(&wipezone, wipe, x, y);
 
 	rt1 = rect1;
@@ -1642,8 +1685,8 @@ static void do_wipe_effect_float(Sequence *seq, float facf0, float UNUSED(facf1)
 	rt = out;
 
 	xo = x;
-	yo = y;
-	for (y = 0; y < yo; y++) {
+	yo = start_line + total_lines;
+	for (y = start_line; y < yo; y++) {
 		for (x = 0; x < xo; x++) {
 			float check = check_zone(&wipezone, x, y, seq, facf0);
 			if (check) {
@@ -1686,21 +1729,26 @@ static void do_wipe_effect_float(Sequence *seq, float facf0, float UNUSED(facf1)
 	}
 }
 
-static ImBuf *do_wipe_effect(const SeqRenderData *context, Sequence *seq, float UNUSED(cfra), float facf0, float facf1,
-                             ImBuf *ibuf1, ImBuf *ibuf2, ImBuf *ibuf3)
+static void do_wipe_effect(const SeqRenderData *context, Sequence *seq, float UNUSED(cfra),
+                           float facf0, float facf1, ImBuf *ibuf1, ImBuf *ibuf2, ImBuf *UNUSED(ibuf3),
+                           int start_line, int total_lines, ImBuf *out)
 {
-	ImBuf *out = prepare_effect_imbufs(context, ibuf1, ibuf2, ibuf3);
-
 	if (out->rect_float) {
-		do_wipe_effect_float(seq, facf0, facf1, context->rectx, context->recty, ibuf1->rect_float,
-		                     ibuf2->rect_float, out->rect_float);
+		float *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
+
+		slice_get_float_buffers(context, ibuf1, ibuf2, NULL, out, start_line, &rect1, &rect2, NULL, &rect_out);
+
+		do_wipe_effect_float(seq, facf0, facf1, context->rectx, context->recty, start_line, total_lines,
+		                     rect1, rect2, rect_out);
 	}
 	else {
-		do_wipe_effect_byte(seq, facf0, facf1, context->rectx, context->recty, (unsigned char *) ibuf1->rect,
-		                    (unsigned char *) ibuf2->rect, (unsigned char *) out->rect);
-	}
+		unsigned char *rect1 = NULL, *rect2 = NULL, *rect_out = NULL;
 
-	return out;
+		slice_get_byte_buffers(context, ibuf1, ibuf2, NULL, out, start_line, &rect1, &rect2, NULL, &rect_out);
+
+		do_wipe_effect_byte(seq, facf0, facf1, context->rectx, context->recty, start_line, total_lines,
+		                    rect1, rect2, rect_out);
+	}
 }
 
 /*********************** Transform *************************/
@@ -1838,6 +1886,126 @@ static ImBuf *do_transform_effect(const SeqRenderData *context, Sequence *seq, f
 
 /*********************** Glow *************************/
 
+typedef struct BlurBitmapState {
+	float *src, *dst;
+	float *filter;
+	int width, height, halfWidth;
+} BlurBitmapState;
+
+static void blur_bitmap_rows_cb(void *userdata, const int y)
+{
+	BlurBitmapState *state = (BlurBitmapState *)userdata;
+	float *map = state->src;
+	float *temp = state->dst;
+	float *filter = state->filter;
+	int width = state->width;
+	int halfWidth = state->halfWidth;
+	int x, i, fx, index;
+	float curColor[3], curColor2[3];
+
+	/* Do the left & right strips */
+	for (x = 0; x < halfWidth; x++) {
+		index = (x + y * width) * 4;
+		fx = 0;
+		curColor[0] = curColor[1] = curColor[2] = 0.0f;
+		curColor2[0] = curColor2[1] = curColor2[2] = 0.0f;
+
+		for (i = x - halfWidth; i < x + halfWidth; i++) {
+			if ((i >= 0) && (i < width)) {
+				curColor[0] += map[(i + y * width) * 4 + GlowR] * filter[fx];
+				curColor[1] += map[(i + y * width) * 4 + GlowG] * filter[fx];
+				curColor[2] += map[(i + y * width) * 4 + GlowB] * filter[fx];
+
+				curColor2[0] += map[(width - 1 - i + y * width) * 4 + GlowR] * filter[fx];
+				curColor2[1] += map[(width - 1 - i + y * width) * 4 + GlowG] * filter[fx];
+				curColor2[2] += map[(width - 1 - i + y * width) * 4 + GlowB] * filter[fx];
+			}
+			fx++;
+		}
+		temp[index + GlowR] = curColor[0];
+		temp[index + GlowG] = curColor[1];
+		temp[index + GlowB] = curColor[2];
+
+		temp[((width - 1 - x + y * width) * 4) + GlowR] = curColor2[0];
+		temp[((width - 1 - x + y * width) * 4) + GlowG] = curColor2[1];
+		temp[((width - 1 - x + y * width) * 4) + GlowB] = curColor2[2];
+
+	}
+
+	/* Do the main body */
+	for (x = halfWidth; x < width - halfWidth; x++) {
+		index = (x + y * width) * 4;
+		fx = 0;
+		zero_v3(curColor);
+		for (i = x - halfWidth; i < x + halfWidth; i++) {
+			curColor[0] += map[(i + y * width) * 4 + GlowR] * filter[fx];
+			curColor[1] += map[(i + y * width) * 4 + GlowG] * filter[fx];
+			curColor[2] += map[(i + y * width) * 4 + GlowB] * filter[fx];
+			fx++;
+		}
+		temp[index + GlowR] = curColor[0];
+		temp[index + GlowG] = curColor[1];
+		temp[index + GlowB] = curColor[2];
+	}
+}
+
+static void blur_bitmap_cols_cb(void *userdata, const int x)
+{
+	BlurBitmapState *state = (BlurBitmapState *)userdata;
+	float *map = state->src;
+	float *temp = state->dst;
+	float *filter = state->filter;
+	int width = state->width;
+	int height = state->height;
+	int halfWidth = state->halfWidth;
+	int y, i, fy, index;
+	float curColor[3], curColor2[3];
+
+	/* Do the top & bottom strips */
+	for (y = 0; y < halfWidth; y++) {
+		index = (x + y * width) * 4;
+		fy = 0;
+		zero_v3(curColor);
+		zero_v3(curColor2);
+		for (i = y - halfWidth; i < y + halfWidth; i++) {
+			if ((i >= 0) && (i < height)) {
+				/* Bottom */
+				curColor[0] += map[(x + i * width) * 4 + GlowR] * filter[fy];
+				curColor[1] += map[(x + i * width) * 4 + GlowG] * filter[fy];
+				curColor[2] += map[(x + i * width) * 4 + GlowB] * filter[fy];
+
+				/* Top */
+				curColor2[0] += map[(x + (height - 1 - i) * width) * 4 + GlowR] * filter[fy];
+				curColor2[1] += map[(x + (height - 1 - i) * width) * 4 + GlowG] * filter[fy];
+				curColor2[2] += map[(x + (height - 1 - i) * width) * 4 + GlowB] * filter[fy];
+			}
+			fy++;
+		}
+		temp[index + GlowR] = curColor[0];
+		temp[index + GlowG] = curColor[1];
+		temp[index + GlowB] = curColor[2];
+		temp[((x + (height - 1 - y) * width) * 4) + GlowR] = curColor2[0];
+		temp[((x + (height - 1 - y) * width) * 4) + GlowG] = curColor2[1];
+		temp[((x + (height - 1 - y) * width) * 4) + GlowB] = curColor2[2];
+	}
+
+	/* Do the main body */
+	for (y = halfWidth; y < height - halfWidth; y++) {
+		index = (x + y * width) * 4;
+		fy = 0;
+		zero_v3(curColor);
+		for (i = y - halfWidth; i < y + halfWidth; i++) {
+			curColor[0] += map[(x + i * width) * 4 + GlowR] * filter[fy];
+			curColor[1] += map[(x + i * width) * 4 + GlowG] * filter[fy];
+			curColor[2] += map[(x + i * width) * 4 + GlowB] * filter[fy];
+			fy++;
+		}
+		temp[index + GlowR] = curColor[0];
+		temp[index + GlowG] = curColor[1];
+		temp[index + GlowB] = curColor[2];
+	}
+}
+
 static void RVBlurBitmap2_float(float *map, int width, int height, float blur, int quality)
 /*	MUUUCCH better than the previous blur. */
 /*	We do the blurring in two passes which is a whole lot faster. */
@@ -1848,11 +2016,12 @@ static void RVBlurBitmap2_float(float *map, int width, int height, float blur, i
 /*	a small bitmap.  Avoid avoid avoid. */
 /*=============================== */
 {
+	BlurBitmapState state;
 	float *temp = NULL, *swap;
 	float *filter = NULL;
-	int x, y, i, fx, fy;
-	int index, ix, halfWidth;
-	float fval, k, curColor[3], curColor2[3], weight = 0;
+	int ix, halfWidth;
+	float fval, k, weight = 0;
+	bool do_threads;
 
 	/* If we're not really blurring, bail out */
 	if (blur <= 0)
@@ -1893,103 +2062,27 @@ static void RVBlurBitmap2_float(float *map, int width, int height, float blur, i
 	for (ix = 0; ix < halfWidth * 2; ix++)
 		filter[ix] /= fval;
 
-	/* Blur the rows */
-	for (y = 0; y < height; y++) {
-		/* Do the left & right strips */
-		for (x = 0; x < halfWidth; x++) {
-			index = (x + y * width) * 4;
-			fx = 0;
-			curColor[0] = curColor[1] = curColor[2] = 0.0f;
-			curColor2[0] = curColor2[1] = curColor2[2] = 0.0f;
-
-			for (i = x - halfWidth; i < x + halfWidth; i++) {
-				if ((i >= 0) && (i < width)) {
-					curColor[0] += map[(i + y * width) * 4 + GlowR] * filter[fx];
-					curColor[1] += map[(i + y * width) * 4 + GlowG] * filter[fx];
-					curColor[2] += map[(i + y * width) * 4 + GlowB] * filter[fx];
-
-					curColor2[0] += map[(width - 1 - i + y * width) * 4 + GlowR] * filter[fx];
-					curColor2[1] += map[(width - 1 - i + y * width) * 4 + GlowG] * filter[fx];
-					curColor2[2] += map[(width - 1 - i + y * width) * 4 + GlowB] * filter[fx];
-				}
-				fx++;
-			}
-			temp[index + GlowR] = curColor[0];
-			temp[index + GlowG] = curColor[1];
-			temp[index + GlowB] = curColor[2];
-
-			temp[((width - 1 - x + y * width) * 4) + GlowR] = curColor2[0];
-			temp[((width - 1 - x + y * width) * 4) + GlowG] = curColor2[1];
-			temp[((width - 1 - x + y * width) * 4) + GlowB] = curColor2[2];
-
-		}
+	/* Rows and columns are independent, so both passes are spread over the
+	 * task scheduler, one row/column per task.
+	 */
+	state.filter = filter;
+	state.width = width;
+	state.height = height;
+	state.halfWidth = halfWidth;
+	do_threads = (((size_t)width * height) >= 64 * 64);
 
-		/* Do the main body */
-		for (x = halfWidth; x < width - halfWidth; x++) {
-			index = (x + y * width) * 4;
-			fx = 0;
-			zero_v3(curColor);
-			for (i = x - halfWidth; i < x + halfWidth; i++) {
-				curColor[0] += map[(i + y * width) * 4 + GlowR] * filter[fx];
-				curColor[1] += map[(i + y * width) * 4 + GlowG] * filter[fx];
-				curColor[2] += map[(i + y * width) * 4 + GlowB] * filter[fx];
-				fx++;
-			}
-			temp[index + GlowR] = curColor[0];
-			temp[index + GlowG] = curColor[1];
-			temp[index + GlowB] = curColor[2];
-		}
-	}
+	/* Blur the rows */
+	state.src = map;
+	state.dst = temp;
+	BLI_task_parallel_range(0, height, &state, blur_bitmap_rows_cb, do_threads);
 
 	/* Swap buffers */
 	swap = temp; temp = map; map = swap;
 
 	/* Blur the columns */
-	for (x = 0; x < width; x++) {
-		/* Do the top & bottom strips */
-		for (y = 0; y < halfWidth; y++) {
-			index = (x + y * width) * 4;
-			fy = 0;
-			zero_v3(curColor);
-			zero_v3(curColor2);
-			for (i = y - halfWidth; i < y + halfWidth; i++) {
-				if ((i >= 0) && (i < height)) {
-					/* Bottom */
-					curColor[0] += map[(x + i * width) * 4 + GlowR] * filter[fy];
-					curColor[1] += map[(x + i * width) * 4 + GlowG] * filter[fy];
-					curColor[2] += map[(x + i * width) * 4 + GlowB] * filter[fy];
-
-					/* Top */
-					curColor2[0] += map[(x + (height - 1 - i) * width) * 4 + GlowR] * filter[fy];
-					curColor2[1] += map[(x + (height - 1 - i) * width) * 4 + GlowG] * filter[fy];
-					curColor2[2] += map[(x + (height - 1 - i) * width) * 4 + GlowB] * filter[fy];
-				}
-				fy++;
-			}
-			temp[index + GlowR] = curColor[0];
-			temp[index + GlowG] = curColor[1];
-			temp[index + GlowB] = curColor[2];
-			temp[((x + (height - 1 - y) * width) * 4) + GlowR] = curColor2[0];
-			temp[((x + (height - 1 - y) * width) * 4) + GlowG] = curColor2[1];
-			temp[((x + (height - 1 - y) * width) * 4) + GlowB] = curColor2[2];
-		}
-	
-		/* Do the main body */
-		for (y = halfWidth; y < height - halfWidth; y++) {
-			index = (x + y * width) * 4;
-			fy = 0;
-			zero_v3(curColor);
-			for (i = y - halfWidth; i < y + halfWidth; i++) {
-				curColor[0] += map[(x + i * width) * 4 + GlowR] * filter[fy];
-				curColor[1] += map[(x + i * width) * 4 + GlowG] * filter[fy];
-				curColor[2] += map[(x + i * width) * 4 + GlowB] * filter[fy];
-				fy++;
-			}
-			temp[index + GlowR] = curColor[0];
-			temp[index + GlowG] = curColor[1];
-			temp[index + GlowB] = curColor[2];
-		}
-	}
+	state.src = map;
+	state.dst = temp;
+	BLI_task_parallel_range(0, width, &state, blur_bitmap_cols_cb, do_threads);
 
 	/* Swap buffers */
 	swap = temp; temp = map; /* map = swap; */ /* UNUSED */
@@ -3358,13 +3451,14 @@ static struct SeqEffectHandle get_sequence_effect_impl(int seq_type)
 			rval.execute_slice = do_alphaunder_effect;
 			break;
 		case SEQ_TYPE_WIPE:
+			rval.multithreaded = true;
 			rval.init = init_wipe_effect;
 			rval.num_inputs = num_inputs_wipe;
 			rval.free = free_wipe_effect;
 			rval.copy = copy_wipe_effect;
 			rval.early_out = early_out_fade;
 			rval.get_default_fac = get_default_fac_fade;
-			rval.execute = do_wipe_effect;
+			rval.execute_slice = do_wipe_effect;
 			break;
 		case SEQ_TYPE_GLOW:
 			rval.init = init_glow_effect;
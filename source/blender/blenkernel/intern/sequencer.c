@@ -3828,6 +3828,10 @@ ImBuf *BKE_sequencer_give_ibuf(const SeqRenderData *context, float cfra, int cha
 		seqbasep = ed->seqbasep;
 	}
 
+	/* prefetch renders go through seq_render_strip_stack directly,
+	 * so cache eviction follows the frame the interface asks for */
+	BKE_sequencer_cache_set_playhead(cfra);
+
 	SeqRenderState state;
 	sequencer_state_init(&state);
 
@@ -3851,6 +3855,116 @@ ImBuf *BKE_sequencer_give_ibuf_direct(const SeqRenderData *context, float cfra,
 	return seq_render_strip(context, &state, seq, cfra);
 }
 
+/* *********************** prefetch api ******************* */
+
+typedef struct SeqPrefetchContext {
+	Scene *scene;
+
+	/* private copies of the scene strips, so decoding for look-ahead frames
+	 * can run concurrently with the strips shown in the interface */
+	ListBase seqbase;
+} SeqPrefetchContext;
+
+static void seq_prefetch_remove_sounds(Scene *scene, ListBase *seqbase)
+{
+	Sequence *seq;
+
+	for (seq = seqbase->first; seq; seq = seq->next) {
+		if (seq->scene_sound) {
+			BKE_sound_remove_scene_sound(scene, seq->scene_sound);
+			seq->scene_sound = NULL;
+		}
+
+		if (seq->type == SEQ_TYPE_META) {
+			seq_prefetch_remove_sounds(scene, &seq->seqbase);
+		}
+	}
+}
+
+SeqPrefetchContext *BKE_sequencer_prefetch_context_create(Scene *scene)
+{
+	Editing *ed = BKE_sequencer_editing_get(scene, false);
+	SeqPrefetchContext *pctx;
+
+	if (ed == NULL) {
+		return NULL;
+	}
+
+	pctx = MEM_callocN(sizeof(SeqPrefetchContext), "seq prefetch context");
+	pctx->scene = scene;
+
+	/* movie strip copies get their own anim handles, the same mechanism the
+	 * proxy builder relies on for threaded decoding */
+	BKE_sequence_base_dupli_recursive(scene, scene, &pctx->seqbase, ed->seqbasep, SEQ_DUPE_ALL);
+
+	/* the copies are render-only, unregister the sounds seq_dupli added */
+	seq_prefetch_remove_sounds(scene, &pctx->seqbase);
+
+	return pctx;
+}
+
+bool BKE_sequencer_prefetch_frame(SeqPrefetchContext *pctx, const SeqRenderData *context, float cfra, int chanshown)
+{
+	Sequence *seq_arr[MAXSEQ + 1];
+	SeqRenderData render_context;
+	ImBuf *out;
+	int count, i;
+	Editing *ed = BKE_sequencer_editing_get(pctx->scene, false);
+
+	if (ed == NULL) {
+		return false;
+	}
+
+	/* lookup the strips the interface would show on this frame, cache entries
+	 * are keyed by these originals so the interface gets the hits */
+	count = get_shown_sequences(ed->seqbasep, cfra, chanshown, (Sequence **)&seq_arr);
+
+	if (count == 0) {
+		return true;
+	}
+
+	/* scene strips would evaluate the scene from the job thread, skip those frames */
+	for (i = 0; i < count; i++) {
+		if (seq_arr[i]->type == SEQ_TYPE_SCENE) {
+			return true;
+		}
+	}
+
+	out = BKE_sequencer_cache_get(context, seq_arr[count - 1], cfra, SEQ_STRIPELEM_IBUF_COMP);
+	if (out) {
+		IMB_freeImBuf(out);
+		return true;
+	}
+
+	/* render on the private copies, entries keyed by them would never be
+	 * looked up again so don't let the render put them in the cache */
+	render_context = *context;
+	render_context.skip_cache = true;
+
+	SeqRenderState state;
+	sequencer_state_init(&state);
+
+	out = seq_render_strip_stack(&render_context, &state, &pctx->seqbase, cfra, chanshown);
+
+	if (out) {
+		BKE_sequencer_cache_put(context, seq_arr[count - 1], cfra, SEQ_STRIPELEM_IBUF_COMP, out);
+		IMB_freeImBuf(out);
+	}
+
+	return true;
+}
+
+void BKE_sequencer_prefetch_context_free(SeqPrefetchContext *pctx)
+{
+	Sequence *seq;
+
+	while ((seq = BLI_pophead(&pctx->seqbase))) {
+		seq_free_sequence_recurse(NULL, seq);
+	}
+
+	MEM_freeN(pctx);
+}
+
 /* *********************** threading api ******************* */
 
 static ListBase running_threads;
@@ -37,6 +37,8 @@
 #include <time.h>
 #include <assert.h>
 
+#include "MEM_guardedalloc.h"
+
 #include "DNA_object_types.h"
 #include "DNA_modifier_types.h"
 #include "DNA_meshdata_types.h"
@@ -231,6 +233,158 @@ bool BKE_shrinkwrap_project_normal(
 }
 
 
+/**
+ * Checks one batched-raycast hit the way #BKE_shrinkwrap_project_normal does:
+ * converts it back to mesh space and applies front/backface culling.
+ * \a dir is the (mesh space) direction the ray was cast in.
+ */
+static bool shrinkwrap_project_batch_hit_accept(
+        char options, const SpaceTransform *transf, const float dir[3], BVHTreeRayHit *hit)
+{
+	if (hit->index == -1) {
+		return false;
+	}
+
+	/* invert the normal first so face culling works on rotated objects */
+	BLI_space_transform_invert_normal(transf, hit->no);
+
+	if (options & (MOD_SHRINKWRAP_CULL_TARGET_FRONTFACE | MOD_SHRINKWRAP_CULL_TARGET_BACKFACE)) {
+		/* apply backface */
+		const float dot = dot_v3v3(dir, hit->no);
+		if (((options & MOD_SHRINKWRAP_CULL_TARGET_FRONTFACE) && dot <= 0.0f) ||
+		    ((options & MOD_SHRINKWRAP_CULL_TARGET_BACKFACE)  && dot >= 0.0f))
+		{
+			return false;  /* Ignore hit */
+		}
+	}
+
+	BLI_space_transform_invert(transf, hit->co);
+	return true;
+}
+
+/**
+ * Batched projection: collects the rays of all vertices in target space first, so
+ * #BLI_bvhtree_ray_cast_batch can group them by direction octant and keep the bvh
+ * traversal coherent. Gives the same hits as the per-vertex path, only used when
+ * there is no auxiliary target (merging hits of two trees needs the serial path).
+ */
+static void shrinkwrap_calc_normal_projection_batch(
+        ShrinkwrapCalcData *calc,
+        BVHTree *targ_tree, BVHTree_RayCastCallback targ_callback, void *treeData,
+        const float proj_axis[3], const float proj_limit_squared)
+{
+	const char shrink_opts = calc->smd->shrinkOpts;
+	const bool use_pos = (shrink_opts & MOD_SHRINKWRAP_PROJECT_ALLOW_POS_DIR) != 0;
+	const bool use_neg = (shrink_opts & MOD_SHRINKWRAP_PROJECT_ALLOW_NEG_DIR) != 0;
+
+	float (*ray_start)[3] = MEM_mallocN(sizeof(*ray_start) * (size_t)calc->numVerts, __func__);
+	float (*ray_dir)[3] = MEM_mallocN(sizeof(*ray_dir) * (size_t)calc->numVerts, __func__);
+	float (*ray_no_local)[3] = MEM_mallocN(sizeof(*ray_no_local) * (size_t)calc->numVerts, __func__);
+	float *ray_weight = MEM_mallocN(sizeof(*ray_weight) * (size_t)calc->numVerts, __func__);
+	int *ray_vert_index = MEM_mallocN(sizeof(*ray_vert_index) * (size_t)calc->numVerts, __func__);
+	BVHTreeRayHit *hits_pos = NULL, *hits_neg = NULL;
+	int ray_tot = 0;
+	int i;
+
+	/* Collect rays of all vertices which are going to be projected. */
+	for (i = 0; i < calc->numVerts; i++) {
+		float *co = calc->vertexCos[i];
+		float weight = defvert_array_find_weight_safe(calc->dvert, i, calc->vgroup);
+
+		if (calc->invert_vgroup) {
+			weight = 1.0f - weight;
+		}
+
+		if (weight == 0.0f) {
+			continue;
+		}
+
+		if (calc->vert && calc->smd->projAxis == MOD_SHRINKWRAP_PROJECT_OVER_NORMAL) {
+			copy_v3_v3(ray_start[ray_tot], calc->vert[i].co);
+			normal_short_to_float_v3(ray_no_local[ray_tot], calc->vert[i].no);
+		}
+		else {
+			copy_v3_v3(ray_start[ray_tot], co);
+			copy_v3_v3(ray_no_local[ray_tot], proj_axis);
+		}
+
+		copy_v3_v3(ray_dir[ray_tot], ray_no_local[ray_tot]);
+		BLI_space_transform_apply(&calc->local2target, ray_start[ray_tot]);
+		BLI_space_transform_apply_normal(&calc->local2target, ray_dir[ray_tot]);
+
+		ray_weight[ray_tot] = weight;
+		ray_vert_index[ray_tot] = i;
+		ray_tot++;
+	}
+
+	if (use_pos) {
+		hits_pos = MEM_mallocN(sizeof(*hits_pos) * (size_t)ray_tot, __func__);
+		for (i = 0; i < ray_tot; i++) {
+			hits_pos[i].index = -1;
+			hits_pos[i].dist = BVH_RAYCAST_DIST_MAX;
+		}
+		BLI_bvhtree_ray_cast_batch(
+		        targ_tree, (const float (*)[3])ray_start, (const float (*)[3])ray_dir, ray_tot,
+		        0.0f, hits_pos, targ_callback, treeData);
+	}
+	if (use_neg) {
+		for (i = 0; i < ray_tot; i++) {
+			negate_v3(ray_dir[i]);
+		}
+		hits_neg = MEM_mallocN(sizeof(*hits_neg) * (size_t)ray_tot, __func__);
+		for (i = 0; i < ray_tot; i++) {
+			hits_neg[i].index = -1;
+			hits_neg[i].dist = BVH_RAYCAST_DIST_MAX;
+		}
+		BLI_bvhtree_ray_cast_batch(
+		        targ_tree, (const float (*)[3])ray_start, (const float (*)[3])ray_dir, ray_tot,
+		        0.0f, hits_neg, targ_callback, treeData);
+	}
+
+	/* Merge both directions and apply, like the per-vertex path does.
+	 * Note 'dist' values are compared in target space, as in #BKE_shrinkwrap_project_normal. */
+	for (i = 0; i < ray_tot; i++) {
+		float *co = calc->vertexCos[ray_vert_index[i]];
+		BVHTreeRayHit *hit = NULL;
+
+		if (use_pos &&
+		    shrinkwrap_project_batch_hit_accept(shrink_opts, &calc->local2target, ray_no_local[i], &hits_pos[i]))
+		{
+			hit = &hits_pos[i];
+		}
+		if (use_neg) {
+			float inv_no[3];
+			negate_v3_v3(inv_no, ray_no_local[i]);
+			if (shrinkwrap_project_batch_hit_accept(shrink_opts, &calc->local2target, inv_no, &hits_neg[i]) &&
+			    (hit == NULL || hits_neg[i].dist < hit->dist))
+			{
+				hit = &hits_neg[i];
+			}
+		}
+
+		if (hit == NULL) {
+			continue;
+		}
+
+		if (proj_limit_squared != 0.0f) {
+			if (len_squared_v3v3(hit->co, co) > proj_limit_squared) {
+				continue;
+			}
+		}
+
+		madd_v3_v3v3fl(hit->co, hit->co, ray_no_local[i], calc->keepDist);
+		interp_v3_v3v3(co, co, hit->co, ray_weight[i]);
+	}
+
+	if (hits_pos) MEM_freeN(hits_pos);
+	if (hits_neg) MEM_freeN(hits_neg);
+	MEM_freeN(ray_start);
+	MEM_freeN(ray_dir);
+	MEM_freeN(ray_no_local);
+	MEM_freeN(ray_weight);
+	MEM_freeN(ray_vert_index);
+}
+
 static void shrinkwrap_calc_normal_projection(ShrinkwrapCalcData *calc, bool for_render)
 {
 	int i;
@@ -323,90 +477,96 @@ static void shrinkwrap_calc_normal_projection(ShrinkwrapCalcData *calc, bool for
 			}
 		}
 		/* After sucessufuly build the trees, start projection vertexs */
-
+		if (aux_tree == NULL) {
+			/* No auxiliary target: all rays can be cast in coherent batches. */
+			shrinkwrap_calc_normal_projection_batch(
+			        calc, targ_tree, targ_callback, treeData, proj_axis, proj_limit_squared);
+		}
+		else {
 #ifndef __APPLE__
 #pragma omp parallel for private(i, hit) schedule(static) if (calc->numVerts > BKE_MESH_OMP_LIMIT)
 #endif
-		for (i = 0; i < calc->numVerts; ++i) {
-			float *co = calc->vertexCos[i];
-			float tmp_co[3], tmp_no[3];
-			float weight = defvert_array_find_weight_safe(calc->dvert, i, calc->vgroup);
+			for (i = 0; i < calc->numVerts; ++i) {
+				float *co = calc->vertexCos[i];
+				float tmp_co[3], tmp_no[3];
+				float weight = defvert_array_find_weight_safe(calc->dvert, i, calc->vgroup);
 
-			if (calc->invert_vgroup) {
-				weight = 1.0f - weight;
-			}
+				if (calc->invert_vgroup) {
+					weight = 1.0f - weight;
+				}
 
-			if (weight == 0.0f) {
-				continue;
-			}
+				if (weight == 0.0f) {
+					continue;
+				}
 
-			if (calc->vert) {
-				/* calc->vert contains verts from derivedMesh  */
-				/* this coordinated are deformed by vertexCos only for normal projection (to get correct normals) */
-				/* for other cases calc->varts contains undeformed coordinates and vertexCos should be used */
-				if (calc->smd->projAxis == MOD_SHRINKWRAP_PROJECT_OVER_NORMAL) {
-					copy_v3_v3(tmp_co, calc->vert[i].co);
-					normal_short_to_float_v3(tmp_no, calc->vert[i].no);
+				if (calc->vert) {
+					/* calc->vert contains verts from derivedMesh  */
+					/* this coordinated are deformed by vertexCos only for normal projection (to get correct normals) */
+					/* for other cases calc->varts contains undeformed coordinates and vertexCos should be used */
+					if (calc->smd->projAxis == MOD_SHRINKWRAP_PROJECT_OVER_NORMAL) {
+						copy_v3_v3(tmp_co, calc->vert[i].co);
+						normal_short_to_float_v3(tmp_no, calc->vert[i].no);
+					}
+					else {
+						copy_v3_v3(tmp_co, co);
+						copy_v3_v3(tmp_no, proj_axis);
+					}
 				}
 				else {
 					copy_v3_v3(tmp_co, co);
 					copy_v3_v3(tmp_no, proj_axis);
 				}
-			}
-			else {
-				copy_v3_v3(tmp_co, co);
-				copy_v3_v3(tmp_no, proj_axis);
-			}
 
 
-			hit.index = -1;
-			hit.dist = BVH_RAYCAST_DIST_MAX; /* TODO: we should use FLT_MAX here, but sweepsphere code isn't prepared for that */
+				hit.index = -1;
+				hit.dist = BVH_RAYCAST_DIST_MAX; /* TODO: we should use FLT_MAX here, but sweepsphere code isn't prepared for that */
 
-			/* Project over positive direction of axis */
-			if (calc->smd->shrinkOpts & MOD_SHRINKWRAP_PROJECT_ALLOW_POS_DIR) {
+				/* Project over positive direction of axis */
+				if (calc->smd->shrinkOpts & MOD_SHRINKWRAP_PROJECT_ALLOW_POS_DIR) {
+
+					if (aux_tree) {
+						BKE_shrinkwrap_project_normal(
+						        0, tmp_co, tmp_no,
+						        &local2aux, aux_tree, &hit,
+						        aux_callback, auxData);
+					}
 
-				if (aux_tree) {
 					BKE_shrinkwrap_project_normal(
-					        0, tmp_co, tmp_no,
-					        &local2aux, aux_tree, &hit,
-					        aux_callback, auxData);
+					        calc->smd->shrinkOpts, tmp_co, tmp_no,
+					        &calc->local2target, targ_tree, &hit,
+					        targ_callback, treeData);
 				}
 
-				BKE_shrinkwrap_project_normal(
-				        calc->smd->shrinkOpts, tmp_co, tmp_no,
-				        &calc->local2target, targ_tree, &hit,
-				        targ_callback, treeData);
-			}
+				/* Project over negative direction of axis */
+				if (calc->smd->shrinkOpts & MOD_SHRINKWRAP_PROJECT_ALLOW_NEG_DIR) {
+					float inv_no[3];
+					negate_v3_v3(inv_no, tmp_no);
 
-			/* Project over negative direction of axis */
-			if (calc->smd->shrinkOpts & MOD_SHRINKWRAP_PROJECT_ALLOW_NEG_DIR) {
-				float inv_no[3];
-				negate_v3_v3(inv_no, tmp_no);
+					if (aux_tree) {
+						BKE_shrinkwrap_project_normal(
+						        0, tmp_co, inv_no,
+						        &local2aux, aux_tree, &hit,
+						        aux_callback, auxData);
+					}
 
-				if (aux_tree) {
 					BKE_shrinkwrap_project_normal(
-					        0, tmp_co, inv_no,
-					        &local2aux, aux_tree, &hit,
-					        aux_callback, auxData);
+					        calc->smd->shrinkOpts, tmp_co, inv_no,
+					        &calc->local2target, targ_tree, &hit,
+					        targ_callback, treeData);
 				}
 
-				BKE_shrinkwrap_project_normal(
-				        calc->smd->shrinkOpts, tmp_co, inv_no,
-				        &calc->local2target, targ_tree, &hit,
-				        targ_callback, treeData);
-			}
-
-			/* don't set the initial dist (which is more efficient),
-			 * because its calculated in the targets space, we want the dist in our own space */
-			if (proj_limit_squared != 0.0f) {
-				if (len_squared_v3v3(hit.co, co) > proj_limit_squared) {
-					hit.index = -1;
+				/* don't set the initial dist (which is more efficient),
+				 * because its calculated in the targets space, we want the dist in our own space */
+				if (proj_limit_squared != 0.0f) {
+					if (len_squared_v3v3(hit.co, co) > proj_limit_squared) {
+						hit.index = -1;
+					}
 				}
-			}
 
-			if (hit.index != -1) {
-				madd_v3_v3v3fl(hit.co, hit.co, tmp_no, calc->keepDist);
-				interp_v3_v3v3(co, co, hit.co, weight);
+				if (hit.index != -1) {
+					madd_v3_v3v3fl(hit.co, hit.co, tmp_no, calc->keepDist);
+					interp_v3_v3v3(co, co, hit.co, weight);
+				}
 			}
 		}
 	}
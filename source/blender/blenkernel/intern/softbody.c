@@ -139,6 +139,12 @@ typedef struct  SB_thread_context {
 		float windfactor;
 		int nr;
 		int tot;
+		/* softbody_apply_forces() per thread data, reduced after the join */
+		int mode;
+		int mid_flags;
+		float maxerrpos, maxerrvel;
+		float aabbmin[3], aabbmax[3];
+		int fuzzy;
 } SB_thread_context;
 
 #define MID_PRESERVE 1
@@ -2476,20 +2482,20 @@ static void softbody_calc_forces(Scene *scene, Object *ob, float forcetime, floa
 	}
 }
 
-static void softbody_apply_forces(Object *ob, float forcetime, int mode, float *err, int mid_flags)
+static void _softbody_apply_forces_slice_in_a_thread(Object *ob, float forcetime, int mode, int mid_flags, int ifirst, int ilast,
+                                                     float *r_maxerrpos, float *r_maxerrvel, float aabbmin[3], float aabbmax[3], int *r_fuzzy)
 {
 	/* time evolution */
 	/* actually does an explicit euler step mode == 0 */
 	/* or heun ~ 2nd order runge-kutta steps, mode 1, 2 */
+	/* forcetime is expected to be scaled by sb_time_scale() already */
 	SoftBody *sb= ob->soft;	/* is supposed to be there */
 	BodyPoint *bp;
-	float dx[3] = {0}, dv[3], aabbmin[3], aabbmax[3], cm[3] = {0.0f, 0.0f, 0.0f};
+	float dx[3] = {0}, dv[3];
 	float timeovermass/*, freezeloc=0.00001f, freezeforce=0.00000000001f*/;
 	float maxerrpos= 0.0f, maxerrvel = 0.0f;
 	int a, fuzzy=0;
 
-	forcetime *= sb_time_scale(ob);
-
 	aabbmin[0]=aabbmin[1]=aabbmin[2] = 1e20f;
 	aabbmax[0]=aabbmax[1]=aabbmax[2] = -1e20f;
 
@@ -2500,7 +2506,7 @@ static void softbody_apply_forces(Object *ob, float forcetime, int mode, float *
 	else timeovermass = forcetime/0.009999f;
 	*/
 
-	for (a=sb->totpoint, bp= sb->bpoint; a>0; a--, bp++) {
+	for (a=ilast-ifirst, bp= &sb->bpoint[ifirst]; a>0; a--, bp++) {
 /* now we have individual masses   */
 /* claim a minimum mass for vertex */
 		if (_final_mass(ob, bp) > 0.009999f) timeovermass = forcetime/_final_mass(ob, bp);
@@ -2587,7 +2593,82 @@ static void softbody_apply_forces(Object *ob, float forcetime, int mode, float *
 		if (bp->loc_flag & SBF_DOFUZZY) fuzzy =1;
 	} /*for*/
 
-	if (sb->totpoint) mul_v3_fl(cm, 1.0f/sb->totpoint);
+	*r_maxerrpos = maxerrpos;
+	*r_maxerrvel = maxerrvel;
+	*r_fuzzy = fuzzy;
+}
+
+static void *exec_softbody_apply_forces(void *data)
+{
+	SB_thread_context *pctx = (SB_thread_context*)data;
+	_softbody_apply_forces_slice_in_a_thread(pctx->ob, pctx->forcetime, pctx->mode, pctx->mid_flags, pctx->ifirst, pctx->ilast,
+	                                         &pctx->maxerrpos, &pctx->maxerrvel, pctx->aabbmin, pctx->aabbmax, &pctx->fuzzy);
+	return NULL;
+}
+
+static void softbody_apply_forces(Scene *scene, Object *ob, float forcetime, int mode, float *err, int mid_flags)
+{
+	SoftBody *sb= ob->soft;	/* is supposed to be there */
+	ListBase threads;
+	SB_thread_context *sb_threads;
+	float maxerrpos= 0.0f, maxerrvel = 0.0f;
+	float aabbmin[3], aabbmax[3];
+	int i, totthread, left, dec, fuzzy=0;
+	int totpoint = sb->totpoint;
+	int lowpoints =100; /* wild guess .. may increase with better thread management 'above' or even be UI option sb->spawn_cf_threads_nopts */
+
+	forcetime *= sb_time_scale(ob);
+
+	/* points only write their own data, so slices can integrate in parallel;
+	 * error and bounding box accumulators are kept per thread and reduced below */
+	totthread= BKE_scene_num_threads(scene);
+	/* what if we got zillions of CPUs running but less to spread*/
+	while ((totpoint/totthread < lowpoints) && (totthread > 1)) {
+		totthread--;
+	}
+
+	sb_threads= MEM_callocN(sizeof(SB_thread_context)*totthread, "SBApplyForcesThread");
+	left = totpoint;
+	dec = totpoint/totthread +1;
+	for (i=0; i<totthread; i++) {
+		sb_threads[i].ob = ob;
+		sb_threads[i].forcetime = forcetime;
+		sb_threads[i].mode = mode;
+		sb_threads[i].mid_flags = mid_flags;
+		sb_threads[i].ilast   = left;
+		left = left - dec;
+		if (left >0) {
+			sb_threads[i].ifirst  = left;
+		}
+		else
+			sb_threads[i].ifirst  = 0;
+		sb_threads[i].nr= i;
+		sb_threads[i].tot= totthread;
+	}
+
+	if (totthread > 1) {
+		BLI_init_threads(&threads, exec_softbody_apply_forces, totthread);
+
+		for (i=0; i<totthread; i++)
+			BLI_insert_thread(&threads, &sb_threads[i]);
+
+		BLI_end_threads(&threads);
+	}
+	else
+		exec_softbody_apply_forces(&sb_threads[0]);
+
+	/* reduce the per thread results */
+	aabbmin[0]=aabbmin[1]=aabbmin[2] = 1e20f;
+	aabbmax[0]=aabbmax[1]=aabbmax[2] = -1e20f;
+	for (i=0; i<totthread; i++) {
+		maxerrpos = max_ff(maxerrpos, sb_threads[i].maxerrpos);
+		maxerrvel = max_ff(maxerrvel, sb_threads[i].maxerrvel);
+		minmax_v3v3_v3(aabbmin, aabbmax, sb_threads[i].aabbmin);
+		minmax_v3v3_v3(aabbmin, aabbmax, sb_threads[i].aabbmax);
+		fuzzy |= sb_threads[i].fuzzy;
+	}
+	MEM_freeN(sb_threads);
+
 	if (sb->scratch) {
 		copy_v3_v3(sb->scratch->aabbmin, aabbmin);
 		copy_v3_v3(sb->scratch->aabbmax, aabbmax);
@@ -3508,12 +3589,12 @@ static void softbody_step(Scene *scene, Object *ob, SoftBody *sb, float dtime)
 			/* do predictive euler step */
 			softbody_calc_forces(scene, ob, forcetime, timedone/dtime);
 
-			softbody_apply_forces(ob, forcetime, 1, NULL, mid_flags);
+			softbody_apply_forces(scene, ob, forcetime, 1, NULL, mid_flags);
 
 			/* crop new slope values to do averaged slope step */
 			softbody_calc_forces(scene, ob, forcetime, timedone/dtime);
 
-			softbody_apply_forces(ob, forcetime, 2, &err, mid_flags);
+			softbody_apply_forces(scene, ob, forcetime, 2, &err, mid_flags);
 			softbody_apply_goalsnap(ob);
 
 			if (err > SoftHeunTol) { /* error needs to be scaled to some quantity */
@@ -374,14 +374,20 @@ void BKE_sound_load(struct Main *bmain, bSound *sound)
 
 			/* load sound */
 			PackedFile *pf = sound->packedfile;
+			unsigned char *data;
 
 			/* don't modify soundact->sound->name, only change a copy */
 			BLI_strncpy(fullpath, sound->name, sizeof(fullpath));
 			BLI_path_abs(fullpath, ID_BLEND_PATH(bmain, &sound->id));
 
 			/* but we need a packed file then */
-			if (pf)
-				sound->handle = AUD_Sound_bufferFile((unsigned char *) pf->data, pf->size);
+			data = pf ? acquirePackedFileData(pf) : NULL;
+
+			if (data) {
+				/* the audio library copies the buffer */
+				sound->handle = AUD_Sound_bufferFile(data, pf->size);
+				releasePackedFileData(pf);
+			}
 			/* or else load it from disk */
 			else
 				sound->handle = AUD_Sound_file(fullpath);
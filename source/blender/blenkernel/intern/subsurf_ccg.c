@@ -3914,6 +3914,7 @@ static void ccgDM_release(DerivedMesh *dm)
 			}
 			MEM_freeN(ccgdm->gridHidden);
 		}
+		if (ccgdm->multires.grid_dirty) MEM_freeN(ccgdm->multires.grid_dirty);
 		if (ccgdm->freeSS) ccgSubSurf_free(ccgdm->ss);
 		if (ccgdm->pmap) MEM_freeN(ccgdm->pmap);
 		if (ccgdm->pmap_mem) MEM_freeN(ccgdm->pmap_mem);
@@ -4557,6 +4558,7 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
 	MEdge *medge = NULL;
 	MPoly *mpoly = NULL;
 	bool has_edge_cd;
+	CustomDataLayerPlan *loop_plan, *poly_plan, *edge_plan;
 
 	edgeSize = ccgSubSurf_getEdgeSize(ss);
 	gridSize = ccgSubSurf_getGridSize(ss);
@@ -4589,6 +4591,12 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
 	mcol = DM_get_tessface_data_layer(&ccgdm->dm, CD_MCOL);
 #endif
 
+	/* no layers are added while filling below, so the per-element layer
+	 * descriptor walk can be compiled into plans once */
+	loop_plan = CustomData_layer_plan_create(&dm->loopData, &ccgdm->dm.loopData);
+	poly_plan = CustomData_layer_plan_create(&dm->polyData, &ccgdm->dm.polyData);
+	edge_plan = CustomData_layer_plan_create(&dm->edgeData, &ccgdm->dm.edgeData);
+
 	loopindex = loopindex2 = 0; /* current loop index */
 	for (index = 0; index < totface; index++) {
 		CCGFace *f = ccgdm->faceMap[index].face;
@@ -4687,27 +4695,23 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
 			for (y = 0; y < gridFaces; y++) {
 				for (x = 0; x < gridFaces; x++) {
 					w2 = w + s * numVerts * g2_wid * g2_wid + (y * g2_wid + x) * numVerts;
-					CustomData_interp(&dm->loopData, &ccgdm->dm.loopData,
-					                  loopidx, w2, NULL, numVerts, loopindex2);
+					CustomData_layer_plan_interp(loop_plan, loopidx, w2, NULL, numVerts, loopindex2);
 					loopindex2++;
 
 					w2 = w + s * numVerts * g2_wid * g2_wid + ((y + 1) * g2_wid + (x)) * numVerts;
-					CustomData_interp(&dm->loopData, &ccgdm->dm.loopData,
-					                  loopidx, w2, NULL, numVerts, loopindex2);
+					CustomData_layer_plan_interp(loop_plan, loopidx, w2, NULL, numVerts, loopindex2);
 					loopindex2++;
 
 					w2 = w + s * numVerts * g2_wid * g2_wid + ((y + 1) * g2_wid + (x + 1)) * numVerts;
-					CustomData_interp(&dm->loopData, &ccgdm->dm.loopData,
-					                  loopidx, w2, NULL, numVerts, loopindex2);
+					CustomData_layer_plan_interp(loop_plan, loopidx, w2, NULL, numVerts, loopindex2);
 					loopindex2++;
 
 					w2 = w + s * numVerts * g2_wid * g2_wid + ((y) * g2_wid + (x + 1)) * numVerts;
-					CustomData_interp(&dm->loopData, &ccgdm->dm.loopData,
-					                  loopidx, w2, NULL, numVerts, loopindex2);
+					CustomData_layer_plan_interp(loop_plan, loopidx, w2, NULL, numVerts, loopindex2);
 					loopindex2++;
 
 					/*copy over poly data, e.g. mtexpoly*/
-					CustomData_copy_data(&dm->polyData, &ccgdm->dm.polyData, origIndex, faceNum, 1);
+					CustomData_layer_plan_copy_data(poly_plan, origIndex, faceNum, 1);
 
 					/*set original index data*/
 					if (faceOrigIndex) {
@@ -4773,7 +4777,7 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
 		if (has_edge_cd) {
 			BLI_assert(edgeIdx >= 0 && edgeIdx < dm->getNumEdges(dm));
 			for (i = 0; i < numFinalEdges; ++i) {
-				CustomData_copy_data(&dm->edgeData, &ccgdm->dm.edgeData, edgeIdx, edgeNum + i, 1);
+				CustomData_layer_plan_copy_data(edge_plan, edgeIdx, edgeNum + i, 1);
 			}
 		}
 
@@ -4821,6 +4825,9 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
 	BLI_array_free(vertidx);
 	BLI_array_free(loopidx);
 #endif
+	CustomData_layer_plan_free(loop_plan);
+	CustomData_layer_plan_free(poly_plan);
+	CustomData_layer_plan_free(edge_plan);
 	free_ss_weights(&wtable);
 
 	BLI_assert(vertNum == ccgSubSurf_getNumFinalVerts(ss));
@@ -523,6 +523,9 @@ typedef struct AccessCacheKey {
 	int frame;
 	int downscale;
 	libmv_InputMode input_mode;
+	bool has_region;
+	float region_min[2];
+	float region_max[2];
 	int64_t transform_key;
 } AccessCacheKey;
 
@@ -538,9 +541,9 @@ static bool accesscache_hashcmp(const void *a_v, const void *b_v)
 	const AccessCacheKey *a = (const AccessCacheKey *) a_v;
 	const AccessCacheKey *b = (const AccessCacheKey *) b_v;
 
-#define COMPARE_FIELD(field)
+#define COMPARE_FIELD(field) \
 	{ \
-		if (a->clip_index != b->clip_index) { \
+		if (a->field != b->field) { \
 			return false; \
 		} \
 	} (void) 0
@@ -549,28 +552,58 @@ static bool accesscache_hashcmp(const void *a_v, const void *b_v)
 	COMPARE_FIELD(frame);
 	COMPARE_FIELD(downscale);
 	COMPARE_FIELD(input_mode);
+	COMPARE_FIELD(has_region);
 	COMPARE_FIELD(transform_key);
 
 #undef COMPARE_FIELD
 
+	if (a->has_region) {
+		if (!equals_v2v2(a->region_min, b->region_min) ||
+		    !equals_v2v2(a->region_max, b->region_max))
+		{
+			return false;
+		}
+	}
+
 	return true;
 }
 
+static void accesscache_construct_key(AccessCacheKey *key,
+                                      int clip_index,
+                                      int frame,
+                                      libmv_InputMode input_mode,
+                                      int downscale,
+                                      const libmv_Region *region,
+                                      int64_t transform_key)
+{
+	memset(key, 0, sizeof(*key));
+	key->clip_index = clip_index;
+	key->frame = frame;
+	key->input_mode = input_mode;
+	key->downscale = downscale;
+	key->has_region = (region != NULL);
+	if (key->has_region) {
+		copy_v2_v2(key->region_min, region->min);
+		copy_v2_v2(key->region_max, region->max);
+	}
+	key->transform_key = transform_key;
+}
+
 static void accesscache_put(TrackingImageAccessor *accessor,
                             int clip_index,
                             int frame,
                             libmv_InputMode input_mode,
                             int downscale,
+                            const libmv_Region *region,
                             int64_t transform_key,
                             ImBuf *ibuf)
 {
 	AccessCacheKey key;
-	key.clip_index = clip_index;
-	key.frame = frame;
-	key.input_mode = input_mode;
-	key.downscale = downscale;
-	key.transform_key = transform_key;
+	accesscache_construct_key(&key, clip_index, frame, input_mode, downscale,
+	                          region, transform_key);
+	BLI_spin_lock(&accessor->cache_lock);
 	IMB_moviecache_put(accessor->cache, &key, ibuf);
+	BLI_spin_unlock(&accessor->cache_lock);
 }
 
 static ImBuf *accesscache_get(TrackingImageAccessor *accessor,
@@ -578,15 +611,17 @@ static ImBuf *accesscache_get(TrackingImageAccessor *accessor,
                               int frame,
                               libmv_InputMode input_mode,
                               int downscale,
+                              const libmv_Region *region,
                               int64_t transform_key)
 {
 	AccessCacheKey key;
-	key.clip_index = clip_index;
-	key.frame = frame;
-	key.input_mode = input_mode;
-	key.downscale = downscale;
-	key.transform_key = transform_key;
-	return IMB_moviecache_get(accessor->cache, &key);
+	ImBuf *ibuf;
+	accesscache_construct_key(&key, clip_index, frame, input_mode, downscale,
+	                          region, transform_key);
+	BLI_spin_lock(&accessor->cache_lock);
+	ibuf = IMB_moviecache_get(accessor->cache, &key);
+	BLI_spin_unlock(&accessor->cache_lock);
+	return ibuf;
 }
 
 static ImBuf *accessor_get_preprocessed_ibuf(TrackingImageAccessor *accessor,
@@ -685,6 +720,7 @@ static ImBuf *accessor_get_ibuf(TrackingImageAccessor *accessor,
 	                       frame,
 	                       input_mode,
 	                       downscale,
+	                       region,
 	                       transform_key);
 	if (ibuf != NULL) {
 		return ibuf;
@@ -806,23 +842,19 @@ static ImBuf *accessor_get_ibuf(TrackingImageAccessor *accessor,
 
 	/* We put postprocessed frame to the cache always for now,
 	 * not the smartest thing in the world, but who cares at this point.
-	 */
-
-	/* TODO(sergey): Disable cache for now, because we don't store region
-	 * in the cache key and can't check whether cached version is usable for
-	 * us or not.
 	 *
-	 * Need to think better about what to cache and when.
+	 * The requested region (or its absence) is part of the cache key, so
+	 * search-area patches for different markers never alias each other and
+	 * repeated lookups of the same patch skip the decode and postprocessing.
 	 */
-	if (false) {
-		accesscache_put(accessor,
-		                clip_index,
-		                frame,
-		                input_mode,
-		                downscale,
-		                transform_key,
-		                final_ibuf);
-	}
+	accesscache_put(accessor,
+	                clip_index,
+	                frame,
+	                input_mode,
+	                downscale,
+	                region,
+	                transform_key,
+	                final_ibuf);
 
 	return final_ibuf;
 }
@@ -889,6 +921,11 @@ TrackingImageAccessor *tracking_image_accessor_new(MovieClip *clips[MAX_ACCESSOR
 	                                        accesscache_hashhash,
 	                                        accesscache_hashcmp);
 
+	/* background access, don't push interactive buffers out of the cache */
+	IMB_moviecache_set_priority_band(accessor->cache, MOVIECACHE_BAND_THUMBNAIL);
+
+	BLI_spin_init(&accessor->cache_lock);
+
 	memcpy(accessor->clips, clips, num_clips * sizeof(MovieClip *));
 	accessor->num_clips = num_clips;
 	accessor->start_frame = start_frame;
@@ -903,6 +940,7 @@ TrackingImageAccessor *tracking_image_accessor_new(MovieClip *clips[MAX_ACCESSOR
 
 void tracking_image_accessor_destroy(TrackingImageAccessor *accessor)
 {
+	BLI_spin_end(&accessor->cache_lock);
 	IMB_moviecache_free(accessor->cache);
 	libmv_FrameAccessorDestroy(accessor->libmv_accessor);
 	MEM_freeN(accessor);
@@ -43,6 +43,7 @@
 #include "DNA_scene_types.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_threads.h"
 
 #ifdef WITH_AUDASPACE
 #  include AUD_DEVICE_H
@@ -62,6 +63,15 @@
 
 #include "ffmpeg_compat.h"
 
+/* Number of frame buffers cycling between the render thread and the encode
+ * worker, bounds how far encoding may lag behind the render loop. */
+#define FFMPEG_FRAME_QUEUE_SIZE 2
+
+typedef struct FFMpegFrameTask {
+	int cfra;
+	uint8_t *pixels;
+} FFMpegFrameTask;
+
 typedef struct FFMpegContext {
 	int ffmpeg_type;
 	int ffmpeg_codec;
@@ -90,6 +100,18 @@ typedef struct FFMpegContext {
 	bool audio_deinterleave;
 	int audio_sample_size;
 
+	/* Asynchronous encoding: the render thread hands copied frame pixels to a
+	 * worker which converts, encodes and muxes them, overlapping with the next
+	 * frame's render. The free queue doubles as the bounded frame buffer pool. */
+	ListBase encode_threads;
+	ThreadQueue *encode_queue;
+	ThreadQueue *encode_free_queue;
+	ThreadMutex mux_mutex;
+	FFMpegFrameTask encode_tasks[FFMPEG_FRAME_QUEUE_SIZE];
+	RenderData *encode_rd;
+	ReportList *encode_reports;
+	int encode_success;
+
 #ifdef WITH_AUDASPACE
 	AUD_Device *audio_mixdown_device;
 #endif
@@ -127,6 +149,7 @@ static int write_audio_frame(FFMpegContext *context)
 	AVPacket pkt;
 	AVFrame *frame = NULL;
 	int got_output = 0;
+	int write_ret;
 
 	c = context->audio_stream->codec;
 
@@ -199,7 +222,11 @@ static int write_audio_frame(FFMpegContext *context)
 
 		pkt.flags |= AV_PKT_FLAG_KEY;
 
-		if (av_interleaved_write_frame(context->outfile, &pkt) != 0) {
+		BLI_mutex_lock(&context->mux_mutex);
+		write_ret = av_interleaved_write_frame(context->outfile, &pkt);
+		BLI_mutex_unlock(&context->mux_mutex);
+
+		if (write_ret != 0) {
 			fprintf(stderr, "Error writing audio packet!\n");
 			if (frame)
 				av_frame_free(&frame);
@@ -340,7 +367,9 @@ static int write_video_frame(FFMpegContext *context, RenderData *rd, int cfra, A
 		}
 
 		packet.stream_index = context->video_stream->index;
+		BLI_mutex_lock(&context->mux_mutex);
 		ret = av_interleaved_write_frame(context->outfile, &packet);
+		BLI_mutex_unlock(&context->mux_mutex);
 		success = (ret == 0);
 	}
 	else if (ret < 0) {
@@ -382,18 +411,10 @@ static AVFrame *generate_video_frame(FFMpegContext *context, uint8_t *pixels, Re
 	if (ENDIAN_ORDER == L_ENDIAN) {
 		int y;
 		for (y = 0; y < height; y++) {
-			uint8_t *target = rgb_frame->data[0] + width * 4 * (height - y - 1);
-			uint8_t *src = rendered_frame + width * 4 * y;
-			uint8_t *end = src + width * 4;
-			while (src != end) {
-				target[3] = src[3];
-				target[2] = src[2];
-				target[1] = src[1];
-				target[0] = src[0];
-
-				target += 4;
-				src += 4;
-			}
+			/* no byte swapping needed, rows are copied as they are */
+			memcpy(rgb_frame->data[0] + width * 4 * (height - y - 1),
+			       rendered_frame + width * 4 * y,
+			       width * 4);
 		}
 	}
 	else {
@@ -1181,11 +1202,88 @@ static void write_audio_frames(FFMpegContext *context, double to_pts)
 }
 #endif
 
+static void *ffmpeg_encode_thread(void *context_v)
+{
+	FFMpegContext *context = context_v;
+	FFMpegFrameTask *task;
+	AVFrame *avframe;
+
+	/* NULL is returned once the queue is set to nowait at shutdown */
+	while ((task = BLI_thread_queue_pop(context->encode_queue))) {
+		avframe = generate_video_frame(context, task->pixels, context->encode_reports);
+
+		if (!(avframe && write_video_frame(context, context->encode_rd, task->cfra, avframe, context->encode_reports))) {
+			context->encode_success = 0;
+		}
+
+		BLI_thread_queue_push(context->encode_free_queue, task);
+	}
+
+	return NULL;
+}
+
+static void ffmpeg_encode_threads_start(FFMpegContext *context, RenderData *rd, int rectx, int recty,
+                                        ReportList *reports)
+{
+	int i;
+
+	context->encode_queue = BLI_thread_queue_init();
+	context->encode_free_queue = BLI_thread_queue_init();
+	context->encode_rd = rd;
+	context->encode_reports = reports;
+	context->encode_success = 1;
+
+	for (i = 0; i < FFMPEG_FRAME_QUEUE_SIZE; i++) {
+		context->encode_tasks[i].pixels = MEM_mallocN((size_t)rectx * recty * 4, "ffmpeg encode pixels");
+		BLI_thread_queue_push(context->encode_free_queue, &context->encode_tasks[i]);
+	}
+
+	BLI_init_threads(&context->encode_threads, ffmpeg_encode_thread, 1);
+	BLI_insert_thread(&context->encode_threads, context);
+}
+
+/* wait until all queued frames are encoded and the worker is idle */
+static void ffmpeg_encode_sync(FFMpegContext *context)
+{
+	FFMpegFrameTask *tasks[FFMPEG_FRAME_QUEUE_SIZE];
+	int i;
+
+	if (!context->encode_threads.first)
+		return;
+
+	/* Owning all pool entries means the worker has nothing queued and
+	 * nothing in flight. */
+	for (i = 0; i < FFMPEG_FRAME_QUEUE_SIZE; i++)
+		tasks[i] = BLI_thread_queue_pop(context->encode_free_queue);
+	for (i = 0; i < FFMPEG_FRAME_QUEUE_SIZE; i++)
+		BLI_thread_queue_push(context->encode_free_queue, tasks[i]);
+}
+
+static void ffmpeg_encode_threads_end(FFMpegContext *context)
+{
+	int i;
+
+	if (context->encode_threads.first) {
+		ffmpeg_encode_sync(context);
+		BLI_thread_queue_nowait(context->encode_queue);
+		BLI_end_threads(&context->encode_threads);
+
+		BLI_thread_queue_free(context->encode_queue);
+		BLI_thread_queue_free(context->encode_free_queue);
+		context->encode_queue = NULL;
+		context->encode_free_queue = NULL;
+
+		for (i = 0; i < FFMPEG_FRAME_QUEUE_SIZE; i++) {
+			MEM_freeN(context->encode_tasks[i].pixels);
+			context->encode_tasks[i].pixels = NULL;
+		}
+	}
+}
+
 int BKE_ffmpeg_append(void *context_v, RenderData *rd, int start_frame, int frame, int *pixels,
                       int rectx, int recty, const char *suffix, ReportList *reports)
 {
 	FFMpegContext *context = context_v;
-	AVFrame *avframe;
 	int success = 1;
 
 	PRINT("Writing frame %i, render width=%d, render height=%d\n", frame, rectx, recty);
@@ -1194,16 +1292,32 @@ int BKE_ffmpeg_append(void *context_v, RenderData *rd, int start_frame, int fram
 //	write_audio_frames(frame / (((double)rd->frs_sec) / rd->frs_sec_base));
 
 	if (context->video_stream) {
-		avframe = generate_video_frame(context, (unsigned char *) pixels, reports);
-		success = (avframe && write_video_frame(context, rd, frame - start_frame, avframe, reports));
+		FFMpegFrameTask *task;
+
+		if (context->encode_threads.first == NULL) {
+			ffmpeg_encode_threads_start(context, rd, rectx, recty, reports);
+		}
+
+		/* Blocks while all pool frames are queued or encoding, which bounds
+		 * the pipeline to encoding one frame while the next one renders. */
+		task = BLI_thread_queue_pop(context->encode_free_queue);
+		task->cfra = frame - start_frame;
+		memcpy(task->pixels, pixels, (size_t)rectx * recty * 4);
+		BLI_thread_queue_push(context->encode_queue, task);
 
 		if (context->ffmpeg_autosplit) {
+			/* Measuring the file size needs the muxer idle, and splitting
+			 * recreates the container, so autosplit stays synchronous. */
+			ffmpeg_encode_sync(context);
 			if (avio_tell(context->outfile->pb) > FFMPEG_AUTOSPLIT_SIZE) {
+				ffmpeg_encode_threads_end(context);
 				end_ffmpeg_impl(context, true);
 				context->ffmpeg_autosplit_count++;
 				success &= start_ffmpeg_impl(context, rd, rectx, recty, suffix, reports);
 			}
 		}
+
+		success &= context->encode_success;
 	}
 
 #ifdef WITH_AUDASPACE
@@ -1216,6 +1330,9 @@ static void end_ffmpeg_impl(FFMpegContext *context, int is_autosplit)
 {
 	PRINT("Closing ffmpeg...\n");
 
+	/* encode worker references the streams and the muxer, stop it first */
+	ffmpeg_encode_threads_end(context);
+
 #if 0
 	if (context->audio_stream) { /* SEE UPPER */
 		write_audio_frames(context);
@@ -1702,6 +1819,8 @@ void *BKE_ffmpeg_context_create(void)
 	context->ffmpeg_autosplit_count = 0;
 	context->ffmpeg_preview = false;
 
+	BLI_mutex_init(&context->mux_mutex);
+
 	return context;
 }
 
@@ -1709,6 +1828,7 @@ void BKE_ffmpeg_context_free(void *context_v)
 {
 	FFMpegContext *context = context_v;
 	if (context) {
+		BLI_mutex_end(&context->mux_mutex);
 		MEM_freeN(context);
 	}
 }
@@ -116,6 +116,8 @@ typedef struct TrackingImageAccessor {
 	int num_clips;
 	int start_frame;
 	struct libmv_FrameAccessor *libmv_accessor;
+	/* protects the cache, accessor callbacks run from tracker threads */
+	SpinLock cache_lock;
 } TrackingImageAccessor;
 
 TrackingImageAccessor *tracking_image_accessor_new(MovieClip *clips[MAX_ACCESSOR_CLIP],
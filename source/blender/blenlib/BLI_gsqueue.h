@@ -43,4 +43,14 @@ void        BLI_gsqueue_push(GSQueue *gq, const void *item);
 void        BLI_gsqueue_pushback(GSQueue *gq, const void *item);
 void        BLI_gsqueue_free(GSQueue *gq);
 
+/* Bounded lock-free multi-producer/multi-consumer variant,
+ * for high frequency producer/consumer handoff, see gsqueue.c. */
+typedef struct _GSQueueMPMC GSQueueMPMC;
+
+GSQueueMPMC *BLI_gsqueue_mpmc_new(size_t elem_size, unsigned int tot_elem);
+bool         BLI_gsqueue_mpmc_push(GSQueueMPMC *gq, const void *item);
+bool         BLI_gsqueue_mpmc_pop(GSQueueMPMC *gq, void *r_item);
+bool         BLI_gsqueue_mpmc_is_empty(GSQueueMPMC *gq);
+void         BLI_gsqueue_mpmc_free(GSQueueMPMC *gq);
+
 #endif /* __BLI_GSQUEUE_H__ */
@@ -104,6 +104,10 @@ typedef bool (*BVHTree_OverlapCallback)(void *userdata, int index_a, int index_b
 /* callback to range search query */
 typedef void (*BVHTree_RangeQuery)(void *userdata, int index, const float co[3], float dist_sq);
 
+/* callback to fetch the updated points of a leaf element for BLI_bvhtree_refit,
+ * writes at most 4 points into r_co and returns how many were written */
+typedef int (*BVHTree_RefitCallback)(void *userdata, int index, float r_co[4][3]);
+
 
 /* callbacks to BLI_bvhtree_walk_dfs */
 /* return true to traverse into this nodes children, else skip. */
@@ -125,6 +129,9 @@ void BLI_bvhtree_balance(BVHTree *tree);
 bool BLI_bvhtree_update_node(BVHTree *tree, int index, const float co[3], const float co_moving[3], int numpoints);
 void BLI_bvhtree_update_tree(BVHTree *tree);
 
+/* refit all leaves at once through a callback, then update the tree */
+void BLI_bvhtree_refit(BVHTree *tree, BVHTree_RefitCallback refit_cb, void *userdata);
+
 int BLI_bvhtree_overlap_thread_num(const BVHTree *tree);
 
 /* collision/overlap: check two trees if they overlap, alloc's *overlap with length of the int return value */
@@ -150,6 +157,10 @@ int BLI_bvhtree_ray_cast_ex(
         BVHTree *tree, const float co[3], const float dir[3], float radius, BVHTreeRayHit *hit,
         BVHTree_RayCastCallback callback, void *userdata,
         int flag);
+void BLI_bvhtree_ray_cast_batch(
+        BVHTree *tree, const float (*ray_start)[3], const float (*ray_dir)[3], int ray_tot,
+        float radius, BVHTreeRayHit *hits,
+        BVHTree_RayCastCallback callback, void *userdata);
 int BLI_bvhtree_ray_cast(
         BVHTree *tree, const float co[3], const float dir[3], float radius, BVHTreeRayHit *hit,
         BVHTree_RayCastCallback callback, void *userdata);
@@ -53,6 +53,10 @@ int BLI_kdtree_find_nearest(
         const KDTree *tree, const float co[3],
         KDTreeNearest *r_nearest) ATTR_NONNULL(1, 2);
 
+void BLI_kdtree_find_nearest_batch(
+        const KDTree *tree, const float (*co_array)[3], unsigned int co_tot,
+        KDTreeNearest *r_nearest) ATTR_NONNULL(1, 2, 4);
+
 #define BLI_kdtree_find_nearest_n(tree, co, r_nearest, n) \
         BLI_kdtree_find_nearest_n__normal(tree, co, NULL, r_nearest, n)
 #define BLI_kdtree_range_search(tree, co, r_nearest, range) \
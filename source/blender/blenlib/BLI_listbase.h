@@ -114,6 +114,30 @@ if ((lb)->first && (lb_init || (lb_init = (lb)->first))) { \
 	         (lb_iter != lb_init)); \
 }
 
+/**
+ * Frozen (array backed) view over a #ListBase.
+ *
+ * Hot loops which walk long lists every update pay a dependent load per
+ * element, snapshotting the links into a contiguous array once makes the
+ * traversal cache & prefetcher friendly. The view owns its array and is
+ * re-usable: pass a generation number that the caller bumps whenever the
+ * list changes and #BLI_listbase_frozen_ensure only re-builds on mismatch.
+ */
+typedef struct ListBaseFrozen {
+	struct Link **array;
+	unsigned int count;
+	unsigned int count_alloc;
+	/* caller supplied, view is re-built when it differs */
+	unsigned int generation;
+	bool is_valid;
+} ListBaseFrozen;
+
+#define BLI_LISTBASE_FROZEN_INIT {NULL, 0, 0, 0, false}
+
+void BLI_listbase_frozen_ensure(ListBaseFrozen *fl, const struct ListBase *lb, unsigned int generation) ATTR_NONNULL(1, 2);
+void BLI_listbase_frozen_tag_dirty(ListBaseFrozen *fl) ATTR_NONNULL(1);
+void BLI_listbase_frozen_clear(ListBaseFrozen *fl) ATTR_NONNULL(1);
+
 #define BLI_LISTBASE_CIRCULAR_BACKWARD_BEGIN(lb, lb_iter, lb_init) \
 if ((lb)->last && (lb_init || (lb_init = (lb)->last))) { \
 	lb_iter = lb_init; \
@@ -57,6 +57,16 @@ void               *BLI_memarena_calloc(struct MemArena *ma, size_t size) ATTR_W
 
 void BLI_memarena_clear(MemArena *ma) ATTR_NONNULL(1);
 
+/* Snapshot & rewind, members are private (see BLI_memarena.c). */
+typedef struct MemArenaSnapshot {
+	struct LinkNode *bufs;
+	unsigned char *curbuf;
+	size_t cursize;
+} MemArenaSnapshot;
+
+void BLI_memarena_snapshot(MemArena *ma, MemArenaSnapshot *snapshot) ATTR_NONNULL(1, 2);
+void BLI_memarena_rewind(MemArena *ma, const MemArenaSnapshot *snapshot) ATTR_NONNULL(1, 2);
+
 #ifdef __cplusplus
 }
 #endif
@@ -82,9 +82,17 @@ enum {
 	 * \note order of iteration is only assured to be the order of allocation when no chunks have been freed.
 	 */
 	BLI_MEMPOOL_ALLOW_ITER = (1 << 0),
+
+	/* Allow #BLI_mempool_alloc / #BLI_mempool_free to be called from
+	 * multiple threads concurrently (other functions still require
+	 * external synchronization). Allocations go through small per-thread
+	 * magazines which are refilled from / flushed to the shared free list
+	 * in batches, so threads rarely touch the shared lock. */
+	BLI_MEMPOOL_THREADSAFE = (1 << 1),
 };
 
 void  BLI_mempool_iternew(BLI_mempool *pool, BLI_mempool_iter *iter) ATTR_NONNULL();
+void  BLI_mempool_chunks_sort(BLI_mempool *pool) ATTR_NONNULL(1);
 void *BLI_mempool_iterstep(BLI_mempool_iter *iter) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
 
 #ifdef __cplusplus
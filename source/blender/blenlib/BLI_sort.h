@@ -49,4 +49,12 @@ __attribute__((nonnull(1, 5)))
 #endif
 ;
 
+/* Multi-threaded quick/merge sort, see implementation for details.
+ * The compare callback must be thread-safe. */
+void BLI_qsort_parallel(void *a, size_t n, size_t es, BLI_sort_cmp_t cmp, void *thunk)
+#ifdef __GNUC__
+__attribute__((nonnull(1, 5)))
+#endif
+;
+
 #endif  /* __BLI_SORT_H__ */
@@ -113,6 +113,15 @@ struct GHash {
 
 	unsigned int nentries;
 	unsigned int flag;
+
+	/* Flat (open-addressing) storage, used instead of buckets/entrypool for
+	 * hashes created with #GHASH_FLAG_IS_FLAT. Entries live in parallel
+	 * arrays (hash is cached so probing does not chase key pointers),
+	 * always power-of-two sized. */
+	unsigned int *fl_hashes;
+	void **fl_keys;
+	void **fl_vals;
+	unsigned int fl_nbuckets, fl_mask, fl_limit_grow;
 };
 
 
@@ -429,6 +438,183 @@ BLI_INLINE Entry *ghash_lookup_entry(GHash *gh, const void *key)
 	return ghash_lookup_entry_ex(gh, key, bucket_index);
 }
 
+/* Internal Flat (Open-Addressing) Storage
+ *
+ * Robin-hood linear probing over three parallel arrays, so probe sequences
+ * walk contiguous memory instead of chasing per-entry mempool pointers.
+ * This favors lookup-heavy usages (it trades away stable entry pointers,
+ * hence no iterator support and no GSet mode). */
+
+#define GHASH_FLAT_NBUCKETS_MIN 8
+
+BLI_INLINE bool ghash_is_flat(const GHash *gh)
+{
+	return (gh->flag & GHASH_FLAG_IS_FLAT) != 0;
+}
+
+/* Zero marks an empty slot, so never store a zero hash. */
+BLI_INLINE unsigned int ghash_flat_keyhash(GHash *gh, const void *key)
+{
+	const unsigned int hash = gh->hashfp(key);
+	return hash ? hash : 1u;
+}
+
+BLI_INLINE unsigned int ghash_flat_probe_distance(
+        const GHash *gh, const unsigned int hash, const unsigned int index)
+{
+	return (index + gh->fl_nbuckets - (hash & gh->fl_mask)) & gh->fl_mask;
+}
+
+/**
+ * Robin-hood insertion of an already-hashed pair.
+ * No growing and no duplicate check, callers handle both.
+ */
+static void ghash_flat_insert_no_grow(GHash *gh, unsigned int hash, void *key, void *val)
+{
+	unsigned int index = hash & gh->fl_mask;
+	unsigned int dist = 0;
+
+	while (gh->fl_hashes[index] != 0) {
+		const unsigned int dist_curr = ghash_flat_probe_distance(gh, gh->fl_hashes[index], index);
+		if (dist_curr < dist) {
+			/* Entry closer to its home than we are to ours:
+			 * take its slot and keep probing with the evicted entry. */
+			SWAP(unsigned int, hash, gh->fl_hashes[index]);
+			SWAP(void *, key, gh->fl_keys[index]);
+			SWAP(void *, val, gh->fl_vals[index]);
+			dist = dist_curr;
+		}
+		index = (index + 1) & gh->fl_mask;
+		dist++;
+	}
+
+	gh->fl_hashes[index] = hash;
+	gh->fl_keys[index] = key;
+	gh->fl_vals[index] = val;
+}
+
+static void ghash_flat_buckets_resize(GHash *gh, const unsigned int nbuckets)
+{
+	unsigned int *hashes_old = gh->fl_hashes;
+	void **keys_old = gh->fl_keys;
+	void **vals_old = gh->fl_vals;
+	const unsigned int nbuckets_old = gh->fl_nbuckets;
+	unsigned int i;
+
+	BLI_assert((nbuckets & (nbuckets - 1)) == 0);
+
+	gh->fl_nbuckets = nbuckets;
+	gh->fl_mask = nbuckets - 1;
+	gh->fl_limit_grow = GHASH_LIMIT_GROW(nbuckets);
+
+	gh->fl_hashes = MEM_callocN(sizeof(*gh->fl_hashes) * nbuckets, __func__);
+	gh->fl_keys = MEM_mallocN(sizeof(*gh->fl_keys) * nbuckets, __func__);
+	gh->fl_vals = MEM_mallocN(sizeof(*gh->fl_vals) * nbuckets, __func__);
+
+	if (hashes_old) {
+		for (i = 0; i < nbuckets_old; i++) {
+			if (hashes_old[i] != 0) {
+				ghash_flat_insert_no_grow(gh, hashes_old[i], keys_old[i], vals_old[i]);
+			}
+		}
+		MEM_freeN(hashes_old);
+		MEM_freeN(keys_old);
+		MEM_freeN(vals_old);
+	}
+}
+
+BLI_INLINE void ghash_flat_expand(GHash *gh, const unsigned int nentries)
+{
+	if (UNLIKELY(nentries > gh->fl_limit_grow)) {
+		unsigned int nbuckets = gh->fl_nbuckets;
+		while (nentries > GHASH_LIMIT_GROW(nbuckets)) {
+			nbuckets <<= 1;
+		}
+		ghash_flat_buckets_resize(gh, nbuckets);
+	}
+}
+
+static void ghash_flat_buckets_reset(GHash *gh, const unsigned int nentries_reserve)
+{
+	unsigned int nbuckets = GHASH_FLAT_NBUCKETS_MIN;
+
+	MEM_SAFE_FREE(gh->fl_hashes);
+	MEM_SAFE_FREE(gh->fl_keys);
+	MEM_SAFE_FREE(gh->fl_vals);
+
+	while (nentries_reserve > GHASH_LIMIT_GROW(nbuckets)) {
+		nbuckets <<= 1;
+	}
+
+	gh->fl_nbuckets = 0;
+	gh->nentries = 0;
+	ghash_flat_buckets_resize(gh, nbuckets);
+}
+
+/**
+ * \return slot index of \a key, or UINT_MAX when not in \a gh.
+ */
+static unsigned int ghash_flat_lookup_index(GHash *gh, const void *key, const unsigned int hash)
+{
+	unsigned int index = hash & gh->fl_mask;
+	unsigned int dist = 0;
+
+	while (gh->fl_hashes[index] != 0) {
+		/* Robin-hood invariant: once an entry sits closer to its home than
+		 * we are to ours, the key cannot be any further along. */
+		if (ghash_flat_probe_distance(gh, gh->fl_hashes[index], index) < dist) {
+			break;
+		}
+		if ((gh->fl_hashes[index] == hash) &&
+		    (gh->cmpfp(key, gh->fl_keys[index]) == false))
+		{
+			return index;
+		}
+		index = (index + 1) & gh->fl_mask;
+		dist++;
+	}
+
+	return UINT_MAX;
+}
+
+/**
+ * Remove the entry at \a index, using backward-shifting
+ * (keeps the probe invariant without tombstones).
+ */
+static void ghash_flat_remove_index(GHash *gh, unsigned int index)
+{
+	unsigned int index_next = (index + 1) & gh->fl_mask;
+
+	while ((gh->fl_hashes[index_next] != 0) &&
+	       (ghash_flat_probe_distance(gh, gh->fl_hashes[index_next], index_next) != 0))
+	{
+		gh->fl_hashes[index] = gh->fl_hashes[index_next];
+		gh->fl_keys[index] = gh->fl_keys[index_next];
+		gh->fl_vals[index] = gh->fl_vals[index_next];
+		index = index_next;
+		index_next = (index_next + 1) & gh->fl_mask;
+	}
+
+	gh->fl_hashes[index] = 0;
+	gh->nentries--;
+}
+
+static void ghash_flat_free_cb(GHash *gh, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp)
+{
+	unsigned int i;
+
+	for (i = 0; i < gh->fl_nbuckets; i++) {
+		if (gh->fl_hashes[i] != 0) {
+			if (keyfreefp) {
+				keyfreefp(gh->fl_keys[i]);
+			}
+			if (valfreefp) {
+				valfreefp(gh->fl_vals[i]);
+			}
+		}
+	}
+}
+
 static GHash *ghash_new(GHashHashFP hashfp, GHashCmpFP cmpfp, const char *info,
                         const unsigned int nentries_reserve, const unsigned int flag)
 {
@@ -438,10 +624,21 @@ static GHash *ghash_new(GHashHashFP hashfp, GHashCmpFP cmpfp, const char *info,
 	gh->cmpfp = cmpfp;
 
 	gh->buckets = NULL;
+	gh->entrypool = NULL;
+	gh->fl_hashes = NULL;
+	gh->fl_keys = NULL;
+	gh->fl_vals = NULL;
+	gh->fl_nbuckets = 0;
 	gh->flag = flag;
 
-	ghash_buckets_reset(gh, nentries_reserve);
-	gh->entrypool = BLI_mempool_create(GHASH_ENTRY_SIZE(flag & GHASH_FLAG_IS_GSET), 64, 64, BLI_MEMPOOL_NOP);
+	if (flag & GHASH_FLAG_IS_FLAT) {
+		BLI_assert(!(flag & GHASH_FLAG_IS_GSET));
+		ghash_flat_buckets_reset(gh, nentries_reserve);
+	}
+	else {
+		ghash_buckets_reset(gh, nentries_reserve);
+		gh->entrypool = BLI_mempool_create(GHASH_ENTRY_SIZE(flag & GHASH_FLAG_IS_GSET), 64, 64, BLI_MEMPOOL_NOP);
+	}
 
 	return gh;
 }
@@ -652,6 +849,20 @@ static GHash *ghash_copy(GHash *gh, GHashKeyCopyFP keycopyfp, GHashValCopyFP val
 {
 	GHash *gh_new;
 	unsigned int i;
+
+	if (ghash_is_flat(gh)) {
+		gh_new = ghash_new(gh->hashfp, gh->cmpfp, __func__, 0, gh->flag);
+		ghash_flat_buckets_resize(gh_new, gh->fl_nbuckets);
+		for (i = 0; i < gh->fl_nbuckets; i++) {
+			gh_new->fl_hashes[i] = gh->fl_hashes[i];
+			if (gh->fl_hashes[i] != 0) {
+				gh_new->fl_keys[i] = (keycopyfp) ? keycopyfp(gh->fl_keys[i]) : gh->fl_keys[i];
+				gh_new->fl_vals[i] = (valcopyfp) ? valcopyfp(gh->fl_vals[i]) : gh->fl_vals[i];
+			}
+		}
+		gh_new->nentries = gh->nentries;
+		return gh_new;
+	}
 	/* This allows us to be sure to get the same number of buckets in gh_new as in ghash. */
 	const unsigned int reserve_nentries_new = MAX2(GHASH_LIMIT_GROW(gh->nbuckets) - 1, gh->nentries);
 
@@ -713,6 +924,29 @@ GHash *BLI_ghash_new(GHashHashFP hashfp, GHashCmpFP cmpfp, const char *info)
 	return BLI_ghash_new_ex(hashfp, cmpfp, info, 0);
 }
 
+/**
+ * Creates a new, empty GHash using flat (open-addressing) storage.
+ *
+ * Entries are kept in contiguous arrays with robin-hood probing, which makes
+ * lookup-heavy usages much more cache friendly than the default chained
+ * storage. The trade-offs: entry pointers are not stable across insertions
+ * (so pointers returned by e.g. #BLI_ghash_lookup_p are invalidated by any
+ * insert/remove), and iterators are not supported.
+ */
+GHash *BLI_ghash_flat_new_ex(GHashHashFP hashfp, GHashCmpFP cmpfp, const char *info,
+                             const unsigned int nentries_reserve)
+{
+	return ghash_new(hashfp, cmpfp, info, nentries_reserve, GHASH_FLAG_IS_FLAT);
+}
+
+/**
+ * Wraps #BLI_ghash_flat_new_ex with zero entries reserved.
+ */
+GHash *BLI_ghash_flat_new(GHashHashFP hashfp, GHashCmpFP cmpfp, const char *info)
+{
+	return BLI_ghash_flat_new_ex(hashfp, cmpfp, info, 0);
+}
+
 /**
  * Copy given GHash. Keys and values are also copied if relevant callback is provided, else pointers remain the same.
  */
@@ -726,6 +960,10 @@ GHash *BLI_ghash_copy(GHash *gh, GHashKeyCopyFP keycopyfp, GHashValCopyFP valcop
  */
 void BLI_ghash_reserve(GHash *gh, const unsigned int nentries_reserve)
 {
+	if (ghash_is_flat(gh)) {
+		ghash_flat_expand(gh, nentries_reserve);
+		return;
+	}
 	ghash_buckets_expand(gh, nentries_reserve, true);
 	ghash_buckets_contract(gh, nentries_reserve, true, false);
 }
@@ -747,6 +985,13 @@ unsigned int BLI_ghash_size(GHash *gh)
  */
 void BLI_ghash_insert(GHash *gh, void *key, void *val)
 {
+	if (ghash_is_flat(gh)) {
+		const unsigned int hash = ghash_flat_keyhash(gh, key);
+		BLI_assert((gh->flag & GHASH_FLAG_ALLOW_DUPES) || (BLI_ghash_haskey(gh, key) == 0));
+		ghash_flat_expand(gh, ++gh->nentries);
+		ghash_flat_insert_no_grow(gh, hash, key, val);
+		return;
+	}
 	ghash_insert(gh, key, val);
 }
 
@@ -759,6 +1004,24 @@ void BLI_ghash_insert(GHash *gh, void *key, void *val)
  */
 bool BLI_ghash_reinsert(GHash *gh, void *key, void *val, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp)
 {
+	if (ghash_is_flat(gh)) {
+		const unsigned int hash = ghash_flat_keyhash(gh, key);
+		const unsigned int index = ghash_flat_lookup_index(gh, key, hash);
+		if (index != UINT_MAX) {
+			if (keyfreefp) {
+				keyfreefp(gh->fl_keys[index]);
+			}
+			if (valfreefp) {
+				valfreefp(gh->fl_vals[index]);
+			}
+			gh->fl_keys[index] = key;
+			gh->fl_vals[index] = val;
+			return false;
+		}
+		ghash_flat_expand(gh, ++gh->nentries);
+		ghash_flat_insert_no_grow(gh, hash, key, val);
+		return true;
+	}
 	return ghash_insert_safe(gh, key, val, true, keyfreefp, valfreefp);
 }
 
@@ -773,9 +1036,15 @@ bool BLI_ghash_reinsert(GHash *gh, void *key, void *val, GHashKeyFreeFP keyfreef
  */
 void *BLI_ghash_lookup(GHash *gh, const void *key)
 {
-	GHashEntry *e = (GHashEntry *)ghash_lookup_entry(gh, key);
 	BLI_assert(!(gh->flag & GHASH_FLAG_IS_GSET));
-	return e ? e->val : NULL;
+	if (ghash_is_flat(gh)) {
+		const unsigned int index = ghash_flat_lookup_index(gh, key, ghash_flat_keyhash(gh, key));
+		return (index != UINT_MAX) ? gh->fl_vals[index] : NULL;
+	}
+	{
+		GHashEntry *e = (GHashEntry *)ghash_lookup_entry(gh, key);
+		return e ? e->val : NULL;
+	}
 }
 
 /**
@@ -783,9 +1052,15 @@ void *BLI_ghash_lookup(GHash *gh, const void *key)
  */
 void *BLI_ghash_lookup_default(GHash *gh, const void *key, void *val_default)
 {
-	GHashEntry *e = (GHashEntry *)ghash_lookup_entry(gh, key);
 	BLI_assert(!(gh->flag & GHASH_FLAG_IS_GSET));
-	return e ? e->val : val_default;
+	if (ghash_is_flat(gh)) {
+		const unsigned int index = ghash_flat_lookup_index(gh, key, ghash_flat_keyhash(gh, key));
+		return (index != UINT_MAX) ? gh->fl_vals[index] : val_default;
+	}
+	{
+		GHashEntry *e = (GHashEntry *)ghash_lookup_entry(gh, key);
+		return e ? e->val : val_default;
+	}
 }
 
 /**
@@ -800,9 +1075,17 @@ void *BLI_ghash_lookup_default(GHash *gh, const void *key, void *val_default)
  */
 void **BLI_ghash_lookup_p(GHash *gh, const void *key)
 {
-	GHashEntry *e = (GHashEntry *)ghash_lookup_entry(gh, key);
 	BLI_assert(!(gh->flag & GHASH_FLAG_IS_GSET));
-	return e ? &e->val : NULL;
+	if (ghash_is_flat(gh)) {
+		/* Note: for flat storage the returned pointer is only valid until
+		 * the next insertion or removal! */
+		const unsigned int index = ghash_flat_lookup_index(gh, key, ghash_flat_keyhash(gh, key));
+		return (index != UINT_MAX) ? &gh->fl_vals[index] : NULL;
+	}
+	{
+		GHashEntry *e = (GHashEntry *)ghash_lookup_entry(gh, key);
+		return e ? &e->val : NULL;
+	}
 }
 
 /**
@@ -821,6 +1104,23 @@ void **BLI_ghash_lookup_p(GHash *gh, const void *key)
  */
 bool BLI_ghash_ensure_p(GHash *gh, void *key, void ***r_val)
 {
+	if (ghash_is_flat(gh)) {
+		const unsigned int hash = ghash_flat_keyhash(gh, key);
+		unsigned int index = ghash_flat_lookup_index(gh, key, hash);
+		const bool haskey = (index != UINT_MAX);
+
+		if (!haskey) {
+			ghash_flat_expand(gh, ++gh->nentries);
+			ghash_flat_insert_no_grow(gh, hash, key, NULL);
+			index = ghash_flat_lookup_index(gh, key, hash);
+			BLI_assert(index != UINT_MAX);
+		}
+
+		/* Note: only valid until the next insertion or removal! */
+		*r_val = &gh->fl_vals[index];
+		return haskey;
+	}
+
 	const unsigned int hash = ghash_keyhash(gh, key);
 	const unsigned int bucket_index = ghash_bucket_index(gh, hash);
 	GHashEntry *e = (GHashEntry *)ghash_lookup_entry_ex(gh, key, bucket_index);
@@ -844,6 +1144,24 @@ bool BLI_ghash_ensure_p(GHash *gh, void *key, void ***r_val)
 bool BLI_ghash_ensure_p_ex(
         GHash *gh, const void *key, void ***r_key, void ***r_val)
 {
+	if (ghash_is_flat(gh)) {
+		const unsigned int hash = ghash_flat_keyhash(gh, key);
+		unsigned int index = ghash_flat_lookup_index(gh, key, hash);
+		const bool haskey = (index != UINT_MAX);
+
+		if (!haskey) {
+			ghash_flat_expand(gh, ++gh->nentries);
+			ghash_flat_insert_no_grow(gh, hash, (void *)key, NULL);
+			index = ghash_flat_lookup_index(gh, key, hash);
+			BLI_assert(index != UINT_MAX);
+		}
+
+		/* Note: only valid until the next insertion or removal! */
+		*r_key = &gh->fl_keys[index];
+		*r_val = &gh->fl_vals[index];
+		return haskey;
+	}
+
 	const unsigned int hash = ghash_keyhash(gh, key);
 	const unsigned int bucket_index = ghash_bucket_index(gh, hash);
 	GHashEntry *e = (GHashEntry *)ghash_lookup_entry_ex(gh, key, bucket_index);
@@ -871,6 +1189,21 @@ bool BLI_ghash_ensure_p_ex(
  */
 bool BLI_ghash_remove(GHash *gh, const void *key, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp)
 {
+	if (ghash_is_flat(gh)) {
+		const unsigned int index = ghash_flat_lookup_index(gh, key, ghash_flat_keyhash(gh, key));
+		if (index == UINT_MAX) {
+			return false;
+		}
+		if (keyfreefp) {
+			keyfreefp(gh->fl_keys[index]);
+		}
+		if (valfreefp) {
+			valfreefp(gh->fl_vals[index]);
+		}
+		ghash_flat_remove_index(gh, index);
+		return true;
+	}
+
 	const unsigned int hash = ghash_keyhash(gh, key);
 	const unsigned int bucket_index = ghash_bucket_index(gh, hash);
 	Entry *e = ghash_remove_ex(gh, key, keyfreefp, valfreefp, bucket_index);
@@ -894,6 +1227,20 @@ bool BLI_ghash_remove(GHash *gh, const void *key, GHashKeyFreeFP keyfreefp, GHas
  */
 void *BLI_ghash_popkey(GHash *gh, const void *key, GHashKeyFreeFP keyfreefp)
 {
+	if (ghash_is_flat(gh)) {
+		const unsigned int index = ghash_flat_lookup_index(gh, key, ghash_flat_keyhash(gh, key));
+		void *val;
+		if (index == UINT_MAX) {
+			return NULL;
+		}
+		if (keyfreefp) {
+			keyfreefp(gh->fl_keys[index]);
+		}
+		val = gh->fl_vals[index];
+		ghash_flat_remove_index(gh, index);
+		return val;
+	}
+
 	const unsigned int hash = ghash_keyhash(gh, key);
 	const unsigned int bucket_index = ghash_bucket_index(gh, hash);
 	GHashEntry *e = (GHashEntry *)ghash_remove_ex(gh, key, keyfreefp, NULL, bucket_index);
@@ -913,6 +1260,9 @@ void *BLI_ghash_popkey(GHash *gh, const void *key, GHashKeyFreeFP keyfreefp)
  */
 bool BLI_ghash_haskey(GHash *gh, const void *key)
 {
+	if (ghash_is_flat(gh)) {
+		return (ghash_flat_lookup_index(gh, key, ghash_flat_keyhash(gh, key)) != UINT_MAX);
+	}
 	return (ghash_lookup_entry(gh, key) != NULL);
 }
 
@@ -928,6 +1278,23 @@ bool BLI_ghash_pop(
         GHash *gh, GHashIterState *state,
         void **r_key, void **r_val)
 {
+	if (ghash_is_flat(gh)) {
+		unsigned int index = state->curr_bucket;
+		if (gh->nentries == 0) {
+			*r_key = *r_val = NULL;
+			return false;
+		}
+		while (gh->fl_hashes[index & gh->fl_mask] == 0) {
+			index++;
+		}
+		index &= gh->fl_mask;
+		*r_key = gh->fl_keys[index];
+		*r_val = gh->fl_vals[index];
+		ghash_flat_remove_index(gh, index);
+		state->curr_bucket = index;
+		return true;
+	}
+
 	GHashEntry *e = (GHashEntry *)ghash_pop(gh, state);
 
 	BLI_assert(!(gh->flag & GHASH_FLAG_IS_GSET));
@@ -955,6 +1322,13 @@ bool BLI_ghash_pop(
 void BLI_ghash_clear_ex(GHash *gh, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp,
                         const unsigned int nentries_reserve)
 {
+	if (ghash_is_flat(gh)) {
+		if (keyfreefp || valfreefp)
+			ghash_flat_free_cb(gh, keyfreefp, valfreefp);
+		ghash_flat_buckets_reset(gh, nentries_reserve);
+		return;
+	}
+
 	if (keyfreefp || valfreefp)
 		ghash_free_cb(gh, keyfreefp, valfreefp);
 
@@ -979,6 +1353,16 @@ void BLI_ghash_clear(GHash *gh, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfree
  */
 void BLI_ghash_free(GHash *gh, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp)
 {
+	if (ghash_is_flat(gh)) {
+		if (keyfreefp || valfreefp)
+			ghash_flat_free_cb(gh, keyfreefp, valfreefp);
+		MEM_freeN(gh->fl_hashes);
+		MEM_freeN(gh->fl_keys);
+		MEM_freeN(gh->fl_vals);
+		MEM_freeN(gh);
+		return;
+	}
+
 	BLI_assert((int)gh->nentries == BLI_mempool_count(gh->entrypool));
 	if (keyfreefp || valfreefp)
 		ghash_free_cb(gh, keyfreefp, valfreefp);
@@ -1038,6 +1422,8 @@ GHashIterator *BLI_ghashIterator_new(GHash *gh)
  */
 void BLI_ghashIterator_init(GHashIterator *ghi, GHash *gh)
 {
+	BLI_assert(!ghash_is_flat(gh));  /* Flat storage has no stable entries to iterate. */
+
 	ghi->gh = gh;
 	ghi->curEntry = NULL;
 	ghi->curBucket = UINT_MAX;  /* wraps to zero */
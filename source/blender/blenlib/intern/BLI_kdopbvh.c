@@ -58,6 +58,10 @@
 #include "BLI_strict_flags.h"
 #include "BLI_task.h"
 
+#ifdef __SSE2__
+#  include <xmmintrin.h>
+#endif
+
 /* used for iterative_raycast */
 // #define USE_SKIP_LINKS
 
@@ -1114,6 +1118,38 @@ void BLI_bvhtree_update_tree(BVHTree *tree)
 	for (; index >= root; index--)
 		node_join(tree, *index);
 }
+
+/**
+ * Refit the whole tree against updated coordinates, keeping its topology.
+ *
+ * Calls \a refit_cb for every leaf to get the new element points
+ * (at most 4, written into its \a r_co argument), then updates the
+ * internal nodes bottom-up. For deforming geometry this is much cheaper
+ * than rebuilding and re-balancing, at the cost of some bound quality.
+ */
+void BLI_bvhtree_refit(BVHTree *tree, BVHTree_RefitCallback refit_cb, void *userdata)
+{
+	int i;
+
+	for (i = 0; i < tree->totleaf; i++) {
+		BVHNode *node = &tree->nodearray[i];
+		float co[4][3];
+		const int numpoints = refit_cb(userdata, node->index, co);
+		axis_t axis_iter;
+
+		BLI_assert(numpoints > 0 && numpoints <= 4);
+
+		create_kdop_hull(tree, node, (const float *)co, numpoints, 0);
+
+		/* inflate the bv with some epsilon */
+		for (axis_iter = tree->start_axis; axis_iter < tree->stop_axis; axis_iter++) {
+			node->bv[(2 * axis_iter)]     -= tree->epsilon; /* minimum */
+			node->bv[(2 * axis_iter) + 1] += tree->epsilon; /* maximum */
+		}
+	}
+
+	BLI_bvhtree_update_tree(tree);
+}
 /**
  * Number of times #BLI_bvhtree_insert has been called.
  * mainly useful for asserts functions to check we added the correct number.
@@ -1144,7 +1180,30 @@ static bool tree_overlap_test(const BVHNode *node1, const BVHNode *node2, axis_t
 	const float *bv1     = node1->bv + (start_axis << 1);
 	const float *bv2     = node2->bv + (start_axis << 1);
 	const float *bv1_end = node1->bv + (stop_axis  << 1);
-	
+
+#ifdef __SSE2__
+	/* Branch-free SIMD path for the common plain-AABB case (3 min/max axes,
+	 * i.e. 6 contiguous floats per node), which covers all collision and
+	 * cloth usages. Tests all 3 axes at once. */
+	if (LIKELY(start_axis == 0 && stop_axis == 3)) {
+		/* bv layout is min0, max0, min1, max1, min2, max2. */
+		const __m128 a_lo = _mm_loadu_ps(bv1);      /* min0 max0 min1 max1 */
+		const __m128 a_hi = _mm_loadu_ps(bv1 + 2);  /* min1 max1 min2 max2 */
+		const __m128 b_lo = _mm_loadu_ps(bv2);
+		const __m128 b_hi = _mm_loadu_ps(bv2 + 2);
+
+		const __m128 a_min = _mm_shuffle_ps(a_lo, a_hi, _MM_SHUFFLE(2, 2, 2, 0));
+		const __m128 a_max = _mm_shuffle_ps(a_lo, a_hi, _MM_SHUFFLE(3, 3, 3, 1));
+		const __m128 b_min = _mm_shuffle_ps(b_lo, b_hi, _MM_SHUFFLE(2, 2, 2, 0));
+		const __m128 b_max = _mm_shuffle_ps(b_lo, b_hi, _MM_SHUFFLE(3, 3, 3, 1));
+
+		const __m128 separated = _mm_or_ps(_mm_cmpgt_ps(a_min, b_max),
+		                                   _mm_cmpgt_ps(b_min, a_max));
+
+		return (_mm_movemask_ps(separated) & 7) == 0;
+	}
+#endif  /* __SSE2__ */
+
 	/* test all axis if min + max overlap */
 	for (; bv1 != bv1_end; bv1 += 2, bv2 += 2) {
 		if ((bv1[0] > bv2[1]) || (bv2[0] > bv1[1])) {
@@ -1816,6 +1875,55 @@ int BLI_bvhtree_ray_cast(
 	return BLI_bvhtree_ray_cast_ex(tree, co, dir, radius, hit, callback, userdata, BVH_RAYCAST_DEFAULT);
 }
 
+/**
+ * Cast a batch of rays at once.
+ *
+ * Rays are traversed grouped by direction octant, so consecutive rays tend to
+ * walk the same branches of the tree and traversal stays cache-hot, which is
+ * a substantial win when casting many (mostly coherent) rays as collision and
+ * shrinkwrap do.
+ *
+ * Every entry of \a hits must be initialized like the \a hit argument of
+ * #BLI_bvhtree_ray_cast (index -1, dist set to the maximum wanted distance).
+ */
+void BLI_bvhtree_ray_cast_batch(
+        BVHTree *tree, const float (*ray_start)[3], const float (*ray_dir)[3], int ray_tot,
+        float radius, BVHTreeRayHit *hits,
+        BVHTree_RayCastCallback callback, void *userdata)
+{
+	int *order = MEM_mallocN(sizeof(int) * (size_t)ray_tot, __func__);
+	int bucket_tot[8] = {0};
+	int bucket_start[8];
+	int i, j;
+
+	/* Counting sort of ray indices on the 3 sign bits of the direction. */
+	for (i = 0; i < ray_tot; i++) {
+		const int octant = ((ray_dir[i][0] < 0.0f) ? 1 : 0) |
+		                   ((ray_dir[i][1] < 0.0f) ? 2 : 0) |
+		                   ((ray_dir[i][2] < 0.0f) ? 4 : 0);
+		bucket_tot[octant]++;
+	}
+	for (j = 0, i = 0; j < 8; j++) {
+		bucket_start[j] = i;
+		i += bucket_tot[j];
+	}
+	for (i = 0; i < ray_tot; i++) {
+		const int octant = ((ray_dir[i][0] < 0.0f) ? 1 : 0) |
+		                   ((ray_dir[i][1] < 0.0f) ? 2 : 0) |
+		                   ((ray_dir[i][2] < 0.0f) ? 4 : 0);
+		order[bucket_start[octant]++] = i;
+	}
+
+	for (i = 0; i < ray_tot; i++) {
+		const int ray_index = order[i];
+		BLI_bvhtree_ray_cast(
+		        tree, ray_start[ray_index], ray_dir[ray_index], radius,
+		        &hits[ray_index], callback, userdata);
+	}
+
+	MEM_freeN(order);
+}
+
 float BLI_bvhtree_bb_raycast(const float bv[6], const float light_start[3], const float light_end[3], float pos[3])
 {
 	BVHRayCastData data;
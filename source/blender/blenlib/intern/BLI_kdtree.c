@@ -29,6 +29,7 @@
 
 #include "BLI_math.h"
 #include "BLI_kdtree.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "BLI_strict_flags.h"
 
@@ -61,6 +62,10 @@ struct KDTree {
 
 #define KD_NODE_UNSET ((unsigned int)-1)
 
+/* Smallest subtree that is still handed over to a task of its own when
+ * balancing in parallel, below this recursion stays serial. */
+#define KD_PARALLEL_LEAF_THRESHOLD 1024
+
 /**
  * Creates or free a kdtree
  */
@@ -113,17 +118,15 @@ void BLI_kdtree_insert(KDTree *tree, int index, const float co[3])
 #endif
 }
 
-static unsigned int kdtree_balance(KDTreeNode *nodes, unsigned int totnode, unsigned int axis, const unsigned int ofs)
+/**
+ * Partition \a nodes around their median along \a axis (quicksort style),
+ * and initialize the median node. Shared by the serial and parallel build.
+ */
+static unsigned int kdtree_balance_median(KDTreeNode *nodes, unsigned int totnode, unsigned int axis)
 {
-	KDTreeNode *node;
 	float co;
 	unsigned int left, right, median, i, j;
 
-	if (totnode <= 0)
-		return KD_NODE_UNSET;
-	else if (totnode == 1)
-		return 0 + ofs;
-	
 	/* quicksort style sorting around median */
 	left = 0;
 	right = totnode - 1;
@@ -151,9 +154,25 @@ static unsigned int kdtree_balance(KDTreeNode *nodes, unsigned int totnode, unsi
 			left = i + 1;
 	}
 
+	nodes[median].d = axis;
+
+	return median;
+}
+
+static unsigned int kdtree_balance(KDTreeNode *nodes, unsigned int totnode, unsigned int axis, const unsigned int ofs)
+{
+	KDTreeNode *node;
+	unsigned int median;
+
+	if (totnode <= 0)
+		return KD_NODE_UNSET;
+	else if (totnode == 1)
+		return 0 + ofs;
+
+	median = kdtree_balance_median(nodes, totnode, axis);
+
 	/* set node and sort subnodes */
 	node = &nodes[median];
-	node->d = axis;
 	axis = (axis + 1) % 3;
 	node->left = kdtree_balance(nodes, median, axis, ofs);
 	node->right = kdtree_balance(nodes + median + 1, (totnode - (median + 1)), axis, (median + 1) + ofs);
@@ -161,15 +180,124 @@ static unsigned int kdtree_balance(KDTreeNode *nodes, unsigned int totnode, unsi
 	return median + ofs;
 }
 
+/* Parallel balancing: every subtree above the leaf threshold becomes a task
+ * of its own. Tasks only touch their disjoint sub-range of the nodes array,
+ * and write the resulting subtree root through r_index (which lives in the
+ * parent node, set before the children tasks are pushed). */
+typedef struct KDTreeBalanceTask {
+	KDTreeNode *nodes;
+	unsigned int totnode;
+	unsigned int axis;
+	unsigned int ofs;
+	unsigned int *r_index;
+} KDTreeBalanceTask;
+
+static void kdtree_balance_push_task(
+        TaskPool *pool, KDTreeNode *nodes, unsigned int totnode, unsigned int axis, unsigned int ofs,
+        unsigned int *r_index, int thread_id);
+
+static void kdtree_balance_task_run(TaskPool *pool, void *taskdata, int thread_id)
+{
+	KDTreeBalanceTask *task = taskdata;
+	KDTreeNode *nodes = task->nodes;
+	const unsigned int totnode = task->totnode;
+	unsigned int axis = task->axis;
+	KDTreeNode *node;
+	unsigned int median;
+
+	if (totnode < KD_PARALLEL_LEAF_THRESHOLD) {
+		*task->r_index = kdtree_balance(nodes, totnode, axis, task->ofs);
+		return;
+	}
+
+	median = kdtree_balance_median(nodes, totnode, axis);
+
+	node = &nodes[median];
+	*task->r_index = median + task->ofs;
+	axis = (axis + 1) % 3;
+
+	kdtree_balance_push_task(pool, nodes, median, axis, task->ofs,
+	                         &node->left, thread_id);
+	kdtree_balance_push_task(pool, nodes + median + 1, totnode - (median + 1), axis,
+	                         (median + 1) + task->ofs, &node->right, thread_id);
+}
+
+static void kdtree_balance_push_task(
+        TaskPool *pool, KDTreeNode *nodes, unsigned int totnode, unsigned int axis, unsigned int ofs,
+        unsigned int *r_index, int thread_id)
+{
+	KDTreeBalanceTask *task;
+
+	if (totnode <= 1) {
+		*r_index = (totnode == 1) ? ofs : KD_NODE_UNSET;
+		return;
+	}
+
+	task = MEM_mallocN(sizeof(*task), __func__);
+	task->nodes = nodes;
+	task->totnode = totnode;
+	task->axis = axis;
+	task->ofs = ofs;
+	task->r_index = r_index;
+
+	BLI_task_pool_push_from_thread(pool, kdtree_balance_task_run, task, true,
+	                               TASK_PRIORITY_HIGH, thread_id);
+}
+
 void BLI_kdtree_balance(KDTree *tree)
 {
-	tree->root = kdtree_balance(tree->nodes, tree->totnode, 0, 0);
+	if (tree->totnode < KD_PARALLEL_LEAF_THRESHOLD * 2) {
+		tree->root = kdtree_balance(tree->nodes, tree->totnode, 0, 0);
+	}
+	else {
+		TaskScheduler *task_scheduler = BLI_task_scheduler_get();
+		TaskPool *task_pool = BLI_task_pool_create(task_scheduler, NULL);
+
+		kdtree_balance_push_task(task_pool, tree->nodes, tree->totnode, 0, 0, &tree->root, 0);
+
+		BLI_task_pool_work_and_wait(task_pool);
+		BLI_task_pool_free(task_pool);
+	}
 
 #ifdef DEBUG
 	tree->is_balanced = true;
 #endif
 }
 
+typedef struct KDTreeNearestBatchData {
+	const KDTree *tree;
+	const float (*co_array)[3];
+	KDTreeNearest *r_nearest;
+} KDTreeNearestBatchData;
+
+static void kdtree_find_nearest_batch_cb(void *userdata, const int i)
+{
+	KDTreeNearestBatchData *data = userdata;
+	if (BLI_kdtree_find_nearest(data->tree, data->co_array[i], &data->r_nearest[i]) == -1) {
+		data->r_nearest[i].index = -1;
+	}
+}
+
+/**
+ * Answer nearest-point queries for many query points at once, in parallel.
+ *
+ * \param r_nearest  An array sized \a co_tot, entries of query points with no
+ * result get their index set to -1.
+ */
+void BLI_kdtree_find_nearest_batch(
+        const KDTree *tree, const float (*co_array)[3], unsigned int co_tot,
+        KDTreeNearest *r_nearest)
+{
+	KDTreeNearestBatchData data = {tree, co_array, r_nearest};
+
+#ifdef DEBUG
+	BLI_assert(tree->is_balanced == true);
+#endif
+
+	BLI_task_parallel_range(0, (int)co_tot, &data, kdtree_find_nearest_batch_cb,
+	                        co_tot > 512);
+}
+
 static float squared_distance(const float v2[3], const float v1[3], const float n2[3])
 {
 	float d[3], dist;
@@ -56,6 +56,9 @@ struct MemArena {
 	unsigned char *curbuf;
 	const char *name;
 	LinkNode *bufs;
+	/* retired buffers kept for re-use (see #BLI_memarena_clear), so arenas
+	 * which are cleared every iteration stop calling malloc altogether */
+	LinkNode *bufs_reuse;
 
 	size_t bufsize, cursize;
 	size_t align;
@@ -96,6 +99,7 @@ void BLI_memarena_use_align(struct MemArena *ma, const size_t align)
 void BLI_memarena_free(MemArena *ma)
 {
 	BLI_linklist_freeN(ma->bufs);
+	BLI_linklist_freeN(ma->bufs_reuse);
 
 #ifdef WITH_MEM_VALGRIND
 	VALGRIND_DESTROY_MEMPOOL(ma);
@@ -133,8 +137,28 @@ void *BLI_memarena_alloc(MemArena *ma, size_t size)
 			ma->cursize = ma->bufsize;
 		}
 
-		ma->curbuf = (ma->use_calloc ? MEM_callocN : MEM_mallocN)(ma->cursize, ma->name);
-		BLI_linklist_prepend(&ma->bufs, ma->curbuf);
+		/* try to recycle a retired buffer before hitting the allocator,
+		 * first fit so oversized blocks get re-used too */
+		ma->curbuf = NULL;
+		for (LinkNode **node_p = &ma->bufs_reuse; *node_p; node_p = &(*node_p)->next) {
+			if (MEM_allocN_len((*node_p)->link) >= ma->cursize) {
+				LinkNode *node = *node_p;
+				*node_p = node->next;
+				ma->curbuf = node->link;
+				ma->cursize = MEM_allocN_len(node->link);
+				node->next = ma->bufs;
+				ma->bufs = node;
+				if (ma->use_calloc) {
+					memset(ma->curbuf, 0, ma->cursize);
+				}
+				break;
+			}
+		}
+
+		if (ma->curbuf == NULL) {
+			ma->curbuf = (ma->use_calloc ? MEM_callocN : MEM_mallocN)(ma->cursize, ma->name);
+			BLI_linklist_prepend(&ma->bufs, ma->curbuf);
+		}
 		memarena_curbuf_align(ma);
 	}
 
@@ -173,8 +197,16 @@ void BLI_memarena_clear(MemArena *ma)
 		size_t curbuf_used;
 
 		if (ma->bufs->next) {
-			BLI_linklist_freeN(ma->bufs->next);
+			/* keep the extra buffers around for re-use instead of freeing,
+			 * clearing is precisely what per-element arena usages do a lot */
+			LinkNode *node = ma->bufs->next;
 			ma->bufs->next = NULL;
+			while (node) {
+				LinkNode *node_next = node->next;
+				node->next = ma->bufs_reuse;
+				ma->bufs_reuse = node;
+				node = node_next;
+			}
 		}
 
 		curbuf_prev = ma->curbuf;
@@ -196,3 +228,38 @@ void BLI_memarena_clear(MemArena *ma)
 #endif
 
 }
+
+/**
+ * Take a snapshot of the arena state, allocations made afterwards can be
+ * thrown away again with #BLI_memarena_rewind. Snapshots may be nested as
+ * long as they are rewound innermost first.
+ */
+void BLI_memarena_snapshot(MemArena *ma, MemArenaSnapshot *snapshot)
+{
+	snapshot->bufs = ma->bufs;
+	snapshot->curbuf = ma->curbuf;
+	snapshot->cursize = ma->cursize;
+}
+
+/**
+ * Give back all memory allocated since \a snapshot was taken,
+ * retiring whole buffers into the re-use list.
+ */
+void BLI_memarena_rewind(MemArena *ma, const MemArenaSnapshot *snapshot)
+{
+	while (ma->bufs != snapshot->bufs) {
+		LinkNode *node = ma->bufs;
+		BLI_assert(node != NULL);
+		ma->bufs = node->next;
+		node->next = ma->bufs_reuse;
+		ma->bufs_reuse = node;
+	}
+
+	ma->curbuf = snapshot->curbuf;
+	ma->cursize = snapshot->cursize;
+
+	if (ma->use_calloc && ma->curbuf) {
+		/* anything handed out since the snapshot must read as zeroed again */
+		memset(ma->curbuf, 0, ma->cursize);
+	}
+}
@@ -44,9 +44,12 @@
 #include "BLI_utildefines.h"
 
 #include "BLI_mempool.h" /* own include */
+#include "BLI_threads.h"
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_strict_flags.h"  /* keep last */
 
 #ifdef WITH_MEM_VALGRIND
@@ -79,6 +82,12 @@
 static bool mempool_debug_memset = false;
 #endif
 
+/* Sizing of the per-thread magazines for BLI_MEMPOOL_THREADSAFE pools.
+ * Threads map onto magazine slots by hashing their pthread id; slots have
+ * their own spin lock, so two threads only contend when they collide. */
+#define MEMPOOL_NUM_MAGAZINES 64  /* must be a power of two */
+#define MEMPOOL_MAGAZINE_SIZE 64
+
 /**
  * A free element from #BLI_mempool_chunk. Data is cast to this type and stored in
  * #BLI_mempool.free as a single linked list, each item #BLI_mempool.esize large.
@@ -101,6 +110,15 @@ typedef struct BLI_mempool_chunk {
 #endif
 } BLI_mempool_chunk;
 
+/**
+ * Per-thread cache of free elements for #BLI_MEMPOOL_THREADSAFE pools.
+ */
+typedef struct BLI_mempool_magazine {
+	SpinLock lock;
+	BLI_freenode *free;
+	unsigned int count;
+} BLI_mempool_magazine;
+
 /**
  * The mempool, stores and tracks memory \a chunks and elements within those chunks \a free.
  */
@@ -119,6 +137,10 @@ struct BLI_mempool {
 	BLI_freenode *free;         /* free element list. Interleaved into chunk datas. */
 	unsigned int maxchunks;     /* use to know how many chunks to keep for BLI_mempool_clear */
 	unsigned int totused;       /* number of elements currently in use */
+
+	/* BLI_MEMPOOL_THREADSAFE only */
+	SpinLock lock;              /* guards 'free' and chunk management */
+	BLI_mempool_magazine *magazines;
 #ifdef USE_TOTALLOC
 	unsigned int totalloc;          /* number of elements allocated in total */
 #endif
@@ -318,6 +340,18 @@ BLI_mempool *BLI_mempool_create(unsigned int esize, unsigned int totelem,
 #endif
 	pool->totused = 0;
 
+	if (flag & BLI_MEMPOOL_THREADSAFE) {
+		BLI_spin_init(&pool->lock);
+		pool->magazines = MEM_callocN(sizeof(*pool->magazines) * MEMPOOL_NUM_MAGAZINES,
+		                              "BLI_mempool magazines");
+		for (i = 0; i < MEMPOOL_NUM_MAGAZINES; i++) {
+			BLI_spin_init(&pool->magazines[i].lock);
+		}
+	}
+	else {
+		pool->magazines = NULL;
+	}
+
 	if (totelem) {
 		/* allocate the actual chunks */
 		for (i = 0; i < maxchunks; i++) {
@@ -333,10 +367,129 @@ BLI_mempool *BLI_mempool_create(unsigned int esize, unsigned int totelem,
 	return pool;
 }
 
+/**
+ * The magazine of the calling thread (BLI_MEMPOOL_THREADSAFE pools only).
+ */
+BLI_INLINE BLI_mempool_magazine *mempool_magazine_get(BLI_mempool *pool)
+{
+	/* Cheap pthread id hash, ids are usually pointers or small handles. */
+	const size_t tid = (size_t)pthread_self();
+	return &pool->magazines[(tid ^ (tid >> 8)) & (MEMPOOL_NUM_MAGAZINES - 1)];
+}
+
+static void *mempool_alloc_threadsafe(BLI_mempool *pool)
+{
+	BLI_mempool_magazine *mag = mempool_magazine_get(pool);
+	BLI_freenode *free_pop;
+
+	BLI_spin_lock(&mag->lock);
+	if (UNLIKELY(mag->free == NULL)) {
+		/* Refill half a magazine from the shared free list. */
+		unsigned int n = MEMPOOL_MAGAZINE_SIZE / 2;
+
+		BLI_spin_lock(&pool->lock);
+		while (n--) {
+			BLI_freenode *node;
+			if (UNLIKELY(pool->free == NULL)) {
+				BLI_mempool_chunk *mpchunk = mempool_chunk_alloc(pool);
+				mempool_chunk_add(pool, mpchunk, NULL);
+			}
+			node = pool->free;
+			pool->free = node->next;
+			node->next = mag->free;
+			mag->free = node;
+			mag->count++;
+		}
+		BLI_spin_unlock(&pool->lock);
+	}
+
+	free_pop = mag->free;
+	mag->free = free_pop->next;
+	mag->count--;
+	BLI_spin_unlock(&mag->lock);
+
+	if (pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
+		free_pop->freeword = USEDWORD;
+	}
+
+	atomic_add_u(&pool->totused, 1);
+
+#ifdef WITH_MEM_VALGRIND
+	VALGRIND_MEMPOOL_ALLOC(pool, free_pop, pool->esize);
+#endif
+
+	return (void *)free_pop;
+}
+
+static void mempool_free_threadsafe(BLI_mempool *pool, void *addr)
+{
+	BLI_mempool_magazine *mag = mempool_magazine_get(pool);
+	BLI_freenode *newhead = addr;
+
+	if (pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
+#ifndef NDEBUG
+		/* this will detect double free's */
+		BLI_assert(newhead->freeword != FREEWORD);
+#endif
+		newhead->freeword = FREEWORD;
+	}
+
+	BLI_spin_lock(&mag->lock);
+	newhead->next = mag->free;
+	mag->free = newhead;
+	mag->count++;
+
+	if (UNLIKELY(mag->count > MEMPOOL_MAGAZINE_SIZE)) {
+		/* Flush half a magazine back to the shared free list. */
+		unsigned int n = MEMPOOL_MAGAZINE_SIZE / 2;
+
+		BLI_spin_lock(&pool->lock);
+		while (n--) {
+			BLI_freenode *node = mag->free;
+			mag->free = node->next;
+			node->next = pool->free;
+			pool->free = node;
+			mag->count--;
+		}
+		BLI_spin_unlock(&pool->lock);
+	}
+	BLI_spin_unlock(&mag->lock);
+
+	atomic_sub_u(&pool->totused, 1);
+
+#ifdef WITH_MEM_VALGRIND
+	VALGRIND_MEMPOOL_FREE(pool, addr);
+#endif
+}
+
+/**
+ * Give back all magazine-cached elements to the shared free list.
+ * Callers must ensure no other thread uses the pool meanwhile.
+ */
+static void mempool_magazines_drain(BLI_mempool *pool)
+{
+	unsigned int i;
+
+	for (i = 0; i < MEMPOOL_NUM_MAGAZINES; i++) {
+		BLI_mempool_magazine *mag = &pool->magazines[i];
+		while (mag->free) {
+			BLI_freenode *node = mag->free;
+			mag->free = node->next;
+			node->next = pool->free;
+			pool->free = node;
+		}
+		mag->count = 0;
+	}
+}
+
 void *BLI_mempool_alloc(BLI_mempool *pool)
 {
 	BLI_freenode *free_pop;
 
+	if (pool->flag & BLI_MEMPOOL_THREADSAFE) {
+		return mempool_alloc_threadsafe(pool);
+	}
+
 	if (UNLIKELY(pool->free == NULL)) {
 		/* need to allocate a new chunk */
 		BLI_mempool_chunk *mpchunk = mempool_chunk_alloc(pool);
@@ -377,6 +530,11 @@ void BLI_mempool_free(BLI_mempool *pool, void *addr)
 {
 	BLI_freenode *newhead = addr;
 
+	if (pool->flag & BLI_MEMPOOL_THREADSAFE) {
+		mempool_free_threadsafe(pool, addr);
+		return;
+	}
+
 #ifndef NDEBUG
 	{
 		BLI_mempool_chunk *chunk;
@@ -609,6 +767,50 @@ void *BLI_mempool_iterstep(BLI_mempool_iter *iter)
 
 #endif
 
+static int mempool_chunk_cmp_ptr(const void *a, const void *b)
+{
+	const BLI_mempool_chunk *chunk_a = *(const BLI_mempool_chunk **)a;
+	const BLI_mempool_chunk *chunk_b = *(const BLI_mempool_chunk **)b;
+	if (chunk_a > chunk_b) return 1;
+	if (chunk_a < chunk_b) return -1;
+	return 0;
+}
+
+/**
+ * Re-link the chunk list in increasing address order, so iterating the pool
+ * walks memory (mostly) linearly, which the hardware prefetcher likes.
+ * Useful after heavy alloc/free churn shuffled the chunk order; safe at any
+ * point since the free list references elements directly.
+ */
+void BLI_mempool_chunks_sort(BLI_mempool *pool)
+{
+	BLI_mempool_chunk **table, *mpchunk;
+	unsigned int tot = 0, i;
+
+	for (mpchunk = pool->chunks; mpchunk; mpchunk = mpchunk->next) {
+		tot++;
+	}
+	if (tot < 2) {
+		return;
+	}
+
+	table = MEM_mallocN(sizeof(*table) * tot, __func__);
+	for (mpchunk = pool->chunks, i = 0; mpchunk; mpchunk = mpchunk->next) {
+		table[i++] = mpchunk;
+	}
+
+	qsort(table, tot, sizeof(*table), mempool_chunk_cmp_ptr);
+
+	for (i = 0; i + 1 < tot; i++) {
+		table[i]->next = table[i + 1];
+	}
+	table[tot - 1]->next = NULL;
+	pool->chunks = table[0];
+	pool->chunk_tail = table[tot - 1];
+
+	MEM_freeN(table);
+}
+
 /**
  * Empty the pool, as if it were just created.
  *
@@ -629,6 +831,10 @@ void BLI_mempool_clear_ex(BLI_mempool *pool, const int totelem_reserve)
 	VALGRIND_CREATE_MEMPOOL(pool, 0, false);
 #endif
 
+	if (pool->magazines) {
+		mempool_magazines_drain(pool);
+	}
+
 	if (totelem_reserve == -1) {
 		maxchunks = pool->maxchunks;
 	}
@@ -680,6 +886,15 @@ void BLI_mempool_clear(BLI_mempool *pool)
  */
 void BLI_mempool_destroy(BLI_mempool *pool)
 {
+	if (pool->magazines) {
+		unsigned int i;
+		for (i = 0; i < MEMPOOL_NUM_MAGAZINES; i++) {
+			BLI_spin_end(&pool->magazines[i].lock);
+		}
+		MEM_freeN(pool->magazines);
+		BLI_spin_end(&pool->lock);
+	}
+
 	mempool_chunk_free_all(pool->chunks);
 
 #ifdef WITH_MEM_VALGRIND
@@ -41,6 +41,9 @@
 
 #include "BLI_utildefines.h"
 #include "BLI_gsqueue.h"
+
+#include "atomic_ops.h"
+
 #include "BLI_strict_flags.h"
 
 typedef struct _GSQueueElem GSQueueElem;
@@ -186,3 +189,170 @@ void BLI_gsqueue_free(GSQueue *gq)
 	}
 	MEM_freeN(gq);
 }
+
+
+/* -------------------------------------------------------------------- */
+
+/* Bounded lock-free MPMC queue.
+ *
+ * Array based queue where every cell carries a sequence number, producers
+ * and consumers claim a cell by CAS'ing the respective position counter and
+ * publish it by bumping the cell sequence (a cell is ready for pop when its
+ * sequence is one past the position it was pushed at). No mutex, so many
+ * short-lived producers/consumers don't serialize on a single lock the way
+ * #GSQueue users must.
+ *
+ * Unlike #GSQueue this variant is fixed capacity and never allocates after
+ * creation: push fails on a full queue, pop fails on an empty one, which is
+ * what job pipelines want anyway (back-pressure instead of unbounded growth).
+ */
+
+struct _GSQueueMPMC {
+	uint32_t enqueue_pos;
+	uint32_t dequeue_pos;
+	/* per cell sequence numbers */
+	uint32_t *seq;
+	char *data;
+	uint32_t size_mask;
+	size_t elem_size;
+};
+
+/* full barrier read (CAS only writes when the value is already 0) */
+BLI_INLINE uint32_t gsqueue_mpmc_read(uint32_t *p)
+{
+	return atomic_cas_uint32(p, 0, 0);
+}
+
+/**
+ * Create a bounded lock-free queue.
+ *
+ * \param elem_size: The size of the structures in the queue.
+ * \param tot_elem: Capacity, rounded up to the next power of two (min 2).
+ */
+GSQueueMPMC *BLI_gsqueue_mpmc_new(size_t elem_size, unsigned int tot_elem)
+{
+	GSQueueMPMC *gq = MEM_mallocN(sizeof(*gq), "gqueue_mpmc_new");
+	uint32_t size = 2;
+	uint32_t i;
+
+	while (size < tot_elem) {
+		size *= 2;
+	}
+
+	gq->enqueue_pos = 0;
+	gq->dequeue_pos = 0;
+	gq->size_mask = size - 1;
+	gq->elem_size = elem_size;
+	gq->seq = MEM_mallocN(sizeof(*gq->seq) * (size_t)size, "gqueue_mpmc_seq");
+	gq->data = MEM_mallocN(elem_size * (size_t)size, "gqueue_mpmc_data");
+
+	for (i = 0; i < size; i++) {
+		gq->seq[i] = i;
+	}
+
+	return gq;
+}
+
+/**
+ * Append an element at the tail of the queue.
+ *
+ * Safe to call from multiple threads concurrently (with pop too).
+ *
+ * \return false when the queue is full.
+ */
+bool BLI_gsqueue_mpmc_push(GSQueueMPMC *gq, const void *item)
+{
+	uint32_t pos = gsqueue_mpmc_read(&gq->enqueue_pos);
+
+	while (true) {
+		const uint32_t idx = pos & gq->size_mask;
+		const uint32_t seq = gsqueue_mpmc_read(&gq->seq[idx]);
+		const int32_t dif = (int32_t)(seq - pos);
+
+		if (dif == 0) {
+			/* cell is free, try to claim it */
+			const uint32_t pos_prev = atomic_cas_uint32(&gq->enqueue_pos, pos, pos + 1);
+			if (pos_prev == pos) {
+				break;
+			}
+			pos = pos_prev;
+		}
+		else if (dif < 0) {
+			/* cell still holds an element a lap behind: queue is full */
+			return false;
+		}
+		else {
+			/* another producer claimed this position, re-read */
+			pos = gsqueue_mpmc_read(&gq->enqueue_pos);
+		}
+	}
+
+	memcpy(gq->data + (size_t)(pos & gq->size_mask) * gq->elem_size, item, gq->elem_size);
+	/* publish: seq == pos here, consumers wait for pos + 1 (the add is a full barrier) */
+	atomic_add_uint32(&gq->seq[pos & gq->size_mask], 1);
+
+	return true;
+}
+
+/**
+ * Retrieve and remove the element at the head of the queue.
+ *
+ * Safe to call from multiple threads concurrently (with push too).
+ *
+ * \return false when the queue is empty.
+ */
+bool BLI_gsqueue_mpmc_pop(GSQueueMPMC *gq, void *r_item)
+{
+	uint32_t pos = gsqueue_mpmc_read(&gq->dequeue_pos);
+
+	while (true) {
+		const uint32_t idx = pos & gq->size_mask;
+		const uint32_t seq = gsqueue_mpmc_read(&gq->seq[idx]);
+		const int32_t dif = (int32_t)(seq - (pos + 1));
+
+		if (dif == 0) {
+			/* cell holds an element, try to claim it */
+			const uint32_t pos_prev = atomic_cas_uint32(&gq->dequeue_pos, pos, pos + 1);
+			if (pos_prev == pos) {
+				break;
+			}
+			pos = pos_prev;
+		}
+		else if (dif < 0) {
+			/* producer hasn't published this position yet: queue is empty */
+			return false;
+		}
+		else {
+			/* another consumer claimed this position, re-read */
+			pos = gsqueue_mpmc_read(&gq->dequeue_pos);
+		}
+	}
+
+	memcpy(r_item, gq->data + (size_t)(pos & gq->size_mask) * gq->elem_size, gq->elem_size);
+	/* mark the cell free for the next lap: seq == pos + 1 here,
+	 * producers wait for pos + capacity */
+	atomic_add_uint32(&gq->seq[pos & gq->size_mask], gq->size_mask);
+
+	return true;
+}
+
+/**
+ * Query if the queue is empty (only a snapshot when threads are pushing).
+ */
+bool BLI_gsqueue_mpmc_is_empty(GSQueueMPMC *gq)
+{
+	const uint32_t dequeue_pos = gsqueue_mpmc_read(&gq->dequeue_pos);
+	const uint32_t seq = gsqueue_mpmc_read(&gq->seq[dequeue_pos & gq->size_mask]);
+
+	return ((int32_t)(seq - (dequeue_pos + 1)) < 0);
+}
+
+/**
+ * Free the queue, any elements still in it are discarded.
+ */
+void BLI_gsqueue_mpmc_free(GSQueueMPMC *gq)
+{
+	MEM_freeN(gq->seq);
+	MEM_freeN(gq->data);
+	MEM_freeN(gq);
+}
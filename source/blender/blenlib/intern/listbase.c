@@ -684,6 +684,60 @@ void BLI_listbase_rotate_last(ListBase *lb, void *vlink)
 	((Link *)lb->last)->next = NULL;
 }
 
+/**
+ * Make \a fl a valid snapshot of \a lb, only re-building the array when the
+ * view is dirty or \a generation differs from the one it was built for.
+ *
+ * Callers without a change counter can simply pass an incrementing value to
+ * force a re-build, the array allocation is still re-used between calls.
+ */
+void BLI_listbase_frozen_ensure(ListBaseFrozen *fl, const ListBase *lb, unsigned int generation)
+{
+	Link *link;
+	unsigned int i;
+
+	if (fl->is_valid && (fl->generation == generation)) {
+		return;
+	}
+
+	fl->count = (unsigned int)BLI_listbase_count(lb);
+
+	if (fl->count > fl->count_alloc) {
+		if (fl->array) {
+			MEM_freeN(fl->array);
+		}
+		fl->count_alloc = fl->count;
+		fl->array = MEM_mallocN(sizeof(*fl->array) * (size_t)fl->count_alloc, __func__);
+	}
+
+	for (link = lb->first, i = 0; link; link = link->next, i++) {
+		fl->array[i] = link;
+	}
+	BLI_assert(i == fl->count);
+
+	fl->generation = generation;
+	fl->is_valid = true;
+}
+
+/**
+ * Force the next #BLI_listbase_frozen_ensure to re-build,
+ * for callers which detect list changes themselves.
+ */
+void BLI_listbase_frozen_tag_dirty(ListBaseFrozen *fl)
+{
+	fl->is_valid = false;
+}
+
+void BLI_listbase_frozen_clear(ListBaseFrozen *fl)
+{
+	if (fl->array) {
+		MEM_freeN(fl->array);
+	}
+	fl->array = NULL;
+	fl->count = fl->count_alloc = 0;
+	fl->is_valid = false;
+}
+
 /* create a generic list node containing link to provided data */
 LinkData *BLI_genericNodeN(void *data)
 {
@@ -0,0 +1,267 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/blenlib/intern/math_geom_batch.c
+ *  \ingroup bli
+ *
+ * Batched (4 wide) variants of hot geometry primitives from math_geom.c,
+ * for callers which test many triangles against a single ray or point.
+ *
+ * When SSE2 is available the batch runs in structure-of-arrays registers,
+ * otherwise a plain loop over the scalar functions is used so callers can
+ * batch unconditionally. Results match the scalar versions.
+ */
+
+#include "BLI_math.h"
+
+#include "BLI_strict_flags.h"
+
+#ifdef __SSE2__
+#  include <xmmintrin.h>
+
+/* (mask & a) | (~mask & b) */
+BLI_INLINE __m128 sse_select_ps(const __m128 mask, const __m128 a, const __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+/* gather one component of 4 vertices into a register */
+BLI_INLINE __m128 sse_gather_component(const float *v[4], const int i)
+{
+	return _mm_set_ps(v[3][i], v[2][i], v[1][i], v[0][i]);
+}
+
+BLI_INLINE __m128 sse_dot3(const __m128 ax, const __m128 ay, const __m128 az,
+                           const __m128 bx, const __m128 by, const __m128 bz)
+{
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+}
+
+#endif  /* __SSE2__ */
+
+/**
+ * Batched #closest_on_tri_to_point_v3: closest points on 4 triangles to one point.
+ *
+ * \param r: closest point per triangle.
+ * \param p: the query point.
+ * \param tri_a, tri_b, tri_c: per-triangle vertex coordinates.
+ */
+void closest_on_tri_to_point_v3_batch4(
+        float r[4][3], const float p[3],
+        const float *tri_a[4], const float *tri_b[4], const float *tri_c[4])
+{
+#ifdef __SSE2__
+	const __m128 zero = _mm_setzero_ps();
+	__m128 ax[3], bx[3], cx[3], px[3];
+	__m128 ab[3], ac[3], bc[3], ap[3], bp[3], cp[3];
+	__m128 d1, d2, d3, d4, d5, d6, va, vb, vc;
+	__m128 mask_a, mask_b, mask_c, mask_ab, mask_ac, mask_bc, done;
+	__m128 v, w, denom, rx[3];
+	int i;
+
+	for (i = 0; i < 3; i++) {
+		ax[i] = sse_gather_component(tri_a, i);
+		bx[i] = sse_gather_component(tri_b, i);
+		cx[i] = sse_gather_component(tri_c, i);
+		px[i] = _mm_set1_ps(p[i]);
+
+		ab[i] = _mm_sub_ps(bx[i], ax[i]);
+		ac[i] = _mm_sub_ps(cx[i], ax[i]);
+		bc[i] = _mm_sub_ps(cx[i], bx[i]);
+		ap[i] = _mm_sub_ps(px[i], ax[i]);
+		bp[i] = _mm_sub_ps(px[i], bx[i]);
+		cp[i] = _mm_sub_ps(px[i], cx[i]);
+	}
+
+	d1 = sse_dot3(ab[0], ab[1], ab[2], ap[0], ap[1], ap[2]);
+	d2 = sse_dot3(ac[0], ac[1], ac[2], ap[0], ap[1], ap[2]);
+	d3 = sse_dot3(ab[0], ab[1], ab[2], bp[0], bp[1], bp[2]);
+	d4 = sse_dot3(ac[0], ac[1], ac[2], bp[0], bp[1], bp[2]);
+	d5 = sse_dot3(ab[0], ab[1], ab[2], cp[0], cp[1], cp[2]);
+	d6 = sse_dot3(ac[0], ac[1], ac[2], cp[0], cp[1], cp[2]);
+
+	vc = _mm_sub_ps(_mm_mul_ps(d1, d4), _mm_mul_ps(d3, d2));
+	vb = _mm_sub_ps(_mm_mul_ps(d5, d2), _mm_mul_ps(d1, d6));
+	va = _mm_sub_ps(_mm_mul_ps(d3, d6), _mm_mul_ps(d5, d4));
+
+	/* region masks, same tests (and priority) as the scalar version */
+	mask_a  = _mm_and_ps(_mm_cmple_ps(d1, zero), _mm_cmple_ps(d2, zero));
+	done    = mask_a;
+
+	mask_b  = _mm_andnot_ps(done, _mm_and_ps(_mm_cmpge_ps(d3, zero), _mm_cmple_ps(d4, d3)));
+	done    = _mm_or_ps(done, mask_b);
+
+	mask_ab = _mm_andnot_ps(done, _mm_and_ps(_mm_cmple_ps(vc, zero),
+	                                         _mm_and_ps(_mm_cmpge_ps(d1, zero), _mm_cmple_ps(d3, zero))));
+	done    = _mm_or_ps(done, mask_ab);
+
+	mask_c  = _mm_andnot_ps(done, _mm_and_ps(_mm_cmpge_ps(d6, zero), _mm_cmple_ps(d5, d6)));
+	done    = _mm_or_ps(done, mask_c);
+
+	mask_ac = _mm_andnot_ps(done, _mm_and_ps(_mm_cmple_ps(vb, zero),
+	                                         _mm_and_ps(_mm_cmpge_ps(d2, zero), _mm_cmple_ps(d6, zero))));
+	done    = _mm_or_ps(done, mask_ac);
+
+	mask_bc = _mm_andnot_ps(done, _mm_and_ps(_mm_cmple_ps(va, zero),
+	                                         _mm_and_ps(_mm_cmpge_ps(_mm_sub_ps(d4, d3), zero),
+	                                                    _mm_cmpge_ps(_mm_sub_ps(d5, d6), zero))));
+	done    = _mm_or_ps(done, mask_bc);
+
+	/* interior: a + ab * v + ac * w (unselected lanes may divide by zero,
+	 * their results are fully masked out below) */
+	denom = _mm_div_ps(_mm_set1_ps(1.0f), _mm_add_ps(_mm_add_ps(va, vb), vc));
+	v = _mm_mul_ps(vb, denom);
+	w = _mm_mul_ps(vc, denom);
+	for (i = 0; i < 3; i++) {
+		rx[i] = _mm_add_ps(ax[i], _mm_add_ps(_mm_mul_ps(ab[i], v), _mm_mul_ps(ac[i], w)));
+	}
+
+	/* edge BC: b + bc * w */
+	w = _mm_div_ps(_mm_sub_ps(d4, d3),
+	               _mm_add_ps(_mm_sub_ps(d4, d3), _mm_sub_ps(d5, d6)));
+	for (i = 0; i < 3; i++) {
+		rx[i] = sse_select_ps(mask_bc, _mm_add_ps(bx[i], _mm_mul_ps(bc[i], w)), rx[i]);
+	}
+
+	/* edge AC: a + ac * w */
+	w = _mm_div_ps(d2, _mm_sub_ps(d2, d6));
+	for (i = 0; i < 3; i++) {
+		rx[i] = sse_select_ps(mask_ac, _mm_add_ps(ax[i], _mm_mul_ps(ac[i], w)), rx[i]);
+	}
+
+	/* edge AB: a + ab * v */
+	v = _mm_div_ps(d1, _mm_sub_ps(d1, d3));
+	for (i = 0; i < 3; i++) {
+		rx[i] = sse_select_ps(mask_ab, _mm_add_ps(ax[i], _mm_mul_ps(ab[i], v)), rx[i]);
+	}
+
+	/* vertex regions */
+	for (i = 0; i < 3; i++) {
+		rx[i] = sse_select_ps(mask_c, cx[i], rx[i]);
+		rx[i] = sse_select_ps(mask_b, bx[i], rx[i]);
+		rx[i] = sse_select_ps(mask_a, ax[i], rx[i]);
+	}
+
+	/* scatter back (transpose of the gather) */
+	for (i = 0; i < 3; i++) {
+		float tmp[4];
+		_mm_storeu_ps(tmp, rx[i]);
+		r[0][i] = tmp[0];
+		r[1][i] = tmp[1];
+		r[2][i] = tmp[2];
+		r[3][i] = tmp[3];
+	}
+#else
+	int i;
+	for (i = 0; i < 4; i++) {
+		closest_on_tri_to_point_v3(r[i], p, tri_a[i], tri_b[i], tri_c[i]);
+	}
+#endif  /* __SSE2__ */
+}
+
+/**
+ * Batched #isect_ray_tri_v3: intersect one ray against 4 triangles.
+ *
+ * \param r_lambda: hit distance per triangle (only set for hit lanes).
+ * \param r_uv: barycentric hit coordinates per triangle (only set for hit lanes), may be NULL.
+ * \return bitmask of triangles hit (bit i set when triangle i was hit).
+ */
+int isect_ray_tri_v3_batch4(
+        const float ray_origin[3], const float ray_direction[3],
+        const float *tri_a[4], const float *tri_b[4], const float *tri_c[4],
+        float r_lambda[4], float r_uv[4][2])
+{
+#ifdef __SSE2__
+	/* epsilon matches isect_ray_tri_v3 */
+	const __m128 epsilon = _mm_set1_ps(0.00000001f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	__m128 v0[3], dir[3], e1[3], e2[3], pv[3], sv[3], qv[3];
+	__m128 a, f, u, v, lambda, mask;
+	float u4[4], v4[4], lambda4[4];
+	int hit_mask, i;
+
+	for (i = 0; i < 3; i++) {
+		v0[i] = sse_gather_component(tri_a, i);
+		e1[i] = _mm_sub_ps(sse_gather_component(tri_b, i), v0[i]);
+		e2[i] = _mm_sub_ps(sse_gather_component(tri_c, i), v0[i]);
+		dir[i] = _mm_set1_ps(ray_direction[i]);
+		sv[i] = _mm_sub_ps(_mm_set1_ps(ray_origin[i]), v0[i]);
+	}
+
+	/* p = dir x e2 */
+	pv[0] = _mm_sub_ps(_mm_mul_ps(dir[1], e2[2]), _mm_mul_ps(dir[2], e2[1]));
+	pv[1] = _mm_sub_ps(_mm_mul_ps(dir[2], e2[0]), _mm_mul_ps(dir[0], e2[2]));
+	pv[2] = _mm_sub_ps(_mm_mul_ps(dir[0], e2[1]), _mm_mul_ps(dir[1], e2[0]));
+
+	a = sse_dot3(e1[0], e1[1], e1[2], pv[0], pv[1], pv[2]);
+	/* |a| > epsilon */
+	mask = _mm_or_ps(_mm_cmple_ps(a, _mm_sub_ps(zero, epsilon)), _mm_cmpge_ps(a, epsilon));
+
+	/* degenerate lanes divide by zero, masked out of the result */
+	f = _mm_div_ps(one, a);
+
+	u = _mm_mul_ps(f, sse_dot3(sv[0], sv[1], sv[2], pv[0], pv[1], pv[2]));
+	mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, one)));
+
+	/* q = s x e1 */
+	qv[0] = _mm_sub_ps(_mm_mul_ps(sv[1], e1[2]), _mm_mul_ps(sv[2], e1[1]));
+	qv[1] = _mm_sub_ps(_mm_mul_ps(sv[2], e1[0]), _mm_mul_ps(sv[0], e1[2]));
+	qv[2] = _mm_sub_ps(_mm_mul_ps(sv[0], e1[1]), _mm_mul_ps(sv[1], e1[0]));
+
+	v = _mm_mul_ps(f, sse_dot3(dir[0], dir[1], dir[2], qv[0], qv[1], qv[2]));
+	mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), one)));
+
+	lambda = _mm_mul_ps(f, sse_dot3(e2[0], e2[1], e2[2], qv[0], qv[1], qv[2]));
+	mask = _mm_and_ps(mask, _mm_cmpge_ps(lambda, zero));
+
+	hit_mask = _mm_movemask_ps(mask);
+	if (hit_mask == 0) {
+		return 0;
+	}
+
+	_mm_storeu_ps(u4, u);
+	_mm_storeu_ps(v4, v);
+	_mm_storeu_ps(lambda4, lambda);
+
+	for (i = 0; i < 4; i++) {
+		if (hit_mask & (1 << i)) {
+			r_lambda[i] = lambda4[i];
+			if (r_uv) {
+				r_uv[i][0] = u4[i];
+				r_uv[i][1] = v4[i];
+			}
+		}
+	}
+
+	return hit_mask;
+#else
+	int hit_mask = 0;
+	int i;
+	for (i = 0; i < 4; i++) {
+		if (isect_ray_tri_v3(ray_origin, ray_direction, tri_a[i], tri_b[i], tri_c[i],
+		                     &r_lambda[i], r_uv ? r_uv[i] : NULL))
+		{
+			hit_mask |= (1 << i);
+		}
+	}
+	return hit_mask;
+#endif  /* __SSE2__ */
+}
@@ -32,6 +32,10 @@
 
 #include <math.h>
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 #include "BLI_math.h"
 
 #include "BLI_strict_flags.h"
@@ -321,10 +325,20 @@ BLI_INLINE void bilinear_interpolation(const unsigned char *byte_buffer, const f
 			float_output[2] = ma_mb * row1[2] + a_mb * row3[2] + ma_b * row2[2] + a_b * row4[2];
 		}
 		else {
+#ifdef __SSE2__
+			/* RGBA is one SSE register wide, blend all four channels at once */
+			__m128 result;
+			result =                    _mm_mul_ps(_mm_set1_ps(ma_mb), _mm_loadu_ps(row1));
+			result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(a_mb),  _mm_loadu_ps(row3)));
+			result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(ma_b),  _mm_loadu_ps(row2)));
+			result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(a_b),   _mm_loadu_ps(row4)));
+			_mm_storeu_ps(float_output, result);
+#else
 			float_output[0] = ma_mb * row1[0] + a_mb * row3[0] + ma_b * row2[0] + a_b * row4[0];
 			float_output[1] = ma_mb * row1[1] + a_mb * row3[1] + ma_b * row2[1] + a_b * row4[1];
 			float_output[2] = ma_mb * row1[2] + a_mb * row3[2] + ma_b * row2[2] + a_b * row4[2];
 			float_output[3] = ma_mb * row1[3] + a_mb * row3[3] + ma_b * row2[3] + a_b * row4[3];
+#endif
 		}
 	}
 	else {
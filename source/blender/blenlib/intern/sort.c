@@ -185,3 +185,124 @@ loop:
 }
 
 #endif  /* __GLIBC__ */
+
+/* -------------------------------------------------------------------- */
+/* Parallel sort */
+
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_sort.h"
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+
+/* Below this array length going wide costs more than it saves. */
+#define PARALLEL_SORT_MIN_SIZE 65536
+
+typedef struct ParallelSortState {
+	char *src, *dst;
+	size_t n, es;
+	size_t width;  /* current merge width, in elements */
+	size_t num_chunks;
+	BLI_sort_cmp_t cmp;
+	void *thunk;
+} ParallelSortState;
+
+static void parallel_sort_chunk_cb(void *userdata, const int chunk)
+{
+	ParallelSortState *state = userdata;
+	const size_t start = (size_t)chunk * state->width;
+	const size_t len = MIN2(state->width, state->n - start);
+
+	BLI_qsort_r(state->src + start * state->es, len, state->es, state->cmp, state->thunk);
+}
+
+static void parallel_sort_merge_cb(void *userdata, const int pair)
+{
+	ParallelSortState *state = userdata;
+	const size_t es = state->es;
+	const size_t left = (size_t)pair * 2 * state->width;
+	const size_t mid = MIN2(left + state->width, state->n);
+	const size_t right = MIN2(left + 2 * state->width, state->n);
+	const char *a = state->src + left * es;
+	const char *a_end = state->src + mid * es;
+	const char *b = a_end;
+	const char *b_end = state->src + right * es;
+	char *dst = state->dst + left * es;
+
+	while (a < a_end && b < b_end) {
+		if (state->cmp(b, a, state->thunk) < 0) {
+			memcpy(dst, b, es);
+			b += es;
+		}
+		else {
+			memcpy(dst, a, es);
+			a += es;
+		}
+		dst += es;
+	}
+	if (a < a_end) {
+		memcpy(dst, a, (size_t)(a_end - a));
+	}
+	if (b < b_end) {
+		memcpy(dst, b, (size_t)(b_end - b));
+	}
+}
+
+/**
+ * Multi-threaded drop-in for #BLI_qsort_r: chunks of the array are sorted
+ * concurrently through the task scheduler, then pairwise-merged in parallel
+ * level by level. Falls back to plain #BLI_qsort_r for small arrays (or
+ * single-threaded schedulers), so it is always safe to call.
+ *
+ * 
+ote Unlike qsort proper this needs a temporary buffer of the array size.
+ * 
+ote  cmp must be thread-safe.
+ */
+void BLI_qsort_parallel(void *a, size_t n, size_t es, BLI_sort_cmp_t cmp, void *thunk)
+{
+	ParallelSortState state;
+	const int num_threads = BLI_task_scheduler_num_threads(BLI_task_scheduler_get());
+	size_t num_chunks, i;
+
+	if (n < PARALLEL_SORT_MIN_SIZE || num_threads == 1) {
+		BLI_qsort_r(a, n, es, cmp, thunk);
+		return;
+	}
+
+	/* Power of two chunk count keeps the merge tree balanced. */
+	num_chunks = 2;
+	while (num_chunks < (size_t)num_threads * 2) {
+		num_chunks <<= 1;
+	}
+
+	state.src = a;
+	state.dst = MEM_mallocN(n * es, __func__);
+	state.n = n;
+	state.es = es;
+	state.cmp = cmp;
+	state.thunk = thunk;
+	state.num_chunks = num_chunks;
+	state.width = (n + num_chunks - 1) / num_chunks;
+
+	BLI_task_parallel_range(0, (int)num_chunks, &state, parallel_sort_chunk_cb, true);
+
+	while (state.width < n) {
+		const size_t num_pairs = (n + (2 * state.width) - 1) / (2 * state.width);
+
+		BLI_task_parallel_range(0, (int)num_pairs, &state, parallel_sort_merge_cb, true);
+
+		SWAP(char *, state.src, state.dst);
+		state.width *= 2;
+	}
+
+	/* Result may have ended up in the temporary buffer. */
+	if (state.src != (char *)a) {
+		memcpy(a, state.src, n * es);
+		SWAP(char *, state.src, state.dst);
+	}
+
+	MEM_freeN(state.dst);
+}
@@ -153,9 +153,28 @@ struct TaskScheduler {
 	volatile bool do_exit;
 };
 
+/* Number of slots in the per-thread local task queue.
+ *
+ * Tasks pushed from within a worker thread land in that worker's own queue
+ * first, so nested task spawning does not have to fight over the global
+ * scheduler mutex. Idle workers steal from each other's local queues before
+ * falling back to sleeping on the global queue condition.
+ */
+#define LOCAL_QUEUE_SIZE 64
+
 typedef struct TaskThread {
 	TaskScheduler *scheduler;
 	int id;
+
+	/* Work-stealing deque, a simple ring buffer guarded by a spin lock.
+	 * The owner thread pushes/pops at the head (LIFO, cache friendly),
+	 * thieves pop at the tail (FIFO, steals the oldest hence likely
+	 * largest chunk of work).
+	 */
+	Task *local_queue[LOCAL_QUEUE_SIZE];
+	int local_queue_head;
+	int local_queue_size;
+	SpinLock local_queue_lock;
 } TaskThread;
 
 /* Helper */
@@ -228,6 +247,77 @@ static void task_free(TaskPool *pool, Task *task, const int thread_id)
 	}
 }
 
+/* Work-stealing local queues */
+
+/* Push to the head of the owner's local queue, returns false when full
+ * (caller then falls back to the global queue). */
+static bool task_thread_local_push(TaskThread *task_thread, Task *task)
+{
+	bool pushed = false;
+
+	BLI_spin_lock(&task_thread->local_queue_lock);
+	if (task_thread->local_queue_size < LOCAL_QUEUE_SIZE) {
+		task_thread->local_queue[task_thread->local_queue_head] = task;
+		task_thread->local_queue_head = (task_thread->local_queue_head + 1) % LOCAL_QUEUE_SIZE;
+		task_thread->local_queue_size++;
+		pushed = true;
+	}
+	BLI_spin_unlock(&task_thread->local_queue_lock);
+
+	return pushed;
+}
+
+/* Pop from the head (newest task) for the owner thread, from the tail
+ * (oldest task) for thieves. */
+static Task *task_thread_local_pop(TaskThread *task_thread, const bool is_owner)
+{
+	Task *task = NULL;
+
+	BLI_spin_lock(&task_thread->local_queue_lock);
+	if (task_thread->local_queue_size > 0) {
+		if (is_owner) {
+			task_thread->local_queue_head =
+			        (task_thread->local_queue_head + LOCAL_QUEUE_SIZE - 1) % LOCAL_QUEUE_SIZE;
+			task = task_thread->local_queue[task_thread->local_queue_head];
+		}
+		else {
+			const int tail = (task_thread->local_queue_head + LOCAL_QUEUE_SIZE -
+			                  task_thread->local_queue_size) % LOCAL_QUEUE_SIZE;
+			task = task_thread->local_queue[tail];
+		}
+		task_thread->local_queue_size--;
+	}
+	BLI_spin_unlock(&task_thread->local_queue_lock);
+
+	return task;
+}
+
+/* Try to steal a runnable task, checking own queue first. */
+static Task *task_scheduler_steal(TaskScheduler *scheduler, const int thread_id)
+{
+	Task *task;
+	int i;
+
+	if (thread_id > 0) {
+		task = task_thread_local_pop(&scheduler->task_threads[thread_id - 1], true);
+		if (task != NULL) {
+			return task;
+		}
+	}
+
+	for (i = 0; i < scheduler->num_threads; i++) {
+		if (i == thread_id - 1) {
+			continue;
+		}
+		task = task_thread_local_pop(&scheduler->task_threads[i], false);
+		if (task != NULL) {
+			return task;
+		}
+	}
+
+	return NULL;
+}
+
 /* Task Scheduler */
 
 static void task_pool_num_decrease(TaskPool *pool, size_t done)
@@ -256,13 +346,18 @@ static void task_pool_num_increase(TaskPool *pool)
 	BLI_mutex_unlock(&pool->num_mutex);
 }
 
-static bool task_scheduler_thread_wait_pop(TaskScheduler *scheduler, Task **task)
+static bool task_scheduler_thread_wait_pop(TaskScheduler *scheduler, Task **task, const int thread_id)
 {
 	bool found_task = false;
-	BLI_mutex_lock(&scheduler->queue_mutex);
 
-	while (!scheduler->queue.first && !scheduler->do_exit)
-		BLI_condition_wait(&scheduler->queue_cond, &scheduler->queue_mutex);
+	/* Check local queues first, without touching the global mutex. */
+	*task = task_scheduler_steal(scheduler, thread_id);
+	if (*task != NULL) {
+		atomic_add_z(&(*task)->pool->currently_running_tasks, 1);
+		return true;
+	}
+
+	BLI_mutex_lock(&scheduler->queue_mutex);
 
 	do {
 		Task *current_task;
@@ -302,8 +397,29 @@ static bool task_scheduler_thread_wait_pop(TaskScheduler *scheduler, Task **task
 				break;
 			}
 		}
-		if (!found_task)
-			BLI_condition_wait(&scheduler->queue_cond, &scheduler->queue_mutex);
+		if (!found_task) {
+			/* Nothing in the global queue, try stealing from other
+			 * threads before going to sleep. */
+			BLI_mutex_unlock(&scheduler->queue_mutex);
+			*task = task_scheduler_steal(scheduler, thread_id);
+			if (*task != NULL) {
+				atomic_add_z(&(*task)->pool->currently_running_tasks, 1);
+				return true;
+			}
+			BLI_mutex_lock(&scheduler->queue_mutex);
+			/* Re-check under the mutex so a push+notify that happened in
+			 * between does not leave us sleeping on work (pushes to local
+			 * queues notify while holding the queue mutex). */
+			*task = task_scheduler_steal(scheduler, thread_id);
+			if (*task != NULL) {
+				atomic_add_z(&(*task)->pool->currently_running_tasks, 1);
+				BLI_mutex_unlock(&scheduler->queue_mutex);
+				return true;
+			}
+			if (scheduler->queue.first == NULL && !scheduler->do_exit) {
+				BLI_condition_wait(&scheduler->queue_cond, &scheduler->queue_mutex);
+			}
+		}
 	} while (!found_task);
 
 	BLI_mutex_unlock(&scheduler->queue_mutex);
@@ -319,7 +435,7 @@ static void *task_scheduler_thread_run(void *thread_p)
 	Task *task;
 
 	/* keep popping off tasks */
-	while (task_scheduler_thread_wait_pop(scheduler, &task)) {
+	while (task_scheduler_thread_wait_pop(scheduler, &task, thread_id)) {
 		TaskPool *pool = task->pool;
 
 		/* run task */
@@ -373,6 +489,9 @@ TaskScheduler *BLI_task_scheduler_create(int num_threads)
 			TaskThread *thread = &scheduler->task_threads[i];
 			thread->scheduler = scheduler;
 			thread->id = i + 1;
+			thread->local_queue_head = 0;
+			thread->local_queue_size = 0;
+			BLI_spin_init(&thread->local_queue_lock);
 
 			if (pthread_create(&scheduler->threads[i], NULL, task_scheduler_thread_run, thread) != 0) {
 				fprintf(stderr, "TaskScheduler failed to launch thread %d/%d\n", i, num_threads);
@@ -408,8 +527,18 @@ void BLI_task_scheduler_free(TaskScheduler *scheduler)
 		MEM_freeN(scheduler->threads);
 	}
 
-	/* Delete task thread data */
+	/* Delete task thread data, including tasks left in the local queues
+	 * (workers exit without draining those on do_exit). */
 	if (scheduler->task_threads) {
+		int i;
+		for (i = 0; i < scheduler->num_threads; i++) {
+			TaskThread *thread = &scheduler->task_threads[i];
+			while ((task = task_thread_local_pop(thread, true))) {
+				task_data_free(task, 0);
+				MEM_freeN(task);
+			}
+			BLI_spin_end(&thread->local_queue_lock);
+		}
 		MEM_freeN(scheduler->task_threads);
 	}
 
@@ -441,10 +570,29 @@ int BLI_task_scheduler_num_threads(TaskScheduler *scheduler)
 	return scheduler->num_threads + 1;
 }
 
-static void task_scheduler_push(TaskScheduler *scheduler, Task *task, TaskPriority priority)
+static void task_scheduler_push(TaskScheduler *scheduler, Task *task, TaskPriority priority,
+                                int thread_id)
 {
 	task_pool_num_increase(task->pool);
 
+	/* Tasks pushed from within a worker thread go to that worker's own
+	 * queue when there is room, so nested task spawning does not contend
+	 * on the global queue mutex; idle workers will steal them. */
+	if (thread_id > 0 && thread_id <= scheduler->num_threads &&
+	    task->pool->num_threads == 0 &&
+	    !scheduler->background_thread_only)
+	{
+		if (task_thread_local_push(&scheduler->task_threads[thread_id - 1], task)) {
+			/* Wake up a sleeper to give stealing a chance. Done while
+			 * holding the queue mutex, so the notify cannot slip between
+			 * a worker's last steal attempt and its condition wait. */
+			BLI_mutex_lock(&scheduler->queue_mutex);
+			BLI_condition_notify_one(&scheduler->queue_cond);
+			BLI_mutex_unlock(&scheduler->queue_mutex);
+			return;
+		}
+	}
+
 	/* add task to queue */
 	BLI_mutex_lock(&scheduler->queue_mutex);
 
@@ -460,7 +608,9 @@ static void task_scheduler_push(TaskScheduler *scheduler, Task *task, TaskPriori
 static void task_scheduler_clear(TaskScheduler *scheduler, TaskPool *pool)
 {
 	Task *task, *nexttask;
+	Task *keep[LOCAL_QUEUE_SIZE];
 	size_t done = 0;
+	int i;
 
 	BLI_mutex_lock(&scheduler->queue_mutex);
 
@@ -478,6 +628,36 @@ static void task_scheduler_clear(TaskScheduler *scheduler, TaskPool *pool)
 
 	BLI_mutex_unlock(&scheduler->queue_mutex);
 
+	/* also sweep the workers' local queues, tasks in there must not
+	 * outlive their pool either */
+	for (i = 0; i < scheduler->num_threads; i++) {
+		TaskThread *thread = &scheduler->task_threads[i];
+		int j, num_keep = 0;
+
+		BLI_spin_lock(&thread->local_queue_lock);
+		for (j = 0; j < thread->local_queue_size; j++) {
+			const int index = (thread->local_queue_head + LOCAL_QUEUE_SIZE -
+			                   thread->local_queue_size + j) % LOCAL_QUEUE_SIZE;
+			Task *local_task = thread->local_queue[index];
+
+			if (local_task->pool == pool) {
+				task_data_free(local_task, 0);
+				MEM_freeN(local_task);
+				done++;
+			}
+			else {
+				keep[num_keep++] = local_task;
+			}
+		}
+		for (j = 0; j < num_keep; j++) {
+			const int index = (thread->local_queue_head + LOCAL_QUEUE_SIZE -
+			                   num_keep + j) % LOCAL_QUEUE_SIZE;
+			thread->local_queue[index] = keep[j];
+		}
+		thread->local_queue_size = num_keep;
+		BLI_spin_unlock(&thread->local_queue_lock);
+	}
+
 	/* notify done */
 	task_pool_num_decrease(pool, done);
 }
@@ -610,7 +790,7 @@ static void task_pool_push(
 	task->freedata = freedata;
 	task->pool = pool;
 
-	task_scheduler_push(pool->scheduler, task, priority);
+	task_scheduler_push(pool->scheduler, task, priority, thread_id);
 }
 
 void BLI_task_pool_push_ex(
@@ -35,10 +35,13 @@
 
 typedef struct {
 	void *next, *prev;
-	
+
 	char *buf;
 	unsigned int ident, size;
-	
+	/* content hash, to find matching chunks in the previous undo step
+	 * again after chunk boundaries shifted (see memfile_chunk_add) */
+	unsigned int hash;
+
 } MemFileChunk;
 
 typedef struct MemFile {
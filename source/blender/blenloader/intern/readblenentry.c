@@ -148,6 +148,24 @@ LinkNode *BLO_blendhandle_get_datablock_names(BlendHandle *bh, int ofblocktype,
 	LinkNode *names = NULL;
 	BHead *bhead;
 	int tot = 0;
+	const int idx_tot = blo_blendidx_tot(fd);
+
+	if (idx_tot != -1) {
+		/* the file has an ID index footer, no need to walk the blocks */
+		BlendIdxEntry entry;
+		int i;
+
+		for (i = 0; i < idx_tot; i++) {
+			blo_blendidx_get(fd, idx_tot, i, &entry);
+			if (entry.code == ofblocktype) {
+				BLI_linklist_prepend(&names, strdup(entry.name + 2));
+				tot++;
+			}
+		}
+
+		*tot_names = tot;
+		return names;
+	}
 
 	for (bhead = blo_firstbhead(fd); bhead; bhead = blo_nextbhead(fd, bhead)) {
 		if (bhead->code == ofblocktype) {
@@ -210,11 +228,11 @@ LinkNode *BLO_blendhandle_get_previews(BlendHandle *bh, int ofblocktype, int *to
 					if (prv) {
 						memcpy(new_prv, prv, sizeof(PreviewImage));
 						if (prv->rect[0] && prv->w[0] && prv->h[0]) {
-							unsigned int *rect = NULL;
+							const unsigned int *rect = NULL;
 							size_t len = new_prv->w[0] * new_prv->h[0] * sizeof(unsigned int);
 							new_prv->rect[0] = MEM_callocN(len, __func__);
 							bhead = blo_nextbhead(fd, bhead);
-							rect = (unsigned int *)(bhead + 1);
+							rect = blo_bhead_data(bhead);
 							BLI_assert(len == bhead->len);
 							memcpy(new_prv->rect[0], rect, len);
 						}
@@ -227,11 +245,11 @@ LinkNode *BLO_blendhandle_get_previews(BlendHandle *bh, int ofblocktype, int *to
 						}
 						
 						if (prv->rect[1] && prv->w[1] && prv->h[1]) {
-							unsigned int *rect = NULL;
+							const unsigned int *rect = NULL;
 							size_t len = new_prv->w[1] * new_prv->h[1] * sizeof(unsigned int);
 							new_prv->rect[1] = MEM_callocN(len, __func__);
 							bhead = blo_nextbhead(fd, bhead);
-							rect = (unsigned int *)(bhead + 1);
+							rect = blo_bhead_data(bhead);
 							BLI_assert(len == bhead->len);
 							memcpy(new_prv->rect[1], rect, len);
 						}
@@ -274,7 +292,29 @@ LinkNode *BLO_blendhandle_get_linkable_groups(BlendHandle *bh)
 	GSet *gathered = BLI_gset_ptr_new("linkable_groups gh");
 	LinkNode *names = NULL;
 	BHead *bhead;
-	
+	const int idx_tot = blo_blendidx_tot(fd);
+
+	if (idx_tot != -1) {
+		/* the file has an ID index footer, no need to walk the blocks */
+		BlendIdxEntry entry;
+		int i;
+
+		for (i = 0; i < idx_tot; i++) {
+			blo_blendidx_get(fd, idx_tot, i, &entry);
+			if (BKE_idcode_is_valid(entry.code) && BKE_idcode_is_linkable(entry.code)) {
+				const char *str = BKE_idcode_to_name(entry.code);
+
+				if (BLI_gset_add(gathered, (void *)str)) {
+					BLI_linklist_prepend(&names, strdup(str));
+				}
+			}
+		}
+
+		BLI_gset_free(gathered, NULL);
+
+		return names;
+	}
+
 	for (bhead = blo_firstbhead(fd); bhead; bhead = blo_nextbhead(fd, bhead)) {
 		if (bhead->code == ENDB) {
 			break;
@@ -282,16 +322,16 @@ LinkNode *BLO_blendhandle_get_linkable_groups(BlendHandle *bh)
 		else if (BKE_idcode_is_valid(bhead->code)) {
 			if (BKE_idcode_is_linkable(bhead->code)) {
 				const char *str = BKE_idcode_to_name(bhead->code);
-				
+
 				if (BLI_gset_add(gathered, (void *)str)) {
 					BLI_linklist_prepend(&names, strdup(str));
 				}
 			}
 		}
 	}
-	
+
 	BLI_gset_free(gathered, NULL);
-	
+
 	return names;
 }		
 
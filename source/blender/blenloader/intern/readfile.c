@@ -45,10 +45,12 @@
 #include "BLI_utildefines.h"
 #ifndef WIN32
 #  include <unistd.h> // for read close
+#  include <sys/mman.h> // for mmap munmap
 #else
 #  include <io.h> // for open close read
 #  include "winsock2.h"
 #  include "BLI_winstuff.h"
+#  include "mmap_win.h"
 #endif
 
 /* allow readfile to use deprecated functionality */
@@ -107,6 +109,7 @@
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
 #include "BLI_threads.h"
+#include "BLI_task.h"
 #include "BLI_mempool.h"
 
 #include "BLT_translation.h"
@@ -128,6 +131,7 @@
 #include "BKE_idcode.h"
 #include "BKE_material.h"
 #include "BKE_main.h" // for Main
+#include "BKE_main_idmap.h"
 #include "BKE_mesh.h" // for ME_ defines (patching)
 #include "BKE_modifier.h"
 #include "BKE_multires.h"
@@ -557,38 +561,51 @@ static void read_file_version(FileData *fd, Main *main)
 #ifdef USE_GHASH_BHEAD
 static void read_file_bhead_idname_map_create(FileData *fd)
 {
-	BHead *bhead;
+	BLI_assert(fd->bhead_idname_hash == NULL);
+
+	/* The map is filled in lazily, see bhead_idname_map_scan: indexing all
+	 * blocks here would read (and for compressed files, decompress) entire
+	 * library files up front, while linking typically only needs a few of
+	 * their datablocks. */
+	fd->bhead_idname_hash = BLI_ghash_str_new(__func__);
+	fd->bhead_idname_scan = blo_firstbhead(fd);
+}
+
+/**
+ * Continue indexing ID block names from where the last scan stopped, until
+ * \a idname is found or the end of the file is reached. So a library file is
+ * only read up to the last datablock that is actually looked up in it.
+ */
+static BHead *bhead_idname_map_scan(FileData *fd, const char *idname)
+{
+	BHead *bhead = fd->bhead_idname_scan;
+	BHead *found = NULL;
 
 	/* dummy values */
 	bool is_link = false;
 	int code_prev = ENDB;
-	unsigned int reserve = 0;
 
-	for (bhead = blo_firstbhead(fd); bhead; bhead = blo_nextbhead(fd, bhead)) {
+	while (bhead && !found) {
 		if (code_prev != bhead->code) {
 			code_prev = bhead->code;
 			is_link = BKE_idcode_is_valid(code_prev) ? BKE_idcode_is_linkable(code_prev) : false;
 		}
 
 		if (is_link) {
-			reserve += 1;
-		}
-	}
-
-	BLI_assert(fd->bhead_idname_hash == NULL);
+			const char *bhead_idname = bhead_id_name(fd, bhead);
 
-	fd->bhead_idname_hash = BLI_ghash_str_new_ex(__func__, reserve);
-
-	for (bhead = blo_firstbhead(fd); bhead; bhead = blo_nextbhead(fd, bhead)) {
-		if (code_prev != bhead->code) {
-			code_prev = bhead->code;
-			is_link = BKE_idcode_is_valid(code_prev) ? BKE_idcode_is_linkable(code_prev) : false;
+			BLI_ghash_insert(fd->bhead_idname_hash, (void *)bhead_idname, bhead);
+			if (STREQ(idname, bhead_idname)) {
+				found = bhead;
+			}
 		}
 
-		if (is_link) {
-			BLI_ghash_insert(fd->bhead_idname_hash, (void *)bhead_id_name(fd, bhead), bhead);
-		}
+		bhead = blo_nextbhead(fd, bhead);
 	}
+
+	fd->bhead_idname_scan = bhead;
+
+	return found;
 }
 #endif
 
@@ -771,21 +788,43 @@ static BHeadN *get_bhead(FileData *fd)
 			 * the associated data and put everything in a BHeadN (creative naming !)
 			 */
 			if (!fd->eof) {
-				new_bhead = MEM_mallocN(sizeof(BHeadN) + bhead.len, "new_bhead");
-				if (new_bhead) {
-					new_bhead->next = new_bhead->prev = NULL;
-					new_bhead->bhead = bhead;
-					
-					readsize = fd->read(fd, new_bhead + 1, bhead.len);
-					
-					if (readsize != bhead.len) {
+				if ((fd->flags & (FD_FLAGS_FILE_MEMMAPPED | FD_FLAGS_SWITCH_ENDIAN)) ==
+				    FD_FLAGS_FILE_MEMMAPPED)
+				{
+					/* Zero-copy: reference the block data directly in the mapped
+					 * (read-only) file. Foreign endian files keep the copying path
+					 * below, since endian switching modifies the data in place. */
+					if (fd->seek + bhead.len > fd->buffersize) {
 						fd->eof = 1;
-						MEM_freeN(new_bhead);
-						new_bhead = NULL;
+					}
+					else {
+						new_bhead = MEM_mallocN(sizeof(BHeadN), "new_bhead");
+						new_bhead->next = new_bhead->prev = NULL;
+						new_bhead->decoded = NULL;
+						new_bhead->bhead = bhead;
+						new_bhead->data = fd->buffer + fd->seek;
+						fd->seek += bhead.len;
 					}
 				}
 				else {
-					fd->eof = 1;
+					new_bhead = MEM_mallocN(sizeof(BHeadN) + bhead.len, "new_bhead");
+					if (new_bhead) {
+						new_bhead->next = new_bhead->prev = NULL;
+						new_bhead->decoded = NULL;
+						new_bhead->bhead = bhead;
+						new_bhead->data = (const char *)(new_bhead + 1);
+
+						readsize = fd->read(fd, new_bhead + 1, bhead.len);
+
+						if (readsize != bhead.len) {
+							fd->eof = 1;
+							MEM_freeN(new_bhead);
+							new_bhead = NULL;
+						}
+					}
+					else {
+						fd->eof = 1;
+					}
 				}
 			}
 		}
@@ -796,8 +835,14 @@ static BHeadN *get_bhead(FileData *fd)
 	 */
 	if (new_bhead) {
 		BLI_addtail(&fd->listbase, new_bhead);
+
+		/* block data ends at ENDB, what follows (the ID index footer,
+		 * see readfile.h) must not be parsed as blocks */
+		if (new_bhead->bhead.code == ENDB) {
+			fd->eof = 1;
+		}
 	}
-	
+
 	return(new_bhead);
 }
 
@@ -855,10 +900,62 @@ BHead *blo_nextbhead(FileData *fd, BHead *thisblock)
 	return(bhead);
 }
 
+/**
+ * Data of a BHead block: directly follows the BHead for file/memory reads,
+ * but points into the mapped file in memory mapped mode, so always go
+ * through this instead of using `bhead + 1`.
+ */
+const void *blo_bhead_data(const BHead *bhead)
+{
+	const BHeadN *bheadn = (const BHeadN *)POINTER_OFFSET(bhead, -offsetof(BHeadN, bhead));
+
+	return bheadn->data;
+}
+
+/**
+ * Number of entries in the ID block index footer of this file (see readfile.h),
+ * -1 when there is none or it cannot be used (foreign endian files,
+ * or the file is not buffer backed like gzip streams).
+ */
+int blo_blendidx_tot(const FileData *fd)
+{
+	BlendIdxTrailer trailer;
+
+	if ((fd->buffer == NULL) || (fd->flags & FD_FLAGS_SWITCH_ENDIAN)) {
+		return -1;
+	}
+	if (fd->buffersize < (int)sizeof(trailer)) {
+		return -1;
+	}
+
+	memcpy(&trailer, fd->buffer + fd->buffersize - sizeof(trailer), sizeof(trailer));
+
+	if (memcmp(trailer.magic, BLEND_IDX_MAGIC, sizeof(trailer.magic)) != 0) {
+		return -1;
+	}
+	if ((trailer.version != BLEND_IDX_VERSION) ||
+	    (trailer.tot < 0) ||
+	    (trailer.tot > (int)((fd->buffersize - sizeof(trailer)) / sizeof(BlendIdxEntry))))
+	{
+		return -1;
+	}
+
+	return trailer.tot;
+}
+
+void blo_blendidx_get(const FileData *fd, int tot, int i, BlendIdxEntry *r_entry)
+{
+	const char *entries = fd->buffer + fd->buffersize -
+	                      sizeof(BlendIdxTrailer) - (size_t)tot * sizeof(BlendIdxEntry);
+
+	/* copied out, the entries in the file are not suitably aligned */
+	memcpy(r_entry, entries + (size_t)i * sizeof(BlendIdxEntry), sizeof(*r_entry));
+}
+
 /* Warning! Caller's responsability to ensure given bhead **is** and ID one! */
 const char *bhead_id_name(const FileData *fd, const BHead *bhead)
 {
-	return (const char *)POINTER_OFFSET(bhead, sizeof(*bhead) + fd->id_name_offs);
+	return (const char *)POINTER_OFFSET(blo_bhead_data(bhead), fd->id_name_offs);
 }
 
 static void decode_blender_header(FileData *fd)
@@ -911,7 +1008,7 @@ static int read_file_dna(FileData *fd)
 		if (bhead->code == DNA1) {
 			const bool do_endian_swap = (fd->flags & FD_FLAGS_SWITCH_ENDIAN) != 0;
 			
-			fd->filesdna = DNA_sdna_from_data(&bhead[1], bhead->len, do_endian_swap);
+			fd->filesdna = DNA_sdna_from_data(blo_bhead_data(bhead), bhead->len, do_endian_swap);
 			if (fd->filesdna) {
 				fd->compflags = DNA_struct_get_compareflags(fd->filesdna, fd->memsdna);
 				/* used to retrieve ID names from (bhead+1) */
@@ -935,7 +1032,7 @@ static int *read_file_thumbnail(FileData *fd)
 	for (bhead = blo_firstbhead(fd); bhead; bhead = blo_nextbhead(fd, bhead)) {
 		if (bhead->code == TEST) {
 			const bool do_endian_swap = (fd->flags & FD_FLAGS_SWITCH_ENDIAN) != 0;
-			int *data = (int *)(bhead + 1);
+			int *data = (int *)blo_bhead_data(bhead);
 
 			if (bhead->len < (2 * sizeof(int))) {
 				break;
@@ -1105,9 +1202,44 @@ static FileData *blo_decode_and_check(FileData *fd, ReportList *reports)
 FileData *blo_openblenderfile(const char *filepath, ReportList *reports)
 {
 	gzFile gzfile;
+	char header[7];
+	int file;
 	errno = 0;
+
+	/* Uncompressed files are memory mapped, so BHead block data can be used
+	 * straight from the page cache instead of being copied into each BHeadN;
+	 * compressed (and unreadable) files take the gzip streaming path below. */
+	file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+	if (file != -1) {
+		if ((read(file, header, sizeof(header)) == sizeof(header)) &&
+		    (memcmp(header, "BLENDER", sizeof(header)) == 0))
+		{
+			const size_t filesize = BLI_file_descriptor_size(file);
+			void *mem = NULL;
+
+			if ((filesize != (size_t)-1) && (filesize <= INT_MAX)) {
+				mem = mmap(NULL, filesize, PROT_READ, MAP_SHARED, file, 0);
+			}
+
+			if (mem && (mem != MAP_FAILED)) {
+				FileData *fd = filedata_new();
+				fd->filedes = file;
+				fd->buffer = mem;
+				fd->buffersize = (int)filesize;
+				fd->read = fd_read_from_memory;
+				fd->flags |= FD_FLAGS_FILE_MEMMAPPED;
+
+				/* needed for library_append and read_libraries */
+				BLI_strncpy(fd->relabase, filepath, sizeof(fd->relabase));
+
+				return blo_decode_and_check(fd, reports);
+			}
+		}
+		close(file);
+	}
+
 	gzfile = BLI_gzopen(filepath, "rb");
-	
+
 	if (gzfile == (gzFile)Z_NULL) {
 		BKE_reportf(reports, RPT_WARNING, "Unable to open '%s': %s",
 		            filepath, errno ? strerror(errno) : TIP_("unknown error reading file"));
@@ -1242,6 +1374,9 @@ FileData *blo_openblendermemfile(MemFile *memfile, ReportList *reports)
 void blo_freefiledata(FileData *fd)
 {
 	if (fd) {
+		BHeadN *new_bhead;
+
+
 		if (fd->filedes != -1) {
 			close(fd->filedes);
 		}
@@ -1256,12 +1391,21 @@ void blo_freefiledata(FileData *fd)
 			}
 		}
 		
-		if (fd->buffer && !(fd->flags & FD_FLAGS_NOT_MY_BUFFER)) {
+		if (fd->buffer && (fd->flags & FD_FLAGS_FILE_MEMMAPPED)) {
+			munmap((void *)fd->buffer, (size_t)fd->buffersize);
+			fd->buffer = NULL;
+		}
+		else if (fd->buffer && !(fd->flags & FD_FLAGS_NOT_MY_BUFFER)) {
 			MEM_freeN((void *)fd->buffer);
 			fd->buffer = NULL;
 		}
 		
-		// Free all BHeadN data blocks
+		// Free all BHeadN data blocks, including decoded structs nothing took ownership of
+		for (new_bhead = fd->listbase.first; new_bhead; new_bhead = new_bhead->next) {
+			if (new_bhead->decoded) {
+				MEM_freeN(new_bhead->decoded);
+			}
+		}
 		BLI_freelistN(&fd->listbase);
 		
 		if (fd->memsdna)
@@ -1730,6 +1874,9 @@ static void insert_packedmap(FileData *fd, PackedFile *pf)
 {
 	oldnewmap_insert(fd->packedmap, pf, pf, 0);
 	oldnewmap_insert(fd->packedmap, pf->data, pf->data, 0);
+	if (pf->lazy_path) {
+		oldnewmap_insert(fd->packedmap, pf->lazy_path, pf->lazy_path, 0);
+	}
 }
 
 void blo_make_packed_pointer_map(FileData *fd, Main *oldmain)
@@ -1830,7 +1977,8 @@ static void switch_endian_structs(struct SDNA *filesdna, BHead *bhead)
 	int blocksize, nblocks;
 	char *data;
 	
-	data = (char *)(bhead+1);
+	/* only called for non-mapped data (see get_bhead), which we own and may modify */
+	data = (char *)blo_bhead_data(bhead);
 	blocksize = filesdna->typelens[ filesdna->structs[bhead->SDNAnr][0] ];
 	
 	nblocks = bhead->nr;
@@ -1841,23 +1989,24 @@ static void switch_endian_structs(struct SDNA *filesdna, BHead *bhead)
 	}
 }
 
-static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
+static void *read_struct_decode(FileData *fd, BHead *bh, const char *blockname)
 {
 	void *temp = NULL;
-	
+
 	if (bh->len) {
 		/* switch is based on file dna */
 		if (bh->SDNAnr && (fd->flags & FD_FLAGS_SWITCH_ENDIAN))
 			switch_endian_structs(fd->filesdna, bh);
-		
+
 		if (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) {
 			if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
-				temp = DNA_struct_reconstruct(fd->memsdna, fd->filesdna, fd->compflags, bh->SDNAnr, bh->nr, (bh+1));
+				/* data is only read from, cast is safe for mapped blocks */
+				temp = DNA_struct_reconstruct(fd->memsdna, fd->filesdna, fd->compflags, bh->SDNAnr, bh->nr, (void *)blo_bhead_data(bh));
 			}
 			else {
 				/* SDNA_CMP_EQUAL */
 				temp = MEM_mallocN(bh->len, blockname);
-				memcpy(temp, (bh+1), bh->len);
+				memcpy(temp, blo_bhead_data(bh), bh->len);
 			}
 		}
 	}
@@ -1865,6 +2014,21 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 	return temp;
 }
 
+static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
+{
+	BHeadN *bheadn = (BHeadN *)POINTER_OFFSET(bh, -offsetof(BHeadN, bhead));
+
+	/* decode_blocks_parallel() may have decoded this block already,
+	 * if so ownership of the result passes on to the caller */
+	if (bheadn->decoded) {
+		void *temp = bheadn->decoded;
+		bheadn->decoded = NULL;
+		return temp;
+	}
+
+	return read_struct_decode(fd, bh, blockname);
+}
+
 typedef void (*link_list_cb)(FileData *fd, void *data);
 
 static void link_list_ex(FileData *fd, ListBase *lb, link_list_cb callback)		/* only direct data */
@@ -2229,14 +2393,66 @@ static void direct_link_paint_curve(FileData *fd, PaintCurve *pc)
 
 /* ************ READ PACKEDFILE *************** */
 
-static PackedFile *direct_link_packedfile(FileData *fd, PackedFile *oldpf)
+/* packed data blocks below this size are not worth re-reading on demand */
+#define PACKEDFILE_LAZY_MINSIZE (128 * 1024)
+
+/* Find the block the packed data was read from again, to get its position
+ * in the file. Packed files are rare enough that a linear walk is fine
+ * (the sorted bheadmap can not be used, it would go stale while blocks are
+ * still being streamed in). */
+static BHead *packedfile_data_bhead(FileData *fd, const void *olddata)
+{
+	BHeadN *new_bhead;
+
+	for (new_bhead = fd->listbase.first; new_bhead; new_bhead = new_bhead->next) {
+		if ((new_bhead->bhead.old == olddata) && (new_bhead->bhead.code == DATA)) {
+			return &new_bhead->bhead;
+		}
+	}
+
+	return NULL;
+}
+
+static PackedFile *direct_link_packedfile(FileData *fd, PackedFile *oldpf, const bool allow_lazy)
 {
 	PackedFile *pf = newpackedadr(fd, oldpf);
 
 	if (pf) {
-		pf->data = newpackedadr(fd, pf->data);
+		if (fd->memfile) {
+			/* undo: the data and source path of the old main are reused */
+			pf->data = newpackedadr(fd, pf->data);
+			pf->lazy_path = newpackedadr(fd, pf->lazy_path);
+		}
+		else {
+			const void *olddata = pf->data;
+
+			pf->data = newpackedadr(fd, pf->data);
+			pf->flag &= ~PF_FILE_LAZY;
+			pf->lazy_path = NULL;
+
+			/* Memory mapped files are uncompressed, so block positions in
+			 * the buffer equal positions in the file on disk: instead of
+			 * keeping large packed data in memory, remember where it lives
+			 * and stream it back in on demand (see acquirePackedFileData).
+			 * The raw packed bytes are never endian switched, so this works
+			 * for foreign endian files too. */
+			if (allow_lazy && pf->data &&
+			    (fd->flags & FD_FLAGS_FILE_MEMMAPPED) &&
+			    (pf->size >= PACKEDFILE_LAZY_MINSIZE))
+			{
+				BHead *bhead = packedfile_data_bhead(fd, olddata);
+
+				if (bhead && (bhead->len >= pf->size)) {
+					pf->lazy_offset = (int)((const char *)blo_bhead_data(bhead) - fd->buffer);
+					pf->lazy_path = BLI_strdup(fd->relabase);
+					pf->flag |= PF_FILE_LAZY;
+					MEM_freeN(pf->data);
+					pf->data = NULL;
+				}
+			}
+		}
 	}
-	
+
 	return pf;
 }
 
@@ -2663,7 +2879,10 @@ static void direct_link_animdata(FileData *fd, AnimData *adt)
 	//		state, but it's going to be too hard to enforce this single case...
 	adt->act_track = newdataadr(fd, adt->act_track);
 	adt->actstrip = newdataadr(fd, adt->actstrip);
-}	
+
+	/* runtime only, rebuilt on demand */
+	adt->rna_path_cache = NULL;
+}
 
 /* ************ READ MOTION PATHS *************** */
 
@@ -3569,7 +3788,7 @@ static void direct_link_vfont(FileData *fd, VFont *vf)
 {
 	vf->data = NULL;
 	vf->temp_pf = NULL;
-	vf->packedfile = direct_link_packedfile(fd, vf->packedfile);
+	vf->packedfile = direct_link_packedfile(fd, vf->packedfile, true);
 }
 
 /* ************ READ TEXT ****************** */
@@ -3678,12 +3897,12 @@ static void direct_link_image(FileData *fd, Image *ima)
 
 	if (ima->packedfiles.first) {
 		for (imapf = ima->packedfiles.first; imapf; imapf = imapf->next) {
-			imapf->packedfile = direct_link_packedfile(fd, imapf->packedfile);
+			imapf->packedfile = direct_link_packedfile(fd, imapf->packedfile, true);
 		}
 		ima->packedfile = NULL;
 	}
 	else {
-		ima->packedfile = direct_link_packedfile(fd, ima->packedfile);
+		ima->packedfile = direct_link_packedfile(fd, ima->packedfile, true);
 	}
 
 	BLI_listbase_clear(&ima->anims);
@@ -4269,6 +4488,7 @@ static void direct_link_particlesystems(FileData *fd, ListBase *particles)
 
 		psys->tree = NULL;
 		psys->bvhtree = NULL;
+		psys->sph_grid = NULL;
 	}
 	return;
 }
@@ -5217,6 +5437,11 @@ static void direct_link_modifiers(FileData *fd, ListBase *lb)
 			}
 			lmd->cache_system = NULL;
 		}
+		else if (md->type == eModifierType_LaplacianSmooth) {
+			LaplacianSmoothModifierData *smd = (LaplacianSmoothModifierData *)md;
+
+			smd->cache_system = NULL;
+		}
 		else if (md->type == eModifierType_CorrectiveSmooth) {
 			CorrectiveSmoothModifierData *csmd = (CorrectiveSmoothModifierData*)md;
 
@@ -5465,6 +5690,9 @@ static void direct_link_object(FileData *fd, Object *ob)
 	/* Runtime curve data  */
 	ob->curve_cache = NULL;
 
+	/* runtime only, rebuilt on demand */
+	ob->dupli_cache = NULL;
+
 	/* in case this value changes in future, clamp else we get undefined behavior */
 	CLAMP(ob->rotmode, ROT_MODE_MIN, ROT_MODE_MAX);
 
@@ -6082,6 +6310,7 @@ static void direct_link_windowmanager(FileData *fd, wmWindowManager *wm)
 	BLI_listbase_clear(&wm->operators);
 	BLI_listbase_clear(&wm->paintcursors);
 	BLI_listbase_clear(&wm->queue);
+	wm->notifier_queue_set = NULL;
 	BKE_reports_init(&wm->reports, RPT_STORE);
 	
 	BLI_listbase_clear(&wm->keyconfigs);
@@ -6380,68 +6609,53 @@ typedef enum ePointerUserMode {
 	USER_REAL   = 1,  /* ensure at least one real user (fake user ignored) */
 } ePointerUserMode;
 
-static bool restore_pointer(ID *id, ID *newid, ePointerUserMode user)
-{
-	if (STREQ(newid->name + 2, id->name + 2)) {
-		if (newid->lib == id->lib) {
-			if (user == USER_REAL) {
-				id_us_ensure_real(newid);
-			}
-			return true;
-		}
-	}
-	return false;
-}
-
 /**
  * Only for undo files, or to restore a screen after reading without UI...
  *
+ * \param id_map name/lib lookup map over newmain, so the (possibly many)
+ * pointers can be restored without walking the ID lists for each of them.
+ *
  * user
  * - USER_IGNORE: no usercount change
  * - USER_REAL: ensure a real user (even if a fake one is set)
  */
-static void *restore_pointer_by_name(Main *mainp, ID *id, ePointerUserMode user)
+static void *restore_pointer_by_name(struct IDNameLib_Map *id_map, ID *id, ePointerUserMode user)
 {
 	if (id) {
-		ListBase *lb = which_libbase(mainp, GS(id->name));
-		if (lb) {	// there's still risk of checking corrupt mem (freed Ids in oops)
-			ID *idn = lb->first;
-			
-			for (; idn; idn = idn->next) {
-				if (restore_pointer(id, idn, user))
-					break;
-			}
-			
-			return idn;
+		/* note: there's still risk of checking corrupt mem (freed Ids in oops) */
+		ID *idn = BKE_main_idmap_lookup_id(id_map, id);
+		if (idn && user == USER_REAL) {
+			id_us_ensure_real(idn);
 		}
+		return idn;
 	}
 	return NULL;
 }
 
-static void lib_link_seq_clipboard_pt_restore(ID *id, Main *newmain)
+static void lib_link_seq_clipboard_pt_restore(ID *id, struct IDNameLib_Map *id_map)
 {
 	if (id) {
 		/* clipboard must ensure this */
 		BLI_assert(id->newid != NULL);
-		id->newid = restore_pointer_by_name(newmain, (ID *)id->newid, USER_REAL);
+		id->newid = restore_pointer_by_name(id_map, (ID *)id->newid, USER_REAL);
 	}
 }
 static int lib_link_seq_clipboard_cb(Sequence *seq, void *arg_pt)
 {
-	Main *newmain = (Main *)arg_pt;
+	struct IDNameLib_Map *id_map = arg_pt;
 
-	lib_link_seq_clipboard_pt_restore((ID *)seq->scene, newmain);
-	lib_link_seq_clipboard_pt_restore((ID *)seq->scene_camera, newmain);
-	lib_link_seq_clipboard_pt_restore((ID *)seq->clip, newmain);
-	lib_link_seq_clipboard_pt_restore((ID *)seq->mask, newmain);
-	lib_link_seq_clipboard_pt_restore((ID *)seq->sound, newmain);
+	lib_link_seq_clipboard_pt_restore((ID *)seq->scene, id_map);
+	lib_link_seq_clipboard_pt_restore((ID *)seq->scene_camera, id_map);
+	lib_link_seq_clipboard_pt_restore((ID *)seq->clip, id_map);
+	lib_link_seq_clipboard_pt_restore((ID *)seq->mask, id_map);
+	lib_link_seq_clipboard_pt_restore((ID *)seq->sound, id_map);
 	return 1;
 }
 
-static void lib_link_clipboard_restore(Main *newmain)
+static void lib_link_clipboard_restore(struct IDNameLib_Map *id_map)
 {
 	/* update IDs stored in sequencer clipboard */
-	BKE_sequencer_base_recursive_apply(&seqbase_clipboard, lib_link_seq_clipboard_cb, newmain);
+	BKE_sequencer_base_recursive_apply(&seqbase_clipboard, lib_link_seq_clipboard_cb, id_map);
 }
 
 /* called from kernel/blender.c */
@@ -6453,11 +6667,12 @@ void blo_lib_link_screen_restore(Main *newmain, bScreen *curscreen, Scene *cursc
 	wmWindowManager *wm;
 	bScreen *sc;
 	ScrArea *sa;
-	
+	struct IDNameLib_Map *id_map = BKE_main_idmap_create(newmain);
+
 	/* first windowmanager */
 	for (wm = newmain->wm.first; wm; wm = wm->id.next) {
 		for (win= wm->windows.first; win; win= win->next) {
-			win->screen = restore_pointer_by_name(newmain, (ID *)win->screen, USER_REAL);
+			win->screen = restore_pointer_by_name(id_map, (ID *)win->screen, USER_REAL);
 			
 			if (win->screen == NULL)
 				win->screen = curscreen;
@@ -6470,7 +6685,7 @@ void blo_lib_link_screen_restore(Main *newmain, bScreen *curscreen, Scene *cursc
 	for (sc = newmain->screen.first; sc; sc = sc->id.next) {
 		Scene *oldscene = sc->scene;
 		
-		sc->scene= restore_pointer_by_name(newmain, (ID *)sc->scene, USER_REAL);
+		sc->scene= restore_pointer_by_name(id_map, (ID *)sc->scene, USER_REAL);
 		if (sc->scene == NULL)
 			sc->scene = curscene;
 		
@@ -6489,16 +6704,16 @@ void blo_lib_link_screen_restore(Main *newmain, bScreen *curscreen, Scene *cursc
 					if (v3d->scenelock)
 						v3d->camera = NULL; /* always get from scene */
 					else
-						v3d->camera = restore_pointer_by_name(newmain, (ID *)v3d->camera, USER_REAL);
+						v3d->camera = restore_pointer_by_name(id_map, (ID *)v3d->camera, USER_REAL);
 					if (v3d->camera == NULL)
 						v3d->camera = sc->scene->camera;
-					v3d->ob_centre = restore_pointer_by_name(newmain, (ID *)v3d->ob_centre, USER_REAL);
+					v3d->ob_centre = restore_pointer_by_name(id_map, (ID *)v3d->ob_centre, USER_REAL);
 					
 					for (bgpic= v3d->bgpicbase.first; bgpic; bgpic= bgpic->next) {
-						if ((bgpic->ima = restore_pointer_by_name(newmain, (ID *)bgpic->ima, USER_IGNORE))) {
+						if ((bgpic->ima = restore_pointer_by_name(id_map, (ID *)bgpic->ima, USER_IGNORE))) {
 							id_us_plus((ID *)bgpic->ima);
 						}
-						if ((bgpic->clip = restore_pointer_by_name(newmain, (ID *)bgpic->clip, USER_IGNORE))) {
+						if ((bgpic->clip = restore_pointer_by_name(id_map, (ID *)bgpic->clip, USER_IGNORE))) {
 							id_us_plus((ID *)bgpic->clip);
 						}
 					}
@@ -6542,10 +6757,10 @@ void blo_lib_link_screen_restore(Main *newmain, bScreen *curscreen, Scene *cursc
 					bDopeSheet *ads = sipo->ads;
 					
 					if (ads) {
-						ads->source = restore_pointer_by_name(newmain, (ID *)ads->source, USER_REAL);
+						ads->source = restore_pointer_by_name(id_map, (ID *)ads->source, USER_REAL);
 						
 						if (ads->filter_grp)
-							ads->filter_grp = restore_pointer_by_name(newmain, (ID *)ads->filter_grp, USER_IGNORE);
+							ads->filter_grp = restore_pointer_by_name(id_map, (ID *)ads->filter_grp, USER_IGNORE);
 					}
 					
 					/* force recalc of list of channels (i.e. includes calculating F-Curve colors)
@@ -6555,7 +6770,7 @@ void blo_lib_link_screen_restore(Main *newmain, bScreen *curscreen, Scene *cursc
 				}
 				else if (sl->spacetype == SPACE_BUTS) {
 					SpaceButs *sbuts = (SpaceButs *)sl;
-					sbuts->pinid = restore_pointer_by_name(newmain, sbuts->pinid, USER_IGNORE);
+					sbuts->pinid = restore_pointer_by_name(id_map, sbuts->pinid, USER_IGNORE);
 					if (sbuts->pinid == NULL) {
 						sbuts->flag &= ~SB_PIN_CONTEXT;
 					}
@@ -6572,11 +6787,11 @@ void blo_lib_link_screen_restore(Main *newmain, bScreen *curscreen, Scene *cursc
 				else if (sl->spacetype == SPACE_ACTION) {
 					SpaceAction *saction = (SpaceAction *)sl;
 					
-					saction->action = restore_pointer_by_name(newmain, (ID *)saction->action, USER_REAL);
-					saction->ads.source = restore_pointer_by_name(newmain, (ID *)saction->ads.source, USER_REAL);
+					saction->action = restore_pointer_by_name(id_map, (ID *)saction->action, USER_REAL);
+					saction->ads.source = restore_pointer_by_name(id_map, (ID *)saction->ads.source, USER_REAL);
 					
 					if (saction->ads.filter_grp)
-						saction->ads.filter_grp = restore_pointer_by_name(newmain, (ID *)saction->ads.filter_grp, USER_IGNORE);
+						saction->ads.filter_grp = restore_pointer_by_name(id_map, (ID *)saction->ads.filter_grp, USER_IGNORE);
 						
 					
 					/* force recalc of list of channels, potentially updating the active action 
@@ -6587,7 +6802,7 @@ void blo_lib_link_screen_restore(Main *newmain, bScreen *curscreen, Scene *cursc
 				else if (sl->spacetype == SPACE_IMAGE) {
 					SpaceImage *sima = (SpaceImage *)sl;
 					
-					sima->image = restore_pointer_by_name(newmain, (ID *)sima->image, USER_REAL);
+					sima->image = restore_pointer_by_name(id_map, (ID *)sima->image, USER_REAL);
 					
 					/* this will be freed, not worth attempting to find same scene,
 					 * since it gets initialized later */
@@ -6602,8 +6817,8 @@ void blo_lib_link_screen_restore(Main *newmain, bScreen *curscreen, Scene *cursc
 					/* NOTE: pre-2.5, this was local data not lib data, but now we need this as lib data
 					 * so assume that here we're doing for undo only...
 					 */
-					sima->gpd = restore_pointer_by_name(newmain, (ID *)sima->gpd, USER_REAL);
-					sima->mask_info.mask = restore_pointer_by_name(newmain, (ID *)sima->mask_info.mask, USER_REAL);
+					sima->gpd = restore_pointer_by_name(id_map, (ID *)sima->gpd, USER_REAL);
+					sima->mask_info.mask = restore_pointer_by_name(id_map, (ID *)sima->mask_info.mask, USER_REAL);
 				}
 				else if (sl->spacetype == SPACE_SEQ) {
 					SpaceSeq *sseq = (SpaceSeq *)sl;
@@ -6611,29 +6826,29 @@ void blo_lib_link_screen_restore(Main *newmain, bScreen *curscreen, Scene *cursc
 					/* NOTE: pre-2.5, this was local data not lib data, but now we need this as lib data
 					 * so assume that here we're doing for undo only...
 					 */
-					sseq->gpd = restore_pointer_by_name(newmain, (ID *)sseq->gpd, USER_REAL);
+					sseq->gpd = restore_pointer_by_name(id_map, (ID *)sseq->gpd, USER_REAL);
 				}
 				else if (sl->spacetype == SPACE_NLA) {
 					SpaceNla *snla = (SpaceNla *)sl;
 					bDopeSheet *ads = snla->ads;
 					
 					if (ads) {
-						ads->source = restore_pointer_by_name(newmain, (ID *)ads->source, USER_REAL);
+						ads->source = restore_pointer_by_name(id_map, (ID *)ads->source, USER_REAL);
 						
 						if (ads->filter_grp)
-							ads->filter_grp = restore_pointer_by_name(newmain, (ID *)ads->filter_grp, USER_IGNORE);
+							ads->filter_grp = restore_pointer_by_name(id_map, (ID *)ads->filter_grp, USER_IGNORE);
 					}
 				}
 				else if (sl->spacetype == SPACE_TEXT) {
 					SpaceText *st = (SpaceText *)sl;
 					
-					st->text = restore_pointer_by_name(newmain, (ID *)st->text, USER_REAL);
+					st->text = restore_pointer_by_name(id_map, (ID *)st->text, USER_REAL);
 					if (st->text == NULL) st->text = newmain->text.first;
 				}
 				else if (sl->spacetype == SPACE_SCRIPT) {
 					SpaceScript *scpt = (SpaceScript *)sl;
 					
-					scpt->script = restore_pointer_by_name(newmain, (ID *)scpt->script, USER_REAL);
+					scpt->script = restore_pointer_by_name(id_map, (ID *)scpt->script, USER_REAL);
 					
 					/*sc->script = NULL; - 2.45 set to null, better re-run the script */
 					if (scpt->script) {
@@ -6643,7 +6858,7 @@ void blo_lib_link_screen_restore(Main *newmain, bScreen *curscreen, Scene *cursc
 				else if (sl->spacetype == SPACE_OUTLINER) {
 					SpaceOops *so= (SpaceOops *)sl;
 					
-					so->search_tse.id = restore_pointer_by_name(newmain, so->search_tse.id, USER_IGNORE);
+					so->search_tse.id = restore_pointer_by_name(id_map, so->search_tse.id, USER_IGNORE);
 					
 					if (so->treestore) {
 						TreeStoreElem *tselem;
@@ -6653,7 +6868,7 @@ void blo_lib_link_screen_restore(Main *newmain, bScreen *curscreen, Scene *cursc
 						while ((tselem = BLI_mempool_iterstep(&iter))) {
 							/* Do not try to restore pointers to drivers/sequence/etc., can crash in undo case! */
 							if (TSE_IS_REAL_ID(tselem)) {
-								tselem->id = restore_pointer_by_name(newmain, tselem->id, USER_IGNORE);
+								tselem->id = restore_pointer_by_name(id_map, tselem->id, USER_IGNORE);
 							}
 							else {
 								tselem->id = NULL;
@@ -6671,14 +6886,14 @@ void blo_lib_link_screen_restore(Main *newmain, bScreen *curscreen, Scene *cursc
 					bNodeTree *ntree;
 					
 					/* node tree can be stored locally in id too, link this first */
-					snode->id = restore_pointer_by_name(newmain, snode->id, USER_REAL);
-					snode->from = restore_pointer_by_name(newmain, snode->from, USER_IGNORE);
+					snode->id = restore_pointer_by_name(id_map, snode->id, USER_REAL);
+					snode->from = restore_pointer_by_name(id_map, snode->from, USER_IGNORE);
 					
 					ntree = nodetree_from_id(snode->id);
 					if (ntree)
 						snode->nodetree = ntree;
 					else
-						snode->nodetree = restore_pointer_by_name(newmain, (ID*)snode->nodetree, USER_REAL);
+						snode->nodetree = restore_pointer_by_name(id_map, (ID*)snode->nodetree, USER_REAL);
 					
 					for (path = snode->treepath.first; path; path = path->next) {
 						if (path == snode->treepath.first) {
@@ -6686,7 +6901,7 @@ void blo_lib_link_screen_restore(Main *newmain, bScreen *curscreen, Scene *cursc
 							path->nodetree = snode->nodetree;
 						}
 						else
-							path->nodetree= restore_pointer_by_name(newmain, (ID*)path->nodetree, USER_REAL);
+							path->nodetree= restore_pointer_by_name(id_map, (ID*)path->nodetree, USER_REAL);
 						
 						if (!path->nodetree)
 							break;
@@ -6712,22 +6927,24 @@ void blo_lib_link_screen_restore(Main *newmain, bScreen *curscreen, Scene *cursc
 				else if (sl->spacetype == SPACE_CLIP) {
 					SpaceClip *sclip = (SpaceClip *)sl;
 					
-					sclip->clip = restore_pointer_by_name(newmain, (ID *)sclip->clip, USER_REAL);
-					sclip->mask_info.mask = restore_pointer_by_name(newmain, (ID *)sclip->mask_info.mask, USER_REAL);
+					sclip->clip = restore_pointer_by_name(id_map, (ID *)sclip->clip, USER_REAL);
+					sclip->mask_info.mask = restore_pointer_by_name(id_map, (ID *)sclip->mask_info.mask, USER_REAL);
 					
 					sclip->scopes.ok = 0;
 				}
 				else if (sl->spacetype == SPACE_LOGIC) {
 					SpaceLogic *slogic = (SpaceLogic *)sl;
 					
-					slogic->gpd = restore_pointer_by_name(newmain, (ID *)slogic->gpd, USER_REAL);
+					slogic->gpd = restore_pointer_by_name(id_map, (ID *)slogic->gpd, USER_REAL);
 				}
 			}
 		}
 	}
 
 	/* update IDs stored in all possible clipboards */
-	lib_link_clipboard_restore(newmain);
+	lib_link_clipboard_restore(id_map);
+
+	BKE_main_idmap_destroy(id_map);
 }
 
 static void direct_link_region(FileData *fd, ARegion *ar, int spacetype)
@@ -7159,7 +7376,8 @@ static void direct_link_library(FileData *fd, Library *lib, Main *main)
 //	printf("direct_link_library: name %s\n", lib->name);
 //	printf("direct_link_library: filepath %s\n", lib->filepath);
 	
-	lib->packedfile = direct_link_packedfile(fd, lib->packedfile);
+	/* library files are opened right away during reading, no use in lazy data */
+	lib->packedfile = direct_link_packedfile(fd, lib->packedfile, false);
 	
 	/* new main */
 	newmain = BKE_main_new();
@@ -7260,8 +7478,8 @@ static void direct_link_sound(FileData *fd, bSound *sound)
 	/* clear waveform loading flag */
 	sound->flags &= ~SOUND_FLAGS_WAVEFORM_LOADING;
 
-	sound->packedfile = direct_link_packedfile(fd, sound->packedfile);
-	sound->newpackedfile = direct_link_packedfile(fd, sound->newpackedfile);
+	sound->packedfile = direct_link_packedfile(fd, sound->packedfile, true);
+	sound->newpackedfile = direct_link_packedfile(fd, sound->newpackedfile, true);
 }
 
 static void lib_link_sound(FileData *fd, Main *main)
@@ -8195,6 +8413,48 @@ static void do_versions_userdef(FileData *fd, BlendFileData *bfd)
 	}
 }
 
+typedef struct VersionListData {
+	ID **ids;
+	BLOVersionIDFunc func;
+	void *userdata;
+} VersionListData;
+
+static void do_versions_listbase_cb(void *userdata, const int i)
+{
+	VersionListData *data = userdata;
+
+	data->func(data->ids[i], data->userdata);
+}
+
+/* Threaded helper for the versioning passes: runs func over every ID in lb.
+ * Only use it for fixups that patch each ID fully independently, without
+ * looking at Main or at other IDs. */
+void blo_do_versions_listbase_parallel(ListBase *lb, BLOVersionIDFunc func, void *userdata)
+{
+	VersionListData data;
+	ID **ids;
+	ID *id;
+	const int tot = BLI_listbase_count(lb);
+	int i;
+
+	if (tot == 0) {
+		return;
+	}
+
+	ids = MEM_mallocN(sizeof(ID *) * (size_t)tot, __func__);
+	for (id = lb->first, i = 0; id; id = id->next) {
+		ids[i++] = id;
+	}
+
+	data.ids = ids;
+	data.func = func;
+	data.userdata = userdata;
+
+	BLI_task_parallel_range(0, tot, &data, do_versions_listbase_cb, (tot > 64));
+
+	MEM_freeN(ids);
+}
+
 static void do_versions(FileData *fd, Library *lib, Main *main)
 {
 	/* WATCH IT!!!: pointers from libdata have not been converted */
@@ -8355,6 +8615,68 @@ static BHead *read_userdef(BlendFileData *bfd, FileData *fd, BHead *bhead)
 	return bhead;
 }
 
+/* Decoding a block (DNA reconstruction or a plain copy, see read_struct) is
+ * independent per block, only the linking passes need the blocks in order.
+ * So before the serial read_libblock loop runs, decode all DATA blocks across
+ * threads and stash the results in their BHeadN for read_struct to take over.
+ *
+ * Foreign endian files are excluded: switch_endian_structs modifies the block
+ * data in place, and a second read_struct call on the same block would switch
+ * it again. The lastfind cache in DNA_struct_find_nr is racy here, but it is
+ * only ever a valid struct index used as a search hint, so the worst case is
+ * a missed cache hit. */
+
+typedef struct BlockDecodeData {
+	FileData *fd;
+	BHeadN **blocks;
+} BlockDecodeData;
+
+static void decode_blocks_cb(void *userdata, const int i)
+{
+	BlockDecodeData *data = userdata;
+	BHeadN *new_bhead = data->blocks[i];
+
+	new_bhead->decoded = read_struct_decode(data->fd, &new_bhead->bhead, "Data from Lib Block");
+}
+
+static void decode_blocks_parallel(FileData *fd)
+{
+	BlockDecodeData data;
+	BHeadN **blocks;
+	BHead *bhead;
+	int tot = 0;
+
+	if (fd->flags & FD_FLAGS_SWITCH_ENDIAN) {
+		return;
+	}
+
+	/* walking the full list here forces reading of all blocks */
+	for (bhead = blo_firstbhead(fd); bhead; bhead = blo_nextbhead(fd, bhead)) {
+		if (bhead->code == DATA) {
+			tot++;
+		}
+	}
+
+	if (tot == 0) {
+		return;
+	}
+
+	blocks = MEM_mallocN(sizeof(*blocks) * tot, "decode_blocks_parallel");
+	tot = 0;
+	for (bhead = blo_firstbhead(fd); bhead; bhead = blo_nextbhead(fd, bhead)) {
+		if (bhead->code == DATA) {
+			blocks[tot++] = (BHeadN *)POINTER_OFFSET(bhead, -offsetof(BHeadN, bhead));
+		}
+	}
+
+	data.fd = fd;
+	data.blocks = blocks;
+
+	BLI_task_parallel_range(0, tot, &data, decode_blocks_cb, (tot > 1024));
+
+	MEM_freeN(blocks);
+}
+
 BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 {
 	BHead *bhead = blo_firstbhead(fd);
@@ -8389,6 +8711,11 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 		}
 	}
 
+	/* in the undo case most blocks are skipped, decode them on demand instead */
+	if (fd->memfile == NULL) {
+		decode_blocks_parallel(fd);
+	}
+
 	while (bhead) {
 		switch (bhead->code) {
 		case DATA:
@@ -8530,11 +8857,17 @@ static BHead *find_bhead_from_code_name(FileData *fd, const short idcode, const
 #ifdef USE_GHASH_BHEAD
 
 	char idname_full[MAX_ID_NAME];
+	BHead *bhead;
 
 	*((short *)idname_full) = idcode;
 	BLI_strncpy(idname_full + 2, name, sizeof(idname_full) - 2);
 
-	return BLI_ghash_lookup(fd->bhead_idname_hash, idname_full);
+	bhead = BLI_ghash_lookup(fd->bhead_idname_hash, idname_full);
+	if (bhead == NULL && fd->bhead_idname_scan) {
+		bhead = bhead_idname_map_scan(fd, idname_full);
+	}
+
+	return bhead;
 
 #else
 	BHead *bhead;
@@ -8558,7 +8891,13 @@ static BHead *find_bhead_from_code_name(FileData *fd, const short idcode, const
 static BHead *find_bhead_from_idname(FileData *fd, const char *idname)
 {
 #ifdef USE_GHASH_BHEAD
-	return BLI_ghash_lookup(fd->bhead_idname_hash, idname);
+	BHead *bhead = BLI_ghash_lookup(fd->bhead_idname_hash, idname);
+
+	if (bhead == NULL && fd->bhead_idname_scan) {
+		bhead = bhead_idname_map_scan(fd, idname);
+	}
+
+	return bhead;
 #else
 	return find_bhead_from_code_name(fd, GS(idname), idname + 2);
 #endif
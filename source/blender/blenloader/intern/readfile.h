@@ -92,8 +92,10 @@ typedef struct FileData {
 	struct BHeadSort *bheadmap;
 	int tot_bheadmap;
 
-	/* see: USE_GHASH_BHEAD */
+	/* see: USE_GHASH_BHEAD, filled in lazily,
+	 * bhead_idname_scan is where the next scan resumes (NULL when complete) */
 	struct GHash *bhead_idname_hash;
+	struct BHead *bhead_idname_scan;
 	
 	ListBase *mainlist;
 	ListBase *old_mainlist;  /* Used for undo. */
@@ -107,6 +109,11 @@ typedef struct FileData {
 
 typedef struct BHeadN {
 	struct BHeadN *next, *prev;
+	/* Usually points just behind this struct (the data is read into the same
+	 * allocation), but in memory mapped mode it points into the mapped file. */
+	const char *data;
+	/* Result of decode_blocks_parallel(), taken over by read_struct(). */
+	void *decoded;
 	struct BHead bhead;
 } BHeadN;
 
@@ -118,10 +125,39 @@ enum {
 	FD_FLAGS_FILE_OK               = 1 << 3,
 	FD_FLAGS_NOT_MY_BUFFER         = 1 << 4,
 	FD_FLAGS_NOT_MY_LIBMAP         = 1 << 5,  /* XXX Unused in practice (checked once but never set). */
+	FD_FLAGS_FILE_MEMMAPPED        = 1 << 6,  /* FileData.buffer is a read-only memory mapped file. */
 };
 
 #define SIZEOFBLENDERHEADER 12
 
+/**
+ * ID block index footer, appended after ENDB by uncompressed saves so
+ * browsing and linking can list datablocks without scanning the file:
+ * an array of BlendIdxEntry followed by a BlendIdxTrailer as the last
+ * bytes of the file. Readers stopping at ENDB never see it, old files
+ * simply have no trailer magic. All fields are 4 byte aligned so the
+ * layout does not depend on the platform, stored in native endianness
+ * (foreign endian readers fall back to scanning, like they do for the
+ * block data itself).
+ */
+typedef struct BlendIdxEntry {
+	int offset;  /* file offset of the ID BHead */
+	int code;    /* block code, e.g. ID_OB, also ID_ID for indirect libdata */
+	char name[68];  /* full id->name, 0-padded (MAX_ID_NAME + 2) */
+} BlendIdxEntry;
+
+typedef struct BlendIdxTrailer {
+	char magic[8];  /* BLEND_IDX_MAGIC, not 0-terminated */
+	int version;
+	int tot;
+} BlendIdxTrailer;
+
+#define BLEND_IDX_MAGIC "BlendIdx"
+#define BLEND_IDX_VERSION 1
+
+int blo_blendidx_tot(const FileData *fd);
+void blo_blendidx_get(const FileData *fd, int tot, int i, BlendIdxEntry *r_entry);
+
 /***/
 struct Main;
 void blo_join_main(ListBase *mainlist);
@@ -149,11 +185,17 @@ void blo_freefiledata(FileData *fd);
 BHead *blo_firstbhead(FileData *fd);
 BHead *blo_nextbhead(FileData *fd, BHead *thisblock);
 BHead *blo_prevbhead(FileData *fd, BHead *thisblock);
+const void *blo_bhead_data(const BHead *bhead);
 
 const char *bhead_id_name(const FileData *fd, const BHead *bhead);
 
 /* do versions stuff */
 
+/* Runs func over every ID in lb, from multiple threads when the list is
+ * long. Only for fixups where each ID is patched fully independently. */
+typedef void (*BLOVersionIDFunc)(struct ID *id, void *userdata);
+void blo_do_versions_listbase_parallel(ListBase *lb, BLOVersionIDFunc func, void *userdata);
+
 void blo_reportf_wrap(struct ReportList *reports, ReportType type, const char *format, ...) ATTR_PRINTF_FORMAT(3, 4);
 
 void blo_do_versions_oldnewmap_insert(struct OldNewMap *onm, void *oldaddr, void *newaddr, int nr);
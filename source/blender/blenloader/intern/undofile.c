@@ -40,6 +40,8 @@
 #include "DNA_listBase.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
 
 #include "BLO_undofile.h"
 
@@ -62,21 +64,30 @@ void BLO_memfile_free(MemFile *memfile)
 /* result is that 'first' is being freed */
 void BLO_memfile_merge(MemFile *first, MemFile *second)
 {
+	/* Match the chunks of 'first' that 'second' still references by their
+	 * buffer pointer: since chunks can be shared by content hash now, they
+	 * do not necessarily line up by list position anymore. */
+	GHash *buf_map = BLI_ghash_ptr_new(__func__);
 	MemFileChunk *fc, *sc;
-	
-	fc = first->chunks.first;
-	sc = second->chunks.first;
-	while (fc || sc) {
-		if (fc && sc) {
-			if (sc->ident) {
+
+	for (sc = second->chunks.first; sc; sc = sc->next) {
+		if (sc->ident && !BLI_ghash_haskey(buf_map, sc->buf)) {
+			BLI_ghash_insert(buf_map, sc->buf, sc);
+		}
+	}
+
+	for (fc = first->chunks.first; fc; fc = fc->next) {
+		if (fc->ident == 0) {
+			if ((sc = BLI_ghash_lookup(buf_map, fc->buf))) {
+				/* pass buffer ownership on to 'second' */
 				sc->ident = 0;
 				fc->ident = 1;
 			}
 		}
-		if (fc) fc = fc->next;
-		if (sc) sc = sc->next;
 	}
-	
+
+	BLI_ghash_free(buf_map, NULL, NULL);
+
 	BLO_memfile_free(first);
 }
 
@@ -97,35 +108,78 @@ static int my_memcmp(const int *mem1, const int *mem2, const int len)
 void memfile_chunk_add(MemFile *compare, MemFile *current, const char *buf, unsigned int size)
 {
 	static MemFileChunk *compchunk = NULL;
+	static GHash *comphash = NULL;
 	MemFileChunk *curchunk;
-	
+
 	/* this function inits when compare != NULL or when current == NULL  */
 	if (compare) {
+		if (comphash) {
+			BLI_ghash_free(comphash, NULL, NULL);
+			comphash = NULL;
+		}
 		compchunk = compare->chunks.first;
 		return;
 	}
 	if (current == NULL) {
+		if (comphash) {
+			BLI_ghash_free(comphash, NULL, NULL);
+			comphash = NULL;
+		}
 		compchunk = NULL;
 		return;
 	}
-	
+
 	curchunk = MEM_mallocN(sizeof(MemFileChunk), "MemFileChunk");
 	curchunk->size = size;
 	curchunk->buf = NULL;
 	curchunk->ident = 0;
+	curchunk->hash = BLI_hash_mm2((const unsigned char *)buf, size, 0);
 	BLI_addtail(&current->chunks, curchunk);
-	
+
 	/* we compare compchunk with buf */
 	if (compchunk) {
-		if (compchunk->size == curchunk->size) {
-			if (my_memcmp((int *)compchunk->buf, (const int *)buf, size / 4) == 0) {
-				curchunk->buf = compchunk->buf;
+		if ((compchunk->size == curchunk->size) &&
+		    (compchunk->hash == curchunk->hash) &&
+		    (my_memcmp((int *)compchunk->buf, (const int *)buf, size / 4) == 0))
+		{
+			curchunk->buf = compchunk->buf;
+			curchunk->ident = 1;
+			compchunk = compchunk->next;
+		}
+		else {
+			/* Chunk boundaries shifted, e.g. because data was added or removed
+			 * earlier in the file. Look the chunk up by content hash in the
+			 * remainder of the previous step to resynchronize, so everything
+			 * after a change can still be shared instead of copied again. */
+			MemFileChunk *foundchunk;
+
+			if (comphash == NULL) {
+				MemFileChunk *cc;
+
+				comphash = BLI_ghash_int_new("memfile_chunk_add gh");
+				for (cc = compchunk; cc; cc = cc->next) {
+					void **val_p;
+					if (!BLI_ghash_ensure_p(comphash, SET_UINT_IN_POINTER(cc->hash), &val_p)) {
+						*val_p = cc;
+					}
+				}
+			}
+
+			foundchunk = BLI_ghash_lookup(comphash, SET_UINT_IN_POINTER(curchunk->hash));
+			if (foundchunk &&
+			    (foundchunk->size == curchunk->size) &&
+			    (my_memcmp((int *)foundchunk->buf, (const int *)buf, size / 4) == 0))
+			{
+				curchunk->buf = foundchunk->buf;
 				curchunk->ident = 1;
+				compchunk = foundchunk->next;
+			}
+			else {
+				compchunk = compchunk->next;
 			}
 		}
-		compchunk = compchunk->next;
 	}
-	
+
 	/* not equal... */
 	if (curchunk->buf == NULL) {
 		curchunk->buf = MEM_mallocN(size, "Chunk buffer");
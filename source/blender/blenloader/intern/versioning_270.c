@@ -161,23 +161,59 @@ static void do_version_action_editor_properties_region(ListBase *regionbase)
 	}
 }
 
+/* Each of these only patches its own object, so the object list can be
+ * processed from multiple threads (see blo_do_versions_listbase_parallel). */
+
+static void do_version_bevel_profile_cb(ID *id, void *UNUSED(userdata))
+{
+	Object *ob = (Object *)id;
+	ModifierData *md;
+
+	for (md = ob->modifiers.first; md; md = md->next) {
+		if (md->type == eModifierType_Bevel) {
+			BevelModifierData *bmd = (BevelModifierData *)md;
+			bmd->profile = 0.5f;
+			bmd->val_flags = MOD_BEVEL_AMT_OFFSET;
+		}
+	}
+}
+
+static void do_version_constraints_270_1_cb(ID *id, void *UNUSED(userdata))
+{
+	Object *ob = (Object *)id;
+
+	do_version_constraints_radians_degrees_270_1(&ob->constraints);
+
+	if (ob->pose) {
+		/* Bones constraints! */
+		bPoseChannel *pchan;
+		for (pchan = ob->pose->chanbase.first; pchan; pchan = pchan->next) {
+			do_version_constraints_radians_degrees_270_1(&pchan->constraints);
+		}
+	}
+}
+
+static void do_version_constraints_270_5_cb(ID *id, void *UNUSED(userdata))
+{
+	Object *ob = (Object *)id;
+
+	do_version_constraints_radians_degrees_270_5(&ob->constraints);
+
+	if (ob->pose) {
+		/* Bones constraints! */
+		bPoseChannel *pchan;
+		for (pchan = ob->pose->chanbase.first; pchan; pchan = pchan->next) {
+			do_version_constraints_radians_degrees_270_5(&pchan->constraints);
+		}
+	}
+}
+
 void blo_do_versions_270(FileData *fd, Library *UNUSED(lib), Main *main)
 {
 	if (!MAIN_VERSION_ATLEAST(main, 270, 0)) {
 
 		if (!DNA_struct_elem_find(fd->filesdna, "BevelModifierData", "float", "profile")) {
-			Object *ob;
-
-			for (ob = main->object.first; ob; ob = ob->id.next) {
-				ModifierData *md;
-				for (md = ob->modifiers.first; md; md = md->next) {
-					if (md->type == eModifierType_Bevel) {
-						BevelModifierData *bmd = (BevelModifierData *)md;
-						bmd->profile = 0.5f;
-						bmd->val_flags = MOD_BEVEL_AMT_OFFSET;
-					}
-				}
-			}
+			blo_do_versions_listbase_parallel(&main->object, do_version_bevel_profile_cb, NULL);
 		}
 
 		/* nodes don't use fixed node->id any more, clean up */
@@ -221,20 +257,9 @@ void blo_do_versions_270(FileData *fd, Library *UNUSED(lib), Main *main)
 
 	if (!MAIN_VERSION_ATLEAST(main, 270, 1)) {
 		Scene *sce;
-		Object *ob;
 
 		/* Update Transform constraint (another deg -> rad stuff). */
-		for (ob = main->object.first; ob; ob = ob->id.next) {
-			do_version_constraints_radians_degrees_270_1(&ob->constraints);
-
-			if (ob->pose) {
-				/* Bones constraints! */
-				bPoseChannel *pchan;
-				for (pchan = ob->pose->chanbase.first; pchan; pchan = pchan->next) {
-					do_version_constraints_radians_degrees_270_1(&pchan->constraints);
-				}
-			}
-		}
+		blo_do_versions_listbase_parallel(&main->object, do_version_constraints_270_1_cb, NULL);
 
 		for (sce = main->scene.first; sce; sce = sce->id.next) {
 			if (sce->r.raytrace_structure == R_RAYSTRUCTURE_BLIBVH) {
@@ -286,20 +311,8 @@ void blo_do_versions_270(FileData *fd, Library *UNUSED(lib), Main *main)
 	}
 
 	if (!MAIN_VERSION_ATLEAST(main, 270, 5)) {
-		Object *ob;
-
 		/* Update Transform constraint (again :|). */
-		for (ob = main->object.first; ob; ob = ob->id.next) {
-			do_version_constraints_radians_degrees_270_5(&ob->constraints);
-
-			if (ob->pose) {
-				/* Bones constraints! */
-				bPoseChannel *pchan;
-				for (pchan = ob->pose->chanbase.first; pchan; pchan = pchan->next) {
-					do_version_constraints_radians_degrees_270_5(&pchan->constraints);
-				}
-			}
-		}
+		blo_do_versions_listbase_parallel(&main->object, do_version_constraints_270_5_cb, NULL);
 	}
 
 	if (!MAIN_VERSION_ATLEAST(main, 271, 0)) {
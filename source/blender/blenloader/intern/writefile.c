@@ -143,6 +143,7 @@
 #include "BLI_blenlib.h"
 #include "BLI_linklist.h"
 #include "BLI_mempool.h"
+#include "BLI_threads.h"
 
 #include "BKE_action.h"
 #include "BKE_blender_version.h"
@@ -154,6 +155,7 @@
 #include "BKE_library.h" // for  set_listbasepointers
 #include "BKE_main.h"
 #include "BKE_node.h"
+#include "BKE_packedFile.h"
 #include "BKE_report.h"
 #include "BKE_sequencer.h"
 #include "BKE_subsurf.h"
@@ -181,6 +183,15 @@
 #define MYWRITE_BUFFER_SIZE	100000
 #define MYWRITE_MAX_CHUNK	32768
 
+/* number of write buffers cycling between the serializer and the write
+ * thread for uncompressed saves, the serializer blocks when all of them
+ * are in flight (compressed saves size the pool by thread count) */
+#define MYWRITE_NUM_BUFFERS	4
+
+/* enough for a gzip member of an incompressible full buffer:
+ * deflate adds a few bytes per 16k block plus header and trailer */
+#define MYWRITE_ZBUF_SIZE	(MYWRITE_BUFFER_SIZE + (MYWRITE_BUFFER_SIZE / 1000) + 64)
+
 
 
 /** \name Small API to handle compression.
@@ -188,7 +199,6 @@
 
 typedef enum {
 	WW_WRAP_NONE = 1,
-	WW_WRAP_ZLIB,
 } eWriteWrapType;
 
 typedef struct WriteWrap WriteWrap;
@@ -201,7 +211,6 @@ struct WriteWrap {
 	/* internal */
 	union {
 		int file_handle;
-		gzFile gz_handle;
 	} _user_data;
 };
 
@@ -233,34 +242,6 @@ static size_t ww_write_none(WriteWrap *ww, const char *buf, size_t buf_len)
 }
 #undef FILE_HANDLE
 
-/* zlib */
-#define FILE_HANDLE(ww) \
-	(ww)->_user_data.gz_handle
-
-static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
-{
-	gzFile file;
-
-	file = BLI_gzopen(filepath, "wb1");
-
-	if (file != Z_NULL) {
-		FILE_HANDLE(ww) = file;
-		return true;
-	}
-	else {
-		return false;
-	}
-}
-static bool ww_close_zlib(WriteWrap *ww)
-{
-	return (gzclose(FILE_HANDLE(ww)) == Z_OK);
-}
-static size_t ww_write_zlib(WriteWrap *ww, const char *buf, size_t buf_len)
-{
-	return gzwrite(FILE_HANDLE(ww), buf, buf_len);
-}
-#undef FILE_HANDLE
-
 /* --- end compression types --- */
 
 static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
@@ -268,13 +249,6 @@ static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
 	memset(r_ww, 0, sizeof(*r_ww));
 
 	switch (ww_type) {
-		case WW_WRAP_ZLIB:
-		{
-			r_ww->open  = ww_open_zlib;
-			r_ww->close = ww_close_zlib;
-			r_ww->write = ww_write_zlib;
-			break;
-		}
 		default:
 		{
 			r_ww->open  = ww_open_none;
@@ -289,12 +263,22 @@ static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
 
 
 
+typedef struct WriteBuffer {
+	unsigned char *buf;
+	int len;
+	/* position of this buffer in the file, in buffer counts */
+	int seq;
+	/* compressed saves only: this buffer deflated as its own gzip member */
+	unsigned char *zbuf;
+	int zlen;
+} WriteBuffer;
+
 typedef struct {
 	struct SDNA *sdna;
 
 	unsigned char *buf;
 	MemFile *compare, *current;
-	
+
 	int tot, count, error;
 
 	/* Wrap writing, so we can use zlib or
@@ -302,12 +286,103 @@ typedef struct {
 	 * Will be NULL for UNDO. */
 	WriteWrap *ww;
 
+	/* Pipelined file writing (not used for UNDO): the serializer pushes
+	 * filled buffers onto comp_queue (compressed saves) or write_queue,
+	 * compressor threads deflate each buffer into an independent gzip
+	 * member, and the write thread writes the buffers back out in
+	 * serialization order, so saving does not block on I/O or compression.
+	 * Written out buffers come back via free_queue, wd->buf aliases
+	 * cur_wbuf->buf so mywrite() stays unaware of all this. */
+	WriteBuffer *wbufs;
+	WriteBuffer **stash;  /* write thread reordering, indexed by seq % numbufs */
+	int numbufs;
+	int seq_next;
+	WriteBuffer *cur_wbuf;
+	ThreadQueue *write_queue, *free_queue, *comp_queue;
+	ListBase write_threads, comp_threads;
+
+	/* ID block index footer (see readfile.h), collected while writing and
+	 * appended after ENDB, only for uncompressed file saves */
+	ListBase idx_entries;
+	int idx_tot;
+	bool idx_do;
+
 #ifdef USE_BMESH_SAVE_AS_COMPAT
 	char use_mesh_compat; /* option to save with older mesh format */
 #endif
 } WriteData;
 
-static WriteData *writedata_new(WriteWrap *ww)
+static void *writedata_do_compress_thread(void *wd_v)
+{
+	WriteData *wd = wd_v;
+	WriteBuffer *wbuf;
+
+	while ((wbuf = BLI_thread_queue_pop(wd->comp_queue))) {
+		z_stream strm;
+
+		memset(&strm, 0, sizeof(strm));
+
+		/* 16 + window size makes deflate produce a standard gzip member,
+		 * level 1 matches the "wb1" mode gzopen was opened with before.
+		 * Concatenated members are a valid gzip stream, so the file stays
+		 * readable by the existing (and older) load paths. */
+		if (deflateInit2(&strm, 1, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK) {
+			strm.next_in = wbuf->buf;
+			strm.avail_in = wbuf->len;
+			strm.next_out = wbuf->zbuf;
+			strm.avail_out = MYWRITE_ZBUF_SIZE;
+
+			if (deflate(&strm, Z_FINISH) == Z_STREAM_END) {
+				wbuf->zlen = MYWRITE_ZBUF_SIZE - (int)strm.avail_out;
+			}
+			else {
+				wd->error = 1;
+			}
+			deflateEnd(&strm);
+		}
+		else {
+			wd->error = 1;
+		}
+
+		BLI_thread_queue_push(wd->write_queue, wbuf);
+	}
+
+	return NULL;
+}
+
+static void *writedata_do_write_thread(void *wd_v)
+{
+	WriteData *wd = wd_v;
+	WriteBuffer *wbuf;
+	int seq = 0;
+
+	while ((wbuf = BLI_thread_queue_pop(wd->write_queue))) {
+		/* compressor threads finish in any order but the file needs the
+		 * buffers back in serialization order, so stash what came in and
+		 * write as far as the sequence has no gaps (at most numbufs buffers
+		 * are in flight, the slots can never collide) */
+		wd->stash[wbuf->seq % wd->numbufs] = wbuf;
+
+		while ((wbuf = wd->stash[seq % wd->numbufs])) {
+			const char *data = wbuf->zbuf ? (const char *)wbuf->zbuf : (const char *)wbuf->buf;
+			const int data_len = wbuf->zbuf ? wbuf->zlen : wbuf->len;
+
+			if (!wd->error) {
+				if (wd->ww->write(wd->ww, data, data_len) != data_len) {
+					wd->error = 1;
+				}
+			}
+
+			wd->stash[seq % wd->numbufs] = NULL;
+			seq++;
+			BLI_thread_queue_push(wd->free_queue, wbuf);
+		}
+	}
+
+	return NULL;
+}
+
+static WriteData *writedata_new(WriteWrap *ww, bool do_compress)
 {
 	WriteData *wd= MEM_callocN(sizeof(*wd), "writedata");
 
@@ -321,7 +396,45 @@ static WriteData *writedata_new(WriteWrap *ww)
 
 	wd->ww = ww;
 
-	wd->buf= MEM_mallocN(MYWRITE_BUFFER_SIZE, "wd->buf");
+	if (ww) {
+		const int totthread = do_compress ? BLI_system_thread_count() : 0;
+		int i;
+
+		/* enough buffers to keep all compressor threads busy */
+		wd->numbufs = do_compress ? (totthread * 2 + 2) : MYWRITE_NUM_BUFFERS;
+		wd->wbufs = MEM_callocN(sizeof(WriteBuffer) * wd->numbufs, "wd->wbufs");
+		wd->stash = MEM_callocN(sizeof(WriteBuffer *) * wd->numbufs, "wd->stash");
+
+		for (i = 0; i < wd->numbufs; i++) {
+			wd->wbufs[i].buf = MEM_mallocN(MYWRITE_BUFFER_SIZE, "wd->buf");
+			if (do_compress) {
+				wd->wbufs[i].zbuf = MEM_mallocN(MYWRITE_ZBUF_SIZE, "wd->zbuf");
+			}
+		}
+
+		wd->write_queue = BLI_thread_queue_init();
+		wd->free_queue = BLI_thread_queue_init();
+		for (i = 1; i < wd->numbufs; i++) {
+			BLI_thread_queue_push(wd->free_queue, &wd->wbufs[i]);
+		}
+
+		wd->cur_wbuf = &wd->wbufs[0];
+		wd->buf = wd->cur_wbuf->buf;
+
+		if (do_compress) {
+			wd->comp_queue = BLI_thread_queue_init();
+			BLI_init_threads(&wd->comp_threads, writedata_do_compress_thread, totthread);
+			for (i = 0; i < totthread; i++) {
+				BLI_insert_thread(&wd->comp_threads, wd);
+			}
+		}
+
+		BLI_init_threads(&wd->write_threads, writedata_do_write_thread, 1);
+		BLI_insert_thread(&wd->write_threads, wd);
+	}
+	else {
+		wd->buf= MEM_mallocN(MYWRITE_BUFFER_SIZE, "wd->buf");
+	}
 
 	return wd;
 }
@@ -335,18 +448,60 @@ static void writedata_do_write(WriteData *wd, const void *mem, int memlen)
 	if (wd->current) {
 		memfile_chunk_add(NULL, wd->current, mem, memlen);
 	}
+	else if (mem == wd->buf) {
+		/* the fill buffer is full: hand it to the pipeline and continue
+		 * filling a recycled one, blocks only when all buffers are in flight */
+		wd->cur_wbuf->len = memlen;
+		wd->cur_wbuf->seq = wd->seq_next++;
+		BLI_thread_queue_push(wd->comp_queue ? wd->comp_queue : wd->write_queue, wd->cur_wbuf);
+
+		wd->cur_wbuf = BLI_thread_queue_pop(wd->free_queue);
+		wd->buf = wd->cur_wbuf->buf;
+	}
 	else {
-		if (wd->ww->write(wd->ww, mem, memlen) != memlen) {
-			wd->error = 1;
-		}
+		/* a large chunk written from caller memory, unlike the synchronous
+		 * writer we have to copy it since the caller may modify or free it
+		 * before the write thread gets there (mywrite already splits these
+		 * into pieces well below the buffer size) */
+		WriteBuffer *wbuf = BLI_thread_queue_pop(wd->free_queue);
+
+		BLI_assert(memlen <= MYWRITE_BUFFER_SIZE);
+		memcpy(wbuf->buf, mem, memlen);
+		wbuf->len = memlen;
+		wbuf->seq = wd->seq_next++;
+		BLI_thread_queue_push(wd->comp_queue ? wd->comp_queue : wd->write_queue, wbuf);
 	}
 }
 
 static void writedata_free(WriteData *wd)
 {
+	if (wd->ww) {
+		int i;
+
+		/* the compressor and write threads were already joined in endwrite() */
+		if (wd->comp_queue) {
+			BLI_thread_queue_free(wd->comp_queue);
+		}
+		BLI_thread_queue_free(wd->write_queue);
+		BLI_thread_queue_free(wd->free_queue);
+
+		for (i = 0; i < wd->numbufs; i++) {
+			MEM_freeN(wd->wbufs[i].buf);
+			if (wd->wbufs[i].zbuf) {
+				MEM_freeN(wd->wbufs[i].zbuf);
+			}
+		}
+		MEM_freeN(wd->wbufs);
+		MEM_freeN(wd->stash);
+	}
+	else {
+		MEM_freeN(wd->buf);
+	}
+
+	BLI_freelistN(&wd->idx_entries);
+
 	DNA_sdna_free(wd->sdna);
 
-	MEM_freeN(wd->buf);
 	MEM_freeN(wd);
 }
 
@@ -412,9 +567,9 @@ static void mywrite(WriteData *wd, const void *adr, int len)
  * \param current The current memory file (can be NULL).
  * \warning Talks to other functions with global parameters
  */
-static WriteData *bgnwrite(WriteWrap *ww, MemFile *compare, MemFile *current)
+static WriteData *bgnwrite(WriteWrap *ww, MemFile *compare, MemFile *current, bool do_compress)
 {
-	WriteData *wd= writedata_new(ww);
+	WriteData *wd= writedata_new(ww, do_compress);
 
 	if (wd == NULL) return NULL;
 
@@ -440,7 +595,18 @@ static int endwrite(WriteData *wd)
 		writedata_do_write(wd, wd->buf, wd->count);
 		wd->count= 0;
 	}
-	
+
+	if (wd->ww) {
+		/* let the compressor and write threads drain their queues and join
+		 * them, only then wd->error covers the whole file */
+		if (wd->comp_queue) {
+			BLI_thread_queue_nowait(wd->comp_queue);
+			BLI_end_threads(&wd->comp_threads);
+		}
+		BLI_thread_queue_nowait(wd->write_queue);
+		BLI_end_threads(&wd->write_threads);
+	}
+
 	err= wd->error;
 	writedata_free(wd);
 
@@ -449,6 +615,38 @@ static int endwrite(WriteData *wd)
 
 /* ********** WRITE FILE ****************** */
 
+typedef struct IndexEntryLink {
+	struct IndexEntryLink *next, *prev;
+	BlendIdxEntry entry;
+} IndexEntryLink;
+
+static void write_index_entry_add(WriteData *wd, int filecode, const ID *id)
+{
+	IndexEntryLink *link = MEM_callocN(sizeof(*link), "IndexEntryLink");
+
+	link->entry.offset = wd->tot;
+	link->entry.code = filecode;
+	BLI_strncpy(link->entry.name, id->name, sizeof(link->entry.name));
+
+	BLI_addtail(&wd->idx_entries, link);
+	wd->idx_tot++;
+}
+
+static void write_index_footer(WriteData *wd)
+{
+	BlendIdxTrailer trailer;
+	IndexEntryLink *link;
+
+	for (link = wd->idx_entries.first; link; link = link->next) {
+		mywrite(wd, &link->entry, sizeof(link->entry));
+	}
+
+	memcpy(trailer.magic, BLEND_IDX_MAGIC, sizeof(trailer.magic));
+	trailer.version = BLEND_IDX_VERSION;
+	trailer.tot = wd->idx_tot;
+	mywrite(wd, &trailer, sizeof(trailer));
+}
+
 static void writestruct_at_address(WriteData *wd, int filecode, const char *structname, int nr, void *adr, void *data)
 {
 	BHead bh;
@@ -456,6 +654,12 @@ static void writestruct_at_address(WriteData *wd, int filecode, const char *stru
 
 	if (adr==NULL || data==NULL || nr==0) return;
 
+	/* ID blocks (and library placeholders) start with the ID struct,
+	 * record their name and position for the index footer */
+	if (wd->idx_do && (ELEM(filecode, ID_ID, ID_SCRN) || BKE_idcode_is_valid(filecode))) {
+		write_index_entry_add(wd, filecode, data);
+	}
+
 	/* init BHead */
 	bh.code= filecode;
 	bh.old= adr;
@@ -1733,6 +1937,31 @@ static void write_objects(WriteData *wd, ListBase *idbase)
 }
 
 
+static void write_packedfile(WriteData *wd, PackedFile *pf)
+{
+	void *data;
+
+	if (wd->current) {
+		/* Undo keeps the old data pointers alive through the packedmap (see
+		 * blo_make_packed_pointer_map), don't force lazy files into memory
+		 * for every undo push. */
+		data = pf->data;
+	}
+	else {
+		/* File saves need the actual bytes; lazy files not streaming from
+		 * the file being overwritten were left lazy by BLO_write_file(). */
+		data = acquirePackedFileData(pf);
+	}
+
+	writestruct(wd, DATA, "PackedFile", 1, pf);
+	if (data) {
+		writedata(wd, DATA, pf->size, data);
+		if (wd->current == NULL) {
+			releasePackedFileData(pf);
+		}
+	}
+}
+
 static void write_vfonts(WriteData *wd, ListBase *idbase)
 {
 	VFont *vf;
@@ -1749,8 +1978,7 @@ static void write_vfonts(WriteData *wd, ListBase *idbase)
 
 			if (vf->packedfile) {
 				pf = vf->packedfile;
-				writestruct(wd, DATA, "PackedFile", 1, pf);
-				writedata(wd, DATA, pf->size, pf->data);
+				write_packedfile(wd, pf);
 			}
 		}
 
@@ -2190,8 +2418,7 @@ static void write_images(WriteData *wd, ListBase *idbase)
 				writestruct(wd, DATA, "ImagePackedFile", 1, imapf);
 				if (imapf->packedfile) {
 					pf = imapf->packedfile;
-					writestruct(wd, DATA, "PackedFile", 1, pf);
-					writedata(wd, DATA, pf->size, pf->data);
+					write_packedfile(wd, pf);
 				}
 			}
 
@@ -2914,8 +3141,7 @@ static void write_libraries(WriteData *wd, Main *main)
 
 			if (main->curlib->packedfile) {
 				PackedFile *pf = main->curlib->packedfile;
-				writestruct(wd, DATA, "PackedFile", 1, pf);
-				writedata(wd, DATA, pf->size, pf->data);
+				write_packedfile(wd, pf);
 				if (wd->current == NULL)
 					printf("write packed .blend: %s\n", main->curlib->name);
 			}
@@ -3055,8 +3281,7 @@ static void write_sounds(WriteData *wd, ListBase *idbase)
 
 			if (sound->packedfile) {
 				pf = sound->packedfile;
-				writestruct(wd, DATA, "PackedFile", 1, pf);
-				writedata(wd, DATA, pf->size, pf->data);
+				write_packedfile(wd, pf);
 			}
 		}
 		sound= sound->id.next;
@@ -3700,7 +3925,11 @@ static int write_file_handle(
 
 	blo_split_main(&mainlist, mainvar);
 
-	wd = bgnwrite(ww, compare, current);
+	wd = bgnwrite(ww, compare, current, (ww && (write_flags & G_FILE_COMPRESS)));
+
+	/* uncompressed file saves get an ID index footer appended, the offsets
+	 * would be useless in a gzip stream so compressed saves skip it */
+	wd->idx_do = (ww != NULL && (write_flags & G_FILE_COMPRESS) == 0);
 
 #ifdef USE_BMESH_SAVE_AS_COMPAT
 	wd->use_mesh_compat = (write_flags & G_FILE_MESH_COMPAT) != 0;
@@ -3781,6 +4010,11 @@ static int write_file_handle(
 	bhead.code= ENDB;
 	mywrite(wd, &bhead, sizeof(BHead));
 
+	/* readers stop at ENDB, only index aware ones look behind it */
+	if (wd->idx_do) {
+		write_index_footer(wd);
+	}
+
 	blo_join_main(&mainlist);
 
 	return endwrite(wd);
@@ -3834,7 +4068,6 @@ bool BLO_write_file(
 {
 	char tempname[FILE_MAX+1];
 	int err, write_user_block;
-	eWriteWrapType ww_type;
 	WriteWrap ww;
 
 	/* path backup/restore */
@@ -3844,14 +4077,10 @@ bool BLO_write_file(
 	/* open temporary file, so we preserve the original in case we crash */
 	BLI_snprintf(tempname, sizeof(tempname), "%s@", filepath);
 
-	if (write_flags & G_FILE_COMPRESS) {
-		ww_type = WW_WRAP_ZLIB;
-	}
-	else {
-		ww_type = WW_WRAP_NONE;
-	}
-
-	ww_handle_init(ww_type, &ww);
+	/* compressed saves deflate their buffers into independent gzip members
+	 * on the compressor threads (see writedata_do_compress_thread), the
+	 * resulting stream is plain file I/O here either way */
+	ww_handle_init(WW_WRAP_NONE, &ww);
 
 	if (ww.open(&ww, tempname) == false) {
 		BKE_reportf(reports, RPT_ERROR, "Cannot open file %s for writing: %s", tempname, strerror(errno));
@@ -3911,6 +4140,11 @@ bool BLO_write_file(
 	}
 
 	/* file save to temporary file was successful */
+
+	/* lazy packed files streaming from the file we are about to replace must
+	 * be pulled into memory now, their stored offsets are about to go stale */
+	ensureAllPackedFiles(mainvar, filepath);
+
 	/* now do reverse file history (move .blend1 -> .blend2, .blend -> .blend1) */
 	if (write_flags & G_FILE_HISTORY) {
 		const bool err_hist = do_history(filepath, reports);
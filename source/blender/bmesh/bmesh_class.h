@@ -196,6 +196,11 @@ typedef struct BMesh {
 	 * or when it needs to be re-created */
 	char elem_table_dirty;
 
+	/* set by the low level topology functions in bmesh_core.c whenever loops
+	 * are created, freed or reordered, which invalidates the edit-mesh looptri
+	 * cache; cleared by a full tessellation pass in BKE_editmesh_tessface_calc */
+	char tess_dirty;
+
 
 	/* element pools */
 	struct BLI_mempool *vpool, *epool, *lpool, *fpool;
@@ -256,6 +256,7 @@ static BMLoop *bm_loop_create(
 
 	/* may add to middle of the pool */
 	bm->elem_index_dirty |= BM_LOOP;
+	bm->tess_dirty = true;
 
 	bm->totloop++;
 
@@ -816,6 +817,7 @@ static void bm_kill_only_loop(BMesh *bm, BMLoop *l)
 {
 	bm->totloop--;
 	bm->elem_index_dirty |= BM_LOOP;
+	bm->tess_dirty = true;
 	if (l->head.data)
 		CustomData_bmesh_free_block(&bm->ldata, &l->head.data);
 
@@ -1123,6 +1125,8 @@ static bool bm_loop_reverse_loop(
 
 	/* Loop indices are no more valid! */
 	bm->elem_index_dirty |= BM_LOOP;
+	/* neither is the looptri winding */
+	bm->tess_dirty = true;
 
 	return true;
 }
@@ -2211,6 +2215,7 @@ BMFace *bmesh_jfke(BMesh *bm, BMFace *f1, BMFace *f2, BMEdge *e)
 	bm->totface--;
 	/* account for both above */
 	bm->elem_index_dirty |= BM_EDGE | BM_LOOP | BM_FACE;
+	bm->tess_dirty = true;
 
 	BM_CHECK_ELEMENT(f1);
 
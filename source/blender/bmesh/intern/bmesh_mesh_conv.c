@@ -86,6 +86,7 @@
 #include "BLI_listbase.h"
 #include "BLI_alloca.h"
 #include "BLI_math_vector.h"
+#include "BLI_task.h"
 
 #include "BKE_mesh.h"
 #include "BKE_customdata.h"
@@ -576,6 +577,102 @@ BLI_INLINE void bmesh_quick_edgedraw_flag(MEdge *med, BMEdge *e)
 	}
 }
 
+/* number of elements above which the bm-to-me copy loops are threaded */
+#define BM_TO_MESH_THREADED_LIMIT 10240
+
+typedef struct BMToMeshTaskData {
+	BMesh *bm;
+	Mesh *me;
+	MVert *mvert;
+	MEdge *medge;
+	MPoly *mpoly;
+	MLoop *mloop;
+	int cd_vert_bweight_offset;
+	int cd_edge_bweight_offset;
+	int cd_edge_crease_offset;
+} BMToMeshTaskData;
+
+static void bm_to_mesh_verts_task_cb(void *userdata, const int i)
+{
+	BMToMeshTaskData *data = userdata;
+	BMesh *bm = data->bm;
+	BMVert *v = bm->vtable[i];
+	MVert *mvert = &data->mvert[i];
+
+	copy_v3_v3(mvert->co, v->co);
+	normal_float_to_short_v3(mvert->no, v->no);
+
+	mvert->flag = BM_vert_flag_to_mflag(v);
+
+	/* copy over customdata */
+	CustomData_from_bmesh_block(&bm->vdata, &data->me->vdata, v->head.data, i);
+
+	if (data->cd_vert_bweight_offset != -1) {
+		mvert->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, data->cd_vert_bweight_offset);
+	}
+
+	BM_CHECK_ELEMENT(v);
+}
+
+static void bm_to_mesh_edges_task_cb(void *userdata, const int i)
+{
+	BMToMeshTaskData *data = userdata;
+	BMesh *bm = data->bm;
+	BMEdge *e = bm->etable[i];
+	MEdge *med = &data->medge[i];
+
+	med->v1 = BM_elem_index_get(e->v1);
+	med->v2 = BM_elem_index_get(e->v2);
+
+	med->flag = BM_edge_flag_to_mflag(e);
+
+	/* copy over customdata */
+	CustomData_from_bmesh_block(&bm->edata, &data->me->edata, e->head.data, i);
+
+	bmesh_quick_edgedraw_flag(med, e);
+
+	if (data->cd_edge_crease_offset  != -1) med->crease  = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, data->cd_edge_crease_offset);
+	if (data->cd_edge_bweight_offset != -1) med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, data->cd_edge_bweight_offset);
+
+	BM_CHECK_ELEMENT(e);
+}
+
+static void bm_to_mesh_faces_task_cb(void *userdata, const int i)
+{
+	BMToMeshTaskData *data = userdata;
+	BMesh *bm = data->bm;
+	BMFace *f = bm->ftable[i];
+	MPoly *mpoly = &data->mpoly[i];
+	/* loopstart was precomputed by the caller */
+	MLoop *mloop = &data->mloop[mpoly->loopstart];
+	BMLoop *l_iter, *l_first;
+	int j = mpoly->loopstart;
+
+	mpoly->totloop = f->len;
+	mpoly->mat_nr = f->mat_nr;
+	mpoly->flag = BM_face_flag_to_mflag(f);
+
+	l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+	do {
+		mloop->e = BM_elem_index_get(l_iter->e);
+		mloop->v = BM_elem_index_get(l_iter->v);
+
+		/* copy over customdata */
+		CustomData_from_bmesh_block(&bm->ldata, &data->me->ldata, l_iter->head.data, j);
+
+		j++;
+		mloop++;
+		BM_CHECK_ELEMENT(l_iter);
+		BM_CHECK_ELEMENT(l_iter->e);
+		BM_CHECK_ELEMENT(l_iter->v);
+	} while ((l_iter = l_iter->next) != l_first);
+
+	/* copy over customdata */
+	CustomData_from_bmesh_block(&bm->pdata, &data->me->pdata, f->head.data, i);
+
+	BM_CHECK_ELEMENT(f);
+}
+
 void BM_mesh_bm_to_me(
         BMesh *bm, Mesh *me,
         const struct BMeshToMeshParams *params)
@@ -583,11 +680,10 @@ void BM_mesh_bm_to_me(
 	MLoop *mloop;
 	MPoly *mpoly;
 	MVert *mvert, *oldverts;
-	MEdge *med, *medge;
-	BMVert *v, *eve;
-	BMEdge *e;
-	BMFace *f;
+	MEdge *medge;
+	BMVert *eve;
 	BMIter iter;
+	BMToMeshTaskData task_data;
 	int i, j, ototvert;
 
 	const int cd_vert_bweight_offset = CustomData_get_offset(&bm->vdata, CD_BWEIGHT);
@@ -657,85 +753,41 @@ void BM_mesh_bm_to_me(
 	/* this is called again, 'dotess' arg is used there */
 	BKE_mesh_update_customdata_pointers(me, 0);
 
-	i = 0;
-	BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
-		copy_v3_v3(mvert->co, v->co);
-		normal_float_to_short_v3(mvert->no, v->no);
-
-		mvert->flag = BM_vert_flag_to_mflag(v);
-
-		BM_elem_index_set(v, i); /* set_inline */
-
-		/* copy over customdat */
-		CustomData_from_bmesh_block(&bm->vdata, &me->vdata, v->head.data, i);
-
-		if (cd_vert_bweight_offset != -1) mvert->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, cd_vert_bweight_offset);
-
-		i++;
-		mvert++;
-
-		BM_CHECK_ELEMENT(v);
-	}
-	bm->elem_index_dirty &= ~BM_VERT;
-
-	med = medge;
-	i = 0;
-	BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
-		med->v1 = BM_elem_index_get(e->v1);
-		med->v2 = BM_elem_index_get(e->v2);
-
-		med->flag = BM_edge_flag_to_mflag(e);
-
-		BM_elem_index_set(e, i); /* set_inline */
-
-		/* copy over customdata */
-		CustomData_from_bmesh_block(&bm->edata, &me->edata, e->head.data, i);
-
-		bmesh_quick_edgedraw_flag(med, e);
-
-		if (cd_edge_crease_offset  != -1) med->crease  = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_crease_offset);
-		if (cd_edge_bweight_offset != -1) med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_bweight_offset);
-
-		i++;
-		med++;
-		BM_CHECK_ELEMENT(e);
-	}
-	bm->elem_index_dirty &= ~BM_EDGE;
-
-	i = 0;
+	/* the index tables make every element independently addressable, which
+	 * lets the per-domain copy loops below run threaded */
+	BM_mesh_elem_index_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
+	BM_mesh_elem_table_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
+
+	task_data.bm = bm;
+	task_data.me = me;
+	task_data.mvert = mvert;
+	task_data.medge = medge;
+	task_data.mpoly = mpoly;
+	task_data.mloop = mloop;
+	task_data.cd_vert_bweight_offset = cd_vert_bweight_offset;
+	task_data.cd_edge_bweight_offset = cd_edge_bweight_offset;
+	task_data.cd_edge_crease_offset = cd_edge_crease_offset;
+
+	BLI_task_parallel_range(0, bm->totvert, &task_data, bm_to_mesh_verts_task_cb,
+	                        bm->totvert > BM_TO_MESH_THREADED_LIMIT);
+	BLI_task_parallel_range(0, bm->totedge, &task_data, bm_to_mesh_edges_task_cb,
+	                        bm->totedge > BM_TO_MESH_THREADED_LIMIT);
+
+	/* loopstart is a running sum over the face lengths, precompute it so the
+	 * faces (and the loop ranges they own) become independent of each other */
 	j = 0;
-	BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
-		BMLoop *l_iter, *l_first;
-		mpoly->loopstart = j;
-		mpoly->totloop = f->len;
-		mpoly->mat_nr = f->mat_nr;
-		mpoly->flag = BM_face_flag_to_mflag(f);
-
-		l_iter = l_first = BM_FACE_FIRST_LOOP(f);
-		do {
-			mloop->e = BM_elem_index_get(l_iter->e);
-			mloop->v = BM_elem_index_get(l_iter->v);
+	for (i = 0; i < bm->totface; i++) {
+		BMFace *f = bm->ftable[i];
 
-			/* copy over customdata */
-			CustomData_from_bmesh_block(&bm->ldata, &me->ldata, l_iter->head.data, j);
-
-			j++;
-			mloop++;
-			BM_CHECK_ELEMENT(l_iter);
-			BM_CHECK_ELEMENT(l_iter->e);
-			BM_CHECK_ELEMENT(l_iter->v);
-		} while ((l_iter = l_iter->next) != l_first);
+		mpoly[i].loopstart = j;
+		j += f->len;
 
 		if (f == bm->act_face) me->act_face = i;
-
-		/* copy over customdata */
-		CustomData_from_bmesh_block(&bm->pdata, &me->pdata, f->head.data, i);
-
-		i++;
-		mpoly++;
-		BM_CHECK_ELEMENT(f);
 	}
 
+	BLI_task_parallel_range(0, bm->totface, &task_data, bm_to_mesh_faces_task_cb,
+	                        bm->totface > BM_TO_MESH_THREADED_LIMIT);
+
 	/* patch hook indices and vertex parents */
 	if (ototvert > 0) {
 		Object *ob;
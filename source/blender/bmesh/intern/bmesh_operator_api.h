@@ -419,6 +419,14 @@ void *BMO_slot_buffer_get_single(BMOpSlot *slot);
 
 /* counts number of elements inside a slot array. */
 int BMO_slot_buffer_count(BMOpSlot slot_args[BMO_OP_MAX_SLOTS], const char *slot_name);
+
+/* parallel iteration over an element buffer slot, the callback must not
+ * modify topology; thread_id can index per-thread output accumulators */
+typedef void (*BMOParallelForFunc)(BMOperator *op, void *element, const int index,
+                                   void *userdata, const int thread_id);
+void BMO_slot_buffer_parallel_for(
+        BMOperator *op, BMOpSlot slot_args[BMO_OP_MAX_SLOTS], const char *slot_name,
+        BMOParallelForFunc func, void *userdata, const bool use_threading);
 int BMO_slot_map_count(BMOpSlot slot_args[BMO_OP_MAX_SLOTS], const char *slot_name);
 
 void BMO_slot_map_insert(
@@ -34,6 +34,7 @@
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
 #include "BLI_listbase.h"
+#include "BLI_task.h"
 
 #include "BLT_translation.h"
 
@@ -656,6 +657,50 @@ int BMO_slot_buffer_count(BMOpSlot slot_args[BMO_OP_MAX_SLOTS], const char *slot
 	return slot->len;
 }
 
+typedef struct BMOParallelForData {
+	BMOperator *op;
+	BMOpSlot *slot;
+	BMOParallelForFunc func;
+	void *userdata;
+} BMOParallelForData;
+
+static void bmo_slot_buffer_parallel_for_task_cb(
+        void *userdata, void *UNUSED(userdata_chunk), const int index, const int thread_id)
+{
+	BMOParallelForData *data = userdata;
+
+	data->func(data->op, data->slot->data.buf[index], index, data->userdata, thread_id);
+}
+
+/**
+ * Visit every element of an element buffer slot through the task scheduler.
+ *
+ * The callback runs concurrently for independent elements, so it must not
+ * create, free or flag elements, or touch anything of the mesh beyond the
+ * element it was handed. Per-thread output can be accumulated in arrays
+ * sized by #BLI_task_scheduler_num_threads and indexed by the callback's
+ * thread_id, to be merged by the caller afterwards.
+ */
+void BMO_slot_buffer_parallel_for(
+        BMOperator *op, BMOpSlot slot_args[BMO_OP_MAX_SLOTS], const char *slot_name,
+        BMOParallelForFunc func, void *userdata, const bool use_threading)
+{
+	BMOpSlot *slot = BMO_slot_get(slot_args, slot_name);
+	BMOParallelForData data;
+
+	BLI_assert(slot->slot_type == BMO_OP_SLOT_ELEMENT_BUF);
+
+	data.op = op;
+	data.slot = slot;
+	data.func = func;
+	data.userdata = userdata;
+
+	/* dynamic scheduling, since per-element workloads are typically uneven */
+	BLI_task_parallel_range_ex(0, slot->len, &data, NULL, 0,
+	                           bmo_slot_buffer_parallel_for_task_cb,
+	                           use_threading, true);
+}
+
 int BMO_slot_map_count(BMOpSlot slot_args[BMO_OP_MAX_SLOTS], const char *slot_name)
 {
 	BMOpSlot *slot = BMO_slot_get(slot_args, slot_name);
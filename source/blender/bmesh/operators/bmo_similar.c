@@ -33,6 +33,7 @@
 #include "DNA_meshdata_types.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "BKE_customdata.h"
 #include "BKE_deform.h"
@@ -87,30 +88,189 @@ static int bm_sel_similar_cmp_i(const int delta, const int compare)
 	}
 }
 
+#define FACE_MARK	1
+
+/* shared by the precompute and compare tasks below,
+ * all fields are read-only while the tasks run */
+typedef struct SimSel_FaceTaskData {
+	BMesh *bm;
+	SimSel_FaceExt *f_ext;
+	const int *indices;
+	int num_sels;
+	int type;
+	float thresh;
+	float thresh_radians;
+	int compare;
+} SimSel_FaceTaskData;
+
+/* fill the computed member of one SimSel_FaceExt, tasks never share an element */
+static void sel_similar_face_ext_task_cb(void *userdata, const int i)
+{
+	SimSel_FaceTaskData *data = userdata;
+	SimSel_FaceExt *f_ext = data->f_ext;
+
+	switch (data->type) {
+		case SIMFACE_PERIMETER:
+			/* set the perimeter */
+			f_ext[i].perim = BM_face_calc_perimeter(f_ext[i].f);
+			break;
+
+		case SIMFACE_COPLANAR:
+			/* compute the center of the polygon */
+			BM_face_calc_center_mean(f_ext[i].f, f_ext[i].c);
+
+			/* compute the plane distance */
+			f_ext[i].d = dot_v3v3(f_ext[i].f->no, f_ext[i].c);
+			break;
+
+		case SIMFACE_AREA:
+			f_ext[i].area = BM_face_calc_area(f_ext[i].f);
+			break;
+
+		case SIMFACE_IMAGE:
+			f_ext[i].t = NULL;
+			if (CustomData_has_layer(&(data->bm->pdata), CD_MTEXPOLY)) {
+				MTexPoly *mtpoly = CustomData_bmesh_get(&data->bm->pdata, f_ext[i].f->head.data, CD_MTEXPOLY);
+				f_ext[i].t = mtpoly->tpage;
+			}
+			break;
+	}
+}
+
+/* compare one unmarked face against the original selection;
+ * a task only writes the operator flag of its own face, so tasks don't interact */
+static void sel_similar_face_cmp_task_cb(void *userdata, const int i)
+{
+	SimSel_FaceTaskData *data = userdata;
+	BMesh *bm = data->bm;
+	SimSel_FaceExt *f_ext = data->f_ext;
+	const int *indices = data->indices;
+	const int type = data->type;
+	const float thresh = data->thresh;
+	BMFace *fm = f_ext[i].f;
+	float angle;
+
+	/* initial_elem - other_elem */
+	float delta_fl;
+	int   delta_i;
+	int idx;
+
+	if (!BMO_elem_flag_test(bm, fm, FACE_MARK) && !BM_elem_flag_test(fm, BM_ELEM_HIDDEN)) {
+		bool cont = true;
+		for (idx = 0; idx < data->num_sels && cont == true; idx++) {
+			BMFace *fs = f_ext[indices[idx]].f;
+			switch (type) {
+				case SIMFACE_MATERIAL:
+					if (fm->mat_nr == fs->mat_nr) {
+						BMO_elem_flag_enable(bm, fm, FACE_MARK);
+						cont = false;
+					}
+					break;
+
+				case SIMFACE_IMAGE:
+					if (f_ext[i].t == f_ext[indices[idx]].t) {
+						BMO_elem_flag_enable(bm, fm, FACE_MARK);
+						cont = false;
+					}
+					break;
+
+				case SIMFACE_NORMAL:
+					angle = angle_normalized_v3v3(fs->no, fm->no);	/* if the angle between the normals -> 0 */
+					if (angle <= data->thresh_radians) {
+						BMO_elem_flag_enable(bm, fm, FACE_MARK);
+						cont = false;
+					}
+					break;
+
+				case SIMFACE_COPLANAR:
+				{
+					float sign = 1.0f;
+					angle = angle_normalized_v3v3(fs->no, fm->no); /* angle -> 0 */
+					/* allow for normal pointing in either direction (just check the plane) */
+					if (angle > (float)M_PI * 0.5f) {
+						angle = (float)M_PI - angle;
+						sign = -1.0f;
+					}
+					if (angle <= data->thresh_radians) { /* and dot product difference -> 0 */
+						delta_fl = f_ext[i].d - (f_ext[indices[idx]].d * sign);
+						if (bm_sel_similar_cmp_fl(delta_fl, thresh, data->compare)) {
+							BMO_elem_flag_enable(bm, fm, FACE_MARK);
+							cont = false;
+						}
+					}
+					break;
+				}
+				case SIMFACE_AREA:
+					delta_fl = f_ext[i].area - f_ext[indices[idx]].area;
+					if (bm_sel_similar_cmp_fl(delta_fl, thresh, data->compare)) {
+						BMO_elem_flag_enable(bm, fm, FACE_MARK);
+						cont = false;
+					}
+					break;
+
+				case SIMFACE_SIDES:
+					delta_i = fm->len - fs->len;
+					if (bm_sel_similar_cmp_i(delta_i, data->compare)) {
+						BMO_elem_flag_enable(bm, fm, FACE_MARK);
+						cont = false;
+					}
+					break;
+
+				case SIMFACE_PERIMETER:
+					delta_fl = f_ext[i].perim - f_ext[indices[idx]].perim;
+					if (bm_sel_similar_cmp_fl(delta_fl, thresh, data->compare)) {
+						BMO_elem_flag_enable(bm, fm, FACE_MARK);
+						cont = false;
+					}
+					break;
+
+				case SIMFACE_SMOOTH:
+					if (BM_elem_flag_test(fm, BM_ELEM_SMOOTH) == BM_elem_flag_test(fs, BM_ELEM_SMOOTH)) {
+						BMO_elem_flag_enable(bm, fm, FACE_MARK);
+						cont = false;
+					}
+					break;
+#ifdef WITH_FREESTYLE
+				case SIMFACE_FREESTYLE:
+					if (CustomData_has_layer(&bm->pdata, CD_FREESTYLE_FACE)) {
+						FreestyleEdge *ffa1, *ffa2;
+
+						ffa1 = CustomData_bmesh_get(&bm->pdata, fs->head.data, CD_FREESTYLE_FACE);
+						ffa2 = CustomData_bmesh_get(&bm->pdata, fm->head.data, CD_FREESTYLE_FACE);
+
+						if (ffa1 && ffa2 && (ffa1->flag & FREESTYLE_FACE_MARK) == (ffa2->flag & FREESTYLE_FACE_MARK)) {
+							BMO_elem_flag_enable(bm, fm, FACE_MARK);
+							cont = false;
+						}
+					}
+					break;
+#endif
+				default:
+					BLI_assert(0);
+					break;
+			}
+		}
+	}
+}
+
 /*
  * Select similar faces, the choices are in the enum in source/blender/bmesh/bmesh_operators.h
  * We select either similar faces based on material, image, area, perimeter, normal, or the coplanar faces
  */
 void bmo_similar_faces_exec(BMesh *bm, BMOperator *op)
 {
-#define FACE_MARK	1
-
 	BMIter fm_iter;
 	BMFace *fs, *fm;
 	BMOIter fs_iter;
 	int num_sels = 0, num_total = 0, i = 0, idx = 0;
-	float angle = 0.0f;
 	SimSel_FaceExt *f_ext = NULL;
 	int *indices = NULL;
+	SimSel_FaceTaskData data;
 	const int type = BMO_slot_int_get(op->slots_in, "type");
 	const float thresh = BMO_slot_float_get(op->slots_in, "thresh");
 	const float thresh_radians = thresh * (float)M_PI;
 	const int compare = BMO_slot_int_get(op->slots_in, "compare");
 
-	/* initial_elem - other_elem */
-	float delta_fl;
-	int   delta_i;
-
 	num_total = BM_mesh_elem_count(bm, BM_FACE);
 
 	/*
@@ -141,178 +301,235 @@ void bmo_similar_faces_exec(BMesh *bm, BMOperator *op)
 		i++;
 	}
 
+	data.bm = bm;
+	data.f_ext = f_ext;
+	data.indices = indices;
+	data.num_sels = num_sels;
+	data.type = type;
+	data.thresh = thresh;
+	data.thresh_radians = thresh_radians;
+	data.compare = compare;
+
 	/*
 	 * Save us some computation burden: In case of perimeter/area/coplanar selection we compute
 	 * only once.
 	 */
 	if (type == SIMFACE_PERIMETER || type == SIMFACE_AREA || type == SIMFACE_COPLANAR || type == SIMFACE_IMAGE) {
-		for (i = 0; i < num_total; i++) {
+		BLI_task_parallel_range(0, num_total, &data, sel_similar_face_ext_task_cb, (num_total > 1024));
+	}
+
+	/* now select the rest (if any) */
+	BLI_task_parallel_range(0, num_total, &data, sel_similar_face_cmp_task_cb, (num_total > 1024));
+
+	MEM_freeN(f_ext);
+	MEM_freeN(indices);
+
+	/* transfer all marked faces to the output slot */
+	BMO_slot_buffer_from_enabled_flag(bm, op, op->slots_out, "faces.out", BM_FACE, FACE_MARK);
+}
+
+#undef FACE_MARK
+
+/**************************************************************************** *
+ * Similar Edges
+ **************************************************************************** */
+
+/*
+ * extra edge information
+ */
+typedef struct SimSel_EdgeExt {
+	BMEdge *e;
+	union {
+		float dir[3];
+		float angle;            /* angle between the face */
+	};
+
+	union {
+		float length;           /* edge length */
+		int   faces;            /* faces count */
+	};
+} SimSel_EdgeExt;
+
+#define EDGE_MARK	1
+
+/* shared by the precompute and compare tasks below,
+ * all fields are read-only while the tasks run */
+typedef struct SimSel_EdgeTaskData {
+	BMesh *bm;
+	SimSel_EdgeExt *e_ext;
+	const int *indices;
+	int num_sels;
+	int type;
+	float thresh;
+	int compare;
+} SimSel_EdgeTaskData;
+
+/* fill the computed members of one SimSel_EdgeExt, tasks never share an element */
+static void sel_similar_edge_ext_task_cb(void *userdata, const int i)
+{
+	SimSel_EdgeTaskData *data = userdata;
+	SimSel_EdgeExt *e_ext = data->e_ext;
+
+	switch (data->type) {
+		case SIMEDGE_LENGTH:	/* compute the length of the edge */
+			e_ext[i].length = len_v3v3(e_ext[i].e->v1->co, e_ext[i].e->v2->co);
+			break;
+
+		case SIMEDGE_DIR:		/* compute the direction */
+			sub_v3_v3v3(e_ext[i].dir, e_ext[i].e->v1->co, e_ext[i].e->v2->co);
+			normalize_v3(e_ext[i].dir);
+			break;
+
+		case SIMEDGE_FACE:		/* count the faces around the edge */
+			e_ext[i].faces = BM_edge_face_count(e_ext[i].e);
+			break;
+
+		case SIMEDGE_FACE_ANGLE:
+			e_ext[i].faces = BM_edge_face_count(e_ext[i].e);
+			if (e_ext[i].faces == 2)
+				e_ext[i].angle = BM_edge_calc_face_angle(e_ext[i].e);
+			break;
+	}
+}
+
+/* compare one unmarked edge against the original selection;
+ * a task only writes the operator flag of its own edge, so tasks don't interact */
+static void sel_similar_edge_cmp_task_cb(void *userdata, const int i)
+{
+	SimSel_EdgeTaskData *data = userdata;
+	BMesh *bm = data->bm;
+	SimSel_EdgeExt *e_ext = data->e_ext;
+	const int *indices = data->indices;
+	const int type = data->type;
+	const float thresh = data->thresh;
+	BMEdge *e = e_ext[i].e;
+	float angle;
+
+	/* initial_elem - other_elem */
+	float delta_fl;
+	int   delta_i;
+	int idx;
+
+	if (!BMO_elem_flag_test(bm, e, EDGE_MARK) && !BM_elem_flag_test(e, BM_ELEM_HIDDEN)) {
+		bool cont = true;
+		for (idx = 0; idx < data->num_sels && cont == true; idx++) {
+			BMEdge *es = e_ext[indices[idx]].e;
 			switch (type) {
-				case SIMFACE_PERIMETER:
-					/* set the perimeter */
-					f_ext[i].perim = BM_face_calc_perimeter(f_ext[i].f);
+				case SIMEDGE_LENGTH:
+					delta_fl = e_ext[i].length - e_ext[indices[idx]].length;
+					if (bm_sel_similar_cmp_fl(delta_fl, thresh, data->compare)) {
+						BMO_elem_flag_enable(bm, e, EDGE_MARK);
+						cont = false;
+					}
 					break;
 
-				case SIMFACE_COPLANAR:
-					/* compute the center of the polygon */
-					BM_face_calc_center_mean(f_ext[i].f, f_ext[i].c);
+				case SIMEDGE_DIR:
+					/* compute the angle between the two edges */
+					angle = angle_normalized_v3v3(e_ext[i].dir, e_ext[indices[idx]].dir);
 
-					/* compute the plane distance */
-					f_ext[i].d = dot_v3v3(f_ext[i].f->no, f_ext[i].c);
-					break;
+					if (angle > (float)M_PI_2) /* use the smallest angle between the edges */
+						angle = fabsf(angle - (float)M_PI);
 
-				case SIMFACE_AREA:
-					f_ext[i].area = BM_face_calc_area(f_ext[i].f);
+					if (angle / (float)M_PI_2 <= thresh) {
+						BMO_elem_flag_enable(bm, e, EDGE_MARK);
+						cont = false;
+					}
 					break;
 
-				case SIMFACE_IMAGE:
-					f_ext[i].t = NULL;
-					if (CustomData_has_layer(&(bm->pdata), CD_MTEXPOLY)) {
-						MTexPoly *mtpoly = CustomData_bmesh_get(&bm->pdata, f_ext[i].f->head.data, CD_MTEXPOLY);
-						f_ext[i].t = mtpoly->tpage;
+				case SIMEDGE_FACE:
+					delta_i = e_ext[i].faces - e_ext[indices[idx]].faces;
+					if (bm_sel_similar_cmp_i(delta_i, data->compare)) {
+						BMO_elem_flag_enable(bm, e, EDGE_MARK);
+						cont = false;
 					}
 					break;
-			}
-		}
-	}
 
-	/* now select the rest (if any) */
-	for (i = 0; i < num_total; i++) {
-		fm = f_ext[i].f;
-		if (!BMO_elem_flag_test(bm, fm, FACE_MARK) && !BM_elem_flag_test(fm, BM_ELEM_HIDDEN)) {
-			bool cont = true;
-			for (idx = 0; idx < num_sels && cont == true; idx++) {
-				fs = f_ext[indices[idx]].f;
-				switch (type) {
-					case SIMFACE_MATERIAL:
-						if (fm->mat_nr == fs->mat_nr) {
-							BMO_elem_flag_enable(bm, fm, FACE_MARK);
-							cont = false;
+				case SIMEDGE_FACE_ANGLE:
+					if (e_ext[i].faces == 2) {
+						if (e_ext[indices[idx]].faces == 2) {
+							if (fabsf(e_ext[i].angle - e_ext[indices[idx]].angle) <= thresh) {
+								BMO_elem_flag_enable(bm, e, EDGE_MARK);
+								cont = false;
+							}
 						}
-						break;
+					}
+					else {
+						cont = false;
+					}
+					break;
 
-					case SIMFACE_IMAGE:
-						if (f_ext[i].t == f_ext[indices[idx]].t) {
-							BMO_elem_flag_enable(bm, fm, FACE_MARK);
-							cont = false;
-						}
-						break;
+				case SIMEDGE_CREASE:
+					{
+						const float *c1, *c2;
 
-					case SIMFACE_NORMAL:
-						angle = angle_normalized_v3v3(fs->no, fm->no);	/* if the angle between the normals -> 0 */
-						if (angle <= thresh_radians) {
-							BMO_elem_flag_enable(bm, fm, FACE_MARK);
+						c1 = CustomData_bmesh_get(&bm->edata, e->head.data, CD_CREASE);
+						c2 = CustomData_bmesh_get(&bm->edata, es->head.data, CD_CREASE);
+						delta_fl = *c1 - *c2;
+
+						if (bm_sel_similar_cmp_fl(delta_fl, thresh, data->compare)) {
+							BMO_elem_flag_enable(bm, e, EDGE_MARK);
 							cont = false;
 						}
-						break;
+					}
+					break;
 
-					case SIMFACE_COPLANAR:
+				case SIMEDGE_BEVEL:
 					{
-						float sign = 1.0f;
-						angle = angle_normalized_v3v3(fs->no, fm->no); /* angle -> 0 */
-						/* allow for normal pointing in either direction (just check the plane) */
-						if (angle > (float)M_PI * 0.5f) {
-							angle = (float)M_PI - angle;
-							sign = -1.0f;
-						}
-						if (angle <= thresh_radians) { /* and dot product difference -> 0 */
-							delta_fl = f_ext[i].d - (f_ext[indices[idx]].d * sign);
-							if (bm_sel_similar_cmp_fl(delta_fl, thresh, compare)) {
-								BMO_elem_flag_enable(bm, fm, FACE_MARK);
-								cont = false;
-							}
-						}
-						break;
-					}
-					case SIMFACE_AREA:
-						delta_fl = f_ext[i].area - f_ext[indices[idx]].area;
-						if (bm_sel_similar_cmp_fl(delta_fl, thresh, compare)) {
-							BMO_elem_flag_enable(bm, fm, FACE_MARK);
-							cont = false;
-						}
-						break;
+						const float *c1, *c2;
 
-					case SIMFACE_SIDES:
-						delta_i = fm->len - fs->len;
-						if (bm_sel_similar_cmp_i(delta_i, compare)) {
-							BMO_elem_flag_enable(bm, fm, FACE_MARK);
-							cont = false;
-						}
-						break;
+						c1 = CustomData_bmesh_get(&bm->edata, e->head.data, CD_BWEIGHT);
+						c2 = CustomData_bmesh_get(&bm->edata, es->head.data, CD_BWEIGHT);
+						delta_fl = *c1 - *c2;
 
-					case SIMFACE_PERIMETER:
-						delta_fl = f_ext[i].perim - f_ext[indices[idx]].perim;
-						if (bm_sel_similar_cmp_fl(delta_fl, thresh, compare)) {
-							BMO_elem_flag_enable(bm, fm, FACE_MARK);
+						if (bm_sel_similar_cmp_fl(delta_fl, thresh, data->compare)) {
+							BMO_elem_flag_enable(bm, e, EDGE_MARK);
 							cont = false;
 						}
-						break;
+					}
+					break;
 
-					case SIMFACE_SMOOTH:
-						if (BM_elem_flag_test(fm, BM_ELEM_SMOOTH) == BM_elem_flag_test(fs, BM_ELEM_SMOOTH)) {
-							BMO_elem_flag_enable(bm, fm, FACE_MARK);
-							cont = false;
-						}
-						break;
+				case SIMEDGE_SEAM:
+					if (BM_elem_flag_test(e, BM_ELEM_SEAM) == BM_elem_flag_test(es, BM_ELEM_SEAM)) {
+						BMO_elem_flag_enable(bm, e, EDGE_MARK);
+						cont = false;
+					}
+					break;
+
+				case SIMEDGE_SHARP:
+					if (BM_elem_flag_test(e, BM_ELEM_SMOOTH) == BM_elem_flag_test(es, BM_ELEM_SMOOTH)) {
+						BMO_elem_flag_enable(bm, e, EDGE_MARK);
+						cont = false;
+					}
+					break;
 #ifdef WITH_FREESTYLE
-					case SIMFACE_FREESTYLE:
-						if (CustomData_has_layer(&bm->pdata, CD_FREESTYLE_FACE)) {
-							FreestyleEdge *ffa1, *ffa2;
+				case SIMEDGE_FREESTYLE:
+					if (CustomData_has_layer(&bm->edata, CD_FREESTYLE_EDGE)) {
+						FreestyleEdge *fed1, *fed2;
 
-							ffa1 = CustomData_bmesh_get(&bm->pdata, fs->head.data, CD_FREESTYLE_FACE);
-							ffa2 = CustomData_bmesh_get(&bm->pdata, fm->head.data, CD_FREESTYLE_FACE);
+						fed1 = CustomData_bmesh_get(&bm->edata, e->head.data, CD_FREESTYLE_EDGE);
+						fed2 = CustomData_bmesh_get(&bm->edata, es->head.data, CD_FREESTYLE_EDGE);
 
-							if (ffa1 && ffa2 && (ffa1->flag & FREESTYLE_FACE_MARK) == (ffa2->flag & FREESTYLE_FACE_MARK)) {
-								BMO_elem_flag_enable(bm, fm, FACE_MARK);
-								cont = false;
-							}
+						if (fed1 && fed2 && (fed1->flag & FREESTYLE_EDGE_MARK) == (fed2->flag & FREESTYLE_EDGE_MARK)) {
+							BMO_elem_flag_enable(bm, e, EDGE_MARK);
+							cont = false;
 						}
-						break;
+					}
+					break;
 #endif
-					default:
-						BLI_assert(0);
-						break;
-				}
+				default:
+					BLI_assert(0);
+					break;
 			}
 		}
 	}
-
-	MEM_freeN(f_ext);
-	MEM_freeN(indices);
-
-	/* transfer all marked faces to the output slot */
-	BMO_slot_buffer_from_enabled_flag(bm, op, op->slots_out, "faces.out", BM_FACE, FACE_MARK);
-#undef FACE_MARK
 }
 
-/**************************************************************************** *
- * Similar Edges
- **************************************************************************** */
-
-/*
- * extra edge information
- */
-typedef struct SimSel_EdgeExt {
-	BMEdge *e;
-	union {
-		float dir[3];
-		float angle;            /* angle between the face */
-	};
-
-	union {
-		float length;           /* edge length */
-		int   faces;            /* faces count */
-	};
-} SimSel_EdgeExt;
-
 /*
  * select similar edges: the choices are in the enum in source/blender/bmesh/bmesh_operators.h
  * choices are length, direction, face, ...
  */
 void bmo_similar_edges_exec(BMesh *bm, BMOperator *op)
 {
-#define EDGE_MARK	1
-
 	BMOIter es_iter;	/* selected edges iterator */
 	BMIter e_iter;		/* mesh edges iterator */
 	BMEdge *es;		/* selected edge */
@@ -320,18 +537,13 @@ void bmo_similar_edges_exec(BMesh *bm, BMOperator *op)
 	int idx = 0, i = 0 /* , f = 0 */;
 	int *indices = NULL;
 	SimSel_EdgeExt *e_ext = NULL;
-	// float *angles = NULL;
-	float angle;
+	SimSel_EdgeTaskData data;
 
 	int num_sels = 0, num_total = 0;
 	const int type = BMO_slot_int_get(op->slots_in, "type");
 	const float thresh = BMO_slot_float_get(op->slots_in, "thresh");
 	const int compare = BMO_slot_int_get(op->slots_in, "compare");
 
-	/* initial_elem - other_elem */
-	float delta_fl;
-	int   delta_i;
-
 	/* sanity checks that the data we need is available */
 	switch (type) {
 		case SIMEDGE_CREASE:
@@ -368,157 +580,30 @@ void bmo_similar_edges_exec(BMesh *bm, BMOperator *op)
 		i++;
 	}
 
+	data.bm = bm;
+	data.e_ext = e_ext;
+	data.indices = indices;
+	data.num_sels = num_sels;
+	data.type = type;
+	data.thresh = thresh;
+	data.compare = compare;
+
 	/* save us some computation time by doing heavy computation once */
 	if (type == SIMEDGE_LENGTH || type == SIMEDGE_FACE || type == SIMEDGE_DIR || type == SIMEDGE_FACE_ANGLE) {
-		for (i = 0; i < num_total; i++) {
-			switch (type) {
-				case SIMEDGE_LENGTH:	/* compute the length of the edge */
-					e_ext[i].length = len_v3v3(e_ext[i].e->v1->co, e_ext[i].e->v2->co);
-					break;
-
-				case SIMEDGE_DIR:		/* compute the direction */
-					sub_v3_v3v3(e_ext[i].dir, e_ext[i].e->v1->co, e_ext[i].e->v2->co);
-					normalize_v3(e_ext[i].dir);
-					break;
-
-				case SIMEDGE_FACE:		/* count the faces around the edge */
-					e_ext[i].faces = BM_edge_face_count(e_ext[i].e);
-					break;
-
-				case SIMEDGE_FACE_ANGLE:
-					e_ext[i].faces = BM_edge_face_count(e_ext[i].e);
-					if (e_ext[i].faces == 2)
-						e_ext[i].angle = BM_edge_calc_face_angle(e_ext[i].e);
-					break;
-			}
-		}
+		BLI_task_parallel_range(0, num_total, &data, sel_similar_edge_ext_task_cb, (num_total > 1024));
 	}
 
 	/* select the edges if any */
-	for (i = 0; i < num_total; i++) {
-		e = e_ext[i].e;
-		if (!BMO_elem_flag_test(bm, e, EDGE_MARK) && !BM_elem_flag_test(e, BM_ELEM_HIDDEN)) {
-			bool cont = true;
-			for (idx = 0; idx < num_sels && cont == true; idx++) {
-				es = e_ext[indices[idx]].e;
-				switch (type) {
-					case SIMEDGE_LENGTH:
-						delta_fl = e_ext[i].length - e_ext[indices[idx]].length;
-						if (bm_sel_similar_cmp_fl(delta_fl, thresh, compare)) {
-							BMO_elem_flag_enable(bm, e, EDGE_MARK);
-							cont = false;
-						}
-						break;
-
-					case SIMEDGE_DIR:
-						/* compute the angle between the two edges */
-						angle = angle_normalized_v3v3(e_ext[i].dir, e_ext[indices[idx]].dir);
-
-						if (angle > (float)M_PI_2) /* use the smallest angle between the edges */
-							angle = fabsf(angle - (float)M_PI);
-
-						if (angle / (float)M_PI_2 <= thresh) {
-							BMO_elem_flag_enable(bm, e, EDGE_MARK);
-							cont = false;
-						}
-						break;
-
-					case SIMEDGE_FACE:
-						delta_i = e_ext[i].faces - e_ext[indices[idx]].faces;
-						if (bm_sel_similar_cmp_i(delta_i, compare)) {
-							BMO_elem_flag_enable(bm, e, EDGE_MARK);
-							cont = false;
-						}
-						break;
-
-					case SIMEDGE_FACE_ANGLE:
-						if (e_ext[i].faces == 2) {
-							if (e_ext[indices[idx]].faces == 2) {
-								if (fabsf(e_ext[i].angle - e_ext[indices[idx]].angle) <= thresh) {
-									BMO_elem_flag_enable(bm, e, EDGE_MARK);
-									cont = false;
-								}
-							}
-						}
-						else {
-							cont = false;
-						}
-						break;
-
-					case SIMEDGE_CREASE:
-						{
-							const float *c1, *c2;
-
-							c1 = CustomData_bmesh_get(&bm->edata, e->head.data, CD_CREASE);
-							c2 = CustomData_bmesh_get(&bm->edata, es->head.data, CD_CREASE);
-							delta_fl = *c1 - *c2;
-
-							if (bm_sel_similar_cmp_fl(delta_fl, thresh, compare)) {
-								BMO_elem_flag_enable(bm, e, EDGE_MARK);
-								cont = false;
-							}
-						}
-						break;
-
-					case SIMEDGE_BEVEL:
-						{
-							const float *c1, *c2;
-
-							c1 = CustomData_bmesh_get(&bm->edata, e->head.data, CD_BWEIGHT);
-							c2 = CustomData_bmesh_get(&bm->edata, es->head.data, CD_BWEIGHT);
-							delta_fl = *c1 - *c2;
-
-							if (bm_sel_similar_cmp_fl(delta_fl, thresh, compare)) {
-								BMO_elem_flag_enable(bm, e, EDGE_MARK);
-								cont = false;
-							}
-						}
-						break;
-
-					case SIMEDGE_SEAM:
-						if (BM_elem_flag_test(e, BM_ELEM_SEAM) == BM_elem_flag_test(es, BM_ELEM_SEAM)) {
-							BMO_elem_flag_enable(bm, e, EDGE_MARK);
-							cont = false;
-						}
-						break;
-
-					case SIMEDGE_SHARP:
-						if (BM_elem_flag_test(e, BM_ELEM_SMOOTH) == BM_elem_flag_test(es, BM_ELEM_SMOOTH)) {
-							BMO_elem_flag_enable(bm, e, EDGE_MARK);
-							cont = false;
-						}
-						break;
-#ifdef WITH_FREESTYLE
-					case SIMEDGE_FREESTYLE:
-						if (CustomData_has_layer(&bm->edata, CD_FREESTYLE_EDGE)) {
-							FreestyleEdge *fed1, *fed2;
-
-							fed1 = CustomData_bmesh_get(&bm->edata, e->head.data, CD_FREESTYLE_EDGE);
-							fed2 = CustomData_bmesh_get(&bm->edata, es->head.data, CD_FREESTYLE_EDGE);
-
-							if (fed1 && fed2 && (fed1->flag & FREESTYLE_EDGE_MARK) == (fed2->flag & FREESTYLE_EDGE_MARK)) {
-								BMO_elem_flag_enable(bm, e, EDGE_MARK);
-								cont = false;
-							}
-						}
-						break;
-#endif
-					default:
-						BLI_assert(0);
-						break;
-				}
-			}
-		}
-	}
+	BLI_task_parallel_range(0, num_total, &data, sel_similar_edge_cmp_task_cb, (num_total > 1024));
 
 	MEM_freeN(e_ext);
 	MEM_freeN(indices);
 
 	/* transfer all marked edges to the output slot */
 	BMO_slot_buffer_from_enabled_flag(bm, op, op->slots_out, "edges.out", BM_EDGE, EDGE_MARK);
+}
 
 #undef EDGE_MARK
-}
 
 /**************************************************************************** *
  * Similar Vertices
@@ -533,14 +618,109 @@ typedef struct SimSel_VertExt {
 	};
 } SimSel_VertExt;
 
+#define VERT_MARK	1
+
+/* shared by the precompute and compare tasks below,
+ * all fields are read-only while the tasks run */
+typedef struct SimSel_VertTaskData {
+	BMesh *bm;
+	SimSel_VertExt *v_ext;
+	const int *indices;
+	int num_sels;
+	int type;
+	float thresh_radians;
+	int compare;
+	int cd_dvert_offset;
+} SimSel_VertTaskData;
+
+/* fill the computed member of one SimSel_VertExt, tasks never share an element */
+static void sel_similar_vert_ext_task_cb(void *userdata, const int i)
+{
+	SimSel_VertTaskData *data = userdata;
+	SimSel_VertExt *v_ext = data->v_ext;
+
+	switch (data->type) {
+		case SIMVERT_FACE:
+			/* calling BM_vert_face_count every time is time consumming, so call it only once per vertex */
+			v_ext[i].num_faces = BM_vert_face_count(v_ext[i].v);
+			break;
+
+		case SIMVERT_VGROUP:
+			v_ext[i].dvert = (data->cd_dvert_offset != -1) ?
+			                 BM_ELEM_CD_GET_VOID_P(v_ext[i].v, data->cd_dvert_offset) : NULL;
+			break;
+
+		case SIMVERT_EDGE:
+			v_ext[i].num_edges = BM_vert_edge_count(v_ext[i].v);
+			break;
+	}
+}
+
+/* compare one unmarked vertex against the original selection;
+ * a task only writes the operator flag of its own vertex, so tasks don't interact */
+static void sel_similar_vert_cmp_task_cb(void *userdata, const int i)
+{
+	SimSel_VertTaskData *data = userdata;
+	BMesh *bm = data->bm;
+	SimSel_VertExt *v_ext = data->v_ext;
+	const int *indices = data->indices;
+	BMVert *v = v_ext[i].v;
+
+	/* initial_elem - other_elem */
+	int delta_i;
+	int idx;
+
+	if (!BMO_elem_flag_test(bm, v, VERT_MARK) && !BM_elem_flag_test(v, BM_ELEM_HIDDEN)) {
+		bool cont = true;
+		for (idx = 0; idx < data->num_sels && cont == true; idx++) {
+			BMVert *vs = v_ext[indices[idx]].v;
+			switch (data->type) {
+				case SIMVERT_NORMAL:
+					/* compare the angle between the normals */
+					if (angle_normalized_v3v3(v->no, vs->no) <= data->thresh_radians) {
+						BMO_elem_flag_enable(bm, v, VERT_MARK);
+						cont = false;
+					}
+					break;
+				case SIMVERT_FACE:
+					/* number of adjacent faces */
+					delta_i = v_ext[i].num_faces - v_ext[indices[idx]].num_faces;
+					if (bm_sel_similar_cmp_i(delta_i, data->compare)) {
+						BMO_elem_flag_enable(bm, v, VERT_MARK);
+						cont = false;
+					}
+					break;
+
+				case SIMVERT_VGROUP:
+					if (v_ext[i].dvert != NULL && v_ext[indices[idx]].dvert != NULL) {
+						if (defvert_find_shared(v_ext[i].dvert, v_ext[indices[idx]].dvert) != -1) {
+							BMO_elem_flag_enable(bm, v, VERT_MARK);
+							cont = false;
+						}
+					}
+					break;
+				case SIMVERT_EDGE:
+					/* number of adjacent edges */
+					delta_i = v_ext[i].num_edges - v_ext[indices[idx]].num_edges;
+					if (bm_sel_similar_cmp_i(delta_i, data->compare)) {
+						BMO_elem_flag_enable(bm, v, VERT_MARK);
+						cont = false;
+					}
+					break;
+				default:
+					BLI_assert(0);
+					break;
+			}
+		}
+	}
+}
+
 /*
  * select similar vertices: the choices are in the enum in source/blender/bmesh/bmesh_operators.h
  * choices are normal, face, vertex group...
  */
 void bmo_similar_verts_exec(BMesh *bm, BMOperator *op)
 {
-#define VERT_MARK	1
-
 	const int cd_dvert_offset = CustomData_get_offset(&bm->vdata, CD_MDEFORMVERT);
 	BMOIter vs_iter;	/* selected verts iterator */
 	BMIter v_iter;		/* mesh verts iterator */
@@ -548,16 +728,13 @@ void bmo_similar_verts_exec(BMesh *bm, BMOperator *op)
 	BMVert *v;			/* mesh vertex */
 	SimSel_VertExt *v_ext = NULL;
 	int *indices = NULL;
+	SimSel_VertTaskData data;
 	int num_total = 0, num_sels = 0, i = 0, idx = 0;
 	const int type = BMO_slot_int_get(op->slots_in, "type");
 	const float thresh = BMO_slot_float_get(op->slots_in, "thresh");
 	const float thresh_radians = thresh * (float)M_PI;
 	const int compare = BMO_slot_int_get(op->slots_in, "compare");
 
-	/* initial_elem - other_elem */
-//	float delta_fl;
-	int   delta_i;
-
 	num_total = BM_mesh_elem_count(bm, BM_VERT);
 
 	/* iterate through all selected edges and mark them */
@@ -578,76 +755,30 @@ void bmo_similar_verts_exec(BMesh *bm, BMOperator *op)
 			idx++;
 		}
 
-		switch (type) {
-			case SIMVERT_FACE:
-				/* calling BM_vert_face_count every time is time consumming, so call it only once per vertex */
-				v_ext[i].num_faces = BM_vert_face_count(v);
-				break;
-
-			case SIMVERT_VGROUP:
-				v_ext[i].dvert = (cd_dvert_offset != -1) ? BM_ELEM_CD_GET_VOID_P(v_ext[i].v, cd_dvert_offset) : NULL;
-				break;
-
-			case SIMVERT_EDGE:
-				v_ext[i].num_edges = BM_vert_edge_count(v);
-				break;
-		}
-
 		i++;
 	}
 
-	/* select the vertices if any */
-	for (i = 0; i < num_total; i++) {
-		v = v_ext[i].v;
-		if (!BMO_elem_flag_test(bm, v, VERT_MARK) && !BM_elem_flag_test(v, BM_ELEM_HIDDEN)) {
-			bool cont = true;
-			for (idx = 0; idx < num_sels && cont == true; idx++) {
-				vs = v_ext[indices[idx]].v;
-				switch (type) {
-					case SIMVERT_NORMAL:
-						/* compare the angle between the normals */
-						if (angle_normalized_v3v3(v->no, vs->no) <= thresh_radians) {
-							BMO_elem_flag_enable(bm, v, VERT_MARK);
-							cont = false;
-						}
-						break;
-					case SIMVERT_FACE:
-						/* number of adjacent faces */
-						delta_i = v_ext[i].num_faces - v_ext[indices[idx]].num_faces;
-						if (bm_sel_similar_cmp_i(delta_i, compare)) {
-							BMO_elem_flag_enable(bm, v, VERT_MARK);
-							cont = false;
-						}
-						break;
+	data.bm = bm;
+	data.v_ext = v_ext;
+	data.indices = indices;
+	data.num_sels = num_sels;
+	data.type = type;
+	data.thresh_radians = thresh_radians;
+	data.compare = compare;
+	data.cd_dvert_offset = cd_dvert_offset;
 
-					case SIMVERT_VGROUP:
-						if (v_ext[i].dvert != NULL && v_ext[indices[idx]].dvert != NULL) {
-							if (defvert_find_shared(v_ext[i].dvert, v_ext[indices[idx]].dvert) != -1) {
-								BMO_elem_flag_enable(bm, v, VERT_MARK);
-								cont = false;
-							}
-						}
-						break;
-					case SIMVERT_EDGE:
-						/* number of adjacent edges */
-						delta_i = v_ext[i].num_edges - v_ext[indices[idx]].num_edges;
-						if (bm_sel_similar_cmp_i(delta_i, compare)) {
-							BMO_elem_flag_enable(bm, v, VERT_MARK);
-							cont = false;
-						}
-						break;
-					default:
-						BLI_assert(0);
-						break;
-				}
-			}
-		}
+	/* save us some computation time by doing heavy computation once */
+	if (type == SIMVERT_FACE || type == SIMVERT_VGROUP || type == SIMVERT_EDGE) {
+		BLI_task_parallel_range(0, num_total, &data, sel_similar_vert_ext_task_cb, (num_total > 1024));
 	}
 
+	/* select the vertices if any */
+	BLI_task_parallel_range(0, num_total, &data, sel_similar_vert_cmp_task_cb, (num_total > 1024));
+
 	MEM_freeN(indices);
 	MEM_freeN(v_ext);
 
 	BMO_slot_buffer_from_enabled_flag(bm, op, op->slots_out, "verts.out", BM_VERT, VERT_MARK);
+}
 
 #undef VERT_MARK
-}
@@ -40,6 +40,7 @@
 #include "BLI_gsqueue.h"
 #include "BLI_math.h"
 #include "BLI_memarena.h"
+#include "BLI_task.h"
 
 #include "BKE_customdata.h"
 #include "BKE_deform.h"
@@ -171,6 +172,8 @@ typedef struct BevVert {
 	EdgeHalf *edges;        /* array of size edgecount; CCW order from vertex normal side */
 	BMEdge **wire_edges;	/* array of size wirecount of wire edges */
 	VMesh *vmesh;           /* mesh structure for replacing vertex */
+	VMesh *adj_vmesh;       /* interior mesh of the M_ADJ pattern, when precomputed
+	                         * in parallel, see bevel_build_adj_vmeshes */
 } BevVert;
 
 /* Bevel parameters and state */
@@ -2778,6 +2781,98 @@ static float snap_face_dist_squared(float *co, BMFace *f, BMEdge **r_snap_e, flo
 	return beste_d2;
 }
 
+/* Calculate the interior mesh points of the M_ADJ pattern for bv.
+ * Pure geometry, only reads the boundary and allocates from bp->mem_arena,
+ * so independent vertices can be computed concurrently with per-thread
+ * arenas (see bevel_build_adj_vmeshes). */
+static VMesh *adj_vmesh_compute(BevelParams *bp, BevVert *bv)
+{
+	BoundVert *vpipe = pipe_test(bv);
+
+	if (vpipe)
+		return pipe_adj_vmesh(bp, bv, vpipe);
+	else if (tri_corner_test(bp, bv))
+		return tri_corner_adj_vmesh(bp, bv);
+	else
+		return adj_vmesh(bp, bv);
+}
+
+typedef struct BevelAdjTaskData {
+	BevelParams *bp;
+	BevVert **bevs;
+	MemArena **arenas;
+} BevelAdjTaskData;
+
+static void bevel_build_adj_vmeshes_task_cb(
+        void *userdata, void *UNUSED(userdata_chunk), const int n, const int thread_id)
+{
+	BevelAdjTaskData *data = userdata;
+	BevVert *bv = data->bevs[n];
+	BevelParams bp_local = *data->bp;
+
+	/* allocate from a per-thread arena; a thread_id is never used by more
+	 * than one thread at a time, so lazy creation here is race free */
+	if (data->arenas[thread_id] == NULL) {
+		data->arenas[thread_id] = BLI_memarena_new(MEM_SIZE_OPTIMAL(1 << 16), __func__);
+		BLI_memarena_use_calloc(data->arenas[thread_id]);
+	}
+	bp_local.mem_arena = data->arenas[thread_id];
+
+	bv->adj_vmesh = adj_vmesh_compute(&bp_local, bv);
+}
+
+/* Precompute the interior meshes of all M_ADJ pattern vertices through the
+ * task scheduler. The subdivision math per vertex is independent and only
+ * reads boundary data that is final once adjust_offsets has run, so it can
+ * happen before any result geometry is created.
+ * Returns the per-thread arenas holding the computed meshes (or NULL if
+ * there was nothing to do); the caller frees them once build_vmesh has
+ * consumed the results. */
+static MemArena **bevel_build_adj_vmeshes(BevelParams *bp, BMesh *bm, int *r_tot_arena)
+{
+	BevelAdjTaskData data;
+	BMIter iter;
+	BMVert *v;
+	BevVert *bv;
+	BevVert **bevs;
+	MemArena **arenas;
+	int tot = 0, tot_arena;
+
+	*r_tot_arena = 0;
+
+	bevs = MEM_mallocN(sizeof(*bevs) * bm->totvert, __func__);
+	BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
+		if (BM_elem_flag_test(v, BM_ELEM_TAG)) {
+			bv = find_bevvert(bp, v);
+			if (bv && bv->vmesh->mesh_kind == M_ADJ &&
+			    bv->vmesh->count >= 3 && bv->vmesh->seg > 1)
+			{
+				bevs[tot++] = bv;
+			}
+		}
+	}
+
+	if (tot == 0) {
+		MEM_freeN(bevs);
+		return NULL;
+	}
+
+	tot_arena = BLI_task_scheduler_num_threads(BLI_task_scheduler_get());
+	arenas = MEM_callocN(sizeof(*arenas) * tot_arena, __func__);
+
+	data.bp = bp;
+	data.bevs = bevs;
+	data.arenas = arenas;
+
+	/* dynamic scheduling, vertex costs vary a lot with topology */
+	BLI_task_parallel_range_ex(0, tot, &data, NULL, 0,
+	                           bevel_build_adj_vmeshes_task_cb, tot > 1, true);
+
+	MEM_freeN(bevs);
+	*r_tot_arena = tot_arena;
+	return arenas;
+}
+
 /*
  * Given that the boundary is built and the boundary BMVerts have been made,
  * calculate the positions of the interior mesh points for the M_ADJ pattern,
@@ -2791,7 +2886,6 @@ static void bevel_build_rings(BevelParams *bp, BMesh *bm, BevVert *bv)
 	BMFace *f, *f2;
 	BMEdge *bme, *bme1, *bme2, *bme3;
 	EdgeHalf *e;
-	BoundVert *vpipe;
 	int mat_nr = bp->mat_nr;
 
 	n = bv->vmesh->count;
@@ -2800,14 +2894,8 @@ static void bevel_build_rings(BevelParams *bp, BMesh *bm, BevVert *bv)
 	odd = ns % 2;
 	BLI_assert(n >= 3 && ns > 1);
 
-	vpipe = pipe_test(bv);
-
-	if (vpipe)
-		vm1 = pipe_adj_vmesh(bp, bv, vpipe);
-	else if (tri_corner_test(bp, bv))
-		vm1 = tri_corner_adj_vmesh(bp, bv);
-	else
-		vm1 = adj_vmesh(bp, bv);
+	/* the interior mesh is normally precomputed in parallel */
+	vm1 = bv->adj_vmesh ? bv->adj_vmesh : adj_vmesh_compute(bp, bv);
 
 	/* copy final vmesh into bv->vmesh, make BMVerts and BMFaces */
 	vm = bv->vmesh;
@@ -4193,6 +4281,8 @@ void BM_mesh_bevel(
 	BMVert *v, *v_next;
 	BMEdge *e;
 	BevVert *bv;
+	MemArena **adj_arenas;
+	int tot_adj_arena, i;
 	BevelParams bp = {NULL};
 
 	bp.offset = offset;
@@ -4234,6 +4324,9 @@ void BM_mesh_bevel(
 			adjust_offsets(&bp);
 		}
 
+		/* Precompute the heavy M_ADJ interior meshes in parallel */
+		adj_arenas = bevel_build_adj_vmeshes(&bp, bm, &tot_adj_arena);
+
 		/* Build the meshes around vertices, now that positions are final */
 		BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
 			if (BM_elem_flag_test(v, BM_ELEM_TAG)) {
@@ -4243,6 +4336,15 @@ void BM_mesh_bevel(
 			}
 		}
 
+		/* the precomputed meshes have all been copied into place now */
+		if (adj_arenas) {
+			for (i = 0; i < tot_adj_arena; i++) {
+				if (adj_arenas[i])
+					BLI_memarena_free(adj_arenas[i]);
+			}
+			MEM_freeN(adj_arenas);
+		}
+
 		/* Build polygons for edges */
 		if (!bp.vertex_only) {
 			BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
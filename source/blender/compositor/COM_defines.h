@@ -111,4 +111,16 @@ typedef enum OrderOfChunks {
 
 #define COM_BLUR_BOKEH_PIXELS 512
 
+/**
+ * @brief memory budget of the inter-execution buffer cache, in bytes
+ * @see BufferCache
+ */
+#define COM_BUFFER_CACHE_LIMIT (512 * 1024 * 1024)
+
+/**
+ * @brief maximum bytes of free buffers kept by the memory buffer pool
+ * @see MemoryBufferPool
+ */
+#define COM_BUFFER_POOL_LIMIT (1024 * 1024 * 1024)
+
 #endif  /* __COM_DEFINES_H__ */
@@ -0,0 +1,239 @@
+/*
+ * Copyright 2016, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+
+#include "COM_BufferCache.h"
+#include "COM_CompositorContext.h"
+#include "COM_defines.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_color_types.h"
+#include "DNA_node_types.h"
+
+#include "BKE_node.h"
+
+BufferCache::BufferCache()
+{
+	this->m_memoryInUse = 0;
+}
+
+BufferCache::~BufferCache()
+{
+	this->clear();
+}
+
+BufferCache *BufferCache::getInstance()
+{
+	/* all access happens on the serialized compositor execution path,
+	 * so no locking is needed around the singleton or the entry list */
+	static BufferCache instance;
+	return &instance;
+}
+
+void BufferCache::freeEntry(CacheEntry *entry)
+{
+	this->m_memoryInUse -= entry->size;
+	MEM_freeN(entry->data);
+	delete entry;
+}
+
+bool BufferCache::restore(uint64_t key, MemoryBuffer *buffer)
+{
+	std::list<CacheEntry *>::iterator it;
+
+	for (it = this->m_entries.begin(); it != this->m_entries.end(); ++it) {
+		CacheEntry *entry = *it;
+		if (entry->key == key) {
+			if (entry->width != buffer->getWidth() ||
+			    entry->height != buffer->getHeight() ||
+			    entry->num_channels != buffer->get_num_channels())
+			{
+				/* same settings but another resolution, entry is stale */
+				this->m_entries.erase(it);
+				this->freeEntry(entry);
+				return false;
+			}
+			memcpy(buffer->getBuffer(), entry->data, entry->size);
+			/* move to the front so it is evicted last */
+			this->m_entries.erase(it);
+			this->m_entries.push_front(entry);
+			return true;
+		}
+	}
+	return false;
+}
+
+void BufferCache::store(uint64_t key, MemoryBuffer *buffer)
+{
+	std::list<CacheEntry *>::iterator it;
+	CacheEntry *entry;
+	size_t size;
+
+	for (it = this->m_entries.begin(); it != this->m_entries.end(); ++it) {
+		if ((*it)->key == key) {
+			/* already cached, just refresh the eviction order */
+			entry = *it;
+			this->m_entries.erase(it);
+			this->m_entries.push_front(entry);
+			return;
+		}
+	}
+
+	size = (size_t)buffer->getWidth() * buffer->getHeight() * buffer->get_num_channels() * sizeof(float);
+	if (size == 0 || size > (size_t)COM_BUFFER_CACHE_LIMIT)
+		return;
+
+	while (this->m_memoryInUse + size > (size_t)COM_BUFFER_CACHE_LIMIT && !this->m_entries.empty()) {
+		entry = this->m_entries.back();
+		this->m_entries.pop_back();
+		this->freeEntry(entry);
+	}
+
+	entry = new CacheEntry();
+	entry->key = key;
+	entry->width = buffer->getWidth();
+	entry->height = buffer->getHeight();
+	entry->num_channels = buffer->get_num_channels();
+	entry->size = size;
+	entry->data = (float *)MEM_mallocN(size, "BufferCache entry");
+	memcpy(entry->data, buffer->getBuffer(), size);
+	this->m_entries.push_front(entry);
+	this->m_memoryInUse += size;
+}
+
+void BufferCache::clear()
+{
+	while (!this->m_entries.empty()) {
+		CacheEntry *entry = this->m_entries.back();
+		this->m_entries.pop_back();
+		this->freeEntry(entry);
+	}
+}
+
+/* 64 bit FNV-1a */
+uint64_t BufferCache::hashData(const void *data, size_t size, uint64_t hash)
+{
+	const unsigned char *bytes = (const unsigned char *)data;
+	size_t i;
+
+	for (i = 0; i < size; i++) {
+		hash = (hash ^ bytes[i]) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+static uint64_t hash_curve_mapping(const CurveMapping *cumap, uint64_t hash)
+{
+	int i;
+
+	for (i = 0; i < CM_TOT; i++) {
+		const CurveMap *cuma = &cumap->cm[i];
+		hash = BufferCache::hashData(&cuma->totpoint, sizeof(cuma->totpoint), hash);
+		if (cuma->curve) {
+			hash = BufferCache::hashData(cuma->curve, cuma->totpoint * sizeof(CurveMapPoint), hash);
+		}
+	}
+	hash = BufferCache::hashData(&cumap->flag, sizeof(cumap->flag), hash);
+	hash = BufferCache::hashData(&cumap->black, sizeof(cumap->black), hash);
+	hash = BufferCache::hashData(&cumap->white, sizeof(cumap->white), hash);
+	return hash;
+}
+
+uint64_t BufferCache::hashEditorNode(const bNode *node, const CompositorContext *context, bool *r_cacheable)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	const bNodeSocket *sock;
+	int muted;
+
+	switch (node->type) {
+		/* these read data that can change without any trace in the node
+		 * itself (clip/mask/texture evaluation, tracking), so their
+		 * subtree is never reused from the cache */
+		case CMP_NODE_MOVIECLIP:
+		case CMP_NODE_MASK:
+		case CMP_NODE_TEXTURE:
+		case CMP_NODE_TRACKPOS:
+		case CMP_NODE_KEYINGSCREEN:
+		case CMP_NODE_MOVIEDISTORTION:
+		case CMP_NODE_STABILIZE2D:
+		case CMP_NODE_PLANETRACKDEFORM:
+		case CMP_NODE_DEFOCUS:
+		/* image buffers are painted in place (the ImBuf and its rects keep
+		 * their addresses) and a re-render can give a RenderResult back at
+		 * a previously freed address, so neither has anything stable to
+		 * hash; without a real change counter they can't be cached either */
+		case CMP_NODE_IMAGE:
+		case CMP_NODE_R_LAYERS:
+			*r_cacheable = false;
+			return 0;
+	}
+
+	hash = hashData(&node->type, sizeof(node->type), hash);
+	hash = hashData(&node->custom1, sizeof(node->custom1), hash);
+	hash = hashData(&node->custom2, sizeof(node->custom2), hash);
+	hash = hashData(&node->custom3, sizeof(node->custom3), hash);
+	hash = hashData(&node->custom4, sizeof(node->custom4), hash);
+	muted = (node->flag & NODE_MUTED) != 0;
+	hash = hashData(&muted, sizeof(muted), hash);
+
+	if (node->id) {
+		hash = hashData(node->id->name, sizeof(node->id->name), hash);
+	}
+
+	if (node->storage) {
+		switch (node->type) {
+			case CMP_NODE_CURVE_RGB:
+			case CMP_NODE_CURVE_VEC:
+			case CMP_NODE_HUECORRECT:
+			case CMP_NODE_TIME:
+				/* storage holds pointers into point arrays that are edited
+				 * in place, hash the points themselves instead */
+				hash = hash_curve_mapping((const CurveMapping *)node->storage, hash);
+				break;
+			default:
+				hash = hashData(node->storage, MEM_allocN_len(node->storage), hash);
+				break;
+		}
+	}
+
+	/* external data the node reads */
+	if (node->type == CMP_NODE_TIME) {
+		int framenumber = context->getFramenumber();
+		hash = hashData(&framenumber, sizeof(framenumber), hash);
+	}
+
+	for (sock = (const bNodeSocket *)node->inputs.first; sock; sock = sock->next) {
+		int linked = (sock->link != NULL);
+		hash = hashData(&sock->type, sizeof(sock->type), hash);
+		hash = hashData(&linked, sizeof(linked), hash);
+		if (!linked && sock->default_value) {
+			hash = hashData(sock->default_value, MEM_allocN_len(sock->default_value), hash);
+		}
+	}
+
+	/* value and color nodes store their value on the output socket */
+	for (sock = (const bNodeSocket *)node->outputs.first; sock; sock = sock->next) {
+		if (sock->default_value) {
+			hash = hashData(sock->default_value, MEM_allocN_len(sock->default_value), hash);
+		}
+	}
+
+	return hash;
+}
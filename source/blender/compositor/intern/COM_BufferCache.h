@@ -0,0 +1,110 @@
+/*
+ * Copyright 2016, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_BufferCache_h
+#define _COM_BufferCache_h
+
+#include <list>
+
+#include "BLI_sys_types.h"
+
+#include "COM_MemoryBuffer.h"
+
+class CompositorContext;
+struct bNode;
+
+/**
+ * @brief cache of write buffer contents that is kept between executions
+ *
+ * Normally every evaluation of a node tree starts from scratch, so nudging a
+ * value in one color node re-cooks the entire graph including expensive
+ * upstream buffers. This cache keeps copies of finished write buffers, keyed
+ * by a hash of the editor node subtree that produced them, so only the dirty
+ * part of the graph is executed again.
+ *
+ * Keys are content based (node settings, unconnected socket values, external
+ * data references), never editor node pointers, so they stay valid across
+ * undo and graph rebuilds. Entries are dropped least recently used when the
+ * cache grows over its memory budget.
+ *
+ * @see WriteBufferOperation
+ * @ingroup execution
+ */
+class BufferCache {
+private:
+	typedef struct CacheEntry {
+		uint64_t key;
+		int width, height;
+		unsigned int num_channels;
+		float *data;
+		size_t size;
+	} CacheEntry;
+
+	/** @brief entries ordered most recently used first */
+	std::list<CacheEntry *> m_entries;
+
+	/** @brief total bytes of buffer data held by the entries */
+	size_t m_memoryInUse;
+
+	BufferCache();
+
+	void freeEntry(CacheEntry *entry);
+
+public:
+	~BufferCache();
+
+	static BufferCache *getInstance();
+
+	/**
+	 * @brief copy a cached buffer with this key into buffer
+	 * @return true on a hit with matching dimensions
+	 */
+	bool restore(uint64_t key, MemoryBuffer *buffer);
+
+	/**
+	 * @brief keep a copy of this buffer, evicting old entries over budget
+	 */
+	void store(uint64_t key, MemoryBuffer *buffer);
+
+	/**
+	 * @brief free all cached buffers
+	 */
+	void clear();
+
+	/**
+	 * @brief hash the settings of an editor node for use in cache keys
+	 *
+	 * Covers the node settings, values of unconnected sockets and the state
+	 * of referenced external data (images, render results). Nodes reading
+	 * data that can change without leaving a trace here (movie clips, masks,
+	 * textures) set r_cacheable to false, which excludes their subtree from
+	 * caching.
+	 */
+	static uint64_t hashEditorNode(const bNode *node, const CompositorContext *context, bool *r_cacheable);
+
+	/**
+	 * @brief hash helper, also used to fold the context salt into cache keys
+	 */
+	static uint64_t hashData(const void *data, size_t size, uint64_t hash);
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("COM:BufferCache")
+#endif
+};
+
+#endif
@@ -82,6 +82,13 @@ private:
 	 */
 	bool m_fastCalculation;
 
+	/**
+	 * @brief Resolution scale of this pass, 1 means full resolution.
+	 * Used by the progressive preview mode to cook coarse passes first.
+	 * @see COM_execute
+	 */
+	float m_previewResolutionScale;
+
 	/* @brief color management settings */
 	const ColorManagedViewSettings *m_viewSettings;
 	const ColorManagedDisplaySettings *m_displaySettings;
@@ -199,6 +206,8 @@ public:
 	
 	void setFastCalculation(bool fastCalculation) {this->m_fastCalculation = fastCalculation;}
 	bool isFastCalculation() const { return this->m_fastCalculation; }
+	void setPreviewResolutionScale(float scale) { this->m_previewResolutionScale = scale; }
+	float getPreviewResolutionScale() const { return this->m_previewResolutionScale; }
 	bool isGroupnodeBufferEnabled() const { return (this->getbNodeTree()->flag & NTREE_COM_GROUPNODE_BUFFER) != 0; }
 };
 
@@ -27,6 +27,7 @@
 
 #include "atomic_ops.h"
 
+#include "COM_BufferCache.h"
 #include "COM_ExecutionGroup.h"
 #include "COM_defines.h"
 #include "COM_ExecutionSystem.h"
@@ -138,6 +139,34 @@ void ExecutionGroup::initExecution()
 	maxNumber++;
 	this->m_cachedMaxReadBufferOffset = maxNumber;
 
+	/* when the buffer cache still holds a buffer with the same content hash,
+	 * copy it back in and mark all chunks executed, so the whole subtree of
+	 * this group is skipped during scheduling */
+	NodeOperation *operation = this->getOutputOperation();
+	if (operation->isWriteBufferOperation() && this->m_chunkExecutionStates) {
+		WriteBufferOperation *writeOperation = (WriteBufferOperation *)operation;
+		if (writeOperation->getCacheKey() != 0 &&
+		    !writeOperation->isSingleValue() &&
+		    BufferCache::getInstance()->restore(writeOperation->getCacheKey(), writeOperation->getMemoryProxy()->getBuffer()))
+		{
+			for (index = 0; index < this->m_numberOfChunks; index++) {
+				this->m_chunkExecutionStates[index] = COM_ES_EXECUTED;
+			}
+		}
+	}
+}
+
+bool ExecutionGroup::isFullyExecuted() const
+{
+	unsigned int index;
+
+	if (this->m_numberOfChunks == 0 || this->m_chunkExecutionStates == NULL)
+		return false;
+	for (index = 0; index < this->m_numberOfChunks; index++) {
+		if (this->m_chunkExecutionStates[index] != COM_ES_EXECUTED)
+			return false;
+	}
+	return true;
 }
 
 void ExecutionGroup::deinitExecution()
@@ -321,7 +321,13 @@ public:
 	 * @note The implementation will calculate the chunkSize of this execution group.
 	 */
 	void initExecution();
-	
+
+	/**
+	 * @brief check whether every chunk of this group has been executed
+	 * @note used to decide if the output buffer can be stored in the BufferCache
+	 */
+	bool isFullyExecuted() const;
+
 	/**
 	 * @brief get all inputbuffers needed to calculate an chunk
 	 * @note all inputbuffers must be executed
@@ -22,6 +22,8 @@
 
 #include "COM_ExecutionSystem.h"
 
+#include <string.h>
+
 #include "PIL_time.h"
 #include "BLI_utildefines.h"
 extern "C" {
@@ -30,12 +32,15 @@ extern "C" {
 
 #include "BLT_translation.h"
 
+#include "COM_BufferCache.h"
 #include "COM_Converter.h"
+#include "COM_MemoryBufferPool.h"
 #include "COM_NodeOperationBuilder.h"
 #include "COM_NodeOperation.h"
 #include "COM_ExecutionGroup.h"
 #include "COM_WorkScheduler.h"
 #include "COM_ReadBufferOperation.h"
+#include "COM_WriteBufferOperation.h"
 #include "COM_Debug.h"
 
 #ifdef WITH_CXX_GUARDEDALLOC
@@ -43,6 +48,7 @@ extern "C" {
 #endif
 
 ExecutionSystem::ExecutionSystem(RenderData *rd, Scene *scene, bNodeTree *editingtree, bool rendering, bool fastcalculation,
+                                 float resolutionScale,
                                  const ColorManagedViewSettings *viewSettings, const ColorManagedDisplaySettings *displaySettings,
                                  const char *viewName)
 {
@@ -51,6 +57,7 @@ ExecutionSystem::ExecutionSystem(RenderData *rd, Scene *scene, bNodeTree *editin
 	this->m_context.setbNodeTree(editingtree);
 	this->m_context.setPreviewHash(editingtree->previews);
 	this->m_context.setFastCalculation(fastcalculation);
+	this->m_context.setPreviewResolutionScale(resolutionScale);
 	/* initialize the CompositorContext */
 	if (rendering) {
 		this->m_context.setQuality((CompositorQuality)editingtree->render_quality);
@@ -144,6 +151,8 @@ void ExecutionSystem::execute()
 	}
 	unsigned int index;
 
+	determineCacheKeys();
+
 	// First allocale all write buffer
 	for (index = 0; index < this->m_operations.size(); index++) {
 		NodeOperation *operation = this->m_operations[index];
@@ -185,6 +194,8 @@ void ExecutionSystem::execute()
 	WorkScheduler::finish();
 	WorkScheduler::stop();
 
+	storeCacheBuffers();
+
 	editingtree->stats_draw(editingtree->sdh, IFACE_("Compositing | De-initializing execution"));
 	for (index = 0; index < this->m_operations.size(); index++) {
 		NodeOperation *operation = this->m_operations[index];
@@ -194,6 +205,108 @@ void ExecutionSystem::execute()
 		ExecutionGroup *executionGroup = this->m_groups[index];
 		executionGroup->deinitExecution();
 	}
+
+	/* buffers were recycled through the pool during execution,
+	 * give the memory back now the cook is over */
+	MemoryBufferPool::getInstance()->flush();
+}
+
+uint64_t ExecutionSystem::determineCacheKey(NodeOperation *operation, std::map<NodeOperation *, uint64_t> &memo)
+{
+	std::map<NodeOperation *, uint64_t>::iterator memo_it = memo.find(operation);
+	if (memo_it != memo.end()) {
+		return memo_it->second;
+	}
+	/* break cycles (should not occur, but a wrong key would reuse stale buffers) */
+	memo[operation] = 0;
+
+	uint64_t key = 0;
+	if (operation->isCacheable()) {
+		uint64_t hash = operation->getCacheHash();
+		key = BufferCache::hashData(&hash, sizeof(hash), 14695981039346656037ULL);
+
+		if (operation->isReadBufferOperation()) {
+			/* follow the read through its memory proxy into the subtree writing the buffer */
+			ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
+			uint64_t childKey = determineCacheKey(readOperation->getMemoryProxy()->getWriteBufferOperation(), memo);
+			key = (childKey == 0) ? 0 : BufferCache::hashData(&childKey, sizeof(childKey), key);
+		}
+		else {
+			unsigned int index;
+			for (index = 0; index < operation->getNumberOfInputSockets() && key != 0; index++) {
+				NodeOperationInput *input = operation->getInputSocket(index);
+				if (input && input->isConnected()) {
+					uint64_t childKey = determineCacheKey(&input->getLink()->getOperation(), memo);
+					if (childKey == 0) {
+						key = 0;
+					}
+					else {
+						key = BufferCache::hashData(&index, sizeof(index), key);
+						key = BufferCache::hashData(&childKey, sizeof(childKey), key);
+					}
+				}
+			}
+		}
+	}
+
+	memo[operation] = key;
+	return key;
+}
+
+void ExecutionSystem::determineCacheKeys()
+{
+	std::map<NodeOperation *, uint64_t> memo;
+	uint64_t salt = 14695981039346656037ULL;
+	unsigned int index;
+
+	/* fold context settings that influence buffer content into every key */
+	salt = BufferCache::hashData(this->m_context.getViewName(), strlen(this->m_context.getViewName()), salt);
+	CompositorQuality quality = this->m_context.getQuality();
+	salt = BufferCache::hashData(&quality, sizeof(quality), salt);
+	bool rendering = this->m_context.isRendering();
+	salt = BufferCache::hashData(&rendering, sizeof(rendering), salt);
+	float resolutionScale = this->m_context.getPreviewResolutionScale();
+	salt = BufferCache::hashData(&resolutionScale, sizeof(resolutionScale), salt);
+	const RenderData *rd = this->m_context.getRenderData();
+	if (rendering && (rd->mode & R_BORDER) && !(rd->mode & R_CROP)) {
+		salt = BufferCache::hashData(&rd->border, sizeof(rd->border), salt);
+	}
+
+	for (index = 0; index < this->m_operations.size(); index++) {
+		NodeOperation *operation = this->m_operations[index];
+		if (operation->isWriteBufferOperation()) {
+			WriteBufferOperation *writeOperation = (WriteBufferOperation *)operation;
+			uint64_t key = determineCacheKey(writeOperation, memo);
+			if (key != 0) {
+				key = BufferCache::hashData(&salt, sizeof(salt), key);
+				if (key == 0) {
+					key = 1;
+				}
+			}
+			writeOperation->setCacheKey(key);
+		}
+	}
+}
+
+void ExecutionSystem::storeCacheBuffers()
+{
+	unsigned int index;
+
+	for (index = 0; index < this->m_groups.size(); index++) {
+		ExecutionGroup *executionGroup = this->m_groups[index];
+		NodeOperation *operation = executionGroup->getOutputOperation();
+		if (operation->isWriteBufferOperation()) {
+			WriteBufferOperation *writeOperation = (WriteBufferOperation *)operation;
+			/* only complete buffers are kept; partial executions (borders,
+			 * user break) would poison later lookups */
+			if (writeOperation->getCacheKey() != 0 &&
+			    !writeOperation->isSingleValue() &&
+			    executionGroup->isFullyExecuted())
+			{
+				BufferCache::getInstance()->store(writeOperation->getCacheKey(), writeOperation->getMemoryProxy()->getBuffer());
+			}
+		}
+	}
 }
 
 void ExecutionSystem::executeGroups(CompositorPriority priority)
@@ -25,6 +25,8 @@ class ExecutionGroup;
 #ifndef _COM_ExecutionSystem_h
 #define _COM_ExecutionSystem_h
 
+#include <map>
+
 #include "DNA_color_types.h"
 #include "DNA_node_types.h"
 #include "COM_Node.h"
@@ -151,6 +153,7 @@ public:
 	 * @param rendering [true false]
 	 */
 	ExecutionSystem(RenderData *rd, Scene *scene, bNodeTree *editingtree, bool rendering, bool fastcalculation,
+	                float resolutionScale,
 	                const ColorManagedViewSettings *viewSettings, const ColorManagedDisplaySettings *displaySettings,
 	                const char *viewName);
 
@@ -177,6 +180,23 @@ public:
 private:
 	void executeGroups(CompositorPriority priority);
 
+	/**
+	 * @brief assign buffer cache keys to all WriteBufferOperation's
+	 *
+	 * A key covers the editor node hashes of the whole subtree writing into
+	 * the buffer, so a key match means the cached buffer content is still
+	 * valid. Uncacheable subtrees get key zero.
+	 * @see BufferCache
+	 */
+	void determineCacheKeys();
+	uint64_t determineCacheKey(NodeOperation *operation, std::map<NodeOperation *, uint64_t> &memo);
+
+	/**
+	 * @brief store fully executed write buffers in the buffer cache
+	 * @see BufferCache
+	 */
+	void storeCacheBuffers();
+
 	/* allow the DebugInfo class to look at internals */
 	friend class DebugInfo;
 
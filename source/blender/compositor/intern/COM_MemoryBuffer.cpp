@@ -21,6 +21,7 @@
  */
 
 #include "COM_MemoryBuffer.h"
+#include "COM_MemoryBufferPool.h"
 
 #include "MEM_guardedalloc.h"
 
@@ -62,7 +63,7 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, unsigned int chunkNumber, r
 	this->m_memoryProxy = memoryProxy;
 	this->m_chunkNumber = chunkNumber;
 	this->m_num_channels = determine_num_channels(memoryProxy->getDataType());
-	this->m_buffer = (float *)MEM_mallocN_aligned(sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+	this->m_buffer = MemoryBufferPool::getInstance()->acquire(sizeof(float) * determineBufferSize() * this->m_num_channels);
 	this->m_state = COM_MB_ALLOCATED;
 	this->m_datatype = memoryProxy->getDataType();
 }
@@ -75,7 +76,7 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect)
 	this->m_memoryProxy = memoryProxy;
 	this->m_chunkNumber = -1;
 	this->m_num_channels = determine_num_channels(memoryProxy->getDataType());
-	this->m_buffer = (float *)MEM_mallocN_aligned(sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+	this->m_buffer = MemoryBufferPool::getInstance()->acquire(sizeof(float) * determineBufferSize() * this->m_num_channels);
 	this->m_state = COM_MB_TEMPORARILY;
 	this->m_datatype = memoryProxy->getDataType();
 }
@@ -88,7 +89,7 @@ MemoryBuffer::MemoryBuffer(DataType dataType, rcti *rect)
 	this->m_memoryProxy = NULL;
 	this->m_chunkNumber = -1;
 	this->m_num_channels = determine_num_channels(dataType);
-	this->m_buffer = (float *)MEM_mallocN_aligned(sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+	this->m_buffer = MemoryBufferPool::getInstance()->acquire(sizeof(float) * determineBufferSize() * this->m_num_channels);
 	this->m_state = COM_MB_TEMPORARILY;
 	this->m_datatype = dataType;
 }
@@ -145,7 +146,7 @@ float MemoryBuffer::getMaximumValue(rcti *rect)
 MemoryBuffer::~MemoryBuffer()
 {
 	if (this->m_buffer) {
-		MEM_freeN(this->m_buffer);
+		MemoryBufferPool::getInstance()->release(this->m_buffer, sizeof(float) * determineBufferSize() * this->m_num_channels);
 		this->m_buffer = NULL;
 	}
 }
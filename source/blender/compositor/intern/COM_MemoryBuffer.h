@@ -134,7 +134,16 @@ public:
 	 * @note buffer should already be available in memory
 	 */
 	float *getBuffer() { return this->m_buffer; }
-	
+
+	/**
+	 * @brief get a pointer to the first channel of pixel (x, y)
+	 * @note no bounds checking, the coordinates must be inside the rect
+	 */
+	inline float *getElem(int x, int y)
+	{
+		return &this->m_buffer[((intptr_t)(y - m_rect.ymin) * m_width + (x - m_rect.xmin)) * m_num_channels];
+	}
+
 	/**
 	 * @brief after execution the state will be set to available by calling this method
 	 */
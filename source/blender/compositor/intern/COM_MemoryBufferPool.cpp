@@ -0,0 +1,92 @@
+/*
+ * Copyright 2016, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "COM_MemoryBufferPool.h"
+#include "COM_defines.h"
+
+#include "MEM_guardedalloc.h"
+
+MemoryBufferPool::MemoryBufferPool()
+{
+	this->m_memoryInUse = 0;
+	BLI_mutex_init(&this->m_mutex);
+}
+
+MemoryBufferPool::~MemoryBufferPool()
+{
+	this->flush();
+	BLI_mutex_end(&this->m_mutex);
+}
+
+MemoryBufferPool *MemoryBufferPool::getInstance()
+{
+	static MemoryBufferPool instance;
+	return &instance;
+}
+
+float *MemoryBufferPool::acquire(size_t size)
+{
+	float *buffer = NULL;
+
+	BLI_mutex_lock(&this->m_mutex);
+	std::map<size_t, std::vector<float *> >::iterator it = this->m_buffers.find(size);
+	if (it != this->m_buffers.end() && !it->second.empty()) {
+		buffer = it->second.back();
+		it->second.pop_back();
+		this->m_memoryInUse -= size;
+	}
+	BLI_mutex_unlock(&this->m_mutex);
+
+	if (buffer == NULL) {
+		buffer = (float *)MEM_mallocN_aligned(size, 16, "COM_MemoryBuffer");
+	}
+	return buffer;
+}
+
+void MemoryBufferPool::release(float *buffer, size_t size)
+{
+	bool pooled = false;
+
+	BLI_mutex_lock(&this->m_mutex);
+	if (this->m_memoryInUse + size <= (size_t)COM_BUFFER_POOL_LIMIT) {
+		this->m_buffers[size].push_back(buffer);
+		this->m_memoryInUse += size;
+		pooled = true;
+	}
+	BLI_mutex_unlock(&this->m_mutex);
+
+	if (!pooled) {
+		MEM_freeN(buffer);
+	}
+}
+
+void MemoryBufferPool::flush()
+{
+	BLI_mutex_lock(&this->m_mutex);
+	std::map<size_t, std::vector<float *> >::iterator it;
+	for (it = this->m_buffers.begin(); it != this->m_buffers.end(); ++it) {
+		std::vector<float *> &bucket = it->second;
+		while (!bucket.empty()) {
+			MEM_freeN(bucket.back());
+			bucket.pop_back();
+		}
+	}
+	this->m_buffers.clear();
+	this->m_memoryInUse = 0;
+	BLI_mutex_unlock(&this->m_mutex);
+}
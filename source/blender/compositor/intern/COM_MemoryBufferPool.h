@@ -0,0 +1,81 @@
+/*
+ * Copyright 2016, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_MemoryBufferPool_h
+#define _COM_MemoryBufferPool_h
+
+#include <map>
+#include <vector>
+
+extern "C" {
+#include "BLI_threads.h"
+}
+
+/**
+ * @brief size-bucketed pool of the float buffers backing MemoryBuffer
+ *
+ * Chunked execution allocates and frees buffers of a handful of sizes over
+ * and over, which keeps the allocator busy and refaults the pages every
+ * time. Freed buffers are parked here per exact byte size and handed back
+ * out to the next MemoryBuffer of the same size instead.
+ *
+ * Chunk buffers are created and destroyed from worker threads, so the free
+ * lists are protected by a mutex. The pool is flushed at the end of every
+ * execution so no memory is held between cooks.
+ *
+ * @see MemoryBuffer
+ * @ingroup Memory
+ */
+class MemoryBufferPool {
+private:
+	/** @brief free buffers bucketed by their allocation size in bytes */
+	std::map<size_t, std::vector<float *> > m_buffers;
+
+	/** @brief total bytes of pooled (unused) buffer data */
+	size_t m_memoryInUse;
+
+	ThreadMutex m_mutex;
+
+	MemoryBufferPool();
+
+public:
+	~MemoryBufferPool();
+
+	static MemoryBufferPool *getInstance();
+
+	/**
+	 * @brief get a buffer of this many bytes, recycled when possible
+	 */
+	float *acquire(size_t size);
+
+	/**
+	 * @brief return a buffer of this many bytes to the pool
+	 */
+	void release(float *buffer, size_t size);
+
+	/**
+	 * @brief free all pooled buffers
+	 */
+	void flush();
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("COM:MemoryBufferPool")
+#endif
+};
+
+#endif
@@ -41,6 +41,8 @@ NodeOperation::NodeOperation()
 	this->m_isResolutionSet = false;
 	this->m_openCL = false;
 	this->m_btree = NULL;
+	this->m_cacheHash = 0;
+	this->m_cacheable = true;
 }
 
 NodeOperation::~NodeOperation()
@@ -151,6 +153,27 @@ NodeOperation *NodeOperation::getInputOperation(unsigned int inputSocketIndex)
 		return NULL;
 }
 
+void NodeOperation::renderRegionBuffered(MemoryBuffer *output, rcti *rect)
+{
+	if (this->executeRegionBuffered(output, rect))
+		return;
+
+	/* per pixel fallback for operations without a buffered loop */
+	const int num_channels = output->get_num_channels();
+	int x, y;
+	bool breaked = false;
+	for (y = rect->ymin; y < rect->ymax && (!breaked); y++) {
+		float *buffer = output->getElem(rect->xmin, y);
+		for (x = rect->xmin; x < rect->xmax; x++) {
+			this->readSampled(buffer, x, y, COM_PS_NEAREST);
+			buffer += num_channels;
+		}
+		if (isBreaked()) {
+			breaked = true;
+		}
+	}
+}
+
 void NodeOperation::getConnectedInputSockets(Inputs *sockets)
 {
 	for (Inputs::const_iterator it = m_inputs.begin(); it != m_inputs.end(); ++it) {
@@ -30,6 +30,7 @@
 extern "C" {
 #include "BLI_math_color.h"
 #include "BLI_math_vector.h"
+#include "BLI_sys_types.h"
 #include "BLI_threads.h"
 }
 
@@ -125,7 +126,21 @@ private:
 	 * @brief set to truth when resolution for this operation is set
 	 */
 	bool m_isResolutionSet;
-	
+
+	/**
+	 * @brief content hash of the editor node this operation was created for,
+	 * zero when no hash is known
+	 * @see BufferCache
+	 */
+	uint64_t m_cacheHash;
+
+	/**
+	 * @brief false when the output of this operation can change without a
+	 * change in m_cacheHash, which excludes its subtree from the buffer cache
+	 * @see BufferCache
+	 */
+	bool m_cacheable;
+
 public:
 	virtual ~NodeOperation();
 	
@@ -166,6 +181,12 @@ public:
 	virtual int isSingleThreaded() { return false; }
 
 	void setbNodeTree(const bNodeTree *tree) { this->m_btree = tree; }
+
+	void setCacheHash(uint64_t hash) { this->m_cacheHash = hash; }
+	uint64_t getCacheHash() const { return this->m_cacheHash; }
+	void setCacheable(bool cacheable) { this->m_cacheable = cacheable; }
+	bool isCacheable() const { return this->m_cacheable; }
+
 	virtual void initExecution();
 	
 	/**
@@ -178,6 +199,29 @@ public:
 	virtual void executeRegion(rcti * /*rect*/,
 	                           unsigned int /*chunkNumber*/) {}
 
+	/**
+	 * @brief fill a whole region of an output buffer in a single call
+	 *
+	 * Operations that can compute their result with a tight loop over memory
+	 * buffers override this method and return true, so chunk execution skips
+	 * the virtual call per pixel through the operation tree. Operations with
+	 * more complex access patterns keep the default implementation and are
+	 * evaluated per pixel.
+	 *
+	 * @ingroup execution
+	 * @param output the buffer to write to, its rect can be larger than rect
+	 * @param rect the rectangle (in image space) to fill
+	 * @return true when the region was filled, false to use per pixel reads
+	 */
+	virtual bool executeRegionBuffered(MemoryBuffer * /*output*/, rcti * /*rect*/) { return false; }
+
+	/**
+	 * @brief render a region into the given buffer, whole buffer at a time
+	 * when this operation supports it and with per pixel reads otherwise
+	 * @ingroup execution
+	 */
+	void renderRegionBuffered(MemoryBuffer *output, rcti *rect);
+
 	/**
 	 * @brief when a chunk is executed by an OpenCLDevice, this method is called
 	 * @ingroup execution
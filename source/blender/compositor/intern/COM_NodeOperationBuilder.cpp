@@ -23,6 +23,7 @@ extern "C" {
 #include "BLI_utildefines.h"
 }
 
+#include "COM_BufferCache.h"
 #include "COM_NodeConverter.h"
 #include "COM_Converter.h"
 #include "COM_Debug.h"
@@ -38,6 +39,7 @@ extern "C" {
 #include "COM_SocketProxyOperation.h"
 #include "COM_ReadBufferOperation.h"
 #include "COM_WriteBufferOperation.h"
+#include "COM_ScaleOperation.h"
 #include "COM_ViewerOperation.h"
 
 #include "COM_NodeOperationBuilder.h" /* own include */
@@ -45,6 +47,9 @@ extern "C" {
 NodeOperationBuilder::NodeOperationBuilder(const CompositorContext *context, bNodeTree *b_nodetree) :
     m_context(context),
     m_current_node(NULL),
+    m_current_node_hash(0),
+    m_current_node_cacheable(true),
+    m_current_node_op_count(0),
     m_active_viewer(NULL)
 {
 	m_graph.from_bNodeTree(*context, b_nodetree);
@@ -63,7 +68,11 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 		Node *node = (Node *)m_graph.nodes()[index];
 		
 		m_current_node = node;
-		
+		m_current_node_cacheable = true;
+		m_current_node_hash = (node->getbNode()) ?
+		                      BufferCache::hashEditorNode(node->getbNode(), m_context, &m_current_node_cacheable) : 0;
+		m_current_node_op_count = 0;
+
 		DebugInfo::node_to_operations(node);
 		node->convertToOperations(converter, *m_context);
 	}
@@ -105,6 +114,8 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 	
 	resolve_proxies();
 	
+	add_preview_resolution_scales();
+	
 	add_datatype_conversions();
 	
 	determineResolutions();
@@ -131,6 +142,15 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 void NodeOperationBuilder::addOperation(NodeOperation *operation)
 {
 	m_operations.push_back(operation);
+
+	/* tag operations of editor nodes for the buffer cache. converter operations
+	 * added by the builder itself keep hash 0, their type is fully determined
+	 * by the operations they connect so no extra hash data is needed. */
+	if (m_current_node) {
+		operation->setCacheHash(m_current_node_hash ^ ((uint64_t)m_current_node_op_count * 0x9E3779B97F4A7C15ULL));
+		operation->setCacheable(m_current_node_cacheable);
+		m_current_node_op_count++;
+	}
 }
 
 void NodeOperationBuilder::mapInputSocket(NodeInput *node_socket, NodeOperationInput *operation_socket)
@@ -390,6 +410,58 @@ void NodeOperationBuilder::resolve_proxies()
 	}
 }
 
+void NodeOperationBuilder::add_preview_resolution_scales()
+{
+	const float scale = m_context->getPreviewResolutionScale();
+	if (scale >= 1.0f)
+		return;
+
+	/* Wrap every operation without inputs (render layers, images, movie clips, ...)
+	 * in a fixed size scale, so the rest of the graph cooks at reduced resolution.
+	 * Resolutions are only determined later on, but operations without inputs
+	 * can already report their natural size here.
+	 */
+	Operations source_ops;
+	for (Operations::const_iterator it = m_operations.begin(); it != m_operations.end(); ++it) {
+		NodeOperation *op = *it;
+		if (op->getNumberOfInputSockets() == 0 && op->getNumberOfOutputSockets() > 0)
+			source_ops.push_back(op);
+	}
+
+	for (Operations::const_iterator it = source_ops.begin(); it != source_ops.end(); ++it) {
+		NodeOperation *op = *it;
+		unsigned int resolution[2] = {0, 0};
+		unsigned int preferredResolution[2] = {0, 0};
+		op->determineResolution(resolution, preferredResolution);
+
+		/* single value operations stay as they are */
+		if (resolution[0] == 0 || resolution[1] == 0)
+			continue;
+
+		for (unsigned int index = 0; index < op->getNumberOfOutputSockets(); index++) {
+			NodeOperationOutput *output = op->getOutputSocket(index);
+			OpInputs targets = cache_output_links(output);
+			if (targets.empty())
+				continue;
+
+			ScaleFixedSizeOperation *scaleOperation = new ScaleFixedSizeOperation();
+			scaleOperation->setNewWidth(MAX2(1, (int)(resolution[0] * scale)));
+			scaleOperation->setNewHeight(MAX2(1, (int)(resolution[1] * scale)));
+			scaleOperation->setIsAspect(false);
+			scaleOperation->setIsCrop(false);
+			scaleOperation->setOffset(0.0f, 0.0f);
+			addOperation(scaleOperation);
+
+			for (OpInputs::const_iterator target_it = targets.begin(); target_it != targets.end(); ++target_it) {
+				NodeOperationInput *target = *target_it;
+				removeInputLink(target);
+				addLink(scaleOperation->getOutputSocket(), target);
+			}
+			addLink(output, scaleOperation->getInputSocket(0));
+		}
+	}
+}
+
 void NodeOperationBuilder::determineResolutions()
 {
 	/* determine all resolutions of the operations (Width/Height) */
@@ -26,6 +26,10 @@
 #include <set>
 #include <vector>
 
+extern "C" {
+#include "BLI_sys_types.h"
+}
+
 #include "COM_NodeGraph.h"
 
 using std::vector;
@@ -87,7 +91,12 @@ private:
 	OutputSocketMap m_output_map;
 	
 	Node *m_current_node;
-	
+	/** Buffer cache tag for operations of the current node
+	 *  @see BufferCache */
+	uint64_t m_current_node_hash;
+	bool m_current_node_cacheable;
+	int m_current_node_op_count;
+
 	/** Operation that will be writing to the viewer image
 	 *  Only one operation can occupy this place at a time,
 	 *  to avoid race conditions
@@ -136,6 +145,9 @@ protected:
 	
 	/** Replace proxy operations with direct links */
 	void resolve_proxies();
+
+	/** Scale down source operations for progressive preview passes */
+	void add_preview_resolution_scales();
 	
 	/** Calculate resolution for each operation */
 	void determineResolutions();
@@ -20,6 +20,7 @@
  *		Monique Dewanchand
  */
 
+#include <deque>
 #include <list>
 #include <stdio.h>
 
@@ -57,8 +58,22 @@ static ThreadLocal(CPUDevice *) g_thread_device;
 /// @brief list of all thread for every CPUDevice in cpudevices a thread exists
 static ListBase g_cputhreads;
 static bool g_cpuInitialized = false;
-/// @brief all scheduled work for the cpu
-static ThreadQueue *g_cpuqueue;
+/**
+ * @brief scheduled work for the cpu, one deque per CPUDevice
+ *
+ * Work is distributed round-robin over the local deques and every worker
+ * pops from the front of its own. A worker that runs dry steals the back
+ * half of the fullest other deque, so threads keep working through the
+ * tail of a cook instead of idling behind a central queue.
+ */
+static vector<std::deque<WorkPackage *> > g_cpu_queues;
+static ThreadMutex g_cpu_mutex;
+static ThreadCondition g_cpu_cond;
+/// @brief number of workers currently executing a package, for finish()
+static int g_cpu_busy;
+static bool g_cpu_stop;
+/// @brief round robin index for scheduling over the local deques
+static unsigned int g_cpu_schedule_index;
 static ThreadQueue *g_gpuqueue;
 #ifdef COM_OPENCL_ENABLED
 static cl_context g_context;
@@ -152,17 +167,81 @@ int COM_isHighlightedbNode(bNode *bnode)
 } // end extern "C"
 
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+/**
+ * @brief take work for this worker, stealing from another deque when its own is empty
+ * @note g_cpu_mutex must be held
+ */
+static WorkPackage *worksteal_take(unsigned int own_index)
+{
+	std::deque<WorkPackage *> &own = g_cpu_queues[own_index];
+	WorkPackage *work;
+
+	if (!own.empty()) {
+		work = own.front();
+		own.pop_front();
+		return work;
+	}
+
+	/* steal from the fullest deque */
+	unsigned int victim_index = own_index;
+	size_t victim_size = 0;
+	for (unsigned int index = 0; index < g_cpu_queues.size(); index++) {
+		if (index != own_index && g_cpu_queues[index].size() > victim_size) {
+			victim_index = index;
+			victim_size = g_cpu_queues[index].size();
+		}
+	}
+	if (victim_size == 0) {
+		return NULL;
+	}
+
+	/* take the back half; the victim would execute those chunks last anyway,
+	 * and moving several at once keeps the number of steals low */
+	std::deque<WorkPackage *> &victim = g_cpu_queues[victim_index];
+	work = victim.back();
+	victim.pop_back();
+	for (size_t count = victim_size / 2; count > 1 && !victim.empty(); count--) {
+		own.push_front(victim.back());
+		victim.pop_back();
+	}
+	return work;
+}
+
 void *WorkScheduler::thread_execute_cpu(void *data)
 {
 	CPUDevice *device = (CPUDevice *)data;
+	const unsigned int own_index = (unsigned int)device->thread_id();
 	WorkPackage *work;
 	BLI_thread_local_set(g_thread_device, device);
-	while ((work = (WorkPackage *)BLI_thread_queue_pop(g_cpuqueue))) {
+
+	BLI_mutex_lock(&g_cpu_mutex);
+	while (true) {
+		while (!g_cpu_stop && (work = worksteal_take(own_index)) == NULL) {
+			BLI_condition_wait(&g_cpu_cond, &g_cpu_mutex);
+		}
+		if (g_cpu_stop) {
+			break;
+		}
+		g_cpu_busy++;
+		if (!g_cpu_queues[own_index].empty()) {
+			/* stolen packages ended up in our deque, wake another worker for them */
+			BLI_condition_notify_one(&g_cpu_cond);
+		}
+		BLI_mutex_unlock(&g_cpu_mutex);
+
 		HIGHLIGHT(work);
 		device->execute(work);
 		delete work;
+
+		BLI_mutex_lock(&g_cpu_mutex);
+		g_cpu_busy--;
+		if (g_cpu_busy == 0) {
+			/* finish() may be waiting for the last package */
+			BLI_condition_notify_all(&g_cpu_cond);
+		}
 	}
-	
+	BLI_mutex_unlock(&g_cpu_mutex);
+
 	return NULL;
 }
 
@@ -196,19 +275,49 @@ void WorkScheduler::schedule(ExecutionGroup *group, int chunkNumber)
 		BLI_thread_queue_push(g_gpuqueue, package);
 	}
 	else {
-		BLI_thread_queue_push(g_cpuqueue, package);
+		schedule_cpu(package);
 	}
 #else
-	BLI_thread_queue_push(g_cpuqueue, package);
+	schedule_cpu(package);
 #endif
 #endif
 }
 
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+void WorkScheduler::schedule_cpu(WorkPackage *package)
+{
+	BLI_mutex_lock(&g_cpu_mutex);
+	g_cpu_queues[g_cpu_schedule_index % g_cpu_queues.size()].push_back(package);
+	g_cpu_schedule_index++;
+	BLI_condition_notify_one(&g_cpu_cond);
+	BLI_mutex_unlock(&g_cpu_mutex);
+}
+
+/**
+ * @brief check whether all local cpu deques are drained
+ * @note g_cpu_mutex must be held
+ */
+static bool worksteal_queues_empty()
+{
+	for (unsigned int index = 0; index < g_cpu_queues.size(); index++) {
+		if (!g_cpu_queues[index].empty()) {
+			return false;
+		}
+	}
+	return true;
+}
+#endif
+
 void WorkScheduler::start(CompositorContext &context)
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
 	unsigned int index;
-	g_cpuqueue = BLI_thread_queue_init();
+	BLI_mutex_init(&g_cpu_mutex);
+	BLI_condition_init(&g_cpu_cond);
+	g_cpu_queues.resize(g_cpudevices.size());
+	g_cpu_busy = 0;
+	g_cpu_stop = false;
+	g_cpu_schedule_index = 0;
 	BLI_init_threads(&g_cputhreads, thread_execute_cpu, g_cpudevices.size());
 	for (index = 0; index < g_cpudevices.size(); index++) {
 		Device *device = g_cpudevices[index];
@@ -236,23 +345,37 @@ void WorkScheduler::finish()
 #ifdef COM_OPENCL_ENABLED
 	if (g_openclActive) {
 		BLI_thread_queue_wait_finish(g_gpuqueue);
-		BLI_thread_queue_wait_finish(g_cpuqueue);
-	}
-	else {
-		BLI_thread_queue_wait_finish(g_cpuqueue);
 	}
-#else
-	BLI_thread_queue_wait_finish(cpuqueue);
 #endif
+	BLI_mutex_lock(&g_cpu_mutex);
+	while (!worksteal_queues_empty() || g_cpu_busy > 0) {
+		if (!worksteal_queues_empty()) {
+			/* make sure no worker stays asleep while work is pending */
+			BLI_condition_notify_all(&g_cpu_cond);
+		}
+		BLI_condition_wait(&g_cpu_cond, &g_cpu_mutex);
+	}
+	BLI_mutex_unlock(&g_cpu_mutex);
 #endif
 }
 void WorkScheduler::stop()
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-	BLI_thread_queue_nowait(g_cpuqueue);
+	BLI_mutex_lock(&g_cpu_mutex);
+	g_cpu_stop = true;
+	BLI_condition_notify_all(&g_cpu_cond);
+	BLI_mutex_unlock(&g_cpu_mutex);
 	BLI_end_threads(&g_cputhreads);
-	BLI_thread_queue_free(g_cpuqueue);
-	g_cpuqueue = NULL;
+	/* normally drained by finish(), but don't leak when execution was broken */
+	for (unsigned int index = 0; index < g_cpu_queues.size(); index++) {
+		while (!g_cpu_queues[index].empty()) {
+			delete g_cpu_queues[index].back();
+			g_cpu_queues[index].pop_back();
+		}
+	}
+	g_cpu_queues.clear();
+	BLI_condition_end(&g_cpu_cond);
+	BLI_mutex_end(&g_cpu_mutex);
 #ifdef COM_OPENCL_ENABLED
 	if (g_openclActive) {
 		BLI_thread_queue_nowait(g_gpuqueue);
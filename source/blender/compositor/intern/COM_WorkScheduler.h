@@ -53,7 +53,12 @@ class WorkScheduler {
 	 * inside this loop new work is queried and being executed
 	 */
 	static void *thread_execute_gpu(void *data);
-#endif	
+
+	/**
+	 * @brief push a package onto one of the per-worker cpu deques
+	 */
+	static void schedule_cpu(WorkPackage *package);
+#endif
 public:
 	/**
 	 * @brief schedule a chunk of a group to be calculated.
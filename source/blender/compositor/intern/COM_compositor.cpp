@@ -31,7 +31,9 @@ extern "C" {
 #include "BKE_scene.h"
 
 #include "COM_compositor.h"
+#include "COM_BufferCache.h"
 #include "COM_ExecutionSystem.h"
+#include "COM_MemoryBufferPool.h"
 #include "COM_WorkScheduler.h"
 #include "clew.h"
 #include "COM_MovieDistortionOperation.h"
@@ -79,19 +81,29 @@ void COM_execute(RenderData *rd, Scene *scene, bNodeTree *editingtree, int rende
 	bool twopass = (editingtree->flag & NTREE_TWO_PASS) > 0 && !rendering;
 	/* initialize execution system */
 	if (twopass) {
-		ExecutionSystem *system = new ExecutionSystem(rd, scene, editingtree, rendering, twopass, viewSettings, displaySettings, viewName);
-		system->execute();
-		delete system;
-		
-		if (editingtree->test_break(editingtree->tbh)) {
-			// during editing multiple calls to this method can be triggered.
-			// make sure one the last one will be doing the work.
-			BLI_mutex_unlock(&s_compositorMutex);
-			return;
+		/* progressive preview: cook a resolution pyramid before the final pass.
+		 * the backdrop and node previews update after every level, so editing
+		 * large comps gives coarse feedback quickly while the remaining levels
+		 * refine the result. the coarsest level also skips slow nodes, like the
+		 * former single fast pass did.
+		 */
+		static const float preview_scales[] = {0.125f, 0.25f, 0.5f};
+		for (int level = 0; level < 3; level++) {
+			ExecutionSystem *system = new ExecutionSystem(rd, scene, editingtree, rendering, (level == 0),
+			                                              preview_scales[level], viewSettings, displaySettings, viewName);
+			system->execute();
+			delete system;
+
+			if (editingtree->test_break(editingtree->tbh)) {
+				// during editing multiple calls to this method can be triggered.
+				// make sure one the last one will be doing the work.
+				BLI_mutex_unlock(&s_compositorMutex);
+				return;
+			}
 		}
 	}
 
-	ExecutionSystem *system = new ExecutionSystem(rd, scene, editingtree, rendering, false,
+	ExecutionSystem *system = new ExecutionSystem(rd, scene, editingtree, rendering, false, 1.0f,
 	                                              viewSettings, displaySettings, viewName);
 	system->execute();
 	delete system;
@@ -103,6 +115,8 @@ void COM_deinitialize()
 {
 	if (is_compositorMutex_init) {
 		BLI_mutex_lock(&s_compositorMutex);
+		BufferCache::getInstance()->clear();
+		MemoryBufferPool::getInstance()->flush();
 		WorkScheduler::deinitialize();
 		is_compositorMutex_init = false;
 		BLI_mutex_unlock(&s_compositorMutex);
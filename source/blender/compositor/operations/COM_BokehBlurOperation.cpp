@@ -24,6 +24,10 @@
 #include "BLI_math.h"
 #include "COM_OpenCLDevice.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 extern "C" {
 #  include "RE_pipeline.h"
 }
@@ -115,6 +119,25 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 		int offsetadd = getOffsetAdd() * COM_NUM_CHANNELS_COLOR;
 
 		float m = this->m_bokehDimension / pixelSize;
+#ifdef __SSE2__
+		__m128 color_accum_sse = _mm_load_ps(color_accum);
+		__m128 multiplier_accum_sse = _mm_load_ps(multiplier_accum);
+		for (int ny = miny; ny < maxy; ny += step) {
+			int bufferindex = ((minx - bufferstartx) * COM_NUM_CHANNELS_COLOR) + ((ny - bufferstarty) * COM_NUM_CHANNELS_COLOR * bufferwidth);
+			for (int nx = minx; nx < maxx; nx += step) {
+				float u = this->m_bokehMidX - (nx - x) * m;
+				float v = this->m_bokehMidY - (ny - y) * m;
+				this->m_inputBokehProgram->readSampled(bokeh, u, v, COM_PS_NEAREST);
+				__m128 bokeh_sse = _mm_load_ps(bokeh);
+				__m128 reg_a = _mm_load_ps(&buffer[bufferindex]);
+				color_accum_sse = _mm_add_ps(color_accum_sse, _mm_mul_ps(bokeh_sse, reg_a));
+				multiplier_accum_sse = _mm_add_ps(multiplier_accum_sse, bokeh_sse);
+				bufferindex += offsetadd;
+			}
+		}
+		_mm_store_ps(color_accum, color_accum_sse);
+		_mm_store_ps(multiplier_accum, multiplier_accum_sse);
+#else
 		for (int ny = miny; ny < maxy; ny += step) {
 			int bufferindex = ((minx - bufferstartx) * COM_NUM_CHANNELS_COLOR) + ((ny - bufferstarty) * COM_NUM_CHANNELS_COLOR * bufferwidth);
 			for (int nx = minx; nx < maxx; nx += step) {
@@ -126,6 +149,7 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 				bufferindex += offsetadd;
 			}
 		}
+#endif
 		output[0] = color_accum[0] * (1.0f / multiplier_accum[0]);
 		output[1] = color_accum[1] * (1.0f / multiplier_accum[1]);
 		output[2] = color_accum[2] * (1.0f / multiplier_accum[2]);
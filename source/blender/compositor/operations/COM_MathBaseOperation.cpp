@@ -72,6 +72,12 @@ void MathBaseOperation::clampIfNeeded(float *color)
 	}
 }
 
+void MathBaseOperation::gatherValueInputs(MemoryBuffer *value1, MemoryBuffer *value2, rcti *rect)
+{
+	this->getInputOperation(0)->renderRegionBuffered(value1, rect);
+	this->getInputOperation(1)->renderRegionBuffered(value2, rect);
+}
+
 void MathAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -85,6 +91,31 @@ void MathAddOperation::executePixelSampled(float output[4], float x, float y, Pi
 	clampIfNeeded(output);
 }
 
+bool MathAddOperation::executeRegionBuffered(MemoryBuffer *output, rcti *rect)
+{
+	MemoryBuffer value1(COM_DT_VALUE, rect);
+	MemoryBuffer value2(COM_DT_VALUE, rect);
+	const int w = rect->xmax - rect->xmin;
+	int x, y;
+
+	gatherValueInputs(&value1, &value2, rect);
+
+	for (y = rect->ymin; y < rect->ymax; y++) {
+		const float *in1 = value1.getElem(rect->xmin, y);
+		const float *in2 = value2.getElem(rect->xmin, y);
+		float *out = output->getElem(rect->xmin, y);
+		for (x = 0; x < w; x++) {
+			out[x] = in1[x] + in2[x];
+		}
+		if (this->m_useClamp) {
+			for (x = 0; x < w; x++) {
+				CLAMP(out[x], 0.0f, 1.0f);
+			}
+		}
+	}
+	return true;
+}
+
 void MathSubtractOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -98,6 +129,31 @@ void MathSubtractOperation::executePixelSampled(float output[4], float x, float
 	clampIfNeeded(output);
 }
 
+bool MathSubtractOperation::executeRegionBuffered(MemoryBuffer *output, rcti *rect)
+{
+	MemoryBuffer value1(COM_DT_VALUE, rect);
+	MemoryBuffer value2(COM_DT_VALUE, rect);
+	const int w = rect->xmax - rect->xmin;
+	int x, y;
+
+	gatherValueInputs(&value1, &value2, rect);
+
+	for (y = rect->ymin; y < rect->ymax; y++) {
+		const float *in1 = value1.getElem(rect->xmin, y);
+		const float *in2 = value2.getElem(rect->xmin, y);
+		float *out = output->getElem(rect->xmin, y);
+		for (x = 0; x < w; x++) {
+			out[x] = in1[x] - in2[x];
+		}
+		if (this->m_useClamp) {
+			for (x = 0; x < w; x++) {
+				CLAMP(out[x], 0.0f, 1.0f);
+			}
+		}
+	}
+	return true;
+}
+
 void MathMultiplyOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -111,6 +167,31 @@ void MathMultiplyOperation::executePixelSampled(float output[4], float x, float
 	clampIfNeeded(output);
 }
 
+bool MathMultiplyOperation::executeRegionBuffered(MemoryBuffer *output, rcti *rect)
+{
+	MemoryBuffer value1(COM_DT_VALUE, rect);
+	MemoryBuffer value2(COM_DT_VALUE, rect);
+	const int w = rect->xmax - rect->xmin;
+	int x, y;
+
+	gatherValueInputs(&value1, &value2, rect);
+
+	for (y = rect->ymin; y < rect->ymax; y++) {
+		const float *in1 = value1.getElem(rect->xmin, y);
+		const float *in2 = value2.getElem(rect->xmin, y);
+		float *out = output->getElem(rect->xmin, y);
+		for (x = 0; x < w; x++) {
+			out[x] = in1[x] * in2[x];
+		}
+		if (this->m_useClamp) {
+			for (x = 0; x < w; x++) {
+				CLAMP(out[x], 0.0f, 1.0f);
+			}
+		}
+	}
+	return true;
+}
+
 void MathDivideOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -127,6 +208,31 @@ void MathDivideOperation::executePixelSampled(float output[4], float x, float y,
 	clampIfNeeded(output);
 }
 
+bool MathDivideOperation::executeRegionBuffered(MemoryBuffer *output, rcti *rect)
+{
+	MemoryBuffer value1(COM_DT_VALUE, rect);
+	MemoryBuffer value2(COM_DT_VALUE, rect);
+	const int w = rect->xmax - rect->xmin;
+	int x, y;
+
+	gatherValueInputs(&value1, &value2, rect);
+
+	for (y = rect->ymin; y < rect->ymax; y++) {
+		const float *in1 = value1.getElem(rect->xmin, y);
+		const float *in2 = value2.getElem(rect->xmin, y);
+		float *out = output->getElem(rect->xmin, y);
+		for (x = 0; x < w; x++) {
+			out[x] = (in2[x] == 0.0f) ? 0.0f : in1[x] / in2[x];
+		}
+		if (this->m_useClamp) {
+			for (x = 0; x < w; x++) {
+				CLAMP(out[x], 0.0f, 1.0f);
+			}
+		}
+	}
+	return true;
+}
+
 void MathSineOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -46,6 +46,12 @@ protected:
 	MathBaseOperation();
 
 	void clampIfNeeded(float color[4]);
+
+	/**
+	 * Gather both inputs into temporary value buffers, for the buffered
+	 * loops of the simple math functions
+	 */
+	void gatherValueInputs(MemoryBuffer *value1, MemoryBuffer *value2, rcti *rect);
 public:
 	/**
 	 * the inner loop of this program
@@ -74,21 +80,25 @@ class MathAddOperation : public MathBaseOperation {
 public:
 	MathAddOperation() : MathBaseOperation() {}
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	bool executeRegionBuffered(MemoryBuffer *output, rcti *rect);
 };
 class MathSubtractOperation : public MathBaseOperation {
 public:
 	MathSubtractOperation() : MathBaseOperation() {}
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	bool executeRegionBuffered(MemoryBuffer *output, rcti *rect);
 };
 class MathMultiplyOperation : public MathBaseOperation {
 public:
 	MathMultiplyOperation() : MathBaseOperation() {}
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	bool executeRegionBuffered(MemoryBuffer *output, rcti *rect);
 };
 class MathDivideOperation : public MathBaseOperation {
 public:
 	MathDivideOperation() : MathBaseOperation() {}
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	bool executeRegionBuffered(MemoryBuffer *output, rcti *rect);
 };
 class MathSineOperation : public MathBaseOperation {
 public:
@@ -93,6 +93,13 @@ void MixBaseOperation::determineResolution(unsigned int resolution[2], unsigned
 	NodeOperation::determineResolution(resolution, preferredResolution);
 }
 
+void MixBaseOperation::gatherMixInputs(MemoryBuffer *value, MemoryBuffer *color1, MemoryBuffer *color2, rcti *rect)
+{
+	this->getInputOperation(0)->renderRegionBuffered(value, rect);
+	this->getInputOperation(1)->renderRegionBuffered(color1, rect);
+	this->getInputOperation(2)->renderRegionBuffered(color2, rect);
+}
+
 void MixBaseOperation::deinitExecution()
 {
 	this->m_inputValueOperation = NULL;
@@ -129,6 +136,39 @@ void MixAddOperation::executePixelSampled(float output[4], float x, float y, Pix
 	clampIfNeeded(output);
 }
 
+bool MixAddOperation::executeRegionBuffered(MemoryBuffer *output, rcti *rect)
+{
+	MemoryBuffer value(COM_DT_VALUE, rect);
+	MemoryBuffer color1(COM_DT_COLOR, rect);
+	MemoryBuffer color2(COM_DT_COLOR, rect);
+	const int w = rect->xmax - rect->xmin;
+	int x, y;
+
+	if (output->get_num_channels() != 4)
+		return false;
+
+	gatherMixInputs(&value, &color1, &color2, rect);
+
+	for (y = rect->ymin; y < rect->ymax; y++) {
+		const float *in_value = value.getElem(rect->xmin, y);
+		const float *in1 = color1.getElem(rect->xmin, y);
+		const float *in2 = color2.getElem(rect->xmin, y);
+		float *out = output->getElem(rect->xmin, y);
+		for (x = 0; x < w; x++, in1 += 4, in2 += 4, out += 4) {
+			float val = in_value[x];
+			if (this->m_valueAlphaMultiply) {
+				val *= in2[3];
+			}
+			out[0] = in1[0] + val * in2[0];
+			out[1] = in1[1] + val * in2[1];
+			out[2] = in1[2] + val * in2[2];
+			out[3] = in1[3];
+			clampIfNeeded(out);
+		}
+	}
+	return true;
+}
+
 /* ******** Mix Blend Operation ******** */
 
 MixBlendOperation::MixBlendOperation() : MixBaseOperation()
@@ -160,6 +200,40 @@ void MixBlendOperation::executePixelSampled(float output[4], float x, float y, P
 	clampIfNeeded(output);
 }
 
+bool MixBlendOperation::executeRegionBuffered(MemoryBuffer *output, rcti *rect)
+{
+	MemoryBuffer value(COM_DT_VALUE, rect);
+	MemoryBuffer color1(COM_DT_COLOR, rect);
+	MemoryBuffer color2(COM_DT_COLOR, rect);
+	const int w = rect->xmax - rect->xmin;
+	int x, y;
+
+	if (output->get_num_channels() != 4)
+		return false;
+
+	gatherMixInputs(&value, &color1, &color2, rect);
+
+	for (y = rect->ymin; y < rect->ymax; y++) {
+		const float *in_value = value.getElem(rect->xmin, y);
+		const float *in1 = color1.getElem(rect->xmin, y);
+		const float *in2 = color2.getElem(rect->xmin, y);
+		float *out = output->getElem(rect->xmin, y);
+		for (x = 0; x < w; x++, in1 += 4, in2 += 4, out += 4) {
+			float val = in_value[x];
+			if (this->m_valueAlphaMultiply) {
+				val *= in2[3];
+			}
+			float valm = 1.0f - val;
+			out[0] = valm * in1[0] + val * in2[0];
+			out[1] = valm * in1[1] + val * in2[1];
+			out[2] = valm * in1[2] + val * in2[2];
+			out[3] = in1[3];
+			clampIfNeeded(out);
+		}
+	}
+	return true;
+}
+
 /* ******** Mix Burn Operation ******** */
 
 MixBurnOperation::MixBurnOperation() : MixBaseOperation()
@@ -623,6 +697,40 @@ void MixMultiplyOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
+bool MixMultiplyOperation::executeRegionBuffered(MemoryBuffer *output, rcti *rect)
+{
+	MemoryBuffer value(COM_DT_VALUE, rect);
+	MemoryBuffer color1(COM_DT_COLOR, rect);
+	MemoryBuffer color2(COM_DT_COLOR, rect);
+	const int w = rect->xmax - rect->xmin;
+	int x, y;
+
+	if (output->get_num_channels() != 4)
+		return false;
+
+	gatherMixInputs(&value, &color1, &color2, rect);
+
+	for (y = rect->ymin; y < rect->ymax; y++) {
+		const float *in_value = value.getElem(rect->xmin, y);
+		const float *in1 = color1.getElem(rect->xmin, y);
+		const float *in2 = color2.getElem(rect->xmin, y);
+		float *out = output->getElem(rect->xmin, y);
+		for (x = 0; x < w; x++, in1 += 4, in2 += 4, out += 4) {
+			float val = in_value[x];
+			if (this->m_valueAlphaMultiply) {
+				val *= in2[3];
+			}
+			float valm = 1.0f - val;
+			out[0] = in1[0] * (valm + val * in2[0]);
+			out[1] = in1[1] * (valm + val * in2[1]);
+			out[2] = in1[2] * (valm + val * in2[2]);
+			out[3] = in1[3];
+			clampIfNeeded(out);
+		}
+	}
+	return true;
+}
+
 /* ******** Mix Ovelray Operation ******** */
 
 MixOverlayOperation::MixOverlayOperation() : MixBaseOperation()
@@ -41,6 +41,12 @@ protected:
 	bool m_valueAlphaMultiply;
 	bool m_useClamp;
 
+	/**
+	 * Gather the three inputs into temporary buffers, for the buffered
+	 * loops of the simple mix modes
+	 */
+	void gatherMixInputs(MemoryBuffer *value, MemoryBuffer *color1, MemoryBuffer *color2, rcti *rect);
+
 	inline void clampIfNeeded(float color[4])
 	{
 		if (m_useClamp) {
@@ -84,12 +90,14 @@ class MixAddOperation : public MixBaseOperation {
 public:
 	MixAddOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	bool executeRegionBuffered(MemoryBuffer *output, rcti *rect);
 };
 
 class MixBlendOperation : public MixBaseOperation {
 public:
 	MixBlendOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	bool executeRegionBuffered(MemoryBuffer *output, rcti *rect);
 };
 
 class MixBurnOperation : public MixBaseOperation {
@@ -156,6 +164,7 @@ class MixMultiplyOperation : public MixBaseOperation {
 public:
 	MixMultiplyOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	bool executeRegionBuffered(MemoryBuffer *output, rcti *rect);
 };
 
 class MixOverlayOperation : public MixBaseOperation {
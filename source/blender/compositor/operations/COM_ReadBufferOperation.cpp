@@ -74,6 +74,38 @@ void ReadBufferOperation::executePixelSampled(float output[4], float x, float y,
 	}
 }
 
+bool ReadBufferOperation::executeRegionBuffered(MemoryBuffer *output, rcti *rect)
+{
+	if (m_single_value || m_buffer == NULL)
+		return false;
+	if (output->get_num_channels() != m_buffer->get_num_channels())
+		return false;
+
+	/* copy rows straight out of the input buffer, matching the clipping
+	 * behavior of read(): pixels outside the buffer rect are zero */
+	const rcti *buffer_rect = m_buffer->getRect();
+	const int num_channels = output->get_num_channels();
+	const int xmin = max(rect->xmin, buffer_rect->xmin);
+	const int xmax = min(rect->xmax, buffer_rect->xmax);
+	int y;
+
+	for (y = rect->ymin; y < rect->ymax; y++) {
+		float *dst = output->getElem(rect->xmin, y);
+		if (y < buffer_rect->ymin || y >= buffer_rect->ymax || xmin >= xmax) {
+			memset(dst, 0, (rect->xmax - rect->xmin) * num_channels * sizeof(float));
+		}
+		else {
+			if (xmin > rect->xmin)
+				memset(dst, 0, (xmin - rect->xmin) * num_channels * sizeof(float));
+			memcpy(output->getElem(xmin, y), m_buffer->getElem(xmin, y),
+			       (xmax - xmin) * num_channels * sizeof(float));
+			if (xmax < rect->xmax)
+				memset(output->getElem(xmax, y), 0, (rect->xmax - xmax) * num_channels * sizeof(float));
+		}
+	}
+	return true;
+}
+
 void ReadBufferOperation::executePixelExtend(float output[4], float x, float y, PixelSampler sampler,
                                              MemoryBufferExtend extend_x, MemoryBufferExtend extend_y)
 {
@@ -34,6 +34,21 @@ void SetValueOperation::executePixelSampled(float output[4],
 	output[0] = this->m_value;
 }
 
+bool SetValueOperation::executeRegionBuffered(MemoryBuffer *output, rcti *rect)
+{
+	const int num_channels = output->get_num_channels();
+	int x, y;
+
+	for (y = rect->ymin; y < rect->ymax; y++) {
+		float *buffer = output->getElem(rect->xmin, y);
+		for (x = rect->xmin; x < rect->xmax; x++) {
+			buffer[0] = this->m_value;
+			buffer += num_channels;
+		}
+	}
+	return true;
+}
+
 void SetValueOperation::determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2])
 {
 	resolution[0] = preferredResolution[0];
@@ -24,6 +24,10 @@
 #include "BLI_math.h"
 #include "COM_OpenCLDevice.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 extern "C" {
 #  include "RE_pipeline.h"
 }
@@ -141,6 +145,10 @@ void VariableSizeBokehBlurOperation::executePixel(float output[4], int x, int y,
 		const int addXStepColor = addXStepValue * COM_NUM_CHANNELS_COLOR;
 
 		if (size_center > this->m_threshold) {
+#ifdef __SSE2__
+			__m128 color_accum_sse = _mm_load_ps(color_accum);
+			__m128 multiplier_accum_sse = _mm_load_ps(multiplier_accum);
+#endif
 			for (int ny = miny; ny < maxy; ny += addYStepValue) {
 				float dy = ny - y;
 				int offsetValueNy = ny * inputSizeBuffer->getWidth();
@@ -156,14 +164,25 @@ void VariableSizeBokehBlurOperation::executePixel(float output[4], int x, int y,
 									(float)(COM_BLUR_BOKEH_PIXELS / 2) + (dx / size) * (float)((COM_BLUR_BOKEH_PIXELS / 2) - 1),
 									(float)(COM_BLUR_BOKEH_PIXELS / 2) + (dy / size) * (float)((COM_BLUR_BOKEH_PIXELS / 2) - 1)};
 								inputBokehBuffer->read(bokeh, uv[0], uv[1]);
+#ifdef __SSE2__
+								__m128 bokeh_sse = _mm_load_ps(bokeh);
+								__m128 reg_a = _mm_load_ps(&inputProgramFloatBuffer[offsetColorNxNy]);
+								color_accum_sse = _mm_add_ps(color_accum_sse, _mm_mul_ps(bokeh_sse, reg_a));
+								multiplier_accum_sse = _mm_add_ps(multiplier_accum_sse, bokeh_sse);
+#else
 								madd_v4_v4v4(color_accum, bokeh, &inputProgramFloatBuffer[offsetColorNxNy]);
 								add_v4_v4(multiplier_accum, bokeh);
+#endif
 							}
 						}
 					}
 					offsetColorNxNy += addXStepColor;
 					offsetValueNxNy += addXStepValue;				}
 			}
+#ifdef __SSE2__
+			_mm_store_ps(color_accum, color_accum_sse);
+			_mm_store_ps(multiplier_accum, multiplier_accum_sse);
+#endif
 		}
 
 		output[0] = color_accum[0] / multiplier_accum[0];
@@ -31,6 +31,7 @@ WriteBufferOperation::WriteBufferOperation(DataType datatype) : NodeOperation()
 	this->m_memoryProxy = new MemoryProxy(datatype);
 	this->m_memoryProxy->setWriteBufferOperation(this);
 	this->m_memoryProxy->setExecutor(NULL);
+	this->m_cacheKey = 0;
 }
 WriteBufferOperation::~WriteBufferOperation()
 {
@@ -88,24 +89,9 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/
 		}
 	}
 	else {
-		int x1 = rect->xmin;
-		int y1 = rect->ymin;
-		int x2 = rect->xmax;
-		int y2 = rect->ymax;
-
-		int x;
-		int y;
-		bool breaked = false;
-		for (y = y1; y < y2 && (!breaked); y++) {
-			int offset4 = (y * memoryBuffer->getWidth() + x1) * num_channels;
-			for (x = x1; x < x2; x++) {
-				this->m_input->readSampled(&(buffer[offset4]), x, y, COM_PS_NEAREST);
-				offset4 += num_channels;
-			}
-			if (isBreaked()) {
-				breaked = true;
-			}
-		}
+		/* fills the buffer with whole buffer loops where operations support
+		 * them, and with a virtual call per pixel otherwise */
+		this->m_input->renderRegionBuffered(memoryBuffer, rect);
 	}
 	memoryBuffer->setCreatedState();
 }
@@ -34,6 +34,7 @@ class WriteBufferOperation : public NodeOperation {
 	MemoryProxy *m_memoryProxy;
 	bool m_single_value; /* single value stored in buffer */
 	NodeOperation *m_input;
+	uint64_t m_cacheKey; /* key of this buffer in the BufferCache, zero when not cacheable */
 public:
 	WriteBufferOperation(DataType datatype);
 	~WriteBufferOperation();
@@ -52,5 +53,7 @@ public:
 		return m_input;
 	}
 
+	void setCacheKey(uint64_t key) { this->m_cacheKey = key; }
+	uint64_t getCacheKey() const { return this->m_cacheKey; }
 };
 #endif
@@ -85,6 +85,28 @@ void DEG_stats_simple(const struct Depsgraph *graph,
                       size_t *r_operations,
                       size_t *r_relations);
 
+/* ************************************************ */
+/* Per-Operation Evaluation Profiling */
+
+/* Start/stop recording wall time and thread id of every operation node
+ * evaluation into a fixed size ring buffer. Opt-in, there is no overhead
+ * while recording is not running.
+ */
+void DEG_debug_profile_start(void);
+void DEG_debug_profile_stop(void);
+
+/* Dump the recorded samples as a trace event JSON array
+ * (loadable in chrome://tracing).
+ */
+void DEG_debug_profile_dump_json(FILE *stream);
+
+/* Graphviz dump of the graph with operation nodes colored by the total
+ * evaluation time they accumulated in the recorded samples.
+ */
+void DEG_debug_profile_dump_graphviz(const struct Depsgraph *graph,
+                                     FILE *stream,
+                                     const char *label);
+
 /* ************************************************ */
 /* Diagram-Based Graph Debugging */
 
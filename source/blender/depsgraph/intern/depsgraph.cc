@@ -35,6 +35,7 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_listbase.h"
+#include "BLI_utildefines.h"
 
 extern "C" {
 #include "DNA_action_types.h"
@@ -346,14 +347,41 @@ void Depsgraph::clear_id_nodes()
 	id_hash.clear();
 }
 
+/* Check whether an identical relation between the two nodes exists already.
+ *
+ * The builders may visit the same object along several code paths (bases,
+ * proxies, dupli-groups) and partial rebuilds re-run build passes on top of
+ * an existing graph, so relation creation has to be idempotent.
+ */
+static DepsRelation *find_existing_relation(const DepsNode *from,
+                                            const DepsNode *to,
+                                            eDepsRelation_Type type,
+                                            const char *description)
+{
+	for (DepsNode::Relations::const_iterator it = to->inlinks.begin();
+	     it != to->inlinks.end();
+	     ++it)
+	{
+		DepsRelation *rel = *it;
+		if (rel->from == from && rel->type == type && STREQ(rel->name, description)) {
+			return rel;
+		}
+	}
+	return NULL;
+}
+
 /* Add new relationship between two nodes. */
 DepsRelation *Depsgraph::add_new_relation(OperationDepsNode *from,
                                           OperationDepsNode *to,
                                           eDepsRelation_Type type,
                                           const char *description)
 {
+	DepsRelation *rel = find_existing_relation(from, to, type, description);
+	if (rel != NULL) {
+		return rel;
+	}
 	/* Create new relation, and add it to the graph. */
-	DepsRelation *rel = OBJECT_GUARDED_NEW(DepsRelation, from, to, type, description);
+	rel = OBJECT_GUARDED_NEW(DepsRelation, from, to, type, description);
 	/* TODO(sergey): Find a better place for this. */
 #ifdef WITH_OPENSUBDIV
 	ComponentDepsNode *comp_node = from->owner;
@@ -377,8 +405,12 @@ DepsRelation *Depsgraph::add_new_relation(DepsNode *from, DepsNode *to,
                                           eDepsRelation_Type type,
                                           const char *description)
 {
+	DepsRelation *rel = find_existing_relation(from, to, type, description);
+	if (rel != NULL) {
+		return rel;
+	}
 	/* Create new relation, and add it to the graph. */
-	DepsRelation *rel = OBJECT_GUARDED_NEW(DepsRelation, from, to, type, description);
+	rel = OBJECT_GUARDED_NEW(DepsRelation, from, to, type, description);
 	return rel;
 }
 
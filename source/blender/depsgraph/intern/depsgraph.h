@@ -96,6 +96,7 @@ struct DepsRelation {
 struct Depsgraph {
 	typedef unordered_map<const ID *, IDDepsNode *> IDNodeMap;
 	typedef unordered_set<SubgraphDepsNode *> Subgraphs;
+	typedef unordered_set<ID *> IDSet;
 	typedef unordered_set<OperationDepsNode *> EntryTags;
 	typedef vector<OperationDepsNode *> OperationNodes;
 
@@ -174,6 +175,12 @@ struct Depsgraph {
 	/* Indicates whether relations needs to be updated. */
 	bool need_update;
 
+	/* IDs tagged for updates since the last relations rebuild. This is a
+	 * superset of the structurally modified IDs, used to attempt a partial
+	 * rebuild instead of re-creating the graph from scratch (see
+	 * deg_graph_rebuild_partial()). */
+	IDSet need_update_ids;
+
 	/* Quick-Access Temp Data ............. */
 
 	/* Nodes which have been tagged as "directly modified". */
@@ -30,6 +30,7 @@
  * Methods for constructing depsgraph.
  */
 
+#include <algorithm>
 #include <stack>
 
 #include "MEM_guardedalloc.h"
@@ -327,6 +328,341 @@ void DEG_relations_tag_update(Main *bmain)
 	}
 }
 
+/* ******************** */
+/* Partial Graph Update */
+
+/* ID node which ultimately owns the given node,
+ * NULL for nodes which sit outside of any ID (root node, time source).
+ */
+static IDDepsNode *deg_node_id_owner(DepsNode *node)
+{
+	if (node->type == DEPSNODE_TYPE_ID_REF) {
+		return (IDDepsNode *)node;
+	}
+	else if (node->type == DEPSNODE_TYPE_OPERATION) {
+		return ((OperationDepsNode *)node)->owner->owner;
+	}
+	else if (node->tclass == DEPSNODE_CLASS_COMPONENT) {
+		return ((ComponentDepsNode *)node)->owner;
+	}
+	return NULL;
+}
+
+/* Collect the ID node itself plus all its component and operation nodes. */
+static void deg_id_node_collect_nodes(IDDepsNode *id_node,
+                                      vector<DepsNode *> *r_nodes)
+{
+	r_nodes->push_back(id_node);
+	for (IDDepsNode::ComponentMap::const_iterator it = id_node->components.begin();
+	     it != id_node->components.end();
+	     ++it)
+	{
+		ComponentDepsNode *comp_node = it->second;
+		r_nodes->push_back(comp_node);
+		for (ComponentDepsNode::OperationMap::const_iterator it_op = comp_node->operations.begin();
+		     it_op != comp_node->operations.end();
+		     ++it_op)
+		{
+			r_nodes->push_back(it_op->second);
+		}
+	}
+}
+
+static void deg_relation_unlink(DepsNode::Relations &links, DepsRelation *rel)
+{
+	DepsNode::Relations::iterator it = std::find(links.begin(), links.end(), rel);
+	if (it != links.end()) {
+		links.erase(it);
+	}
+}
+
+/* All ID datablock pointers currently in main,
+ * used to detect graph nodes whose ID was freed since the last rebuild.
+ */
+static void deg_main_collect_ids(Main *bmain, unordered_set<const ID *> *r_ids)
+{
+	ListBase *lbarray[MAX_LIBARRAY];
+	int a = set_listbasepointers(bmain, lbarray);
+	while (a--) {
+		for (ID *id = (ID *)lbarray[a]->first; id; id = (ID *)id->next) {
+			r_ids->insert(id);
+		}
+	}
+	/* Nested node trees are not in any of the main listbases. */
+	FOREACH_NODETREE(bmain, nodetree, id) {
+		if (id != (ID *)nodetree) {
+			r_ids->insert(&nodetree->id);
+		}
+	} FOREACH_NODETREE_END
+}
+
+/* Set LIB_TAG_DOIT (the builders' "this ID is done already" tag) on every ID
+ * except the given ones, so re-running a build pass over an existing graph
+ * only visits the IDs which actually need (re)building.
+ */
+static void deg_main_tag_ids_built(Main *bmain,
+                                   const unordered_set<const ID *> &built_ids)
+{
+	ListBase *lbarray[MAX_LIBARRAY];
+	int a = set_listbasepointers(bmain, lbarray);
+	while (a--) {
+		for (ID *id = (ID *)lbarray[a]->first; id; id = (ID *)id->next) {
+			if (built_ids.find(id) != built_ids.end()) {
+				id->tag |= LIB_TAG_DOIT;
+			}
+			else {
+				id->tag &= ~LIB_TAG_DOIT;
+			}
+		}
+	}
+	FOREACH_NODETREE(bmain, nodetree, id) {
+		if (built_ids.find(&nodetree->id) != built_ids.end()) {
+			nodetree->id.tag |= LIB_TAG_DOIT;
+		}
+		else {
+			nodetree->id.tag &= ~LIB_TAG_DOIT;
+		}
+	} FOREACH_NODETREE_END
+}
+
+/* Update an existing graph in place, rebuilding only the nodes and relations
+ * of the IDs tagged since the last rebuild so the cost stays proportional to
+ * the edit instead of the scene size.
+ *
+ * Only handled for plain scene objects: anything involving relations which
+ * are built from the scene level (rigid body, proxies, dupli-groups) or IDs
+ * which may have been removed from main altogether makes us return false,
+ * upon which the caller falls back to a full rebuild.
+ */
+static bool deg_graph_rebuild_partial(Depsgraph *graph, Main *bmain, Scene *scene)
+{
+	const Depsgraph::IDSet &tagged = graph->need_update_ids;
+
+	if (tagged.empty()) {
+		return false;
+	}
+	/* Heuristic: beyond a certain portion of the graph the partial path loses
+	 * against a clean full rebuild. */
+	if (tagged.size() * 4 > graph->id_hash.size()) {
+		return false;
+	}
+
+	/* Datablock removal only tags relations for update, so the graph (and the
+	 * tagged set itself) may reference freed IDs which we can not inspect.
+	 */
+	unordered_set<const ID *> valid_ids;
+	deg_main_collect_ids(bmain, &valid_ids);
+	for (Depsgraph::IDNodeMap::const_iterator it = graph->id_hash.begin();
+	     it != graph->id_hash.end();
+	     ++it)
+	{
+		if (valid_ids.find(it->first) == valid_ids.end()) {
+			return false;
+		}
+	}
+	for (Depsgraph::IDSet::const_iterator it = tagged.begin(); it != tagged.end(); ++it) {
+		if (valid_ids.find(*it) == valid_ids.end()) {
+			return false;
+		}
+	}
+
+	/* All tagged IDs must be objects with a base in this scene. */
+	unordered_map<const ID *, Base *> base_map;
+	for (Base *base = (Base *)scene->base.first; base; base = base->next) {
+		base_map[&base->object->id] = base;
+	}
+	for (Depsgraph::IDSet::const_iterator it = tagged.begin(); it != tagged.end(); ++it) {
+		ID *id = *it;
+		if (GS(id->name) != ID_OB) {
+			return false;
+		}
+		Object *ob = (Object *)id;
+		if (base_map.find(id) == base_map.end()) {
+			return false;
+		}
+		if (ob->proxy || ob->proxy_from || ob->dup_group) {
+			return false;
+		}
+	}
+	/* Dupli relations of group members are built from the duplicator side. */
+	for (Group *group = (Group *)bmain->group.first;
+	     group != NULL;
+	     group = (Group *)group->id.next)
+	{
+		for (GroupObject *go = (GroupObject *)group->gobject.first; go; go = go->next) {
+			if (go->ob && tagged.find(&go->ob->id) != tagged.end()) {
+				return false;
+			}
+		}
+	}
+
+	/* IDs with relations reaching into the tagged nodes: those relations die
+	 * together with the rebuilt nodes, so their build pass has to be re-run
+	 * as well to restore them (re-created relations which still exist are
+	 * caught by the duplicate check in Depsgraph::add_new_relation).
+	 */
+	Depsgraph::IDSet rebuild_relations;
+	for (Depsgraph::IDSet::const_iterator it = tagged.begin(); it != tagged.end(); ++it) {
+		IDDepsNode *id_node = graph->find_id_node(*it);
+		if (id_node == NULL) {
+			/* Freshly added ID, no nodes to drop. */
+			continue;
+		}
+		vector<DepsNode *> nodes;
+		deg_id_node_collect_nodes(id_node, &nodes);
+		for (int i = 0; i < (int)nodes.size(); ++i) {
+			DepsNode *node = nodes[i];
+			for (int dir = 0; dir < 2; ++dir) {
+				DepsNode::Relations &links = (dir == 0) ? node->inlinks : node->outlinks;
+				for (DepsNode::Relations::const_iterator it_rel = links.begin();
+				     it_rel != links.end();
+				     ++it_rel)
+				{
+					DepsRelation *rel = *it_rel;
+					IDDepsNode *other = deg_node_id_owner((dir == 0) ? rel->from : rel->to);
+					if (other == NULL || other == id_node) {
+						continue;
+					}
+					ID *other_id = other->id;
+					if (tagged.find(other_id) != tagged.end()) {
+						continue;
+					}
+					/* Relations from non-object IDs (scene rigid body,
+					 * material drivers, ...) are not re-buildable on their
+					 * own, same for objects we have no base for. */
+					if (GS(other_id->name) != ID_OB ||
+					    base_map.find(other_id) == base_map.end())
+					{
+						return false;
+					}
+					rebuild_relations.insert(other_id);
+				}
+			}
+		}
+	}
+
+	/* Past this point we start modifying the graph, no more bailing out. */
+
+	/* Drop the nodes of the tagged IDs. Relations are only freed from their
+	 * incoming side by the node destructors (see DepsNode::~DepsNode), so
+	 * unlink both directions explicitly first to keep the surviving nodes
+	 * free of dangling pointers.
+	 */
+	unordered_set<IDDepsNode *> removed_id_nodes;
+	for (Depsgraph::IDSet::const_iterator it = tagged.begin(); it != tagged.end(); ++it) {
+		IDDepsNode *id_node = graph->find_id_node(*it);
+		if (id_node != NULL) {
+			removed_id_nodes.insert(id_node);
+		}
+	}
+	if (!removed_id_nodes.empty()) {
+		Depsgraph::OperationNodes operations;
+		operations.reserve(graph->operations.size());
+		for (Depsgraph::OperationNodes::const_iterator it = graph->operations.begin();
+		     it != graph->operations.end();
+		     ++it)
+		{
+			OperationDepsNode *node = *it;
+			if (removed_id_nodes.find(node->owner->owner) == removed_id_nodes.end()) {
+				operations.push_back(node);
+			}
+		}
+		graph->operations.swap(operations);
+
+		Depsgraph::EntryTags entry_tags;
+		for (Depsgraph::EntryTags::const_iterator it = graph->entry_tags.begin();
+		     it != graph->entry_tags.end();
+		     ++it)
+		{
+			OperationDepsNode *node = *it;
+			if (removed_id_nodes.find(node->owner->owner) == removed_id_nodes.end()) {
+				entry_tags.insert(node);
+			}
+		}
+		graph->entry_tags.swap(entry_tags);
+
+		for (unordered_set<IDDepsNode *>::const_iterator it = removed_id_nodes.begin();
+		     it != removed_id_nodes.end();
+		     ++it)
+		{
+			vector<DepsNode *> nodes;
+			deg_id_node_collect_nodes(*it, &nodes);
+			for (int i = 0; i < (int)nodes.size(); ++i) {
+				DepsNode *node = nodes[i];
+				for (DepsNode::Relations::const_iterator it_rel = node->inlinks.begin();
+				     it_rel != node->inlinks.end();
+				     ++it_rel)
+				{
+					deg_relation_unlink((*it_rel)->from->outlinks, *it_rel);
+				}
+				for (DepsNode::Relations::const_iterator it_rel = node->outlinks.begin();
+				     it_rel != node->outlinks.end();
+				     ++it_rel)
+				{
+					DepsRelation *rel = *it_rel;
+					deg_relation_unlink(rel->to->inlinks, rel);
+					OBJECT_GUARDED_DELETE(rel, DepsRelation);
+				}
+				node->outlinks.clear();
+			}
+		}
+		for (unordered_set<IDDepsNode *>::const_iterator it = removed_id_nodes.begin();
+		     it != removed_id_nodes.end();
+		     ++it)
+		{
+			graph->remove_id_node((*it)->id);
+		}
+	}
+
+	/* Rebuild nodes. The "built already" state of the node builder is
+	 * restored from the current graph contents, so only the missing nodes
+	 * (the tagged IDs, plus whatever new datablocks they reference) get
+	 * created.
+	 */
+	unordered_set<const ID *> built_ids;
+	for (Depsgraph::IDNodeMap::const_iterator it = graph->id_hash.begin();
+	     it != graph->id_hash.end();
+	     ++it)
+	{
+		built_ids.insert(it->first);
+	}
+	deg_main_tag_ids_built(bmain, built_ids);
+
+	DepsgraphNodeBuilder node_builder(bmain, graph);
+	for (Depsgraph::IDSet::const_iterator it = tagged.begin(); it != tagged.end(); ++it) {
+		Object *ob = (Object *)*it;
+		node_builder.build_object(scene, base_map[*it], ob);
+	}
+
+	/* Rebuild relations, both for the tagged IDs and for the IDs whose
+	 * relations used to reach into them.
+	 */
+	for (Depsgraph::IDSet::const_iterator it = rebuild_relations.begin();
+	     it != rebuild_relations.end();
+	     ++it)
+	{
+		built_ids.erase(*it);
+	}
+	deg_main_tag_ids_built(bmain, built_ids);
+
+	DepsgraphRelationBuilder relation_builder(graph);
+	for (Depsgraph::IDSet::const_iterator it = tagged.begin(); it != tagged.end(); ++it) {
+		relation_builder.build_object(bmain, scene, (Object *)*it);
+	}
+	for (Depsgraph::IDSet::const_iterator it = rebuild_relations.begin();
+	     it != rebuild_relations.end();
+	     ++it)
+	{
+		relation_builder.build_object(bmain, scene, (Object *)*it);
+	}
+
+	/* Same post-passes as the full build. */
+	deg_graph_detect_cycles(graph);
+	deg_graph_build_finalize(graph);
+
+	return true;
+}
+
 /* Create new graph if didn't exist yet,
  * or update relations if graph was tagged for update.
  */
@@ -345,6 +681,13 @@ void DEG_scene_relations_update(Main *bmain, Scene *scene)
 		return;
 	}
 
+	if (deg_graph_rebuild_partial(graph, bmain, scene)) {
+		/* Updated in place, keeping the untouched nodes and relations. */
+		graph->need_update = false;
+		graph->need_update_ids.clear();
+		return;
+	}
+
 	/* Clear all previous nodes and operations. */
 	graph->clear_all_nodes();
 	graph->operations.clear();
@@ -354,6 +697,7 @@ void DEG_scene_relations_update(Main *bmain, Scene *scene)
 	DEG_graph_build_from_scene(graph, bmain, scene);
 
 	graph->need_update = false;
+	graph->need_update_ids.clear();
 }
 
 /* Rebuild dependency graph only for a given scene. */
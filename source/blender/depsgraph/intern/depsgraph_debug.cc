@@ -33,6 +33,10 @@
 //#include <stdlib.h>
 #include <string.h>
 
+#include "PIL_time.h"
+
+#include "atomic_ops.h"
+
 extern "C" {
 #include "BLI_utildefines.h"
 #include "BLI_listbase.h"
@@ -175,6 +179,12 @@ struct DebugContext {
 	FILE *file;
 	bool show_tags;
 	bool show_eval_priority;
+	/* Color operation nodes by total recorded evaluation time
+	 * (see DEG_debug_profile_dump_graphviz).
+	 */
+	bool show_profile;
+	const unordered_map<const OperationDepsNode *, double> *profile_times;
+	double profile_max_time;
 };
 
 static void deg_debug_fprintf(const DebugContext &ctx, const char *fmt, ...) ATTR_PRINTF_FORMAT(2, 3);
@@ -312,6 +322,18 @@ static void deg_debug_graphviz_node_fillcolor(const DebugContext &ctx,
                                               const DepsNode *node)
 {
 	const char *defaultcolor = "gainsboro";
+	if (ctx.show_profile &&
+	    node->tclass == DEPSNODE_CLASS_OPERATION &&
+	    ctx.profile_max_time > 0.0)
+	{
+		/* White to red ramp, the hottest operation saturates. */
+		unordered_map<const OperationDepsNode *, double>::const_iterator it =
+		        ctx.profile_times->find((const OperationDepsNode *)node);
+		const double time = (it != ctx.profile_times->end()) ? it->second : 0.0;
+		const int channel = 255 - (int)((time / ctx.profile_max_time) * 255.0);
+		deg_debug_fprintf(ctx, "\"#ff%02x%02x\"", channel, channel);
+		return;
+	}
 	int color_index = deg_debug_node_color_index(node);
 	const char *fillcolor = color_index < 0 ? defaultcolor : deg_debug_colors_light[color_index % deg_debug_max_colors];
 	deg_debug_fprintf(ctx, "\"%s\"", fillcolor);
@@ -739,6 +761,10 @@ static void deg_debug_graphviz_graph_relations(const DebugContext &ctx,
 #endif
 }
 
+static void deg_debug_graphviz_write(const DebugContext &ctx,
+                                     const Depsgraph *graph,
+                                     const char *label);
+
 void DEG_debug_graphviz(const Depsgraph *graph, FILE *f, const char *label, bool show_eval)
 {
 #if 0 /* generate shaded color set */
@@ -759,7 +785,17 @@ void DEG_debug_graphviz(const Depsgraph *graph, FILE *f, const char *label, bool
 	ctx.file = f;
 	ctx.show_tags = show_eval;
 	ctx.show_eval_priority = show_eval;
+	ctx.show_profile = false;
+	ctx.profile_times = NULL;
+	ctx.profile_max_time = 0.0;
+
+	deg_debug_graphviz_write(ctx, graph, label);
+}
 
+static void deg_debug_graphviz_write(const DebugContext &ctx,
+                                     const Depsgraph *graph,
+                                     const char *label)
+{
 	deg_debug_fprintf(ctx, "digraph depgraph {" NL);
 	deg_debug_fprintf(ctx, "rankdir=LR;" NL);
 	deg_debug_fprintf(ctx, "graph [");
@@ -875,6 +911,164 @@ void DepsgraphDebug::task_completed(Depsgraph *graph,
 	}
 }
 
+/* ************************************************ */
+/* Per-Operation Evaluation Profiling */
+
+/* Number of samples kept in the ring buffer, older samples get overwritten. */
+#define DEG_PROFILE_SAMPLES_NUM 16384
+
+typedef struct DepsgraphProfileSample {
+	/* Identifier is copied because operation nodes can be freed by a graph
+	 * rebuild while samples are still being kept around for dumping.
+	 */
+	char name[96];
+	/* Seconds since DEG_debug_profile_start(), and duration in seconds. */
+	double start;
+	double duration;
+	/* Only used for matching against a live graph, never dereferenced. */
+	const OperationDepsNode *node;
+	int thread_id;
+} DepsgraphProfileSample;
+
+static DepsgraphProfileSample *deg_profile_samples = NULL;
+/* Total number of samples recorded, slot is index % DEG_PROFILE_SAMPLES_NUM. */
+static uint32_t deg_profile_sample_index = 0;
+static double deg_profile_start_time = 0.0;
+static bool deg_profile_running = false;
+
+void DepsgraphDebug::task_profile(const OperationDepsNode *node,
+                                  double start_time,
+                                  double end_time,
+                                  int thread_id)
+{
+	DepsgraphProfileSample *sample;
+	uint32_t index;
+
+	if (!deg_profile_running) {
+		return;
+	}
+
+	index = atomic_add_uint32(&deg_profile_sample_index, 1) - 1;
+	sample = &deg_profile_samples[index % DEG_PROFILE_SAMPLES_NUM];
+
+	BLI_strncpy(sample->name, node->identifier().c_str(), sizeof(sample->name));
+	sample->start = start_time - deg_profile_start_time;
+	sample->duration = end_time - start_time;
+	sample->node = node;
+	sample->thread_id = thread_id;
+}
+
+void DEG_debug_profile_start(void)
+{
+	if (deg_profile_running) {
+		return;
+	}
+	if (deg_profile_samples == NULL) {
+		deg_profile_samples = (DepsgraphProfileSample *)MEM_callocN(
+		        sizeof(DepsgraphProfileSample) * DEG_PROFILE_SAMPLES_NUM,
+		        "DepsgraphProfileSample ring");
+	}
+	deg_profile_sample_index = 0;
+	deg_profile_start_time = PIL_check_seconds_timer();
+	deg_profile_running = true;
+}
+
+void DEG_debug_profile_stop(void)
+{
+	/* Buffer is kept around so the samples can still be dumped,
+	 * it is freed together with the stats on exit.
+	 */
+	deg_profile_running = false;
+}
+
+static int deg_profile_num_samples(void)
+{
+	if (deg_profile_samples == NULL) {
+		return 0;
+	}
+	return (int)MIN2(deg_profile_sample_index, (uint32_t)DEG_PROFILE_SAMPLES_NUM);
+}
+
+/* Minimal JSON string escaping, node identifiers are plain enough
+ * that quotes and backslashes are all that can realistically occur.
+ */
+static void deg_profile_json_string(FILE *f, const char *str)
+{
+	const char *ch;
+	fputc('"', f);
+	for (ch = str; *ch; ++ch) {
+		if (*ch == '"' || *ch == '\\') {
+			fputc('\\', f);
+		}
+		fputc(*ch, f);
+	}
+	fputc('"', f);
+}
+
+void DEG_debug_profile_dump_json(FILE *stream)
+{
+	const int tot = deg_profile_num_samples();
+	int i;
+
+	fprintf(stream, "[");
+	for (i = 0; i < tot; ++i) {
+		DepsgraphProfileSample *sample = &deg_profile_samples[i];
+
+		fprintf(stream, "%s\n{\"name\": ", (i == 0) ? "" : ",");
+		deg_profile_json_string(stream, sample->name);
+		fprintf(stream,
+		        ", \"cat\": \"depsgraph\", \"ph\": \"X\", \"pid\": 1, "
+		        "\"tid\": %d, \"ts\": %.0f, \"dur\": %.0f}",
+		        sample->thread_id,
+		        sample->start * 1e6,
+		        sample->duration * 1e6);
+	}
+	fprintf(stream, "\n]\n");
+}
+
+void DEG_debug_profile_dump_graphviz(const Depsgraph *graph,
+                                     FILE *stream,
+                                     const char *label)
+{
+	const int tot = deg_profile_num_samples();
+	unordered_set<const OperationDepsNode *> live_nodes;
+	unordered_map<const OperationDepsNode *, double> times;
+	double max_time = 0.0;
+	int i;
+
+	if (!graph) {
+		return;
+	}
+
+	/* Only accumulate samples whose node still exists in this graph, stale
+	 * pointers from before a rebuild must not alias onto new nodes.
+	 */
+	for (Depsgraph::OperationNodes::const_iterator it = graph->operations.begin();
+	     it != graph->operations.end();
+	     ++it)
+	{
+		live_nodes.insert(*it);
+	}
+	for (i = 0; i < tot; ++i) {
+		DepsgraphProfileSample *sample = &deg_profile_samples[i];
+		if (live_nodes.find(sample->node) != live_nodes.end()) {
+			double &time = times[sample->node];
+			time += sample->duration;
+			max_time = MAX2(max_time, time);
+		}
+	}
+
+	DebugContext ctx;
+	ctx.file = stream;
+	ctx.show_tags = false;
+	ctx.show_eval_priority = false;
+	ctx.show_profile = true;
+	ctx.profile_times = &times;
+	ctx.profile_max_time = max_time;
+
+	deg_debug_graphviz_write(ctx, graph, label);
+}
+
 /* ********** */
 /* Statistics */
 
@@ -906,6 +1100,10 @@ void DepsgraphDebug::stats_free()
 		MEM_freeN(stats);
 		stats = NULL;
 	}
+	if (deg_profile_samples) {
+		MEM_freeN(deg_profile_samples);
+		deg_profile_samples = NULL;
+	}
 }
 
 void DepsgraphDebug::verify_stats()
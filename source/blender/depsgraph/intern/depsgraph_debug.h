@@ -65,6 +65,14 @@ struct DepsgraphDebug {
 	                           const OperationDepsNode *node,
 	                           double time);
 
+	/* Record a sample into the profiling ring buffer,
+	 * no-op unless DEG_debug_profile_start() was called.
+	 */
+	static void task_profile(const OperationDepsNode *node,
+	                         double start_time,
+	                         double end_time,
+	                         int thread_id);
+
 	static DepsgraphStatsID *get_id_stats(ID *id, bool create);
 	static DepsgraphStatsComponent *get_component_stats(DepsgraphStatsID *id_stats,
 	                                                    const string &name,
@@ -56,8 +56,12 @@ extern "C" {
 static bool use_legacy_depsgraph = true;
 #endif
 
-/* Unfinished and unused, and takes quite some pre-processing time. */
-#undef USE_EVAL_PRIORITY
+/* Schedule operations on the longest (most expensive) dependency chains
+ * first, using evaluation costs measured on the previous runs, so a single
+ * heavy chain doesn't end up being started last while all other threads
+ * already ran out of work.
+ */
+#define USE_EVAL_PRIORITY
 
 bool DEG_depsgraph_use_legacy(void)
 {
@@ -132,6 +136,12 @@ struct DepsgraphEvalState {
 	EvaluationContext *eval_ctx;
 	Depsgraph *graph;
 	int layers;
+#ifdef USE_EVAL_PRIORITY
+	/* Nodes with a higher eval_priority than this are scheduled with high
+	 * task priority, average priority of all nodes needing an update.
+	 */
+	float priority_threshold;
+#endif
 };
 
 static void deg_task_run_func(TaskPool *pool,
@@ -170,6 +180,19 @@ static void deg_task_run_func(TaskPool *pool,
 			DepsgraphDebug::task_completed(state->graph,
 			                               node,
 			                               end_time - start_time);
+			DepsgraphDebug::task_profile(node, start_time, end_time, thread_id);
+
+			/* Update the cost estimate for the priority of the next runs.
+			 * Exponential moving average so occasional spikes (first evaluation
+			 * after a file load for example) fade out again.
+			 */
+			const float duration = (float)(end_time - start_time);
+			if (node->eval_cost == 0.0f) {
+				node->eval_cost = duration;
+			}
+			else {
+				node->eval_cost = 0.75f * node->eval_cost + 0.25f * duration;
+			}
 		}
 
 		/* If there's only one outgoing link we try to immediately switch to
@@ -187,6 +210,7 @@ static void deg_task_run_func(TaskPool *pool,
 			BLI_assert(child->type == DEPSNODE_TYPE_OPERATION);
 			if (!child->scheduled) {
 				int id_layers = child->owner->owner->layers;
+				uint32_t num_links_pending = child->num_links_pending;
 				if (!((child->flag & DEPSOP_FLAG_NEEDS_UPDATE) != 0 &&
 				      (id_layers & state->layers) != 0))
 				{
@@ -198,9 +222,13 @@ static void deg_task_run_func(TaskPool *pool,
 				}
 				if ((rel->flag & DEPSREL_FLAG_CYCLIC) == 0) {
 					BLI_assert(child->num_links_pending > 0);
-					atomic_sub_uint32(&child->num_links_pending, 1);
+					/* Use the decremented value directly, re-reading the field
+					 * can miss a concurrent decrement by another parent and
+					 * leave the node unscheduled forever.
+					 */
+					num_links_pending = atomic_sub_uint32(&child->num_links_pending, 1);
 				}
-				if (child->num_links_pending == 0) {
+				if (num_links_pending == 0) {
 					bool is_scheduled = atomic_fetch_and_or_uint8((uint8_t *)&child->scheduled, (uint8_t)true);
 					if (!is_scheduled) {
 						/* Node was not scheduled, switch to it! */
@@ -255,6 +283,7 @@ static void calculate_pending_func(void *data_v, int i)
 
 	node->num_links_pending = 0;
 	node->scheduled = false;
+	node->done = 0;
 
 	/* count number of inputs that need updates */
 	if ((id_node->layers & layers) != 0 &&
@@ -297,10 +326,14 @@ static void calculate_eval_priority(OperationDepsNode *node)
 	node->done = 1;
 
 	if (node->flag & DEPSOP_FLAG_NEEDS_UPDATE) {
-		/* XXX standard cost of a node, could be estimated somewhat later on */
-		const float cost = 1.0f;
-		/* NOOP nodes have no cost */
-		node->eval_priority = node->is_noop() ? cost : 0.0f;
+		/* Measured cost of past evaluations of this node, with a small
+		 * default for nodes which were never evaluated yet. NOOP nodes
+		 * have no cost.
+		 */
+		const float default_cost = 1e-4f;
+		const float cost = (node->eval_cost > 0.0f) ? node->eval_cost
+		                                            : default_cost;
+		float max_child_priority = 0.0f;
 
 		for (OperationDepsNode::Relations::const_iterator it = node->outlinks.begin();
 		     it != node->outlinks.end();
@@ -309,9 +342,17 @@ static void calculate_eval_priority(OperationDepsNode *node)
 			DepsRelation *rel = *it;
 			OperationDepsNode *to = (OperationDepsNode *)rel->to;
 			BLI_assert(to->type == DEPSNODE_TYPE_OPERATION);
+			if (rel->flag & DEPSREL_FLAG_CYCLIC) {
+				continue;
+			}
 			calculate_eval_priority(to);
-			node->eval_priority += to->eval_priority;
+			max_child_priority = MAX2(max_child_priority, to->eval_priority);
 		}
+
+		/* Priority is the critical path length: the node's own cost plus the
+		 * most expensive chain of work depending on it.
+		 */
+		node->eval_priority = (node->is_noop() ? 0.0f : cost) + max_child_priority;
 	}
 	else {
 		node->eval_priority = 0.0f;
@@ -328,16 +369,18 @@ static void schedule_node(TaskPool *pool, Depsgraph *graph, int layers,
                           const int thread_id)
 {
 	int id_layers = node->owner->owner->layers;
-	
+
 	if ((node->flag & DEPSOP_FLAG_NEEDS_UPDATE) != 0 &&
 	    (id_layers & layers) != 0)
 	{
+		uint32_t num_links_pending = node->num_links_pending;
 		if (dec_parents) {
 			BLI_assert(node->num_links_pending > 0);
-			atomic_sub_uint32(&node->num_links_pending, 1);
+			/* Use the decremented value directly, see deg_task_run_func(). */
+			num_links_pending = atomic_sub_uint32(&node->num_links_pending, 1);
 		}
 
-		if (node->num_links_pending == 0) {
+		if (num_links_pending == 0) {
 			bool is_scheduled = atomic_fetch_and_or_uint8((uint8_t *)&node->scheduled, (uint8_t)true);
 			if (!is_scheduled) {
 				if (node->is_noop()) {
@@ -345,12 +388,25 @@ static void schedule_node(TaskPool *pool, Depsgraph *graph, int layers,
 					schedule_children(pool, graph, node, layers, thread_id);
 				}
 				else {
+					/* Nodes on an expensive dependency chain go to the front
+					 * of the queue, the only granularity the task scheduler
+					 * gives us.
+					 */
+#ifdef USE_EVAL_PRIORITY
+					DepsgraphEvalState *state =
+					        (DepsgraphEvalState *)BLI_task_pool_userdata(pool);
+					TaskPriority priority =
+					        (node->eval_priority > state->priority_threshold) ?
+					                TASK_PRIORITY_HIGH : TASK_PRIORITY_LOW;
+#else
+					TaskPriority priority = TASK_PRIORITY_LOW;
+#endif
 					/* children are scheduled once this task is completed */
 					BLI_task_pool_push_from_thread(pool,
 					                               deg_task_run_func,
 					                               node,
 					                               false,
-					                               TASK_PRIORITY_LOW,
+					                               priority,
 					                               thread_id);
 				}
 			}
@@ -358,17 +414,38 @@ static void schedule_node(TaskPool *pool, Depsgraph *graph, int layers,
 	}
 }
 
+typedef struct ScheduleGraphData {
+	TaskPool *pool;
+	Depsgraph *graph;
+	int layers;
+} ScheduleGraphData;
+
+static void schedule_graph_func(void *data_v,
+                                void *UNUSED(userdata_chunk),
+                                const int i,
+                                const int thread_id)
+{
+	ScheduleGraphData *data = (ScheduleGraphData *)data_v;
+	OperationDepsNode *node = data->graph->operations[i];
+	schedule_node(data->pool, data->graph, data->layers, node, false, thread_id);
+}
+
+/* Schedule the initial set of ready nodes, from multiple threads for the
+ * large graphs so the workers don't sit idle while a single thread walks
+ * over all operations.
+ */
 static void schedule_graph(TaskPool *pool,
                            Depsgraph *graph,
                            const int layers)
 {
-	for (Depsgraph::OperationNodes::const_iterator it = graph->operations.begin();
-	     it != graph->operations.end();
-	     ++it)
-	{
-		OperationDepsNode *node = *it;
-		schedule_node(pool, graph, layers, node, false, 0);
-	}
+	const int num_operations = graph->operations.size();
+	const bool do_threads = num_operations > 256;
+	ScheduleGraphData data;
+	data.pool = pool;
+	data.graph = graph;
+	data.layers = layers;
+	BLI_task_parallel_range_ex(0, num_operations, &data, NULL, 0,
+	                           schedule_graph_func, do_threads, false);
 }
 
 static void schedule_children(TaskPool *pool,
@@ -426,25 +503,28 @@ void DEG_evaluate_on_refresh_ex(EvaluationContext *eval_ctx,
 		BLI_pool_set_num_threads(task_pool, 1);
 	}
 
+	/* Also clears the scheduled/done tags, all from worker threads. */
 	calculate_pending_parents(graph, layers);
 
-	/* Clear tags. */
-	for (Depsgraph::OperationNodes::const_iterator it = graph->operations.begin();
-	     it != graph->operations.end();
-	     ++it)
-	{
-		OperationDepsNode *node = *it;
-		node->done = 0;
-	}
-
 	/* Calculate priority for operation nodes. */
 #ifdef USE_EVAL_PRIORITY
-	for (Depsgraph::OperationNodes::const_iterator it = graph->operations.begin();
-	     it != graph->operations.end();
-	     ++it)
 	{
-		OperationDepsNode *node = *it;
-		calculate_eval_priority(node);
+		double priority_sum = 0.0;
+		int num_priorities = 0;
+		for (Depsgraph::OperationNodes::const_iterator it = graph->operations.begin();
+		     it != graph->operations.end();
+		     ++it)
+		{
+			OperationDepsNode *node = *it;
+			calculate_eval_priority(node);
+			if (node->eval_priority > 0.0f) {
+				priority_sum += node->eval_priority;
+				num_priorities++;
+			}
+		}
+		state.priority_threshold =
+		        (num_priorities != 0) ? (float)(priority_sum / num_priorities)
+		                              : 0.0f;
 	}
 #endif
 
@@ -44,6 +44,7 @@ extern "C" {
 
 #include "BLI_task.h"
 
+#include "BKE_anim.h"
 #include "BKE_library.h"
 #include "BKE_main.h"
 #include "BKE_node.h"
@@ -120,6 +121,73 @@ void lib_id_recalc_tag_flag(Main *bmain, ID *id, int flag)
 	}
 }
 
+/* Tag only those components of an object which correspond to the given
+ * update flags, so e.g. a transform-only tag doesn't force the whole
+ * modifier stack to re-evaluate. Downstream nodes are still reached via
+ * the relations flush, which only follows links out of tagged components.
+ */
+void depsgraph_object_tag_components(Depsgraph *graph,
+                                     IDDepsNode *id_node,
+                                     short flag)
+{
+	for (IDDepsNode::ComponentMap::const_iterator it = id_node->components.begin();
+	     it != id_node->components.end();
+	     ++it)
+	{
+		ComponentDepsNode *comp_node = it->second;
+		bool do_component_tag;
+		switch (comp_node->type) {
+			case DEPSNODE_TYPE_ANIMATION:
+				do_component_tag = (flag & OB_RECALC_TIME) != 0;
+				break;
+			case DEPSNODE_TYPE_TRANSFORM:
+				do_component_tag = (flag & OB_RECALC_OB) != 0;
+				break;
+			case DEPSNODE_TYPE_GEOMETRY:
+			case DEPSNODE_TYPE_EVAL_POSE:
+			case DEPSNODE_TYPE_BONE:
+			case DEPSNODE_TYPE_EVAL_PARTICLES:
+			case DEPSNODE_TYPE_SHADING:
+				do_component_tag = (flag & OB_RECALC_DATA) != 0;
+				break;
+			default:
+				/* Can't reason about the scope of the change for this
+				 * component, tag it to stay on the safe side.
+				 */
+				do_component_tag = true;
+				break;
+		}
+		if (do_component_tag) {
+			comp_node->tag_update(graph);
+		}
+	}
+}
+
+/* Flag-aware version of DEG_graph_id_tag_update(), tagging components
+ * selectively when the flags tell us the scope of the change.
+ */
+void depsgraph_id_tag_update_flag(Main *bmain, Depsgraph *graph, ID *id, short flag)
+{
+	IDDepsNode *id_node = graph->find_id_node(id);
+	lib_id_recalc_tag(bmain, id);
+	/* Remember the ID for a possible partial relations rebuild,
+	 * see DEG_graph_id_tag_update().
+	 */
+	graph->need_update_ids.insert(id);
+	if (id_node == NULL) {
+		return;
+	}
+	if (GS(id->name) == ID_OB &&
+	    (flag & ~(OB_RECALC_OB | OB_RECALC_DATA | OB_RECALC_TIME)) == 0)
+	{
+		depsgraph_object_tag_components(graph, id_node, flag);
+	}
+	else {
+		/* Unknown flag bits or non-object ID, tag everything. */
+		id_node->tag_update(graph);
+	}
+}
+
 #ifdef DEPSGRAPH_USE_LEGACY_TAGGING
 void depsgraph_legacy_handle_update_tag(Main *bmain, ID *id, short flag)
 {
@@ -156,6 +224,10 @@ void DEG_graph_id_tag_update(Main *bmain, Depsgraph *graph, ID *id)
 {
 	IDDepsNode *node = graph->find_id_node(id);
 	lib_id_recalc_tag(bmain, id);
+	/* Remember the ID for a possible partial relations rebuild: together with
+	 * the entry tags this is a superset of the structurally modified IDs
+	 * (see deg_graph_rebuild_partial()). */
+	graph->need_update_ids.insert(id);
 	if (node != NULL) {
 		node->tag_update(graph);
 	}
@@ -202,6 +274,8 @@ void DEG_id_tag_update_ex(Main *bmain, ID *id, short flag)
 		return;
 	}
 	DEG_DEBUG_PRINTF("%s: id=%s flag=%d\n", __func__, id->name, flag);
+	/* Edits can move instanced objects around, drop cached dupli lists. */
+	object_dupli_cache_invalidate();
 	lib_id_recalc_tag_flag(bmain, id, flag);
 	for (Scene *scene = (Scene *)bmain->scene.first;
 	     scene != NULL;
@@ -226,7 +300,7 @@ void DEG_id_tag_update_ex(Main *bmain, ID *id, short flag)
 				}
 			}
 			if (flag & (OB_RECALC_OB | OB_RECALC_DATA)) {
-				DEG_graph_id_tag_update(bmain, graph, id);
+				depsgraph_id_tag_update_flag(bmain, graph, id, flag);
 			}
 		}
 	}
@@ -417,6 +491,12 @@ void DEG_graph_clear_tags(Depsgraph *graph)
 	BLI_task_parallel_range(0, num_operations, graph, graph_clear_func, do_threads);
 	/* Clear any entry tags which haven't been flushed. */
 	graph->entry_tags.clear();
+	/* Evaluation consumed the tagged IDs, only IDs tagged after this point
+	 * are candidates for a partial relations rebuild. Keep the set while a
+	 * rebuild is still pending though. */
+	if (!graph->need_update) {
+		graph->need_update_ids.clear();
+	}
 }
 
 /* Update dependency graph when visible scenes/layers changes. */
@@ -75,6 +75,7 @@ struct OperationDepsNode : public DepsNode {
 
 	uint32_t num_links_pending; /* how many inlinks are we still waiting on before we can be evaluated... */
 	float eval_priority;
+	float eval_cost;              /* moving average of measured evaluation time, in seconds */
 	bool scheduled;
 
 	short optype;                 /* (eDepsOperation_Type) stage of evaluation */
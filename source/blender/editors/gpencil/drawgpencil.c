@@ -40,6 +40,7 @@
 #include "BLI_sys_types.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "BLI_polyfill2d.h"
 
@@ -816,12 +817,32 @@ static bool gp_can_draw_stroke(const bGPDstroke *gps, const int dflag)
 	return true;
 }
 
+/* refresh the triangulation cache of one stroke, see gp_draw_strokes */
+static void gp_stroke_triangulate_task_cb(void *userdata, Link *iter, int UNUSED(index))
+{
+	const int dflag = *(const int *)userdata;
+	bGPDstroke *gps = (bGPDstroke *)iter;
+
+	if ((gps->totpoints < 3) || (gp_can_draw_stroke(gps, dflag) == false))
+		return;
+
+	if ((gps->flag & GP_STROKE_RECALC_CACHES) || (gps->tot_triangles == 0) || (gps->triangles == NULL)) {
+		gp_triangulate_stroke_fill(gps);
+	}
+}
+
 /* draw a set of strokes */
 static void gp_draw_strokes(bGPDframe *gpf, int offsx, int offsy, int winx, int winy, int dflag,
                             bool debug, short lthick, const float color[4], const float fill_color[4])
 {
 	bGPDstroke *gps;
-	
+
+	/* with high quality fill, refresh all out of date triangulation caches up
+	 * front and in parallel, drawing the fills then only reads the caches */
+	if ((dflag & GP_DRAWDATA_FILL) && (dflag & GP_DRAWDATA_HQ_FILL)) {
+		BLI_task_parallel_listbase(&gpf->strokes, &dflag, gp_stroke_triangulate_task_cb, true);
+	}
+
 	for (gps = gpf->strokes.first; gps; gps = gps->next) {
 		/* check if stroke can be drawn */
 		if (gp_can_draw_stroke(gps, dflag) == false)
@@ -57,6 +57,22 @@ struct SnapObjectHitDepth {
 	unsigned int ob_uuid;
 };
 
+/** a single ray in a batched query, results are written back in place */
+struct SnapObjectRay {
+	/* input */
+	float ray_start[3];
+	float ray_normal[3];
+	float ray_depth;  /* updated to the depth of the nearest hit */
+
+	/* output */
+	bool has_hit;
+	float loc[3];
+	float no[3];
+	int index;
+	struct Object *ob;
+	float obmat[4][4];
+};
+
 struct SnapObjectParams {
 	int snap_select;  /* SnapSelect */
 	union {
@@ -110,6 +126,11 @@ bool ED_transform_snap_object_project_ray_all(
         float ray_depth, bool sort,
         struct ListBase *r_hit_list);
 
+bool ED_transform_snap_object_project_ray_batch(
+        SnapObjectContext *sctx,
+        const struct SnapObjectParams *params,
+        struct SnapObjectRay *rays, const int rays_len);
+
 bool ED_transform_snap_object_project_view3d_ex(
         struct SnapObjectContext *sctx,
         const struct SnapObjectParams *params,
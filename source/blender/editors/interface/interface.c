@@ -1343,6 +1343,18 @@ static void ui_but_to_pixelrect(rcti *rect, const ARegion *ar, uiBlock *block, u
 }
 
 /* uses local copy of style, to scale things down, and allow widgets to change stuff */
+static bool ui_block_has_links(const uiBlock *block)
+{
+	const uiBut *but;
+
+	for (but = block->buttons.first; but; but = but->next) {
+		if (but->type == UI_BTYPE_LINK && but->link) {
+			return true;
+		}
+	}
+	return false;
+}
+
 void UI_block_draw(const bContext *C, uiBlock *block)
 {
 	uiStyle style = *UI_style_get_dpi();  /* XXX pass on as arg */
@@ -1359,6 +1371,25 @@ void UI_block_draw(const bContext *C, uiBlock *block)
 	if (!block->endblock)
 		UI_block_end(C, block);
 
+	/* panels scrolled fully out of view don't need their widgets drawn, this
+	 * is where the time goes with long panel lists (button rects are never
+	 * clipped individually). Closed panels draw the header along an edge and
+	 * blocks with link buttons can draw lines across the visible part, so
+	 * both keep drawing. */
+	if (block->panel && !(block->panel->flag & (PNL_CLOSEDX | PNL_CLOSEDY))) {
+		rcti rect_clip, winrect;
+
+		ui_but_to_pixelrect(&rect_clip, ar, block, NULL);
+		/* the panel header is drawn above the block rect */
+		rect_clip.ymax += (int)ceilf(PNL_HEADER / block->aspect);
+
+		BLI_rcti_init(&winrect, 0, ar->winx, 0, ar->winy);
+
+		if (!BLI_rcti_isect(&winrect, &rect_clip, NULL) && !ui_block_has_links(block)) {
+			return;
+		}
+	}
+
 	/* disable AA, makes widgets too blurry */
 	multisample_enabled = glIsEnabled(GL_MULTISAMPLE);
 	if (multisample_enabled)
@@ -45,6 +45,8 @@
 #include "BLI_math.h"
 #include "BLI_smallhash.h"
 #include "BLI_memarena.h"
+#include "BLI_sort.h"
+#include "BLI_task.h"
 
 #include "BLT_translation.h"
 
@@ -624,7 +626,7 @@ static void linehit_to_knifepos(KnifePosData *kpos, KnifeLineHit *lh)
  * secondary key: lambda along depth
  * tertiary key: pointer comparisons of verts if both snapped to verts
  */
-static int linehit_compare(const void *vlh1, const void *vlh2)
+static int linehit_compare(const void *vlh1, const void *vlh2, void *UNUSED(thunk))
 {
 	const KnifeLineHit *lh1 = vlh1;
 	const KnifeLineHit *lh2 = vlh2;
@@ -658,7 +660,7 @@ static void prepare_linehits_for_cut(KnifeTool_OpData *kcd)
 	if (n == 0)
 		return;
 
-	qsort(linehits, n, sizeof(KnifeLineHit), linehit_compare);
+	BLI_qsort_parallel(linehits, n, sizeof(KnifeLineHit), linehit_compare, NULL);
 
 	/* Remove any edge hits that are preceded or followed
 	 * by a vertex hit that is very near. Mark such edge hits using
@@ -1484,6 +1486,160 @@ static void set_linehit_depth(KnifeTool_OpData *kcd, KnifeLineHit *lh)
 	lh->m = dot_m4_v3_row_z(kcd->vc.rv3d->persmatob, lh->cagehit);
 }
 
+/* Data shared by the per-candidate hit-test tasks of knife_find_line_hits().
+ * The hit slot arrays are zero initialized and a task fills its own slot on a hit,
+ * so the v/kfe/f pointer of a slot doubles as its 'valid' flag. */
+struct KnifeLineHitTestData {
+	KnifeTool_OpData *kcd;
+	bglMats *mats;
+	SmallHash *kfvs;
+	KnifeVert **kfv_arr;
+	KnifeEdge **kfe_arr;
+	BMFace **face_arr;
+	KnifeLineHit *vert_hits;
+	KnifeLineHit *edge_hits;
+	KnifeLineHit *face_hits;  /* two slots per face, one for the ray at each end of the cut line */
+	float s1[2], s2[2];
+	float v1[3], v2[3], v3[3], v4[3];
+	float vert_tol_sq, line_tol, line_tol_sq, face_tol_sq;
+	bool use_hit_prev, use_hit_curr;
+};
+
+static void knife_find_line_hits_vert_cb(void *userdata, const int i)
+{
+	struct KnifeLineHitTestData *data = userdata;
+	KnifeTool_OpData *kcd = data->kcd;
+	KnifeVert *v = data->kfv_arr[i];
+	KnifeEdge *kfe_hit = NULL;
+	float s[2], d;
+
+	knife_project_v2(kcd, v->cageco, s);
+	d = dist_squared_to_line_segment_v2(s, data->s1, data->s2);
+	if ((d <= data->vert_tol_sq) &&
+	    (point_is_visible(kcd, v->cageco, s, data->mats, bm_elem_from_knife_vert(v, &kfe_hit))))
+	{
+		KnifeLineHit *hit = &data->vert_hits[i];
+
+		hit->v = v;
+
+		/* If this isn't from an existing BMVert, it may have been added to a BMEdge originally.
+		 * knowing if the hit comes from an edge is important for edge-in-face checks later on
+		 * see: #knife_add_single_cut -> #knife_verts_edge_in_face, T42611 */
+		if (kfe_hit) {
+			hit->kfe = kfe_hit;
+		}
+
+		copy_v3_v3(hit->hit, v->co);
+		copy_v3_v3(hit->cagehit, v->cageco);
+		copy_v2_v2(hit->schit, s);
+		set_linehit_depth(kcd, hit);
+	}
+}
+
+static void knife_find_line_hits_edge_cb(void *userdata, const int i)
+{
+	struct KnifeLineHitTestData *data = userdata;
+	KnifeTool_OpData *kcd = data->kcd;
+	KnifeEdge *kfe = data->kfe_arr[i];
+	float se1[2], se2[2], sint[2];
+	float r1[3], r2[3];
+	float d1, d2, lambda;
+	int kfe_verts_in_cut;
+	int isect_kind;
+
+	/* if we intersect both verts, don't attempt to intersect the edge */
+
+	kfe_verts_in_cut = (BLI_smallhash_lookup(data->kfvs, (intptr_t)kfe->v1) != NULL) +
+	                   (BLI_smallhash_lookup(data->kfvs, (intptr_t)kfe->v2) != NULL);
+
+	if (kfe_verts_in_cut == 2) {
+		return;
+	}
+
+	knife_project_v2(kcd, kfe->v1->cageco, se1);
+	knife_project_v2(kcd, kfe->v2->cageco, se2);
+	isect_kind = (kfe_verts_in_cut) ? -1 : isect_seg_seg_v2_point(data->s1, data->s2, se1, se2, sint);
+	if (isect_kind == -1) {
+		/* isect_seg_seg_v2_simple doesn't do tolerance test around ends of s1-s2 */
+		closest_to_line_segment_v2(sint, data->s1, se1, se2);
+		if (len_squared_v2v2(sint, data->s1) <= data->line_tol_sq)
+			isect_kind = 1;
+		else {
+			closest_to_line_segment_v2(sint, data->s2, se1, se2);
+			if (len_squared_v2v2(sint, data->s2) <= data->line_tol_sq)
+				isect_kind = 1;
+		}
+	}
+	if (isect_kind == 1) {
+		d1 = len_v2v2(sint, se1);
+		d2 = len_v2v2(se2, se1);
+		if (!(d1 <= data->line_tol || d2 <= data->line_tol || fabsf(d1 - d2) <= data->line_tol)) {
+			float p_cage[3], p_cage_tmp[3];
+			lambda = d1 / d2;
+			/* Can't just interpolate between ends of kfe because
+			 * that doesn't work with perspective transformation.
+			 * Need to find 3d intersection of ray through sint */
+			knife_input_ray_segment(kcd, sint, 1.0f, r1, r2);
+			isect_kind = isect_line_line_v3(kfe->v1->cageco, kfe->v2->cageco, r1, r2, p_cage, p_cage_tmp);
+			if (isect_kind >= 1 && point_is_visible(kcd, p_cage, sint, data->mats, bm_elem_from_knife_edge(kfe))) {
+				KnifeLineHit *hit = &data->edge_hits[i];
+
+				if (kcd->snap_midpoints) {
+					/* choose intermediate point snap too */
+					mid_v3_v3v3(p_cage, kfe->v1->cageco, kfe->v2->cageco);
+					mid_v2_v2v2(sint, se1, se2);
+					lambda = 0.5f;
+				}
+				hit->kfe = kfe;
+				transform_point_by_seg_v3(
+				        hit->hit, p_cage,
+				        kfe->v1->co, kfe->v2->co,
+				        kfe->v1->cageco, kfe->v2->cageco);
+				copy_v3_v3(hit->cagehit, p_cage);
+				copy_v2_v2(hit->schit, sint);
+				hit->perc = lambda;
+				set_linehit_depth(kcd, hit);
+			}
+		}
+	}
+}
+
+static void knife_find_line_hits_face_cb(void *userdata, const int i)
+{
+	struct KnifeLineHitTestData *data = userdata;
+	KnifeTool_OpData *kcd = data->kcd;
+	BMFace *f = data->face_arr[i];
+	float p[3], p_cage[3];
+
+	if (data->use_hit_prev &&
+	    knife_ray_intersect_face(kcd, data->s1, data->v1, data->v3, f, data->face_tol_sq, p, p_cage))
+	{
+		if (point_is_visible(kcd, p_cage, data->s1, data->mats, (BMElem *)f)) {
+			KnifeLineHit *hit = &data->face_hits[2 * i];
+
+			hit->f = f;
+			copy_v3_v3(hit->hit, p);
+			copy_v3_v3(hit->cagehit, p_cage);
+			copy_v2_v2(hit->schit, data->s1);
+			set_linehit_depth(kcd, hit);
+		}
+	}
+
+	if (data->use_hit_curr &&
+	    knife_ray_intersect_face(kcd, data->s2, data->v2, data->v4, f, data->face_tol_sq, p, p_cage))
+	{
+		if (point_is_visible(kcd, p_cage, data->s2, data->mats, (BMElem *)f)) {
+			KnifeLineHit *hit = &data->face_hits[2 * i + 1];
+
+			hit->f = f;
+			copy_v3_v3(hit->hit, p);
+			copy_v3_v3(hit->cagehit, p_cage);
+			copy_v2_v2(hit->schit, data->s2);
+			set_linehit_depth(kcd, hit);
+		}
+	}
+}
+
 /* Finds visible (or all, if cutting through) edges that intersects the current screen drag line */
 static void knife_find_line_hits(KnifeTool_OpData *kcd)
 {
@@ -1501,17 +1657,13 @@ static void knife_find_line_hits(KnifeTool_OpData *kcd)
 	KnifeLineHit *linehits = NULL;
 	BLI_array_declare(linehits);
 	SmallHashIter hiter;
-	KnifeLineHit hit;
 	void *val;
-	void **val_p;
 	float plane_cos[12];
-	float s[2], se1[2], se2[2], sint[2];
-	float r1[3], r2[3];
-	float d, d1, d2, lambda;
-	float vert_tol, vert_tol_sq;
-	float line_tol, line_tol_sq;
-	float face_tol, face_tol_sq;
-	int isect_kind;
+	float vert_tol;
+	float line_tol;
+	float face_tol;
+	struct KnifeLineHitTestData data;
+	int totkfv, totkfe, totface;
 	unsigned int tot;
 	int i;
 	const bool use_hit_prev = true;
@@ -1632,137 +1784,95 @@ static void knife_find_line_hits(KnifeTool_OpData *kcd)
 		vert_tol = line_tol = face_tol = 0.5f;
 	}
 
-	vert_tol_sq = vert_tol * vert_tol;
-	line_tol_sq = line_tol * line_tol;
-	face_tol_sq = face_tol * face_tol;
-
 	/* Assume these tolerances swamp floating point rounding errors in calculations below */
 
-	/* first look for vertex hits */
-	for (val_p = BLI_smallhash_iternew_p(&kfvs, &hiter, (uintptr_t *)&v); val_p;
-	     val_p = BLI_smallhash_iternext_p(&hiter, (uintptr_t *)&v))
+	/* The candidate sets are independent, so test them with one task per candidate
+	 * and gather the hits serially afterwards (appends keep the hash iteration
+	 * order the serial loops had). */
+	totkfv = BLI_smallhash_count(&kfvs);
+	totkfe = BLI_smallhash_count(&kfes);
+	totface = BLI_smallhash_count(&faces);
+
+	data.kcd = kcd;
+	data.mats = &mats;
+	data.kfvs = &kfvs;
+	data.kfv_arr = MEM_mallocN(sizeof(*data.kfv_arr) * totkfv, __func__);
+	data.kfe_arr = MEM_mallocN(sizeof(*data.kfe_arr) * totkfe, __func__);
+	data.face_arr = MEM_mallocN(sizeof(*data.face_arr) * totface, __func__);
+	data.vert_hits = MEM_callocN(sizeof(*data.vert_hits) * totkfv, __func__);
+	data.edge_hits = MEM_callocN(sizeof(*data.edge_hits) * totkfe, __func__);
+	data.face_hits = MEM_callocN(sizeof(*data.face_hits) * 2 * totface, __func__);
+	copy_v2_v2(data.s1, s1);
+	copy_v2_v2(data.s2, s2);
+	copy_v3_v3(data.v1, v1);
+	copy_v3_v3(data.v2, v2);
+	copy_v3_v3(data.v3, v3);
+	copy_v3_v3(data.v4, v4);
+	data.vert_tol_sq = vert_tol * vert_tol;
+	data.line_tol = line_tol;
+	data.line_tol_sq = line_tol * line_tol;
+	data.face_tol_sq = face_tol * face_tol;
+	data.use_hit_prev = use_hit_prev;
+	data.use_hit_curr = use_hit_curr;
+
+	i = 0;
+	for (val = BLI_smallhash_iternew(&kfvs, &hiter, NULL); val;
+	     val = BLI_smallhash_iternext(&hiter, NULL))
+	{
+		data.kfv_arr[i++] = val;
+	}
+	i = 0;
+	for (val = BLI_smallhash_iternew(&kfes, &hiter, NULL); val;
+	     val = BLI_smallhash_iternext(&hiter, NULL))
 	{
-		KnifeEdge *kfe_hit = NULL;
+		data.kfe_arr[i++] = val;
+	}
+	i = 0;
+	for (val = BLI_smallhash_iternew(&faces, &hiter, NULL); val;
+	     val = BLI_smallhash_iternext(&hiter, NULL))
+	{
+		data.face_arr[i++] = val;
+	}
 
-		knife_project_v2(kcd, v->cageco, s);
-		d = dist_squared_to_line_segment_v2(s, s1, s2);
-		if ((d <= vert_tol_sq) &&
-		    (point_is_visible(kcd, v->cageco, s, &mats, bm_elem_from_knife_vert(v, &kfe_hit))))
-		{
-			memset(&hit, 0, sizeof(hit));
-			hit.v = v;
-
-			/* If this isn't from an existing BMVert, it may have been added to a BMEdge originally.
-			 * knowing if the hit comes from an edge is important for edge-in-face checks later on
-			 * see: #knife_add_single_cut -> #knife_verts_edge_in_face, T42611 */
-			if (kfe_hit) {
-				hit.kfe = kfe_hit;
-			}
+	/* first look for vertex hits */
+	BLI_task_parallel_range(0, totkfv, &data, knife_find_line_hits_vert_cb, (totkfv > 64));
 
-			copy_v3_v3(hit.hit, v->co);
-			copy_v3_v3(hit.cagehit, v->cageco);
-			copy_v2_v2(hit.schit, s);
-			set_linehit_depth(kcd, &hit);
-			BLI_array_append(linehits, hit);
+	for (i = 0; i < totkfv; i++) {
+		if (data.vert_hits[i].v) {
+			BLI_array_append(linehits, data.vert_hits[i]);
 		}
 		else {
 			/* note that these vertes aren't used */
-			*val_p = NULL;
+			BLI_smallhash_reinsert(&kfvs, (uintptr_t)data.kfv_arr[i], NULL);
 		}
 	}
 
-	/* now edge hits; don't add if a vertex at end of edge should have hit */
-	for (val = BLI_smallhash_iternew(&kfes, &hiter, (uintptr_t *)&kfe); val;
-	     val = BLI_smallhash_iternext(&hiter, (uintptr_t *)&kfe))
-	{
-		int kfe_verts_in_cut;
-		/* if we intersect both verts, don't attempt to intersect the edge */
-
-		kfe_verts_in_cut = (BLI_smallhash_lookup(&kfvs, (intptr_t)kfe->v1) != NULL) +
-		                   (BLI_smallhash_lookup(&kfvs, (intptr_t)kfe->v2) != NULL);
-
-		if (kfe_verts_in_cut == 2) {
-			continue;
-		}
+	/* now edge hits; don't add if a vertex at end of edge should have hit
+	 * (the edge tasks read the kfvs hash, so it must not change past this point) */
+	BLI_task_parallel_range(0, totkfe, &data, knife_find_line_hits_edge_cb, (totkfe > 64));
 
-		knife_project_v2(kcd, kfe->v1->cageco, se1);
-		knife_project_v2(kcd, kfe->v2->cageco, se2);
-		isect_kind = (kfe_verts_in_cut) ? -1 : isect_seg_seg_v2_point(s1, s2, se1, se2, sint);
-		if (isect_kind == -1) {
-			/* isect_seg_seg_v2_simple doesn't do tolerance test around ends of s1-s2 */
-			closest_to_line_segment_v2(sint, s1, se1, se2);
-			if (len_squared_v2v2(sint, s1) <= line_tol_sq)
-				isect_kind = 1;
-			else {
-				closest_to_line_segment_v2(sint, s2, se1, se2);
-				if (len_squared_v2v2(sint, s2) <= line_tol_sq)
-					isect_kind = 1;
-			}
-		}
-		if (isect_kind == 1) {
-			d1 = len_v2v2(sint, se1);
-			d2 = len_v2v2(se2, se1);
-			if (!(d1 <= line_tol || d2 <= line_tol || fabsf(d1 - d2) <= line_tol)) {
-				float p_cage[3], p_cage_tmp[3];
-				lambda = d1 / d2;
-				/* Can't just interpolate between ends of kfe because
-				 * that doesn't work with perspective transformation.
-				 * Need to find 3d intersection of ray through sint */
-				knife_input_ray_segment(kcd, sint, 1.0f, r1, r2);
-				isect_kind = isect_line_line_v3(kfe->v1->cageco, kfe->v2->cageco, r1, r2, p_cage, p_cage_tmp);
-				if (isect_kind >= 1 && point_is_visible(kcd, p_cage, sint, &mats, bm_elem_from_knife_edge(kfe))) {
-					memset(&hit, 0, sizeof(hit));
-					if (kcd->snap_midpoints) {
-						/* choose intermediate point snap too */
-						mid_v3_v3v3(p_cage, kfe->v1->cageco, kfe->v2->cageco);
-						mid_v2_v2v2(sint, se1, se2);
-						lambda = 0.5f;
-					}
-					hit.kfe = kfe;
-					transform_point_by_seg_v3(
-					        hit.hit, p_cage,
-					        kfe->v1->co, kfe->v2->co,
-					        kfe->v1->cageco, kfe->v2->cageco);
-					copy_v3_v3(hit.cagehit, p_cage);
-					copy_v2_v2(hit.schit, sint);
-					hit.perc = lambda;
-					set_linehit_depth(kcd, &hit);
-					BLI_array_append(linehits, hit);
-				}
-			}
+	for (i = 0; i < totkfe; i++) {
+		if (data.edge_hits[i].kfe) {
+			BLI_array_append(linehits, data.edge_hits[i]);
 		}
 	}
+
 	/* now face hits; don't add if a vertex or edge in face should have hit */
-	for (val = BLI_smallhash_iternew(&faces, &hiter, (uintptr_t *)&f); val;
-	     val = BLI_smallhash_iternext(&hiter, (uintptr_t *)&f))
-	{
-		float p[3], p_cage[3];
-
-		if (use_hit_prev && knife_ray_intersect_face(kcd, s1, v1, v3, f, face_tol_sq, p, p_cage)) {
-			if (point_is_visible(kcd, p_cage, s1, &mats, (BMElem *)f)) {
-				memset(&hit, 0, sizeof(hit));
-				hit.f = f;
-				copy_v3_v3(hit.hit, p);
-				copy_v3_v3(hit.cagehit, p_cage);
-				copy_v2_v2(hit.schit, s1);
-				set_linehit_depth(kcd, &hit);
-				BLI_array_append(linehits, hit);
-			}
-		}
+	BLI_task_parallel_range(0, totface, &data, knife_find_line_hits_face_cb, (totface > 64));
 
-		if (use_hit_curr && knife_ray_intersect_face(kcd, s2, v2, v4, f, face_tol_sq, p, p_cage)) {
-			if (point_is_visible(kcd, p_cage, s2, &mats, (BMElem *)f)) {
-				memset(&hit, 0, sizeof(hit));
-				hit.f = f;
-				copy_v3_v3(hit.hit, p);
-				copy_v3_v3(hit.cagehit, p_cage);
-				copy_v2_v2(hit.schit, s2);
-				set_linehit_depth(kcd, &hit);
-				BLI_array_append(linehits, hit);
-			}
+	for (i = 0; i < 2 * totface; i++) {
+		if (data.face_hits[i].f) {
+			BLI_array_append(linehits, data.face_hits[i]);
 		}
 	}
 
+	MEM_freeN(data.kfv_arr);
+	MEM_freeN(data.kfe_arr);
+	MEM_freeN(data.face_arr);
+	MEM_freeN(data.vert_hits);
+	MEM_freeN(data.edge_hits);
+	MEM_freeN(data.face_hits);
+
 	kcd->linehits = linehits;
 	kcd->totlinehit = BLI_array_count(linehits);
 
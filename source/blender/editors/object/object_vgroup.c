@@ -51,6 +51,7 @@
 #include "BLI_utildefines.h"
 #include "BLI_linklist_stack.h"
 #include "BLI_stackdefines.h"
+#include "BLI_task.h"
 
 
 #include "BKE_context.h"
@@ -1485,13 +1486,58 @@ static void vgroup_fix(Scene *scene, Object *ob, float distToBe, float strength,
 	}
 }
 
+/* shared between the weight tools that apply an independent per-vertex
+ * transformation, so their vertex loops can run in parallel */
+typedef struct VGroupSubsetVertData {
+	MDeformVert **dvert_array;
+	const bool *vgroup_validmap;
+	int vgroup_tot;
+
+	/* levels */
+	float offset;
+	float gain;
+
+	/* invert */
+	bool auto_assign;
+
+	/* normalize all */
+	const bool *lock_flags;
+	int defbase_tot;
+	int def_nr;
+	bool lock_active;
+} VGroupSubsetVertData;
+
+static void vgroup_levels_subset_task_cb(void *userdata, const int i)
+{
+	VGroupSubsetVertData *data = userdata;
+	MDeformVert *dv = data->dvert_array[i];
+	MDeformWeight *dw;
+	int j;
+
+	/* in case its not selected */
+	if (dv == NULL) {
+		return;
+	}
+
+	j = data->vgroup_tot;
+	while (j--) {
+		if (data->vgroup_validmap[j]) {
+			dw = defvert_find_index(dv, j);
+			if (dw) {
+				dw->weight = data->gain * (dw->weight + data->offset);
+
+				CLAMP(dw->weight, 0.0f, 1.0f);
+			}
+		}
+	}
+}
+
 static void vgroup_levels_subset(Object *ob, const bool *vgroup_validmap, const int vgroup_tot,
                                  const int UNUSED(subset_count),
                                  const float offset, const float gain)
 {
-	MDeformWeight *dw;
-	MDeformVert *dv, **dvert_array = NULL;
-	int i, dvert_tot = 0;
+	MDeformVert **dvert_array = NULL;
+	int dvert_tot = 0;
 
 	const bool use_vert_sel = vertex_group_use_vert_sel(ob);
 	const bool use_mirror = (ob->type == OB_MESH) ? (((Mesh *)ob->data)->editflag & ME_EDIT_MIRROR_X) != 0 : false;
@@ -1499,27 +1545,16 @@ static void vgroup_levels_subset(Object *ob, const bool *vgroup_validmap, const
 	ED_vgroup_parray_alloc(ob->data, &dvert_array, &dvert_tot, use_vert_sel);
 
 	if (dvert_array) {
+		VGroupSubsetVertData data = {
+			.dvert_array = dvert_array,
+			.vgroup_validmap = vgroup_validmap,
+			.vgroup_tot = vgroup_tot,
+			.offset = offset,
+			.gain = gain,
+		};
 
-		for (i = 0; i < dvert_tot; i++) {
-			int j;
-
-			/* in case its not selected */
-			if (!(dv = dvert_array[i])) {
-				continue;
-			}
-
-			j = vgroup_tot;
-			while (j--) {
-				if (vgroup_validmap[j]) {
-					dw = defvert_find_index(dv, j);
-					if (dw) {
-						dw->weight = gain * (dw->weight + offset);
-
-						CLAMP(dw->weight, 0.0f, 1.0f);
-					}
-				}
-			}
-		}
+		BLI_task_parallel_range(0, dvert_tot, &data, vgroup_levels_subset_task_cb,
+		                        dvert_tot > 1024);
 
 		if (use_mirror && use_vert_sel) {
 			ED_vgroup_parray_mirror_sync(ob, dvert_array, dvert_tot,
@@ -1530,6 +1565,29 @@ static void vgroup_levels_subset(Object *ob, const bool *vgroup_validmap, const
 	}
 }
 
+static void vgroup_normalize_all_task_cb(void *userdata, const int i)
+{
+	VGroupSubsetVertData *data = userdata;
+	MDeformVert *dv = data->dvert_array[i];
+
+	/* in case its not selected */
+	if (dv == NULL) {
+		return;
+	}
+
+	if (data->lock_flags) {
+		defvert_normalize_lock_map(dv, data->vgroup_validmap, data->vgroup_tot,
+		                           data->lock_flags, data->defbase_tot);
+	}
+	else if (data->lock_active) {
+		defvert_normalize_lock_single(dv, data->vgroup_validmap, data->vgroup_tot,
+		                              data->def_nr);
+	}
+	else {
+		defvert_normalize_subset(dv, data->vgroup_validmap, data->vgroup_tot);
+	}
+}
+
 static bool vgroup_normalize_all(
         Object *ob,
         const bool *vgroup_validmap,
@@ -1538,7 +1596,7 @@ static bool vgroup_normalize_all(
         const bool lock_active,
         ReportList *reports)
 {
-	MDeformVert *dv, **dvert_array = NULL;
+	MDeformVert **dvert_array = NULL;
 	int i, dvert_tot = 0;
 	const int def_nr = ob->actdef - 1;
 
@@ -1576,21 +1634,19 @@ static bool vgroup_normalize_all(
 			}
 		}
 
-		for (i = 0; i < dvert_tot; i++) {
-			/* in case its not selected */
-			if ((dv = dvert_array[i])) {
-				if (lock_flags) {
-					defvert_normalize_lock_map(dv, vgroup_validmap, vgroup_tot,
-					                           lock_flags, defbase_tot);
-				}
-				else if (lock_active) {
-					defvert_normalize_lock_single(dv, vgroup_validmap, vgroup_tot,
-					                              def_nr);
-				}
-				else {
-					defvert_normalize_subset(dv, vgroup_validmap, vgroup_tot);
-				}
-			}
+		{
+			VGroupSubsetVertData data = {
+				.dvert_array = dvert_array,
+				.vgroup_validmap = vgroup_validmap,
+				.vgroup_tot = vgroup_tot,
+				.lock_flags = lock_flags,
+				.defbase_tot = defbase_tot,
+				.def_nr = def_nr,
+				.lock_active = lock_active,
+			};
+
+			BLI_task_parallel_range(0, dvert_tot, &data, vgroup_normalize_all_task_cb,
+			                        dvert_tot > 1024);
 		}
 
 		changed = true;
@@ -1652,45 +1708,59 @@ static void vgroup_lock_all(Object *ob, int action)
 	}
 }
 
+static void vgroup_invert_subset_task_cb(void *userdata, const int i)
+{
+	VGroupSubsetVertData *data = userdata;
+	MDeformVert *dv = data->dvert_array[i];
+	MDeformWeight *dw;
+	int j;
+
+	/* in case its not selected */
+	if (dv == NULL) {
+		return;
+	}
+
+	j = data->vgroup_tot;
+	while (j--) {
+
+		if (data->vgroup_validmap[j]) {
+			if (data->auto_assign) {
+				dw = defvert_verify_index(dv, j);
+			}
+			else {
+				dw = defvert_find_index(dv, j);
+			}
+
+			if (dw) {
+				dw->weight = 1.0f - dw->weight;
+				CLAMP(dw->weight, 0.0f, 1.0f);
+			}
+		}
+	}
+}
+
 static void vgroup_invert_subset(Object *ob,
                                  const bool *vgroup_validmap, const int vgroup_tot,
                                  const int UNUSED(subset_count), const bool auto_assign, const bool auto_remove)
 {
-	MDeformWeight *dw;
-	MDeformVert *dv, **dvert_array = NULL;
-	int i, dvert_tot = 0;
+	MDeformVert **dvert_array = NULL;
+	int dvert_tot = 0;
 	const bool use_vert_sel = vertex_group_use_vert_sel(ob);
 	const bool use_mirror = (ob->type == OB_MESH) ? (((Mesh *)ob->data)->editflag & ME_EDIT_MIRROR_X) != 0 : false;
 
 	ED_vgroup_parray_alloc(ob->data, &dvert_array, &dvert_tot, use_vert_sel);
 
 	if (dvert_array) {
-		for (i = 0; i < dvert_tot; i++) {
-			int j;
+		VGroupSubsetVertData data = {
+			.dvert_array = dvert_array,
+			.vgroup_validmap = vgroup_validmap,
+			.vgroup_tot = vgroup_tot,
+			.auto_assign = auto_assign,
+		};
 
-			/* in case its not selected */
-			if (!(dv = dvert_array[i])) {
-				continue;
-			}
-
-			j = vgroup_tot;
-			while (j--) {
-
-				if (vgroup_validmap[j]) {
-					if (auto_assign) {
-						dw = defvert_verify_index(dv, j);
-					}
-					else {
-						dw = defvert_find_index(dv, j);
-					}
-
-					if (dw) {
-						dw->weight = 1.0f - dw->weight;
-						CLAMP(dw->weight, 0.0f, 1.0f);
-					}
-				}
-			}
-		}
+		/* each vertex only reallocs its own weights so this is thread-safe */
+		BLI_task_parallel_range(0, dvert_tot, &data, vgroup_invert_subset_task_cb,
+		                        dvert_tot > 1024);
 
 		if (use_mirror && use_vert_sel) {
 			ED_vgroup_parray_mirror_sync(ob, dvert_array, dvert_tot,
@@ -1713,6 +1783,105 @@ enum {
 	WEIGHT_SMOOTH_SELECT = true,
 };
 
+typedef struct VGroupSmoothData {
+	BMesh *bm;
+	Mesh *me;
+	MeshElemMap *emap;
+	const unsigned int *verts_used;
+	const float *weight_accum_prev;
+	float *weight_accum_curr;
+	int source;
+	int expand_sign;
+	float expand;
+	float iexpand;
+	float fac;
+	float ifac;
+} VGroupSmoothData;
+
+static void vgroup_smooth_subset_task_cb(void *userdata, const int n)
+{
+	VGroupSmoothData *data = userdata;
+	BMesh *bm = data->bm;
+	Mesh *me = data->me;
+	const int source = data->source;
+	const int expand_sign = data->expand_sign;
+	const float expand = data->expand;
+	const float iexpand = data->iexpand;
+	const unsigned int i = data->verts_used[n];
+	float weight_tot = 0.0f;
+	float weight = 0.0f;
+
+#define WEIGHT_ACCUMULATE \
+	{ \
+		float weight_other = data->weight_accum_prev[i_other]; \
+		float tot_factor = 1.0f; \
+		if (expand_sign == 1) {  /* expand */ \
+			if (weight_other < data->weight_accum_prev[i]) { \
+				weight_other = (data->weight_accum_prev[i] * expand) + (weight_other * iexpand); \
+				tot_factor = iexpand; \
+			} \
+		} \
+		else if (expand_sign == -1) {  /* contract */ \
+			if (weight_other > data->weight_accum_prev[i]) { \
+				weight_other = (data->weight_accum_prev[i] * expand) + (weight_other * iexpand); \
+				tot_factor = iexpand; \
+			} \
+		} \
+		weight     += tot_factor * weight_other; \
+		weight_tot += tot_factor; \
+	} ((void)0)
+
+
+	if (bm) {
+		BMVert *v = BM_vert_at_index(bm, i);
+		BMIter eiter;
+		BMEdge *e;
+
+		/* checked already */
+		BLI_assert(BM_elem_flag_test(v, BM_ELEM_SELECT));
+
+		BM_ITER_ELEM (e, &eiter, v, BM_EDGES_OF_VERT) {
+			BMVert *v_other = BM_edge_other_vert(e, v);
+			if ((source == WEIGHT_SMOOTH_ALL) ||
+			    (source == (BM_elem_flag_test(v_other, BM_ELEM_SELECT) != 0)))
+			{
+				const int i_other = BM_elem_index_get(v_other);
+
+				WEIGHT_ACCUMULATE;
+			}
+		}
+	}
+	else {
+		int j;
+
+		/* checked already */
+		BLI_assert(me->mvert[i].flag & SELECT);
+
+		for (j = 0; j < data->emap[i].count; j++) {
+			MEdge *e = &me->medge[data->emap[i].indices[j]];
+			const int i_other = (e->v1 == i ? e->v2 : e->v1);
+			MVert *v_other = &me->mvert[i_other];
+
+			if ((source == WEIGHT_SMOOTH_ALL) ||
+			    (source == ((v_other->flag & SELECT) != 0)))
+			{
+				WEIGHT_ACCUMULATE;
+			}
+		}
+	}
+
+#undef WEIGHT_ACCUMULATE
+
+	if (weight_tot != 0.0f) {
+		weight /= weight_tot;
+		weight = (data->weight_accum_prev[i] * data->ifac) + (weight * data->fac);
+
+		/* should be within range, just clamp because of float precision */
+		CLAMP(weight, 0.0f, 1.0f);
+		data->weight_accum_curr[i] = weight;
+	}
+}
+
 static void vgroup_smooth_subset(
         Object *ob, const bool *vgroup_validmap, const int vgroup_tot,
         const int subset_count,
@@ -1813,85 +1982,26 @@ static void vgroup_smooth_subset(
 		memcpy(weight_accum_curr, weight_accum_prev, sizeof(*weight_accum_curr) * dvert_tot);
 
 		for (iter = 0; iter < repeat; iter++) {
-			unsigned *vi_step, *vi_end = verts_used + STACK_SIZE(verts_used);
-
-			/* avoid looping over all verts */
-			// for (i = 0; i < dvert_tot; i++)
-			for (vi_step = verts_used; vi_step != vi_end; vi_step++) {
-				const unsigned int i  = *vi_step;
-				float weight_tot = 0.0f;
-				float weight = 0.0f;
-
-#define WEIGHT_ACCUMULATE \
-				{ \
-					float weight_other = weight_accum_prev[i_other]; \
-					float tot_factor = 1.0f; \
-					if (expand_sign == 1) {  /* expand */ \
-						if (weight_other < weight_accum_prev[i]) { \
-							weight_other = (weight_accum_prev[i] * expand) + (weight_other * iexpand); \
-							tot_factor = iexpand; \
-						} \
-					} \
-					else if (expand_sign == -1) {  /* contract */ \
-						if (weight_other > weight_accum_prev[i]) { \
-							weight_other = (weight_accum_prev[i] * expand) + (weight_other * iexpand); \
-							tot_factor = iexpand; \
-						} \
-					} \
-					weight     += tot_factor * weight_other; \
-					weight_tot += tot_factor; \
-				} ((void)0)
-
-
-				if (bm) {
-					BMVert *v = BM_vert_at_index(bm, i);
-					BMIter eiter;
-					BMEdge *e;
-
-					/* checked already */
-					BLI_assert(BM_elem_flag_test(v, BM_ELEM_SELECT));
-
-					BM_ITER_ELEM (e, &eiter, v, BM_EDGES_OF_VERT) {
-						BMVert *v_other = BM_edge_other_vert(e, v);
-						if ((source == WEIGHT_SMOOTH_ALL) ||
-						    (source == (BM_elem_flag_test(v_other, BM_ELEM_SELECT) != 0)))
-						{
-							const int i_other = BM_elem_index_get(v_other);
-
-							WEIGHT_ACCUMULATE;
-						}
-					}
-				}
-				else {
-					int j;
-
-					/* checked already */
-					BLI_assert(me->mvert[i].flag & SELECT);
-
-					for (j = 0; j < emap[i].count; j++) {
-						MEdge *e = &me->medge[emap[i].indices[j]];
-						const int i_other = (e->v1 == i ? e->v2 : e->v1);
-						MVert *v_other = &me->mvert[i_other];
-
-						if ((source == WEIGHT_SMOOTH_ALL) ||
-						    (source == ((v_other->flag & SELECT) != 0)))
-						{
-							WEIGHT_ACCUMULATE;
-						}
-					}
-				}
-
-#undef WEIGHT_ACCUMULATE
-
-				if (weight_tot != 0.0f) {
-					weight /= weight_tot;
-					weight = (weight_accum_prev[i] * ifac) + (weight * fac);
-
-					/* should be within range, just clamp because of float precision */
-					CLAMP(weight, 0.0f, 1.0f);
-					weight_accum_curr[i] = weight;
-				}
-			}
+			VGroupSmoothData data;
+
+			data.bm = bm;
+			data.me = me;
+			data.emap = emap;
+			data.verts_used = verts_used;
+			data.weight_accum_prev = weight_accum_prev;
+			data.weight_accum_curr = weight_accum_curr;
+			data.source = source;
+			data.expand_sign = expand_sign;
+			data.expand = expand;
+			data.iexpand = iexpand;
+			data.fac = fac;
+			data.ifac = ifac;
+
+			/* avoid looping over all verts, each vertex reads the previous
+			 * iteration and writes only its own accumulator */
+			BLI_task_parallel_range(0, (int)STACK_SIZE(verts_used), &data,
+			                        vgroup_smooth_subset_task_cb,
+			                        STACK_SIZE(verts_used) > 1024);
 
 			SWAP(float *, weight_accum_curr, weight_accum_prev);
 		}
@@ -1645,7 +1645,9 @@ static void do_smooth_brush_mesh_task_cb_ex(
 
 	sculpt_brush_test_init(ss, &test);
 
-	BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
+	BKE_pbvh_vertex_iter_begin_sphere(ss->pbvh, data->nodes[n],
+	                                  test.location, test.radius_squared,
+	                                  vd, PBVH_ITER_UNIQUE)
 	{
 		if (sculpt_brush_test(&test, vd.co)) {
 			const float fade = bstrength * tex_strength(
@@ -1673,7 +1675,7 @@ static void do_smooth_brush_mesh_task_cb_ex(
 				vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
 		}
 	}
-	BKE_pbvh_vertex_iter_end;
+	BKE_pbvh_vertex_iter_end_sphere;
 }
 
 static void do_smooth_brush_bmesh_task_cb_ex(
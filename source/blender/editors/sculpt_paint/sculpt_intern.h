@@ -87,6 +87,14 @@ typedef struct SculptUndoNode {
 	float *mask;
 	int totvert;
 
+	/* compressed coordinate storage, packed at stroke end and decompressed
+	 * again on the first restore (see sculpt_undo.c, WITH_LZO) */
+	void *co_compressed;
+	size_t co_compressed_size;
+	void *orig_co_compressed;
+	size_t orig_co_compressed_size;
+	char co_delta_ref;          /* reference state 'co' was delta encoded against */
+
 	/* non-multires */
 	int maxvert;                /* to verify if totvert it still the same */
 	int *index;                 /* to restore into right location */
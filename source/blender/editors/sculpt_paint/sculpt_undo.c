@@ -69,6 +69,17 @@
 #include "paint_intern.h"
 #include "sculpt_intern.h"
 
+#ifdef WITH_LZO
+#  ifdef WITH_SYSTEM_LZO
+#    include <lzo/lzo1x.h>
+#  else
+#    include "minilzo.h"
+#    define LZO_HEAP_ALLOC(var, size) \
+	lzo_align_t __LZO_MMODEL var [ ((size) + (sizeof(lzo_align_t) - 1)) / sizeof(lzo_align_t) ]
+#  endif
+#  define LZO_OUT_LEN(size)  ((size) + (size) / 16 + 64 + 3)
+#endif
+
 /************************** Undo *************************/
 
 static void update_cb(PBVHNode *node, void *rebuild)
@@ -122,6 +133,228 @@ static bool sculpt_undo_restore_deformed(
 	}
 }
 
+/********************* Compressed Coordinate Storage ********************/
+
+#ifdef WITH_LZO
+
+/* Undo coordinates are packed once a stroke finishes: the arrays are delta
+ * encoded against the post-stroke state where possible, so every vertex the
+ * brush did not move becomes a run of zero bytes, then LZO compressed.  The
+ * delta is a plain XOR, applying it twice restores the original bits, and
+ * since undo steps are always applied in reverse stroke order the mesh is
+ * back in the post-stroke state by the time a node is decompressed. */
+
+enum {
+	SCULPT_UNDO_DELTA_NONE  = 0,
+	SCULPT_UNDO_DELTA_MESH  = 1,
+	SCULPT_UNDO_DELTA_GRIDS = 2,
+};
+
+static void sculpt_undo_co_delta_mesh(SculptUndoNode *unode, const MVert *mvert, float (*co)[3])
+{
+	int i, j;
+
+	for (i = 0; i < unode->totvert; i++) {
+		const unsigned int *ref = (const unsigned int *)mvert[unode->index[i]].co;
+		unsigned int *c = (unsigned int *)co[i];
+
+		for (j = 0; j < 3; j++)
+			c[j] ^= ref[j];
+	}
+}
+
+static void sculpt_undo_co_delta_grids(
+        SculptUndoNode *unode, CCGElem **grids, const CCGKey *key, float (*co)[3])
+{
+	int i, j, k;
+
+	for (j = 0; j < unode->totgrid; j++) {
+		CCGElem *grid = grids[unode->grids[j]];
+
+		for (i = 0; i < key->grid_area; i++, co++) {
+			const unsigned int *ref = (const unsigned int *)CCG_elem_offset_co(key, grid, i);
+			unsigned int *c = (unsigned int *)co[0];
+
+			for (k = 0; k < 3; k++)
+				c[k] ^= ref[k];
+		}
+	}
+}
+
+/* returns NULL when the data does not shrink, the plain array is kept then */
+static void *sculpt_undo_compress_array(const void *data, size_t in_len, size_t *r_out_len)
+{
+	unsigned char *out = MEM_mallocN(LZO_OUT_LEN(in_len), "SculptUndoNode.compressed");
+	lzo_uint out_len = 0;
+	LZO_HEAP_ALLOC(wrkmem, LZO1X_1_MEM_COMPRESS);
+
+	lzo1x_1_compress(data, (lzo_uint)in_len, out, &out_len, wrkmem);
+
+	if (out_len == 0 || out_len >= in_len) {
+		MEM_freeN(out);
+		return NULL;
+	}
+
+	*r_out_len = (size_t)out_len;
+
+	return MEM_reallocN(out, out_len);
+}
+
+typedef struct SculptUndoCompressData {
+	Object *ob;
+	SculptUndoNode **unodes;
+} SculptUndoCompressData;
+
+static void sculpt_undo_compress_task_cb(void *userdata, const int n)
+{
+	SculptUndoCompressData *data = userdata;
+	SculptUndoNode *unode = data->unodes[n];
+	SculptSession *ss = data->ob->sculpt;
+	const size_t co_len = sizeof(float[3]) * unode->totvert;
+	float (*delta)[3];
+	void *compressed;
+	size_t compressed_size;
+
+	/* delta encode into a scratch copy so 'co' stays valid when the
+	 * result turns out to be incompressible */
+	delta = MEM_mallocN(co_len, "SculptUndoNode.delta");
+	memcpy(delta, unode->co, co_len);
+
+	unode->co_delta_ref = SCULPT_UNDO_DELTA_NONE;
+
+	if (unode->maxvert) {
+		if (!ss->kb && !ss->modifiers_active && ss->mvert) {
+			sculpt_undo_co_delta_mesh(unode, ss->mvert, delta);
+			unode->co_delta_ref = SCULPT_UNDO_DELTA_MESH;
+		}
+	}
+	else if (unode->maxgrid && unode->node) {
+		CCGElem **grids;
+		CCGKey key;
+
+		BKE_pbvh_node_get_grids(ss->pbvh, unode->node, NULL, NULL, NULL, NULL, &grids);
+		BKE_pbvh_get_grid_key(ss->pbvh, &key);
+
+		sculpt_undo_co_delta_grids(unode, grids, &key, delta);
+		unode->co_delta_ref = SCULPT_UNDO_DELTA_GRIDS;
+	}
+
+	compressed = sculpt_undo_compress_array(delta, co_len, &compressed_size);
+	MEM_freeN(delta);
+
+	if (compressed) {
+		MEM_freeN(unode->co);
+		unode->co = NULL;
+		unode->co_compressed = compressed;
+		unode->co_compressed_size = compressed_size;
+	}
+	else {
+		unode->co_delta_ref = SCULPT_UNDO_DELTA_NONE;
+	}
+
+	if (unode->orig_co) {
+		compressed = sculpt_undo_compress_array(unode->orig_co, co_len, &compressed_size);
+
+		if (compressed) {
+			MEM_freeN(unode->orig_co);
+			unode->orig_co = NULL;
+			unode->orig_co_compressed = compressed;
+			unode->orig_co_compressed_size = compressed_size;
+		}
+	}
+}
+
+static void sculpt_undo_compress_nodes(Object *ob, ListBase *lb)
+{
+	SculptUndoCompressData data;
+	SculptUndoNode *unode, **unodes;
+	int totnode = 0;
+
+	if (!ob || !ob->sculpt)
+		return;
+
+	for (unode = lb->first; unode; unode = unode->next)
+		if (unode->type == SCULPT_UNDO_COORDS && unode->co)
+			totnode++;
+
+	if (totnode == 0)
+		return;
+
+	unodes = MEM_mallocN(sizeof(*unodes) * totnode, "sculpt undo compress nodes");
+	totnode = 0;
+	for (unode = lb->first; unode; unode = unode->next)
+		if (unode->type == SCULPT_UNDO_COORDS && unode->co)
+			unodes[totnode++] = unode;
+
+	data.ob = ob;
+	data.unodes = unodes;
+
+	BLI_task_parallel_range(0, totnode, &data, sculpt_undo_compress_task_cb, totnode > 1);
+
+	/* give the saved memory back to the paint undo stack limit */
+	for (int n = 0; n < totnode; n++) {
+		size_t saved = 0;
+		const size_t co_len = sizeof(float[3]) * unodes[n]->totvert;
+
+		if (unodes[n]->co_compressed)
+			saved += co_len - unodes[n]->co_compressed_size;
+		if (unodes[n]->orig_co_compressed)
+			saved += co_len - unodes[n]->orig_co_compressed_size;
+
+		undo_paint_push_count_alloc(UNDO_PAINT_MESH, -(int)saved);
+	}
+
+	MEM_freeN(unodes);
+}
+
+static void sculpt_undo_decompress_array(void *dst, size_t dst_len, const void *src, size_t src_len)
+{
+	lzo_uint out_len = (lzo_uint)dst_len;
+
+	lzo1x_decompress_safe(src, (lzo_uint)src_len, dst, &out_len, NULL);
+}
+
+#endif  /* WITH_LZO */
+
+static void sculpt_undo_node_decompress(SculptUndoNode *unode, SculptSession *ss, DerivedMesh *dm)
+{
+#ifdef WITH_LZO
+	const size_t co_len = sizeof(float[3]) * unode->totvert;
+
+	if (unode->co_compressed) {
+		unode->co = MEM_mapallocN(co_len, "SculptUndoNode.co");
+		sculpt_undo_decompress_array(unode->co, co_len,
+		                             unode->co_compressed, unode->co_compressed_size);
+
+		if (unode->co_delta_ref == SCULPT_UNDO_DELTA_MESH) {
+			sculpt_undo_co_delta_mesh(unode, ss->mvert, unode->co);
+		}
+		else if (unode->co_delta_ref == SCULPT_UNDO_DELTA_GRIDS && dm->getGridData) {
+			CCGElem **grids = dm->getGridData(dm);
+			CCGKey key;
+
+			dm->getGridKey(dm, &key);
+			sculpt_undo_co_delta_grids(unode, grids, &key, unode->co);
+		}
+		unode->co_delta_ref = SCULPT_UNDO_DELTA_NONE;
+
+		MEM_freeN(unode->co_compressed);
+		unode->co_compressed = NULL;
+	}
+
+	if (unode->orig_co_compressed) {
+		unode->orig_co = MEM_mapallocN(co_len, "SculptUndoNode.orig_co");
+		sculpt_undo_decompress_array(unode->orig_co, co_len,
+		                             unode->orig_co_compressed, unode->orig_co_compressed_size);
+
+		MEM_freeN(unode->orig_co_compressed);
+		unode->orig_co_compressed = NULL;
+	}
+#else
+	UNUSED_VARS(unode, ss, dm);
+#endif
+}
+
 static bool sculpt_undo_restore_coords(bContext *C, DerivedMesh *dm, SculptUndoNode *unode)
 {
 	Scene *scene = CTX_data_scene(C);
@@ -130,7 +363,9 @@ static bool sculpt_undo_restore_coords(bContext *C, DerivedMesh *dm, SculptUndoN
 	SculptSession *ss = ob->sculpt;
 	MVert *mvert;
 	int *index;
-	
+
+	sculpt_undo_node_decompress(unode, ss, dm);
+
 	if (unode->maxvert) {
 		/* regular mesh restore */
 
@@ -580,6 +815,10 @@ static void sculpt_undo_free(ListBase *lb)
 			MEM_freeN(unode->grids);
 		if (unode->orig_co)
 			MEM_freeN(unode->orig_co);
+		if (unode->co_compressed)
+			MEM_freeN(unode->co_compressed);
+		if (unode->orig_co_compressed)
+			MEM_freeN(unode->orig_co_compressed);
 		if (unode->vert_hidden)
 			MEM_freeN(unode->vert_hidden);
 		if (unode->grid_hidden) {
@@ -909,6 +1148,14 @@ SculptUndoNode *sculpt_undo_push_node(Object *ob, PBVHNode *node,
 		BKE_pbvh_node_get_grids(ss->pbvh, node, &grids, &totgrid,
 		                        NULL, NULL, NULL);
 		memcpy(unode->grids, grids, sizeof(int) * totgrid);
+
+		if (ELEM(type, SCULPT_UNDO_COORDS, SCULPT_UNDO_MASK)) {
+			/* mark these grids for the next mdisps update, bitmap writes
+			 * are not atomic so reuse the undo list lock */
+			BLI_lock_thread(LOCK_CUSTOM1);
+			multires_mark_grids_as_modified(ob, grids, totgrid);
+			BLI_unlock_thread(LOCK_CUSTOM1);
+		}
 	}
 	else {
 		const int *vert_indices;
@@ -964,6 +1211,11 @@ void sculpt_undo_push_end(const bContext *C)
 			BKE_pbvh_node_layer_disp_free(unode->node);
 	}
 
+#ifdef WITH_LZO
+	/* pack coordinate arrays before the nodes go on the stack */
+	sculpt_undo_compress_nodes(CTX_data_active_object(C), lb);
+#endif
+
 	ED_undo_paint_push_end(UNDO_PAINT_MESH);
 
 	WM_file_tag_modified(C);
@@ -40,6 +40,7 @@
 
 #ifndef WIN32
 #  include <unistd.h>
+#  include <dirent.h>
 #else
 #  include <io.h>
 #  include <direct.h>
@@ -2148,57 +2149,76 @@ typedef struct TodoDir {
 	char *dir;
 } TodoDir;
 
+/* Max number of entries listed in one go by filelist_readjob_list_dir, so that huge flat directories
+ * (network mounts...) get published to the UI in several chunks instead of one big freeze. */
+#define FILELIST_READJOB_LIST_CHUNK_SIZE 1024
+
+/**
+ * Read at most #FILELIST_READJOB_LIST_CHUNK_SIZE entries from \a root, opening the directory on first call.
+ * \a dir_handle keeps the position across calls, it is set back to NULL once the whole directory has been read
+ * (caller is responsible to close it if listing is aborted in between).
+ */
 static int filelist_readjob_list_dir(
-        const char *root, ListBase *entries, const char *filter_glob,
+        DIR **dir_handle, const char *root, ListBase *entries, const char *filter_glob,
         const bool do_lib, const char *main_name, const bool skip_currpar)
 {
-	struct direntry *files;
-	int nbr_files, nbr_entries = 0;
+	struct dirent *fname;
+	int nbr_entries = 0;
 
-	nbr_files = BLI_filelist_dir_contents(root, &files);
-	if (files) {
-		int i = nbr_files;
-		while (i--) {
-			FileListInternEntry *entry;
+	if (*dir_handle == NULL) {
+		*dir_handle = opendir(root);
+		if (*dir_handle == NULL) {
+			return nbr_entries;
+		}
+	}
 
-			if (skip_currpar && FILENAME_IS_CURRPAR(files[i].relname)) {
-				continue;
-			}
+	while (nbr_entries < FILELIST_READJOB_LIST_CHUNK_SIZE) {
+		FileListInternEntry *entry;
+		char fullname[FILE_MAX_LIBEXTRA];
 
-			entry = MEM_callocN(sizeof(*entry), __func__);
-			entry->relpath = MEM_dupallocN(files[i].relname);
-			entry->st = files[i].s;
+		if ((fname = readdir(*dir_handle)) == NULL) {
+			closedir(*dir_handle);
+			*dir_handle = NULL;
+			break;
+		}
 
-			/* Set file type. */
-			if (S_ISDIR(files[i].s.st_mode)) {
-				entry->typeflag = FILE_TYPE_DIR;
-			}
-			else if (do_lib && BLO_has_bfile_extension(entry->relpath)) {
-				/* If we are considering .blend files as libs, promote them to directory status. */
-				char name[FILE_MAX];
+		if (skip_currpar && FILENAME_IS_CURRPAR(fname->d_name)) {
+			continue;
+		}
 
-				entry->typeflag = FILE_TYPE_BLENDER;
+		entry = MEM_callocN(sizeof(*entry), __func__);
+		entry->relpath = BLI_strdup(fname->d_name);
 
-				BLI_join_dirfile(name, sizeof(name), root, entry->relpath);
+		BLI_join_dirfile(fullname, sizeof(fullname), root, entry->relpath);
+		if (BLI_stat(fullname, &entry->st) == -1) {
+			memset(&entry->st, 0, sizeof(entry->st));
+		}
 
-				/* prevent current file being used as acceptable dir */
-				if (BLI_path_cmp(main_name, name) != 0) {
-					entry->typeflag |= FILE_TYPE_DIR;
-				}
+		/* Set file type. */
+		if (S_ISDIR(entry->st.st_mode)) {
+			entry->typeflag = FILE_TYPE_DIR;
+		}
+		else if (do_lib && BLO_has_bfile_extension(entry->relpath)) {
+			/* If we are considering .blend files as libs, promote them to directory status. */
+			entry->typeflag = FILE_TYPE_BLENDER;
+
+			/* prevent current file being used as acceptable dir */
+			if (BLI_path_cmp(main_name, fullname) != 0) {
+				entry->typeflag |= FILE_TYPE_DIR;
 			}
-			/* Otherwise, do not check extensions for directories! */
-			else if (!(entry->typeflag & FILE_TYPE_DIR)) {
-				entry->typeflag = file_extension_type(root, entry->relpath);
-				if (filter_glob[0] && BLI_testextensie_glob(entry->relpath, filter_glob)) {
-					entry->typeflag |= FILE_TYPE_OPERATOR;
-				}
+		}
+		/* Otherwise, do not check extensions for directories! */
+		else if (!(entry->typeflag & FILE_TYPE_DIR)) {
+			entry->typeflag = file_extension_type(root, entry->relpath);
+			if (filter_glob[0] && BLI_testextensie_glob(entry->relpath, filter_glob)) {
+				entry->typeflag |= FILE_TYPE_OPERATOR;
 			}
-
-			BLI_addtail(entries, entry);
-			nbr_entries++;
 		}
-		BLI_filelist_free(files, nbr_files);
+
+		BLI_addtail(entries, entry);
+		nbr_entries++;
 	}
+
 	return nbr_entries;
 }
 
@@ -2440,6 +2460,7 @@ static void filelist_readjob_do(
 
 	while (!BLI_stack_is_empty(todo_dirs) && !(*stop)) {
 		FileListInternEntry *entry;
+		DIR *dir_handle = NULL;
 		int nbr_entries = 0;
 		bool is_lib = do_lib;
 
@@ -2466,57 +2487,70 @@ static void filelist_readjob_do(
 		if (do_lib) {
 			nbr_entries = filelist_readjob_list_lib(subdir, &entries, skip_currpar);
 		}
-		if (!nbr_entries) {
-			is_lib = false;
-			nbr_entries = filelist_readjob_list_dir(subdir, &entries, filter_glob, do_lib, main_name, skip_currpar);
-		}
 
-		for (entry = entries.first; entry; entry = entry->next) {
-			BLI_join_dirfile(dir, sizeof(dir), rel_subdir, entry->relpath);
-
-			/* Generate our entry uuid. Abusing uuid as an uint32, shall be more than enough here,
-			 * things would crash way before we overflow that counter!
-			 * Using an atomic operation to avoid having to lock thread...
-			 * Note that we do not really need this here currently, since there is a single listing thread, but better
-			 * remain consistent about threading! */
-			*((uint32_t *)entry->uuid) = atomic_add_uint32((uint32_t *)filelist->filelist_intern.curr_uuid, 1);
-
-			/* Only thing we change in direntry here, so we need to free it first. */
-			MEM_freeN(entry->relpath);
-			entry->relpath = BLI_strdup(dir + 2);  /* + 2 to remove '//' added by BLI_path_rel to rel_subdir */
-			entry->name = BLI_strdup(fileentry_uiname(root, entry->relpath, entry->typeflag, dir));
+		/* Huge flat directories are read and published in chunks, so that the UI can start drawing
+		 * the first entries while we are still stat'ing the rest. */
+		do {
+			if (!nbr_entries) {
+				is_lib = false;
+				nbr_entries = filelist_readjob_list_dir(
+				                  &dir_handle, subdir, &entries, filter_glob, do_lib, main_name, skip_currpar);
+			}
 
-			/* Here we decide whether current filedirentry is to be listed too, or not. */
-			if (max_recursion && (is_lib || (recursion_level <= max_recursion))) {
-				if (((entry->typeflag & FILE_TYPE_DIR) == 0) || FILENAME_IS_CURRPAR(entry->relpath)) {
-					/* Skip... */
-				}
-				else if (!is_lib && (recursion_level >= max_recursion) &&
-				         ((entry->typeflag & (FILE_TYPE_BLENDER | FILE_TYPE_BLENDER_BACKUP)) == 0))
-				{
-					/* Do not recurse in real directories in this case, only in .blend libs. */
-				}
-				else {
-					/* We have a directory we want to list, add it to todo list! */
-					BLI_join_dirfile(dir, sizeof(dir), root, entry->relpath);
-					BLI_cleanup_dir(main_name, dir);
-					td_dir = BLI_stack_push_r(todo_dirs);
-					td_dir->level = recursion_level + 1;
-					td_dir->dir = BLI_strdup(dir);
-					nbr_todo_dirs++;
+			for (entry = entries.first; entry; entry = entry->next) {
+				BLI_join_dirfile(dir, sizeof(dir), rel_subdir, entry->relpath);
+
+				/* Generate our entry uuid. Abusing uuid as an uint32, shall be more than enough here,
+				 * things would crash way before we overflow that counter!
+				 * Using an atomic operation to avoid having to lock thread...
+				 * Note that we do not really need this here currently, since there is a single listing thread, but better
+				 * remain consistent about threading! */
+				*((uint32_t *)entry->uuid) = atomic_add_uint32((uint32_t *)filelist->filelist_intern.curr_uuid, 1);
+
+				/* Only thing we change in direntry here, so we need to free it first. */
+				MEM_freeN(entry->relpath);
+				entry->relpath = BLI_strdup(dir + 2);  /* + 2 to remove '//' added by BLI_path_rel to rel_subdir */
+				entry->name = BLI_strdup(fileentry_uiname(root, entry->relpath, entry->typeflag, dir));
+
+				/* Here we decide whether current filedirentry is to be listed too, or not. */
+				if (max_recursion && (is_lib || (recursion_level <= max_recursion))) {
+					if (((entry->typeflag & FILE_TYPE_DIR) == 0) || FILENAME_IS_CURRPAR(entry->relpath)) {
+						/* Skip... */
+					}
+					else if (!is_lib && (recursion_level >= max_recursion) &&
+					         ((entry->typeflag & (FILE_TYPE_BLENDER | FILE_TYPE_BLENDER_BACKUP)) == 0))
+					{
+						/* Do not recurse in real directories in this case, only in .blend libs. */
+					}
+					else {
+						/* We have a directory we want to list, add it to todo list! */
+						BLI_join_dirfile(dir, sizeof(dir), root, entry->relpath);
+						BLI_cleanup_dir(main_name, dir);
+						td_dir = BLI_stack_push_r(todo_dirs);
+						td_dir->level = recursion_level + 1;
+						td_dir->dir = BLI_strdup(dir);
+						nbr_todo_dirs++;
+					}
 				}
 			}
-		}
 
-		if (nbr_entries) {
-			BLI_mutex_lock(lock);
+			if (nbr_entries) {
+				BLI_mutex_lock(lock);
+
+				*do_update = true;
 
-			*do_update = true;
+				BLI_movelisttolist(&filelist->filelist.entries, &entries);
+				filelist->filelist.nbr_entries += nbr_entries;
+
+				BLI_mutex_unlock(lock);
+			}
 
-			BLI_movelisttolist(&filelist->filelist.entries, &entries);
-			filelist->filelist.nbr_entries += nbr_entries;
+			nbr_entries = 0;
+		} while (dir_handle && !(*stop));
 
-			BLI_mutex_unlock(lock);
+		if (dir_handle) {
+			/* We were interrupted in the middle of a directory listing. */
+			closedir(dir_handle);
 		}
 
 		nbr_done_dirs++;
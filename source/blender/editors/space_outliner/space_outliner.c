@@ -292,7 +292,30 @@ static void outliner_main_region_free(ARegion *UNUSED(ar))
 	
 }
 
-static void outliner_main_region_listener(bScreen *UNUSED(sc), ScrArea *UNUSED(sa), ARegion *ar, wmNotifier *wmn)
+/**
+ * Tag the main outliner region for redraw.
+ *
+ * Notifiers which cannot add, remove or reorder tree elements (selection, icon and draw-mode
+ * changes...) reuse the tree built for the previous redraw instead of reconstructing every
+ * element, which makes a real difference with many thousands of datablocks. View modes which
+ * filter on the changed flags, and the raw RNA views, always rebuild to stay correct.
+ */
+static void outliner_main_region_tag_redraw(ScrArea *sa, ARegion *ar, const bool rebuild)
+{
+	SpaceOops *soops = sa ? sa->spacedata.first : NULL;
+
+	if (soops) {
+		if (rebuild || ELEM(soops->outlinevis, SO_VISIBLE, SO_SELECTED, SO_SAME_TYPE, SO_DATABLOCKS, SO_USERDEF)) {
+			soops->storeflag &= ~SO_TREESTORE_REDRAW;
+		}
+		else {
+			soops->storeflag |= SO_TREESTORE_REDRAW;
+		}
+	}
+	ED_region_tag_redraw(ar);
+}
+
+static void outliner_main_region_listener(bScreen *UNUSED(sc), ScrArea *sa, ARegion *ar, wmNotifier *wmn)
 {
 	/* context changes */
 	switch (wmn->category) {
@@ -302,13 +325,15 @@ static void outliner_main_region_listener(bScreen *UNUSED(sc), ScrArea *UNUSED(s
 				case ND_OB_SELECT:
 				case ND_OB_VISIBLE:
 				case ND_OB_RENDER:
-				case ND_MODE:
-				case ND_KEYINGSET:
 				case ND_FRAME:
 				case ND_RENDER_OPTIONS:
+					outliner_main_region_tag_redraw(sa, ar, false);
+					break;
+				case ND_MODE:
+				case ND_KEYINGSET:
 				case ND_LAYER:
 				case ND_WORLD:
-					ED_region_tag_redraw(ar);
+					outliner_main_region_tag_redraw(sa, ar, true);
 					break;
 			}
 			break;
@@ -320,50 +345,52 @@ static void outliner_main_region_listener(bScreen *UNUSED(sc), ScrArea *UNUSED(s
 				case ND_BONE_ACTIVE:
 				case ND_BONE_SELECT:
 				case ND_DRAW:
-				case ND_PARENT:
 				case ND_OB_SHADING:
-					ED_region_tag_redraw(ar);
+					outliner_main_region_tag_redraw(sa, ar, false);
+					break;
+				case ND_PARENT:
+					outliner_main_region_tag_redraw(sa, ar, true);
 					break;
 				case ND_CONSTRAINT:
 					switch (wmn->action) {
 						case NA_ADDED:
 						case NA_REMOVED:
 						case NA_RENAME:
-							ED_region_tag_redraw(ar);
+							outliner_main_region_tag_redraw(sa, ar, true);
 							break;
 					}
 					break;
 				case ND_MODIFIER:
 					/* all modifier actions now */
-					ED_region_tag_redraw(ar);
+					outliner_main_region_tag_redraw(sa, ar, true);
 					break;
 				default:
 					/* Trigger update for NC_OBJECT itself */
-					ED_region_tag_redraw(ar);
+					outliner_main_region_tag_redraw(sa, ar, true);
 					break;
 			}
 			break;
 		case NC_GROUP:
 			/* all actions now, todo: check outliner view mode? */
-			ED_region_tag_redraw(ar);
+			outliner_main_region_tag_redraw(sa, ar, true);
 			break;
 		case NC_LAMP:
 			/* For updating lamp icons, when changing lamp type */
 			if (wmn->data == ND_LIGHTING_DRAW)
-				ED_region_tag_redraw(ar);
+				outliner_main_region_tag_redraw(sa, ar, false);
 			break;
 		case NC_SPACE:
 			if (wmn->data == ND_SPACE_OUTLINER)
-				ED_region_tag_redraw(ar);
+				outliner_main_region_tag_redraw(sa, ar, true);
 			break;
 		case NC_ID:
 			if (wmn->action == NA_RENAME)
-				ED_region_tag_redraw(ar);
+				outliner_main_region_tag_redraw(sa, ar, true);
 			break;
 		case NC_MATERIAL:
 			switch (wmn->data) {
 				case ND_SHADING_LINKS:
-					ED_region_tag_redraw(ar);
+					outliner_main_region_tag_redraw(sa, ar, true);
 					break;
 			}
 			break;
@@ -371,28 +398,32 @@ static void outliner_main_region_listener(bScreen *UNUSED(sc), ScrArea *UNUSED(s
 			switch (wmn->data) {
 				case ND_VERTEX_GROUP:
 				case ND_DATA:
-					ED_region_tag_redraw(ar);
+					outliner_main_region_tag_redraw(sa, ar, true);
 					break;
 			}
 			break;
 		case NC_ANIMATION:
 			switch (wmn->data) {
 				case ND_NLA_ACTCHANGE:
+					outliner_main_region_tag_redraw(sa, ar, true);
+					break;
 				case ND_KEYFRAME:
-					ED_region_tag_redraw(ar);
+					outliner_main_region_tag_redraw(sa, ar, false);
 					break;
 				case ND_ANIMCHAN:
 					if (wmn->action == NA_SELECTED)
-						ED_region_tag_redraw(ar);
+						outliner_main_region_tag_redraw(sa, ar, false);
 					break;
 			}
 			break;
 		case NC_GPENCIL:
-			if (ELEM(wmn->action, NA_EDITED, NA_SELECTED))
-				ED_region_tag_redraw(ar);
+			if (wmn->action == NA_EDITED)
+				outliner_main_region_tag_redraw(sa, ar, true);
+			else if (wmn->action == NA_SELECTED)
+				outliner_main_region_tag_redraw(sa, ar, false);
 			break;
 	}
-	
+
 }
 
 
@@ -37,6 +37,7 @@
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_timecode.h"
 #include "BLI_utildefines.h"
 
@@ -143,23 +144,58 @@ static void proxy_freejob(void *pjv)
 	MEM_freeN(pj);
 }
 
+typedef struct ProxyBuildTaskData {
+	ProxyJob *pj;
+	struct SeqIndexBuildContext **contexts;
+	short *stop;
+	short *do_update;
+	float *progress;
+} ProxyBuildTaskData;
+
+static void proxy_build_task_cb(void *userdata, const int i)
+{
+	ProxyBuildTaskData *data = userdata;
+
+	BKE_sequencer_proxy_rebuild(data->contexts[i], data->stop, data->do_update, data->progress);
+
+	if (*data->stop) {
+		data->pj->stop = 1;
+	}
+}
+
 /* only this runs inside thread */
 static void proxy_startjob(void *pjv, short *stop, short *do_update, float *progress)
 {
 	ProxyJob *pj = pjv;
+	ProxyBuildTaskData task_data;
 	LinkData *link;
+	int queue_len, i;
 
-	for (link = pj->queue.first; link; link = link->next) {
-		struct SeqIndexBuildContext *context = link->data;
+	queue_len = BLI_listbase_count(&pj->queue);
 
-		BKE_sequencer_proxy_rebuild(context, stop, do_update, progress);
-		
-		if (*stop) {
-			pj->stop = 1;
-			fprintf(stderr,  "Canceling proxy rebuild on users request...\n");
-			break;
-		}
+	if (queue_len == 0) {
+		return;
+	}
+
+	task_data.pj = pj;
+	task_data.contexts = MEM_mallocN(sizeof(*task_data.contexts) * queue_len, "proxy build queue");
+	task_data.stop = stop;
+	task_data.do_update = do_update;
+	task_data.progress = progress;
+
+	for (link = pj->queue.first, i = 0; link; link = link->next, i++) {
+		task_data.contexts[i] = link->data;
+	}
+
+	/* every strip builds into its own proxy files from its own decode
+	 * handles, so the queue entries can run as parallel tasks */
+	BLI_task_parallel_range(0, queue_len, &task_data, proxy_build_task_cb, (queue_len > 1));
+
+	if (pj->stop) {
+		fprintf(stderr,  "Canceling proxy rebuild on users request...\n");
 	}
+
+	MEM_freeN(task_data.contexts);
 }
 
 static void proxy_endjob(void *pjv)
@@ -226,6 +262,114 @@ static void seq_proxy_build_job(const bContext *C)
 	ED_area_tag_redraw(sa);
 }
 
+/* ***************** prefetch job manager ********************** */
+
+typedef struct SeqPrefetchJob {
+	Scene *scene;
+	struct SeqPrefetchContext *prefetch_context;
+	SeqRenderData context;
+	int chanshown;
+	int start_frame;
+	int end_frame;
+} SeqPrefetchJob;
+
+static void seq_prefetch_freejob(void *pjv)
+{
+	SeqPrefetchJob *pj = pjv;
+
+	if (pj->prefetch_context) {
+		BKE_sequencer_prefetch_context_free(pj->prefetch_context);
+	}
+
+	MEM_freeN(pj);
+}
+
+/* only this runs inside thread */
+static void seq_prefetch_startjob(void *pjv, short *stop, short *do_update, float *progress)
+{
+	SeqPrefetchJob *pj = pjv;
+	int cfra;
+
+	for (cfra = pj->start_frame; cfra <= pj->end_frame; cfra++) {
+		if (!BKE_sequencer_prefetch_frame(pj->prefetch_context, &pj->context, cfra, pj->chanshown)) {
+			break;
+		}
+
+		*progress = (float)(cfra - pj->start_frame + 1) / (pj->end_frame - pj->start_frame + 1);
+		*do_update = true;
+
+		if (*stop || G.is_break) {
+			break;
+		}
+	}
+}
+
+static void seq_prefetch_job(const bContext *C)
+{
+	wmJob *wm_job;
+	SeqPrefetchJob *pj;
+	Main *bmain = CTX_data_main(C);
+	Scene *scene = CTX_data_scene(C);
+	SpaceSeq *sseq = CTX_wm_space_seq(C);
+	struct SeqPrefetchContext *prefetch_context;
+	float render_size;
+	float proxy_size = 100.0;
+
+	if (sseq == NULL || CFRA >= EFRA) {
+		return;
+	}
+
+	if (WM_jobs_test(CTX_wm_manager(C), CTX_wm_area(C), WM_JOB_TYPE_SEQ_PREFETCH)) {
+		return;
+	}
+
+	/* resolution rules from sequencer_ibuf_get, the cache keys have to match
+	 * what drawing the preview will look up */
+	render_size = sseq->render_size;
+	if (render_size == 0) {
+		render_size = scene->r.size;
+	}
+	else {
+		proxy_size = render_size;
+	}
+
+	if (render_size < 0) {
+		return;
+	}
+
+	prefetch_context = BKE_sequencer_prefetch_context_create(scene);
+
+	if (prefetch_context == NULL) {
+		return;
+	}
+
+	wm_job = WM_jobs_get(CTX_wm_manager(C), CTX_wm_window(C), CTX_wm_area(C), "Prefetching",
+	                     WM_JOB_PROGRESS, WM_JOB_TYPE_SEQ_PREFETCH);
+
+	pj = MEM_callocN(sizeof(SeqPrefetchJob), "seq prefetch job");
+
+	pj->scene = scene;
+	pj->prefetch_context = prefetch_context;
+	pj->chanshown = sseq->chanshown;
+	pj->start_frame = CFRA + 1;
+	pj->end_frame = EFRA;
+
+	BKE_sequencer_new_render_data(
+	        bmain->eval_ctx, bmain, scene,
+	        (render_size * (float)scene->r.xsch) / 100.0f + 0.5f,
+	        (render_size * (float)scene->r.ysch) / 100.0f + 0.5f,
+	        proxy_size, &pj->context);
+
+	WM_jobs_customdata_set(wm_job, pj, seq_prefetch_freejob);
+	WM_jobs_timer(wm_job, 0.2, NC_SCENE | ND_SEQUENCER, 0);
+	WM_jobs_callbacks(wm_job, seq_prefetch_startjob, NULL, NULL, NULL);
+
+	G.is_break = false;
+
+	/* and finally start the job */
+	WM_jobs_start(CTX_wm_manager(C), wm_job);
+}
+
 /* ********************************************************************** */
 
 void seq_rectf(Sequence *seq, rctf *rectf)
@@ -3495,6 +3639,46 @@ void SEQUENCER_OT_rebuild_proxy(wmOperatorType *ot)
 	ot->flag = OPTYPE_REGISTER;
 }
 
+/* **************** prefetch operator **************** */
+
+static int sequencer_prefetch_modal(bContext *C, wmOperator *UNUSED(op), const wmEvent *event)
+{
+	/* no running job, remove handler and pass through */
+	if (0 == WM_jobs_test(CTX_wm_manager(C), CTX_wm_area(C), WM_JOB_TYPE_SEQ_PREFETCH))
+		return OPERATOR_FINISHED | OPERATOR_PASS_THROUGH;
+
+	/* running prefetch */
+	switch (event->type) {
+		case ESCKEY:
+			return OPERATOR_RUNNING_MODAL;
+	}
+
+	return OPERATOR_PASS_THROUGH;
+}
+
+static int sequencer_prefetch_invoke(bContext *C, wmOperator *op, const wmEvent *UNUSED(event))
+{
+	seq_prefetch_job(C);
+
+	/* add modal handler for ESC */
+	WM_event_add_modal_handler(C, op);
+
+	return OPERATOR_RUNNING_MODAL;
+}
+
+void SEQUENCER_OT_prefetch(wmOperatorType *ot)
+{
+	/* identifiers */
+	ot->name = "Prefetch Frames";
+	ot->idname = "SEQUENCER_OT_prefetch";
+	ot->description = "Prefetch frames after the current frame into the sequencer cache for faster playback";
+
+	/* api callbacks */
+	ot->poll = sequencer_edit_poll;
+	ot->invoke = sequencer_prefetch_invoke;
+	ot->modal = sequencer_prefetch_modal;
+}
+
 static int sequencer_enable_proxies_invoke(bContext *C, wmOperator *op, const wmEvent *UNUSED(event))
 {
 	return WM_operator_props_dialog_popup(C, op, 10 * UI_UNIT_X, 5 * UI_UNIT_Y);
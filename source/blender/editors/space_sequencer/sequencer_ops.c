@@ -91,6 +91,7 @@ void sequencer_operatortypes(void)
 	WM_operatortype_append(SEQUENCER_OT_view_ghost_border);
 
 	WM_operatortype_append(SEQUENCER_OT_rebuild_proxy);
+	WM_operatortype_append(SEQUENCER_OT_prefetch);
 	WM_operatortype_append(SEQUENCER_OT_enable_proxies);
 	WM_operatortype_append(SEQUENCER_OT_change_effect_input);
 	WM_operatortype_append(SEQUENCER_OT_change_effect_type);
@@ -230,6 +231,8 @@ void sequencer_keymap(wmKeyConfig *keyconf)
 	WM_keymap_add_item(keymap, "SEQUENCER_OT_snap", SKEY, KM_PRESS, KM_SHIFT, 0);
 	WM_keymap_add_item(keymap, "SEQUENCER_OT_swap_inputs", SKEY, KM_PRESS, KM_ALT, 0);
 
+	WM_keymap_add_item(keymap, "SEQUENCER_OT_prefetch", PKEY, KM_PRESS, 0, 0);
+
 	/* multicam editing keyboard layout, switch to camera 1-10 using
 	 * regular number keys */
 	{
@@ -7462,6 +7462,51 @@ static void draw_rigidbody_shape(Object *ob)
  * main object drawing function, draws in selection
  * \param dflag (draw flag) can be DRAW_PICKING and/or DRAW_CONSTCOLOR, DRAW_SCENESET
  */
+/* Fast check to skip objects which can't possibly touch the viewport.
+ *
+ * Only cull objects where everything they draw is known to stay inside the
+ * boundbox (expanded to include the object center, the center dot and name
+ * are drawn there). Anything which may draw outside of it - particles,
+ * motion paths, force fields, relationship lines of selected objects -
+ * disqualifies the object so it takes the full #draw_object path. */
+static bool draw_object_is_culled(Scene *scene, RegionView3D *rv3d, Base *base)
+{
+	Object *ob = base->object;
+	BoundBox bb;
+	float min[3], max[3], center[3];
+	int i;
+
+	if (!ELEM(ob->type, OB_MESH, OB_CURVE, OB_SURF, OB_FONT))
+		return false;
+	if ((ob == scene->obedit) || (ob->mode != OB_MODE_OBJECT))
+		return false;
+	if ((ob->flag & SELECT) || (base->flag & OB_FROMDUPLI))
+		return false;
+	if (ob->bb == NULL)
+		return false;
+	if (ob->particlesystem.first || ob->mpath || ob->soft || ob->rigidbody_object)
+		return false;
+	if (ob->pd && ob->pd->forcefield)
+		return false;
+	if (ob->constraints.first)
+		return false;
+	if (ob->gameflag & OB_BOUNDS)
+		return false;
+	if (ob->dtx & (OB_AXIS | OB_TEXSPACE))
+		return false;
+
+	INIT_MINMAX(min, max);
+	for (i = 0; i < 8; i++) {
+		minmax_v3v3_v3(min, max, ob->bb->vec[i]);
+	}
+	/* object center, in object space this is the origin */
+	zero_v3(center);
+	minmax_v3v3_v3(min, max, center);
+	BKE_boundbox_init_from_minmax(&bb, min, max);
+
+	return !ED_view3d_boundbox_clip_ex(rv3d, &bb, ob->obmat);
+}
+
 void draw_object(Scene *scene, ARegion *ar, View3D *v3d, Base *base, const short dflag)
 {
 	ModifierData *md = NULL;
@@ -7556,6 +7601,13 @@ void draw_object(Scene *scene, ARegion *ar, View3D *v3d, Base *base, const short
 	}
 
 
+	/* skip objects which are fully outside the view, the per type boundbox
+	 * clipping below only saves the geometry draw, not the per object
+	 * matrix/color/extras overhead which dominates for large scenes */
+	if (draw_object_is_culled(scene, rv3d, base)) {
+		return;
+	}
+
 	/* -------------------------------------------------------------------- */
 	/* no return after this point, otherwise leaks */
 
@@ -47,6 +47,7 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_ghash.h"
 #include "BLI_math.h"
 #include "BLI_jitter.h"
 #include "BLI_utildefines.h"
@@ -2055,14 +2056,15 @@ static void draw_dupli_objects_color(
 	RegionView3D *rv3d = ar->regiondata;
 	ListBase *lb;
 	LodLevel *savedlod;
-	DupliObject *dob_prev = NULL, *dob, *dob_next = NULL;
+	DupliObject *dob, *dob_next = NULL;
 	Base tbase = {NULL};
 	BoundBox bb, *bb_tmp; /* use a copy because draw_object, calls clear_mesh_caches */
-	GLuint displist = 0;
+	GHash *dlist_hash;   /* object -> compiled displist, zero value means draw directly */
+	GHash *count_hash;   /* object -> number of drawn instances */
+	GHashIterator gh_iter;
 	unsigned char color_rgb[3];
 	const short dflag_dupli = dflag | DRAW_CONSTCOLOR;
 	short transflag;
-	bool use_displist = false;  /* -1 is initialize */
 	char dt;
 	short dtx;
 	DupliApplyData *apply_data;
@@ -2079,14 +2081,26 @@ static void draw_dupli_objects_color(
 
 	tbase.flag = OB_FROMDUPLI | base->flag;
 	lb = object_duplilist(G.main->eval_ctx, scene, base->object);
-	// BLI_listbase_sort(lb, dupli_ob_sort); /* might be nice to have if we have a dupli list with mixed objects. */
 
 	apply_data = duplilist_apply(base->object, scene, lb);
 
+	/* group instances by source object: one display list gets compiled per
+	 * object drawn more than once and replayed for every instance, also when
+	 * different objects interleave in the list (particle duplis of a group) */
+	count_hash = BLI_ghash_ptr_new_ex(__func__, 64);
+	for (dob = dupli_step(lb->first); dob; dob = dupli_step(dob->next)) {
+		void **count_p;
+		if (!BLI_ghash_ensure_p(count_hash, dob->ob, &count_p)) {
+			*count_p = NULL;
+		}
+		*count_p = SET_INT_IN_POINTER(GET_INT_FROM_POINTER(*count_p) + 1);
+	}
+	dlist_hash = BLI_ghash_ptr_new_ex(__func__, 64);
+
 	dob = dupli_step(lb->first);
 	if (dob) dob_next = dupli_step(dob->next);
 
-	for (; dob; dob_prev = dob, dob = dob_next, dob_next = dob_next ? dupli_step(dob_next->next) : NULL) {
+	for (; dob; dob = dob_next, dob_next = dob_next ? dupli_step(dob_next->next) : NULL) {
 		bool testbb = false;
 
 		tbase.object = dob->ob;
@@ -2124,31 +2138,26 @@ static void draw_dupli_objects_color(
 		if ((dflag & DRAW_CONSTCOLOR) == 0) {
 			glColor3ubv(color_rgb);
 		}
-		
-		/* generate displist, test for new object */
-		if (dob_prev && dob_prev->ob != dob->ob) {
-			if (use_displist == true)
-				glDeleteLists(displist, 1);
-			
-			use_displist = false;
-		}
-		
+
 		if ((bb_tmp = BKE_object_boundbox_get(dob->ob))) {
 			bb = *bb_tmp; /* must make a copy  */
 			testbb = true;
 		}
 
 		if (!testbb || ED_view3d_boundbox_clip_ex(rv3d, &bb, dob->mat)) {
-			/* generate displist */
-			if (use_displist == false) {
-				
+			void **dlist_p;
+			GLuint displist;
+
+			/* generate displist on first encounter of the object */
+			if (!BLI_ghash_ensure_p(dlist_hash, dob->ob, &dlist_p)) {
+
 				/* note, since this was added, its checked (dob->type == OB_DUPLIGROUP)
 				 * however this is very slow, it was probably needed for the NLA
 				 * offset feature (used in group-duplicate.blend but no longer works in 2.5)
 				 * so for now it should be ok to - campbell */
-				
-				if ( /* if this is the last no need  to make a displist */
-				     (dob_next == NULL || dob_next->ob != dob->ob) ||
+
+				if ( /* single instance, not worth a displist */
+				     (GET_INT_FROM_POINTER(BLI_ghash_lookup(count_hash, dob->ob)) < 2) ||
 				     /* lamp drawing messes with matrices, could be handled smarter... but this works */
 				     (dob->ob->type == OB_LAMP) ||
 				     (dob->type == OB_DUPLIGROUP && dob->animated) ||
@@ -2158,32 +2167,34 @@ static void draw_dupli_objects_color(
 				     (v3d->flag2 & V3D_SOLID_MATCAP) != 0)
 				{
 					// printf("draw_dupli_objects_color: skipping displist for %s\n", dob->ob->id.name + 2);
-					use_displist = false;
+					*dlist_p = NULL;
 				}
 				else {
 					// printf("draw_dupli_objects_color: using displist for %s\n", dob->ob->id.name + 2);
-					
+
 					/* disable boundbox check for list creation */
 					BKE_object_boundbox_flag(dob->ob, BOUNDBOX_DISABLED, 1);
 					/* need this for next part of code */
 					unit_m4(dob->ob->obmat);    /* obmat gets restored */
-					
+
 					displist = glGenLists(1);
 					glNewList(displist, GL_COMPILE);
 					draw_object(scene, ar, v3d, &tbase, dflag_dupli);
 					glEndList();
-					
-					use_displist = true;
+
 					BKE_object_boundbox_flag(dob->ob, BOUNDBOX_DISABLED, 0);
-				}		
+					*dlist_p = SET_UINT_IN_POINTER(displist);
+				}
 			}
-			
-			if (use_displist) {
+
+			displist = GET_UINT_FROM_POINTER(*dlist_p);
+
+			if (displist) {
 				glPushMatrix();
 				glMultMatrixf(dob->mat);
 				glCallList(displist);
 				glPopMatrix();
-			}	
+			}
 			else {
 				copy_m4_m4(dob->ob->obmat, dob->mat);
 				GPU_begin_dupli_object(dob);
@@ -2204,9 +2215,15 @@ static void draw_dupli_objects_color(
 	}
 
 	free_object_duplilist(lb);
-	
-	if (use_displist)
-		glDeleteLists(displist, 1);
+
+	GHASH_ITER (gh_iter, dlist_hash) {
+		GLuint displist = GET_UINT_FROM_POINTER(BLI_ghashIterator_getValue(&gh_iter));
+		if (displist) {
+			glDeleteLists(displist, 1);
+		}
+	}
+	BLI_ghash_free(dlist_hash, NULL, NULL);
+	BLI_ghash_free(count_hash, NULL, NULL);
 }
 
 static void draw_dupli_objects(Scene *scene, ARegion *ar, View3D *v3d, Base *base)
@@ -52,6 +52,7 @@
 #include "BLI_string.h"
 #include "BLI_ghash.h"
 #include "BLI_memarena.h"
+#include "BLI_task.h"
 
 #include "BKE_nla.h"
 #include "BKE_editmesh.h"
@@ -4315,12 +4316,51 @@ static void headerTranslation(TransInfo *t, const float vec[3], char str[UI_MAX_
 	}
 }
 
+typedef struct TranslateTaskData {
+	TransInfo *t;
+	float vec[3];
+} TranslateTaskData;
+
+static void applyTranslationValue_task_cb(void *userdata, const int i)
+{
+	TranslateTaskData *ttd = userdata;
+	TransData *td = &ttd->t->data[i];
+	float tvec[3];
+
+	/* the NOACTION tail the serial loop breaks on is simply skipped here */
+	if (td->flag & (TD_NOACTION | TD_SKIP))
+		return;
+
+	copy_v3_v3(tvec, ttd->vec);
+
+	mul_m3_v3(td->smtx, tvec);
+	mul_v3_fl(tvec, td->factor);
+
+	protectedTransBits(td->protectflag, tvec);
+
+	if (td->loc)
+		add_v3_v3v3(td->loc, td->iloc, tvec);
+
+	constraintTransLim(ttd->t, td);
+}
+
 static void applyTranslationValue(TransInfo *t, const float vec[3])
 {
 	TransData *td = t->data;
 	float tvec[3];
 	int i;
 
+	/* huge element counts only happen without constraints or snapped normals
+	 * (mesh vertices), that common case can run one range per thread */
+	if ((t->total > 10000) && (t->con.applyVec == NULL) && (usingSnappingNormal(t) == false)) {
+		TranslateTaskData ttd;
+
+		ttd.t = t;
+		copy_v3_v3(ttd.vec, vec);
+		BLI_task_parallel_range(0, t->total, &ttd, applyTranslationValue_task_cb, true);
+		return;
+	}
+
 	for (i = 0; i < t->total; i++, td++) {
 		if (td->flag & TD_NOACTION)
 			break;
@@ -56,6 +56,7 @@
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
 #include "BLI_listbase.h"
+#include "BLI_task.h"
 #include "BLI_linklist_stack.h"
 #include "BLI_string.h"
 #include "BLI_bitmap.h"
@@ -211,12 +212,70 @@ static void sort_trans_data(TransInfo *t)
 	}
 }
 
+typedef struct SetPropDistData {
+	TransData *data;
+	int total;
+	const float *proj_vec;
+	bool use_island;
+	bool with_dist;
+} SetPropDistData;
+
+/* distance of one element to the nearest selected one, each element only
+ * reads the selected elements and writes itself so this runs per thread */
+static void set_prop_dist_task_cb(void *userdata, const int a)
+{
+	SetPropDistData *spd = userdata;
+	TransData *tob = &spd->data[a];
+
+	tob->rdist = 0.0f; // init, it was mallocced
+
+	if ((tob->flag & TD_SELECTED) == 0) {
+		TransData *td;
+		int i;
+		float dist_sq, vec[3];
+
+		tob->rdist = -1.0f; // signal for next loop
+
+		for (i = 0, td = spd->data; i < spd->total; i++, td++) {
+			if (td->flag & TD_SELECTED) {
+				if (spd->use_island) {
+					sub_v3_v3v3(vec, tob->iloc, td->iloc);
+				}
+				else {
+					sub_v3_v3v3(vec, tob->center, td->center);
+				}
+				mul_m3_v3(tob->mtx, vec);
+
+				if (spd->proj_vec) {
+					float vec_p[3];
+					project_v3_v3v3(vec_p, vec, spd->proj_vec);
+					sub_v3_v3(vec, vec_p);
+				}
+
+				dist_sq = len_squared_v3(vec);
+				if ((tob->rdist == -1.0f) || (dist_sq < SQUARE(tob->rdist))) {
+					tob->rdist = sqrtf(dist_sq);
+					if (spd->use_island) {
+						copy_v3_v3(tob->center, td->center);
+						copy_m3_m3(tob->axismtx, td->axismtx);
+					}
+				}
+			}
+			else {
+				break;  /* by definition transdata has selected items in beginning */
+			}
+		}
+		if (spd->with_dist) {
+			tob->dist = tob->rdist;
+		}
+	}
+}
+
 /* distance calculated from not-selected vertex to nearest selected vertex
  * warning; this is loops inside loop, has minor N^2 issues, but by sorting list it is OK */
 static void set_prop_dist(TransInfo *t, const bool with_dist)
 {
-	TransData *tob;
-	int a;
+	SetPropDistData spd;
 
 	float _proj_vec[3];
 	const float *proj_vec = NULL;
@@ -232,51 +291,13 @@ static void set_prop_dist(TransInfo *t, const bool with_dist)
 		}
 	}
 
-	for (a = 0, tob = t->data; a < t->total; a++, tob++) {
-
-		tob->rdist = 0.0f; // init, it was mallocced
-
-		if ((tob->flag & TD_SELECTED) == 0) {
-			TransData *td;
-			int i;
-			float dist_sq, vec[3];
-
-			tob->rdist = -1.0f; // signal for next loop
-
-			for (i = 0, td = t->data; i < t->total; i++, td++) {
-				if (td->flag & TD_SELECTED) {
-					if (use_island) {
-						sub_v3_v3v3(vec, tob->iloc, td->iloc);
-					}
-					else {
-						sub_v3_v3v3(vec, tob->center, td->center);
-					}
-					mul_m3_v3(tob->mtx, vec);
-
-					if (proj_vec) {
-						float vec_p[3];
-						project_v3_v3v3(vec_p, vec, proj_vec);
-						sub_v3_v3(vec, vec_p);
-					}
+	spd.data = t->data;
+	spd.total = t->total;
+	spd.proj_vec = proj_vec;
+	spd.use_island = use_island;
+	spd.with_dist = with_dist;
 
-					dist_sq = len_squared_v3(vec);
-					if ((tob->rdist == -1.0f) || (dist_sq < SQUARE(tob->rdist))) {
-						tob->rdist = sqrtf(dist_sq);
-						if (use_island) {
-							copy_v3_v3(tob->center, td->center);
-							copy_m3_m3(tob->axismtx, td->axismtx);
-						}
-					}
-				}
-				else {
-					break;  /* by definition transdata has selected items in beginning */
-				}
-			}
-			if (with_dist) {
-				tob->dist = tob->rdist;
-			}
-		}
-	}
+	BLI_task_parallel_range(0, t->total, &spd, set_prop_dist_task_cb, (t->total > 1024));
 }
 
 /* ************************** CONVERSIONS ************************* */
@@ -56,6 +56,7 @@
 #include "BLI_math.h"
 #include "BLI_blenlib.h"
 #include "BLI_rand.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -1884,86 +1885,107 @@ void calculateCenter(TransInfo *t)
 	}
 }
 
+static void calculate_prop_ratio_elem(TransInfo *t, TransData *td)
+{
+	const bool connected = (t->flag & T_PROP_CONNECTED) != 0;
+	float dist;
+
+	if (td->flag & TD_SELECTED) {
+		td->factor = 1.0f;
+	}
+	else if (t->flag & T_MIRROR && td->loc[0] * t->mirror < -0.00001f) {
+		td->flag |= TD_SKIP;
+		td->factor = 0.0f;
+		restoreElement(td);
+	}
+	else if ((connected && (td->flag & TD_NOTCONNECTED || td->dist > t->prop_size)) ||
+	         (connected == 0 && td->rdist > t->prop_size))
+	{
+		/*
+		 * The elements are sorted according to their dist member in the array,
+		 * that means we can stop when it finds one element outside of the propsize.
+		 * do not set 'td->flag |= TD_NOACTION', the prop circle is being changed.
+		 */
+
+		td->factor = 0.0f;
+		restoreElement(td);
+	}
+	else {
+		/* Use rdist for falloff calculations, it is the real distance */
+		td->flag &= ~TD_NOACTION;
+
+		if (connected)
+			dist = (t->prop_size - td->dist) / t->prop_size;
+		else
+			dist = (t->prop_size - td->rdist) / t->prop_size;
+
+		/*
+		 * Clamp to positive numbers.
+		 * Certain corner cases with connectivity and individual centers
+		 * can give values of rdist larger than propsize.
+		 */
+		if (dist < 0.0f)
+			dist = 0.0f;
+
+		switch (t->prop_mode) {
+			case PROP_SHARP:
+				td->factor = dist * dist;
+				break;
+			case PROP_SMOOTH:
+				td->factor = 3.0f * dist * dist - 2.0f * dist * dist * dist;
+				break;
+			case PROP_ROOT:
+				td->factor = sqrtf(dist);
+				break;
+			case PROP_LIN:
+				td->factor = dist;
+				break;
+			case PROP_CONST:
+				td->factor = 1.0f;
+				break;
+			case PROP_SPHERE:
+				td->factor = sqrtf(2 * dist - dist * dist);
+				break;
+			case PROP_RANDOM:
+				td->factor = BLI_frand() * dist;
+				break;
+			case PROP_INVSQUARE:
+				td->factor = dist * (2.0f - dist);
+				break;
+			default:
+				td->factor = 1;
+				break;
+		}
+	}
+}
+
+static void calculate_prop_ratio_task_cb(void *userdata, const int i)
+{
+	TransInfo *t = userdata;
+	calculate_prop_ratio_elem(t, &t->data[i]);
+}
+
 void calculatePropRatio(TransInfo *t)
 {
 	TransData *td = t->data;
 	int i;
-	float dist;
-	const bool connected = (t->flag & T_PROP_CONNECTED) != 0;
 
 	t->proptext[0] = '\0';
 
 	if (t->flag & T_PROP_EDIT) {
 		const char *pet_id = NULL;
-		for (i = 0; i < t->total; i++, td++) {
-			if (td->flag & TD_SELECTED) {
-				td->factor = 1.0f;
-			}
-			else if (t->flag & T_MIRROR && td->loc[0] * t->mirror < -0.00001f) {
-				td->flag |= TD_SKIP;
-				td->factor = 0.0f;
-				restoreElement(td);
-			}
-			else if ((connected && (td->flag & TD_NOTCONNECTED || td->dist > t->prop_size)) ||
-			         (connected == 0 && td->rdist > t->prop_size))
-			{
-				/*
-				 * The elements are sorted according to their dist member in the array,
-				 * that means we can stop when it finds one element outside of the propsize.
-				 * do not set 'td->flag |= TD_NOACTION', the prop circle is being changed.
-				 */
-				
-				td->factor = 0.0f;
-				restoreElement(td);
-			}
-			else {
-				/* Use rdist for falloff calculations, it is the real distance */
-				td->flag &= ~TD_NOACTION;
-				
-				if (connected)
-					dist = (t->prop_size - td->dist) / t->prop_size;
-				else
-					dist = (t->prop_size - td->rdist) / t->prop_size;
 
-				/*
-				 * Clamp to positive numbers.
-				 * Certain corner cases with connectivity and individual centers
-				 * can give values of rdist larger than propsize.
-				 */
-				if (dist < 0.0f)
-					dist = 0.0f;
-				
-				switch (t->prop_mode) {
-					case PROP_SHARP:
-						td->factor = dist * dist;
-						break;
-					case PROP_SMOOTH:
-						td->factor = 3.0f * dist * dist - 2.0f * dist * dist * dist;
-						break;
-					case PROP_ROOT:
-						td->factor = sqrtf(dist);
-						break;
-					case PROP_LIN:
-						td->factor = dist;
-						break;
-					case PROP_CONST:
-						td->factor = 1.0f;
-						break;
-					case PROP_SPHERE:
-						td->factor = sqrtf(2 * dist - dist * dist);
-						break;
-					case PROP_RANDOM:
-						td->factor = BLI_frand() * dist;
-						break;
-					case PROP_INVSQUARE:
-						td->factor = dist * (2.0f - dist);
-						break;
-					default:
-						td->factor = 1;
-						break;
-				}
+		if (t->prop_mode == PROP_RANDOM) {
+			/* BLI_frand is neither thread safe nor call order independent */
+			for (i = 0; i < t->total; i++, td++) {
+				calculate_prop_ratio_elem(t, td);
 			}
 		}
+		else {
+			BLI_task_parallel_range(0, t->total, t, calculate_prop_ratio_task_cb,
+			                        (t->total > 10000));
+		}
+
 		switch (t->prop_mode) {
 			case PROP_SHARP:
 				pet_id = N_("(Sharp)");
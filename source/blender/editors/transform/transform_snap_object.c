@@ -1233,6 +1233,64 @@ static bool snapEditMesh(
 	return retval;
 }
 
+/**
+ * Cheap world-space rejection of objects whose bounding box can not be hit by the ray,
+ * so that misses in large scenes never pay for the derived-mesh lookup and matrix
+ * inversion done by #snapObject.
+ *
+ * This is a conservative axis-aligned version of the exact local-space test in
+ * #snapDerivedMesh (same minimum-dimension threshold and vert/edge scaling),
+ * so it can only reject objects that test would reject anyway.
+ */
+static bool snapObjectBoundsGet(
+        Object *ob, float obmat[4][4], const short snap_to,
+        float r_bb_min[3], float r_bb_max[3])
+{
+	BoundBox bb_temp, *bb;
+	float co[3];
+	int i;
+
+	/* only mesh snapping performs boundbox checks, and the edit-mesh path has none */
+	if (ob->type != OB_MESH) {
+		return false;
+	}
+
+	bb = BKE_object_boundbox_get(ob);
+	if (bb == NULL) {
+		return false;
+	}
+
+	bb = BKE_boundbox_ensure_minimum_dimensions(bb, &bb_temp, 1e-1f);
+
+	if (ELEM(snap_to, SCE_SNAP_MODE_VERTEX, SCE_SNAP_MODE_EDGE)) {
+		BKE_boundbox_scale(&bb_temp, bb, 1.0f + 1e-1f);
+		bb = &bb_temp;
+	}
+
+	INIT_MINMAX(r_bb_min, r_bb_max);
+	for (i = 0; i < 8; i++) {
+		mul_v3_m4v3(co, obmat, bb->vec[i]);
+		minmax_v3v3_v3(r_bb_min, r_bb_max, co);
+	}
+
+	return true;
+}
+
+static bool snapObjectBoundsCheck(
+        Object *ob, float obmat[4][4], const short snap_to,
+        const float ray_start[3], const float ray_normal[3])
+{
+	struct IsectRayAABB_Precalc isect_precalc;
+	float bb_min[3], bb_max[3], tmin;
+
+	if (!snapObjectBoundsGet(ob, obmat, snap_to, bb_min, bb_max)) {
+		return true;
+	}
+
+	isect_ray_aabb_v3_precalc(&isect_precalc, ray_start, ray_normal);
+	return isect_ray_aabb_v3(&isect_precalc, bb_min, bb_max, &tmin);
+}
+
 static bool snapObject(
         SnapObjectContext *sctx,
         Object *ob, float obmat[4][4], bool use_obedit, const short snap_to,
@@ -1314,6 +1372,52 @@ static bool snapObject(
 	return retval;
 }
 
+/**
+ * Cast a whole packet of rays at a single object.
+ *
+ * The world-space boundbox is computed once for the object and every ray
+ * re-uses its own pre-calculated slab test against it, so per-object setup
+ * (and the BVH build, with #SNAP_OBJECT_USE_CACHE) is shared by all rays.
+ */
+static bool snapObjectRays(
+        SnapObjectContext *sctx,
+        Object *ob, float obmat[4][4], bool use_obedit, const short snap_to,
+        const unsigned int ob_index,
+        struct SnapObjectRay *rays, const struct IsectRayAABB_Precalc *ray_precalc, const int rays_len)
+{
+	bool retval = false;
+	float bb_min[3], bb_max[3];
+	bool has_bounds = false;
+	int i;
+
+	/* the edit-mesh path performs no boundbox culling, see snapObjectsRay */
+	if (!use_obedit) {
+		has_bounds = snapObjectBoundsGet(ob, obmat, snap_to, bb_min, bb_max);
+	}
+
+	for (i = 0; i < rays_len; i++) {
+		struct SnapObjectRay *sray = &rays[i];
+		float tmin;
+
+		if (has_bounds && !isect_ray_aabb_v3(&ray_precalc[i], bb_min, bb_max, &tmin)) {
+			continue;
+		}
+
+		if (snapObject(
+		            sctx, ob, obmat, use_obedit, snap_to,
+		            NULL, NULL, ob_index,
+		            sray->ray_start, sray->ray_normal, sray->ray_start, &sray->ray_depth,
+		            sray->loc, sray->no, &sray->index,
+		            &sray->ob, sray->obmat, NULL))
+		{
+			sray->has_hit = true;
+			retval = true;
+		}
+	}
+
+	return retval;
+}
+
 static bool snapObjectsRay(
         SnapObjectContext *sctx,
         SnapSelect snap_select, const short snap_to,
@@ -1375,6 +1479,13 @@ static bool snapObjectsRay(
 					bool use_obedit_dupli = (obedit && dupli_ob->ob->data == obedit->data);
 					Object *dupli_snap = (use_obedit_dupli) ? obedit : dupli_ob->ob;
 
+					if (!use_obedit_dupli &&
+					    !snapObjectBoundsCheck(dupli_snap, dupli_ob->mat, snap_to, ray_start, ray_normal))
+					{
+						ob_index++;
+						continue;
+					}
+
 					retval |= snapObject(
 					        sctx, dupli_snap, dupli_ob->mat, use_obedit_dupli, snap_to,
 					        mval, dist_px, ob_index++,
@@ -1399,6 +1510,13 @@ static bool snapObjectsRay(
 				}
 			}
 
+			if (!use_obedit &&
+			    !snapObjectBoundsCheck(ob_snap, ob->obmat, snap_to, ray_start, ray_normal))
+			{
+				ob_index++;
+				continue;
+			}
+
 			retval |= snapObject(
 			        sctx, ob_snap, ob->obmat, use_obedit, snap_to,
 			        mval, dist_px, ob_index++,
@@ -1410,6 +1528,90 @@ static bool snapObjectsRay(
 	return retval;
 }
 
+/**
+ * Batched counterpart of #snapObjectsRay: the scene is walked once and every
+ * object is tested against the whole ray packet, so dupli-list creation,
+ * boundbox transforms and BVH builds aren't repeated for every ray.
+ */
+static bool snapObjectsRayBatch(
+        SnapObjectContext *sctx,
+        SnapSelect snap_select, const short snap_to,
+        /* special handling of active and edit objects */
+        Base *base_act, Object *obedit,
+        struct SnapObjectRay *rays, const struct IsectRayAABB_Precalc *ray_precalc, const int rays_len)
+{
+	Base *base;
+	bool retval = false;
+	bool snap_obedit_first = snap_select == SNAP_ALL && obedit;
+	unsigned int ob_index = 0;
+
+	if (snap_obedit_first) {
+		Object *ob = obedit;
+
+		retval |= snapObjectRays(
+		        sctx, ob, ob->obmat, true, snap_to, ob_index++,
+		        rays, ray_precalc, rays_len);
+	}
+
+	/* see snapObjectsRay for the particle edit exception */
+	base = base_act;
+	if (base && base->object && base->object->mode & OB_MODE_PARTICLE_EDIT) {
+		Object *ob = base->object;
+		retval |= snapObjectRays(
+		        sctx, ob, ob->obmat, false, snap_to, ob_index++,
+		        rays, ray_precalc, rays_len);
+	}
+
+	for (base = sctx->scene->base.first; base != NULL; base = base->next) {
+		if ((BASE_VISIBLE_BGMODE(sctx->v3d_data.v3d, sctx->scene, base)) &&
+		    (base->flag & (BA_HAS_RECALC_OB | BA_HAS_RECALC_DATA)) == 0 &&
+
+		    ((snap_select == SNAP_NOT_SELECTED && (base->flag & (SELECT | BA_WAS_SEL)) == 0) ||
+		     (ELEM(snap_select, SNAP_ALL, SNAP_NOT_OBEDIT) && base != base_act)))
+		{
+			Object *ob = base->object;
+			Object *ob_snap = ob;
+			bool use_obedit = false;
+
+			if (ob->transflag & OB_DUPLI) {
+				DupliObject *dupli_ob;
+				ListBase *lb = object_duplilist(sctx->bmain->eval_ctx, sctx->scene, ob);
+
+				for (dupli_ob = lb->first; dupli_ob; dupli_ob = dupli_ob->next) {
+					bool use_obedit_dupli = (obedit && dupli_ob->ob->data == obedit->data);
+					Object *dupli_snap = (use_obedit_dupli) ? obedit : dupli_ob->ob;
+
+					retval |= snapObjectRays(
+					        sctx, dupli_snap, dupli_ob->mat, use_obedit_dupli, snap_to, ob_index++,
+					        rays, ray_precalc, rays_len);
+				}
+
+				free_object_duplilist(lb);
+			}
+
+			if (obedit) {
+				if ((ob == obedit) &&
+				   (snap_obedit_first || (snap_select == SNAP_NOT_OBEDIT)))
+				{
+					continue;
+				}
+
+				if (ob->data == obedit->data) {
+					/* for linked objects, use the same object but a different matrix */
+					use_obedit = true;
+					ob_snap = obedit;
+				}
+			}
+
+			retval |= snapObjectRays(
+			        sctx, ob_snap, ob->obmat, use_obedit, snap_to, ob_index++,
+			        rays, ray_precalc, rays_len);
+		}
+	}
+
+	return retval;
+}
+
 /** \} */
 
 
@@ -1566,6 +1768,54 @@ bool ED_transform_snap_object_project_ray_all(
 	return retval;
 }
 
+/**
+ * Cast a packet of rays into the scene in a single pass over the objects.
+ *
+ * Equivalent to calling #ED_transform_snap_object_project_ray_ex once per ray,
+ * but per-object setup (dupli-lists, boundbox transforms, cached BVH builds)
+ * is shared by the whole packet. Useful when one input event needs several
+ * rays, e.g. depth picking over multiple objects or gizmo hit testing.
+ *
+ * \param rays: Array of rays; results are written back into each element,
+ * a depth of -1.0 means maximum distance.
+ * \return true if any ray in the packet hit something.
+ */
+bool ED_transform_snap_object_project_ray_batch(
+        SnapObjectContext *sctx,
+        const struct SnapObjectParams *params,
+        struct SnapObjectRay *rays, const int rays_len)
+{
+	Base *base_act = params->use_object_active ? sctx->scene->basact : NULL;
+	Object *obedit = params->use_object_edit ? sctx->scene->obedit : NULL;
+	struct IsectRayAABB_Precalc *ray_precalc;
+	bool retval;
+	int i;
+
+	if (rays_len <= 0) {
+		return false;
+	}
+
+	ray_precalc = MEM_mallocN(sizeof(*ray_precalc) * rays_len, __func__);
+
+	for (i = 0; i < rays_len; i++) {
+		if (rays[i].ray_depth == -1.0f) {
+			rays[i].ray_depth = BVH_RAYCAST_DIST_MAX;
+		}
+		rays[i].has_hit = false;
+		isect_ray_aabb_v3_precalc(&ray_precalc[i], rays[i].ray_start, rays[i].ray_normal);
+	}
+
+	retval = snapObjectsRayBatch(
+	        sctx,
+	        params->snap_select, params->snap_to,
+	        base_act, obedit,
+	        rays, ray_precalc, rays_len);
+
+	MEM_freeN(ray_precalc);
+
+	return retval;
+}
+
 /**
  * Convenience function for snap ray-casting.
  *
@@ -38,6 +38,8 @@
 #include "DNA_object_types.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_blender_undo.h"
@@ -94,6 +96,44 @@ typedef struct UndoElem {
 static ListBase undobase = {NULL, NULL};
 static UndoElem *curundo = NULL;
 
+/* Discarded undo data is freed on the task scheduler. A step holding a mesh with
+ * millions of elements takes long enough to free that doing it inline adds real
+ * latency to the operator pushing the new step, and once a step is unlinked from
+ * the stack nothing references its data anymore, so freeing it can safely overlap
+ * with whatever the user does next. */
+static TaskPool *undo_free_pool = NULL;
+
+typedef struct UndoFreeTask {
+	void (*freedata)(void *);
+	void *undodata;
+} UndoFreeTask;
+
+static void undo_free_task_run(TaskPool *__restrict UNUSED(pool), void *taskdata, int UNUSED(threadid))
+{
+	UndoFreeTask *task = taskdata;
+	task->freedata(task->undodata);
+}
+
+static void undo_elem_free_data(UndoElem *uel)
+{
+	UndoFreeTask *task;
+
+	if (uel->undodata == NULL) {
+		return;
+	}
+
+	if (undo_free_pool == NULL) {
+		undo_free_pool = BLI_task_pool_create_background(BLI_task_scheduler_get(), NULL);
+	}
+
+	task = MEM_mallocN(sizeof(*task), "undo free task");
+	task->freedata = uel->freedata;
+	task->undodata = uel->undodata;
+	uel->undodata = NULL;
+
+	BLI_task_pool_push(undo_free_pool, undo_free_task_run, task, true, TASK_PRIORITY_LOW);
+}
+
 
 /* ********************* xtern api calls ************* */
 
@@ -124,7 +164,7 @@ void undo_editmode_push(bContext *C, const char *name,
 	/* remove all undos after (also when curundo == NULL) */
 	while (undobase.last != curundo) {
 		uel = undobase.last;
-		uel->freedata(uel->undodata);
+		undo_elem_free_data(uel);
 		BLI_freelinkN(&undobase, uel);
 	}
 	
@@ -150,7 +190,7 @@ void undo_editmode_push(bContext *C, const char *name,
 	if (uel) {
 		while (undobase.first != uel) {
 			UndoElem *first = undobase.first;
-			first->freedata(first->undodata);
+			undo_elem_free_data(first);
 			BLI_freelinkN(&undobase, first);
 		}
 	}
@@ -182,7 +222,7 @@ void undo_editmode_push(bContext *C, const char *name,
 
 			while (undobase.first != uel) {
 				UndoElem *first = undobase.first;
-				first->freedata(first->undodata);
+				undo_elem_free_data(first);
 				BLI_freelinkN(&undobase, first);
 			}
 		}
@@ -219,7 +259,7 @@ static void undo_clean_stack(bContext *C)
 			if (uel == curundo)
 				curundo = NULL;
 
-			uel->freedata(uel->undodata);
+			undo_elem_free_data(uel);
 			BLI_freelinkN(&undobase, uel);
 		}
 		
@@ -277,14 +317,22 @@ void undo_editmode_step(bContext *C, int step)
 void undo_editmode_clear(void)
 {
 	UndoElem *uel;
-	
+
 	uel = undobase.first;
 	while (uel) {
-		uel->freedata(uel->undodata);
+		undo_elem_free_data(uel);
 		uel = uel->next;
 	}
 	BLI_freelistN(&undobase);
 	curundo = NULL;
+
+	/* Main thread joins in on the pending frees, also ensures nothing is
+	 * still running on exit or when switching to another editmode object. */
+	if (undo_free_pool) {
+		BLI_task_pool_work_and_wait(undo_free_pool);
+		BLI_task_pool_free(undo_free_pool);
+		undo_free_pool = NULL;
+	}
 }
 
 /* based on index nr it does a restore */
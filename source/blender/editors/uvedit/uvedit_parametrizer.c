@@ -34,6 +34,7 @@
 #include "BLI_heap.h"
 #include "BLI_boxpack2d.h"
 #include "BLI_convexhull2d.h"
+#include "BLI_task.h"
 
 #include "uvedit_parametrizer.h"
 
@@ -4312,44 +4313,66 @@ void param_construct_end(ParamHandle *handle, ParamBool fill, ParamBool impl)
 	phandle->state = PHANDLE_STATE_CONSTRUCTED;
 }
 
+typedef struct PLscmBeginTaskData {
+	PHandle *phandle;
+	PBool live, abf;
+} PLscmBeginTaskData;
+
+/* charts are fully independent of each other and each has its own solver
+ * context, so both setup (including the abf solve) and the lscm solve run
+ * one chart per task */
+static void p_chart_lscm_begin_task_cb(void *userdata, const int i)
+{
+	PLscmBeginTaskData *data = userdata;
+	PChart *chart = data->phandle->charts[i];
+	PFace *f;
+
+	for (f = chart->faces; f; f = f->nextlink)
+		p_face_backup_uvs(f);
+	p_chart_lscm_begin(chart, data->live, data->abf);
+}
+
+static void p_chart_lscm_solve_task_cb(void *userdata, const int i)
+{
+	PHandle *phandle = userdata;
+	PChart *chart = phandle->charts[i];
+	PBool result;
+
+	if (chart->u.lscm.context) {
+		result = p_chart_lscm_solve(phandle, chart);
+
+		if (result && !(chart->flag & PCHART_NOPACK))
+			p_chart_rotate_minimum_area(chart);
+
+		if (!result || (chart->u.lscm.pin1))
+			p_chart_lscm_end(chart);
+	}
+}
+
 void param_lscm_begin(ParamHandle *handle, ParamBool live, ParamBool abf)
 {
 	PHandle *phandle = (PHandle *)handle;
-	PFace *f;
-	int i;
+	PLscmBeginTaskData data;
 
 	param_assert(phandle->state == PHANDLE_STATE_CONSTRUCTED);
 	phandle->state = PHANDLE_STATE_LSCM;
 
-	for (i = 0; i < phandle->ncharts; i++) {
-		for (f = phandle->charts[i]->faces; f; f = f->nextlink)
-			p_face_backup_uvs(f);
-		p_chart_lscm_begin(phandle->charts[i], (PBool)live, (PBool)abf);
-	}
+	data.phandle = phandle;
+	data.live = (PBool)live;
+	data.abf = (PBool)abf;
+
+	BLI_task_parallel_range(0, phandle->ncharts, &data, p_chart_lscm_begin_task_cb,
+	                        (phandle->ncharts > 1));
 }
 
 void param_lscm_solve(ParamHandle *handle)
 {
 	PHandle *phandle = (PHandle *)handle;
-	PChart *chart;
-	int i;
-	PBool result;
 
 	param_assert(phandle->state == PHANDLE_STATE_LSCM);
 
-	for (i = 0; i < phandle->ncharts; i++) {
-		chart = phandle->charts[i];
-
-		if (chart->u.lscm.context) {
-			result = p_chart_lscm_solve(phandle, chart);
-
-			if (result && !(chart->flag & PCHART_NOPACK))
-				p_chart_rotate_minimum_area(chart);
-
-			if (!result || (chart->u.lscm.pin1))
-				p_chart_lscm_end(chart);
-		}
-	}
+	BLI_task_parallel_range(0, phandle->ncharts, phandle, p_chart_lscm_solve_task_cb,
+	                        (phandle->ncharts > 1));
 }
 
 void param_lscm_end(ParamHandle *handle)
@@ -263,9 +263,7 @@ public:
 #endif
 	                real epsilon)
 	{
-		real t, u;
-		Point CP;
-		Vec2r v0, v1, v2, v3;
+		Vec2r v0, v1;
 		if (true == S->order()) {
 			v0[0] = ((*S)[0])[0];
 			v0[1] = ((*S)[0])[1];
@@ -278,8 +276,21 @@ public:
 			v0[0] = ((*S)[1])[0];
 			v0[1] = ((*S)[1])[1];
 		}
-		for (typename std::list<Segment<T, Point> *>::iterator s = _set.begin(), send = _set.end(); s != send; s++) {
-			Segment<T, Point> *currentS = (*s);
+		// the intersection tests against the active segments are independent of
+		// each other, run them in parallel and record the results afterwards so
+		// the intersections are created in the same order as the sequential scan
+		std::vector<Segment<T, Point> *> active(_set.begin(), _set.end());
+		const int activeSize = (int)active.size();
+		std::vector<real> ts(activeSize), us(activeSize);
+		std::vector<char> hit(activeSize, 0);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64) if (activeSize > 256)
+#endif
+		for (int i = 0; i < activeSize; i++) {
+			Segment<T, Point> *currentS = active[i];
+			real t, u;
+			Point CP;
+			Vec2r v2, v3;
 			if (true != binrule(*S, *currentS))
 				continue;
 
@@ -299,16 +310,24 @@ public:
 				continue; // the two edges have a common vertex->no need to check
 
 			if (GeomUtils::intersect2dSeg2dSegParametric(v0, v1, v2, v3, t, u, epsilon) == GeomUtils::DO_INTERSECT) {
-				// create the intersection
-				Intersection<Segment<T, Point> > *inter = new Intersection<Segment<T, Point> >(S, t, currentS, u);
-				// add it to the intersections list
-				_Intersections.push_back(inter);
-				// add this intersection to the first edge intersections list
-				S->AddIntersection(inter);
-				// add this intersection to the second edge intersections list
-				currentS->AddIntersection(inter);
+				ts[i] = t;
+				us[i] = u;
+				hit[i] = 1;
 			}
 		}
+		for (int i = 0; i < activeSize; i++) {
+			if (!hit[i])
+				continue;
+			Segment<T, Point> *currentS = active[i];
+			// create the intersection
+			Intersection<Segment<T, Point> > *inter = new Intersection<Segment<T, Point> >(S, ts[i], currentS, us[i]);
+			// add it to the intersections list
+			_Intersections.push_back(inter);
+			// add this intersection to the first edge intersections list
+			S->AddIntersection(inter);
+			// add this intersection to the second edge intersections list
+			currentS->AddIntersection(inter);
+		}
 		// add the added segment to the list of active segments
 		_set.push_back(S);
 	}
@@ -128,10 +128,12 @@ void FEdgeXDetector::preProcessShape(WXShape *iWShape)
 #endif
 
 	vector<WFace*>& wfaces = iWShape->GetFaceList();
-	vector<WFace*>::iterator f, fend;
-	// view dependant stuff
-	for (f = wfaces.begin(), fend = wfaces.end(); f != fend; ++f) {
-		preProcessFace((WXFace *)(*f));
+	// view dependant stuff, each face is processed independently
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+	for (int i = 0; i < (int)wfaces.size(); i++) {
+		preProcessFace((WXFace *)wfaces[i]);
 	}
 
 	if (_computeRidgesAndValleys || _computeSuggestiveContours) {
@@ -256,10 +258,13 @@ void FEdgeXDetector::computeCurvatures(WXVertex *vertex)
 void FEdgeXDetector::processSilhouetteShape(WXShape *iWShape)
 {
 	// Make a first pass on every polygons in order to compute all their silhouette relative values:
+	// (each face only writes its own layers, so the faces can be done in parallel)
 	vector<WFace*>& wfaces = iWShape->GetFaceList();
-	vector<WFace*>::iterator f, fend;
-	for (f = wfaces.begin(), fend = wfaces.end(); f != fend; ++f) {
-		ProcessSilhouetteFace((WXFace *)(*f));
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+	for (int i = 0; i < (int)wfaces.size(); i++) {
+		ProcessSilhouetteFace((WXFace *)wfaces[i]);
 	}
 
 	// Make a pass on the edges to detect the silhouette edges that are not smooth
@@ -52,9 +52,20 @@ struct GPUDrawObject;
 struct PBVH;
 struct MVert;
 
+/* number of regions a persistent mapped streaming buffer cycles through,
+ * enough to never stall on the gpu reading the previous frame */
+#define GPU_BUFFER_STREAM_REGIONS 3
+
 typedef struct GPUBuffer {
 	size_t size;        /* in bytes */
 	unsigned int id; /* used with vertex buffer objects */
+
+	/* persistent mapped streaming (GL_ARB_buffer_storage); the GL buffer then
+	 * holds GPU_BUFFER_STREAM_REGIONS regions of size bytes each and
+	 * GPU_buffer_lock_stream rotates through them instead of orphaning */
+	void *persistent_map;
+	size_t stream_offset;  /* byte offset of the region currently written/drawn */
+	void *stream_fences[GPU_BUFFER_STREAM_REGIONS];  /* GLsync per region */
 } GPUBuffer;
 
 typedef struct GPUBufferMaterial {
@@ -155,6 +166,7 @@ void GPU_global_buffer_pool_free(void);
 void GPU_global_buffer_pool_free_unused(void);
 
 GPUBuffer *GPU_buffer_alloc(size_t size);
+GPUBuffer *GPU_buffer_alloc_stream(size_t size);
 void GPU_buffer_free(GPUBuffer *buffer);
 
 void GPU_drawobject_free(struct DerivedMesh *dm);
@@ -250,6 +262,23 @@ void GPU_update_grid_pbvh_buffers(GPU_PBVH_Buffers *buffers, struct CCGElem **gr
                              int *grid_indices, int totgrid, const struct CCGKey *key,
                              bool show_diffuse_color);
 
+/* split variants of the mesh/grid updates above; _begin maps the buffer on
+ * the main thread, _fill may then run in a worker thread, _end unmaps again */
+
+void *GPU_update_mesh_pbvh_buffers_begin(
+        GPU_PBVH_Buffers *buffers, const struct MVert *mvert,
+        const int *vert_indices, int totvert, const float *vmask,
+        const int (*face_vert_indices)[4], bool show_diffuse_color);
+void GPU_update_mesh_pbvh_buffers_fill(GPU_PBVH_Buffers *buffers);
+
+void *GPU_update_grid_pbvh_buffers_begin(
+        GPU_PBVH_Buffers *buffers, struct CCGElem **grids,
+        const struct DMFlagMat *grid_flag_mats, int *grid_indices,
+        int totgrid, const struct CCGKey *key, bool show_diffuse_color);
+void GPU_update_grid_pbvh_buffers_fill(GPU_PBVH_Buffers *buffers);
+
+void GPU_update_pbvh_buffers_end(GPU_PBVH_Buffers *buffers);
+
 /* draw */
 void GPU_draw_pbvh_buffers(GPU_PBVH_Buffers *buffers, DMSetMaterial setMaterial,
                            bool wireframe, bool fast);
@@ -332,6 +332,35 @@ static GPUBuffer *gpu_buffer_alloc_intern(size_t size)
 	return buf;
 }
 
+/* streaming buffer with a persistent mapping when the hardware supports it,
+ * GPU_buffer_lock_stream then rotates through GPU_BUFFER_STREAM_REGIONS
+ * regions instead of orphaning and re-mapping every update
+ *
+ * these bypass the buffer pool (their storage is immutable and couldn't be
+ * re-specified for another user) and must be freed from the main thread */
+static GPUBuffer *gpu_buffer_alloc_persistent(size_t size)
+{
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	GPUBuffer *buf = MEM_callocN(sizeof(GPUBuffer), "GPUBuffer.persistent");
+
+	buf->size = size;
+
+	glGenBuffers(1, &buf->id);
+	glBindBuffer(GL_ARRAY_BUFFER, buf->id);
+	glBufferStorage(GL_ARRAY_BUFFER, size * GPU_BUFFER_STREAM_REGIONS, NULL, flags);
+	buf->persistent_map = glMapBufferRange(GL_ARRAY_BUFFER, 0,
+	                                       size * GPU_BUFFER_STREAM_REGIONS, flags);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	if (!buf->persistent_map) {
+		glDeleteBuffers(1, &buf->id);
+		MEM_freeN(buf);
+		return NULL;
+	}
+
+	return buf;
+}
+
 /* Same as above, but safe for threading. */
 GPUBuffer *GPU_buffer_alloc(size_t size)
 {
@@ -349,6 +378,25 @@ GPUBuffer *GPU_buffer_alloc(size_t size)
 	return buffer;
 }
 
+/* allocate a buffer for repeated streaming updates; prefers a persistent
+ * mapped triple-buffer, falls back to a regular pooled buffer on hardware
+ * without GL_ARB_buffer_storage */
+GPUBuffer *GPU_buffer_alloc_stream(size_t size)
+{
+	if (size == 0) {
+		return NULL;
+	}
+
+	if (GLEW_ARB_buffer_storage) {
+		GPUBuffer *buffer = gpu_buffer_alloc_persistent(size);
+		if (buffer) {
+			return buffer;
+		}
+	}
+
+	return GPU_buffer_alloc(size);
+}
+
 /* release a GPUBuffer; does not free the actual buffer or its data,
  * but rather moves it to the pool of recently-freed buffers for
  * possible re-use
@@ -402,6 +450,26 @@ void GPU_buffer_free(GPUBuffer *buffer)
 		return;
 	}
 
+	if (buffer->persistent_map) {
+		/* persistent buffers have immutable storage and can't go back into
+		 * the pool, delete them right away (their only users, the sculpt
+		 * streaming buffers, free from the main thread) */
+		int i;
+
+		for (i = 0; i < GPU_BUFFER_STREAM_REGIONS; i++) {
+			if (buffer->stream_fences[i]) {
+				glDeleteSync((GLsync)buffer->stream_fences[i]);
+			}
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, buffer->id);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glDeleteBuffers(1, &buffer->id);
+		MEM_freeN(buffer);
+		return;
+	}
+
 	BLI_mutex_lock(&buffer_mutex);
 	gpu_buffer_free_intern(buffer);
 	BLI_mutex_unlock(&buffer_mutex);
@@ -911,6 +979,10 @@ void *GPU_buffer_lock(GPUBuffer *buffer, GPUBindingType binding)
 	if (!buffer)
 		return 0;
 
+	/* persistent buffers can't be mapped again, rotate a region instead */
+	if (buffer->persistent_map)
+		return GPU_buffer_lock_stream(buffer, binding);
+
 	bindtypegl = gpu_binding_type_gl[binding];
 	glBindBuffer(bindtypegl, buffer->id);
 	varray = glMapBuffer(bindtypegl, GL_WRITE_ONLY);
@@ -927,18 +999,47 @@ void *GPU_buffer_lock_stream(GPUBuffer *buffer, GPUBindingType binding)
 
 	bindtypegl = gpu_binding_type_gl[binding];
 	glBindBuffer(bindtypegl, buffer->id);
+
+	if (buffer->persistent_map) {
+		int region = (int)(buffer->stream_offset / buffer->size);
+
+		/* all draws reading the region written last update have been issued
+		 * by now, fence them before rotating to the oldest region */
+		if (buffer->stream_fences[region]) {
+			glDeleteSync((GLsync)buffer->stream_fences[region]);
+		}
+		buffer->stream_fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+		region = (region + 1) % GPU_BUFFER_STREAM_REGIONS;
+		buffer->stream_offset = (size_t)region * buffer->size;
+
+		/* with three regions in flight this wait almost never blocks */
+		if (buffer->stream_fences[region]) {
+			glClientWaitSync((GLsync)buffer->stream_fences[region],
+			                 GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+			glDeleteSync((GLsync)buffer->stream_fences[region]);
+			buffer->stream_fences[region] = NULL;
+		}
+
+		return (char *)buffer->persistent_map + buffer->stream_offset;
+	}
+
 	/* discard previous data, avoid stalling gpu */
 	glBufferData(bindtypegl, buffer->size, 0, GL_STREAM_DRAW);
 	varray = glMapBuffer(bindtypegl, GL_WRITE_ONLY);
 	return varray;
 }
 
-void GPU_buffer_unlock(GPUBuffer *UNUSED(buffer), GPUBindingType binding)
+void GPU_buffer_unlock(GPUBuffer *buffer, GPUBindingType binding)
 {
 	int bindtypegl = gpu_binding_type_gl[binding];
-	/* note: this operation can fail, could return
+
+	/* persistent mappings stay mapped, writes are coherent */
+	if (!(buffer && buffer->persistent_map)) {
+		/* note: this operation can fail, could return
 		 * an error code from this function? */
-	glUnmapBuffer(bindtypegl);
+		glUnmapBuffer(bindtypegl);
+	}
 	glBindBuffer(bindtypegl, 0);
 }
 
@@ -1015,6 +1116,13 @@ struct GPU_PBVH_Buffers {
 	bool show_diffuse_color;
 	bool use_matcaps;
 	float diffuse_color[4];
+
+	/* state for the split update functions; the mapped vertex memory between
+	 * a _begin and GPU_update_pbvh_buffers_end call, NULL when mapping failed */
+	void *vert_data_mapped;
+	const int (*face_vert_indices)[4];
+	const int *vert_indices;
+	int totvert;
 };
 
 static float gpu_color_from_mask(float mask)
@@ -1050,134 +1158,172 @@ static void gpu_color_from_mask_quad_copy(const CCGKey *key,
 	out[2] = diffuse_color[2] * mask_color;
 }
 
-void GPU_update_mesh_pbvh_buffers(
+/* Draw buffer updates are split in three stages so the expensive vertex data
+ * fill can run in worker threads: the _begin functions do the GL buffer
+ * allocation and mapping and must run on the main thread, the _fill functions
+ * only write into the mapped memory and are safe to call from another thread,
+ * and GPU_update_pbvh_buffers_end unmaps on the main thread again. */
+
+void *GPU_update_mesh_pbvh_buffers_begin(
         GPU_PBVH_Buffers *buffers, const MVert *mvert,
         const int *vert_indices, int totvert, const float *vmask,
         const int (*face_vert_indices)[4], bool show_diffuse_color)
 {
-	VertexBufferFormat *vert_data;
-	int i, j;
+	int totelem;
+	float diffuse_color[4] = {0.8f, 0.8f, 0.8f, 0.8f};
 
 	buffers->vmask = vmask;
 	buffers->show_diffuse_color = show_diffuse_color;
 	buffers->use_matcaps = GPU_material_use_matcaps_get();
+	buffers->mvert = mvert;
+	buffers->vert_indices = vert_indices;
+	buffers->totvert = totvert;
+	buffers->face_vert_indices = face_vert_indices;
 
-	{
-		int totelem = (buffers->smooth ? totvert : (buffers->tot_tri * 3));
-		float diffuse_color[4] = {0.8f, 0.8f, 0.8f, 0.8f};
+	totelem = (buffers->smooth ? totvert : (buffers->tot_tri * 3));
 
-		if (buffers->use_matcaps)
-			diffuse_color[0] = diffuse_color[1] = diffuse_color[2] = 1.0;
-		else if (show_diffuse_color) {
-			const MLoopTri *lt = &buffers->looptri[buffers->face_indices[0]];
-			const MPoly *mp = &buffers->mpoly[lt->poly];
+	if (buffers->use_matcaps)
+		diffuse_color[0] = diffuse_color[1] = diffuse_color[2] = 1.0;
+	else if (show_diffuse_color) {
+		const MLoopTri *lt = &buffers->looptri[buffers->face_indices[0]];
+		const MPoly *mp = &buffers->mpoly[lt->poly];
 
-			GPU_material_diffuse_get(mp->mat_nr + 1, diffuse_color);
-		}
+		GPU_material_diffuse_get(mp->mat_nr + 1, diffuse_color);
+	}
 
-		copy_v4_v4(buffers->diffuse_color, diffuse_color);
+	copy_v4_v4(buffers->diffuse_color, diffuse_color);
 
-		/* Build VBO */
-		if (buffers->vert_buf)
-			GPU_buffer_free(buffers->vert_buf);
-		buffers->vert_buf = GPU_buffer_alloc(sizeof(VertexBufferFormat) * totelem);
-		vert_data = GPU_buffer_lock(buffers->vert_buf, GPU_BINDING_ARRAY);
-
-		if (vert_data) {
-			/* Vertex data is shared if smooth-shaded, but separate
-			 * copies are made for flat shading because normals
-			 * shouldn't be shared. */
-			if (buffers->smooth) {
-				for (i = 0; i < totvert; ++i) {
-					const MVert *v = &mvert[vert_indices[i]];
-					VertexBufferFormat *out = vert_data + i;
-
-					copy_v3_v3(out->co, v->co);
-					memcpy(out->no, v->no, sizeof(short) * 3);
-				}
+	/* Build VBO */
+	if (buffers->vert_buf)
+		GPU_buffer_free(buffers->vert_buf);
+	buffers->vert_buf = GPU_buffer_alloc(sizeof(VertexBufferFormat) * totelem);
+	buffers->vert_data_mapped = GPU_buffer_lock(buffers->vert_buf, GPU_BINDING_ARRAY);
 
-#define UPDATE_VERTEX(face, vertex, index, diffuse_color) \
-				{ \
-					VertexBufferFormat *out = vert_data + face_vert_indices[face][index]; \
-					if (vmask) \
-						gpu_color_from_mask_copy(vmask[vertex], diffuse_color, out->color); \
-					else \
-						rgb_float_to_uchar(out->color, diffuse_color); \
-				} (void)0
-
-				for (i = 0; i < buffers->face_indices_len; i++) {
-					const MLoopTri *lt = &buffers->looptri[buffers->face_indices[i]];
-					const unsigned int vtri[3] = {
-					    buffers->mloop[lt->tri[0]].v,
-					    buffers->mloop[lt->tri[1]].v,
-					    buffers->mloop[lt->tri[2]].v,
-					};
+	if (!buffers->vert_data_mapped) {
+		GPU_buffer_free(buffers->vert_buf);
+		buffers->vert_buf = NULL;
+	}
 
-					UPDATE_VERTEX(i, vtri[0], 0, diffuse_color);
-					UPDATE_VERTEX(i, vtri[1], 1, diffuse_color);
-					UPDATE_VERTEX(i, vtri[2], 2, diffuse_color);
-				}
-#undef UPDATE_VERTEX
-			}
-			else {
-				/* calculate normal for each polygon only once */
-				unsigned int mpoly_prev = UINT_MAX;
-				short no[3];
-
-				for (i = 0; i < buffers->face_indices_len; ++i) {
-					const MLoopTri *lt = &buffers->looptri[buffers->face_indices[i]];
-					const unsigned int vtri[3] = {
-					    buffers->mloop[lt->tri[0]].v,
-					    buffers->mloop[lt->tri[1]].v,
-					    buffers->mloop[lt->tri[2]].v,
-					};
+	return buffers->vert_data_mapped;
+}
 
-					float fmask;
+void GPU_update_mesh_pbvh_buffers_fill(GPU_PBVH_Buffers *buffers)
+{
+	VertexBufferFormat *vert_data = buffers->vert_data_mapped;
+	const MVert *mvert = buffers->mvert;
+	const int *vert_indices = buffers->vert_indices;
+	const int totvert = buffers->totvert;
+	const float *vmask = buffers->vmask;
+	const int (*face_vert_indices)[4] = buffers->face_vert_indices;
+	const float *diffuse_color = buffers->diffuse_color;
+	int i, j;
 
-					if (paint_is_face_hidden(lt, mvert, buffers->mloop))
-						continue;
+	if (!vert_data)
+		return;
 
-					/* Face normal and mask */
-					if (lt->poly != mpoly_prev) {
-						const MPoly *mp = &buffers->mpoly[lt->poly];
-						float fno[3];
-						BKE_mesh_calc_poly_normal(mp, &buffers->mloop[mp->loopstart], mvert, fno);
-						normal_float_to_short_v3(no, fno);
-						mpoly_prev = lt->poly;
-					}
+	/* Vertex data is shared if smooth-shaded, but separate
+	 * copies are made for flat shading because normals
+	 * shouldn't be shared. */
+	if (buffers->smooth) {
+		for (i = 0; i < totvert; ++i) {
+			const MVert *v = &mvert[vert_indices[i]];
+			VertexBufferFormat *out = vert_data + i;
 
-					if (vmask) {
-						fmask = (vmask[vtri[0]] +
-						         vmask[vtri[1]] +
-						         vmask[vtri[2]]) / 3.0f;
-					}
+			copy_v3_v3(out->co, v->co);
+			memcpy(out->no, v->no, sizeof(short) * 3);
+		}
 
-					for (j = 0; j < 3; j++) {
-						const MVert *v = &mvert[vtri[j]];
-						VertexBufferFormat *out = vert_data;
+#define UPDATE_VERTEX(face, vertex, index, diffuse_color) \
+		{ \
+			VertexBufferFormat *out = vert_data + face_vert_indices[face][index]; \
+			if (vmask) \
+				gpu_color_from_mask_copy(vmask[vertex], diffuse_color, out->color); \
+			else \
+				rgb_float_to_uchar(out->color, diffuse_color); \
+		} (void)0
+
+		for (i = 0; i < buffers->face_indices_len; i++) {
+			const MLoopTri *lt = &buffers->looptri[buffers->face_indices[i]];
+			const unsigned int vtri[3] = {
+			    buffers->mloop[lt->tri[0]].v,
+			    buffers->mloop[lt->tri[1]].v,
+			    buffers->mloop[lt->tri[2]].v,
+			};
+
+			UPDATE_VERTEX(i, vtri[0], 0, diffuse_color);
+			UPDATE_VERTEX(i, vtri[1], 1, diffuse_color);
+			UPDATE_VERTEX(i, vtri[2], 2, diffuse_color);
+		}
+#undef UPDATE_VERTEX
+	}
+	else {
+		/* calculate normal for each polygon only once */
+		unsigned int mpoly_prev = UINT_MAX;
+		short no[3];
+
+		for (i = 0; i < buffers->face_indices_len; ++i) {
+			const MLoopTri *lt = &buffers->looptri[buffers->face_indices[i]];
+			const unsigned int vtri[3] = {
+			    buffers->mloop[lt->tri[0]].v,
+			    buffers->mloop[lt->tri[1]].v,
+			    buffers->mloop[lt->tri[2]].v,
+			};
+
+			float fmask;
+
+			if (paint_is_face_hidden(lt, mvert, buffers->mloop))
+				continue;
+
+			/* Face normal and mask */
+			if (lt->poly != mpoly_prev) {
+				const MPoly *mp = &buffers->mpoly[lt->poly];
+				float fno[3];
+				BKE_mesh_calc_poly_normal(mp, &buffers->mloop[mp->loopstart], mvert, fno);
+				normal_float_to_short_v3(no, fno);
+				mpoly_prev = lt->poly;
+			}
 
-						copy_v3_v3(out->co, v->co);
-						copy_v3_v3_short(out->no, no);
+			if (vmask) {
+				fmask = (vmask[vtri[0]] +
+				         vmask[vtri[1]] +
+				         vmask[vtri[2]]) / 3.0f;
+			}
 
-						if (vmask)
-							gpu_color_from_mask_copy(fmask, diffuse_color, out->color);
-						else
-							rgb_float_to_uchar(out->color, diffuse_color);
+			for (j = 0; j < 3; j++) {
+				const MVert *v = &mvert[vtri[j]];
+				VertexBufferFormat *out = vert_data;
 
-						vert_data++;
-					}
-				}
-			}
+				copy_v3_v3(out->co, v->co);
+				copy_v3_v3_short(out->no, no);
 
-			GPU_buffer_unlock(buffers->vert_buf, GPU_BINDING_ARRAY);
-		}
-		else {
-			GPU_buffer_free(buffers->vert_buf);
-			buffers->vert_buf = NULL;
+				if (vmask)
+					gpu_color_from_mask_copy(fmask, diffuse_color, out->color);
+				else
+					rgb_float_to_uchar(out->color, diffuse_color);
+
+				vert_data++;
+			}
 		}
 	}
+}
 
-	buffers->mvert = mvert;
+void GPU_update_pbvh_buffers_end(GPU_PBVH_Buffers *buffers)
+{
+	if (buffers->vert_data_mapped) {
+		GPU_buffer_unlock(buffers->vert_buf, GPU_BINDING_ARRAY);
+		buffers->vert_data_mapped = NULL;
+	}
+}
+
+void GPU_update_mesh_pbvh_buffers(
+        GPU_PBVH_Buffers *buffers, const MVert *mvert,
+        const int *vert_indices, int totvert, const float *vmask,
+        const int (*face_vert_indices)[4], bool show_diffuse_color)
+{
+	GPU_update_mesh_pbvh_buffers_begin(buffers, mvert, vert_indices, totvert, vmask,
+	                                   face_vert_indices, show_diffuse_color);
+	GPU_update_mesh_pbvh_buffers_fill(buffers);
+	GPU_update_pbvh_buffers_end(buffers);
 }
 
 GPU_PBVH_Buffers *GPU_build_mesh_pbvh_buffers(
@@ -1259,20 +1405,25 @@ GPU_PBVH_Buffers *GPU_build_mesh_pbvh_buffers(
 	return buffers;
 }
 
-void GPU_update_grid_pbvh_buffers(GPU_PBVH_Buffers *buffers, CCGElem **grids,
-                                  const DMFlagMat *grid_flag_mats, int *grid_indices,
-                                  int totgrid, const CCGKey *key, bool show_diffuse_color)
+void *GPU_update_grid_pbvh_buffers_begin(
+        GPU_PBVH_Buffers *buffers, CCGElem **grids,
+        const DMFlagMat *grid_flag_mats, int *grid_indices,
+        int totgrid, const CCGKey *key, bool show_diffuse_color)
 {
-	VertexBufferFormat *vert_data;
-	int i, j, k, x, y;
-
 	buffers->show_diffuse_color = show_diffuse_color;
 	buffers->use_matcaps = GPU_material_use_matcaps_get();
 	buffers->smooth = grid_flag_mats[grid_indices[0]].flag & ME_SMOOTH;
 
+	buffers->grids = grids;
+	buffers->grid_indices = grid_indices;
+	buffers->totgrid = totgrid;
+	buffers->grid_flag_mats = grid_flag_mats;
+	buffers->gridkey = *key;
+
+	buffers->vert_data_mapped = NULL;
+
 	/* Build VBO */
 	if (buffers->vert_buf) {
-		const int has_mask = key->has_mask;
 		float diffuse_color[4] = {0.8f, 0.8f, 0.8f, 1.0f};
 
 		if (buffers->use_matcaps)
@@ -1285,81 +1436,99 @@ void GPU_update_grid_pbvh_buffers(GPU_PBVH_Buffers *buffers, CCGElem **grids,
 
 		copy_v4_v4(buffers->diffuse_color, diffuse_color);
 
-		vert_data = GPU_buffer_lock_stream(buffers->vert_buf, GPU_BINDING_ARRAY);
-		if (vert_data) {
-			for (i = 0; i < totgrid; ++i) {
-				VertexBufferFormat *vd = vert_data;
-				CCGElem *grid = grids[grid_indices[i]];
-
-				for (y = 0; y < key->grid_size; y++) {
-					for (x = 0; x < key->grid_size; x++) {
-						CCGElem *elem = CCG_grid_elem(key, grid, x, y);
-						
-						copy_v3_v3(vd->co, CCG_elem_co(key, elem));
-						if (buffers->smooth) {
-							normal_float_to_short_v3(vd->no, CCG_elem_no(key, elem));
-
-							if (has_mask) {
-								gpu_color_from_mask_copy(*CCG_elem_mask(key, elem),
-								                         diffuse_color, vd->color);
-							}
-						}
-						vd++;
-					}
-				}
+		buffers->vert_data_mapped = GPU_buffer_lock_stream(buffers->vert_buf, GPU_BINDING_ARRAY);
+
+		if (!buffers->vert_data_mapped) {
+			GPU_buffer_free(buffers->vert_buf);
+			buffers->vert_buf = NULL;
+		}
+	}
+
+	return buffers->vert_data_mapped;
+}
+
+void GPU_update_grid_pbvh_buffers_fill(GPU_PBVH_Buffers *buffers)
+{
+	VertexBufferFormat *vert_data = buffers->vert_data_mapped;
+	CCGElem **grids = buffers->grids;
+	const int *grid_indices = buffers->grid_indices;
+	const CCGKey *key = &buffers->gridkey;
+	const int has_mask = key->has_mask;
+	const float *diffuse_color = buffers->diffuse_color;
+	int i, j, k, x, y;
+
+	if (!vert_data)
+		return;
+
+	for (i = 0; i < buffers->totgrid; ++i) {
+		VertexBufferFormat *vd = vert_data;
+		CCGElem *grid = grids[grid_indices[i]];
+
+		for (y = 0; y < key->grid_size; y++) {
+			for (x = 0; x < key->grid_size; x++) {
+				CCGElem *elem = CCG_grid_elem(key, grid, x, y);
 				
-				if (!buffers->smooth) {
-					/* for flat shading, recalc normals and set the last vertex of
-					 * each triangle in the index buffer to have the flat normal as
-					 * that is what opengl will use */
-					for (j = 0; j < key->grid_size - 1; j++) {
-						for (k = 0; k < key->grid_size - 1; k++) {
-							CCGElem *elems[4] = {
-								CCG_grid_elem(key, grid, k, j + 1),
-								CCG_grid_elem(key, grid, k + 1, j + 1),
-								CCG_grid_elem(key, grid, k + 1, j),
-								CCG_grid_elem(key, grid, k, j)
-							};
-							float fno[3];
-
-							normal_quad_v3(fno,
-							               CCG_elem_co(key, elems[0]),
-							               CCG_elem_co(key, elems[1]),
-							               CCG_elem_co(key, elems[2]),
-							               CCG_elem_co(key, elems[3]));
-
-							vd = vert_data + (j + 1) * key->grid_size + k;
-							normal_float_to_short_v3(vd->no, fno);
-
-							if (has_mask) {
-								gpu_color_from_mask_quad_copy(key,
-								                              elems[0],
-								                              elems[1],
-								                              elems[2],
-								                              elems[3],
-								                              diffuse_color,
-								                              vd->color);
-							}
-						}
+				copy_v3_v3(vd->co, CCG_elem_co(key, elem));
+				if (buffers->smooth) {
+					normal_float_to_short_v3(vd->no, CCG_elem_no(key, elem));
+
+					if (has_mask) {
+						gpu_color_from_mask_copy(*CCG_elem_mask(key, elem),
+						                         diffuse_color, vd->color);
 					}
 				}
-
-				vert_data += key->grid_area;
+				vd++;
 			}
-
-			GPU_buffer_unlock(buffers->vert_buf, GPU_BINDING_ARRAY);
 		}
-		else {
-			GPU_buffer_free(buffers->vert_buf);
-			buffers->vert_buf = NULL;
+		
+		if (!buffers->smooth) {
+			/* for flat shading, recalc normals and set the last vertex of
+			 * each triangle in the index buffer to have the flat normal as
+			 * that is what opengl will use */
+			for (j = 0; j < key->grid_size - 1; j++) {
+				for (k = 0; k < key->grid_size - 1; k++) {
+					CCGElem *elems[4] = {
+						CCG_grid_elem(key, grid, k, j + 1),
+						CCG_grid_elem(key, grid, k + 1, j + 1),
+						CCG_grid_elem(key, grid, k + 1, j),
+						CCG_grid_elem(key, grid, k, j)
+					};
+					float fno[3];
+
+					normal_quad_v3(fno,
+					               CCG_elem_co(key, elems[0]),
+					               CCG_elem_co(key, elems[1]),
+					               CCG_elem_co(key, elems[2]),
+					               CCG_elem_co(key, elems[3]));
+
+					vd = vert_data + (j + 1) * key->grid_size + k;
+					normal_float_to_short_v3(vd->no, fno);
+
+					if (has_mask) {
+						gpu_color_from_mask_quad_copy(key,
+						                              elems[0],
+						                              elems[1],
+						                              elems[2],
+						                              elems[3],
+						                              diffuse_color,
+						                              vd->color);
+					}
+				}
+			}
 		}
+
+		vert_data += key->grid_area;
 	}
+}
 
-	buffers->grids = grids;
-	buffers->grid_indices = grid_indices;
-	buffers->totgrid = totgrid;
-	buffers->grid_flag_mats = grid_flag_mats;
-	buffers->gridkey = *key;
+void GPU_update_grid_pbvh_buffers(GPU_PBVH_Buffers *buffers, CCGElem **grids,
+                                  const DMFlagMat *grid_flag_mats, int *grid_indices,
+                                  int totgrid, const CCGKey *key, bool show_diffuse_color)
+{
+	GPU_update_grid_pbvh_buffers_begin(buffers, grids, grid_flag_mats, grid_indices,
+	                                   totgrid, key, show_diffuse_color);
+	GPU_update_grid_pbvh_buffers_fill(buffers);
+	GPU_update_pbvh_buffers_end(buffers);
 
 	//printf("node updated %p\n", buffers);
 }
@@ -1520,7 +1689,7 @@ GPU_PBVH_Buffers *GPU_build_grid_pbvh_buffers(int *grid_indices, int totgrid,
 
 	/* Build coord/normal VBO */
 	if (buffers->index_buf)
-		buffers->vert_buf = GPU_buffer_alloc(sizeof(VertexBufferFormat) * totgrid * key->grid_area);
+		buffers->vert_buf = GPU_buffer_alloc_stream(sizeof(VertexBufferFormat) * totgrid * key->grid_area);
 
 	if (GLEW_ARB_draw_elements_base_vertex /* 3.2 */) {
 		int i;
@@ -1836,6 +2005,11 @@ void GPU_draw_pbvh_buffers(GPU_PBVH_Buffers *buffers, DMSetMaterial setMaterial,
 		char *base = NULL;
 		char *index_base = NULL;
 		int bound_options = 0;
+
+		/* persistent streaming buffers draw from the region written last */
+		if (buffers->vert_buf->persistent_map)
+			base = (char *)buffers->vert_buf->stream_offset;
+
 		glEnableClientState(GL_VERTEX_ARRAY);
 		if (!wireframe) {
 			glEnableClientState(GL_NORMAL_ARRAY);
@@ -62,6 +62,25 @@ extern char datatoc_gpu_shader_geometry_glsl[];
 
 static char *glsl_material_library = NULL;
 
+/* Cache of compiled material shaders. Duplicated materials and materials from
+ * linked libraries often generate byte-identical GLSL, so identical generated
+ * code shares a single linked GL program instead of compiling it again. */
+typedef struct GPUShaderCacheEntry {
+	struct GPUShaderCacheEntry *next, *prev;
+
+	struct GPUShader *shader;
+	char *vertexcode;
+	char *geometrycode;
+	char *fragmentcode;
+	int flags;
+	unsigned int hash;
+	int users;
+} GPUShaderCacheEntry;
+
+static ListBase pass_shader_cache = {NULL, NULL};
+
+static void gpu_pass_shader_cache_entry_free(GPUShaderCacheEntry *entry);
+
 
 /* type definitions and constants */
 
@@ -282,6 +301,11 @@ void gpu_codegen_exit(void)
 	if (defmaterial.gpumaterial.first)
 		GPU_material_free(&defmaterial.gpumaterial);
 
+	while (pass_shader_cache.first) {
+		/* all passes should be freed by now, don't leak GL programs */
+		gpu_pass_shader_cache_entry_free(pass_shader_cache.first);
+	}
+
 	if (FUNCTION_HASH) {
 		BLI_ghash_free(FUNCTION_HASH, NULL, MEM_freeN);
 		FUNCTION_HASH = NULL;
@@ -1640,6 +1664,90 @@ static void gpu_nodes_prune(ListBase *nodes, GPUNodeLink *outlink)
 	}
 }
 
+static unsigned int gpu_pass_shader_hash(
+        const char *vertexcode, const char *geometrycode, const char *fragmentcode,
+        const int flags)
+{
+	unsigned int hash = (unsigned int)flags;
+
+	hash ^= BLI_ghashutil_strhash(vertexcode);
+	hash ^= BLI_ghashutil_strhash(fragmentcode);
+	if (geometrycode)
+		hash ^= BLI_ghashutil_strhash(geometrycode);
+
+	return hash;
+}
+
+/* lookup a previously linked shader for byte-identical generated code,
+ * increases the user count on success */
+static GPUShader *gpu_pass_shader_get(
+        const char *vertexcode, const char *geometrycode, const char *fragmentcode,
+        const int flags)
+{
+	GPUShaderCacheEntry *entry;
+	unsigned int hash = gpu_pass_shader_hash(vertexcode, geometrycode, fragmentcode, flags);
+
+	for (entry = pass_shader_cache.first; entry; entry = entry->next) {
+		if (entry->hash == hash && entry->flags == flags &&
+		    STREQ(entry->vertexcode, vertexcode) &&
+		    STREQ(entry->fragmentcode, fragmentcode) &&
+		    ((geometrycode == NULL) == (entry->geometrycode == NULL)) &&
+		    (geometrycode == NULL || STREQ(entry->geometrycode, geometrycode)))
+		{
+			entry->users++;
+			return entry->shader;
+		}
+	}
+
+	return NULL;
+}
+
+/* the cache keeps its own copies of the code, passes are freed in any order */
+static void gpu_pass_shader_cache_add(
+        GPUShader *shader,
+        const char *vertexcode, const char *geometrycode, const char *fragmentcode,
+        const int flags)
+{
+	GPUShaderCacheEntry *entry = MEM_callocN(sizeof(GPUShaderCacheEntry), "GPUShaderCacheEntry");
+
+	entry->shader = shader;
+	entry->vertexcode = BLI_strdup(vertexcode);
+	entry->geometrycode = geometrycode ? BLI_strdup(geometrycode) : NULL;
+	entry->fragmentcode = BLI_strdup(fragmentcode);
+	entry->flags = flags;
+	entry->hash = gpu_pass_shader_hash(vertexcode, geometrycode, fragmentcode, flags);
+	entry->users = 1;
+
+	BLI_addtail(&pass_shader_cache, entry);
+}
+
+static void gpu_pass_shader_cache_entry_free(GPUShaderCacheEntry *entry)
+{
+	GPU_shader_free(entry->shader);
+	MEM_freeN(entry->vertexcode);
+	if (entry->geometrycode)
+		MEM_freeN(entry->geometrycode);
+	MEM_freeN(entry->fragmentcode);
+	BLI_remlink(&pass_shader_cache, entry);
+	MEM_freeN(entry);
+}
+
+static void gpu_pass_shader_release(GPUShader *shader)
+{
+	GPUShaderCacheEntry *entry;
+
+	for (entry = pass_shader_cache.first; entry; entry = entry->next) {
+		if (entry->shader == shader) {
+			if (--entry->users == 0)
+				gpu_pass_shader_cache_entry_free(entry);
+			return;
+		}
+	}
+
+	/* not cached, shader is owned by the pass alone */
+	GPU_shader_free(shader);
+}
+
 GPUPass *GPU_generate_pass(
         ListBase *nodes, GPUNodeLink *outlink,
         GPUVertexAttribs *attribs, int *builtins,
@@ -1676,15 +1784,23 @@ GPUPass *GPU_generate_pass(
 	if (use_new_shading) {
 		flags |= GPU_SHADER_FLAGS_NEW_SHADING;
 	}
-	shader = GPU_shader_create_ex(vertexcode,
-	                              fragmentcode,
-	                              geometrycode,
-	                              glsl_material_library,
-	                              NULL,
-	                              0,
-	                              0,
-	                              0,
-	                              flags);
+	/* reuse a previously linked shader when the generated code is identical */
+	shader = gpu_pass_shader_get(vertexcode, geometrycode, fragmentcode, flags);
+
+	if (!shader) {
+		shader = GPU_shader_create_ex(vertexcode,
+		                              fragmentcode,
+		                              geometrycode,
+		                              glsl_material_library,
+		                              NULL,
+		                              0,
+		                              0,
+		                              0,
+		                              flags);
+
+		if (shader)
+			gpu_pass_shader_cache_add(shader, vertexcode, geometrycode, fragmentcode, flags);
+	}
 
 	/* failed? */
 	if (!shader) {
@@ -1717,7 +1833,7 @@ GPUPass *GPU_generate_pass(
 
 void GPU_pass_free(GPUPass *pass)
 {
-	GPU_shader_free(pass->shader);
+	gpu_pass_shader_release(pass->shader);
 	gpu_inputs_free(&pass->inputs);
 	if (pass->fragmentcode)
 		MEM_freeN(pass->fragmentcode);
@@ -1266,12 +1266,75 @@ static bool GPU_check_scaled_image(ImBuf *ibuf, Image *ima, float *frect, int x,
 	return false;
 }
 
+/* can the CPU mipmap pyramid be refreshed in place instead of a full texture
+ * reload? requires a byte image whose pyramid is already uploaded and a
+ * texture that was not downscaled on upload. */
+static bool gpu_paint_mipmaps_partial_poll(Image *ima, ImBuf *ibuf)
+{
+	if (ibuf->rect == NULL || ibuf->rect_float != NULL)
+		return false;
+	if ((ima->tpageflag & IMA_MIPMAP_COMPLETE) == 0)
+		return false;
+	if (ibuf->miptot <= 1 || ibuf->mipmap[0] == NULL)
+		return false;
+	if ((!GPU_full_non_power_of_two_support() && !is_power_of_2_resolution(ibuf->x, ibuf->y)) ||
+	    is_over_resolution_limit(GL_TEXTURE_2D, ibuf->x, ibuf->y))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+/* refresh the CPU mipmaps inside the painted rectangle and re-upload only the
+ * dirty region of each texture level */
+static void gpu_paint_update_mipmaps_partial(ImBuf *ibuf, int x, int y, int w, int h)
+{
+	GLint row_length, skip_pixels, skip_rows;
+	int level;
+
+	IMB_makemipmap_partial(ibuf, x, y, w, h);
+	ibuf->userflags &= ~IB_MIPMAP_INVALID;
+
+	glGetIntegerv(GL_UNPACK_ROW_LENGTH, &row_length);
+	glGetIntegerv(GL_UNPACK_SKIP_PIXELS, &skip_pixels);
+	glGetIntegerv(GL_UNPACK_SKIP_ROWS, &skip_rows);
+
+	for (level = 1; level < ibuf->miptot; level++) {
+		ImBuf *mip = ibuf->mipmap[level - 1];
+		int mx1, my1, mx2, my2;
+
+		if (mip == NULL || mip->rect == NULL)
+			break;
+
+		/* expand by one pixel to cover partially dirty border texels */
+		mx1 = x >> level;
+		my1 = y >> level;
+		mx2 = MIN2(((x + w) >> level) + 1, mip->x);
+		my2 = MIN2(((y + h) >> level) + 1, mip->y);
+
+		if (mx1 >= mx2 || my1 >= my2)
+			continue;
+
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, mip->x);
+		glPixelStorei(GL_UNPACK_SKIP_PIXELS, mx1);
+		glPixelStorei(GL_UNPACK_SKIP_ROWS, my1);
+
+		glTexSubImage2D(GL_TEXTURE_2D, level, mx1, my1, mx2 - mx1, my2 - my1,
+		                GL_RGBA, GL_UNSIGNED_BYTE, mip->rect);
+	}
+
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, row_length);
+	glPixelStorei(GL_UNPACK_SKIP_PIXELS, skip_pixels);
+	glPixelStorei(GL_UNPACK_SKIP_ROWS, skip_rows);
+}
+
 void GPU_paint_update_image(Image *ima, ImageUser *iuser, int x, int y, int w, int h)
 {
 	ImBuf *ibuf = BKE_image_acquire_ibuf(ima, iuser, NULL);
 
 	if (ima->repbind ||
-	    (!GTS.gpu_mipmap && GPU_get_mipmap()) ||
+	    (!GTS.gpu_mipmap && GPU_get_mipmap() && !(ibuf && gpu_paint_mipmaps_partial_poll(ima, ibuf))) ||
 	    (ima->bindcode[TEXTARGET_TEXTURE_2D] == 0) ||
 	    (ibuf == NULL) ||
 	    (w == 0) || (h == 0))
@@ -1336,9 +1399,15 @@ void GPU_paint_update_image(Image *ima, ImageUser *iuser, int x, int y, int w, i
 		glPixelStorei(GL_UNPACK_SKIP_PIXELS, skip_pixels);
 		glPixelStorei(GL_UNPACK_SKIP_ROWS, skip_rows);
 
-		/* see comment above as to why we are using gpu mipmap generation here */
 		if (GPU_get_mipmap()) {
-			gpu_generate_mipmap(GL_TEXTURE_2D);
+			if (GTS.gpu_mipmap) {
+				gpu_generate_mipmap(GL_TEXTURE_2D);
+			}
+			else {
+				/* no GPU generation available, refresh the painted region of
+				 * the CPU pyramid and re-upload only those texels */
+				gpu_paint_update_mipmaps_partial(ibuf, x, y, w, h);
+			}
 		}
 		else {
 			ima->tpageflag &= ~IMA_MIPMAP_COMPLETE;
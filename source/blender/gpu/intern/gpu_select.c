@@ -53,6 +53,8 @@ typedef struct GPUQueryState {
 	unsigned int *id;
 	/* number of queries in *queries and *id */
 	unsigned int num_of_queries;
+	/* GL_SAMPLES_PASSED, or the cheaper boolean GL_ANY_SAMPLES_PASSED when supported */
+	unsigned int query_target;
 	/* index to the next query to start */
 	unsigned int active_query;
 	/* flag to cache user preference for occlusion based selection */
@@ -96,6 +98,10 @@ void GPU_select_begin(unsigned int *buffer, unsigned int bufsize, rctf *input, c
 
 		g_query_state.num_of_queries = ALLOC_QUERIES;
 
+		/* we only care whether any sample passed, which lets the gpu terminate
+		 * early instead of counting every fragment */
+		g_query_state.query_target = GLEW_ARB_occlusion_query2 ? GL_ANY_SAMPLES_PASSED : GL_SAMPLES_PASSED;
+
 		g_query_state.queries = MEM_mallocN(g_query_state.num_of_queries * sizeof(*g_query_state.queries), "gpu selection queries");
 		g_query_state.id = MEM_mallocN(g_query_state.num_of_queries * sizeof(*g_query_state.id), "gpu selection ids");
 		glGenQueries(g_query_state.num_of_queries, g_query_state.queries);
@@ -154,7 +160,7 @@ bool GPU_select_load_id(unsigned int id)
 	}
 	else {
 		if (g_query_state.query_issued) {
-			glEndQuery(GL_SAMPLES_PASSED);
+			glEndQuery(g_query_state.query_target);
 		}
 		/* if required, allocate extra queries */
 		if (g_query_state.active_query == g_query_state.num_of_queries) {
@@ -164,7 +170,7 @@ bool GPU_select_load_id(unsigned int id)
 			glGenQueries(ALLOC_QUERIES, &g_query_state.queries[g_query_state.active_query]);
 		}
 
-		glBeginQuery(GL_SAMPLES_PASSED, g_query_state.queries[g_query_state.active_query]);
+		glBeginQuery(g_query_state.query_target, g_query_state.queries[g_query_state.active_query]);
 		g_query_state.id[g_query_state.active_query] = id;
 		g_query_state.active_query++;
 		g_query_state.query_issued = true;
@@ -199,7 +205,20 @@ unsigned int GPU_select_end(void)
 		int i;
 
 		if (g_query_state.query_issued) {
-			glEndQuery(GL_SAMPLES_PASSED);
+			glEndQuery(g_query_state.query_target);
+		}
+
+		/* queries complete in issue order, so once the last one has its result
+		 * available every read below comes from the driver cache instead of
+		 * stalling the pipeline per query */
+		if (g_query_state.active_query > 0) {
+			unsigned int available = 0;
+
+			glFlush();
+			while (!available) {
+				glGetQueryObjectuiv(g_query_state.queries[g_query_state.active_query - 1],
+				                    GL_QUERY_RESULT_AVAILABLE, &available);
+			}
 		}
 
 		for (i = 0; i < g_query_state.active_query; i++) {
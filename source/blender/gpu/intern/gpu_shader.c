@@ -29,9 +29,12 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_utildefines.h"
+#include "BLI_dynstr.h"
+#include "BLI_hash_md5.h"
 #include "BLI_math_base.h"
 #include "BLI_math_vector.h"
 
+#include "BKE_appdir.h"
 #include "BKE_global.h"
 
 #include "GPU_compositing.h"
@@ -233,6 +236,122 @@ static void gpu_shader_standard_defines(char defines[MAX_DEFINE_LENGTH],
 	return;
 }
 
+/* On-disk program binary cache (ARB_get_program_binary).
+ *
+ * Relinking the same generated material shaders on every file open is by far
+ * the biggest cost of entering textured/material draw modes in heavy scenes,
+ * so successfully linked programs are stored on disk keyed by an md5 of all
+ * the source strings plus the driver identification. Binaries are driver and
+ * hardware specific and drivers reject stale ones, in which case we silently
+ * fall back to compiling from source. */
+
+static bool gpu_shader_binary_cache_path(
+        char r_path[FILE_MAX],
+        const char *vertexcode, const char *fragcode, const char *geocode,
+        const char *libcode, const char *defines,
+        const char *standard_defines, const char *standard_extensions,
+        int input, int output, int number, const int flags)
+{
+	DynStr *ds;
+	char *codestr;
+	unsigned char digest[16];
+	char filename[64], hexdigest[33];
+	const char *cachedir = BKE_appdir_folder_id_create(BLENDER_USER_CONFIG, "glsl-program-cache");
+
+	if (!cachedir)
+		return false;
+
+	ds = BLI_dynstr_new();
+	BLI_dynstr_append(ds, (const char *)glGetString(GL_VENDOR));
+	BLI_dynstr_append(ds, (const char *)glGetString(GL_RENDERER));
+	BLI_dynstr_append(ds, (const char *)glGetString(GL_VERSION));
+	BLI_dynstr_appendf(ds, "%d %d %d %d", input, output, number, flags);
+	BLI_dynstr_append(ds, standard_defines);
+	BLI_dynstr_append(ds, standard_extensions);
+	if (defines) BLI_dynstr_append(ds, defines);
+	if (libcode) BLI_dynstr_append(ds, libcode);
+	if (vertexcode) BLI_dynstr_append(ds, vertexcode);
+	if (geocode) BLI_dynstr_append(ds, geocode);
+	if (fragcode) BLI_dynstr_append(ds, fragcode);
+
+	codestr = BLI_dynstr_get_cstring(ds);
+	BLI_dynstr_free(ds);
+
+	BLI_hash_md5_buffer(codestr, strlen(codestr), digest);
+	BLI_hash_md5_to_hexdigest(digest, hexdigest);
+	MEM_freeN(codestr);
+
+	BLI_snprintf(filename, sizeof(filename), "%s.bin", hexdigest);
+	BLI_join_dirfile(r_path, FILE_MAX, cachedir, filename);
+
+	return true;
+}
+
+static bool gpu_shader_binary_cache_read(GLuint program, const char *path)
+{
+	FILE *fp = BLI_fopen(path, "rb");
+	GLenum format;
+	GLint status = 0;
+	long size;
+	void *binary;
+
+	if (!fp)
+		return false;
+
+	fseek(fp, 0L, SEEK_END);
+	size = ftell(fp);
+	fseek(fp, 0L, SEEK_SET);
+
+	if (size <= (long)sizeof(format) ||
+	    fread(&format, sizeof(format), 1, fp) != 1)
+	{
+		fclose(fp);
+		return false;
+	}
+
+	size -= sizeof(format);
+	binary = MEM_mallocN(size, "gpu_shader_binary");
+
+	if (fread(binary, size, 1, fp) != 1) {
+		MEM_freeN(binary);
+		fclose(fp);
+		return false;
+	}
+
+	fclose(fp);
+
+	glProgramBinary(program, format, binary, size);
+	MEM_freeN(binary);
+
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+
+	return (status != 0);
+}
+
+static void gpu_shader_binary_cache_write(GLuint program, const char *path)
+{
+	GLint size = 0;
+	GLenum format = 0;
+	GLsizei length = 0;
+	void *binary;
+	FILE *fp;
+
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+	if (size <= 0)
+		return;
+
+	binary = MEM_mallocN(size, "gpu_shader_binary");
+	glGetProgramBinary(program, size, &length, &format, binary);
+
+	if (length > 0 && (fp = BLI_fopen(path, "wb"))) {
+		fwrite(&format, sizeof(format), 1, fp);
+		fwrite(binary, length, 1, fp);
+		fclose(fp);
+	}
+
+	MEM_freeN(binary);
+}
+
 GPUShader *GPU_shader_create(const char *vertexcode,
                              const char *fragcode,
                              const char *geocode,
@@ -279,37 +398,53 @@ GPUShader *GPU_shader_create_ex(const char *vertexcode,
 	GPUShader *shader;
 	char standard_defines[MAX_DEFINE_LENGTH] = "";
 	char standard_extensions[MAX_EXT_DEFINE_LENGTH] = "";
+	char binary_path[FILE_MAX];
+	bool use_binary_cache = false;
+	bool binary_loaded = false;
 
 	if (geocode && !GPU_geometry_shader_support())
 		return NULL;
 
 	shader = MEM_callocN(sizeof(GPUShader), "GPUShader");
 
-	if (vertexcode)
-		shader->vertex = glCreateShader(GL_VERTEX_SHADER);
-	if (fragcode)
-		shader->fragment = glCreateShader(GL_FRAGMENT_SHADER);
-	if (geocode)
-		shader->geometry = glCreateShader(GL_GEOMETRY_SHADER_EXT);
-
 	shader->program = glCreateProgram();
 
+	gpu_shader_standard_defines(standard_defines,
+	                            use_opensubdiv,
+	                            (flags & GPU_SHADER_FLAGS_NEW_SHADING) != 0);
+	gpu_shader_standard_extensions(standard_extensions, geocode != NULL);
+
+	/* skip compiling alltogether when a cached program binary loads */
+	if (shader->program && GLEW_ARB_get_program_binary) {
+		use_binary_cache = gpu_shader_binary_cache_path(
+		        binary_path, vertexcode, fragcode, geocode, libcode, defines,
+		        standard_defines, standard_extensions, input, output, number, flags);
+
+		if (use_binary_cache)
+			binary_loaded = gpu_shader_binary_cache_read(shader->program, binary_path);
+	}
+
+	if (!binary_loaded) {
+		if (vertexcode)
+			shader->vertex = glCreateShader(GL_VERTEX_SHADER);
+		if (fragcode)
+			shader->fragment = glCreateShader(GL_FRAGMENT_SHADER);
+		if (geocode)
+			shader->geometry = glCreateShader(GL_GEOMETRY_SHADER_EXT);
+	}
+
 	if (!shader->program ||
-	    (vertexcode && !shader->vertex) ||
-	    (fragcode && !shader->fragment) ||
-	    (geocode && !shader->geometry))
+	    (!binary_loaded &&
+	     ((vertexcode && !shader->vertex) ||
+	      (fragcode && !shader->fragment) ||
+	      (geocode && !shader->geometry))))
 	{
 		fprintf(stderr, "GPUShader, object creation failed.\n");
 		GPU_shader_free(shader);
 		return NULL;
 	}
 
-	gpu_shader_standard_defines(standard_defines,
-	                            use_opensubdiv,
-	                            (flags & GPU_SHADER_FLAGS_NEW_SHADING) != 0);
-	gpu_shader_standard_extensions(standard_extensions, geocode != NULL);
-
-	if (vertexcode) {
+	if (!binary_loaded && vertexcode) {
 		const char *source[5];
 		/* custom limit, may be too small, beware */
 		int num_source = 0;
@@ -336,7 +471,7 @@ GPUShader *GPU_shader_create_ex(const char *vertexcode,
 		}
 	}
 
-	if (fragcode) {
+	if (!binary_loaded && fragcode) {
 		const char *source[7];
 		int num_source = 0;
 
@@ -375,7 +510,7 @@ GPUShader *GPU_shader_create_ex(const char *vertexcode,
 		}
 	}
 
-	if (geocode) {
+	if (!binary_loaded && geocode) {
 		const char *source[6];
 		int num_source = 0;
 
@@ -406,7 +541,7 @@ GPUShader *GPU_shader_create_ex(const char *vertexcode,
 	}
 
 #ifdef WITH_OPENSUBDIV
-	if (use_opensubdiv) {
+	if (!binary_loaded && use_opensubdiv) {
 		glBindAttribLocation(shader->program, 0, "position");
 		glBindAttribLocation(shader->program, 1, "normal");
 		GPU_shader_geometry_stage_primitive_io(shader,
@@ -416,18 +551,26 @@ GPUShader *GPU_shader_create_ex(const char *vertexcode,
 	}
 #endif
 
-	glLinkProgram(shader->program);
-	glGetProgramiv(shader->program, GL_LINK_STATUS, &status);
-	if (!status) {
-		glGetProgramInfoLog(shader->program, sizeof(log), &length, log);
-		/* print attached shaders in pipeline order */
-		if (vertexcode) shader_print_errors("linking", log, &vertexcode, 1);
-		if (geocode) shader_print_errors("linking", log, &geocode, 1);
-		if (libcode) shader_print_errors("linking", log, &libcode, 1);
-		if (fragcode) shader_print_errors("linking", log, &fragcode, 1);
+	if (!binary_loaded) {
+		if (use_binary_cache)
+			glProgramParameteri(shader->program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 
-		GPU_shader_free(shader);
-		return NULL;
+		glLinkProgram(shader->program);
+		glGetProgramiv(shader->program, GL_LINK_STATUS, &status);
+		if (!status) {
+			glGetProgramInfoLog(shader->program, sizeof(log), &length, log);
+			/* print attached shaders in pipeline order */
+			if (vertexcode) shader_print_errors("linking", log, &vertexcode, 1);
+			if (geocode) shader_print_errors("linking", log, &geocode, 1);
+			if (libcode) shader_print_errors("linking", log, &libcode, 1);
+			if (fragcode) shader_print_errors("linking", log, &fragcode, 1);
+
+			GPU_shader_free(shader);
+			return NULL;
+		}
+
+		if (use_binary_cache)
+			gpu_shader_binary_cache_write(shader->program, binary_path);
 	}
 
 #ifdef WITH_OPENSUBDIV
@@ -169,6 +169,9 @@ struct IK_Scene {
 	iTaSC::MovingFrame* base;		// armature base object
 	KDL::Frame			baseFrame;	// frame of armature base relative to blArmature
 	KDL::JntArray		jointArray;	// buffer for storing temporary joint array
+	KDL::JntArray		jointSolution;	// last converged solution, seed for reevaluation of the same frame
+	float				solutionTime;	// ctime at which jointSolution was computed
+	bool				solutionValid;
 	iTaSC::Solver*		solver;
 	Object*				blArmature;
 	float				blScale;	// scale of the Armature object (assume uniform scaling)
@@ -189,6 +192,8 @@ struct IK_Scene {
 		blArmature = NULL;
 		numchan = 0;
 		numjoint = 0;
+		solutionTime = 0.0f;
+		solutionValid = false;
 		polarConstraint = NULL;
 	}
 
@@ -1621,7 +1626,17 @@ static void execute_scene(Scene *blscene, IK_Scene *ikscene, bItasc *ikparam, fl
 	else {
 		// in animation mode we start from the pose after action and constraint
 		convert_pose(ikscene);
-		ikscene->armature->setJointArray(ikscene->jointArray);
+		if (ikscene->solutionValid && ikscene->solutionTime == ctime &&
+		    ikscene->jointSolution.rows() == ikscene->jointArray.rows())
+		{
+			// reevaluation of the same frame (e.g. dragging an IK target):
+			// warm start from the previous solution, the reiteration below only
+			// needs to absorb the target motion instead of redoing the full solve
+			ikscene->armature->setJointArray(ikscene->jointSolution);
+		}
+		else {
+			ikscene->armature->setJointArray(ikscene->jointArray);
+		}
 		// and we don't handle velocity
 		reiterate = true;
 		simulation = false;
@@ -1663,6 +1678,13 @@ static void execute_scene(Scene *blscene, IK_Scene *ikscene, bItasc *ikparam, fl
 			ikscene->scene->update(timestamp, 0.0, 1, true, true, true);
 		}
 	}
+	if (!simulation) {
+		// remember the converged solution, it's only used as seed as long as
+		// we stay on this frame; the simulation mode has its own cache
+		ikscene->jointSolution = ikscene->armature->getJointArray();
+		ikscene->solutionTime = ctime;
+		ikscene->solutionValid = true;
+	}
 	// compute constraint error
 	for (i = ikscene->targets.size(); i > 0; --i) {
 		IK_Target *iktarget = ikscene->targets[i - 1];
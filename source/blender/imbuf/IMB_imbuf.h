@@ -119,6 +119,18 @@ struct ImBuf *IMB_testiffname(const char *filepath, int flags);
  */
 struct ImBuf *IMB_loadiffname(const char *filepath, int flags, char colorspace[IM_MAX_SPACE]);
 
+/**
+ * Load only a region of an image, for formats that support partial reads
+ * (currently tiled/mipmapped OpenEXR). \a miplevel selects the resolution
+ * level, the region is given in pixels of that level with the ImBuf origin.
+ * Returns NULL when the format can not do a region read, callers should
+ * fall back to #IMB_loadiffname then.
+ *
+ * \attention Defined in readimage.c
+ */
+struct ImBuf *IMB_loadiffname_region(const char *filepath, int flags, char colorspace[IM_MAX_SPACE], int miplevel,
+                                     int x, int y, int width, int height);
+
 /**
  *
  * \attention Defined in allocimbuf.c
@@ -351,6 +363,7 @@ void IMB_mask_filter_extend(char *mask, int width, int height);
 void IMB_mask_clear(struct ImBuf *ibuf, char *mask, int val);
 void IMB_filter_extend(struct ImBuf *ibuf, char *mask, int filter);
 void IMB_makemipmap(struct ImBuf *ibuf, int use_filter);
+void IMB_makemipmap_partial(struct ImBuf *ibuf, int x, int y, int w, int h);
 void IMB_remakemipmap(struct ImBuf *ibuf, int use_filter);
 struct ImBuf *IMB_getmipmap(struct ImBuf *ibuf, int level);
 
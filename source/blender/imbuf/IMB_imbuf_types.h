@@ -49,6 +49,7 @@
 
 #define IMB_MIPMAP_LEVELS	20
 #define IMB_FILENAME_SIZE	1024
+#define IMB_INVALID_RECTS	8
 
 typedef struct DDSData {
 	unsigned int fourcc; /* DDS fourcc info */
@@ -216,7 +217,8 @@ typedef struct ImBuf {
 	unsigned int *display_buffer_flags;          /* array of per-display display buffers dirty flags */
 	struct ColormanageCache *colormanage_cache;  /* cache used by color management */
 	int colormanage_flag;
-	rcti invalid_rect;
+	rcti invalid_rects[IMB_INVALID_RECTS];  /* regions with out of date display buffers, see IMB_partial_display_buffer_update_delayed */
+	int invalid_rect_tot;
 
 	/* information for compressed textures */
 	struct DDSData dds_data;
@@ -42,6 +42,19 @@
 struct ImBuf;
 struct MovieCache;
 
+/* Eviction priority bands. Buffers from lower bands are always evicted
+ * before buffers from higher ones, and each band only gets a proportional
+ * share of the global cache limit, so a background thumbnail pass can not
+ * push sequencer playback frames out of the cache.
+ */
+enum {
+	MOVIECACHE_BAND_THUMBNAIL  = 0,  /* thumbnails, background passes */
+	MOVIECACHE_BAND_MOVIECLIP  = 1,  /* movie clips, images, display buffers */
+	MOVIECACHE_BAND_SEQUENCER  = 2,  /* sequencer playback frames */
+
+	MOVIECACHE_NUM_BANDS       = 3,
+};
+
 typedef void (*MovieCacheGetKeyDataFP) (void *userkey, int *framenr, int *proxy, int *render_flags);
 
 typedef void  *(*MovieCacheGetPriorityDataFP) (void *userkey);
@@ -56,6 +69,10 @@ void IMB_moviecache_set_getdata_callback(struct MovieCache *cache, MovieCacheGet
 void IMB_moviecache_set_priority_callback(struct MovieCache *cache, MovieCacheGetPriorityDataFP getprioritydatafp,
                                           MovieCacheGetItemPriorityFP getitempriorityfp,
                                           MovieCachePriorityDeleterFP prioritydeleterfp);
+void IMB_moviecache_set_priority_band(struct MovieCache *cache, int priority_band);
+
+void IMB_moviecache_pin_frame_range(struct MovieCache *cache, int start_frame, int end_frame);
+void IMB_moviecache_unpin_frame_range(struct MovieCache *cache);
 
 void IMB_moviecache_put(struct MovieCache *cache, void *userkey, struct ImBuf *ibuf);
 bool IMB_moviecache_put_if_possible(struct MovieCache *cache, void *userkey, struct ImBuf *ibuf);
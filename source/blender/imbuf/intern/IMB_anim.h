@@ -108,6 +108,12 @@
 
 #define MAXNUMSTREAMS       50
 
+#ifdef WITH_FFMPEG
+/* number of horizontal bands the RGBA conversion can be split into,
+ * each band is converted by its own swscale context */
+#  define ANIM_FFMPEG_CONVERT_SLICES 8
+#endif
+
 struct _AviMovie;
 struct anim_index;
 
@@ -162,6 +168,8 @@ struct anim {
 	AVFrame *pFrameRGB;
 	AVFrame *pFrameDeinterlaced;
 	struct SwsContext *img_convert_ctx;
+	/* extra contexts for threaded slice conversion, created on demand */
+	struct SwsContext *img_convert_slice_ctx[ANIM_FFMPEG_CONVERT_SLICES];
 	int videoStream;
 
 	struct ImBuf *last_frame;
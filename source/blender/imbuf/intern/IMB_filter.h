@@ -45,6 +45,8 @@ void IMB_unpremultiply_rect(unsigned int *rect, char planes, int w, int h);
 void IMB_unpremultiply_rect_float(float *rect_float, int channels, int w, int h);
 
 void imb_onehalf_no_alloc(struct ImBuf *ibuf2, struct ImBuf *ibuf1);
+void imb_onehalf_partial_no_alloc(struct ImBuf *ibuf2, struct ImBuf *ibuf1,
+                                  int x1, int y1, int x2, int y2);
 
 #endif
 
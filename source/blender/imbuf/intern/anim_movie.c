@@ -67,6 +67,8 @@
 #include "BLI_utildefines.h"
 #include "BLI_string.h"
 #include "BLI_path_util.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "MEM_guardedalloc.h"
 
@@ -448,6 +450,53 @@ BLI_INLINE bool need_aligned_ffmpeg_buffer(struct anim *anim)
 	return (anim->x & 31) != 0;
 }
 
+static struct SwsContext *ffmpeg_sws_context_create(struct anim *anim, int flags)
+{
+	struct SwsContext *ctx;
+
+#ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
+	/* The following for color space determination */
+	int srcRange, dstRange, brightness, contrast, saturation;
+	int *table;
+	const int *inv_table;
+#endif
+
+	ctx = sws_getContext(
+	        anim->x,
+	        anim->y,
+	        anim->pCodecCtx->pix_fmt,
+	        anim->x,
+	        anim->y,
+	        AV_PIX_FMT_RGBA,
+	        flags,
+	        NULL, NULL, NULL);
+
+	if (!ctx) {
+		return NULL;
+	}
+
+#ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
+	/* Try do detect if input has 0-255 YCbCR range (JFIF Jpeg MotionJpeg) */
+	if (!sws_getColorspaceDetails(ctx, (int **)&inv_table, &srcRange,
+	                              &table, &dstRange, &brightness, &contrast, &saturation))
+	{
+		srcRange = srcRange || anim->pCodecCtx->color_range == AVCOL_RANGE_JPEG;
+		inv_table = sws_getCoefficients(anim->pCodecCtx->colorspace);
+
+		if (sws_setColorspaceDetails(ctx, (int *)inv_table, srcRange,
+		                             table, dstRange, brightness, contrast, saturation))
+		{
+			fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
+		}
+	}
+	else {
+		fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
+	}
+#endif
+
+	return ctx;
+}
+
 static int startffmpeg(struct anim *anim)
 {
 	int i, videoStream;
@@ -460,13 +509,6 @@ static int startffmpeg(struct anim *anim)
 	double frs_den;
 	int streamcount;
 
-#ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
-	/* The following for color space determination */
-	int srcRange, dstRange, brightness, contrast, saturation;
-	int *table;
-	const int *inv_table;
-#endif
-
 	if (anim == NULL) return(-1);
 
 	streamcount = anim->streamindex;
@@ -615,16 +657,9 @@ static int startffmpeg(struct anim *anim)
 		anim->preseek = 0;
 	}
 	
-	anim->img_convert_ctx = sws_getContext(
-	        anim->x,
-	        anim->y,
-	        anim->pCodecCtx->pix_fmt,
-	        anim->x,
-	        anim->y,
-	        AV_PIX_FMT_RGBA,
-	        SWS_FAST_BILINEAR | SWS_PRINT_INFO | SWS_FULL_CHR_H_INT,
-	        NULL, NULL, NULL);
-		
+	anim->img_convert_ctx = ffmpeg_sws_context_create(
+	        anim, SWS_FAST_BILINEAR | SWS_PRINT_INFO | SWS_FULL_CHR_H_INT);
+
 	if (!anim->img_convert_ctx) {
 		fprintf(stderr,
 		        "Can't transform color space??? Bailing out...\n");
@@ -637,26 +672,67 @@ static int startffmpeg(struct anim *anim)
 		return -1;
 	}
 
-#ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
-	/* Try do detect if input has 0-255 YCbCR range (JFIF Jpeg MotionJpeg) */
-	if (!sws_getColorspaceDetails(anim->img_convert_ctx, (int **)&inv_table, &srcRange,
-	                              &table, &dstRange, &brightness, &contrast, &saturation))
-	{
-		srcRange = srcRange || anim->pCodecCtx->color_range == AVCOL_RANGE_JPEG;
-		inv_table = sws_getCoefficients(anim->pCodecCtx->colorspace);
+	return (0);
+}
 
-		if (sws_setColorspaceDetails(anim->img_convert_ctx, (int *)inv_table, srcRange,
-		                             table, dstRange, brightness, contrast, saturation))
-		{
-			fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
-		}
+typedef struct FFmpegConvertState {
+	struct anim *anim;
+	AVFrame *input;
+	uint8_t **dst;
+	int *dst_stride;
+	int slice_height;
+} FFmpegConvertState;
+
+static void ffmpeg_postprocess_slice_cb(void *userdata, const int slice)
+{
+	FFmpegConvertState *state = userdata;
+	struct anim *anim = state->anim;
+	int y = slice * state->slice_height;
+	int h = MIN2(state->slice_height, anim->y - y);
+
+	if (h <= 0) {
+		return;
 	}
-	else {
-		fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
+
+	sws_scale(anim->img_convert_slice_ctx[slice],
+	          (const uint8_t *const *)state->input->data,
+	          state->input->linesize,
+	          y,
+	          h,
+	          state->dst,
+	          state->dst_stride);
+}
+
+/* decide how many bands the conversion of the current frame is split into
+ * and make sure each band has its own swscale context */
+static int ffmpeg_convert_slice_count(struct anim *anim)
+{
+	int num_slices, i;
+
+	/* small frames are dominated by the dispatch overhead */
+	if (anim->x * anim->y < 1280 * 720) {
+		return 1;
 	}
-#endif
-		
-	return (0);
+
+	num_slices = MIN2(ANIM_FFMPEG_CONVERT_SLICES, BLI_system_thread_count());
+
+	/* keep slice boundaries on even rows, subsampled chroma planes
+	 * cover two luma rows */
+	while (num_slices > 1 && ((anim->y + num_slices - 1) / num_slices) & 1) {
+		num_slices--;
+	}
+
+	for (i = 0; i < num_slices; i++) {
+		if (anim->img_convert_slice_ctx[i] == NULL) {
+			anim->img_convert_slice_ctx[i] = ffmpeg_sws_context_create(
+			        anim, SWS_FAST_BILINEAR | SWS_FULL_CHR_H_INT);
+		}
+		if (anim->img_convert_slice_ctx[i] == NULL) {
+			return 1;
+		}
+	}
+
+	return num_slices;
 }
 
 /* postprocess the image in anim->pFrame and do color conversion
@@ -767,14 +843,30 @@ static void ffmpeg_postprocess(struct anim *anim)
 		int dstStride2[4] = { -dstStride[0], 0, 0, 0 };
 		uint8_t *dst2[4]  = { dst[0] + (anim->y - 1) * dstStride[0],
 			                  0, 0, 0 };
-		
-		sws_scale(anim->img_convert_ctx,
-		          (const uint8_t *const *)input->data,
-		          input->linesize,
-		          0,
-		          anim->y,
-		          dst2,
-		          dstStride2);
+		int num_slices = ffmpeg_convert_slice_count(anim);
+
+		if (num_slices > 1) {
+			/* convert horizontal bands in parallel, there is no vertical
+			 * scaling so each band only reads its own source rows */
+			FFmpegConvertState state;
+
+			state.anim = anim;
+			state.input = input;
+			state.dst = dst2;
+			state.dst_stride = dstStride2;
+			state.slice_height = (anim->y + num_slices - 1) / num_slices;
+
+			BLI_task_parallel_range(0, num_slices, &state, ffmpeg_postprocess_slice_cb, true);
+		}
+		else {
+			sws_scale(anim->img_convert_ctx,
+			          (const uint8_t *const *)input->data,
+			          input->linesize,
+			          0,
+			          anim->y,
+			          dst2,
+			          dstStride2);
+		}
 	}
 
 	if (need_aligned_ffmpeg_buffer(anim)) {
@@ -1191,6 +1283,9 @@ static void free_anim_ffmpeg(struct anim *anim)
 		av_frame_free(&anim->pFrameDeinterlaced);
 
 		sws_freeContext(anim->img_convert_ctx);
+		for (int i = 0; i < ANIM_FFMPEG_CONVERT_SLICES; i++) {
+			sws_freeContext(anim->img_convert_slice_ctx[i]);
+		}
 		IMB_freeImBuf(anim->last_frame);
 		if (anim->next_packet.stream_index != -1) {
 			av_free_packet(&anim->next_packet);
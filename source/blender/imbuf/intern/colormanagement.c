@@ -38,6 +38,10 @@
 #include <string.h>
 #include <math.h>
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 #include "DNA_color_types.h"
 #include "DNA_image_types.h"
 #include "DNA_movieclip_types.h"
@@ -106,6 +110,12 @@ typedef struct ColormanageProcessor {
 	OCIO_ConstProcessorRcPtr *processor;
 	CurveMapping *curve_mapping;
 	bool is_data_result;
+
+	/* baked shaper + 3D LUT approximation of the OCIO processor, RGBX
+	 * entries, only used for display transforms of large buffers, see
+	 * colormanage_processor_bake_display_lut()
+	 */
+	float *display_lut;
 } ColormanageProcessor;
 
 static struct global_glsl_state {
@@ -1230,6 +1240,252 @@ const char *IMB_colormanagement_get_rect_colorspace(ImBuf *ibuf)
 	return ibuf->rect_colorspace->name;
 }
 
+/*********************** Display transform LUT fast path *************************/
+
+/* For display transforms of large buffers applying the OCIO processor for
+ * every pixel is the bottleneck: each pixel runs through the whole transform
+ * chain. Display output only needs display precision, so for such buffers the
+ * processor is baked into a log2-shaped 3D LUT once and the pixels are then
+ * transformed with trilinear interpolation, which is the same approximation
+ * the GLSL viewport draw uses for its baked LUT textures.
+ *
+ * The LUT is only baked from display_buffer_apply_threaded() and only for
+ * buffers which are large enough for the bake to pay off, so transforms
+ * which end up in saved files keep using the exact processor.
+ */
+
+/* Keep equal to LUT3D_EDGE_SIZE used by the GLSL draw, so CPU and GPU
+ * display paths have matching precision.
+ */
+#define DISPLAY_LUT_EDGE_SIZE 64
+
+/* Scene linear channel values are shaped with log2 over this exposure range
+ * before they index the LUT, values outside of the range are clamped. The
+ * first grid sample is baked from an input of exactly zero, so values below
+ * the minimum interpolate towards the transformed black level.
+ */
+#define DISPLAY_LUT_MIN_EXPONENT -12.0f
+#define DISPLAY_LUT_MAX_EXPONENT 12.0f
+#define DISPLAY_LUT_MIN_VALUE 0.000244140625f  /* 2^-12 */
+
+/* Baking evaluates the processor for EDGE_SIZE^3 grid samples, only do it
+ * for buffers where that's small compared to the pixel count itself.
+ */
+#define DISPLAY_LUT_BAKE_THRESHOLD (1024 * 1024)
+
+#define DISPLAY_LUT_INDEX(x, y, z) \
+	(4 * (((size_t)(z) * DISPLAY_LUT_EDGE_SIZE + (y)) * DISPLAY_LUT_EDGE_SIZE + (x)))
+
+#ifdef __SSE2__
+/* Approximate log2 for shaping, exponent comes from the float bits and a
+ * degree 5 minimax polynomial handles the mantissa. The error stays well
+ * below the spacing of the LUT grid. Input is expected to be a positive
+ * normalized number.
+ */
+BLI_INLINE __m128 display_lut_log2_ps(__m128 v)
+{
+	const __m128i mantissa_mask = _mm_set1_epi32(0x007fffff);
+	const __m128i one_bits = _mm_set1_epi32(0x3f800000);
+	__m128i bits = _mm_castps_si128(v);
+	__m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23),
+	                                                _mm_set1_epi32(127)));
+	__m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, mantissa_mask), one_bits));
+	__m128 p;
+
+	p = _mm_set1_ps(-3.4436006e-2f);
+	p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(3.1821337e-1f));
+	p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(-1.2315303f));
+	p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(2.5988452f));
+	p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(-3.3241990f));
+	p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(3.1157899f));
+
+	return _mm_add_ps(_mm_mul_ps(p, _mm_sub_ps(m, _mm_set1_ps(1.0f))), exponent);
+}
+#else
+BLI_INLINE float display_lut_apply_shaper(float value)
+{
+	const float scale = (float)(DISPLAY_LUT_EDGE_SIZE - 1) /
+	                    (DISPLAY_LUT_MAX_EXPONENT - DISPLAY_LUT_MIN_EXPONENT);
+	float co;
+
+	/* negated comparison catches NaN as well */
+	if (!(value > DISPLAY_LUT_MIN_VALUE))
+		return 0.0f;
+
+	co = (logf(value) * (float)(1.0 / M_LN2) - DISPLAY_LUT_MIN_EXPONENT) * scale;
+	CLAMP(co, 0.0f, (float)(DISPLAY_LUT_EDGE_SIZE - 1));
+
+	return co;
+}
+#endif  /* __SSE2__ */
+
+/* Transform a single straight rgb pixel through the baked LUT. */
+BLI_INLINE void display_lut_apply_pixel(const float *lut, float rgb[3])
+{
+	float co[4];
+	int x0, y0, z0, x1, y1, z1;
+
+#ifdef __SSE2__
+	{
+		const __m128 scale = _mm_set1_ps((float)(DISPLAY_LUT_EDGE_SIZE - 1) /
+		                                 (DISPLAY_LUT_MAX_EXPONENT - DISPLAY_LUT_MIN_EXPONENT));
+		/* NaN in the first argument makes _mm_max_ps return the minimum */
+		__m128 v = _mm_max_ps(_mm_setr_ps(rgb[0], rgb[1], rgb[2], DISPLAY_LUT_MIN_VALUE),
+		                      _mm_set1_ps(DISPLAY_LUT_MIN_VALUE));
+		__m128 co_v = _mm_mul_ps(_mm_sub_ps(display_lut_log2_ps(v),
+		                                    _mm_set1_ps(DISPLAY_LUT_MIN_EXPONENT)),
+		                         scale);
+
+		co_v = _mm_max_ps(co_v, _mm_setzero_ps());
+		co_v = _mm_min_ps(co_v, _mm_set1_ps((float)(DISPLAY_LUT_EDGE_SIZE - 1)));
+
+		_mm_storeu_ps(co, co_v);
+	}
+#else
+	co[0] = display_lut_apply_shaper(rgb[0]);
+	co[1] = display_lut_apply_shaper(rgb[1]);
+	co[2] = display_lut_apply_shaper(rgb[2]);
+#endif
+
+	x0 = (int)co[0];
+	y0 = (int)co[1];
+	z0 = (int)co[2];
+
+	x1 = min_ii(x0 + 1, DISPLAY_LUT_EDGE_SIZE - 1);
+	y1 = min_ii(y0 + 1, DISPLAY_LUT_EDGE_SIZE - 1);
+	z1 = min_ii(z0 + 1, DISPLAY_LUT_EDGE_SIZE - 1);
+
+#ifdef __SSE2__
+	{
+		const __m128 fx = _mm_set1_ps(co[0] - (float)x0);
+		const __m128 fy = _mm_set1_ps(co[1] - (float)y0);
+		const __m128 fz = _mm_set1_ps(co[2] - (float)z0);
+		__m128 c00, c01, c10, c11, c0, c1, c;
+		float result[4];
+
+		/* trilinear interpolation of the 4 float wide RGBX grid entries */
+#define LUT_LERP(f, a, b) _mm_add_ps(a, _mm_mul_ps(f, _mm_sub_ps(b, a)))
+		c00 = LUT_LERP(fx, _mm_loadu_ps(lut + DISPLAY_LUT_INDEX(x0, y0, z0)),
+		                   _mm_loadu_ps(lut + DISPLAY_LUT_INDEX(x1, y0, z0)));
+		c10 = LUT_LERP(fx, _mm_loadu_ps(lut + DISPLAY_LUT_INDEX(x0, y1, z0)),
+		                   _mm_loadu_ps(lut + DISPLAY_LUT_INDEX(x1, y1, z0)));
+		c01 = LUT_LERP(fx, _mm_loadu_ps(lut + DISPLAY_LUT_INDEX(x0, y0, z1)),
+		                   _mm_loadu_ps(lut + DISPLAY_LUT_INDEX(x1, y0, z1)));
+		c11 = LUT_LERP(fx, _mm_loadu_ps(lut + DISPLAY_LUT_INDEX(x0, y1, z1)),
+		                   _mm_loadu_ps(lut + DISPLAY_LUT_INDEX(x1, y1, z1)));
+
+		c0 = LUT_LERP(fy, c00, c10);
+		c1 = LUT_LERP(fy, c01, c11);
+		c = LUT_LERP(fz, c0, c1);
+#undef LUT_LERP
+
+		_mm_storeu_ps(result, c);
+
+		copy_v3_v3(rgb, result);
+	}
+#else
+	{
+		const float fx = co[0] - (float)x0;
+		const float fy = co[1] - (float)y0;
+		const float fz = co[2] - (float)z0;
+		float c00[3], c01[3], c10[3], c11[3], c0[3], c1[3];
+
+		interp_v3_v3v3(c00, lut + DISPLAY_LUT_INDEX(x0, y0, z0), lut + DISPLAY_LUT_INDEX(x1, y0, z0), fx);
+		interp_v3_v3v3(c10, lut + DISPLAY_LUT_INDEX(x0, y1, z0), lut + DISPLAY_LUT_INDEX(x1, y1, z0), fx);
+		interp_v3_v3v3(c01, lut + DISPLAY_LUT_INDEX(x0, y0, z1), lut + DISPLAY_LUT_INDEX(x1, y0, z1), fx);
+		interp_v3_v3v3(c11, lut + DISPLAY_LUT_INDEX(x0, y1, z1), lut + DISPLAY_LUT_INDEX(x1, y1, z1), fx);
+
+		interp_v3_v3v3(c0, c00, c10, fy);
+		interp_v3_v3v3(c1, c01, c11, fy);
+		interp_v3_v3v3(rgb, c0, c1, fz);
+	}
+#endif  /* __SSE2__ */
+}
+
+static void colormanage_processor_apply_display_lut(ColormanageProcessor *cm_processor, float *buffer,
+                                                    int width, int height, int channels, bool predivide)
+{
+	const float *lut = cm_processor->display_lut;
+	const size_t num_pixels = ((size_t)width) * height;
+	float *pixel = buffer;
+	size_t i;
+
+	for (i = 0; i < num_pixels; i++, pixel += channels) {
+		float rgb[3];
+
+		if (channels == 4 && predivide && pixel[3] > 0.0f && pixel[3] < 1.0f) {
+			const float alpha = pixel[3];
+			const float inv_alpha = 1.0f / alpha;
+
+			rgb[0] = pixel[0] * inv_alpha;
+			rgb[1] = pixel[1] * inv_alpha;
+			rgb[2] = pixel[2] * inv_alpha;
+
+			display_lut_apply_pixel(lut, rgb);
+
+			pixel[0] = rgb[0] * alpha;
+			pixel[1] = rgb[1] * alpha;
+			pixel[2] = rgb[2] * alpha;
+		}
+		else {
+			copy_v3_v3(rgb, pixel);
+
+			display_lut_apply_pixel(lut, rgb);
+
+			copy_v3_v3(pixel, rgb);
+		}
+	}
+}
+
+static void colormanage_processor_bake_display_lut(ColormanageProcessor *cm_processor)
+{
+	const int size = DISPLAY_LUT_EDGE_SIZE;
+	OCIO_PackedImageDesc *img;
+	float *lut, *entry;
+	int x, y, z;
+
+	if (cm_processor == NULL || cm_processor->processor == NULL)
+		return;
+
+	if (cm_processor->display_lut != NULL)
+		return;
+
+	lut = MEM_mallocN(sizeof(float) * 4 * size * size * size, "display transform 3d lut");
+
+	entry = lut;
+	for (z = 0; z < size; z++) {
+		for (y = 0; y < size; y++) {
+			for (x = 0; x < size; x++) {
+				/* inverse shaper, first sample gets exact zero so pure
+				 * black stays at the transformed black level
+				 */
+				entry[0] = (x == 0) ? 0.0f : powf(2.0f, DISPLAY_LUT_MIN_EXPONENT +
+				                                  (DISPLAY_LUT_MAX_EXPONENT - DISPLAY_LUT_MIN_EXPONENT) *
+				                                  ((float)x / (size - 1)));
+				entry[1] = (y == 0) ? 0.0f : powf(2.0f, DISPLAY_LUT_MIN_EXPONENT +
+				                                  (DISPLAY_LUT_MAX_EXPONENT - DISPLAY_LUT_MIN_EXPONENT) *
+				                                  ((float)y / (size - 1)));
+				entry[2] = (z == 0) ? 0.0f : powf(2.0f, DISPLAY_LUT_MIN_EXPONENT +
+				                                  (DISPLAY_LUT_MAX_EXPONENT - DISPLAY_LUT_MIN_EXPONENT) *
+				                                  ((float)z / (size - 1)));
+				entry[3] = 1.0f;
+
+				entry += 4;
+			}
+		}
+	}
+
+	img = OCIO_createOCIO_PackedImageDesc(lut, size * size, size, 4, sizeof(float),
+	                                      4 * sizeof(float),
+	                                      4 * sizeof(float) * size * size);
+
+	OCIO_processorApply(cm_processor->processor, img);
+
+	OCIO_PackedImageDescRelease(img);
+
+	cm_processor->display_lut = lut;
+}
+
 /*********************** Threaded display buffer transform routines *************************/
 
 typedef struct DisplayBufferThread {
@@ -1492,6 +1748,12 @@ static void display_buffer_apply_threaded(ImBuf *ibuf, float *buffer, unsigned c
 		init_data.float_colorspace = NULL;
 	}
 
+	/* bake the processor into a LUT before the threads start pulling from it,
+	 * small buffers are cheaper to transform exactly
+	 */
+	if (cm_processor != NULL && ((size_t)ibuf->x) * ibuf->y >= DISPLAY_LUT_BAKE_THRESHOLD)
+		colormanage_processor_bake_display_lut(cm_processor);
+
 	IMB_processor_apply_threaded(ibuf->y, sizeof(DisplayBufferThread), &init_data,
 	                             display_buffer_init_handle, do_display_buffer_apply_thread);
 }
@@ -2025,23 +2287,27 @@ unsigned char *IMB_display_buffer_acquire(ImBuf *ibuf, const ColorManagedViewSet
 	colormanage_view_settings_to_cache(ibuf, &cache_view_settings, applied_view_settings);
 	colormanage_display_settings_to_cache(&cache_display_settings, display_settings);
 
-	if (ibuf->invalid_rect.xmin != ibuf->invalid_rect.xmax) {
+	if (ibuf->invalid_rect_tot) {
 		if ((ibuf->userflags & IB_DISPLAY_BUFFER_INVALID) == 0) {
-			IMB_partial_display_buffer_update_threaded(ibuf,
-			                                           ibuf->rect_float,
-			                                           (unsigned char *) ibuf->rect,
-			                                           ibuf->x,
-			                                           0, 0,
-			                                           applied_view_settings,
-			                                           display_settings,
-			                                           ibuf->invalid_rect.xmin,
-			                                           ibuf->invalid_rect.ymin,
-			                                           ibuf->invalid_rect.xmax,
-			                                           ibuf->invalid_rect.ymax,
-			                                           false);
+			int a;
+			for (a = 0; a < ibuf->invalid_rect_tot; a++) {
+				const rcti *rect = &ibuf->invalid_rects[a];
+				IMB_partial_display_buffer_update_threaded(ibuf,
+				                                           ibuf->rect_float,
+				                                           (unsigned char *) ibuf->rect,
+				                                           ibuf->x,
+				                                           0, 0,
+				                                           applied_view_settings,
+				                                           display_settings,
+				                                           rect->xmin,
+				                                           rect->ymin,
+				                                           rect->xmax,
+				                                           rect->ymax,
+				                                           false);
+			}
 		}
 
-		BLI_rcti_init(&ibuf->invalid_rect, 0, 0, 0, 0);
+		ibuf->invalid_rect_tot = 0;
 	}
 
 	BLI_lock_thread(LOCK_COLORMANAGE);
@@ -2952,13 +3218,43 @@ void IMB_partial_display_buffer_update_threaded(struct ImBuf *ibuf,
 
 void IMB_partial_display_buffer_update_delayed(ImBuf *ibuf, int xmin, int ymin, int xmax, int ymax)
 {
-	if (ibuf->invalid_rect.xmin == ibuf->invalid_rect.xmax) {
-		BLI_rcti_init(&ibuf->invalid_rect, xmin, xmax, ymin, ymax);
+	rcti rect;
+	int a;
+
+	BLI_rcti_init(&rect, xmin, xmax, ymin, ymax);
+
+	/* consecutive stroke dabs usually overlap, grow an existing rect then so
+	 * separated paint areas don't union into one frame-sized update */
+	for (a = 0; a < ibuf->invalid_rect_tot; a++) {
+		if (BLI_rcti_isect(&ibuf->invalid_rects[a], &rect, NULL)) {
+			BLI_rcti_union(&ibuf->invalid_rects[a], &rect);
+			return;
+		}
+	}
+
+	if (ibuf->invalid_rect_tot < IMB_INVALID_RECTS) {
+		ibuf->invalid_rects[ibuf->invalid_rect_tot++] = rect;
 	}
 	else {
-		rcti rect;
-		BLI_rcti_init(&rect, xmin, xmax, ymin, ymax);
-		BLI_rcti_union(&ibuf->invalid_rect, &rect);
+		/* all slots taken, union into the rect which grows the least */
+		int best = 0;
+		size_t best_cost = SIZE_MAX;
+
+		for (a = 0; a < ibuf->invalid_rect_tot; a++) {
+			rcti merged = ibuf->invalid_rects[a];
+			size_t cost;
+
+			BLI_rcti_union(&merged, &rect);
+			cost = ((size_t)BLI_rcti_size_x(&merged)) * BLI_rcti_size_y(&merged) -
+			       ((size_t)BLI_rcti_size_x(&ibuf->invalid_rects[a])) * BLI_rcti_size_y(&ibuf->invalid_rects[a]);
+
+			if (cost < best_cost) {
+				best_cost = cost;
+				best = a;
+			}
+		}
+
+		BLI_rcti_union(&ibuf->invalid_rects[best], &rect);
 	}
 }
 
@@ -3080,6 +3376,12 @@ void IMB_colormanagement_processor_apply(ColormanageProcessor *cm_processor, flo
 	if (cm_processor->processor && channels >= 3) {
 		OCIO_PackedImageDesc *img;
 
+		if (cm_processor->display_lut && ELEM(channels, 3, 4)) {
+			colormanage_processor_apply_display_lut(cm_processor, buffer, width, height,
+			                                        channels, predivide);
+			return;
+		}
+
 		/* apply OCIO processor */
 		img = OCIO_createOCIO_PackedImageDesc(
 		        buffer, width, height, channels, sizeof(float),
@@ -3101,6 +3403,8 @@ void IMB_colormanagement_processor_free(ColormanageProcessor *cm_processor)
 		curvemapping_free(cm_processor->curve_mapping);
 	if (cm_processor->processor)
 		OCIO_processorRelease(cm_processor->processor);
+	if (cm_processor->display_lut)
+		MEM_freeN(cm_processor->display_lut);
 
 	MEM_freeN(cm_processor);
 }
@@ -576,6 +576,51 @@ void IMB_makemipmap(ImBuf *ibuf, int use_filter)
 	}
 }
 
+/* Refresh an already built pyramid inside a rectangle only, for interactive
+ * painting where rebuilding all levels of an 8k image is far too slow.
+ *
+ * Levels are recomputed from the previous level with the same 2x2 box average
+ * as imb_onehalf_no_alloc, without the optional pre-filter pass: the quality
+ * difference is invisible for localized stroke updates and avoids filtering
+ * the full image. Falls back to a full level update once a level gets
+ * degenerate (width or height 1). */
+void IMB_makemipmap_partial(ImBuf *ibuf, int x, int y, int w, int h)
+{
+	ImBuf *prev = ibuf;
+	int curmap;
+	int x1 = x, y1 = y, x2 = x + w, y2 = y + h;
+
+	for (curmap = 0; curmap < ibuf->miptot - 1; curmap++) {
+		ImBuf *mip = ibuf->mipmap[curmap];
+
+		if (mip == NULL)
+			break;
+
+		if (prev->x <= 1 || prev->y <= 1) {
+			/* degenerate level, plain onehalf handles the 1 pixel rows/columns */
+			imb_onehalf_no_alloc(mip, prev);
+			prev = mip;
+			x1 = y1 = 0;
+			x2 = mip->x;
+			y2 = mip->y;
+			continue;
+		}
+
+		/* halve the dirty rectangle, expanding to cover partially dirty pixels */
+		x1 = x1 / 2;
+		y1 = y1 / 2;
+		x2 = MIN2((x2 + 1) / 2, mip->x);
+		y2 = MIN2((y2 + 1) / 2, mip->y);
+
+		if (x1 >= x2 || y1 >= y2)
+			break;
+
+		imb_onehalf_partial_no_alloc(mip, prev, x1, y1, x2, y2);
+
+		prev = mip;
+	}
+}
+
 ImBuf *IMB_getmipmap(ImBuf *ibuf, int level)
 {
 	CLAMP(level, 0, ibuf->miptot - 1);
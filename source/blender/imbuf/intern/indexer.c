@@ -36,6 +36,7 @@
 #include "BLI_string.h"
 #include "BLI_fileops.h"
 #include "BLI_ghash.h"
+#include "BLI_task.h"
 
 #include "IMB_indexer.h"
 #include "IMB_anim.h"
@@ -842,8 +843,20 @@ static void index_rebuild_ffmpeg_finish(FFmpegIndexBuilderContext *context, int
 	MEM_freeN(context);
 }
 
+typedef struct ProxyEncodeTaskData {
+	FFmpegIndexBuilderContext *context;
+	AVFrame *in_frame;
+} ProxyEncodeTaskData;
+
+static void index_rebuild_ffmpeg_proxy_task_cb(void *userdata, const int i)
+{
+	ProxyEncodeTaskData *data = userdata;
+
+	add_to_proxy_output_ffmpeg(data->context->proxy_ctx[i], data->in_frame);
+}
+
 static void index_rebuild_ffmpeg_proc_decoded_frame(
-	FFmpegIndexBuilderContext *context, 
+	FFmpegIndexBuilderContext *context,
 	AVPacket * curr_packet,
 	AVFrame *in_frame)
 {
@@ -851,10 +864,16 @@ static void index_rebuild_ffmpeg_proc_decoded_frame(
 	unsigned long long s_pos = context->seek_pos;
 	unsigned long long s_dts = context->seek_pos_dts;
 	unsigned long long pts = av_get_pts_from_frame(context->iFormatCtx, in_frame);
+	ProxyEncodeTaskData task_data;
 
-	for (i = 0; i < context->num_proxy_sizes; i++) {
-		add_to_proxy_output_ffmpeg(context->proxy_ctx[i], in_frame);
-	}
+	task_data.context = context;
+	task_data.in_frame = in_frame;
+
+	/* all proxy sizes scale and encode from the same decoded frame and write
+	 * to their own files, so they can run concurrently */
+	BLI_task_parallel_range(0, context->num_proxy_sizes, &task_data,
+	                        index_rebuild_ffmpeg_proxy_task_cb,
+	                        (context->num_proxy_sizes > 1));
 
 	if (!context->start_pts_set) {
 		context->start_pts = pts;
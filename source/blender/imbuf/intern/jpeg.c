@@ -67,6 +67,10 @@ static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int fla
 static const uchar jpeg_default_quality = 75;
 static uchar ibuf_quality;
 
+/* smallest long side to keep when decoding with IB_thumbnail, twice the
+ * largest thumbnail size so scaling down stays lossless enough */
+#define JPEG_THUMB_MIN_SIZE 512
+
 int imb_is_a_jpeg(const unsigned char *mem)
 {
 	if ((mem[0] == 0xFF) && (mem[1] == 0xD8)) return 1;
@@ -271,12 +275,19 @@ static boolean handle_app1(j_decompress_ptr cinfo)
 }
 
 
+/* How many scanlines to pull out of the decoder per call. Decoding stays
+ * sequential (the entropy decoder carries state across restart intervals in
+ * libjpeg), but reading row groups amortizes the per-call overhead.
+ */
+#define JPEG_MAX_READ_ROWS 16
+
 static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int flags)
 {
 	JSAMPARRAY row_pointer;
 	JSAMPLE *buffer = NULL;
 	int row_stride;
 	int x, y, depth, r, g, b, k;
+	int row, num_rows;
 	struct ImBuf *ibuf = NULL;
 	uchar *rect;
 	jpeg_saved_marker_ptr marker;
@@ -295,8 +306,25 @@ static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int fla
 
 		if (cinfo->jpeg_color_space == JCS_YCCK) cinfo->out_color_space = JCS_CMYK;
 
+		if ((flags & IB_thumbnail) && !(flags & IB_test)) {
+			/* decode at reduced size using DCT scaling, the result gets scaled
+			 * down to thumbnail size afterwards anyway so a 512 pixel long
+			 * side keeps full quality while skipping most of the idct work */
+			while (cinfo->scale_denom < 8 &&
+			       MAX2(x, y) / (cinfo->scale_denom * 2) >= JPEG_THUMB_MIN_SIZE)
+			{
+				cinfo->scale_denom *= 2;
+			}
+		}
+
 		jpeg_start_decompress(cinfo);
 
+		if (!(flags & IB_test)) {
+			/* equal to the image size unless DCT scaling kicked in */
+			x = cinfo->output_width;
+			y = cinfo->output_height;
+		}
+
 		if (flags & IB_test) {
 			jpeg_abort_decompress(cinfo);
 			ibuf = IMB_allocImBuf(x, y, 8 * depth, 0);
@@ -307,48 +335,54 @@ static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int fla
 		else {
 			row_stride = cinfo->output_width * depth;
 
-			row_pointer = (*cinfo->mem->alloc_sarray)((j_common_ptr) cinfo, JPOOL_IMAGE, row_stride, 1);
-			
-			for (y = ibuf->y - 1; y >= 0; y--) {
-				jpeg_read_scanlines(cinfo, row_pointer, 1);
-				rect = (uchar *) (ibuf->rect + y * ibuf->x);
-				buffer = row_pointer[0];
-				
-				switch (depth) {
-					case 1:
-						for (x = ibuf->x; x > 0; x--) {
-							rect[3] = 255;
-							rect[0] = rect[1] = rect[2] = *buffer++;
-							rect += 4;
-						}
-						break;
-					case 3:
-						for (x = ibuf->x; x > 0; x--) {
-							rect[3] = 255;
-							rect[0] = *buffer++;
-							rect[1] = *buffer++;
-							rect[2] = *buffer++;
-							rect += 4;
-						}
-						break;
-					case 4:
-						for (x = ibuf->x; x > 0; x--) {
-							r = *buffer++;
-							g = *buffer++;
-							b = *buffer++;
-							k = *buffer++;
-
-							r = (r * k) / 255;
-							g = (g * k) / 255;
-							b = (b * k) / 255;
-
-							rect[3] = 255;
-							rect[2] = b;
-							rect[1] = g;
-							rect[0] = r;
-							rect += 4;
-						}
-						break;
+			row_pointer = (*cinfo->mem->alloc_sarray)((j_common_ptr) cinfo, JPOOL_IMAGE, row_stride, JPEG_MAX_READ_ROWS);
+
+			for (y = ibuf->y - 1; y >= 0; ) {
+				num_rows = jpeg_read_scanlines(cinfo, row_pointer, JPEG_MAX_READ_ROWS);
+				if (num_rows == 0) {
+					break;
+				}
+
+				for (row = 0; row < num_rows; row++, y--) {
+					rect = (uchar *) (ibuf->rect + y * ibuf->x);
+					buffer = row_pointer[row];
+
+					switch (depth) {
+						case 1:
+							for (x = ibuf->x; x > 0; x--) {
+								rect[3] = 255;
+								rect[0] = rect[1] = rect[2] = *buffer++;
+								rect += 4;
+							}
+							break;
+						case 3:
+							for (x = ibuf->x; x > 0; x--) {
+								rect[3] = 255;
+								rect[0] = *buffer++;
+								rect[1] = *buffer++;
+								rect[2] = *buffer++;
+								rect += 4;
+							}
+							break;
+						case 4:
+							for (x = ibuf->x; x > 0; x--) {
+								r = *buffer++;
+								g = *buffer++;
+								b = *buffer++;
+								k = *buffer++;
+
+								r = (r * k) / 255;
+								g = (g * k) / 255;
+								b = (b * k) / 255;
+
+								rect[3] = 255;
+								rect[2] = b;
+								rect[1] = g;
+								rect[0] = r;
+								rect += 4;
+							}
+							break;
+					}
 				}
 			}
 
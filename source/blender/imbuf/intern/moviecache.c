@@ -37,6 +37,8 @@
 #include "MEM_guardedalloc.h"
 #include "MEM_CacheLimiterC-Api.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_string.h"
 #include "BLI_utildefines.h"
 #include "BLI_ghash.h"
@@ -61,6 +63,23 @@
 static MEM_CacheLimiterC *limitor = NULL;
 static pthread_mutex_t limitor_lock = BLI_MUTEX_INITIALIZER;
 
+/* Each priority band gets its own window of the limiter's priority space,
+ * per-item priorities from the callbacks are clamped into that window so a
+ * lower band can never outrank a higher one.
+ */
+#define MOVIECACHE_BAND_STEP (1 << 24)
+
+/* Proportional shares of the global cache limit per priority band. Bands
+ * borrow memory from each other freely while they stay under their share,
+ * buffers of a band which went over it are evicted before anything else.
+ */
+static const int band_share_percent[MOVIECACHE_NUM_BANDS] = {10, 30, 60};
+
+/* updated atomically, eviction can run from the limiter with only
+ * limitor_lock held while other caches are being freed
+ */
+static size_t band_mem_in_use[MOVIECACHE_NUM_BANDS] = {0, 0, 0};
+
 typedef struct MovieCache {
 	char name[64];
 
@@ -78,6 +97,13 @@ typedef struct MovieCache {
 	struct BLI_mempool *userkeys_pool;
 
 	int keysize;
+	int priority_band;
+
+	/* playback window which is kept in memory regardless of eviction
+	 * priorities, only usable when a getdata callback is set
+	 */
+	bool use_pinned_range;
+	int pinned_range[2];
 
 	void *last_userkey;
 
@@ -95,6 +121,9 @@ typedef struct MovieCacheItem {
 	ImBuf *ibuf;
 	MEM_CacheLimiterHandleC *c_handle;
 	void *priority_data;
+
+	size_t size;  /* size of the buffer when it was put, for band accounting */
+	int framenr;  /* frame number from the getdata callback, for pinned ranges */
 } MovieCacheItem;
 
 static unsigned int moviecache_hashhash(const void *keyv)
@@ -131,6 +160,8 @@ static void moviecache_valfree(void *val)
 	if (item->ibuf) {
 		MEM_CacheLimiter_unmanage(item->c_handle);
 		IMB_freeImBuf(item->ibuf);
+
+		atomic_sub_z(&band_mem_in_use[cache->priority_band], item->size);
 	}
 
 	if (item->priority_data && cache->prioritydeleterfp) {
@@ -182,8 +213,11 @@ static void IMB_moviecache_destructor(void *p)
 
 		IMB_freeImBuf(item->ibuf);
 
+		atomic_sub_z(&band_mem_in_use[cache->priority_band], item->size);
+
 		item->ibuf = NULL;
 		item->c_handle = NULL;
+		item->size = 0;
 
 		/* force cached segments to be updated */
 		if (cache->points) {
@@ -246,19 +280,48 @@ static size_t get_item_size(void *p)
 	return size;
 }
 
+/* size of the global cache limit a band may occupy before its buffers are
+ * demoted below all other bands, 0 means the band is not limited
+ */
+static size_t get_band_budget(int priority_band)
+{
+	size_t mem_limit = MEM_CacheLimiter_get_maximum();
+
+	if (mem_limit == 0)
+		return 0;
+
+	return (mem_limit / 100) * band_share_percent[priority_band];
+}
+
 static int get_item_priority(void *item_v, int default_priority)
 {
 	MovieCacheItem *item = (MovieCacheItem *) item_v;
 	MovieCache *cache = item->cache_owner;
+	size_t band_budget;
 	int priority;
 
 	if (!cache->getitempriorityfp) {
 		PRINT("%s: cache '%s' item %p use default priority %d\n", __func__, cache-> name, item, default_priority);
 
-		return default_priority;
+		priority = default_priority;
+	}
+	else {
+		priority = cache->getitempriorityfp(cache->last_userkey, item->priority_data);
 	}
 
-	priority = cache->getitempriorityfp(cache->last_userkey, item->priority_data);
+	/* offset the priority into the cache's band, so items from lower
+	 * bands are always evicted before items from higher bands
+	 */
+	CLAMP(priority, -MOVIECACHE_BAND_STEP / 2, MOVIECACHE_BAND_STEP / 2 - 1);
+	priority += cache->priority_band * MOVIECACHE_BAND_STEP;
+
+	/* bands which went over their share of the global limit are demoted
+	 * below everything else, in their original relative order
+	 */
+	band_budget = get_band_budget(cache->priority_band);
+	if (band_budget != 0 && band_mem_in_use[cache->priority_band] > band_budget) {
+		priority -= MOVIECACHE_NUM_BANDS * MOVIECACHE_BAND_STEP;
+	}
 
 	PRINT("%s: cache '%s' item %p priority %d\n", __func__, cache-> name, item, priority);
 
@@ -268,6 +331,16 @@ static int get_item_priority(void *item_v, int default_priority)
 static bool get_item_destroyable(void *item_v)
 {
 	MovieCacheItem *item = (MovieCacheItem *) item_v;
+	MovieCache *cache = item->cache_owner;
+
+	/* frames of a pinned playback window stay in memory */
+	if (cache->use_pinned_range &&
+	    item->framenr >= cache->pinned_range[0] &&
+	    item->framenr <= cache->pinned_range[1])
+	{
+		return false;
+	}
+
 	/* IB_BITMAPDIRTY means image was modified from inside blender and
 	 * changes are not saved to disk.
 	 *
@@ -314,6 +387,7 @@ MovieCache *IMB_moviecache_create(const char *name, int keysize, GHashHashFP has
 	cache->hashfp = hashfp;
 	cache->cmpfp = cmpfp;
 	cache->proxy = -1;
+	cache->priority_band = MOVIECACHE_BAND_MOVIECLIP;
 
 	return cache;
 }
@@ -334,6 +408,28 @@ void IMB_moviecache_set_priority_callback(struct MovieCache *cache, MovieCacheGe
 	cache->prioritydeleterfp = prioritydeleterfp;
 }
 
+void IMB_moviecache_set_priority_band(MovieCache *cache, int priority_band)
+{
+	BLI_assert(priority_band >= 0 && priority_band < MOVIECACHE_NUM_BANDS);
+
+	cache->priority_band = priority_band;
+}
+
+void IMB_moviecache_pin_frame_range(MovieCache *cache, int start_frame, int end_frame)
+{
+	/* without a getdata callback items have no frame number to test against */
+	BLI_assert(cache->getdatafp != NULL);
+
+	cache->use_pinned_range = true;
+	cache->pinned_range[0] = start_frame;
+	cache->pinned_range[1] = end_frame;
+}
+
+void IMB_moviecache_unpin_frame_range(MovieCache *cache)
+{
+	cache->use_pinned_range = false;
+}
+
 static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, bool need_lock)
 {
 	MovieCacheKey *key;
@@ -357,11 +453,21 @@ static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, boo
 	item->cache_owner = cache;
 	item->c_handle = NULL;
 	item->priority_data = NULL;
+	item->size = sizeof(MovieCacheItem) + IMB_get_size_in_memory(ibuf);
+	item->framenr = 0;
 
 	if (cache->getprioritydatafp) {
 		item->priority_data = cache->getprioritydatafp(userkey);
 	}
 
+	if (cache->getdatafp) {
+		int proxy, render_flags;
+
+		cache->getdatafp(userkey, &item->framenr, &proxy, &render_flags);
+	}
+
+	atomic_add_z(&band_mem_in_use[cache->priority_band], item->size);
+
 	BLI_ghash_reinsert(cache->hash, key, item, moviecache_keyfree, moviecache_valfree);
 
 	if (cache->last_userkey) {
@@ -61,6 +61,7 @@
 #include <ImfInputPart.h>
 #include <ImfOutputPart.h>
 #include <ImfMultiPartOutputFile.h>
+#include <ImfTiledInputPart.h>
 #include <ImfTiledOutputPart.h>
 #include <ImfPartType.h>
 #include <ImfPartHelper.h>
@@ -87,6 +88,7 @@ _CRTIMP void __cdecl _invalid_parameter_noinfo(void)
 
 #include "BLI_blenlib.h"
 #include "BLI_math_color.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BKE_idprop.h"
@@ -373,6 +375,55 @@ static void openexr_header_metadata_callback(void *data, const char *propname, c
 }
 
 
+/* scanline conversion to half storage, threaded over the image height since
+ * for large frames this repack is a significant part of the save time */
+
+typedef struct SaveHalfConvertData {
+	RGBAZ *pixels;
+	const float *rect_float;
+	const unsigned char *rect_byte;
+	int width;
+	int height;
+	int channels;
+} SaveHalfConvertData;
+
+static void imb_save_openexr_half_from_float_cb(void *userdata, const int scanline)
+{
+	SaveHalfConvertData *convert_data = (SaveHalfConvertData *)userdata;
+	const int width = convert_data->width;
+	const int channels = convert_data->channels;
+	/* output rows are stored top to bottom, source buffer is bottom to top */
+	const float *from = convert_data->rect_float +
+	                    (size_t)channels * (convert_data->height - 1 - scanline) * width;
+	RGBAZ *to = convert_data->pixels + (size_t)scanline * width;
+
+	for (int j = width; j > 0; j--) {
+		to->r = from[0];
+		to->g = (channels >= 2) ? from[1] : from[0];
+		to->b = (channels >= 3) ? from[2] : from[0];
+		to->a = (channels >= 4) ? from[3] : 1.0f;
+		to++; from += channels;
+	}
+}
+
+static void imb_save_openexr_half_from_byte_cb(void *userdata, const int scanline)
+{
+	SaveHalfConvertData *convert_data = (SaveHalfConvertData *)userdata;
+	const int width = convert_data->width;
+	const int channels = convert_data->channels;
+	const unsigned char *from = convert_data->rect_byte +
+	                            (size_t)4 * (convert_data->height - 1 - scanline) * width;
+	RGBAZ *to = convert_data->pixels + (size_t)scanline * width;
+
+	for (int j = width; j > 0; j--) {
+		to->r = srgb_to_linearrgb((float)from[0] / 255.0f);
+		to->g = srgb_to_linearrgb((float)from[1] / 255.0f);
+		to->b = srgb_to_linearrgb((float)from[2] / 255.0f);
+		to->a = channels >= 4 ? (float)from[3] / 255.0f : 1.0f;
+		to++; from += 4;
+	}
+}
+
 static bool imb_save_openexr_half(
         ImBuf *ibuf, const char *name, const int flags, const int totviews,
         const char * (*getview)(void *base, int view_id),
@@ -447,35 +498,23 @@ static bool imb_save_openexr_half(
 			if (is_zbuf)
 				frameBuffer.insert(insertViewName("Z", views, view_id), Slice(Imf::FLOAT, (char *)(view_ibuf->zbuf_float + (height - 1) * width),
 				                   sizeof(float), sizeof(float) * -width));
-			if (view_ibuf->rect_float) {
-				float *from;
+			SaveHalfConvertData convert_data;
+			convert_data.pixels = to;
+			convert_data.rect_float = view_ibuf->rect_float;
+			convert_data.rect_byte = (unsigned char *)view_ibuf->rect;
+			convert_data.width = width;
+			convert_data.height = height;
+			convert_data.channels = channels;
 
-				for (int i = view_ibuf->y - 1; i >= 0; i--) {
-					from = view_ibuf->rect_float + channels * i * width;
-
-					for (int j = view_ibuf->x; j > 0; j--) {
-						to->r = from[0];
-						to->g = (channels >= 2) ? from[1] : from[0];
-						to->b = (channels >= 3) ? from[2] : from[0];
-						to->a = (channels >= 4) ? from[3] : 1.0f;
-						to++; from += channels;
-					}
-				}
+			if (view_ibuf->rect_float) {
+				BLI_task_parallel_range(0, height, &convert_data,
+				                        imb_save_openexr_half_from_float_cb,
+				                        ((size_t)width * height > 65536));
 			}
 			else {
-				unsigned char *from;
-
-				for (int i = view_ibuf->y - 1; i >= 0; i--) {
-					from = (unsigned char *)view_ibuf->rect + 4 * i * width;
-
-					for (int j = view_ibuf->x; j > 0; j--) {
-						to->r = srgb_to_linearrgb((float)from[0] / 255.0f);
-						to->g = srgb_to_linearrgb((float)from[1] / 255.0f);
-						to->b = srgb_to_linearrgb((float)from[2] / 255.0f);
-						to->a = channels >= 4 ? (float)from[3] / 255.0f : 1.0f;
-						to++; from += 4;
-					}
-				}
+				BLI_task_parallel_range(0, height, &convert_data,
+				                        imb_save_openexr_half_from_byte_cb,
+				                        ((size_t)width * height > 65536));
 			}
 
 			if (is_multiview)
@@ -1094,6 +1133,28 @@ void IMB_exr_clear_channels(void *handle)
 	BLI_freelistN(&data->channels);
 }
 
+/* conversion of one channel to half storage, threaded over the channels of
+ * the multilayer file since they are independent */
+
+typedef struct ExrHalfConvertData {
+	ExrChannel **channels;
+	half **rects_half;
+	size_t num_pixels;
+} ExrHalfConvertData;
+
+static void imb_exr_write_channel_convert_half_cb(void *userdata, const int n)
+{
+	ExrHalfConvertData *convert_data = (ExrHalfConvertData *)userdata;
+	ExrChannel *echan = convert_data->channels[n];
+	const float *rect = echan->rect;
+	half *cur = convert_data->rects_half[n];
+	const size_t num_pixels = convert_data->num_pixels;
+
+	for (size_t i = 0; i < num_pixels; ++i, ++cur) {
+		*cur = rect[i * echan->xstride];
+	}
+}
+
 void IMB_exr_write_channels(void *handle)
 {
 	ExrHandle *data = (ExrHandle *)handle;
@@ -1102,22 +1163,27 @@ void IMB_exr_write_channels(void *handle)
 
 	if (data->channels.first) {
 		const size_t num_pixels = ((size_t)data->width) * data->height;
-		half *rect_half = NULL, *current_rect_half;
+		half *rect_half = NULL, *current_rect_half = NULL;
+		ExrHalfConvertData convert_data;
+		int num_half_channels = 0;
 
 		/* We allocate teporary storage for half pixels for all the channels at once. */
 		if (data->num_half_channels != 0) {
 			rect_half = (half *)MEM_mallocN(sizeof(half) * data->num_half_channels * num_pixels, __func__);
 			current_rect_half = rect_half;
+			convert_data.channels = (ExrChannel **)MEM_mallocN(sizeof(ExrChannel *) * data->num_half_channels, __func__);
+			convert_data.rects_half = (half **)MEM_mallocN(sizeof(half *) * data->num_half_channels, __func__);
+			convert_data.num_pixels = num_pixels;
 		}
 
 		for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
 			/* Writting starts from last scanline, stride negative. */
 			if (echan->use_half_float) {
-				float *rect = echan->rect;
-				half *cur = current_rect_half;
-				for (size_t i = 0; i < num_pixels; ++i, ++cur) {
-					*cur = rect[i * echan->xstride];
-				}
+				/* conversion to half is threaded below, only assign buffers here */
+				convert_data.channels[num_half_channels] = echan;
+				convert_data.rects_half[num_half_channels] = current_rect_half;
+				num_half_channels++;
+
 				half *rect_to_write = current_rect_half + (data->height - 1) * data->width;
 				frameBuffer.insert(echan->name, Slice(Imf::HALF,  (char *)rect_to_write,
 				                                      sizeof(half), -data->width * sizeof(half)));
@@ -1130,6 +1196,12 @@ void IMB_exr_write_channels(void *handle)
 			}
 		}
 
+		if (num_half_channels != 0) {
+			BLI_task_parallel_range(0, num_half_channels, &convert_data,
+			                        imb_exr_write_channel_convert_half_cb,
+			                        (num_half_channels > 1));
+		}
+
 		data->ofile->setFrameBuffer(frameBuffer);
 		try {
 			data->ofile->writePixels(data->height);
@@ -1140,6 +1212,8 @@ void IMB_exr_write_channels(void *handle)
 		/* Free temporary buffers. */
 		if (rect_half != NULL) {
 			MEM_freeN(rect_half);
+			MEM_freeN(convert_data.channels);
+			MEM_freeN(convert_data.rects_half);
 		}
 	}
 	else {
@@ -2101,6 +2175,208 @@ struct ImBuf *imb_load_openexr(const unsigned char *mem, size_t size, int flags,
 
 }
 
+struct ImBuf *imb_load_openexr_region(const unsigned char *mem, size_t size, int flags, int miplevel,
+                                      int x, int y, int width, int height, char *colorspace)
+{
+	struct ImBuf *ibuf = NULL;
+	Mem_IStream *membuf = NULL;
+	MultiPartInputFile *file = NULL;
+
+	if (imb_is_a_openexr(mem) == 0) return(NULL);
+
+	colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_FLOAT);
+
+	try
+	{
+		membuf = new Mem_IStream((unsigned char *)mem, size);
+		file = new MultiPartInputFile(*membuf);
+
+		if (imb_exr_is_multi(*file)) {
+			/* multilayer region reads are not supported, the caller
+			 * falls back to a full load */
+			delete file;
+			delete membuf;
+			return(NULL);
+		}
+
+		const Header &header = file->header(0);
+		const bool is_tiled = header.hasTileDescription();
+		const bool has_rgb = exr_has_rgb(*file);
+		const bool has_luma = exr_has_luma(*file);
+		const int is_alpha = exr_has_alpha(*file);
+
+		/* data window of the level that is read */
+		Box2i ldw;
+
+		if (is_tiled) {
+			TiledInputPart in(*file, 0);
+
+			if (header.tileDescription().mode == MIPMAP_LEVELS) {
+				if (miplevel < 0) miplevel = 0;
+				if (miplevel > in.numLevels() - 1) miplevel = in.numLevels() - 1;
+			}
+			else {
+				miplevel = 0;
+			}
+
+			ldw = in.dataWindowForLevel(miplevel);
+		}
+		else {
+			/* scanline files only have the full resolution level */
+			miplevel = 0;
+			ldw = header.dataWindow();
+		}
+
+		const int level_width  = ldw.max.x - ldw.min.x + 1;
+		const int level_height = ldw.max.y - ldw.min.y + 1;
+
+		/* clamp the region against the level */
+		if (x < 0) { width += x; x = 0; }
+		if (y < 0) { height += y; y = 0; }
+		if (x + width > level_width) width = level_width - x;
+		if (y + height > level_height) height = level_height - y;
+
+		if (width <= 0 || height <= 0) {
+			delete file;
+			delete membuf;
+			return(NULL);
+		}
+
+		/* region in file coordinates, ImBuf rows count from the bottom */
+		const int fx1 = ldw.min.x + x;
+		const int fx2 = fx1 + width - 1;
+		const int fy1 = ldw.min.y + (level_height - (y + height));
+		const int fy2 = fy1 + height - 1;
+
+		/* the library decodes whole scanlines and whole tiles, so the frame
+		 * buffer has to cover everything the touched blocks write */
+		int ax1, ax2, ay1, ay2;
+		int tx1 = 0, tx2 = 0, ty1 = 0, ty2 = 0;
+
+		if (is_tiled) {
+			const TileDescription &td = header.tileDescription();
+
+			tx1 = (fx1 - ldw.min.x) / (int)td.xSize;
+			tx2 = (fx2 - ldw.min.x) / (int)td.xSize;
+			ty1 = (fy1 - ldw.min.y) / (int)td.ySize;
+			ty2 = (fy2 - ldw.min.y) / (int)td.ySize;
+
+			ax1 = ldw.min.x + tx1 * (int)td.xSize;
+			ax2 = ldw.min.x + (tx2 + 1) * (int)td.xSize - 1;
+			ay1 = ldw.min.y + ty1 * (int)td.ySize;
+			ay2 = ldw.min.y + (ty2 + 1) * (int)td.ySize - 1;
+
+			if (ax2 > ldw.max.x) ax2 = ldw.max.x;
+			if (ay2 > ldw.max.y) ay2 = ldw.max.y;
+		}
+		else {
+			ax1 = ldw.min.x;
+			ax2 = ldw.max.x;
+			ay1 = fy1;
+			ay2 = fy2;
+		}
+
+		const int aligned_width  = ax2 - ax1 + 1;
+		const int aligned_height = ay2 - ay1 + 1;
+
+		ibuf = IMB_allocImBuf(aligned_width, aligned_height, is_alpha ? 32 : 24, 0);
+		ibuf->ftype = IMB_FTYPE_OPENEXR;
+
+		imb_addrectfloatImBuf(ibuf);
+
+		FrameBuffer frameBuffer;
+		float *first;
+		int xstride = sizeof(float) * 4;
+		int ystride = -xstride * aligned_width;
+
+		/* inverse correct first pixel for the aligned window (- ay1 because of y flip) */
+		first = ibuf->rect_float - 4 * (ax1 - ay1 * aligned_width);
+		/* but, since we read y-flipped (negative y stride) we move to last scanline */
+		first += 4 * (aligned_height - 1) * aligned_width;
+
+		if (has_rgb) {
+			frameBuffer.insert(exr_rgba_channelname(*file, "R"),
+			                   Slice(Imf::FLOAT,  (char *) first, xstride, ystride));
+			frameBuffer.insert(exr_rgba_channelname(*file, "G"),
+			                   Slice(Imf::FLOAT,  (char *) (first + 1), xstride, ystride));
+			frameBuffer.insert(exr_rgba_channelname(*file, "B"),
+			                   Slice(Imf::FLOAT,  (char *) (first + 2), xstride, ystride));
+		}
+		else if (has_luma) {
+			frameBuffer.insert(exr_rgba_channelname(*file, "Y"),
+			                   Slice(Imf::FLOAT,  (char *) first, xstride, ystride));
+			frameBuffer.insert(exr_rgba_channelname(*file, "BY"),
+			                   Slice(Imf::FLOAT,  (char *) (first + 1), xstride, ystride, 1, 1, 0.5f));
+			frameBuffer.insert(exr_rgba_channelname(*file, "RY"),
+			                   Slice(Imf::FLOAT,  (char *) (first + 2), xstride, ystride, 1, 1, 0.5f));
+		}
+
+		/* 1.0 is fill value, this still needs to be assigned even when (is_alpha == 0) */
+		frameBuffer.insert(exr_rgba_channelname(*file, "A"),
+		                   Slice(Imf::FLOAT,  (char *) (first + 3), xstride, ystride, 1, 1, 1.0f));
+
+		if (is_tiled) {
+			TiledInputPart in(*file, 0);
+			in.setFrameBuffer(frameBuffer);
+			in.readTiles(tx1, tx2, ty1, ty2, miplevel);
+		}
+		else {
+			InputPart in(*file, 0);
+			in.setFrameBuffer(frameBuffer);
+			in.readPixels(ay1, ay2);
+		}
+
+		if (!has_rgb && has_luma) {
+			size_t a;
+			if (exr_has_chroma(*file)) {
+				for (a = 0; a < (size_t) ibuf->x * ibuf->y; ++a) {
+					float *color = ibuf->rect_float + a * 4;
+					ycc_to_rgb(color[0] * 255.0f, color[1] * 255.0f, color[2] * 255.0f,
+					           &color[0], &color[1], &color[2],
+					           BLI_YCC_ITU_BT709);
+				}
+			}
+			else {
+				for (a = 0; a < (size_t) ibuf->x * ibuf->y; ++a) {
+					float *color = ibuf->rect_float + a * 4;
+					color[1] = color[2] = color[0];
+				}
+			}
+		}
+
+		/* file is no longer needed */
+		delete membuf;
+		delete file;
+		membuf = NULL;
+		file = NULL;
+
+		/* crop the scanline/tile padding away */
+		if (aligned_width != width || aligned_height != height) {
+			struct ImBuf *cibuf = IMB_allocImBuf(width, height, is_alpha ? 32 : 24, IB_rectfloat);
+
+			cibuf->ftype = IMB_FTYPE_OPENEXR;
+			IMB_rectcpy(cibuf, ibuf, 0, 0, fx1 - ax1, ay2 - fy2, width, height);
+			IMB_freeImBuf(ibuf);
+			ibuf = cibuf;
+		}
+
+		if (flags & IB_alphamode_detect)
+			ibuf->flags |= IB_alphamode_premul;
+
+		return(ibuf);
+	}
+	catch (const std::exception& exc)
+	{
+		std::cerr << exc.what() << std::endl;
+		if (ibuf) IMB_freeImBuf(ibuf);
+		delete file;
+		delete membuf;
+
+		return (0);
+	}
+
+}
+
 void imb_initopenexr(void)
 {
 	int num_threads = BLI_system_thread_count();
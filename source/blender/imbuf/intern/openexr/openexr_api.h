@@ -47,6 +47,14 @@ int		imb_save_openexr			(struct ImBuf *ibuf, const char *name, int flags);
 
 struct ImBuf *imb_load_openexr		(const unsigned char *mem, size_t size, int flags, char *colorspace);
 
+/* Read a sub-rectangle, for tiled mipmapped files at the requested level,
+ * without decoding the full image. The region is given in ImBuf pixel
+ * coordinates at the resolution of the requested level. Returns NULL when a
+ * region read is not possible (multilayer files), callers are expected to
+ * fall back to a full load then. */
+struct ImBuf *imb_load_openexr_region(const unsigned char *mem, size_t size, int flags, int miplevel,
+                                      int x, int y, int width, int height, char *colorspace);
+
 #ifdef __cplusplus
 }
 #endif
@@ -36,6 +36,11 @@
 #include "BLI_utildefines.h"
 #include "BLI_fileops.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
 
 #include "BKE_global.h"
 #include "BKE_idprop.h"
@@ -511,6 +516,119 @@ static void imb_png_error(png_structp UNUSED(png_ptr), png_const_charp message)
 	fprintf(stderr, "libpng error: %s\n", message);
 }
 
+/* Decoded rows are converted to the ImBuf layout in parallel. Texture heavy
+ * scene loads open many large images back to back and the conversion pass is
+ * a noticeable part of their load time, small images stay single threaded.
+ */
+#define PNG_CONVERT_ROWS_MIN_Y 256
+
+typedef struct PNGRowConvertData {
+	const unsigned char *pixels;
+	const unsigned short *pixels16;
+	ImBuf *ibuf;
+	int bytesperpixel;
+} PNGRowConvertData;
+
+static void png_row_to_float_cb(void *userdata, const int row)
+{
+	PNGRowConvertData *data = userdata;
+	ImBuf *ibuf = data->ibuf;
+	const unsigned short *from16 = data->pixels16 + ((size_t)row) * ibuf->x * data->bytesperpixel;
+	float *to_float = ibuf->rect_float + ((size_t)row) * ibuf->x * 4;
+	const float scale = 1.0f / 65535.0f;
+	int i;
+
+	switch (data->bytesperpixel) {
+		case 4:
+			i = ibuf->x;
+#ifdef __SSE2__
+			{
+				const __m128 scale_v = _mm_set1_ps(scale);
+				const __m128i zero = _mm_setzero_si128();
+
+				/* two pixels (8 channel values) at a time */
+				for (; i > 1; i -= 2) {
+					__m128i v = _mm_loadu_si128((const __m128i *)from16);
+					__m128i lo = _mm_unpacklo_epi16(v, zero);
+					__m128i hi = _mm_unpackhi_epi16(v, zero);
+
+					_mm_storeu_ps(to_float, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale_v));
+					_mm_storeu_ps(to_float + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale_v));
+
+					to_float += 8; from16 += 8;
+				}
+			}
+#endif
+			for (; i > 0; i--) {
+				to_float[0] = from16[0] * scale;
+				to_float[1] = from16[1] * scale;
+				to_float[2] = from16[2] * scale;
+				to_float[3] = from16[3] * scale;
+				to_float += 4; from16 += 4;
+			}
+			break;
+		case 3:
+			for (i = ibuf->x; i > 0; i--) {
+				to_float[0] = from16[0] * scale;
+				to_float[1] = from16[1] * scale;
+				to_float[2] = from16[2] * scale;
+				to_float[3] = 1.0f;
+				to_float += 4; from16 += 3;
+			}
+			break;
+		case 2:
+			for (i = ibuf->x; i > 0; i--) {
+				to_float[0] = to_float[1] = to_float[2] = from16[0] * scale;
+				to_float[3] = from16[1] * scale;
+				to_float += 4; from16 += 2;
+			}
+			break;
+		case 1:
+			for (i = ibuf->x; i > 0; i--) {
+				to_float[0] = to_float[1] = to_float[2] = from16[0] * scale;
+				to_float[3] = 1.0f;
+				to_float += 4; from16++;
+			}
+			break;
+	}
+}
+
+static void png_row_to_byte_cb(void *userdata, const int row)
+{
+	PNGRowConvertData *data = userdata;
+	ImBuf *ibuf = data->ibuf;
+	const unsigned char *from = data->pixels + ((size_t)row) * ibuf->x * data->bytesperpixel;
+	unsigned char *to = (unsigned char *)(ibuf->rect + ((size_t)row) * ibuf->x);
+	int i;
+
+	/* 4 channel images are decoded straight into the rect, see imb_loadpng */
+	switch (data->bytesperpixel) {
+		case 3:
+			for (i = ibuf->x; i > 0; i--) {
+				to[0] = from[0];
+				to[1] = from[1];
+				to[2] = from[2];
+				to[3] = 0xff;
+				to += 4; from += 3;
+			}
+			break;
+		case 2:
+			for (i = ibuf->x; i > 0; i--) {
+				to[0] = to[1] = to[2] = from[0];
+				to[3] = from[1];
+				to += 4; from += 2;
+			}
+			break;
+		case 1:
+			for (i = ibuf->x; i > 0; i--) {
+				to[0] = to[1] = to[2] = from[0];
+				to[3] = 0xff;
+				to += 4; from++;
+			}
+			break;
+	}
+}
+
 ImBuf *imb_loadpng(const unsigned char *mem, size_t size, int flags, char colorspace[IM_MAX_SPACE])
 {
 	struct ImBuf *ibuf = NULL;
@@ -523,9 +641,7 @@ ImBuf *imb_loadpng(const unsigned char *mem, size_t size, int flags, char colors
 	int bit_depth, color_type;
 	PNGReadStruct ps;
 
-	unsigned char *from, *to;
-	unsigned short *from16;
-	float *to_float;
+	PNGRowConvertData convert_data;
 	int i, bytesperpixel;
 
 	if (imb_is_a_png(mem) == 0) return(NULL);
@@ -652,53 +768,16 @@ ImBuf *imb_loadpng(const unsigned char *mem, size_t size, int flags, char colors
 
 			/* copy image data */
 
-			to_float = ibuf->rect_float;
-			from16 = pixels16;
+			convert_data.pixels16 = pixels16;
+			convert_data.ibuf = ibuf;
+			convert_data.bytesperpixel = bytesperpixel;
 
-			switch (bytesperpixel) {
-				case 4:
-					for (i = ibuf->x * ibuf->y; i > 0; i--) {
-						to_float[0] = from16[0] / 65535.0;
-						to_float[1] = from16[1] / 65535.0;
-						to_float[2] = from16[2] / 65535.0;
-						to_float[3] = from16[3] / 65535.0;
-						to_float += 4; from16 += 4;
-					}
-					break;
-				case 3:
-					for (i = ibuf->x * ibuf->y; i > 0; i--) {
-						to_float[0] = from16[0] / 65535.0;
-						to_float[1] = from16[1] / 65535.0;
-						to_float[2] = from16[2] / 65535.0;
-						to_float[3] = 1.0;
-						to_float += 4; from16 += 3;
-					}
-					break;
-				case 2:
-					for (i = ibuf->x * ibuf->y; i > 0; i--) {
-						to_float[0] = to_float[1] = to_float[2] = from16[0] / 65535.0;
-						to_float[3] = from16[1] / 65535.0;
-						to_float += 4; from16 += 2;
-					}
-					break;
-				case 1:
-					for (i = ibuf->x * ibuf->y; i > 0; i--) {
-						to_float[0] = to_float[1] = to_float[2] = from16[0] / 65535.0;
-						to_float[3] = 1.0;
-						to_float += 4; from16++;
-					}
-					break;
-			}
+			BLI_task_parallel_range(0, ibuf->y, &convert_data, png_row_to_float_cb,
+			                        (ibuf->y >= PNG_CONVERT_ROWS_MIN_Y));
 		}
 		else {
 			imb_addrectImBuf(ibuf);
 
-			pixels = MEM_mallocN(((size_t)ibuf->x) * ibuf->y * bytesperpixel * sizeof(unsigned char), "pixels");
-			if (pixels == NULL) {
-				printf("Cannot allocate pixels array\n");
-				longjmp(png_jmpbuf(png_ptr), 1);
-			}
-
 			/* allocate memory for an array of row-pointers */
 			row_pointers = (png_bytepp) MEM_mallocN(ibuf->y * sizeof(png_bytep), "row_pointers");
 			if (row_pointers == NULL) {
@@ -706,52 +785,40 @@ ImBuf *imb_loadpng(const unsigned char *mem, size_t size, int flags, char colors
 				longjmp(png_jmpbuf(png_ptr), 1);
 			}
 
-			/* set the individual row-pointers to point at the correct offsets */
-			for (i = 0; i < ibuf->y; i++) {
-				row_pointers[ibuf->y - 1 - i] = (png_bytep)
-				                                ((unsigned char *)pixels + (((size_t)i) * ibuf->x) * bytesperpixel * sizeof(unsigned char));
+			if (bytesperpixel == 4) {
+				/* decode straight into the ImBuf, decoded rows match the
+				 * RGBA byte layout of the rect exactly
+				 */
+				for (i = 0; i < ibuf->y; i++) {
+					row_pointers[ibuf->y - 1 - i] = (png_bytep)
+					                                ((unsigned char *)(ibuf->rect + ((size_t)i) * ibuf->x));
+				}
+
+				png_read_image(png_ptr, row_pointers);
 			}
+			else {
+				pixels = MEM_mallocN(((size_t)ibuf->x) * ibuf->y * bytesperpixel * sizeof(unsigned char), "pixels");
+				if (pixels == NULL) {
+					printf("Cannot allocate pixels array\n");
+					longjmp(png_jmpbuf(png_ptr), 1);
+				}
 
-			png_read_image(png_ptr, row_pointers);
+				/* set the individual row-pointers to point at the correct offsets */
+				for (i = 0; i < ibuf->y; i++) {
+					row_pointers[ibuf->y - 1 - i] = (png_bytep)
+					                                ((unsigned char *)pixels + (((size_t)i) * ibuf->x) * bytesperpixel * sizeof(unsigned char));
+				}
 
-			/* copy image data */
+				png_read_image(png_ptr, row_pointers);
 
-			to = (unsigned char *) ibuf->rect;
-			from = pixels;
+				/* copy image data */
 
-			switch (bytesperpixel) {
-				case 4:
-					for (i = ibuf->x * ibuf->y; i > 0; i--) {
-						to[0] = from[0];
-						to[1] = from[1];
-						to[2] = from[2];
-						to[3] = from[3];
-						to += 4; from += 4;
-					}
-					break;
-				case 3:
-					for (i = ibuf->x * ibuf->y; i > 0; i--) {
-						to[0] = from[0];
-						to[1] = from[1];
-						to[2] = from[2];
-						to[3] = 0xff;
-						to += 4; from += 3;
-					}
-					break;
-				case 2:
-					for (i = ibuf->x * ibuf->y; i > 0; i--) {
-						to[0] = to[1] = to[2] = from[0];
-						to[3] = from[1];
-						to += 4; from += 2;
-					}
-					break;
-				case 1:
-					for (i = ibuf->x * ibuf->y; i > 0; i--) {
-						to[0] = to[1] = to[2] = from[0];
-						to[3] = 0xff;
-						to += 4; from++;
-					}
-					break;
+				convert_data.pixels = pixels;
+				convert_data.ibuf = ibuf;
+				convert_data.bytesperpixel = bytesperpixel;
+
+				BLI_task_parallel_range(0, ibuf->y, &convert_data, png_row_to_byte_cb,
+				                        (ibuf->y >= PNG_CONVERT_ROWS_MIN_Y));
 			}
 		}
 
@@ -54,6 +54,10 @@
 #include "IMB_colormanagement.h"
 #include "IMB_colormanagement_intern.h"
 
+#ifdef WITH_OPENEXR
+#include "openexr/openexr_api.h"
+#endif
+
 static void imb_handle_alpha(ImBuf *ibuf, int flags, char colorspace[IM_MAX_SPACE], char effective_colorspace[IM_MAX_SPACE])
 {
 	int alpha_flags;
@@ -238,6 +242,56 @@ ImBuf *IMB_loadiffname(const char *filepath, int flags, char colorspace[IM_MAX_S
 	return ibuf;
 }
 
+ImBuf *IMB_loadiffname_region(const char *filepath, int flags, char colorspace[IM_MAX_SPACE], int miplevel,
+                              int x, int y, int width, int height)
+{
+	ImBuf *ibuf = NULL;
+	unsigned char *mem;
+	size_t size;
+	int file;
+	char effective_colorspace[IM_MAX_SPACE] = "";
+
+	BLI_assert(!BLI_path_is_rel(filepath));
+
+	if (colorspace)
+		BLI_strncpy(effective_colorspace, colorspace, sizeof(effective_colorspace));
+
+	file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+	if (file == -1)
+		return NULL;
+
+	size = BLI_file_descriptor_size(file);
+
+	imb_mmap_lock();
+	mem = mmap(NULL, size, PROT_READ, MAP_SHARED, file, 0);
+	imb_mmap_unlock();
+
+	if (mem == (unsigned char *) -1) {
+		fprintf(stderr, "%s: couldn't get mapping %s\n", __func__, filepath);
+		close(file);
+		return NULL;
+	}
+
+#ifdef WITH_OPENEXR
+	ibuf = imb_load_openexr_region(mem, size, flags, miplevel, x, y, width, height, effective_colorspace);
+#endif
+
+	imb_mmap_lock();
+	if (munmap(mem, size))
+		fprintf(stderr, "%s: couldn't unmap file %s\n", __func__, filepath);
+	imb_mmap_unlock();
+
+	close(file);
+
+	if (ibuf) {
+		imb_handle_alpha(ibuf, flags, colorspace, effective_colorspace);
+		BLI_strncpy(ibuf->name, filepath, sizeof(ibuf->name));
+		BLI_strncpy(ibuf->cachename, filepath, sizeof(ibuf->cachename));
+	}
+
+	return ibuf;
+}
+
 ImBuf *IMB_testiffname(const char *filepath, int flags)
 {
 	ImBuf *ibuf;
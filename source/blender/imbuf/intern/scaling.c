@@ -35,6 +35,7 @@
 #include "BLI_utildefines.h"
 #include "BLI_math_color.h"
 #include "BLI_math_interp.h"
+#include "BLI_task.h"
 #include "MEM_guardedalloc.h"
 
 #include "imbuf.h"
@@ -45,6 +46,10 @@
 
 #include "BLI_sys_types.h" // for intptr_t support
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 /************************************************************************/
 /*								SCALING									*/
 /************************************************************************/
@@ -340,9 +345,82 @@ MINLINE void premul_ushort_to_straight_uchar(unsigned char *result, const unsign
 }
 
 /* result in ibuf2, scaling should be done correctly */
+typedef struct OneHalfRowData {
+	ImBuf *ibuf1, *ibuf2;
+	int x1, x2;
+	bool do_rect, do_float;
+} OneHalfRowData;
+
+static void imb_onehalf_row_cb(void *userdata, const int row)
+{
+	OneHalfRowData *data = userdata;
+	ImBuf *ibuf1 = data->ibuf1;
+	ImBuf *ibuf2 = data->ibuf2;
+	int x;
+
+	if (data->do_rect) {
+		const unsigned char *cp1 = (const unsigned char *)(ibuf1->rect + 2 * ((size_t)row) * ibuf1->x + 2 * data->x1);
+		const unsigned char *cp2 = cp1 + (ibuf1->x << 2);
+		unsigned char *dest = (unsigned char *)(ibuf2->rect + ((size_t)row) * ibuf2->x + data->x1);
+
+		for (x = data->x2 - data->x1; x > 0; x--) {
+			unsigned short p1i[8], p2i[8], desti[4];
+
+			straight_uchar_to_premul_ushort(p1i, cp1);
+			straight_uchar_to_premul_ushort(p2i, cp2);
+			straight_uchar_to_premul_ushort(p1i + 4, cp1 + 4);
+			straight_uchar_to_premul_ushort(p2i + 4, cp2 + 4);
+
+			desti[0] = ((unsigned int) p1i[0] + p2i[0] + p1i[4] + p2i[4]) >> 2;
+			desti[1] = ((unsigned int) p1i[1] + p2i[1] + p1i[5] + p2i[5]) >> 2;
+			desti[2] = ((unsigned int) p1i[2] + p2i[2] + p1i[6] + p2i[6]) >> 2;
+			desti[3] = ((unsigned int) p1i[3] + p2i[3] + p1i[7] + p2i[7]) >> 2;
+
+			premul_ushort_to_straight_uchar(dest, desti);
+
+			cp1 += 8;
+			cp2 += 8;
+			dest += 4;
+		}
+	}
+
+	if (data->do_float) {
+		const float *p1f = ibuf1->rect_float + (2 * ((size_t)row) * ibuf1->x + 2 * data->x1) * 4;
+		const float *p2f = p1f + (ibuf1->x << 2);
+		float *destf = ibuf2->rect_float + (((size_t)row) * ibuf2->x + data->x1) * 4;
+
+#ifdef __SSE2__
+		/* each RGBA pixel fits one SSE register, additions happen in the
+		 * same order as the scalar loop so the result is identical */
+		{
+			const __m128 quarter = _mm_set1_ps(0.25f);
+			for (x = data->x2 - data->x1; x > 0; x--) {
+				__m128 sum = _mm_add_ps(_mm_loadu_ps(p1f), _mm_loadu_ps(p2f));
+				sum = _mm_add_ps(sum, _mm_loadu_ps(p1f + 4));
+				sum = _mm_add_ps(sum, _mm_loadu_ps(p2f + 4));
+				_mm_storeu_ps(destf, _mm_mul_ps(quarter, sum));
+				p1f += 8;
+				p2f += 8;
+				destf += 4;
+			}
+		}
+#else
+		for (x = data->x2 - data->x1; x > 0; x--) {
+			destf[0] = 0.25f * (p1f[0] + p2f[0] + p1f[4] + p2f[4]);
+			destf[1] = 0.25f * (p1f[1] + p2f[1] + p1f[5] + p2f[5]);
+			destf[2] = 0.25f * (p1f[2] + p2f[2] + p1f[6] + p2f[6]);
+			destf[3] = 0.25f * (p1f[3] + p2f[3] + p1f[7] + p2f[7]);
+			p1f += 8;
+			p2f += 8;
+			destf += 4;
+		}
+#endif
+	}
+}
+
 void imb_onehalf_no_alloc(struct ImBuf *ibuf2, struct ImBuf *ibuf1)
 {
-	int x, y;
+	OneHalfRowData data;
 	const short do_rect = (ibuf1->rect != NULL);
 	const short do_float = (ibuf1->rect_float != NULL) && (ibuf2->rect_float != NULL);
 
@@ -358,59 +436,40 @@ void imb_onehalf_no_alloc(struct ImBuf *ibuf2, struct ImBuf *ibuf1)
 		imb_half_x_no_alloc(ibuf2, ibuf1);
 		return;
 	}
-	
-	if (do_rect) {
-		unsigned char *cp1, *cp2, *dest;
-		
-		cp1 = (unsigned char *) ibuf1->rect;
-		dest = (unsigned char *) ibuf2->rect;
-		
-		for (y = ibuf2->y; y > 0; y--) {
-			cp2 = cp1 + (ibuf1->x << 2);
-			for (x = ibuf2->x; x > 0; x--) {
-				unsigned short p1i[8], p2i[8], desti[4];
-				
-				straight_uchar_to_premul_ushort(p1i, cp1);
-				straight_uchar_to_premul_ushort(p2i, cp2);
-				straight_uchar_to_premul_ushort(p1i + 4, cp1 + 4);
-				straight_uchar_to_premul_ushort(p2i + 4, cp2 + 4);
-				
-				desti[0] = ((unsigned int) p1i[0] + p2i[0] + p1i[4] + p2i[4]) >> 2;
-				desti[1] = ((unsigned int) p1i[1] + p2i[1] + p1i[5] + p2i[5]) >> 2;
-				desti[2] = ((unsigned int) p1i[2] + p2i[2] + p1i[6] + p2i[6]) >> 2;
-				desti[3] = ((unsigned int) p1i[3] + p2i[3] + p1i[7] + p2i[7]) >> 2;
-				
-				premul_ushort_to_straight_uchar(dest, desti);
-				
-				cp1 += 8;
-				cp2 += 8;
-				dest += 4;
-			}
-			cp1 = cp2;
-			if (ibuf1->x & 1) cp1 += 4;
-		}
-	}
-	
-	if (do_float) {
-		float *p1f, *p2f, *destf;
-		
-		p1f = ibuf1->rect_float;
-		destf = ibuf2->rect_float;
-		for (y = ibuf2->y; y > 0; y--) {
-			p2f = p1f + (ibuf1->x << 2);
-			for (x = ibuf2->x; x > 0; x--) {
-				destf[0] = 0.25f * (p1f[0] + p2f[0] + p1f[4] + p2f[4]);
-				destf[1] = 0.25f * (p1f[1] + p2f[1] + p1f[5] + p2f[5]);
-				destf[2] = 0.25f * (p1f[2] + p2f[2] + p1f[6] + p2f[6]);
-				destf[3] = 0.25f * (p1f[3] + p2f[3] + p1f[7] + p2f[7]);
-				p1f += 8;
-				p2f += 8;
-				destf += 4;
-			}
-			p1f = p2f;
-			if (ibuf1->x & 1) p1f += 4;
-		}
-	}
+
+	data.ibuf1 = ibuf1;
+	data.ibuf2 = ibuf2;
+	data.x1 = 0;
+	data.x2 = ibuf2->x;
+	data.do_rect = do_rect;
+	data.do_float = do_float;
+
+	/* rows are independent, spread large images (the first levels of an 8k
+	 * mipmap pyramid) over the task scheduler */
+	BLI_task_parallel_range(0, ibuf2->y, &data, imb_onehalf_row_cb,
+	                        (((size_t)ibuf2->x) * ibuf2->y >= 256 * 256));
+}
+
+/* same box average as imb_onehalf_no_alloc but only recomputes destination
+ * pixels inside [x1, x2) x [y1, y2), for localized updates of mipmap levels.
+ * Source buffers must be at least twice the destination size in both
+ * dimensions. */
+void imb_onehalf_partial_no_alloc(struct ImBuf *ibuf2, struct ImBuf *ibuf1,
+                                  int x1, int y1, int x2, int y2)
+{
+	OneHalfRowData data;
+
+	BLI_assert(ibuf1->x > 1 && ibuf1->y > 1);
+
+	data.ibuf1 = ibuf1;
+	data.ibuf2 = ibuf2;
+	data.x1 = x1;
+	data.x2 = x2;
+	data.do_rect = (ibuf1->rect != NULL) && (ibuf2->rect != NULL);
+	data.do_float = (ibuf1->rect_float != NULL) && (ibuf2->rect_float != NULL);
+
+	BLI_task_parallel_range(y1, y2, &data, imb_onehalf_row_cb,
+	                        (((size_t)(x2 - x1)) * (y2 - y1) >= 256 * 256));
 }
 
 ImBuf *IMB_onehalf(struct ImBuf *ibuf1)
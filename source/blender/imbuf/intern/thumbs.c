@@ -317,6 +317,7 @@ static ImBuf *thumb_create_ex(
 	char tdir[FILE_MAX];
 	char temp[FILE_MAX];
 	char mtime[40] = "0"; /* in case we can't stat the file */
+	char fsize[40] = "0";
 	char cwidth[40] = "0"; /* in case images have no data */
 	char cheight[40] = "0";
 	short tsize = 128;
@@ -364,7 +365,10 @@ static ImBuf *thumb_create_ex(
 				if (img == NULL) {
 					switch (source) {
 						case THB_SOURCE_IMAGE:
-							img = IMB_loadiffname(file_path, IB_rect | IB_metadata, NULL);
+							/* IB_thumbnail lets loaders decode at reduced scale where the
+							 * codec supports it (jpeg DCT scaling, exr combined-only read),
+							 * the recorded size metadata then reflects the decoded size */
+							img = IMB_loadiffname(file_path, IB_rect | IB_metadata | IB_thumbnail, NULL);
 							break;
 						case THB_SOURCE_BLEND:
 							img = IMB_thumb_load_blend(file_path, blen_group, blen_id);
@@ -380,6 +384,7 @@ static ImBuf *thumb_create_ex(
 				if (img != NULL) {
 					if (BLI_stat(file_path, &info) != -1) {
 						BLI_snprintf(mtime, sizeof(mtime), "%ld", (long int)info.st_mtime);
+						BLI_snprintf(fsize, sizeof(fsize), "%lld", (long long int)info.st_size);
 					}
 					BLI_snprintf(cwidth, sizeof(cwidth), "%d", img->x);
 					BLI_snprintf(cheight, sizeof(cheight), "%d", img->y);
@@ -401,6 +406,7 @@ static ImBuf *thumb_create_ex(
 				}
 				if (BLI_stat(file_path, &info) != -1) {
 					BLI_snprintf(mtime, sizeof(mtime), "%ld", (long int)info.st_mtime);
+					BLI_snprintf(fsize, sizeof(fsize), "%lld", (long long int)info.st_size);
 				}
 			}
 			if (!img) return NULL;
@@ -432,6 +438,7 @@ static ImBuf *thumb_create_ex(
 		IMB_metadata_change_field(img, "Software", "Blender");
 		IMB_metadata_change_field(img, "Thumb::URI", uri);
 		IMB_metadata_change_field(img, "Thumb::MTime", mtime);
+		IMB_metadata_change_field(img, "Thumb::Size", fsize);
 		if (use_hash) {
 			IMB_metadata_change_field(img, "X-Blender::Hash", hash);
 		}
@@ -582,6 +589,7 @@ ImBuf *IMB_thumb_manage(const char *org_path, ThumbSize size, ThumbSource source
 				bool regenerate = false;
 
 				char mtime[40];
+				char fsize[40];
 				char thumb_hash[33];
 				char thumb_hash_curr[33];
 
@@ -595,6 +603,13 @@ ImBuf *IMB_thumb_manage(const char *org_path, ThumbSize size, ThumbSource source
 					regenerate = true;
 				}
 
+				/* the file size is part of the key too, mtime alone misses
+				 * same-second rewrites (field is optional in thumbs written
+				 * by other applications) */
+				if (!regenerate && IMB_metadata_get_field(img, "Thumb::Size", fsize, sizeof(fsize))) {
+					regenerate = (st.st_size != (int64_t)atoll(fsize));
+				}
+
 				if (use_hash && !regenerate) {
 					if (IMB_metadata_get_field(img, "X-Blender::Hash", thumb_hash_curr, sizeof(thumb_hash_curr))) {
 						regenerate = !STREQ(thumb_hash, thumb_hash_curr);
@@ -497,6 +497,12 @@ typedef struct FCurve {
 	float color[3];			/* the last-color this curve took */
 
 	float prev_norm_factor, prev_offset;
+
+	/* Index of the keyframe segment hit by the previous evaluation. Runtime
+	 * cache: during playback consecutive evaluation times almost always fall
+	 * in the same or an adjacent segment (see fcurve_eval_keyframes). */
+	unsigned int last_eval_index;
+	int pad;
 } FCurve;
 
 
@@ -910,6 +916,10 @@ typedef struct AnimData {
 	short act_blendmode;    /* accumulation mode for active action */
 	short act_extendmode;   /* extrapolation mode for active action */
 	float act_influence;    /* influence for active action */
+
+		/* runtime cache of resolved RNA paths used by animation evaluation,
+		 * never saved to files (see BKE_animsys_rna_cache_free) */
+	void *rna_path_cache;
 } AnimData;
 
 /* Animation Data settings (mostly for NLA) */
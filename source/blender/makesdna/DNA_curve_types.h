@@ -85,6 +85,7 @@ typedef struct BevList {
 	int nr, dupe_nr;
 	int poly, hole;
 	int charidx;
+	unsigned int hash;  /* key of the source spline data, for re-use between updates */
 	int *segbevcount;
 	float *seglen;
 
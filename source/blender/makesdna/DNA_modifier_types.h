@@ -1299,6 +1299,7 @@ typedef struct LaplacianSmoothModifierData {
 	float lambda, lambda_border, pad1;
 	char defgrp_name[64];  /* MAX_VGROUP_NAME */
 	short flag, repeat;
+	void *cache_system;  /* runtime only */
 } LaplacianSmoothModifierData;
 
 /* Smooth modifier flags */
@@ -288,7 +288,11 @@ typedef struct Object {
 	ListBase gpulamp;		/* runtime, for glsl lamp display only */
 	ListBase pc_ids;
 	ListBase *duplilist;	/* for temporary dupli list storage, only for use by RNA API */
-	
+
+	/* runtime cache of the last generated dupli list, never saved to files (see object_dupli.c) */
+	struct DupliListStore *dupli_cache;
+
+
 	struct RigidBodyOb *rigidbody_object;		/* settings for Bullet rigid body */
 	struct RigidBodyCon *rigidbody_constraint;	/* settings for Bullet constraint */
 
@@ -37,9 +37,22 @@
 typedef struct PackedFile {
 	int   size;
 	int   seek;
+	int   flag;
+	/* file offset of the data in the .blend at lazy_path, only valid when
+	 * PF_FILE_LAZY is set */
+	int   lazy_offset;
 	void *data;
+	/* path of the .blend file the data is streamed from on demand,
+	 * runtime only (see acquirePackedFileData) */
+	char *lazy_path;
 } PackedFile;
 
+/* PackedFile.flag */
+enum {
+	/* data is not kept in memory but re-read from lazy_path when needed */
+	PF_FILE_LAZY = 1 << 0,
+};
+
 enum PF_FileStatus {
 	PF_EQUAL = 0,
 	PF_DIFFERS = 1,
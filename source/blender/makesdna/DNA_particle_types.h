@@ -318,11 +318,12 @@ typedef struct ParticleSystem {
 
 	struct KDTree *tree;					/* used for interactions with self and other systems */
 	struct BVHTree *bvhtree;				/* used for interactions with self and other systems */
+	struct SPHGrid *sph_grid;				/* uniform grid for SPH neighbor queries, see particle_system.c */
 
 	struct ParticleDrawData *pdd;
 
 	float dt_frac;							/* current time step, as a fraction of a frame */
-	float _pad;								/* spare capacity */
+	unsigned int pathcache_hash;			/* hash of the inputs the path cache was built from (runtime) */
 } ParticleSystem;
 
 typedef enum eParticleDrawFlag {
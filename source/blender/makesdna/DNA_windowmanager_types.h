@@ -137,6 +137,7 @@ typedef struct wmWindowManager {
 	ListBase operators;               /* operator registry */
 
 	ListBase queue;                   /* refresh/redraw wmNotifier structs */
+	void *notifier_queue_set;         /* runtime: GSet mirror of the queue, for fast duplicate checks */
 
 	struct ReportList reports;        /* information and error reports */
 
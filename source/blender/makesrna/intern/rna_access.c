@@ -3514,9 +3514,39 @@ static int rna_raw_access(ReportList *reports, PointerRNA *ptr, PropertyRNA *pro
 
 				return 1;
 			}
+			else {
+				/* raw types don't match, convert per element while still
+				 * accessing the array directly, this stays much faster than
+				 * the per item property loop below */
+				char *outp = out.array;
+				int a, b;
+
+				for (a = 0; a < out.len; a++) {
+					RawArray outitem;
+
+					outitem.array = outp;
+					outitem.type = out.type;
+					outitem.len = arraylen;
+					outitem.stride = 0;
 
-			/* could also be faster with non-matching types,
-			 * for now we just do slower loop .. */
+					for (b = 0; b < arraylen; b++) {
+						double value;
+
+						if (set) {
+							RAW_GET(double, value, in, a * arraylen + b);
+							RAW_SET(double, outitem, b, value);
+						}
+						else {
+							RAW_GET(double, value, outitem, b);
+							RAW_SET(double, in, a * arraylen + b, value);
+						}
+					}
+
+					outp += out.stride;
+				}
+
+				return 1;
+			}
 		}
 	}
 
@@ -607,6 +607,11 @@ void RNA_struct_free(BlenderRNA *brna, StructRNA *srna)
 	}
 #endif
 
+	if (srna->cont.prophash) {
+		BLI_ghash_free(srna->cont.prophash, NULL, NULL);
+		srna->cont.prophash = NULL;
+	}
+
 	for (prop = srna->cont.properties.first; prop; prop = nextprop) {
 		nextprop = prop->next;
 
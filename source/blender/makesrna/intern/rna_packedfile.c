@@ -45,10 +45,20 @@ EnumPropertyItem rna_enum_unpack_method_items[] = {
 
 #ifdef RNA_RUNTIME
 
+#include "BKE_packedFile.h"
+
 static void rna_PackedImage_data_get(PointerRNA *ptr, char *value)
 {
 	PackedFile *pf = (PackedFile *)ptr->data;
-	memcpy(value, pf->data, (size_t)pf->size);
+	const void *data = acquirePackedFileData(pf);
+
+	if (data) {
+		memcpy(value, data, (size_t)pf->size);
+		releasePackedFileData(pf);
+	}
+	else {
+		memset(value, 0, (size_t)pf->size);
+	}
 	value[pf->size] = '\0';
 }
 
@@ -372,27 +372,25 @@ int rna_builtin_properties_lookup_string(PointerRNA *ptr, const char *key, Point
 	srna = ptr->type;
 
 	do {
-		if (srna->cont.prophash) {
-			prop = BLI_ghash_lookup(srna->cont.prophash, (void *)key);
+		if (srna->cont.prophash == NULL) {
+			/* Structs registered at runtime miss out on the hash built by
+			 * RNA_init, create it on first lookup so they get the same
+			 * constant time access, RNA_def_property keeps it up to date. */
+			srna->cont.prophash = BLI_ghash_str_new(__func__);
+
+			for (prop = srna->cont.properties.first; prop; prop = prop->next)
+				if (!(prop->flag & PROP_BUILTIN))
+					BLI_ghash_insert(srna->cont.prophash, (void *)prop->identifier, prop);
+		}
 
-			if (prop) {
-				propptr.type = &RNA_Property;
-				propptr.data = prop;
+		prop = BLI_ghash_lookup(srna->cont.prophash, (void *)key);
 
-				*r_ptr = propptr;
-				return true;
-			}
-		}
-		else {
-			for (prop = srna->cont.properties.first; prop; prop = prop->next) {
-				if (!(prop->flag & PROP_BUILTIN) && STREQ(prop->identifier, key)) {
-					propptr.type = &RNA_Property;
-					propptr.data = prop;
+		if (prop) {
+			propptr.type = &RNA_Property;
+			propptr.data = prop;
 
-					*r_ptr = propptr;
-					return true;
-				}
-			}
+			*r_ptr = propptr;
+			return true;
 		}
 	} while ((srna = srna->base));
 
@@ -33,6 +33,7 @@
 #include "DNA_object_types.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "MEM_guardedalloc.h"
@@ -53,6 +54,7 @@
 struct BLaplacianSystem {
 	float *eweights;        /* Length weights per Edge */
 	float (*fweights)[3];   /* Cotangent weights per face */
+	float *loop_areas;      /* Triangle area per loop corner */
 	float *ring_areas;      /* Total area per ring*/
 	float *vlengths;        /* Total sum of lengths(edges) per vertice*/
 	float *vweights;        /* Total sum of weights per vertice*/
@@ -84,6 +86,7 @@ static LaplacianSystem *init_laplacian_system(int a_numEdges, int a_numPolys, in
 static void copy_data(ModifierData *md, ModifierData *target);
 static void delete_laplacian_system(LaplacianSystem *sys);
 static void fill_laplacian_matrix(LaplacianSystem *sys);
+static void free_data(ModifierData *md);
 static void init_data(ModifierData *md);
 static void init_laplacian_matrix(LaplacianSystem *sys);
 static void memset_laplacian_system(LaplacianSystem *sys, int val);
@@ -94,6 +97,7 @@ static void delete_laplacian_system(LaplacianSystem *sys)
 {
 	MEM_SAFE_FREE(sys->eweights);
 	MEM_SAFE_FREE(sys->fweights);
+	MEM_SAFE_FREE(sys->loop_areas);
 	MEM_SAFE_FREE(sys->numNeEd);
 	MEM_SAFE_FREE(sys->numNeFa);
 	MEM_SAFE_FREE(sys->ring_areas);
@@ -115,6 +119,7 @@ static void memset_laplacian_system(LaplacianSystem *sys, int val)
 {
 	memset(sys->eweights,     val, sizeof(float) * sys->numEdges);
 	memset(sys->fweights,     val, sizeof(float[3]) * sys->numLoops);
+	memset(sys->loop_areas,   val, sizeof(float) * sys->numLoops);
 	memset(sys->numNeEd,      val, sizeof(short) * sys->numVerts);
 	memset(sys->numNeFa,      val, sizeof(short) * sys->numVerts);
 	memset(sys->ring_areas,   val, sizeof(float) * sys->numVerts);
@@ -134,6 +139,7 @@ static LaplacianSystem *init_laplacian_system(int a_numEdges, int a_numPolys, in
 
 	sys->eweights =  MEM_callocN(sizeof(float) * sys->numEdges, __func__);
 	sys->fweights =  MEM_callocN(sizeof(float[3]) * sys->numLoops, __func__);
+	sys->loop_areas =  MEM_callocN(sizeof(float) * sys->numLoops, __func__);
 	sys->numNeEd =  MEM_callocN(sizeof(short) * sys->numVerts, __func__);
 	sys->numNeFa =  MEM_callocN(sizeof(short) * sys->numVerts, __func__);
 	sys->ring_areas =  MEM_callocN(sizeof(float) * sys->numVerts, __func__);
@@ -196,10 +202,36 @@ static void volume_preservation(LaplacianSystem *sys, float vini, float vend, sh
 	}
 }
 
+static void laplacian_triangle_weights_task_cb(void *userdata, const int i)
+{
+	LaplacianSystem *sys = userdata;
+	const MPoly *mp = &sys->mpoly[i];
+	const MLoop *l_next = &sys->mloop[mp->loopstart];
+	const MLoop *l_term = l_next + mp->totloop;
+	const MLoop *l_prev = l_term - 2;
+	const MLoop *l_curr = l_term - 1;
+
+	for (;
+	     l_next != l_term;
+	     l_prev = l_curr, l_curr = l_next, l_next++)
+	{
+		const float *v_prev = sys->vertexCos[l_prev->v];
+		const float *v_curr = sys->vertexCos[l_curr->v];
+		const float *v_next = sys->vertexCos[l_next->v];
+		const unsigned int l_curr_index = l_curr - sys->mloop;
+
+		sys->loop_areas[l_curr_index] = area_tri_v3(v_prev, v_curr, v_next);
+
+		sys->fweights[l_curr_index][0] = cotangent_tri_weight_v3(v_curr, v_next, v_prev) / 2.0f;
+		sys->fweights[l_curr_index][1] = cotangent_tri_weight_v3(v_next, v_prev, v_curr) / 2.0f;
+		sys->fweights[l_curr_index][2] = cotangent_tri_weight_v3(v_prev, v_curr, v_next) / 2.0f;
+	}
+}
+
 static void init_laplacian_matrix(LaplacianSystem *sys)
 {
 	float *v1, *v2;
-	float w1, w2, w3;
+	float w1;
 	float areaf;
 	int i;
 	unsigned int idv1, idv2;
@@ -225,6 +257,13 @@ static void init_laplacian_matrix(LaplacianSystem *sys)
 		sys->eweights[i] = w1;
 	}
 
+	/* the cotangent weights and triangle areas are independent per loop
+	 * and by far the most expensive part, compute them in parallel */
+	BLI_task_parallel_range(0, sys->numPolys, sys, laplacian_triangle_weights_task_cb,
+	                        sys->numPolys > 512);
+
+	/* accumulate the per vertex sums serially, neighbouring triangles
+	 * scatter into the same vertices */
 	for (i = 0; i < sys->numPolys; i++) {
 		const MPoly *mp = &sys->mpoly[i];
 		const MLoop *l_next = &sys->mloop[mp->loopstart];
@@ -236,14 +275,12 @@ static void init_laplacian_matrix(LaplacianSystem *sys)
 		     l_next != l_term;
 		     l_prev = l_curr, l_curr = l_next, l_next++)
 		{
-			const float *v_prev = sys->vertexCos[l_prev->v];
-			const float *v_curr = sys->vertexCos[l_curr->v];
-			const float *v_next = sys->vertexCos[l_next->v];
 			const unsigned int l_curr_index = l_curr - sys->mloop;
+			const float *fw = sys->fweights[l_curr_index];
 
 			sys->numNeFa[l_curr->v] += 1;
 
-			areaf = area_tri_v3(v_prev, v_curr, v_next);
+			areaf = sys->loop_areas[l_curr_index];
 
 			if (areaf < sys->min_area) {
 				sys->zerola[l_curr->v] = 1;
@@ -253,17 +290,9 @@ static void init_laplacian_matrix(LaplacianSystem *sys)
 			sys->ring_areas[l_curr->v] += areaf;
 			sys->ring_areas[l_next->v] += areaf;
 
-			w1 = cotangent_tri_weight_v3(v_curr, v_next, v_prev) / 2.0f;
-			w2 = cotangent_tri_weight_v3(v_next, v_prev, v_curr) / 2.0f;
-			w3 = cotangent_tri_weight_v3(v_prev, v_curr, v_next) / 2.0f;
-
-			sys->fweights[l_curr_index][0] += w1;
-			sys->fweights[l_curr_index][1] += w2;
-			sys->fweights[l_curr_index][2] += w3;
-
-			sys->vweights[l_curr->v] += w2 + w3;
-			sys->vweights[l_next->v] += w1 + w3;
-			sys->vweights[l_prev->v] += w1 + w2;
+			sys->vweights[l_curr->v] += fw[1] + fw[2];
+			sys->vweights[l_next->v] += fw[0] + fw[2];
+			sys->vweights[l_prev->v] += fw[0] + fw[1];
 		}
 	}
 	for (i = 0; i < sys->numEdges; i++) {
@@ -366,10 +395,24 @@ static void laplaciansmoothModifier_do(
 	float w, wpaint;
 	int i, iter;
 	int defgrp_index;
-
-	sys = init_laplacian_system(dm->getNumEdges(dm), dm->getNumPolys(dm), dm->getNumLoops(dm), numVerts);
-	if (!sys) {
-		return;
+	const int numEdges = dm->getNumEdges(dm);
+	const int numPolys = dm->getNumPolys(dm);
+	const int numLoops = dm->getNumLoops(dm);
+
+	/* the system, including the solver context and its factorization, is
+	 * cached on the modifier, it only needs rebuilding when the mesh size
+	 * changed (the solver detects sparsity pattern changes itself) */
+	sys = smd->cache_system;
+	if (sys &&
+	    (sys->numVerts != numVerts || sys->numEdges != numEdges ||
+	     sys->numLoops != numLoops || sys->numPolys != numPolys))
+	{
+		delete_laplacian_system(sys);
+		sys = NULL;
+	}
+	if (sys == NULL) {
+		sys = init_laplacian_system(numEdges, numPolys, numLoops, numVerts);
+		smd->cache_system = sys;
 	}
 
 	sys->mpoly = dm->getPolyArray(dm);
@@ -384,7 +427,14 @@ static void laplaciansmoothModifier_do(
 	sys->vert_centroid[2] = 0.0f;
 	memset_laplacian_system(sys, 0);
 
-	sys->context = EIG_linear_least_squares_solver_new(numVerts, numVerts, 3);
+	if (sys->context == NULL) {
+		sys->context = EIG_linear_least_squares_solver_new(numVerts, numVerts, 3);
+	}
+	else {
+		/* re-enter the coefficients, the symbolic analysis of the previous
+		 * factorization is reused while the sparsity pattern is unchanged */
+		EIG_linear_solver_matrix_refresh(sys->context);
+	}
 
 	init_laplacian_matrix(sys);
 
@@ -456,10 +506,12 @@ static void laplaciansmoothModifier_do(
 			validate_solution(sys, smd->flag, smd->lambda, smd->lambda_border);
 		}
 	}
-	EIG_linear_solver_delete(sys->context);
-	sys->context = NULL;
 
-	delete_laplacian_system(sys);
+	/* don't keep pointers into the evaluated mesh, it is freed by the caller */
+	sys->vertexCos = NULL;
+	sys->mpoly = NULL;
+	sys->mloop = NULL;
+	sys->medges = NULL;
 }
 
 static void init_data(ModifierData *md)
@@ -474,12 +526,22 @@ static void init_data(ModifierData *md)
 
 static void copy_data(ModifierData *md, ModifierData *target)
 {
-#if 0
-	LaplacianSmoothModifierData *smd = (LaplacianSmoothModifierData *) md;
 	LaplacianSmoothModifierData *tsmd = (LaplacianSmoothModifierData *) target;
-#endif
 
 	modifier_copyData_generic(md, target);
+
+	/* the runtime cache is rebuilt by the copy on first evaluation */
+	tsmd->cache_system = NULL;
+}
+
+static void free_data(ModifierData *md)
+{
+	LaplacianSmoothModifierData *smd = (LaplacianSmoothModifierData *) md;
+
+	if (smd->cache_system) {
+		delete_laplacian_system(smd->cache_system);
+		smd->cache_system = NULL;
+	}
 }
 
 static bool is_disabled(ModifierData *md, int UNUSED(useRenderParams))
@@ -559,7 +621,7 @@ ModifierTypeInfo modifierType_LaplacianSmooth = {
 	/* applyModifierEM */   NULL,
 	/* initData */          init_data,
 	/* requiredDataMask */  required_data_mask,
-	/* freeData */          NULL,
+	/* freeData */          free_data,
 	/* isDisabled */        is_disabled,
 	/* updateDepgraph */    NULL,
 	/* updateDepsgraph */   NULL,
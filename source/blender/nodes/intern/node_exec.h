@@ -66,6 +66,9 @@ typedef struct bNodeTreeExec {
 	struct bNodeStack *stack;		/* socket data stack */
 	/* only used by material and texture trees to keep one stack for each thread */
 	ListBase *threadstack;			/* one instance of the stack for each thread */
+	/* only used by texture trees: per-thread caller data with a stable address,
+	 * so texture delegates stored in the thread stacks stay valid across calls */
+	void *threaddata;
 } bNodeTreeExec;
 
 /* stores one stack copy for each thread (material and texture trees) */
@@ -73,6 +76,7 @@ typedef struct bNodeThreadStack {
 	struct bNodeThreadStack *next, *prev;
 	struct bNodeStack *stack;
 	bool used;
+	bool delegates_set;				/* texture trees: delegates in this stack are wired up already */
 } bNodeThreadStack;
 
 int node_exec_socket_use_stack(struct bNodeSocket *sock);
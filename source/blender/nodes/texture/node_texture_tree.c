@@ -233,7 +233,11 @@ bNodeTreeExec *ntreeTexBeginExecTree_internal(bNodeExecContext *context, bNodeTr
 	
 	/* allocate the thread stack listbase array */
 	exec->threadstack = MEM_callocN(BLENDER_MAX_THREADS * sizeof(ListBase), "thread stack array");
-	
+
+	/* one persistent TexCallData per thread, so the delegates stored in the thread
+	 * stacks can keep pointing at it once they are set up (see ntreeTexExecTree) */
+	exec->threaddata = MEM_callocN(BLENDER_MAX_THREADS * sizeof(TexCallData), "tex call data array");
+
 	for (node = exec->nodetree->nodes.first; node; node = node->next)
 		node->need_exec = 1;
 	
@@ -294,7 +298,12 @@ void ntreeTexEndExecTree_internal(bNodeTreeExec *exec)
 		MEM_freeN(exec->threadstack);
 		exec->threadstack = NULL;
 	}
-	
+
+	if (exec->threaddata) {
+		MEM_freeN(exec->threaddata);
+		exec->threaddata = NULL;
+	}
+
 	ntree_exec_end(exec);
 }
 
@@ -324,25 +333,12 @@ int ntreeTexExecTree(
         ShadeInput *shi,
         MTex *mtex)
 {
-	TexCallData data;
+	TexCallData *data;
 	float *nor = texres->nor;
 	int retval = TEX_INT;
 	bNodeThreadStack *nts = NULL;
 	bNodeTreeExec *exec = nodes->execdata;
 
-	data.co = co;
-	data.dxt = dxt;
-	data.dyt = dyt;
-	data.osatex = osatex;
-	data.target = texres;
-	data.do_preview = preview;
-	data.do_manage = (shi) ? shi->do_manage : true;
-	data.thread = thread;
-	data.which_output = which_output;
-	data.cfra = cfra;
-	data.mtex = mtex;
-	data.shi = shi;
-	
 	/* ensure execdata is only initialized once */
 	if (!exec) {
 		BLI_lock_thread(LOCK_NODES);
@@ -352,9 +348,48 @@ int ntreeTexExecTree(
 
 		exec = nodes->execdata;
 	}
-	
+
+	/* refresh this thread's call data in place; the delegates in the thread
+	 * stack keep pointing at this address across calls */
+	data = &((TexCallData *)exec->threaddata)[thread];
+	data->co = co;
+	data->dxt = dxt;
+	data->dyt = dyt;
+	data->osatex = osatex;
+	data->target = texres;
+	data->do_preview = preview;
+	data->do_manage = (shi) ? shi->do_manage : true;
+	data->thread = thread;
+	data->which_output = which_output;
+	data->cfra = cfra;
+	data->mtex = mtex;
+	data->shi = shi;
+
 	nts = ntreeGetThreadStack(exec, thread);
-	ntreeExecThreadNodes(exec, nts, &data, thread);
+	if (nts->delegates_set) {
+		/* the delegates in this stack are wired up already and evaluation is
+		 * pulled through them lazily, so only the output nodes do per-sample
+		 * work; skip re-executing the rest of the tree */
+		bNodeStack *nsin[MAX_SOCKET] = {NULL};
+		bNodeStack *nsout[MAX_SOCKET] = {NULL};
+		bNodeExec *nodeexec;
+		bNode *node;
+		int n;
+
+		for (n = 0, nodeexec = exec->nodeexec; n < exec->totnodes; ++n, ++nodeexec) {
+			node = nodeexec->node;
+			if (!ELEM(node->type, TEX_NODE_OUTPUT, TEX_NODE_VIEWER))
+				continue;
+			if (node->need_exec && node->typeinfo->execfunc && !(node->flag & NODE_MUTED)) {
+				node_get_stack(node, nts->stack, nsin, nsout);
+				node->typeinfo->execfunc(data, thread, node, &nodeexec->data, nsin, nsout);
+			}
+		}
+	}
+	else {
+		ntreeExecThreadNodes(exec, nts, data, thread);
+		nts->delegates_set = true;
+	}
 	ntreeReleaseThreadStack(nts);
 
 	if (texres->nor) retval |= TEX_NOR;
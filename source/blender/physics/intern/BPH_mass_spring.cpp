@@ -680,6 +680,9 @@ static void cloth_continuum_fill_grid(HairGrid *grid, Cloth *cloth)
 		else
 			link = link->next;
 	}
+	
+	/* the segments are only buffered above, rasterize them all in one go */
+	BPH_hair_volume_scatter_segments(grid);
 #endif
 	BPH_hair_volume_normalize_vertex_grid(grid);
 }
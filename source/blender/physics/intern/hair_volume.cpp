@@ -33,6 +33,7 @@
 
 extern "C" {
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_texture_types.h"
@@ -86,11 +87,20 @@ typedef struct HairGridVert {
 	float velocity_smooth[3];
 } HairGridVert;
 
+typedef struct HairGridSegment {
+	float x2[3], v2[3], x3[3], v3[3];
+} HairGridSegment;
+
 typedef struct HairGrid {
 	HairGridVert *verts;
 	int res[3];
 	float gmin[3], gmax[3];
 	float cellsize, inv_cellsize;
+	
+	/* segments buffered by BPH_hair_volume_add_segment, rasterized
+	 * tile-parallel in BPH_hair_volume_scatter_segments */
+	HairGridSegment *segments;
+	int totsegments, maxsegments;
 } HairGrid;
 
 #define HAIR_GRID_INDEX_AXIS(vec, res, gmin, scale, axis) ( min_ii( max_ii( (int)((vec[axis] - gmin[axis]) * scale), 0), res[axis]-2 ) )
@@ -255,6 +265,7 @@ void BPH_hair_volume_grid_clear(HairGrid *grid)
 		grid->verts[i].density = 0.0f;
 		grid->verts[i].samples = 0;
 	}
+	grid->totsegments = 0;
 }
 
 BLI_INLINE bool hair_grid_point_valid(const float vec[3], float gmin[3], float gmax[3])
@@ -525,12 +536,71 @@ BLI_INLINE void hair_volume_eval_grid_vertex_sample(HairGridVert *vert, const fl
 
 /* XXX simplified test implementation using a series of discrete sample along the segment,
  * instead of finding the closest point for all affected grid vertices.
+ *
+ * Segments are only buffered here; BPH_hair_volume_scatter_segments rasterizes
+ * all of them in one go.  The grid is split into tiles of
+ * HAIR_GRID_TILE_SIZE^3 cells, segments are binned by the tiles their support
+ * overlaps, and the tiles then scatter independently: every cell is written by
+ * exactly one task, so no locks or merge passes are needed, and tiles without
+ * any segments are never visited at all.
  */
 void BPH_hair_volume_add_segment(HairGrid *grid,
                                  const float UNUSED(x1[3]), const float UNUSED(v1[3]), const float x2[3], const float v2[3],
                                  const float x3[3], const float v3[3], const float UNUSED(x4[3]), const float UNUSED(v4[3]),
                                  const float UNUSED(dir1[3]), const float UNUSED(dir2[3]), const float UNUSED(dir3[3]))
 {
+	HairGridSegment *seg;
+	
+	if (grid->totsegments == grid->maxsegments) {
+		grid->maxsegments = grid->maxsegments ? grid->maxsegments * 2 : 1024;
+		if (grid->segments)
+			grid->segments = (HairGridSegment *)MEM_reallocN(grid->segments, sizeof(HairGridSegment) * grid->maxsegments);
+		else
+			grid->segments = (HairGridSegment *)MEM_mallocN(sizeof(HairGridSegment) * grid->maxsegments, "hair grid segments");
+	}
+	
+	seg = &grid->segments[grid->totsegments++];
+	copy_v3_v3(seg->x2, x2);
+	copy_v3_v3(seg->v2, v2);
+	copy_v3_v3(seg->x3, x3);
+	copy_v3_v3(seg->v3, v3);
+}
+
+/* cells per tile edge for the parallel scatter */
+#define HAIR_GRID_TILE_SIZE 8
+/* cells around each segment sample that receive a contribution, see the sample loop */
+#define HAIR_GRID_SEGMENT_SUPPORT 2
+/* scatter through the task scheduler above this segment count */
+#define HAIR_GRID_THREADED_LIMIT 1024
+
+BLI_INLINE void hair_volume_segment_tile_range(const HairGridSegment *seg, const int res[3],
+                                               int tmin[3], int tmax[3])
+{
+	int axis;
+	
+	for (axis = 0; axis < 3; ++axis) {
+		float a = min_ff(seg->x2[axis], seg->x3[axis]);
+		float b = max_ff(seg->x2[axis], seg->x3[axis]);
+		int cmin = max_ii(floor_int(a) - HAIR_GRID_SEGMENT_SUPPORT, 0);
+		int cmax = min_ii(floor_int(b) + HAIR_GRID_SEGMENT_SUPPORT, res[axis] - 1);
+		
+		tmin[axis] = cmin / HAIR_GRID_TILE_SIZE;
+		tmax[axis] = cmax / HAIR_GRID_TILE_SIZE;
+	}
+}
+
+typedef struct HairGridScatterData {
+	HairGrid *grid;
+	int tileres[3];
+	const int *tiles;          /* indices of nonempty tiles */
+	const int *tile_offsets;   /* per tile range in tile_segments, tottiles + 1 */
+	const int *tile_segments;  /* segment indices binned by tile, in insertion order */
+} HairGridScatterData;
+
+static void hair_volume_scatter_tile_cb(void *userdata, const int n)
+{
+	HairGridScatterData *data = (HairGridScatterData *)userdata;
+	HairGrid *grid = data->grid;
 	const float radius = 1.5f;
 	const float dist_scale = grid->inv_cellsize;
 	
@@ -538,35 +608,117 @@ void BPH_hair_volume_add_segment(HairGrid *grid,
 	const int stride[3] = { 1, res[0], res[0] * res[1] };
 	const int num_samples = 10;
 	
-	int s;
+	const int tile = data->tiles[n];
+	int tmin[3], tmax[3]; /* inclusive cell bounds of this tile */
+	int t;
 	
-	for (s = 0; s < num_samples; ++s) {
-		float x[3], v[3];
-		int i, j, k;
-		
-		float f = (float)s / (float)(num_samples-1);
-		interp_v3_v3v3(x, x2, x3, f);
-		interp_v3_v3v3(v, v2, v3, f);
-		
-		int imin = max_ii(floor_int(x[0]) - 2, 0);
-		int imax = min_ii(floor_int(x[0]) + 2, res[0]-1);
-		int jmin = max_ii(floor_int(x[1]) - 2, 0);
-		int jmax = min_ii(floor_int(x[1]) + 2, res[1]-1);
-		int kmin = max_ii(floor_int(x[2]) - 2, 0);
-		int kmax = min_ii(floor_int(x[2]) + 2, res[2]-1);
+	tmin[0] = (tile % data->tileres[0]) * HAIR_GRID_TILE_SIZE;
+	tmin[1] = ((tile / data->tileres[0]) % data->tileres[1]) * HAIR_GRID_TILE_SIZE;
+	tmin[2] = (tile / (data->tileres[0] * data->tileres[1])) * HAIR_GRID_TILE_SIZE;
+	tmax[0] = min_ii(tmin[0] + HAIR_GRID_TILE_SIZE - 1, res[0] - 1);
+	tmax[1] = min_ii(tmin[1] + HAIR_GRID_TILE_SIZE - 1, res[1] - 1);
+	tmax[2] = min_ii(tmin[2] + HAIR_GRID_TILE_SIZE - 1, res[2] - 1);
+	
+	for (t = data->tile_offsets[tile]; t < data->tile_offsets[tile + 1]; ++t) {
+		const HairGridSegment *seg = &grid->segments[data->tile_segments[t]];
+		int s;
 		
-		for (k = kmin; k <= kmax; ++k) {
-			for (j = jmin; j <= jmax; ++j) {
-				for (i = imin; i <= imax; ++i) {
-					float loc[3] = { (float)i, (float)j, (float)k };
-					HairGridVert *vert = grid->verts + i * stride[0] + j * stride[1] + k * stride[2];
-					
-					hair_volume_eval_grid_vertex_sample(vert, loc, radius, dist_scale, x, v);
+		for (s = 0; s < num_samples; ++s) {
+			float x[3], v[3];
+			int i, j, k;
+			
+			float f = (float)s / (float)(num_samples-1);
+			interp_v3_v3v3(x, seg->x2, seg->x3, f);
+			interp_v3_v3v3(v, seg->v2, seg->v3, f);
+			
+			/* sample support, clamped to the cells this tile owns */
+			int imin = max_ii(floor_int(x[0]) - HAIR_GRID_SEGMENT_SUPPORT, tmin[0]);
+			int imax = min_ii(floor_int(x[0]) + HAIR_GRID_SEGMENT_SUPPORT, tmax[0]);
+			int jmin = max_ii(floor_int(x[1]) - HAIR_GRID_SEGMENT_SUPPORT, tmin[1]);
+			int jmax = min_ii(floor_int(x[1]) + HAIR_GRID_SEGMENT_SUPPORT, tmax[1]);
+			int kmin = max_ii(floor_int(x[2]) - HAIR_GRID_SEGMENT_SUPPORT, tmin[2]);
+			int kmax = min_ii(floor_int(x[2]) + HAIR_GRID_SEGMENT_SUPPORT, tmax[2]);
+			
+			for (k = kmin; k <= kmax; ++k) {
+				for (j = jmin; j <= jmax; ++j) {
+					for (i = imin; i <= imax; ++i) {
+						float loc[3] = { (float)i, (float)j, (float)k };
+						HairGridVert *vert = grid->verts + i * stride[0] + j * stride[1] + k * stride[2];
+						
+						hair_volume_eval_grid_vertex_sample(vert, loc, radius, dist_scale, x, v);
+					}
 				}
 			}
 		}
 	}
 }
+
+void BPH_hair_volume_scatter_segments(HairGrid *grid)
+{
+	HairGridScatterData data;
+	int tileres[3], tottiles, tottiles_used;
+	int *tile_offsets, *tile_segments, *cursor, *tiles;
+	int n, ti, tj, tk;
+	
+	if (grid->totsegments == 0)
+		return;
+	
+	tileres[0] = (grid->res[0] + HAIR_GRID_TILE_SIZE - 1) / HAIR_GRID_TILE_SIZE;
+	tileres[1] = (grid->res[1] + HAIR_GRID_TILE_SIZE - 1) / HAIR_GRID_TILE_SIZE;
+	tileres[2] = (grid->res[2] + HAIR_GRID_TILE_SIZE - 1) / HAIR_GRID_TILE_SIZE;
+	tottiles = tileres[0] * tileres[1] * tileres[2];
+	
+	/* bin segments by the tiles their support overlaps (counting sort) */
+	tile_offsets = (int *)MEM_callocN(sizeof(int) * (tottiles + 1), "hair grid tile offsets");
+	
+	for (n = 0; n < grid->totsegments; ++n) {
+		int tmin[3], tmax[3];
+		hair_volume_segment_tile_range(&grid->segments[n], grid->res, tmin, tmax);
+		for (tk = tmin[2]; tk <= tmax[2]; ++tk)
+			for (tj = tmin[1]; tj <= tmax[1]; ++tj)
+				for (ti = tmin[0]; ti <= tmax[0]; ++ti)
+					tile_offsets[(ti + (tj + tk * tileres[1]) * tileres[0]) + 1]++;
+	}
+	
+	for (n = 1; n <= tottiles; ++n)
+		tile_offsets[n] += tile_offsets[n - 1];
+	
+	tile_segments = (int *)MEM_mallocN(sizeof(int) * tile_offsets[tottiles], "hair grid tile segments");
+	cursor = (int *)MEM_dupallocN(tile_offsets);
+	
+	for (n = 0; n < grid->totsegments; ++n) {
+		int tmin[3], tmax[3];
+		hair_volume_segment_tile_range(&grid->segments[n], grid->res, tmin, tmax);
+		for (tk = tmin[2]; tk <= tmax[2]; ++tk)
+			for (tj = tmin[1]; tj <= tmax[1]; ++tj)
+				for (ti = tmin[0]; ti <= tmax[0]; ++ti)
+					tile_segments[cursor[ti + (tj + tk * tileres[1]) * tileres[0]]++] = n;
+	}
+	
+	/* only nonempty tiles get a task, empty space costs nothing */
+	tiles = (int *)MEM_mallocN(sizeof(int) * tottiles, "hair grid tile list");
+	tottiles_used = 0;
+	for (n = 0; n < tottiles; ++n) {
+		if (tile_offsets[n + 1] > tile_offsets[n])
+			tiles[tottiles_used++] = n;
+	}
+	
+	data.grid = grid;
+	copy_v3_v3_int(data.tileres, tileres);
+	data.tiles = tiles;
+	data.tile_offsets = tile_offsets;
+	data.tile_segments = tile_segments;
+	
+	BLI_task_parallel_range(0, tottiles_used, &data, hair_volume_scatter_tile_cb,
+	                        grid->totsegments > HAIR_GRID_THREADED_LIMIT);
+	
+	MEM_freeN(tiles);
+	MEM_freeN(cursor);
+	MEM_freeN(tile_segments);
+	MEM_freeN(tile_offsets);
+	
+	grid->totsegments = 0;
+}
 #endif
 
 void BPH_hair_volume_normalize_vertex_grid(HairGrid *grid)
@@ -1016,6 +1168,8 @@ void BPH_hair_volume_free_vertex_grid(HairGrid *grid)
 	if (grid) {
 		if (grid->verts)
 			MEM_freeN(grid->verts);
+		if (grid->segments)
+			MEM_freeN(grid->segments);
 		MEM_freeN(grid);
 	}
 }
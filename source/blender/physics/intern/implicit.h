@@ -146,6 +146,8 @@ void BPH_hair_volume_add_segment(struct HairGrid *grid,
                                  const float x1[3], const float v1[3], const float x2[3], const float v2[3],
                                  const float x3[3], const float v3[3], const float x4[3], const float v4[3],
                                  const float dir1[3], const float dir2[3], const float dir3[3]);
+/* rasterize all buffered segments into the grid, tile-parallel */
+void BPH_hair_volume_scatter_segments(struct HairGrid *grid);
 
 void BPH_hair_volume_normalize_vertex_grid(struct HairGrid *grid);
 
@@ -43,6 +43,7 @@
 
 #include "BLI_math.h"
 #include "BLI_linklist.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_cloth.h"
@@ -60,6 +61,9 @@
 #  define CLOTH_OPENMP_LIMIT 512
 #endif
 
+/* threshold above which the solver kernels go through the task scheduler */
+#define CLOTH_PARALLEL_LIMIT 512
+
 //#define DEBUG_TIME
 
 #ifdef DEBUG_TIME
@@ -617,6 +621,162 @@ DO_INLINE void mul_bfmatrix_lfvector( float (*to)[3], fmatrix3x3 *from, lfVector
 	
 }
 
+/* The loops above scatter into rows shared between springs, which cannot run
+ * over multiple threads. This CSR-style index lists, for every block row, the
+ * blocks contributing to it and which operand vertex they multiply, so the
+ * product can instead gather whole rows independently in parallel.
+ * All matrices of an Implicit_Data share one block structure (see
+ * BPH_mass_spring_init_spring), so a single index serves them all. */
+typedef struct fmatrixRowIndex {
+	unsigned int *offsets;  /* vcount + 1 */
+	unsigned int *entries;  /* block index * 2, low bit set when the block's
+	                         * row vertex supplies the multiplied operand */
+} fmatrixRowIndex;
+
+static fmatrixRowIndex *create_bfmatrix_row_index(fmatrix3x3 *matrix)
+{
+	const unsigned int vcount = matrix[0].vcount;
+	const unsigned int scount = matrix[0].scount;
+	fmatrixRowIndex *index = MEM_mallocN(sizeof(*index), "cloth matrix row index");
+	unsigned int *cursor;
+	unsigned int i;
+
+	index->offsets = MEM_callocN(sizeof(*index->offsets) * (vcount + 1), "cloth matrix row offsets");
+	/* every diagonal block contributes to one row, every spring block to two */
+	index->entries = MEM_mallocN(sizeof(*index->entries) * (vcount + 2 * scount), "cloth matrix row entries");
+
+	for (i = 0; i < vcount + scount; i++) {
+		index->offsets[matrix[i].r + 1]++;
+		if (i >= vcount)
+			index->offsets[matrix[i].c + 1]++;
+	}
+	for (i = 0; i < vcount; i++)
+		index->offsets[i + 1] += index->offsets[i];
+
+	cursor = MEM_dupallocN(index->offsets);
+	for (i = 0; i < vcount + scount; i++) {
+		index->entries[cursor[matrix[i].r]++] = i << 1;
+		if (i >= vcount)
+			index->entries[cursor[matrix[i].c]++] = (i << 1) | 1;
+	}
+	MEM_freeN(cursor);
+
+	return index;
+}
+
+static void del_bfmatrix_row_index(fmatrixRowIndex *index)
+{
+	if (index != NULL) {
+		MEM_freeN(index->offsets);
+		MEM_freeN(index->entries);
+		MEM_freeN(index);
+	}
+}
+
+typedef struct MulBfmatrixData {
+	float (*to)[3];
+	fmatrix3x3 *from;
+	lfVector *vec;
+	const fmatrixRowIndex *index;
+} MulBfmatrixData;
+
+static void mul_bfmatrix_lfvector_task_cb(void *userdata, const int j)
+{
+	MulBfmatrixData *data = userdata;
+	const fmatrixRowIndex *index = data->index;
+	unsigned int k;
+
+	zero_v3(data->to[j]);
+	for (k = index->offsets[j]; k < index->offsets[j + 1]; k++) {
+		const unsigned int e = index->entries[k];
+		fmatrix3x3 *block = &data->from[e >> 1];
+
+		muladd_fmatrix_fvector(data->to[j], block->m, data->vec[(e & 1) ? block->r : block->c]);
+	}
+}
+
+/* SPARSE SYMMETRIC multiply big matrix with long vector, gathering per block
+ * row through the task scheduler; also saves the temporary vector the
+ * scattering version needs */
+static void mul_bfmatrix_lfvector_parallel(
+        float (*to)[3], fmatrix3x3 *from, const fmatrixRowIndex *index, lfVector *fLongVector)
+{
+	MulBfmatrixData data = {to, from, fLongVector, index};
+
+	BLI_task_parallel_range(0, from[0].vcount, &data, mul_bfmatrix_lfvector_task_cb,
+	                        from[0].vcount > CLOTH_PARALLEL_LIMIT);
+}
+
+/* threaded variants of the long-vector ops the CG loop spends its time in,
+ * processing fixed size chunks so results stay deterministic */
+#define CLOTH_VECTOR_CHUNK 4096
+
+typedef struct LfVectorTaskData {
+	float (*to)[3];
+	float (*vec_a)[3];
+	float (*vec_b)[3];
+	float scalar;
+	float *partial;
+	unsigned int verts;
+} LfVectorTaskData;
+
+static void add_lfvector_lfvectorS_task_cb(void *userdata, const int n)
+{
+	LfVectorTaskData *data = userdata;
+	const unsigned int start = (unsigned int)n * CLOTH_VECTOR_CHUNK;
+	const unsigned int end = min_ii(start + CLOTH_VECTOR_CHUNK, data->verts);
+
+	add_lfvector_lfvectorS(data->to + start, data->vec_a + start, data->vec_b + start,
+	                       data->scalar, end - start);
+}
+
+static void add_lfvector_lfvectorS_threaded(
+        float (*to)[3], float (*fLongVectorA)[3], float (*fLongVectorB)[3], float bS, unsigned int verts)
+{
+	if (verts > CLOTH_PARALLEL_LIMIT) {
+		LfVectorTaskData data = {to, fLongVectorA, fLongVectorB, bS, NULL, verts};
+
+		BLI_task_parallel_range(0, (verts + CLOTH_VECTOR_CHUNK - 1) / CLOTH_VECTOR_CHUNK,
+		                        &data, add_lfvector_lfvectorS_task_cb, true);
+	}
+	else {
+		add_lfvector_lfvectorS(to, fLongVectorA, fLongVectorB, bS, verts);
+	}
+}
+
+static void dot_lfvector_task_cb(void *userdata, const int n)
+{
+	LfVectorTaskData *data = userdata;
+	const unsigned int start = (unsigned int)n * CLOTH_VECTOR_CHUNK;
+	const unsigned int end = min_ii(start + CLOTH_VECTOR_CHUNK, data->verts);
+
+	data->partial[n] = dot_lfvector(data->vec_a + start, data->vec_b + start, end - start);
+}
+
+/* unlike an unordered parallel reduction (see the disabled omp pragma on
+ * dot_lfvector), fixed chunk boundaries and a serial final sum give the same
+ * result on every run */
+static float dot_lfvector_threaded(float (*fLongVectorA)[3], float (*fLongVectorB)[3], unsigned int verts)
+{
+	if (verts > CLOTH_PARALLEL_LIMIT) {
+		const int tot_chunk = (verts + CLOTH_VECTOR_CHUNK - 1) / CLOTH_VECTOR_CHUNK;
+		float *partial = MEM_mallocN(sizeof(*partial) * tot_chunk, "cloth dot partial");
+		LfVectorTaskData data = {NULL, fLongVectorA, fLongVectorB, 0.0f, partial, verts};
+		float temp = 0.0f;
+		int n;
+
+		BLI_task_parallel_range(0, tot_chunk, &data, dot_lfvector_task_cb, true);
+
+		for (n = 0; n < tot_chunk; n++)
+			temp += partial[n];
+		MEM_freeN(partial);
+
+		return temp;
+	}
+
+	return dot_lfvector(fLongVectorA, fLongVectorB, verts);
+}
+
 /* SPARSE SYMMETRIC sub big matrix with big matrix*/
 /* A -= B * float + C * float --> for big matrix */
 /* VERIFIED */
@@ -656,6 +816,8 @@ typedef struct Implicit_Data  {
 	lfVector *z;				/* target velocity in constrained directions */
 	fmatrix3x3 *S;				/* filtering matrix for constraints */
 	fmatrix3x3 *P, *Pinv;		/* pre-conditioning matrix */
+	fmatrixRowIndex *row_index;	/* block structure shared by all matrices, built
+								 * lazily once the springs are known */
 } Implicit_Data;
 
 Implicit_Data *BPH_mass_spring_solver_create(int numverts, int numsprings)
@@ -697,6 +859,7 @@ void BPH_mass_spring_solver_free(Implicit_Data *id)
 	del_bfmatrix(id->Pinv);
 	del_bfmatrix(id->bigI);
 	del_bfmatrix(id->M);
+	del_bfmatrix_row_index(id->row_index);
 	
 	del_lfvector(id->X);
 	del_lfvector(id->Xnew);
@@ -814,7 +977,8 @@ static int  cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z
 }
 #endif
 
-static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z, fmatrix3x3 *S, ImplicitSolverResult *result)
+static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, const fmatrixRowIndex *index,
+                       lfVector *lB, lfVector *z, fmatrix3x3 *S, ImplicitSolverResult *result)
 {
 	// Solves for unknown X in equation AX=B
 	unsigned int conjgrad_loopcount=0, conjgrad_looplimit=100;
@@ -834,11 +998,11 @@ static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z,
 	/* d0 = filter(B)^T * P * filter(B) */
 	cp_lfvector(fB, lB, numverts);
 	filter(fB, S);
-	bnorm2 = dot_lfvector(fB, fB, numverts);
+	bnorm2 = dot_lfvector_threaded(fB, fB, numverts);
 	delta_target = conjgrad_epsilon*conjgrad_epsilon * bnorm2;
 	
 	/* r = filter(B - A * dV) */
-	mul_bfmatrix_lfvector(AdV, lA, ldV);
+	mul_bfmatrix_lfvector_parallel(AdV, lA, index, ldV);
 	sub_lfvector_lfvector(r, lB, AdV, numverts);
 	filter(r, S);
 	
@@ -847,7 +1011,7 @@ static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z,
 	filter(c, S);
 	
 	/* delta = r^T * c */
-	delta_new = dot_lfvector(r, c, numverts);
+	delta_new = dot_lfvector_threaded(r, c, numverts);
 	
 #ifdef IMPLICIT_PRINT_SOLVER_INPUT_OUTPUT
 	printf("==== A ====\n");
@@ -861,21 +1025,21 @@ static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z,
 #endif
 	
 	while (delta_new > delta_target && conjgrad_loopcount < conjgrad_looplimit) {
-		mul_bfmatrix_lfvector(q, lA, c);
+		mul_bfmatrix_lfvector_parallel(q, lA, index, c);
 		filter(q, S);
 		
-		alpha = delta_new / dot_lfvector(c, q, numverts);
+		alpha = delta_new / dot_lfvector_threaded(c, q, numverts);
 		
-		add_lfvector_lfvectorS(ldV, ldV, c, alpha, numverts);
+		add_lfvector_lfvectorS_threaded(ldV, ldV, c, alpha, numverts);
 		
-		add_lfvector_lfvectorS(r, r, q, -alpha, numverts);
+		add_lfvector_lfvectorS_threaded(r, r, q, -alpha, numverts);
 		
 		/* s = P^-1 * r */
 		cp_lfvector(s, r, numverts);
 		delta_old = delta_new;
-		delta_new = dot_lfvector(r, s, numverts);
+		delta_new = dot_lfvector_threaded(r, s, numverts);
 		
-		add_lfvector_lfvectorS(c, s, c, delta_new / delta_old, numverts);
+		add_lfvector_lfvectorS_threaded(c, s, c, delta_new / delta_old, numverts);
 		filter(c, S);
 		
 		conjgrad_loopcount++;
@@ -1105,11 +1269,14 @@ bool BPH_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
 	lfVector *dFdXmV = create_lfvector(numverts);
 	zero_lfvector(data->dV, numverts);
 
+	if (data->row_index == NULL)
+		data->row_index = create_bfmatrix_row_index(data->A);
+
 	cp_bfmatrix(data->A, data->M);
 
 	subadd_bfmatrixS_bfmatrixS(data->A, data->dFdV, dt, data->dFdX, (dt*dt));
 
-	mul_bfmatrix_lfvector(dFdXmV, data->dFdX, data->V);
+	mul_bfmatrix_lfvector_parallel(dFdXmV, data->dFdX, data->row_index, data->V);
 
 	add_lfvectorS_lfvectorS(data->B, data->F, dt, dFdXmV, (dt*dt), numverts);
 
@@ -1117,7 +1284,7 @@ bool BPH_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
 	double start = PIL_check_seconds_timer();
 #endif
 
-	cg_filtered(data->dV, data->A, data->B, data->z, data->S, result); /* conjugate gradient algorithm to solve Ax=b */
+	cg_filtered(data->dV, data->A, data->row_index, data->B, data->z, data->S, result); /* conjugate gradient algorithm to solve Ax=b */
 	// cg_filtered_pre(id->dV, id->A, id->B, id->z, id->S, id->P, id->Pinv, id->bigI);
 
 #ifdef DEBUG_TIME
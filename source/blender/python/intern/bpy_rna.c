@@ -4700,6 +4700,21 @@ static bool foreach_compat_buffer(RawPropertyType raw_type, int attr_signed, con
 	return 0;
 }
 
+/* raw type matching the buffer format, for mismatched but still supported
+ * buffers where rna can convert per element (unsigned formats excluded,
+ * conversion would reinterpret their values) */
+static RawPropertyType foreach_buffer_raw_type(const char *format)
+{
+	switch (format ? *format : 'B') {
+		case 'b': return PROP_RAW_CHAR;
+		case 'h': return PROP_RAW_SHORT;
+		case 'i': return PROP_RAW_INT;
+		case 'f': return PROP_RAW_FLOAT;
+		case 'd': return PROP_RAW_DOUBLE;
+		default:  return PROP_RAW_UNSET;
+	}
+}
+
 static PyObject *foreach_getset(BPy_PropertyRNA *self, PyObject *args, int set)
 {
 	PyObject *item = NULL;
@@ -4735,6 +4750,15 @@ static PyObject *foreach_getset(BPy_PropertyRNA *self, PyObject *args, int set)
 			if (buffer_is_compat) {
 				ok = RNA_property_collection_raw_set(NULL, &self->ptr, self->prop, attr, buf.buf, raw_type, tot);
 			}
+			else {
+				/* pass the buffers own raw type and let rna convert,
+				 * still much faster than the sequence fallback below */
+				const RawPropertyType buf_type = foreach_buffer_raw_type(buf.format);
+				if (buf_type != PROP_RAW_UNSET) {
+					ok = RNA_property_collection_raw_set(NULL, &self->ptr, self->prop, attr, buf.buf, buf_type, tot);
+					buffer_is_compat = true;
+				}
+			}
 
 			PyBuffer_Release(&buf);
 		}
@@ -4786,6 +4810,13 @@ static PyObject *foreach_getset(BPy_PropertyRNA *self, PyObject *args, int set)
 			if (buffer_is_compat) {
 				ok = RNA_property_collection_raw_get(NULL, &self->ptr, self->prop, attr, buf.buf, raw_type, tot);
 			}
+			else {
+				const RawPropertyType buf_type = foreach_buffer_raw_type(buf.format);
+				if (buf_type != PROP_RAW_UNSET) {
+					ok = RNA_property_collection_raw_get(NULL, &self->ptr, self->prop, attr, buf.buf, buf_type, tot);
+					buffer_is_compat = true;
+				}
+			}
 
 			PyBuffer_Release(&buf);
 		}
@@ -167,7 +167,12 @@ typedef struct RenderResult {
 	
 	/* optional saved endresult on disk */
 	int do_exr_tile;
-	
+
+	/* bulky passes flushed to a scratch exr file, read back on first access,
+	 * see render_result_passes_spill */
+	int passes_spilled;
+	char *spill_path;
+
 	/* for render results in Image, verify validity for sequences */
 	int framenr;
 
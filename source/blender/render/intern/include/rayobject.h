@@ -53,6 +53,14 @@ typedef struct RayObject RayObject;
 
 int RE_rayobject_raycast(RayObject *r, struct Isect *i);
 
+/* Casts up to 4 coherent shadow rays at once, equivalent to calling
+ * RE_rayobject_raycast on each Isect individually (including the last hit
+ * heuristic). Only valid for occlusion queries, where any hit terminates a
+ * ray. Acceleration structures with packet support traverse all rays in one
+ * pass, others fall back to ray by ray traversal. Returns the number of rays
+ * that hit something. */
+int RE_rayobject_raycast_shadow_packet4(RayObject *r, struct Isect **isecs, int num);
+
 /* Acceleration Structures */
 
 RayObject *RE_rayobject_octree_create(int ocres, int size);
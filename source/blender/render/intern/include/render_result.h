@@ -94,6 +94,11 @@ int render_result_exr_file_read_path(struct RenderResult *rr, struct RenderLayer
 void render_result_exr_file_cache_write(struct Render *re);
 bool render_result_exr_file_cache_read(struct Render *re);
 
+/* Spilled pass backing store */
+
+void render_result_passes_spill(struct RenderResult *rr);
+bool render_result_passes_ensure(struct RenderResult *rr);
+
 /* Combined Pixel Rect */
 
 struct ImBuf *render_result_rect_to_ibuf(struct RenderResult *rr, struct RenderData *rd, const int view_id);
@@ -228,6 +228,11 @@ struct Render {
 	
 	struct GHash *orco_hash;
 
+	/* compiled shadow buffers kept between frames (shadbuf.c), these
+	 * survive RE_Database_Free so sequence renders can reuse them */
+	ListBase shadbufcache;
+	unsigned int shadbufdbhash;
+
 	struct GHash *sss_hash;
 	ListBase *sss_points;
 	struct Material *sss_mat;
@@ -307,7 +312,8 @@ typedef struct ShadBuf {
 	int co[3];
 	int size, bias;
 	ListBase buffers;
-	
+	unsigned int cachehash;	/* key in the shadow buffer cache */
+
 	/* irregular shadowbufer, result stored per thread */
 	struct ISBData *isb_result[BLENDER_MAX_THREADS];
 } ShadBuf;
@@ -36,6 +36,7 @@
 
 struct ShadeInput;
 struct ShadeResult;
+struct ShadeSample;
 struct World;
 struct RenderPart;
 struct RenderLayer;
@@ -89,6 +90,9 @@ struct RayObject* makeraytree_object(Render *re, ObjectInstanceRen *obi);
 extern void ray_shadow(ShadeInput *shi, LampRen *lar, float shadfac[4]);
 extern void ray_trace(ShadeInput *shi, ShadeResult *);
 extern void ray_ao(ShadeInput *shi, float ao[3], float env[3]);
+extern int rayao_cache_enabled(Render *re);
+extern void cache_rayao_samples(Render *re, struct RenderPart *pa, struct ShadeSample *ssamp);
+extern void free_rayao_samples(Render *re, struct RenderPart *pa);
 extern void init_jitter_plane(LampRen *lar);
 extern void init_ao_sphere(struct World *wrld);
 extern void init_render_qmcsampler(Render *re);
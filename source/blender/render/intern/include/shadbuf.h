@@ -44,6 +44,16 @@ void freeshadowbuf(struct LampRen *lar);
 
 void threaded_makeshadowbufs(struct Render *re);
 
+/**
+ * Moves a compiled shadow buffer into the cache on the Render instead of
+ * freeing it, so the next frame can reuse it when lamp and casters are
+ * unchanged. Trim throws away cached buffers that found no lamp to reuse
+ * them, call it once all lamps are stored.
+ */
+void shadowbuf_cache_store(struct Render *re, struct LampRen *lar);
+void shadowbuf_cache_trim(struct Render *re);
+void shadowbuf_cache_free(struct Render *re);
+
 /**
  * Determines the shadow factor for a face and lamp. There is some
  * communication with global variables here.
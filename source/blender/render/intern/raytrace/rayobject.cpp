@@ -431,6 +431,66 @@ int RE_rayobject_raycast(RayObject *r, Isect *isec)
 	return 0;
 }
 
+int RE_rayobject_raycast_shadow_packet4(RayObject *r, Isect **isecs, int num)
+{
+	Isect *pending[4];
+	int num_pending = 0;
+	int hits = 0;
+	int i, j;
+
+	assert(num > 0 && num <= 4);
+
+	for (j = 0; j < num; j++) {
+		Isect *isec = isecs[j];
+
+		RE_RC_COUNT(isec->raycounter->raycast.test);
+
+		/* setup vars used on raycast */
+		for (i = 0; i < 3; i++) {
+			isec->idot_axis[i]          = 1.0f / isec->dir[i];
+
+			isec->bv_index[2 * i]       = isec->idot_axis[i] < 0.0f ? 1 : 0;
+			isec->bv_index[2 * i + 1]   = 1 - isec->bv_index[2 * i];
+
+			isec->bv_index[2 * i]       = i + 3 * isec->bv_index[2 * i];
+			isec->bv_index[2 * i + 1]   = i + 3 * isec->bv_index[2 * i + 1];
+		}
+
+#ifdef RT_USE_LAST_HIT
+		/* last hit heuristic */
+		if (isec->mode == RE_RAY_SHADOW && isec->last_hit) {
+			RE_RC_COUNT(isec->raycounter->rayshadow_last_hit.test);
+
+			if (RE_rayobject_intersect(isec->last_hit, isec)) {
+				RE_RC_COUNT(isec->raycounter->raycast.hit);
+				RE_RC_COUNT(isec->raycounter->rayshadow_last_hit.hit);
+				hits++;
+				continue;
+			}
+		}
+#endif
+
+		pending[num_pending++] = isec;
+	}
+
+	if (num_pending == 0)
+		return hits;
+
+	if (RE_rayobject_isRayAPI(r)) {
+		RayObject *ra = RE_rayobject_align(r);
+
+		if (ra->api->raycast_shadow_packet4)
+			return hits + ra->api->raycast_shadow_packet4(ra, pending, num_pending);
+	}
+
+	/* structures without packet support traverse ray by ray */
+	for (j = 0; j < num_pending; j++)
+		if (RE_rayobject_intersect(r, pending[j]))
+			hits++;
+
+	return hits;
+}
+
 int RE_rayobject_intersect(RayObject *r, Isect *i)
 {
 	if (RE_rayobject_isRayFace(r)) {
@@ -69,7 +69,8 @@ static RayObjectAPI empty_api =
 	RE_rayobject_empty_free,
 	RE_rayobject_empty_bb,
 	RE_rayobject_empty_cost,
-	RE_rayobject_empty_hint_bb
+	RE_rayobject_empty_hint_bb,
+	NULL /* no packet traversal */
 };
 
 static RayObject empty_raytree = { &empty_api, {NULL, NULL} };
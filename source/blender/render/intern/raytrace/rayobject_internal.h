@@ -121,6 +121,7 @@ struct RayObject {
 };
 
 typedef int  (*RE_rayobject_raycast_callback)(RayObject *, struct Isect *);
+typedef int  (*RE_rayobject_raycast_packet_callback)(RayObject *, struct Isect **isecs, int num);
 typedef void (*RE_rayobject_add_callback)(RayObject *raytree, RayObject *rayobject);
 typedef void (*RE_rayobject_done_callback)(RayObject *);
 typedef void (*RE_rayobject_free_callback)(RayObject *);
@@ -136,6 +137,9 @@ typedef struct RayObjectAPI {
 	RE_rayobject_merge_bb_callback	bb;
 	RE_rayobject_cost_callback		cost;
 	RE_rayobject_hint_bb_callback	hint_bb;
+	/* optional, may be NULL: cast up to 4 coherent shadow rays in a single
+	 * traversal, see RE_rayobject_raycast_shadow_packet4 */
+	RE_rayobject_raycast_packet_callback raycast_shadow_packet4;
 } RayObjectAPI;
 
 /*
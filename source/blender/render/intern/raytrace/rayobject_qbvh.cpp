@@ -107,6 +107,21 @@ static int intersect(QBVHTree *obj, Isect *isec)
 		return RE_rayobject_intersect((RayObject *)obj->root, isec);
 }
 
+template<int StackSize>
+static int intersect_shadow_packet4(QBVHTree *obj, Isect **isecs, int num)
+{
+	if (RE_rayobject_isAligned(obj->root)) {
+		return svbvh_node_stack_raycast_shadow_packet4<StackSize>(obj->root, isecs, num);
+	}
+	else {
+		int hits = 0, i;
+		for (i = 0; i < num; i++)
+			if (RE_rayobject_intersect((RayObject *)obj->root, isecs[i]))
+				hits++;
+		return hits;
+	}
+}
+
 template<class Tree>
 static void bvh_hint_bb(Tree *tree, LCTSHint *hint, float *UNUSED(min), float *UNUSED(max))
 {
@@ -128,7 +143,8 @@ static RayObjectAPI make_api()
 		(RE_rayobject_free_callback)    ((void  (*)(Tree *))       & bvh_free<Tree>),
 		(RE_rayobject_merge_bb_callback)((void  (*)(Tree *, float *, float *)) & bvh_bb<Tree>),
 		(RE_rayobject_cost_callback)    ((float (*)(Tree *))      & bvh_cost<Tree>),
-		(RE_rayobject_hint_bb_callback) ((void  (*)(Tree *, LCTSHint *, float *, float *)) & bvh_hint_bb<Tree>)
+		(RE_rayobject_hint_bb_callback) ((void  (*)(Tree *, LCTSHint *, float *, float *)) & bvh_hint_bb<Tree>),
+		(RE_rayobject_raycast_packet_callback) ((int (*)(Tree *, Isect **, int)) & intersect_shadow_packet4<STACK_SIZE>)
 	};
 	
 	return api;
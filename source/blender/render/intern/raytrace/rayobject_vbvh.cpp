@@ -184,7 +184,8 @@ static RayObjectAPI make_api()
 		(RE_rayobject_free_callback)    ((void  (*)(Tree *))       & bvh_free<Tree>),
 		(RE_rayobject_merge_bb_callback)((void  (*)(Tree *, float *, float *)) & bvh_bb<Tree>),
 		(RE_rayobject_cost_callback)    ((float (*)(Tree *))      & bvh_cost<Tree>),
-		(RE_rayobject_hint_bb_callback) ((void  (*)(Tree *, LCTSHint *, float *, float *)) & bvh_hint_bb<Tree>)
+		(RE_rayobject_hint_bb_callback) ((void  (*)(Tree *, LCTSHint *, float *, float *)) & bvh_hint_bb<Tree>),
+		NULL /* packet traversal only implemented for the simd trees */
 	};
 	
 	return api;
@@ -151,6 +151,131 @@ static int svbvh_node_stack_raycast(SVBVHNode *root, Isect *isec)
 	return hit;
 }
 
+/* Shadow ray packets
+ *
+ * Traverses up to 4 coherent occlusion rays at once, testing one child
+ * bounding box against all rays in SSE registers (the transpose of
+ * svbvh_bb_intersect_test_simd4, which tests 4 boxes against one ray).
+ * Each node is visited once for the whole packet, rays that miss a box
+ * are masked out of the subtree below it, and a ray is deactivated as
+ * soon as it hits anything. */
+
+struct SVBVHShadowPacket4 {
+	__m128 start[3];
+	__m128 idot_axis[3];
+	__m128 dist;
+	int active;
+};
+
+static void svbvh_shadow_packet4_init(SVBVHShadowPacket4 *packet, Isect **isecs, int num)
+{
+	float start[3][4], idot_axis[3][4], dist[4];
+	int i, j;
+
+	for (i = 0; i < 4; i++) {
+		/* replicate the first ray into unused lanes, they stay masked out */
+		const Isect *isec = isecs[(i < num) ? i : 0];
+
+		for (j = 0; j < 3; j++) {
+			start[j][i] = isec->start[j];
+			idot_axis[j][i] = isec->idot_axis[j];
+		}
+		dist[i] = isec->dist;
+	}
+
+	for (j = 0; j < 3; j++) {
+		packet->start[j] = _mm_loadu_ps(start[j]);
+		packet->idot_axis[j] = _mm_loadu_ps(idot_axis[j]);
+	}
+	packet->dist = _mm_loadu_ps(dist);
+	packet->active = (1 << num) - 1;
+}
+
+static int svbvh_bb_intersect_test_packet4(const SVBVHShadowPacket4 *packet,
+                                           const float *bb_min, const float *bb_max, int stride)
+{
+	__m128 tmin = _mm_setzero_ps();
+	__m128 tmax = packet->dist;
+	int j;
+
+	for (j = 0; j < 3; j++) {
+		const __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set_ps1(bb_min[j * stride]), packet->start[j]), packet->idot_axis[j]);
+		const __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_set_ps1(bb_max[j * stride]), packet->start[j]), packet->idot_axis[j]);
+
+		/* rays in the packet may differ in direction sign, order per lane
+		 * instead of relying on the precomputed bv_index swap */
+		tmin = _mm_max_ps(tmin, _mm_min_ps(t1, t2));
+		tmax = _mm_min_ps(tmax, _mm_max_ps(t1, t2));
+	}
+
+	return _mm_movemask_ps(_mm_cmpge_ps(tmax, tmin)) & packet->active;
+}
+
+template<int MAX_STACK_SIZE>
+static int svbvh_node_stack_raycast_shadow_packet4(SVBVHNode *root, Isect **isecs, int num)
+{
+	SVBVHNode *node_stack[MAX_STACK_SIZE], *node;
+	int mask_stack[MAX_STACK_SIZE];
+	SVBVHShadowPacket4 packet;
+	int hits = 0, mask, stack_pos = 0;
+
+	svbvh_shadow_packet4_init(&packet, isecs, num);
+
+	node_stack[stack_pos] = root;
+	mask_stack[stack_pos] = packet.active;
+	stack_pos++;
+
+	while (stack_pos) {
+		stack_pos--;
+		node = node_stack[stack_pos];
+		mask = mask_stack[stack_pos] & packet.active;
+
+		if (!mask)
+			continue;
+
+		if (!svbvh_node_is_leaf(node)) {
+			float *child_bb = node->child_bb;
+			SVBVHNode **child = node->child;
+			int i, res;
+
+			if (node->nchilds == 4) {
+				/* childs are stored transposed, in six SSE groups of four */
+				for (i = 0; i < 4; i++) {
+					res = svbvh_bb_intersect_test_packet4(&packet, child_bb + i, child_bb + 12 + i, 4) & mask;
+					if (res) {
+						node_stack[stack_pos] = child[i];
+						mask_stack[stack_pos] = res;
+						stack_pos++;
+					}
+				}
+			}
+			else {
+				for (i = 0; i < node->nchilds; i++) {
+					res = svbvh_bb_intersect_test_packet4(&packet, child_bb + 6 * i, child_bb + 6 * i + 3, 1) & mask;
+					if (res) {
+						node_stack[stack_pos] = child[i];
+						mask_stack[stack_pos] = res;
+						stack_pos++;
+					}
+				}
+			}
+		}
+		else {
+			int i;
+			for (i = 0; i < num; i++) {
+				if ((mask & (1 << i)) && RE_rayobject_intersect((RayObject *)node, isecs[i])) {
+					hits++;
+					packet.active &= ~(1 << i);
+				}
+			}
+			if (!packet.active)
+				break;
+		}
+	}
+
+	return hits;
+}
+
 
 template<>
 inline void bvh_node_merge_bb<SVBVHNode>(SVBVHNode *node, float min[3], float max[3])
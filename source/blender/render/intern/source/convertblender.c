@@ -40,6 +40,8 @@
 #include "BLI_utildefines.h"
 #include "BLI_rand.h"
 #include "BLI_memarena.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #ifdef WITH_FREESTYLE
 #  include "BLI_edgehash.h"
 #endif
@@ -652,21 +654,30 @@ static void autosmooth(Render *UNUSED(re), ObjectRen *obr, float mat[4][4], shor
 /* Orco hash and Materials                                                   */
 /* ------------------------------------------------------------------------- */
 
+/* the orco hash is shared between objects, which can convert in
+ * parallel tasks, so the accessors lock */
+static ThreadMutex orco_lock = BLI_MUTEX_INITIALIZER;
+
 static float *get_object_orco(Render *re, void *ob)
 {
-	if (!re->orco_hash) {
-		return NULL;
-	}
+	float *orco = NULL;
 
-	return BLI_ghash_lookup(re->orco_hash, ob);
+	BLI_mutex_lock(&orco_lock);
+	if (re->orco_hash)
+		orco = BLI_ghash_lookup(re->orco_hash, ob);
+	BLI_mutex_unlock(&orco_lock);
+
+	return orco;
 }
 
 static void set_object_orco(Render *re, void *ob, float *orco)
 {
+	BLI_mutex_lock(&orco_lock);
 	if (!re->orco_hash)
 		re->orco_hash = BLI_ghash_ptr_new("set_object_orco gh");
-	
+
 	BLI_ghash_insert(re->orco_hash, ob, orco);
+	BLI_mutex_unlock(&orco_lock);
 }
 
 static void free_mesh_orco_hash(Render *re) 
@@ -4645,7 +4656,96 @@ static void init_render_object_data(Render *re, ObjectRen *obr, int timeoffset)
 	re->totstrand += obr->totstrand;
 }
 
-static void add_render_object(Render *re, Object *ob, Object *par, DupliObject *dob, float omat[4][4], int timeoffset)
+/* ------------------------------------------------------------------------- */
+/* Threaded object conversion                                                */
+/* ------------------------------------------------------------------------- */
+
+/* Object data that doesn't depend on other objects can convert to render
+ * primitives in parallel tasks, each task filling only its own ObjectRen.
+ * The database topology (object order, indices, instances) is still built
+ * serially, only the data conversion is deferred. */
+
+typedef struct ObjectConvertPool {
+	Render *re;
+	int timeoffset;
+} ObjectConvertPool;
+
+static int allow_deferred_object_data(Render *re, Object *ob, DupliObject *dob)
+{
+	int a;
+
+	if (dob || ob->type != OB_MESH || ob->particlesystem.first)
+		return 0;
+
+	/* halos pull in shared render state during conversion, keep those serial.
+	 * calling give_render_material here also sets the material flags before
+	 * going threaded, so the in-task calls only re-set the same bits */
+	for (a = 1; a <= ob->totcol; a++) {
+		Material *ma = give_render_material(re, ob, a);
+		if (ma && ma->material_type == MA_TYPE_HALO)
+			return 0;
+	}
+	if (ob->totcol == 0)
+		give_render_material(re, ob, 1);
+
+	return 1;
+}
+
+static void database_convert_deferred_task(TaskPool *pool, void *taskdata, int UNUSED(threadid))
+{
+	ObjectConvertPool *data = BLI_task_pool_userdata(pool);
+	ObjectRen *obr = taskdata;
+
+	init_render_mesh(data->re, obr, data->timeoffset);
+	finalize_render_object(data->re, obr, data->timeoffset);
+}
+
+static void database_convert_deferred_objects(Render *re, ListBase *deferred, int timeoffset)
+{
+	LinkData *link;
+
+	if (BLI_listbase_is_empty(deferred))
+		return;
+
+	if (re->r.threads > 1 && (deferred->first != deferred->last)) {
+		TaskScheduler *task_scheduler = BLI_task_scheduler_get();
+		TaskPool *task_pool;
+		ObjectConvertPool data;
+
+		data.re = re;
+		data.timeoffset = timeoffset;
+
+		task_pool = BLI_task_pool_create(task_scheduler, &data);
+
+		for (link = deferred->first; link; link = link->next)
+			BLI_task_pool_push(task_pool, database_convert_deferred_task, link->data, false, TASK_PRIORITY_HIGH);
+
+		BLI_task_pool_work_and_wait(task_pool);
+		BLI_task_pool_free(task_pool);
+	}
+	else {
+		for (link = deferred->first; link; link = link->next) {
+			ObjectRen *obr = link->data;
+
+			init_render_mesh(re, obr, timeoffset);
+			finalize_render_object(re, obr, timeoffset);
+		}
+	}
+
+	/* totals merge into the database serially */
+	for (link = deferred->first; link; link = link->next) {
+		ObjectRen *obr = link->data;
+
+		re->totvert += obr->totvert;
+		re->totvlak += obr->totvlak;
+		re->tothalo += obr->tothalo;
+		re->totstrand += obr->totstrand;
+	}
+
+	BLI_freelistN(deferred);
+}
+
+static void add_render_object(Render *re, Object *ob, Object *par, DupliObject *dob, float omat[4][4], int timeoffset, ListBase *deferred)
 {
 	ObjectRen *obr;
 	ObjectInstanceRen *obi;
@@ -4676,7 +4776,10 @@ static void add_render_object(Render *re, Object *ob, Object *par, DupliObject *
 			obr->flag |= R_INSTANCEABLE;
 			copy_m4_m4(obr->obmat, ob->obmat);
 		}
-		init_render_object_data(re, obr, timeoffset);
+		if (deferred && allow_deferred_object_data(re, ob, dob))
+			BLI_addtail(deferred, BLI_genericNodeN(obr));
+		else
+			init_render_object_data(re, obr, timeoffset);
 
 		/* only add instance for objects that have not been used for dupli */
 		if (!(ob->transflag & OB_RENDER_DUPLI)) {
@@ -4725,7 +4828,8 @@ static void add_render_object(Render *re, Object *ob, Object *par, DupliObject *
 
 /* par = pointer to duplicator parent, needed for object lookup table */
 /* index = when duplicater copies same object (particle), the counter */
-static void init_render_object(Render *re, Object *ob, Object *par, DupliObject *dob, float omat[4][4], int timeoffset)
+/* deferred = optional list that collects objects for threaded conversion */
+static void init_render_object(Render *re, Object *ob, Object *par, DupliObject *dob, float omat[4][4], int timeoffset, ListBase *deferred)
 {
 	static double lasttime= 0.0;
 	double time;
@@ -4734,7 +4838,7 @@ static void init_render_object(Render *re, Object *ob, Object *par, DupliObject
 	if (ob->type==OB_LAMP)
 		add_render_lamp(re, ob);
 	else if (render_object_type(ob->type))
-		add_render_object(re, ob, par, dob, omat, timeoffset);
+		add_render_object(re, ob, par, dob, omat, timeoffset, deferred);
 	else {
 		mul_m4_m4m4(mat, re->viewmat, ob->obmat);
 		invert_m4_m4(ob->imat, mat);
@@ -4774,13 +4878,15 @@ void RE_Database_Free(Render *re)
 	/* FREE */
 	
 	for (lar= re->lampren.first; lar; lar= lar->next) {
+		shadowbuf_cache_store(re, lar);
 		freeshadowbuf(lar);
 		if (lar->jitter) MEM_freeN(lar->jitter);
 		if (lar->shadsamp) MEM_freeN(lar->shadsamp);
 		if (lar->sunsky) MEM_freeN(lar->sunsky);
 		curvemapping_free(lar->curfalloff);
 	}
-	
+	shadowbuf_cache_trim(re);
+
 	free_volume_precache(re);
 	
 	BLI_freelistN(&re->lampren);
@@ -4944,7 +5050,7 @@ static int get_vector_renderlayers(Scene *sce)
 	return lay;
 }
 
-static void add_group_render_dupli_obs(Render *re, Group *group, int nolamps, int onlyselected, Object *actob, int timeoffset, int level)
+static void add_group_render_dupli_obs(Render *re, Group *group, int nolamps, int onlyselected, Object *actob, int timeoffset, int level, ListBase *deferred)
 {
 	GroupObject *go;
 	Object *ob;
@@ -4960,11 +5066,11 @@ static void add_group_render_dupli_obs(Render *re, Group *group, int nolamps, in
 		if (ob->flag & OB_DONE) {
 			if (ob->transflag & OB_RENDER_DUPLI) {
 				if (allow_render_object(re, ob, nolamps, onlyselected, actob)) {
-					init_render_object(re, ob, NULL, NULL, NULL, timeoffset);
+					init_render_object(re, ob, NULL, NULL, NULL, timeoffset, deferred);
 					ob->transflag &= ~OB_RENDER_DUPLI;
 
 					if (ob->dup_group)
-						add_group_render_dupli_obs(re, ob->dup_group, nolamps, onlyselected, actob, timeoffset, level+1);
+						add_group_render_dupli_obs(re, ob->dup_group, nolamps, onlyselected, actob, timeoffset, level+1, deferred);
 				}
 			}
 		}
@@ -4978,6 +5084,7 @@ static void database_init_objects(Render *re, unsigned int renderlay, int nolamp
 	Group *group;
 	ObjectInstanceRen *obi;
 	Scene *sce_iter;
+	ListBase deferred = {NULL, NULL};
 	int lay, vectorlay;
 
 	/* for duplis we need the Object texture mapping to work as if
@@ -5021,7 +5128,7 @@ static void database_init_objects(Render *re, unsigned int renderlay, int nolamp
 			 * it still needs to create the ObjectRen containing the data */
 			if (ob->transflag & OB_RENDER_DUPLI) {
 				if (allow_render_object(re, ob, nolamps, onlyselected, actob)) {
-					init_render_object(re, ob, NULL, NULL, NULL, timeoffset);
+					init_render_object(re, ob, NULL, NULL, NULL, timeoffset, &deferred);
 					ob->transflag &= ~OB_RENDER_DUPLI;
 				}
 			}
@@ -5120,7 +5227,7 @@ static void database_init_objects(Render *re, unsigned int renderlay, int nolamp
 
 						if (obi==NULL)
 							/* can't instance, just create the object */
-							init_render_object(re, obd, ob, dob, dob_extra->obmat, timeoffset);
+							init_render_object(re, obd, ob, dob, dob_extra->obmat, timeoffset, &deferred);
 						
 						if (dob->type != OB_DUPLIGROUP) {
 							obd->flag |= OB_DONE;
@@ -5128,7 +5235,7 @@ static void database_init_objects(Render *re, unsigned int renderlay, int nolamp
 						}
 					}
 					else
-						init_render_object(re, obd, ob, dob, dob_extra->obmat, timeoffset);
+						init_render_object(re, obd, ob, dob, dob_extra->obmat, timeoffset, &deferred);
 					
 					if (re->test_break(re->tbh)) break;
 				}
@@ -5143,10 +5250,10 @@ static void database_init_objects(Render *re, unsigned int renderlay, int nolamp
 				free_object_duplilist(duplilist);
 
 				if (allow_render_object(re, ob, nolamps, onlyselected, actob))
-					init_render_object(re, ob, NULL, NULL, NULL, timeoffset);
+					init_render_object(re, ob, NULL, NULL, NULL, timeoffset, &deferred);
 			}
 			else if (allow_render_object(re, ob, nolamps, onlyselected, actob))
-				init_render_object(re, ob, NULL, NULL, NULL, timeoffset);
+				init_render_object(re, ob, NULL, NULL, NULL, timeoffset, &deferred);
 		}
 
 		if (re->test_break(re->tbh)) break;
@@ -5155,7 +5262,10 @@ static void database_init_objects(Render *re, unsigned int renderlay, int nolamp
 	/* objects in groups with OB_RENDER_DUPLI set still need to be created,
 	 * since they may not be part of the scene */
 	for (group= re->main->group.first; group; group=group->id.next)
-		add_group_render_dupli_obs(re, group, nolamps, onlyselected, actob, timeoffset, 0);
+		add_group_render_dupli_obs(re, group, nolamps, onlyselected, actob, timeoffset, 0, &deferred);
+
+	/* convert the deferred object data, independent objects in parallel */
+	database_convert_deferred_objects(re, &deferred, timeoffset);
 
 	if (!re->test_break(re->tbh))
 		RE_makeRenderInstances(re);
@@ -99,6 +99,10 @@ typedef struct {
 	const MResolvePixelData *data;
 	MFlushPixel flush_pixel;
 	short *do_update;
+
+	/* scanline band of the current work item, half-open;
+	 * oversized triangles are rasterized in several bands by different threads */
+	int yclip_min, yclip_max;
 } MBakeRast;
 
 typedef struct {
@@ -161,6 +165,8 @@ static void init_bake_rast(MBakeRast *bake_rast, const ImBuf *ibuf, const MResol
 	bake_rast->data = data;
 	bake_rast->flush_pixel = flush_pixel;
 	bake_rast->do_update = do_update;
+	bake_rast->yclip_min = 0;
+	bake_rast->yclip_max = ibuf->y;
 }
 
 static void flush_pixel(const MResolvePixelData *data, const int x, const int y)
@@ -248,6 +254,12 @@ static void rasterize_half(const MBakeRast *bake_rast,
 	y0 = y0_in < 0 ? 0 : y0_in;
 	y1 = y1_in >= h ? h : y1_in;
 
+	/* clip to the scanline band of the current work item */
+	if (y0 < bake_rast->yclip_min)
+		y0 = bake_rast->yclip_min;
+	if (y1 > bake_rast->yclip_max)
+		y1 = bake_rast->yclip_max;
+
 	for (y = y0; y < y1; y++) {
 		/*-b(x-x0) + a(y-y0) = 0 */
 		int iXl, iXr, x;
@@ -324,9 +336,24 @@ static int multiresbake_test_break(MultiresBakeRender *bkr)
 
 /* **** Threading routines **** */
 
+/* scanlines per work item; small enough that a few huge triangles of an 8K
+ * bake are still spread over all the threads, large enough to keep the
+ * queue lock out of the profile */
+#define MULTIRESBAKE_BAND_SIZE 64
+
+typedef struct MultiresBakeSpan {
+	int tri_index;
+	/* scanline band of the triangle covered by this item, half-open */
+	int y_min, y_max;
+	/* first span of its triangle, used for the face counter */
+	int is_first;
+} MultiresBakeSpan;
+
 typedef struct MultiresBakeQueue {
-	int cur_tri;
-	int tot_tri;
+	MultiresBakeSpan *spans;
+	int cur_span;
+	int tot_span;
+	int baked_span;
 	SpinLock spin;
 } MultiresBakeQueue;
 
@@ -345,22 +372,88 @@ typedef struct MultiresBakeThread {
 	float height_min, height_max;
 } MultiresBakeThread;
 
-static int multires_bake_queue_next_tri(MultiresBakeQueue *queue)
+static int multires_bake_queue_next_span(MultiresBakeQueue *queue)
 {
-	int face = -1;
+	int span = -1;
 
-	/* TODO: it could worth making it so thread will handle neighbor faces
+	/* TODO: it could worth making it so thread will handle neighbor spans
 	 *       for better memory cache utilization
 	 */
 
 	BLI_spin_lock(&queue->spin);
-	if (queue->cur_tri < queue->tot_tri) {
-		face = queue->cur_tri;
-		queue->cur_tri++;
+	if (queue->cur_span < queue->tot_span) {
+		span = queue->cur_span;
+		queue->cur_span++;
 	}
 	BLI_spin_unlock(&queue->spin);
 
-	return face;
+	return span;
+}
+
+/* Split the triangles of the current image into fixed-size scanline bands,
+ * so that a handful of large triangles (common when baking a single high-res
+ * map) can't leave most threads idle on the tail of the queue.
+ * Triangles belonging to other images are filtered out here instead of in
+ * the thread loop. */
+static MultiresBakeSpan *multires_bake_spans_create(
+        const MLoopTri *mlooptri, const int tot_tri,
+        const MTexPoly *mtpoly, const MLoopUV *mloopuv,
+        Image *ima, const int ibuf_y, int *r_tot_span)
+{
+	MultiresBakeSpan *spans, *span;
+	int i, tot_span = 0;
+	int pass;
+
+	/* first pass counts, second pass fills in */
+	spans = NULL;
+	for (pass = 0; pass < 2; pass++) {
+		span = spans;
+
+		for (i = 0; i < tot_tri; i++) {
+			const MLoopTri *lt = &mlooptri[i];
+			float t_min, t_max;
+			int y_min, y_max, y, tot_band;
+
+			if (mtpoly[lt->poly].tpage != ima)
+				continue;
+
+			/* vertical pixel range as used by bake_rasterize, widened by a
+			 * pixel on both sides to be safe against rounding */
+			t_min = min_fff(mloopuv[lt->tri[0]].uv[1], mloopuv[lt->tri[1]].uv[1], mloopuv[lt->tri[2]].uv[1]);
+			t_max = max_fff(mloopuv[lt->tri[0]].uv[1], mloopuv[lt->tri[1]].uv[1], mloopuv[lt->tri[2]].uv[1]);
+
+			y_min = (int)floorf(t_min * ibuf_y - 0.5f) - 1;
+			y_max = (int)ceilf(t_max * ibuf_y - 0.5f) + 1;
+
+			CLAMP(y_min, 0, ibuf_y);
+			CLAMP(y_max, 0, ibuf_y);
+
+			tot_band = max_ii(1, (y_max - y_min + MULTIRESBAKE_BAND_SIZE - 1) / MULTIRESBAKE_BAND_SIZE);
+
+			if (pass == 0) {
+				tot_span += tot_band;
+			}
+			else {
+				for (y = 0; y < tot_band; y++, span++) {
+					span->tri_index = i;
+					span->y_min = y_min + y * MULTIRESBAKE_BAND_SIZE;
+					span->y_max = min_ii(y_min + (y + 1) * MULTIRESBAKE_BAND_SIZE, y_max);
+					span->is_first = (y == 0);
+				}
+			}
+		}
+
+		if (pass == 0) {
+			if (tot_span == 0)
+				break;
+
+			spans = MEM_mallocN(tot_span * sizeof(MultiresBakeSpan), "multires bake spans");
+		}
+	}
+
+	*r_tot_span = tot_span;
+
+	return spans;
 }
 
 static void *do_multires_bake_thread(void *data_v)
@@ -369,20 +462,19 @@ static void *do_multires_bake_thread(void *data_v)
 	MResolvePixelData *data = &handle->data;
 	MBakeRast *bake_rast = &handle->bake_rast;
 	MultiresBakeRender *bkr = handle->bkr;
-	int tri_index;
+	int span_index;
 
-	while ((tri_index = multires_bake_queue_next_tri(handle->queue)) >= 0) {
-		const MLoopTri *lt = &data->mlooptri[tri_index];
-		MTexPoly *mtpoly = &data->mtpoly[lt->poly];
+	while ((span_index = multires_bake_queue_next_span(handle->queue)) >= 0) {
+		const MultiresBakeSpan *span = &handle->queue->spans[span_index];
+		const MLoopTri *lt = &data->mlooptri[span->tri_index];
 		MLoopUV *mloopuv = data->mloopuv;
 
 		if (multiresbake_test_break(bkr))
 			break;
 
-		if (mtpoly->tpage != handle->image)
-			continue;
-
-		data->tri_index = tri_index;
+		data->tri_index = span->tri_index;
+		bake_rast->yclip_min = span->y_min;
+		bake_rast->yclip_max = span->y_max;
 
 		bake_rasterize(bake_rast, mloopuv[lt->tri[0]].uv, mloopuv[lt->tri[1]].uv, mloopuv[lt->tri[2]].uv);
 
@@ -394,13 +486,15 @@ static void *do_multires_bake_thread(void *data_v)
 
 		/* update progress */
 		BLI_spin_lock(&handle->queue->spin);
-		bkr->baked_faces++;
+		if (span->is_first)
+			bkr->baked_faces++;
+		handle->queue->baked_span++;
 
 		if (bkr->do_update)
 			*bkr->do_update = true;
 
 		if (bkr->progress)
-			*bkr->progress = ((float)bkr->baked_objects + (float)bkr->baked_faces / handle->queue->tot_tri) / bkr->tot_obj;
+			*bkr->progress = ((float)bkr->baked_objects + (float)handle->queue->baked_span / handle->queue->tot_span) / bkr->tot_obj;
 		BLI_spin_unlock(&handle->queue->spin);
 	}
 
@@ -428,7 +522,11 @@ static void init_ccgdm_arrays(DerivedMesh *dm)
 	(void) grid_offset;
 }
 
-static void do_multires_bake(MultiresBakeRender *bkr, Image *ima, bool require_tangent, MPassKnownData passKnownData,
+/* \a bake_data is an optional image-independent bake data created by the
+ * caller and shared by all the bake jobs; when it's NULL and \a initBakeData
+ * is given, per-image bake data is created and freed here as before. */
+static void do_multires_bake(MultiresBakeRender *bkr, Image *ima, void *shared_bake_data,
+                             bool require_tangent, MPassKnownData passKnownData,
                              MInitBakeData initBakeData, MFreeBakeData freeBakeData, MultiresBakeResult *result)
 {
 	DerivedMesh *dm = bkr->lores_dm;
@@ -452,7 +550,7 @@ static void do_multires_bake(MultiresBakeRender *bkr, Image *ima, bool require_t
 		ListBase threads;
 		int i, tot_thread = bkr->threads > 0 ? bkr->threads : BLI_system_thread_count();
 
-		void *bake_data = NULL;
+		void *bake_data = shared_bake_data;
 
 		if (require_tangent) {
 			if (CustomData_get_layer_index(&dm->loopData, CD_TANGENT) == -1)
@@ -462,7 +560,7 @@ static void do_multires_bake(MultiresBakeRender *bkr, Image *ima, bool require_t
 		}
 
 		/* all threads shares the same custom bake data */
-		if (initBakeData)
+		if (bake_data == NULL && initBakeData)
 			bake_data = initBakeData(bkr, ima);
 
 		if (tot_thread > 1)
@@ -472,9 +570,10 @@ static void do_multires_bake(MultiresBakeRender *bkr, Image *ima, bool require_t
 
 		init_ccgdm_arrays(bkr->hires_dm);
 
-		/* faces queue */
-		queue.cur_tri = 0;
-		queue.tot_tri = tot_tri;
+		/* scanline band work queue */
+		queue.spans = multires_bake_spans_create(mlooptri, tot_tri, mtpoly, mloopuv, ima, ibuf->y, &queue.tot_span);
+		queue.cur_span = 0;
+		queue.baked_span = 0;
 		BLI_spin_init(&queue.spin);
 
 		/* fill in threads handles */
@@ -529,8 +628,11 @@ static void do_multires_bake(MultiresBakeRender *bkr, Image *ima, bool require_t
 
 		BLI_spin_end(&queue.spin);
 
-		/* finalize baking */
-		if (freeBakeData)
+		if (queue.spans)
+			MEM_freeN(queue.spans);
+
+		/* finalize baking, shared bake data is freed by the caller */
+		if ((shared_bake_data == NULL) && freeBakeData)
 			freeBakeData(bake_data);
 
 		MEM_freeN(handles);
@@ -1208,6 +1310,21 @@ static void count_images(MultiresBakeRender *bkr)
 static void bake_images(MultiresBakeRender *bkr, MultiresBakeResult *result)
 {
 	LinkData *link;
+	void *shared_bake_data = NULL;
+
+	/* normal and AO bake data don't depend on the image, so the expensive
+	 * parts (the AO raytree in particular) are built once and shared by all
+	 * the per-image bake jobs instead of being rebuilt for each of them;
+	 * height bake data holds a per-image displacement buffer and is still
+	 * created inside do_multires_bake */
+	switch (bkr->mode) {
+		case RE_BAKE_NORMALS:
+			shared_bake_data = init_normal_data(bkr, NULL);
+			break;
+		case RE_BAKE_AO:
+			shared_bake_data = init_ao_data(bkr, NULL);
+			break;
+	}
 
 	for (link = bkr->image.first; link; link = link->next) {
 		Image *ima = (Image *)link->data;
@@ -1220,14 +1337,14 @@ static void bake_images(MultiresBakeRender *bkr, MultiresBakeResult *result)
 
 			switch (bkr->mode) {
 				case RE_BAKE_NORMALS:
-					do_multires_bake(bkr, ima, true, apply_tangmat_callback, init_normal_data, free_normal_data, result);
+					do_multires_bake(bkr, ima, shared_bake_data, true, apply_tangmat_callback, NULL, NULL, result);
 					break;
 				case RE_BAKE_DISPLACEMENT:
 				case RE_BAKE_DERIVATIVE:
-					do_multires_bake(bkr, ima, false, apply_heights_callback, init_heights_data, free_heights_data, result);
+					do_multires_bake(bkr, ima, NULL, false, apply_heights_callback, init_heights_data, free_heights_data, result);
 					break;
 				case RE_BAKE_AO:
-					do_multires_bake(bkr, ima, false, apply_ao_callback, init_ao_data, free_ao_data, result);
+					do_multires_bake(bkr, ima, shared_bake_data, false, apply_ao_callback, NULL, NULL, result);
 					break;
 			}
 		}
@@ -1236,6 +1353,13 @@ static void bake_images(MultiresBakeRender *bkr, MultiresBakeResult *result)
 
 		ima->id.tag |= LIB_TAG_DOIT;
 	}
+
+	if (shared_bake_data) {
+		if (bkr->mode == RE_BAKE_NORMALS)
+			free_normal_data(shared_bake_data);
+		else
+			free_ao_data(shared_bake_data);
+	}
 }
 
 static void finish_images(MultiresBakeRender *bkr, MultiresBakeResult *result)
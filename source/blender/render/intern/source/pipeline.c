@@ -98,6 +98,7 @@
 #include "rendercore.h"
 #include "initrender.h"
 #include "pixelblending.h"
+#include "shadbuf.h"
 #include "zbuf.h"
 
 /* render flow
@@ -306,10 +307,22 @@ Render *RE_GetRender(const char *name)
 }
 
 
+/* passes may have been flushed to the scratch exr backing file, read them
+ * back before handing out the result */
+static void re_ensure_passes(Render *re)
+{
+	if (re->result && re->result->passes_spilled) {
+		BLI_rw_mutex_lock(&re->resultmutex, THREAD_LOCK_WRITE);
+		render_result_passes_ensure(re->result);
+		BLI_rw_mutex_unlock(&re->resultmutex);
+	}
+}
+
 /* if you want to know exactly what has been done */
 RenderResult *RE_AcquireResultRead(Render *re)
 {
 	if (re) {
+		re_ensure_passes(re);
 		BLI_rw_mutex_lock(&re->resultmutex, THREAD_LOCK_READ);
 		return re->result;
 	}
@@ -320,6 +333,7 @@ RenderResult *RE_AcquireResultRead(Render *re)
 RenderResult *RE_AcquireResultWrite(Render *re)
 {
 	if (re) {
+		re_ensure_passes(re);
 		BLI_rw_mutex_lock(&re->resultmutex, THREAD_LOCK_WRITE);
 		return re->result;
 	}
@@ -550,6 +564,7 @@ void RE_FreeRender(Render *re)
 	re->scene = NULL;
 	
 	RE_Database_Free(re);	/* view render can still have full database */
+	shadowbuf_cache_free(re);
 	free_sample_tables(re);
 	
 	render_result_free(re->result);
@@ -1938,8 +1953,17 @@ static void render_scene(Render *re, Scene *sce, int cfra)
 	resc->sdh = re->sdh;
 	resc->current_scene_update = re->current_scene_update;
 	resc->suh = re->suh;
-	
+
 	do_render_fields_blur_3d(resc);
+
+	/* with save buffers enabled the result sits idle until the compositor
+	 * pulls it, flush the bulky passes to disk to bound renderer memory,
+	 * RE_AcquireResultRead maps them back in on access */
+	if (re->r.scemode & R_EXR_TILE_FILE) {
+		BLI_rw_mutex_lock(&resc->resultmutex, THREAD_LOCK_WRITE);
+		render_result_passes_spill(resc->result);
+		BLI_rw_mutex_unlock(&resc->resultmutex);
+	}
 }
 
 /* helper call to detect if this scene needs a render, or if there's a any render layer to render */
@@ -3475,6 +3499,157 @@ static int do_write_image_or_movie(Render *re, Main *bmain, Scene *scene, bMovie
 	return ok;
 }
 
+/* Background image writer, used by RE_BlenderAnim() to overlap saving of
+ * finished frames with rendering (and compositing) of the next one. Finished
+ * results are detached from the Render and pushed onto a bounded queue which
+ * a small worker pool encodes and writes, so the next frame is free to
+ * allocate a fresh result and a slow encode of one frame doesn't stall the
+ * pipe while another is still being written. Only used for background renders
+ * of image sequences: the UI needs re->result around for drawing, and movie
+ * containers have to be appended to in frame order anyway. */
+
+#define ANIM_IMAGE_WRITER_NUM_THREADS 2
+
+/* Every pending frame holds a full detached render result in memory, so
+ * block the render thread instead of queueing frames without bound when the
+ * encoders can not keep up. */
+#define ANIM_IMAGE_WRITER_MAX_PENDING 3
+
+typedef struct AnimImageWriteJob {
+	RenderResult *rr;    /* detached result of the frame being saved */
+	RenderResult rres;   /* shallow view copy into rr, see RE_AcquireResultImageViews */
+	Scene *scene;
+	char name[FILE_MAX];
+	bool ok;
+} AnimImageWriteJob;
+
+typedef struct AnimImageWriter {
+	ListBase threads;
+	ThreadQueue *queue;       /* jobs scheduled for writing */
+	ThreadQueue *done_queue;  /* written jobs, drained by the render thread */
+	int num_pending;          /* scheduled and not yet drained */
+	bool running;
+} AnimImageWriter;
+
+static void *anim_image_write_thread(void *writer_v)
+{
+	AnimImageWriter *writer = writer_v;
+	AnimImageWriteJob *job;
+
+	while ((job = BLI_thread_queue_pop(writer->queue))) {
+		/* NULL reports: BKE_report() prints to the console in background mode,
+		 * appending to re->reports here would race with the render thread */
+		job->ok = RE_WriteRenderViewsImage(NULL, &job->rres, job->scene, true, job->name);
+
+		BLI_thread_queue_push(writer->done_queue, job);
+	}
+
+	return NULL;
+}
+
+static void anim_image_writer_start(AnimImageWriter *writer)
+{
+	int i;
+
+	writer->queue = BLI_thread_queue_init();
+	writer->done_queue = BLI_thread_queue_init();
+
+	BLI_init_threads(&writer->threads, anim_image_write_thread, ANIM_IMAGE_WRITER_NUM_THREADS);
+	for (i = 0; i < ANIM_IMAGE_WRITER_NUM_THREADS; i++)
+		BLI_insert_thread(&writer->threads, writer);
+
+	writer->running = true;
+}
+
+/* free one written job, returns false if its write failed */
+static bool anim_image_writer_drain_job(AnimImageWriter *writer)
+{
+	AnimImageWriteJob *job = BLI_thread_queue_pop(writer->done_queue);
+	bool ok = job->ok;
+
+	writer->num_pending--;
+
+	render_result_views_shallowdelete(&job->rres);
+	render_result_free(job->rr);
+	MEM_freeN(job);
+
+	return ok;
+}
+
+/* wait for all pending background writes, returns false if any failed */
+static bool anim_image_writer_finish(AnimImageWriter *writer)
+{
+	bool ok = true;
+
+	if (!writer->running)
+		return true;
+
+	while (writer->num_pending > 0)
+		ok &= anim_image_writer_drain_job(writer);
+
+	BLI_thread_queue_nowait(writer->queue);
+	BLI_end_threads(&writer->threads);
+
+	BLI_thread_queue_free(writer->queue);
+	BLI_thread_queue_free(writer->done_queue);
+	writer->running = false;
+
+	return ok;
+}
+
+/* detach re->result and queue it for saving, returns false if a previously
+ * scheduled frame (collected here) failed to write */
+static bool anim_image_writer_schedule(AnimImageWriter *writer, Render *re, Main *bmain, Scene *scene)
+{
+	AnimImageWriteJob *job;
+	bool ok = true;
+	char timecode[32];
+
+	if (!writer->running)
+		anim_image_writer_start(writer);
+
+	/* collect results of finished writes, blocking while the queue is full */
+	while (writer->num_pending >= ANIM_IMAGE_WRITER_MAX_PENDING ||
+	       (writer->num_pending > 0 && !BLI_thread_queue_is_empty(writer->done_queue)))
+	{
+		ok &= anim_image_writer_drain_job(writer);
+	}
+
+	job = MEM_callocN(sizeof(AnimImageWriteJob), "anim image write job");
+
+	/* the shallow view copy has to be made while the result is still attached */
+	RE_AcquireResultImageViews(re, &job->rres);
+	BLI_rw_mutex_unlock(&re->resultmutex);
+
+	BLI_rw_mutex_lock(&re->resultmutex, THREAD_LOCK_WRITE);
+	job->rr = re->result;
+	re->result = NULL;
+	BLI_rw_mutex_unlock(&re->resultmutex);
+
+	/* path is resolved now, scene->r.cfra changes for the next frame while we write */
+	job->scene = scene;
+	BKE_image_path_from_imformat(
+	        job->name, scene->r.pic, bmain->name, scene->r.cfra,
+	        &scene->r.im_format, (scene->r.scemode & R_EXTENSION) != 0, true, NULL);
+
+	writer->num_pending++;
+	BLI_thread_queue_push(writer->queue, job);
+
+	/* stats cover the render only, saving runs behind the next frame */
+	re->i.lastframetime = PIL_check_seconds_timer() - re->i.starttime;
+	BLI_timecode_string_from_time_simple(timecode, sizeof(timecode), re->i.lastframetime);
+	printf(" Time: %s (Saving in background: %s)\n", timecode, job->name);
+
+	fflush(stdout);
+
+	BLI_callback_exec(G.main, NULL, BLI_CB_EVT_RENDER_STATS);
+
+	fputc('\n', stdout);
+	fflush(stdout);
+
+	return ok;
+}
+
 static void get_videos_dimensions(
         Render *re, RenderData *rd,
         size_t *r_width, size_t *r_height)
@@ -3522,6 +3697,10 @@ void RE_BlenderAnim(Render *re, Main *bmain, Scene *scene, Object *camera_overri
 	const bool is_movie = BKE_imtype_is_movie(scene->r.im_format.imtype);
 	const bool is_multiview_name = ((scene->r.scemode & R_MULTIVIEW) != 0 &&
 	                                (scene->r.im_format.views_format == R_IMF_VIEWS_INDIVIDUAL));
+	const bool write_in_background = (G.background && !is_movie);
+	AnimImageWriter writer;
+
+	memset(&writer, 0, sizeof(writer));
 
 	BLI_callback_exec(re->main, (ID *)scene, BLI_CB_EVT_RENDER_INIT);
 
@@ -3712,9 +3891,14 @@ void RE_BlenderAnim(Render *re, Main *bmain, Scene *scene, Object *camera_overri
 			totrendered++;
 			
 			if (re->test_break(re->tbh) == 0) {
-				if (!G.is_break)
-					if (!do_write_image_or_movie(re, bmain, scene, mh, totvideos, NULL))
+				if (!G.is_break) {
+					if (write_in_background) {
+						if (!anim_image_writer_schedule(&writer, re, bmain, scene))
+							G.is_break = true;
+					}
+					else if (!do_write_image_or_movie(re, bmain, scene, mh, totvideos, NULL))
 						G.is_break = true;
+				}
 			}
 			else
 				G.is_break = true;
@@ -3757,7 +3941,11 @@ void RE_BlenderAnim(Render *re, Main *bmain, Scene *scene, Object *camera_overri
 			}
 		}
 	}
-	
+
+	/* wait for all scheduled frames to be written */
+	if (!anim_image_writer_finish(&writer))
+		G.is_break = true;
+
 	/* end movie */
 	if (is_movie) {
 		re_movie_free_all(re, mh, totvideos);
@@ -43,6 +43,7 @@
 #include "BLI_system.h"
 #include "BLI_math.h"
 #include "BLI_rand.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -2087,7 +2088,7 @@ static void ray_ao_spheresamp(ShadeInput *shi, float ao[3], float env[3])
 		copy_v3_v3(env, ao);
 }
 
-void ray_ao(ShadeInput *shi, float ao[3], float env[3])
+static void ray_ao_sample(ShadeInput *shi, float ao[3], float env[3])
 {
 	/* Unfortunately, the unusual way that the sphere sampler calculates roughly twice as many
 	 * samples as are actually traced, and skips them based on bias and OSA settings makes it very difficult
@@ -2099,6 +2100,246 @@ void ray_ao(ShadeInput *shi, float ao[3], float env[3])
 		ray_ao_spheresamp(shi, ao, env);
 }
 
+/* -------------------- irradiance caching for ray_ao ------------------- */
+
+/* Raytraced AO and environment lighting vary smoothly over surfaces, so the
+ * gathered irradiance of nearby shading points can often be reused instead
+ * of tracing a full hemisphere of rays again. This works like the cache for
+ * the approximate AO method in occlusion.c: a sparse screen space grid of
+ * records is computed ahead for each part, and shading then interpolates
+ * between neighboring records if their normals and intensities agree,
+ * falling back to a full gather otherwise. */
+
+#define RAYAO_CACHE_STEP	3
+
+typedef struct RayAOCacheSample {
+	float co[3], n[3];
+	float ao[3], env[3];
+	float intensity, dist2;
+	int x, y, filled;
+} RayAOCacheSample;
+
+typedef struct RayAOCache {
+	RayAOCacheSample *sample;
+	int x, y, w, h, step;
+} RayAOCache;
+
+static RayAOCache rayao_cache[BLENDER_MAX_THREADS];
+
+int rayao_cache_enabled(Render *re)
+{
+	return ((re->r.mode & R_RAYTRACE) &&
+	        (re->wrld.mode & (WO_AMB_OCC | WO_ENV_LIGHT)) &&
+	        (re->wrld.ao_gather_method == WO_AOGATHER_RAYTRACE));
+}
+
+static RayAOCacheSample *find_rayao_sample(RayAOCache *cache, int x, int y)
+{
+	x -= cache->x;
+	y -= cache->y;
+
+	x /= cache->step;
+	y /= cache->step;
+	x *= cache->step;
+	y *= cache->step;
+
+	if (x < 0 || x >= cache->w || y < 0 || y >= cache->h)
+		return NULL;
+	else
+		return &cache->sample[y * cache->w + x];
+}
+
+static int sample_rayao_cache(RayAOCache *cache, float *co, float *n, int x, int y, float *ao, float *env)
+{
+	RayAOCacheSample *samples[4], *sample;
+	float wn[4], wb[4], tx, ty, w, totw, mino, maxo;
+	float d[3], dist2;
+	int i, x1, y1, x2, y2;
+
+	/* first try to find a sample in the same pixel */
+	if (cache->sample && cache->step) {
+		sample = &cache->sample[(y - cache->y) * cache->w + (x - cache->x)];
+		if (sample->filled) {
+			sub_v3_v3v3(d, sample->co, co);
+			dist2 = dot_v3v3(d, d);
+			if (dist2 < 0.5f * sample->dist2 && dot_v3v3(sample->n, n) > 0.98f) {
+				copy_v3_v3(ao, sample->ao);
+				copy_v3_v3(env, sample->env);
+				return 1;
+			}
+		}
+	}
+	else
+		return 0;
+
+	/* try to interpolate between 4 neighboring pixels */
+	samples[0] = find_rayao_sample(cache, x, y);
+	samples[1] = find_rayao_sample(cache, x + cache->step, y);
+	samples[2] = find_rayao_sample(cache, x, y + cache->step);
+	samples[3] = find_rayao_sample(cache, x + cache->step, y + cache->step);
+
+	for (i = 0; i < 4; i++)
+		if (!samples[i] || !samples[i]->filled)
+			return 0;
+
+	/* require intensities not being too different */
+	mino = min_ffff(samples[0]->intensity, samples[1]->intensity, samples[2]->intensity, samples[3]->intensity);
+	maxo = max_ffff(samples[0]->intensity, samples[1]->intensity, samples[2]->intensity, samples[3]->intensity);
+
+	if (maxo - mino > 0.05f)
+		return 0;
+
+	/* compute weighted interpolation between samples */
+	zero_v3(ao);
+	zero_v3(env);
+	totw = 0.0f;
+
+	x1 = samples[0]->x;
+	y1 = samples[0]->y;
+	x2 = samples[3]->x;
+	y2 = samples[3]->y;
+
+	tx = (float)(x2 - x) / (float)(x2 - x1);
+	ty = (float)(y2 - y) / (float)(y2 - y1);
+
+	wb[3] = (1.0f - tx) * (1.0f - ty);
+	wb[2] = (tx) * (1.0f - ty);
+	wb[1] = (1.0f - tx) * (ty);
+	wb[0] = tx * ty;
+
+	for (i = 0; i < 4; i++) {
+		wn[i] = pow(dot_v3v3(samples[i]->n, n), 32.0f);
+
+		w = wb[i] * wn[i];
+
+		totw += w;
+		madd_v3_v3fl(ao, samples[i]->ao, w);
+		madd_v3_v3fl(env, samples[i]->env, w);
+	}
+
+	if (totw >= 0.9f) {
+		totw = 1.0f / totw;
+		mul_v3_fl(ao, totw);
+		mul_v3_fl(env, totw);
+		return 1;
+	}
+
+	return 0;
+}
+
+static void fill_rayao_sample(RayAOCache *cache, ShadeInput *shi, const float ao[3], const float env[3])
+{
+	RayAOCacheSample *sample = &cache->sample[(shi->ys - cache->y) * cache->w + (shi->xs - cache->x)];
+
+	copy_v3_v3(sample->co, shi->co);
+	copy_v3_v3(sample->n, shi->vno);
+	copy_v3_v3(sample->ao, ao);
+	copy_v3_v3(sample->env, env);
+	sample->intensity = max_fff(ao[0], ao[1], ao[2]);
+	sample->intensity = max_ff(sample->intensity, max_fff(env[0], env[1], env[2]));
+	sample->dist2 = dot_v3v3(shi->dxco, shi->dxco) + dot_v3v3(shi->dyco, shi->dyco);
+	sample->x = shi->xs;
+	sample->y = shi->ys;
+	sample->filled = 1;
+}
+
+void cache_rayao_samples(Render *re, RenderPart *pa, ShadeSample *ssamp)
+{
+	PixStr ps;
+	RayAOCache *cache;
+	RayAOCacheSample *sample;
+	ShadeInput *shi;
+	intptr_t *rd = NULL;
+	int *ro = NULL, *rp = NULL, *rz = NULL;
+	int x, y, step = RAYAO_CACHE_STEP;
+
+	cache = &rayao_cache[pa->thread];
+	cache->w = pa->rectx;
+	cache->h = pa->recty;
+	cache->x = pa->disprect.xmin;
+	cache->y = pa->disprect.ymin;
+	cache->step = step;
+	cache->sample = MEM_callocN(sizeof(RayAOCacheSample) * cache->w * cache->h, "RayAOCacheSample");
+	sample = cache->sample;
+
+	if (re->osa) {
+		rd = pa->rectdaps;
+	}
+	else {
+		/* fake pixel struct for non-osa */
+		ps.next = NULL;
+		ps.mask = 0xFFFF;
+
+		ro = pa->recto;
+		rp = pa->rectp;
+		rz = pa->rectz;
+	}
+
+	/* compute a sample at every step pixels */
+	for (y = pa->disprect.ymin; y < pa->disprect.ymax; y++) {
+		for (x = pa->disprect.xmin; x < pa->disprect.xmax; x++, sample++, rd++, ro++, rp++, rz++) {
+			if (!(((x - pa->disprect.xmin + step) % step) == 0 || x == pa->disprect.xmax - 1))
+				continue;
+			if (!(((y - pa->disprect.ymin + step) % step) == 0 || y == pa->disprect.ymax - 1))
+				continue;
+
+			if (re->osa) {
+				if (!*rd) continue;
+
+				shade_samples_fill_with_ps(ssamp, (PixStr *)(*rd), x, y);
+			}
+			else {
+				if (!*rp) continue;
+
+				ps.obi = *ro;
+				ps.facenr = *rp;
+				ps.z = *rz;
+				shade_samples_fill_with_ps(ssamp, &ps, x, y);
+			}
+
+			shi = ssamp->shi;
+			if (shi->vlr && shi->mat->amb != 0.0f) {
+				ray_ao_sample(shi, shi->ao, shi->env);
+				fill_rayao_sample(cache, shi, shi->ao, shi->env);
+			}
+
+			if (re->test_break(re->tbh))
+				break;
+		}
+	}
+}
+
+void free_rayao_samples(Render *UNUSED(re), RenderPart *pa)
+{
+	RayAOCache *cache = &rayao_cache[pa->thread];
+
+	if (cache->sample)
+		MEM_freeN(cache->sample);
+
+	cache->sample = NULL;
+	cache->w = 0;
+	cache->h = 0;
+	cache->step = 0;
+}
+
+void ray_ao(ShadeInput *shi, float ao[3], float env[3])
+{
+	RayAOCache *cache = &rayao_cache[shi->thread];
+
+	/* try to get the result from the irradiance cache if possible, only
+	 * camera rays hit the screen space grid the cache is built on */
+	if (shi->strand || shi->depth != 0 ||
+	    !sample_rayao_cache(cache, shi->co, shi->vno, shi->xs, shi->ys, ao, env))
+	{
+		/* no luck, gather the full hemisphere */
+		ray_ao_sample(shi, ao, env);
+
+		/* fill result into sample, each time */
+		if (shi->strand == NULL && shi->depth == 0 && cache->sample && cache->step)
+			fill_rayao_sample(cache, shi, ao, env);
+	}
+}
+
 static void ray_shadow_jittered_coords(ShadeInput *shi, int max, float jitco[RE_MAX_OSA][3], int *totjitco)
 {
 	/* magic numbers for reordering sample positions to give better
@@ -2139,6 +2380,23 @@ static void ray_shadow_jittered_coords(ShadeInput *shi, int max, float jitco[RE_
 	}
 }
 
+/* Cast the gathered opaque shadow samples as one coherent packet, returns the
+ * number of occluded rays. The last hit is copied back to the template isec so
+ * following samples (and the per-lamp heuristic) can take the shortcut. */
+static int ray_shadow_packet_flush(Isect *isec, Isect isec_packet[4], Isect **packet_ptr, int num_packet)
+{
+	RayObject *last_hit = isec->last_hit;
+	int hits, i;
+
+	hits = RE_rayobject_raycast_shadow_packet4(R.raytree, packet_ptr, num_packet);
+
+	for (i = 0; i < num_packet; i++)
+		if (isec_packet[i].last_hit != last_hit)
+			isec->last_hit = isec_packet[i].last_hit;
+
+	return hits;
+}
+
 static void ray_shadow_qmc(ShadeInput *shi, LampRen *lar, const float lampco[3], float shadfac[4], Isect *isec)
 {
 	QMCSampler *qsa=NULL;
@@ -2159,6 +2417,10 @@ static void ray_shadow_qmc(ShadeInput *shi, LampRen *lar, const float lampco[3],
 	float jitco[RE_MAX_OSA][3];
 	int totjitco;
 
+	Isect isec_packet[4];
+	Isect *packet_ptr[4];
+	int num_packet = 0;
+
 	colsq[0] = colsq[1] = colsq[2] = 0.0;
 	if (isec->mode==RE_RAY_SHADOW_TRA) {
 		shadfac[0]= shadfac[1]= shadfac[2]= shadfac[3]= 0.0f;
@@ -2284,15 +2546,25 @@ static void ray_shadow_qmc(ShadeInput *shi, LampRen *lar, const float lampco[3],
 			colsq[2] += col[2]*col[2];
 		}
 		else {
-			if ( RE_rayobject_raycast(R.raytree, isec) ) fac+= 1.0f;
+			/* gather opaque shadow rays and trace them as coherent packets */
+			isec_packet[num_packet] = *isec;
+			packet_ptr[num_packet] = &isec_packet[num_packet];
+			num_packet++;
+
+			if (num_packet == 4) {
+				fac += (float)ray_shadow_packet_flush(isec, isec_packet, packet_ptr, num_packet);
+				num_packet = 0;
+			}
 		}
-		
+
 		samples++;
-		
+
 		if (lar->ray_samp_method == LA_SAMP_HALTON) {
-		
-			/* adaptive sampling - consider samples below threshold as in shadow (or vice versa) and exit early */
-			if ((max_samples > min_adapt_samples) && (adapt_thresh > 0.0f) && (samples > max_samples / 3)) {
+
+			/* adaptive sampling - consider samples below threshold as in shadow (or vice versa) and exit early.
+			 * with packet tracing 'fac' is only up to date on packet boundaries, so test there
+			 * (at worst this takes a few more samples than the per sample test did) */
+			if ((num_packet == 0) && (max_samples > min_adapt_samples) && (adapt_thresh > 0.0f) && (samples > max_samples / 3)) {
 				if (isec->mode==RE_RAY_SHADOW_TRA) {
 					if ((shadfac[3] / samples > (1.0f-adapt_thresh)) || (shadfac[3] / samples < adapt_thresh))
 						break;
@@ -2306,7 +2578,10 @@ static void ray_shadow_qmc(ShadeInput *shi, LampRen *lar, const float lampco[3],
 			}
 		}
 	}
-	
+
+	if (num_packet)
+		fac += (float)ray_shadow_packet_flush(isec, isec_packet, packet_ptr, num_packet);
+
 	if (isec->mode==RE_RAY_SHADOW_TRA) {
 		shadfac[0] /= samples;
 		shadfac[1] /= samples;
@@ -2327,7 +2602,11 @@ static void ray_shadow_jitter(ShadeInput *shi, LampRen *lar, const float lampco[
 	float fac=0.0f, div=0.0f, vec[3];
 	int a, j= -1, mask;
 	RayHint point_hint;
-	
+
+	Isect isec_packet[4];
+	Isect *packet_ptr[4];
+	int num_packet = 0;
+
 	if (isec->mode==RE_RAY_SHADOW_TRA) {
 		shadfac[0]= shadfac[1]= shadfac[2]= shadfac[3]= 0.0f;
 	}
@@ -2388,12 +2667,25 @@ static void ray_shadow_jitter(ShadeInput *shi, LampRen *lar, const float lampco[
 			shadfac[2] += col[2];
 			shadfac[3] += col[3];
 		}
-		else if ( RE_rayobject_raycast(R.raytree, isec) ) fac+= 1.0f;
-		
+		else {
+			/* gather opaque shadow rays and trace them as coherent packets */
+			isec_packet[num_packet] = *isec;
+			packet_ptr[num_packet] = &isec_packet[num_packet];
+			num_packet++;
+
+			if (num_packet == 4) {
+				fac += (float)ray_shadow_packet_flush(isec, isec_packet, packet_ptr, num_packet);
+				num_packet = 0;
+			}
+		}
+
 		div+= 1.0f;
 		jitlamp+= 2;
 	}
-	
+
+	if (num_packet)
+		fac += (float)ray_shadow_packet_flush(isec, isec_packet, packet_ptr, num_packet);
+
 	if (isec->mode==RE_RAY_SHADOW_TRA) {
 		shadfac[0] /= div;
 		shadfac[1] /= div;
@@ -38,6 +38,7 @@
 
 #include "BKE_appdir.h"
 #include "BLI_utildefines.h"
+#include "BLI_fileops.h"
 #include "BLI_listbase.h"
 #include "BLI_hash_md5.h"
 #include "BLI_path_util.h"
@@ -118,6 +119,10 @@ void render_result_free(RenderResult *res)
 		MEM_freeN(res->error);
 	if (res->stamp_data)
 		MEM_freeN(res->stamp_data);
+	if (res->spill_path) {
+		BLI_delete(res->spill_path, false, false);
+		MEM_freeN(res->spill_path);
+	}
 
 	MEM_freeN(res);
 }
@@ -1512,6 +1517,129 @@ bool render_result_exr_file_cache_read(Render *re)
 	return true;
 }
 
+/*********************** Spilled Pass Backing Store **************************/
+
+/* Multilayer results with many passes hold gigabytes per frame; while other
+ * scenes render or a finished frame waits for the compositor all of it sits
+ * idle in memory. The bulky per-layer passes can be flushed to a scratch exr
+ * in the session temp directory and are read back the first time the result
+ * is acquired again. The combined and Z passes stay resident since image
+ * display and RE_AcquireResultImage use them directly. */
+
+static bool render_result_pass_can_spill(RenderPass *rpass)
+{
+	return !ELEM(rpass->passtype, 0, SCE_PASS_COMBINED, SCE_PASS_Z);
+}
+
+static void render_result_spill_filepath(RenderResult *rr, char *r_path)
+{
+	char filename[FILE_MAXFILE];
+
+	/* pointer makes the name unique for simultaneous renders in one session */
+	BLI_snprintf(filename, sizeof(filename), "render_spill_%p.exr", (void *)rr);
+	BLI_make_file_string("/", r_path, BKE_tempdir_session(), filename);
+}
+
+/* flush passes to the scratch file and free their rects, caller must hold
+ * the result write lock */
+void render_result_passes_spill(RenderResult *rr)
+{
+	RenderLayer *rl;
+	RenderPass *rpass;
+	char str[FILE_MAX];
+	int tot = 0;
+
+	if (rr == NULL || rr->passes_spilled || rr->do_exr_tile)
+		return;
+
+	for (rl = rr->layers.first; rl; rl = rl->next)
+		for (rpass = rl->passes.first; rpass; rpass = rpass->next)
+			if (render_result_pass_can_spill(rpass) && rpass->rect)
+				tot++;
+
+	/* only combined/Z, not worth a scratch file */
+	if (tot == 0)
+		return;
+
+	render_result_spill_filepath(rr, str);
+
+	if (!RE_WriteRenderResult(NULL, rr, str, NULL, true, NULL)) {
+		printf("cannot write render spill file: %s\n", str);
+		return;
+	}
+
+	printf("Spilled %d render passes, %dx%d, %s\n", tot, rr->rectx, rr->recty, str);
+
+	for (rl = rr->layers.first; rl; rl = rl->next) {
+		for (rpass = rl->passes.first; rpass; rpass = rpass->next) {
+			if (render_result_pass_can_spill(rpass) && rpass->rect) {
+				MEM_freeN(rpass->rect);
+				rpass->rect = NULL;
+			}
+		}
+	}
+
+	rr->passes_spilled = true;
+	rr->spill_path = BLI_strdup(str);
+}
+
+/* read spilled passes back into freshly mapped rects, caller must hold the
+ * result write lock */
+bool render_result_passes_ensure(RenderResult *rr)
+{
+	RenderLayer *rl;
+	RenderPass *rpass;
+	void *exrhandle;
+	int rectx, recty;
+
+	if (rr == NULL || !rr->passes_spilled)
+		return true;
+
+	exrhandle = IMB_exr_get_handle();
+
+	if (IMB_exr_begin_read(exrhandle, rr->spill_path, &rectx, &recty) == 0) {
+		printf("cannot read render spill file: %s\n", rr->spill_path);
+		IMB_exr_close(exrhandle);
+		return false;
+	}
+
+	if (rectx != rr->rectx || recty != rr->recty) {
+		printf("error in reading render spill file: dimensions don't match\n");
+		IMB_exr_close(exrhandle);
+		return false;
+	}
+
+	for (rl = rr->layers.first; rl; rl = rl->next) {
+		for (rpass = rl->passes.first; rpass; rpass = rpass->next) {
+			const int xstride = rpass->channels;
+			int a;
+			char passname[EXR_PASS_MAXNAME];
+
+			if (!render_result_pass_can_spill(rpass) || rpass->rect)
+				continue;
+
+			rpass->rect = MEM_mapallocN(sizeof(float) * xstride * rectx * recty,
+			                            rpass->internal_name);
+
+			for (a = 0; a < xstride; a++) {
+				set_pass_name(passname, rpass->passtype, a, rpass->view);
+				IMB_exr_set_channel(exrhandle, rl->name, passname,
+				                    xstride, xstride * rectx, rpass->rect + a);
+			}
+		}
+	}
+
+	IMB_exr_read_channels(exrhandle);
+	IMB_exr_close(exrhandle);
+
+	BLI_delete(rr->spill_path, false, false);
+	MEM_freeN(rr->spill_path);
+	rr->spill_path = NULL;
+	rr->passes_spilled = false;
+
+	return true;
+}
+
 /*************************** Combined Pixel Rect *****************************/
 
 ImBuf *render_result_rect_to_ibuf(RenderResult *rr, RenderData *rd, const int view_id)
@@ -37,6 +37,8 @@
 #include "BLI_noise.h"
 #include "BLI_rand.h"
 #include "BLI_utildefines.h"
+#include "BLI_ghash.h"
+#include "BLI_task.h"
 
 #include "DNA_anim_types.h"
 #include "DNA_texture_types.h"
@@ -47,6 +49,7 @@
 #include "DNA_image_types.h"
 #include "DNA_node_types.h"
 
+#include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 #include "IMB_colormanagement.h"
 
@@ -128,15 +131,66 @@ static void init_render_texture(Render *re, Tex *tex)
 
 /* ------------------------------------------------------------------------- */
 
+/* Mipmap prefetch
+ *
+ * imagewraposa builds mipmap pyramids lazily under the global image lock,
+ * which serializes the render threads whenever they first touch a texture.
+ * Build the pyramids for all image textures used by the render up front in
+ * parallel tasks, one per image, so sampling only ever reads them. */
+
+static void tex_mipmap_prefetch_task(TaskPool *UNUSED(pool), void *taskdata, int UNUSED(threadid))
+{
+	Tex *tex = taskdata;
+	ImBuf *ibuf = BKE_image_acquire_ibuf(tex->ima, &tex->iuser, NULL);
+
+	if (ibuf && (ibuf->flags & IB_fields) == 0 && (ibuf->rect || ibuf->rect_float)) {
+		if (ibuf->mipmap[0] && (ibuf->userflags & IB_MIPMAP_INVALID)) {
+			IMB_remakemipmap(ibuf, tex->imaflag & TEX_GAUSS_MIP);
+			ibuf->userflags &= ~IB_MIPMAP_INVALID;
+		}
+		else if (ibuf->mipmap[0] == NULL)
+			IMB_makemipmap(ibuf, tex->imaflag & TEX_GAUSS_MIP);
+	}
+
+	BKE_image_release_ibuf(tex->ima, ibuf, NULL);
+}
+
+static void prefetch_texture_mipmaps(Render *re)
+{
+	TaskScheduler *task_scheduler;
+	TaskPool *task_pool;
+	GSet *done_images;
+	Tex *tex;
+
+	task_scheduler = BLI_task_scheduler_get();
+	task_pool = BLI_task_pool_create(task_scheduler, NULL);
+
+	/* multiple textures can reference one image, build each pyramid once */
+	done_images = BLI_gset_ptr_new("prefetch_texture_mipmaps gset");
+
+	for (tex = re->main->tex.first; tex; tex = tex->id.next) {
+		if (tex->id.us && tex->type == TEX_IMAGE && tex->ima && (tex->imaflag & TEX_MIPMAP)) {
+			if (BLI_gset_add(done_images, tex->ima))
+				BLI_task_pool_push(task_pool, tex_mipmap_prefetch_task, tex, false, TASK_PRIORITY_HIGH);
+		}
+	}
+
+	BLI_task_pool_work_and_wait(task_pool);
+	BLI_task_pool_free(task_pool);
+	BLI_gset_free(done_images, NULL);
+}
+
 void init_render_textures(Render *re)
 {
 	Tex *tex;
-	
+
 	tex= re->main->tex.first;
 	while (tex) {
 		if (tex->id.us) init_render_texture(re, tex);
 		tex= tex->id.next;
 	}
+
+	prefetch_texture_mipmaps(re);
 }
 
 static void end_render_texture(Tex *tex)
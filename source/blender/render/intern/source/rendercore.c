@@ -836,7 +836,9 @@ static void shadeDA_tile(RenderPart *pa, RenderLayer *rl)
 	/* occlusion caching */
 	if (R.occlusiontree)
 		cache_occ_samples(&R, pa, &ssamp);
-		
+	else if (rayao_cache_enabled(&R))
+		cache_rayao_samples(&R, pa, &ssamp);
+
 	/* filtered render, for now we assume only 1 filter size */
 	if (pa->crop) {
 		crop= 1;
@@ -893,6 +895,8 @@ static void shadeDA_tile(RenderPart *pa, RenderLayer *rl)
 
 	if (R.occlusiontree)
 		free_occ_samples(&R, pa);
+	else if (rayao_cache_enabled(&R))
+		free_rayao_samples(&R, pa);
 }
 
 /* ************* pixel struct ******** */
@@ -1376,7 +1380,9 @@ void zbufshade_tile(RenderPart *pa)
 
 				if (R.occlusiontree)
 					cache_occ_samples(&R, pa, &ssamp);
-				
+				else if (rayao_cache_enabled(&R))
+					cache_rayao_samples(&R, pa, &ssamp);
+
 				for (y=pa->disprect.ymin; y<pa->disprect.ymax; y++, rr->renrect.ymax++) {
 					for (x=pa->disprect.xmin; x<pa->disprect.xmax; x++, ro++, rz++, rp++, fcol+=4, offs++) {
 						/* per pixel fixed seed */
@@ -1398,7 +1404,9 @@ void zbufshade_tile(RenderPart *pa)
 				
 				if (R.occlusiontree)
 					free_occ_samples(&R, pa);
-				
+				else if (rayao_cache_enabled(&R))
+					free_rayao_samples(&R, pa);
+
 				if (R.r.mode & R_SHADOW)
 					ISB_free(pa);
 			}
@@ -760,14 +760,261 @@ static void makedeepshadowbuf(Render *re, LampRen *lar, float *jitbuf)
 	freepsA(&apsmbase);
 }
 
+/* ------------------------------------------------------------------------- */
+/* Shadow buffer cache                                                       */
+/* ------------------------------------------------------------------------- */
+
+/* Rendering a sequence regenerates every lamp's shadow buffer each frame,
+ * even when neither the lamp nor any caster moved. So the compiled buffers
+ * are kept on the Render between frames, keyed by a hash of the lamp settings,
+ * lamp view matrix and caster geometry, and swapped back in when the key
+ * still matches. Only done for animation renders and with persistent data,
+ * a single frame render gains nothing from keeping the buffers around. */
+
+typedef struct ShadBufCacheEntry {
+	struct ShadBufCacheEntry *next, *prev;
+	unsigned int hash;
+	ShadBuf *shb;
+	int used;	/* buffer was stored during the last database free */
+} ShadBufCacheEntry;
+
+static int shadowbuf_cache_active(Render *re)
+{
+	return ((re->flag & R_ANIMATION) || (re->r.mode & R_PERSISTENT_DATA));
+}
+
+static unsigned int shadowbuf_hash_data(const void *data, int size, unsigned int hash)
+{
+	const unsigned char *p= data;
+	int a;
+
+	for (a=0; a<size; a++)
+		hash= (hash * 33) ^ p[a];
+
+	return hash;
+}
+
+/* hash of everything casting into shadow buffers, shared by all lamp keys:
+ * object transforms, layers, material shadow settings and vertex positions */
+static unsigned int shadowbuf_database_hash(Render *re)
+{
+	ObjectInstanceRen *obi;
+	ObjectRen *obr;
+	VlakRen *vlr= NULL;
+	VertRen *ver= NULL;
+	StrandRen *strand= NULL;
+	Material *ma;
+	unsigned int hash= 5381;
+	int a;
+
+	for (obi=re->instancetable.first; obi; obi=obi->next) {
+		obr= obi->obr;
+
+		hash= shadowbuf_hash_data(obr->ob->id.name, sizeof(obr->ob->id.name), hash);
+		hash= shadowbuf_hash_data(&obi->lay, sizeof(obi->lay), hash);
+		hash= shadowbuf_hash_data(&obr->totvert, sizeof(obr->totvert), hash);
+		hash= shadowbuf_hash_data(&obr->totvlak, sizeof(obr->totvlak), hash);
+		hash= shadowbuf_hash_data(&obr->totstrand, sizeof(obr->totstrand), hash);
+
+		if (obi->flag & R_TRANSFORMED)
+			hash= shadowbuf_hash_data(obi->mat, sizeof(float[4][4]), hash);
+
+		/* materials switch shadow casting on/off, hashing them only where the
+		 * material changes also catches reordered material assignments */
+		ma= NULL;
+		for (a=0; a<obr->totvlak; a++) {
+			if ((a & 255)==0) vlr= obr->vlaknodes[a>>8].vlak;
+			else vlr++;
+
+			if (vlr->mat != ma) {
+				ma= vlr->mat;
+				hash= shadowbuf_hash_data(&a, sizeof(a), hash);
+				hash= shadowbuf_hash_data(ma->id.name, sizeof(ma->id.name), hash);
+				hash= shadowbuf_hash_data(&ma->mode, sizeof(ma->mode), hash);
+				hash= shadowbuf_hash_data(&ma->mode2, sizeof(ma->mode2), hash);
+			}
+		}
+
+		for (a=0; a<obr->totvert; a++) {
+			if ((a & 255)==0) ver= RE_findOrAddVert(obr, a);
+			else ver++;
+
+			hash= shadowbuf_hash_data(ver->co, sizeof(float[3]), hash);
+		}
+
+		for (a=0; a<obr->totstrand; a++) {
+			if ((a & 255)==0) strand= RE_findOrAddStrand(obr, a);
+			else strand++;
+
+			if (strand->vert)
+				hash= shadowbuf_hash_data(strand->vert, sizeof(StrandVert)*strand->totvert, hash);
+		}
+	}
+
+	return hash;
+}
+
+/* hash of the settings one lamp compiles into its shadow buffer */
+static unsigned int shadowbuf_lamp_hash(Render *re, LampRen *lar)
+{
+	ShadBuf *shb= lar->shb;
+	unsigned int hash= re->shadbufdbhash;
+
+	hash= shadowbuf_hash_data(&lar->buftype, sizeof(lar->buftype), hash);
+	hash= shadowbuf_hash_data(&lar->bufflag, sizeof(lar->bufflag), hash);
+	hash= shadowbuf_hash_data(&lar->filtertype, sizeof(lar->filtertype), hash);
+	hash= shadowbuf_hash_data(&lar->buffers, sizeof(lar->buffers), hash);
+	hash= shadowbuf_hash_data(&lar->mode, sizeof(lar->mode), hash);
+	hash= shadowbuf_hash_data(&lar->lay, sizeof(lar->lay), hash);
+	hash= shadowbuf_hash_data(&lar->spotsi, sizeof(lar->spotsi), hash);
+	hash= shadowbuf_hash_data(&shb->size, sizeof(shb->size), hash);
+	hash= shadowbuf_hash_data(&shb->samp, sizeof(shb->samp), hash);
+	hash= shadowbuf_hash_data(&shb->soft, sizeof(shb->soft), hash);
+	hash= shadowbuf_hash_data(&shb->shadhalostep, sizeof(shb->shadhalostep), hash);
+	hash= shadowbuf_hash_data(&shb->bias, sizeof(shb->bias), hash);
+	hash= shadowbuf_hash_data(&shb->d, sizeof(shb->d), hash);
+	hash= shadowbuf_hash_data(&shb->clipend, sizeof(shb->clipend), hash);
+	hash= shadowbuf_hash_data(&shb->compressthresh, sizeof(shb->compressthresh), hash);
+	hash= shadowbuf_hash_data(shb->viewmat, sizeof(shb->viewmat), hash);
+
+	return hash;
+}
+
+static void free_shadbuf(ShadBuf *shb)
+{
+	ShadSampleBuf *shsample;
+	int b, v;
+
+	for (shsample= shb->buffers.first; shsample; shsample= shsample->next) {
+		if (shsample->deepbuf) {
+			v= shb->size*shb->size;
+			for (b=0; b<v; b++)
+				if (shsample->deepbuf[b])
+					MEM_freeN(shsample->deepbuf[b]);
+
+			MEM_freeN(shsample->deepbuf);
+			MEM_freeN(shsample->totbuf);
+		}
+		else {
+			intptr_t *ztile= shsample->zbuf;
+			const char *ctile= shsample->cbuf;
+
+			v= (shb->size*shb->size)/256;
+			for (b=0; b<v; b++, ztile++, ctile++)
+				if (*ctile) MEM_freeN((void *) *ztile);
+
+			MEM_freeN(shsample->zbuf);
+			MEM_freeN(shsample->cbuf);
+		}
+	}
+	BLI_freelistN(&shb->buffers);
+
+	if (shb->weight) MEM_freeN(shb->weight);
+	MEM_freeN(shb);
+}
+
+static int shadowbuf_cache_restore(Render *re, LampRen *lar, unsigned int hash)
+{
+	ShadBufCacheEntry *entry;
+	ShadBuf *shb;
+
+	BLI_lock_thread(LOCK_CUSTOM1);
+	for (entry= re->shadbufcache.first; entry; entry= entry->next)
+		if (entry->hash == hash)
+			break;
+	if (entry)
+		BLI_remlink(&re->shadbufcache, entry);
+	BLI_unlock_thread(LOCK_CUSTOM1);
+
+	if (entry==NULL)
+		return 0;
+
+	/* swap the compiled buffer in place of the empty one from initshadowbuf */
+	shb= entry->shb;
+	MEM_freeN(lar->shb);
+	lar->shb= shb;
+	MEM_freeN(entry);
+
+	memset(shb->isb_result, 0, sizeof(shb->isb_result));
+
+	/* jitter table pointers are not owned by the buffer, refresh them */
+	BLI_lock_thread(LOCK_CUSTOM1);
+	shb->jit= give_jitter_tab(get_render_shadow_samples(&re->r, shb->samp));
+	BLI_unlock_thread(LOCK_CUSTOM1);
+
+	return 1;
+}
+
+void shadowbuf_cache_store(Render *re, LampRen *lar)
+{
+	ShadBufCacheEntry *entry;
+	ShadBuf *shb= lar->shb;
+
+	if (shb==NULL || !shadowbuf_cache_active(re))
+		return;
+	if (!ELEM(lar->buftype, LA_SHADBUF_REGULAR, LA_SHADBUF_HALFWAY, LA_SHADBUF_DEEP))
+		return;
+	/* incomplete buffers (render was aborted) are not worth keeping */
+	if (BLI_listbase_count(&shb->buffers) != shb->totbuf)
+		return;
+
+	entry= MEM_callocN(sizeof(ShadBufCacheEntry), "ShadBufCacheEntry");
+	entry->hash= shb->cachehash;
+	entry->shb= shb;
+	entry->used= 1;
+	BLI_addtail(&re->shadbufcache, entry);
+
+	lar->shb= NULL;
+}
+
+void shadowbuf_cache_trim(Render *re)
+{
+	ShadBufCacheEntry *entry, *next;
+
+	for (entry= re->shadbufcache.first; entry; entry= next) {
+		next= entry->next;
+
+		if (entry->used) {
+			/* keep for the next frame */
+			entry->used= 0;
+		}
+		else {
+			BLI_remlink(&re->shadbufcache, entry);
+			free_shadbuf(entry->shb);
+			MEM_freeN(entry);
+		}
+	}
+}
+
+void shadowbuf_cache_free(Render *re)
+{
+	ShadBufCacheEntry *entry;
+
+	for (entry= re->shadbufcache.first; entry; entry= entry->next)
+		free_shadbuf(entry->shb);
+
+	BLI_freelistN(&re->shadbufcache);
+}
+
+/* ------------------------------------------------------------------------- */
+
 void makeshadowbuf(Render *re, LampRen *lar)
 {
 	ShadBuf *shb= lar->shb;
 	float wsize, *jitbuf, twozero[2]= {0.0f, 0.0f}, angle, temp;
-	
+
+	if (shadowbuf_cache_active(re) && ELEM(lar->buftype, LA_SHADBUF_REGULAR, LA_SHADBUF_HALFWAY, LA_SHADBUF_DEEP)) {
+		unsigned int hash= shadowbuf_lamp_hash(re, lar);
+
+		if (shadowbuf_cache_restore(re, lar, hash))
+			return;
+
+		shb->cachehash= hash;
+	}
+
 	if (lar->bufflag & (LA_SHADBUF_AUTO_START|LA_SHADBUF_AUTO_END))
 		shadowbuf_autoclip(re, lar);
-	
+
 	/* just to enforce identical behavior of all irregular buffers */
 	if (lar->buftype==LA_SHADBUF_IRREGULAR)
 		shb->size= 1024;
@@ -848,6 +1095,10 @@ void threaded_makeshadowbufs(Render *re)
 	int a, totthread= 0;
 	int (*test_break)(void *);
 
+	/* part of every lamp's key in the shadow buffer cache */
+	if (shadowbuf_cache_active(re))
+		re->shadbufdbhash= shadowbuf_database_hash(re);
+
 	/* count number of threads to use */
 	if (G.is_rendering) {
 		for (lar=re->lampren.first; lar; lar= lar->next)
@@ -908,37 +1159,7 @@ void threaded_makeshadowbufs(Render *re)
 void freeshadowbuf(LampRen *lar)
 {
 	if (lar->shb) {
-		ShadBuf *shb= lar->shb;
-		ShadSampleBuf *shsample;
-		int b, v;
-		
-		for (shsample= shb->buffers.first; shsample; shsample= shsample->next) {
-			if (shsample->deepbuf) {
-				v= shb->size*shb->size;
-				for (b=0; b<v; b++)
-					if (shsample->deepbuf[b])
-						MEM_freeN(shsample->deepbuf[b]);
-					
-				MEM_freeN(shsample->deepbuf);
-				MEM_freeN(shsample->totbuf);
-			}
-			else {
-				intptr_t *ztile= shsample->zbuf;
-				const char *ctile= shsample->cbuf;
-				
-				v= (shb->size*shb->size)/256;
-				for (b=0; b<v; b++, ztile++, ctile++)
-					if (*ctile) MEM_freeN((void *) *ztile);
-				
-				MEM_freeN(shsample->zbuf);
-				MEM_freeN(shsample->cbuf);
-			}
-		}
-		BLI_freelistN(&shb->buffers);
-		
-		if (shb->weight) MEM_freeN(shb->weight);
-		MEM_freeN(lar->shb);
-		
+		free_shadbuf(lar->shb);
 		lar->shb= NULL;
 	}
 }
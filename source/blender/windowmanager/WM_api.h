@@ -444,6 +444,7 @@ enum {
 	WM_JOB_TYPE_CLIP_PREFETCH,
 	WM_JOB_TYPE_SEQ_BUILD_PROXY,
 	WM_JOB_TYPE_SEQ_BUILD_PREVIEW,
+	WM_JOB_TYPE_SEQ_PREFETCH,
 	WM_JOB_TYPE_POINTCACHE,
 	WM_JOB_TYPE_DPAINT_BAKE,
 	/* add as needed, screencast, seq proxy build
@@ -469,6 +470,7 @@ void        WM_jobs_callbacks(struct wmJob *,
                               void (*initjob)(void *),
                               void (*update)(void *),
                               void (*endjob)(void *));
+void        WM_jobs_depend(struct wmJob *, void *dep_owner, int dep_job_type);
 
 void		WM_jobs_start(struct wmWindowManager *wm, struct wmJob *);
 void		WM_jobs_stop(struct wmWindowManager *wm, void *owner, void *startjob);
@@ -455,7 +455,11 @@ void wm_close_and_free(bContext *C, wmWindowManager *wm)
 	}
 
 	BLI_freelistN(&wm->queue);
-	
+	if (wm->notifier_queue_set) {
+		BLI_gset_free(wm->notifier_queue_set, NULL);
+		wm->notifier_queue_set = NULL;
+	}
+
 	BLI_freelistN(&wm->paintcursors);
 
 	WM_drag_free_list(&wm->drags);
@@ -47,6 +47,7 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_dynstr.h"
+#include "BLI_ghash.h"
 #include "BLI_utildefines.h"
 #include "BLI_math.h"
 
@@ -156,15 +157,48 @@ void wm_event_init_from_window(wmWindow *win, wmEvent *event)
 
 /* ********************* notifiers, listeners *************** */
 
-static bool wm_test_duplicate_notifier(wmWindowManager *wm, unsigned int type, void *reference)
+/* hash and compare match #wm_test_duplicate_notifier of old, only the type
+ * flags and the reference identify a notifier, not window or subwindow */
+static unsigned int wm_notifier_hash(const void *ptr)
 {
-	wmNotifier *note;
+	const wmNotifier *note = ptr;
 
-	for (note = wm->queue.first; note; note = note->next)
-		if ((note->category | note->data | note->subtype | note->action) == type && note->reference == reference)
-			return 1;
-	
-	return 0;
+	return (BLI_ghashutil_uinthash(note->category | note->data | note->subtype | note->action) ^
+	        BLI_ghashutil_ptrhash(note->reference));
+}
+
+static bool wm_notifier_cmp(const void *a, const void *b)
+{
+	const wmNotifier *note_a = a;
+	const wmNotifier *note_b = b;
+
+	return !(((note_a->category | note_a->data | note_a->subtype | note_a->action) ==
+	          (note_b->category | note_b->data | note_b->subtype | note_b->action)) &&
+	         (note_a->reference == note_b->reference));
+}
+
+/* queue a notifier, or free it when an equivalent one is already queued,
+ * the GSet mirror of the queue keeps the duplicate check constant time */
+static bool wm_notifier_queue_add(wmWindowManager *wm, wmNotifier *note)
+{
+	if (wm->notifier_queue_set == NULL) {
+		wm->notifier_queue_set = BLI_gset_new_ex(wm_notifier_hash, wm_notifier_cmp, __func__, 256);
+	}
+
+	if (!BLI_gset_add(wm->notifier_queue_set, note)) {
+		MEM_freeN(note);
+		return false;
+	}
+
+	BLI_addtail(&wm->queue, note);
+	return true;
+}
+
+static void wm_notifier_queue_remove(wmWindowManager *wm, wmNotifier *note)
+{
+	if (wm->notifier_queue_set) {
+		BLI_gset_remove(wm->notifier_queue_set, note, NULL);
+	}
 }
 
 /* XXX: in future, which notifiers to send to other windows? */
@@ -174,26 +208,24 @@ void WM_event_add_notifier(const bContext *C, unsigned int type, void *reference
 	wmWindowManager *wm = CTX_wm_manager(C);
 	wmNotifier *note;
 
-	if (wm_test_duplicate_notifier(wm, type, reference))
-		return;
-
 	note = MEM_callocN(sizeof(wmNotifier), "notifier");
-	
+
 	note->wm = wm;
-	BLI_addtail(&note->wm->queue, note);
-	
+
 	note->window = CTX_wm_window(C);
-	
+
 	ar = CTX_wm_region(C);
 	if (ar)
 		note->swinid = ar->swinid;
-	
+
 	note->category = type & NOTE_CATEGORY;
 	note->data = type & NOTE_DATA;
 	note->subtype = type & NOTE_SUBTYPE;
 	note->action = type & NOTE_ACTION;
-	
+
 	note->reference = reference;
+
+	wm_notifier_queue_add(wm, note);
 }
 
 void WM_main_add_notifier(unsigned int type, void *reference)
@@ -202,20 +234,21 @@ void WM_main_add_notifier(unsigned int type, void *reference)
 	wmWindowManager *wm = bmain->wm.first;
 	wmNotifier *note;
 
-	if (!wm || wm_test_duplicate_notifier(wm, type, reference))
+	if (!wm)
 		return;
 
 	note = MEM_callocN(sizeof(wmNotifier), "notifier");
-	
+
 	note->wm = wm;
-	BLI_addtail(&note->wm->queue, note);
-	
+
 	note->category = type & NOTE_CATEGORY;
 	note->data = type & NOTE_DATA;
 	note->subtype = type & NOTE_SUBTYPE;
 	note->action = type & NOTE_ACTION;
-	
+
 	note->reference = reference;
+
+	wm_notifier_queue_add(wm, note);
 }
 
 /**
@@ -235,6 +268,7 @@ void WM_main_remove_notifier_reference(const void *reference)
 			if (note->reference == reference) {
 				/* don't remove because this causes problems for #wm_event_do_notifiers
 				 * which may be looping on the data (deleting screens) */
+				wm_notifier_queue_remove(wm, note);
 				wm_notifier_clear(note);
 			}
 		}
@@ -340,6 +374,8 @@ void wm_event_do_notifiers(bContext *C)
 	
 	/* the notifiers are sent without context, to keep it clean */
 	while ((note = BLI_pophead(&wm->queue))) {
+		wm_notifier_queue_remove(wm, note);
+
 		for (win = wm->windows.first; win; win = win->next) {
 			
 			/* filter out notifiers */
@@ -109,6 +109,11 @@ struct wmJob {
 	short suspended, running, ready, do_update, stop, job_type;
 	float progress;
 
+	/* optional dependency set by WM_jobs_depend, stay suspended while a matching job runs */
+	void *dep_owner;
+	int dep_job_type;
+	bool dep_active;
+
 	/* for display in header, identification */
 	char name[128];
 
@@ -330,6 +335,19 @@ void WM_jobs_callbacks(wmJob *wm_job,
 	wm_job->endjob = endjob;
 }
 
+/**
+ * Keep this job suspended while any (\a dep_owner, \a dep_job_type) job is running.
+ * Either may be NULL / #WM_JOB_TYPE_ANY to match on the other alone; the check re-runs
+ * on every timer step through the regular suspend logic, so the job starts by itself
+ * once the dependency finished.
+ */
+void WM_jobs_depend(wmJob *wm_job, void *dep_owner, int dep_job_type)
+{
+	wm_job->dep_owner = dep_owner;
+	wm_job->dep_job_type = dep_job_type;
+	wm_job->dep_active = (dep_owner != NULL) || (dep_job_type != WM_JOB_TYPE_ANY);
+}
+
 static void *do_job_thread(void *job_v)
 {
 	wmJob *wm_job = job_v;
@@ -345,7 +363,8 @@ static void wm_jobs_test_suspend_stop(wmWindowManager *wm, wmJob *test)
 {
 	wmJob *wm_job;
 	bool suspend = false;
-	
+	int nbr_running = 0;
+
 	/* job added with suspend flag, we wait 1 timer step before activating it */
 	if (test->flag & WM_JOB_SUSPEND) {
 		suspend = true;
@@ -358,12 +377,23 @@ static void wm_jobs_test_suspend_stop(wmWindowManager *wm, wmJob *test)
 			if (wm_job == test || !wm_job->running) {
 				continue;
 			}
-			
+
+			nbr_running++;
+
+			/* explicit dependency from WM_jobs_depend, wait until it finished */
+			if (test->dep_active &&
+			    (test->dep_owner == NULL || wm_job->owner == test->dep_owner) &&
+			    (test->dep_job_type == WM_JOB_TYPE_ANY || wm_job->job_type == test->dep_job_type))
+			{
+				suspend = true;
+				continue;
+			}
+
 			/* if new job is not render, then check for same startjob */
 			if (0 == (test->flag & WM_JOB_EXCL_RENDER))
 				if (wm_job->startjob != test->startjob)
 					continue;
-			
+
 			/* if new job is render, any render job should be stopped */
 			if (test->flag & WM_JOB_EXCL_RENDER)
 				if (0 == (wm_job->flag & WM_JOB_EXCL_RENDER))
@@ -377,8 +407,23 @@ static void wm_jobs_test_suspend_stop(wmWindowManager *wm, wmJob *test)
 				// printf("job stopped: %s\n", wm_job->name);
 			}
 		}
+
+		/* Leave a core free for the interactive main thread: once every other core
+		 * already runs a background job, new jobs wait suspended for a slot instead
+		 * of oversubscribing the machine (priority jobs stop their competitors above
+		 * and so get a slot next timer step). This is a rough budget only, jobs may
+		 * spawn more threads of their own. */
+		if (!suspend && !(test->flag & WM_JOB_PRIORITY)) {
+			int max_running = BLI_system_thread_count() - 1;
+			if (max_running < 1) {
+				max_running = 1;
+			}
+			if (nbr_running >= max_running) {
+				suspend = true;
+			}
+		}
 	}
-	
+
 	/* possible suspend ourselfs, waiting for other jobs, or de-suspend */
 	test->suspended = suspend;
 	// if (suspend) printf("job suspended: %s\n", test->name);
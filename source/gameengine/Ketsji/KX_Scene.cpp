@@ -169,6 +169,8 @@ KX_Scene::KX_Scene(class SCA_IInputDevice* keyboarddevice,
 
 	m_dbvt_culling = false;
 	m_dbvt_occlusion_res = 0;
+	m_objecttree = NULL;
+	m_objecttreecount = 0;
 	m_activity_culling = false;
 	m_suspend = false;
 	m_isclearingZbuffer = true;
@@ -263,6 +265,8 @@ KX_Scene::~KX_Scene()
 	if (m_obstacleSimulation)
 		delete m_obstacleSimulation;
 
+	SetNodeTree(NULL);
+
 	if (m_objectlist)
 		m_objectlist->Release();
 
@@ -1036,6 +1040,10 @@ int KX_Scene::NewRemoveObject(class CValue* gameobj)
 	/* remove property from debug list */
 	RemoveObjectDebugProperties(newobj);
 
+	/* the culling tree references the object's SG node, drop it before the
+	 * node is freed, it will be rebuilt on the next visibility pass */
+	SetNodeTree(NULL);
+
 	/* Invalidate the python reference, since the object may exist in script lists
 	 * its possible that it wont be automatically invalidated, so do it manually here,
 	 * 
@@ -1384,6 +1392,48 @@ void KX_Scene::SetCameraOnTop(KX_Camera* cam)
 	}
 }
 
+/* delete a whole culling tree, the SG_Tree destructor doesn't recurse
+ * because the factory shares children between candidate nodes */
+static void destroy_node_tree(SG_Tree *tree)
+{
+	if (tree->Left())
+		destroy_node_tree(tree->Left());
+	if (tree->Right())
+		destroy_node_tree(tree->Right());
+	delete tree;
+}
+
+void KX_Scene::SetNodeTree(SG_Tree* root)
+{
+	if (m_objecttree)
+		destroy_node_tree(m_objecttree);
+	m_objecttree = root;
+	m_objecttreecount = m_objectlist->GetCount();
+}
+
+void KX_Scene::UpdateObjectTree()
+{
+	// object count change means objects were added or removed, the tree
+	// structure is stale (and removed objects would leave dangling nodes,
+	// see NewRemoveObject for that case)
+	if (m_objecttree && m_objecttreecount != m_objectlist->GetCount())
+		SetNodeTree(NULL);
+
+	if (!m_objecttree) {
+		SG_TreeFactory tf;
+		for (int i = 0; i < m_objectlist->GetCount(); i++) {
+			KX_GameObject *gameobj = static_cast<KX_GameObject*>(m_objectlist->GetValue(i));
+			if (gameobj->GetSGNode())
+				tf.Add(gameobj->GetSGNode());
+		}
+		SetNodeTree(tf.MakeTree());
+	}
+	else {
+		// objects move every frame, only the bounds need updating
+		m_objecttree->Refit();
+	}
+}
+
 void KX_Scene::MarkVisible(SG_Tree *node, RAS_IRasterizer* rasty, KX_Camera* cam, int layer)
 {
 	int intersect = KX_Camera::INTERSECT;
@@ -1431,9 +1481,11 @@ void KX_Scene::MarkSubTreeVisible(SG_Tree *node, RAS_IRasterizer* rasty, bool vi
 	if (node->Client())
 	{
 		KX_GameObject *gameobj = (KX_GameObject*) node->Client()->GetSGClientObject();
+		// shadow lamp layers
+		bool objvisible = visible && (!layer || (gameobj->GetLayer() & layer));
 		if (gameobj->GetVisible())
 		{
-			if (visible)
+			if (objvisible)
 			{
 				int nummeshes = gameobj->GetMeshCount();
 				
@@ -1442,7 +1494,7 @@ void KX_Scene::MarkSubTreeVisible(SG_Tree *node, RAS_IRasterizer* rasty, bool vi
 					(gameobj->GetMesh(m))->SchedulePolygons(rasty->GetDrawingMode());
 			}
 
-			gameobj->SetCulled(!visible);
+			gameobj->SetCulled(!objvisible);
 			gameobj->UpdateBuckets(false);
 		}
 	}
@@ -1567,10 +1619,24 @@ void KX_Scene::CalculateVisibleMeshes(RAS_IRasterizer* rasty,KX_Camera* cam, int
 		                                                 mvmat, pmat);
 	}
 	if (!dbvt_culling) {
-		// the physics engine couldn't help us, do it the hard way
-		for (int i = 0; i < m_objectlist->GetCount(); i++)
-		{
-			MarkVisible(rasty, static_cast<KX_GameObject*>(m_objectlist->GetValue(i)), cam, layer);
+		// the physics engine couldn't help us, walk the scenegraph
+		// bounding volume tree so whole branches outside the frustum
+		// are rejected with a single test
+		SG_Tree *objecttree = NULL;
+		if (cam->GetFrustumCulling()) {
+			UpdateObjectTree();
+			objecttree = m_objecttree;
+		}
+		if (objecttree) {
+			MarkVisible(objecttree, rasty, cam, layer);
+		}
+		else {
+			// no tree available (e.g. frustum culling disabled on the
+			// camera), test every object
+			for (int i = 0; i < m_objectlist->GetCount(); i++)
+			{
+				MarkVisible(rasty, static_cast<KX_GameObject*>(m_objectlist->GetValue(i)), cam, layer);
+			}
 		}
 	}
 }
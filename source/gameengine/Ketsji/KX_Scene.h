@@ -279,6 +279,23 @@ protected:
 	 */
 	RAS_Rect m_viewport;
 	
+	/**
+	 * Bounding volume tree over the scenegraph, used for visibility
+	 * testing when DBVT culling is not available. Rebuilt when objects
+	 * are added or removed, refitted in place as they move.
+	 */
+	SG_Tree* m_objecttree;
+
+	/**
+	 * Number of objects in the scene when m_objecttree was built.
+	 */
+	int m_objecttreecount;
+
+	/**
+	 * Builds or refits m_objecttree for the current frame.
+	 */
+	void UpdateObjectTree();
+
 	/**
 	 * Visibility testing functions.
 	 */
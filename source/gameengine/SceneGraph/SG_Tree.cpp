@@ -174,6 +174,39 @@ void SG_Tree::SetRight(SG_Tree *right)
 	m_radius = (m_bbox.m_max - m_bbox.m_min).length();
 }
 
+void SG_Tree::Refit()
+{
+	/* a node can have both a client object and children (cf MakeTreeDown),
+	 * the bounding box is the union of all of them */
+	bool valid = false;
+	if (m_client_object)
+	{
+		m_bbox = SG_BBox(m_client_object->BBox(), m_client_object->GetWorldTransform());
+		valid = true;
+	}
+	if (m_left)
+	{
+		m_left->Refit();
+		if (valid)
+			m_bbox += m_left->m_bbox;
+		else
+		{
+			m_bbox = m_left->m_bbox;
+			valid = true;
+		}
+	}
+	if (m_right)
+	{
+		m_right->Refit();
+		if (valid)
+			m_bbox += m_right->m_bbox;
+		else
+			m_bbox = m_right->m_bbox;
+	}
+	m_center = (m_bbox.m_min + m_bbox.m_max)/2.0f;
+	m_radius = (m_bbox.m_max - m_bbox.m_min).length();
+}
+
 /**
  * A Half array is a square 2d array where cell(x, y) is undefined
  * if x < y.
@@ -311,8 +344,6 @@ SG_Tree* SG_TreeFactory::MakeTreeDown(SG_BBox &bbox)
 				break;
 		}
 	}
-	std::cout << "Left: " << hasleft << " Right: " << hasright << " Count: " << m_objects.size() << std::endl;
-	
 	SG_Tree *leftnode = NULL;
 	if (hasleft)
 		leftnode = lefttree.MakeTreeDown(left);
@@ -99,6 +99,13 @@ public:
 	void SetLeft(SG_Tree *left);
 	void SetRight(SG_Tree *right);
 
+	/**
+	 * Recompute the bounding boxes of the tree bottom up from the
+	 * current world transforms of the client objects. The structure
+	 * of the tree is left untouched.
+	 */
+	void Refit();
+
 	MT_Point3 Center() const { return m_center; }
 	MT_Scalar Radius() { return m_radius; }
 	
@@ -198,3 +198,43 @@ TEST(ghash, Pop)
 
 	BLI_ghash_free(ghash, NULL, NULL);
 }
+
+/* Flat (open-addressing) storage: insert/lookup all keys, then remove half
+ * of them and check the other half is still found. */
+TEST(ghash, FlatInsertLookupRemove)
+{
+	GHash *ghash = BLI_ghash_flat_new(BLI_ghashutil_inthash_p, BLI_ghashutil_intcmp, __func__);
+	unsigned int keys[TESTCASE_SIZE], *k;
+	int i;
+
+	init_keys(keys, 30);
+
+	for (i = TESTCASE_SIZE, k = keys; i--; k++) {
+		BLI_ghash_insert(ghash, SET_UINT_IN_POINTER(*k), SET_UINT_IN_POINTER(*k));
+	}
+
+	EXPECT_EQ(TESTCASE_SIZE, BLI_ghash_size(ghash));
+
+	for (i = TESTCASE_SIZE, k = keys; i--; k++) {
+		void *v = BLI_ghash_lookup(ghash, SET_UINT_IN_POINTER(*k));
+		EXPECT_EQ(*k, GET_UINT_FROM_POINTER(v));
+	}
+
+	for (i = 0, k = keys; i < TESTCASE_SIZE / 2; i++, k++) {
+		EXPECT_TRUE(BLI_ghash_remove(ghash, SET_UINT_IN_POINTER(*k), NULL, NULL));
+	}
+
+	EXPECT_EQ(TESTCASE_SIZE - TESTCASE_SIZE / 2, BLI_ghash_size(ghash));
+
+	for (i = 0, k = keys; i < TESTCASE_SIZE; i++, k++) {
+		void *v = BLI_ghash_lookup(ghash, SET_UINT_IN_POINTER(*k));
+		if (i < TESTCASE_SIZE / 2) {
+			EXPECT_EQ(NULL, v);
+		}
+		else {
+			EXPECT_EQ(*k, GET_UINT_FROM_POINTER(v));
+		}
+	}
+
+	BLI_ghash_free(ghash, NULL, NULL);
+}
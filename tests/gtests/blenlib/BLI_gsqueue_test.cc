@@ -0,0 +1,186 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+#include <string.h>
+
+#ifdef _WIN32
+#  include <windows.h>
+#  define mpmc_test_yield() SwitchToThread()
+#else
+#  include <sched.h>
+#  define mpmc_test_yield() sched_yield()
+#endif
+
+extern "C" {
+#include "BLI_gsqueue.h"
+#include "BLI_threads.h"
+#include "BLI_listbase.h"
+#include "BLI_utildefines.h"
+#include "MEM_guardedalloc.h"
+#include "atomic_ops.h"
+};
+
+/* -------------------------------------------------------------------- */
+/* Plain GSQueue */
+
+TEST(gsqueue, Empty)
+{
+	GSQueue *queue = BLI_gsqueue_new(sizeof(int));
+	EXPECT_EQ(BLI_gsqueue_is_empty(queue), true);
+	EXPECT_EQ(BLI_gsqueue_size(queue), 0);
+	BLI_gsqueue_free(queue);
+}
+
+TEST(gsqueue, FIFO)
+{
+	const int tot = 128;
+	GSQueue *queue = BLI_gsqueue_new(sizeof(int));
+	int in, out;
+
+	for (in = 0; in < tot; in++) {
+		BLI_gsqueue_push(queue, (void *)&in);
+	}
+	EXPECT_EQ(BLI_gsqueue_size(queue), tot);
+	for (in = 0; in < tot; in++) {
+		BLI_gsqueue_pop(queue, (void *)&out);
+		EXPECT_EQ(out, in);
+	}
+	EXPECT_EQ(BLI_gsqueue_is_empty(queue), true);
+	BLI_gsqueue_free(queue);
+}
+
+/* -------------------------------------------------------------------- */
+/* Lock-free MPMC variant */
+
+TEST(gsqueue, MPMCEmpty)
+{
+	GSQueueMPMC *queue = BLI_gsqueue_mpmc_new(sizeof(int), 8);
+	int out;
+
+	EXPECT_EQ(BLI_gsqueue_mpmc_is_empty(queue), true);
+	EXPECT_EQ(BLI_gsqueue_mpmc_pop(queue, (void *)&out), false);
+	BLI_gsqueue_mpmc_free(queue);
+}
+
+TEST(gsqueue, MPMCFIFO)
+{
+	const int tot = 8;
+	GSQueueMPMC *queue = BLI_gsqueue_mpmc_new(sizeof(int), tot);
+	int in, out;
+
+	for (in = 0; in < tot; in++) {
+		EXPECT_EQ(BLI_gsqueue_mpmc_push(queue, (void *)&in), true);
+	}
+	/* bounded: capacity is exhausted now */
+	EXPECT_EQ(BLI_gsqueue_mpmc_push(queue, (void *)&in), false);
+
+	for (in = 0; in < tot; in++) {
+		EXPECT_EQ(BLI_gsqueue_mpmc_pop(queue, (void *)&out), true);
+		EXPECT_EQ(out, in);
+	}
+	EXPECT_EQ(BLI_gsqueue_mpmc_is_empty(queue), true);
+	BLI_gsqueue_mpmc_free(queue);
+}
+
+TEST(gsqueue, MPMCWrapAround)
+{
+	/* exercise the sequence numbers over many laps of a tiny ring */
+	const int laps = 1000;
+	GSQueueMPMC *queue = BLI_gsqueue_mpmc_new(sizeof(int), 2);
+	int in, out;
+
+	for (in = 0; in < laps; in++) {
+		EXPECT_EQ(BLI_gsqueue_mpmc_push(queue, (void *)&in), true);
+		EXPECT_EQ(BLI_gsqueue_mpmc_pop(queue, (void *)&out), true);
+		EXPECT_EQ(out, in);
+	}
+	BLI_gsqueue_mpmc_free(queue);
+}
+
+/* Threaded stress test: every pushed value must be popped exactly once.
+ * A small capacity forces constant full/empty contention and wrap-around. */
+
+#define MPMC_NUM_PRODUCERS 4
+#define MPMC_NUM_CONSUMERS 4
+#define MPMC_ITEMS_PER_PRODUCER 10000
+#define MPMC_ITEMS_TOTAL (MPMC_NUM_PRODUCERS * MPMC_ITEMS_PER_PRODUCER)
+#define MPMC_QUEUE_SIZE 16
+
+typedef struct MPMCThreadState {
+	GSQueueMPMC *queue;
+	bool is_producer;
+	int producer_index;
+	/* shared between all threads */
+	uint32_t *producers_done;
+	uint32_t *seen;
+} MPMCThreadState;
+
+static void *mpmc_thread_func(void *arg)
+{
+	MPMCThreadState *state = (MPMCThreadState *)arg;
+	GSQueueMPMC *queue = state->queue;
+	int value;
+
+	if (state->is_producer) {
+		int i;
+		for (i = 0; i < MPMC_ITEMS_PER_PRODUCER; i++) {
+			value = state->producer_index * MPMC_ITEMS_PER_PRODUCER + i;
+			while (!BLI_gsqueue_mpmc_push(queue, (void *)&value)) {
+				/* full, let the consumers catch up (pure spinning would
+				 * crawl on a single core machine) */
+				mpmc_test_yield();
+			}
+		}
+		atomic_add_uint32(state->producers_done, 1);
+	}
+	else {
+		while (true) {
+			const bool all_pushed =
+			        (atomic_cas_uint32(state->producers_done, 0, 0) == MPMC_NUM_PRODUCERS);
+			if (BLI_gsqueue_mpmc_pop(queue, (void *)&value)) {
+				/* no two consumers can pop the same value, plain increment is fine */
+				state->seen[value]++;
+			}
+			else if (all_pushed) {
+				/* producers were done before the failed pop, so the queue
+				 * can't refill: really empty */
+				break;
+			}
+			else {
+				mpmc_test_yield();
+			}
+		}
+	}
+
+	return NULL;
+}
+
+TEST(gsqueue, MPMCThreaded)
+{
+	GSQueueMPMC *queue = BLI_gsqueue_mpmc_new(sizeof(int), MPMC_QUEUE_SIZE);
+	MPMCThreadState states[MPMC_NUM_PRODUCERS + MPMC_NUM_CONSUMERS];
+	uint32_t *seen = (uint32_t *)MEM_callocN(sizeof(*seen) * MPMC_ITEMS_TOTAL, __func__);
+	uint32_t producers_done = 0;
+	ListBase threads;
+	int i;
+
+	BLI_threadapi_init();
+	BLI_init_threads(&threads, mpmc_thread_func, MPMC_NUM_PRODUCERS + MPMC_NUM_CONSUMERS);
+	for (i = 0; i < MPMC_NUM_PRODUCERS + MPMC_NUM_CONSUMERS; i++) {
+		states[i].queue = queue;
+		states[i].is_producer = (i < MPMC_NUM_PRODUCERS);
+		states[i].producer_index = i;
+		states[i].producers_done = &producers_done;
+		states[i].seen = seen;
+		BLI_insert_thread(&threads, &states[i]);
+	}
+	BLI_end_threads(&threads);
+
+	for (i = 0; i < MPMC_ITEMS_TOTAL; i++) {
+		EXPECT_EQ(seen[i], 1);
+	}
+	EXPECT_EQ(BLI_gsqueue_mpmc_is_empty(queue), true);
+
+	MEM_freeN(seen);
+	BLI_gsqueue_mpmc_free(queue);
+}